@@ -0,0 +1,347 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/Device.hpp>
+#include <SoapySDR/Registry.hpp>
+#include <SoapySDR/Broker.hpp>
+#include <SoapySDR/Formats.hpp>
+#include <SoapySDR/Time.hpp>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <memory>
+
+/***********************************************************************
+ * A receive only device that reads the shared ring of a SoapySDR::Broker
+ * in another process, which owns the real device.
+ *
+ * Device arguments:
+ *  - name: the name of the broker
+ *
+ * Each stream attaches as a reader of its own, so that overflows are
+ * tracked per stream and a slow stream does not affect the others.
+ * Direct buffer reads hand out the shared slots without a copy.
+ * The broker owns the tuning, so the rate and frequency are read only.
+ **********************************************************************/
+struct BrokerStream
+{
+    BrokerStream(void):
+        elemSize(0),
+        rate(0.0),
+        active(false),
+        handle(0),
+        offset(0),
+        remaining(0),
+        flags(0),
+        timeNs(0)
+    {
+        return;
+    }
+
+    std::unique_ptr<SoapySDR::BrokerReader> reader;
+    std::vector<size_t> channels;
+    size_t elemSize;
+    double rate;
+    bool active;
+
+    //the buffer that readStream() has partly copied out
+    std::vector<const void *> slot;
+    std::vector<const void *> direct;
+    size_t handle;
+    size_t offset;
+    size_t remaining;
+    int flags;
+    long long timeNs;
+};
+
+class BrokerDevice : public SoapySDR::Device
+{
+public:
+    BrokerDevice(const SoapySDR::Kwargs &args):
+        _name(args.at("name"))
+    {
+        const SoapySDR::BrokerReader reader(_name);
+        _format = reader.format();
+        _fullScale = reader.fullScale();
+        _numChannels = reader.numChannels();
+        _hardware = reader.hardwareKey();
+        _ownerPid = reader.ownerPid();
+        _rate = reader.sampleRate();
+        _frequency = reader.frequency();
+    }
+
+    /*******************************************************************
+     * Identification API
+     ******************************************************************/
+    std::string getDriverKey(void) const
+    {
+        return "broker";
+    }
+
+    std::string getHardwareKey(void) const
+    {
+        return _hardware;
+    }
+
+    SoapySDR::Kwargs getHardwareInfo(void) const
+    {
+        SoapySDR::Kwargs info;
+        info["name"] = _name;
+        info["owner_pid"] = std::to_string(_ownerPid);
+        info["format"] = _format;
+        return info;
+    }
+
+    /*******************************************************************
+     * Channels API
+     ******************************************************************/
+    size_t getNumChannels(const int direction) const
+    {
+        return (direction == SOAPY_SDR_RX)?_numChannels:0;
+    }
+
+    /*******************************************************************
+     * Stream API
+     ******************************************************************/
+    std::vector<std::string> getStreamFormats(const int, const size_t) const
+    {
+        return std::vector<std::string>(1, _format);
+    }
+
+    std::string getNativeStreamFormat(const int, const size_t, double &fullScale) const
+    {
+        fullScale = _fullScale;
+        return _format;
+    }
+
+    SoapySDR::Stream *setupStream(const int direction, const std::string &format, const std::vector<size_t> &channels_, const SoapySDR::Kwargs &)
+    {
+        if (direction != SOAPY_SDR_RX) throw std::runtime_error("BrokerDevice::setupStream() only RX is supported");
+        if (format != _format) throw std::runtime_error("BrokerDevice::setupStream() the broker streams " + _format);
+        const auto channels = channels_.empty()?std::vector<size_t>(1, 0):channels_;
+        for (const auto chan : channels)
+        {
+            if (chan >= _numChannels) throw std::runtime_error("BrokerDevice::setupStream() invalid channel " + std::to_string(chan));
+        }
+
+        std::unique_ptr<BrokerStream> stream(new BrokerStream());
+        stream->reader.reset(new SoapySDR::BrokerReader(_name));
+        stream->channels = channels;
+        stream->elemSize = SoapySDR::formatToSize(format);
+        stream->slot.resize(_numChannels);
+        stream->direct.resize(_numChannels);
+        return reinterpret_cast<SoapySDR::Stream *>(stream.release());
+    }
+
+    void closeStream(SoapySDR::Stream *handle)
+    {
+        auto stream = reinterpret_cast<BrokerStream *>(handle);
+        this->releasePartial(stream);
+        delete stream;
+    }
+
+    size_t getStreamMTU(SoapySDR::Stream *handle) const
+    {
+        return reinterpret_cast<BrokerStream *>(handle)->reader->mtu();
+    }
+
+    //the stream joins at the newest buffer, the broker keeps the device streaming
+    int activateStream(SoapySDR::Stream *handle, const int, const long long, const size_t)
+    {
+        auto stream = reinterpret_cast<BrokerStream *>(handle);
+        this->releasePartial(stream);
+        stream->reader->resync();
+        stream->rate = _rate = stream->reader->sampleRate();
+        _frequency = stream->reader->frequency();
+        stream->active = true;
+        return 0;
+    }
+
+    int deactivateStream(SoapySDR::Stream *handle, const int, const long long)
+    {
+        auto stream = reinterpret_cast<BrokerStream *>(handle);
+        this->releasePartial(stream);
+        stream->active = false;
+        return 0;
+    }
+
+    int readStream(SoapySDR::Stream *handle, void * const *buffs, const size_t numElems, int &flags, long long &timeNs, const long timeoutUs)
+    {
+        auto stream = reinterpret_cast<BrokerStream *>(handle);
+        if (not stream->active)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(timeoutUs));
+            return SOAPY_SDR_TIMEOUT;
+        }
+        if (stream->remaining == 0)
+        {
+            const int ret = stream->reader->acquire(stream->handle, stream->slot.data(), stream->flags, stream->timeNs, timeoutUs);
+            if (ret <= 0) return ret;
+            stream->offset = 0;
+            stream->remaining = size_t(ret);
+        }
+
+        const size_t n = std::min(numElems, stream->remaining);
+        for (size_t i = 0; i < stream->channels.size(); i++)
+        {
+            const char *in = reinterpret_cast<const char *>(stream->slot[stream->channels[i]]);
+            std::memcpy(buffs[i], in + stream->offset*stream->elemSize, n*stream->elemSize);
+        }
+
+        //the timestamp and end of burst follow the part of the buffer that is read
+        flags = stream->flags;
+        timeNs = stream->timeNs;
+        if ((flags & SOAPY_SDR_HAS_TIME) != 0) timeNs += SoapySDR::ticksToTimeNs((long long)(stream->offset), stream->rate);
+        stream->offset += n;
+        stream->remaining -= n;
+        if (stream->remaining != 0) flags = (flags & ~SOAPY_SDR_END_BURST) | SOAPY_SDR_MORE_FRAGMENTS;
+        else stream->reader->release(stream->handle);
+        return int(n);
+    }
+
+    /*******************************************************************
+     * Direct buffer access API
+     ******************************************************************/
+    size_t getNumDirectAccessBuffers(SoapySDR::Stream *handle)
+    {
+        return reinterpret_cast<BrokerStream *>(handle)->reader->numBuffers();
+    }
+
+    int getDirectAccessBufferAddrs(SoapySDR::Stream *handle, const size_t index, void **buffs)
+    {
+        auto stream = reinterpret_cast<BrokerStream *>(handle);
+        if (index >= stream->reader->numBuffers()) return SOAPY_SDR_STREAM_ERROR;
+        std::vector<const void *> slot(_numChannels);
+        stream->reader->bufferAddrs(index, slot.data());
+        for (size_t i = 0; i < stream->channels.size(); i++) buffs[i] = const_cast<void *>(slot[stream->channels[i]]);
+        return 0;
+    }
+
+    int acquireReadBuffer(SoapySDR::Stream *handle, size_t &index, const void **buffs, int &flags, long long &timeNs, const long timeoutUs)
+    {
+        auto stream = reinterpret_cast<BrokerStream *>(handle);
+        if (not stream->active)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(timeoutUs));
+            return SOAPY_SDR_TIMEOUT;
+        }
+        const int ret = stream->reader->acquire(index, stream->direct.data(), flags, timeNs, timeoutUs);
+        if (ret <= 0) return ret;
+        for (size_t i = 0; i < stream->channels.size(); i++) buffs[i] = stream->direct[stream->channels[i]];
+        return ret;
+    }
+
+    void releaseReadBuffer(SoapySDR::Stream *handle, const size_t index)
+    {
+        reinterpret_cast<BrokerStream *>(handle)->reader->release(index);
+    }
+
+    /*******************************************************************
+     * Frequency and sample rate API
+     ******************************************************************/
+    std::vector<std::string> listAntennas(const int, const size_t) const
+    {
+        return std::vector<std::string>(1, "RX");
+    }
+
+    std::string getAntenna(const int, const size_t) const
+    {
+        return "RX";
+    }
+
+    void setFrequency(const int, const size_t, const std::string &, const double frequency, const SoapySDR::Kwargs &)
+    {
+        if (frequency != _frequency) throw std::runtime_error("BrokerDevice::setFrequency() the broker owns the tuning");
+    }
+
+    double getFrequency(const int, const size_t, const std::string &) const
+    {
+        return _frequency;
+    }
+
+    std::vector<std::string> listFrequencies(const int, const size_t) const
+    {
+        return std::vector<std::string>(1, "RF");
+    }
+
+    SoapySDR::RangeList getFrequencyRange(const int, const size_t, const std::string &) const
+    {
+        return SoapySDR::RangeList(1, SoapySDR::Range(_frequency, _frequency));
+    }
+
+    void setSampleRate(const int, const size_t, const double rate)
+    {
+        if (rate != _rate) throw std::runtime_error("BrokerDevice::setSampleRate() the broker owns the sample rate");
+    }
+
+    double getSampleRate(const int, const size_t) const
+    {
+        return _rate;
+    }
+
+    SoapySDR::RangeList getSampleRateRange(const int, const size_t) const
+    {
+        return SoapySDR::RangeList(1, SoapySDR::Range(_rate, _rate));
+    }
+
+private:
+
+    void releasePartial(BrokerStream *stream)
+    {
+        if (stream->remaining != 0) stream->reader->release(stream->handle);
+        stream->remaining = 0;
+    }
+
+    const std::string _name;
+    std::string _format;
+    double _fullScale;
+    size_t _numChannels;
+    std::string _hardware;
+    long long _ownerPid;
+    std::atomic<double> _rate;
+    std::atomic<double> _frequency;
+};
+
+/***********************************************************************
+ * Find available devices
+ **********************************************************************/
+SoapySDR::KwargsList findBrokerDevice(const SoapySDR::Kwargs &args)
+{
+    SoapySDR::KwargsList results;
+
+    //require that the user specify the broker name
+    if (args.count("name") == 0) return results;
+    if (args.count("driver") != 0 and args.at("driver") != "broker") return results;
+
+    try
+    {
+        const SoapySDR::BrokerReader reader(args.at("name"));
+        SoapySDR::Kwargs brokerArgs;
+        brokerArgs["driver"] = "broker";
+        brokerArgs["name"] = args.at("name");
+        brokerArgs["label"] = "Broker " + args.at("name") + " (" + reader.hardwareKey() + ")";
+        results.push_back(brokerArgs);
+    }
+    catch (const std::exception &)
+    {
+        //no running broker by that name
+    }
+
+    return results;
+}
+
+/***********************************************************************
+ * Make device instance
+ **********************************************************************/
+SoapySDR::Device *makeBrokerDevice(const SoapySDR::Kwargs &args)
+{
+    return new BrokerDevice(args);
+}
+
+/***********************************************************************
+ * Registration
+ **********************************************************************/
+static SoapySDR::Registry registerBrokerDevice("broker", &findBrokerDevice, &makeBrokerDevice, SOAPY_SDR_ABI_VERSION);
@@ -0,0 +1,476 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/Device.hpp>
+#include <SoapySDR/Registry.hpp>
+#include <SoapySDR/Recording.hpp>
+#include <SoapySDR/ConverterRegistry.hpp>
+#include <SoapySDR/Formats.hpp>
+#include <SoapySDR/Time.hpp>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <memory>
+
+/***********************************************************************
+ * A receive only device that streams a recording from a file.
+ *
+ * Device arguments:
+ *  - file: a SigMF recording, or a raw file with the format argument
+ *  - format: the sample format of a raw file
+ *  - paced: true (default) to stream at the sample rate, false to run unthrottled
+ *  - loop: true to repeat the recording, false (default) to end the burst
+ *  - mtu: the default stream MTU in elements, also a stream argument
+ *
+ * The file is memory mapped. Reads in the file format copy from the mapped
+ * pages and direct buffer reads hand out the mapped pages without a copy.
+ * Stream timestamps follow the capture times of the SigMF metadata,
+ * or count samples from zero when the recording has none.
+ **********************************************************************/
+static const size_t numDirectBuffs = 4;
+
+struct ReplayStream
+{
+    std::string format;
+    size_t elemSize;
+    size_t mtu;
+
+    //samples are converted from the file format unless the formats match
+    SoapySDR::ConverterRegistry::ConverterFunction fromFile;
+
+    //the read position in samples and the number of wraps
+    bool active;
+    size_t pos;
+    long long loops;
+    size_t burstRemaining;
+
+    //paced streams deliver samples at the rate since activation
+    std::chrono::steady_clock::time_point epoch;
+    long long delivered;
+
+    //direct access buffers hold converted samples when the formats differ
+    std::vector<std::vector<char>> directMem;
+    std::vector<bool> directInUse;
+    size_t directNext;
+};
+
+static double formatFullScale(const std::string &format)
+{
+    if (format.find('F') != std::string::npos) return 1.0;
+    const size_t bits = SoapySDR::formatToSize(format)*8/((format[0] == 'C')?2:1);
+    return double(1ull << (bits-1));
+}
+
+class ReplayDevice : public SoapySDR::Device
+{
+public:
+    ReplayDevice(const SoapySDR::Kwargs &args):
+        _recording(args.at("file"), (args.count("format") != 0)?args.at("format"):""),
+        _fileSize(SoapySDR::formatToSize(_recording.meta().format)),
+        _paced(args.count("paced") == 0 or args.at("paced") == "true"),
+        _loop(args.count("loop") != 0 and args.at("loop") == "true"),
+        _mtu(4096),
+        _rate(_recording.meta().sampleRate),
+        _frequency(0.0),
+        _timeNs(0)
+    {
+        if (args.count("mtu") != 0) _mtu = std::max<size_t>(1, std::stoul(args.at("mtu")));
+        if (not (_rate > 0.0)) _rate = 1e6;
+        const auto &captures = _recording.meta().captures;
+        if (not captures.empty()) _frequency = captures.front().frequency;
+    }
+
+    /*******************************************************************
+     * Identification API
+     ******************************************************************/
+    std::string getDriverKey(void) const
+    {
+        return "replay";
+    }
+
+    std::string getHardwareKey(void) const
+    {
+        const auto &hardware = _recording.meta().hardware;
+        return hardware.empty()?"replay":hardware;
+    }
+
+    SoapySDR::Kwargs getHardwareInfo(void) const
+    {
+        SoapySDR::Kwargs info;
+        info["file"] = _recording.dataPath();
+        info["format"] = _recording.meta().format;
+        info["samples"] = std::to_string(_recording.numElems());
+        if (not _recording.meta().description.empty()) info["description"] = _recording.meta().description;
+        return info;
+    }
+
+    /*******************************************************************
+     * Channels API
+     ******************************************************************/
+    size_t getNumChannels(const int direction) const
+    {
+        return (direction == SOAPY_SDR_RX)?1:0;
+    }
+
+    /*******************************************************************
+     * Stream API
+     ******************************************************************/
+    std::vector<std::string> getStreamFormats(const int, const size_t) const
+    {
+        const auto &fileFormat = _recording.meta().format;
+        std::vector<std::string> formats(1, fileFormat);
+        for (const auto &format : SoapySDR::ConverterRegistry::listTargetFormats(fileFormat))
+        {
+            if (format != fileFormat) formats.push_back(format);
+        }
+        return formats;
+    }
+
+    std::string getNativeStreamFormat(const int, const size_t, double &fullScale) const
+    {
+        fullScale = formatFullScale(_recording.meta().format);
+        return _recording.meta().format;
+    }
+
+    SoapySDR::ArgInfoList getStreamArgsInfo(const int, const size_t) const
+    {
+        SoapySDR::ArgInfo mtuArg;
+        mtuArg.key = "mtu";
+        mtuArg.value = std::to_string(_mtu);
+        mtuArg.name = "MTU";
+        mtuArg.description = "The maximum number of elements per stream call";
+        mtuArg.units = "elements";
+        mtuArg.type = SoapySDR::ArgInfo::INT;
+        return SoapySDR::ArgInfoList(1, mtuArg);
+    }
+
+    SoapySDR::Stream *setupStream(const int direction, const std::string &format, const std::vector<size_t> &channels, const SoapySDR::Kwargs &args)
+    {
+        if (direction != SOAPY_SDR_RX) throw std::runtime_error("ReplayDevice::setupStream() only RX is supported");
+        if (channels.size() > 1 or (channels.size() == 1 and channels.front() != 0))
+        {
+            throw std::runtime_error("ReplayDevice::setupStream() only channel 0 is supported");
+        }
+
+        std::unique_ptr<ReplayStream> stream(new ReplayStream());
+        stream->format = format;
+        stream->elemSize = SoapySDR::formatToSize(format);
+        stream->mtu = (args.count("mtu") != 0)?std::max<size_t>(1, std::stoul(args.at("mtu"))):_mtu;
+        const auto &fileFormat = _recording.meta().format;
+        stream->fromFile = (format == fileFormat)?nullptr:SoapySDR::ConverterRegistry::getFunction(fileFormat, format);
+        stream->active = false;
+        stream->pos = 0;
+        stream->loops = 0;
+        stream->burstRemaining = 0;
+        stream->delivered = 0;
+        if (stream->fromFile != nullptr)
+        {
+            stream->directMem.resize(numDirectBuffs, std::vector<char>(stream->mtu*stream->elemSize));
+        }
+        stream->directInUse.assign(numDirectBuffs, false);
+        stream->directNext = 0;
+        return reinterpret_cast<SoapySDR::Stream *>(stream.release());
+    }
+
+    void closeStream(SoapySDR::Stream *handle)
+    {
+        delete reinterpret_cast<ReplayStream *>(handle);
+    }
+
+    size_t getStreamMTU(SoapySDR::Stream *handle) const
+    {
+        return reinterpret_cast<ReplayStream *>(handle)->mtu;
+    }
+
+    int activateStream(SoapySDR::Stream *handle, const int, const long long, const size_t numElems)
+    {
+        auto stream = reinterpret_cast<ReplayStream *>(handle);
+        stream->epoch = std::chrono::steady_clock::now();
+        stream->delivered = 0;
+        stream->burstRemaining = numElems;
+        stream->active = true;
+        return 0;
+    }
+
+    int deactivateStream(SoapySDR::Stream *handle, const int, const long long)
+    {
+        reinterpret_cast<ReplayStream *>(handle)->active = false;
+        return 0;
+    }
+
+    int readStream(SoapySDR::Stream *handle, void * const *buffs, const size_t numElems, int &flags, long long &timeNs, const long timeoutUs)
+    {
+        auto stream = reinterpret_cast<ReplayStream *>(handle);
+        const char *in(nullptr);
+        const int ret = this->nextSamples(stream, numElems, in, flags, timeNs, timeoutUs);
+        if (ret <= 0) return ret;
+        if (stream->fromFile == nullptr) std::memcpy(buffs[0], in, size_t(ret)*_fileSize);
+        else stream->fromFile(in, buffs[0], size_t(ret), 1.0);
+        return ret;
+    }
+
+    /*******************************************************************
+     * Direct buffer access API
+     ******************************************************************/
+    size_t getNumDirectAccessBuffers(SoapySDR::Stream *)
+    {
+        return numDirectBuffs;
+    }
+
+    int getDirectAccessBufferAddrs(SoapySDR::Stream *handle, const size_t index, void **buffs)
+    {
+        //buffers in the file format are the mapped pages, which move with each read
+        auto stream = reinterpret_cast<ReplayStream *>(handle);
+        if (stream->fromFile == nullptr) return SOAPY_SDR_NOT_SUPPORTED;
+        if (index >= numDirectBuffs) return SOAPY_SDR_STREAM_ERROR;
+        buffs[0] = stream->directMem[index].data();
+        return 0;
+    }
+
+    int acquireReadBuffer(SoapySDR::Stream *handle, size_t &index, const void **buffs, int &flags, long long &timeNs, const long timeoutUs)
+    {
+        auto stream = reinterpret_cast<ReplayStream *>(handle);
+        if (not this->acquireDirect(stream, index)) return SOAPY_SDR_STREAM_ERROR;
+        const char *in(nullptr);
+        const int ret = this->nextSamples(stream, stream->mtu, in, flags, timeNs, timeoutUs);
+        if (ret <= 0)
+        {
+            stream->directInUse[index] = false;
+            return ret;
+        }
+        if (stream->fromFile == nullptr) buffs[0] = in;
+        else
+        {
+            stream->fromFile(in, stream->directMem[index].data(), size_t(ret), 1.0);
+            buffs[0] = stream->directMem[index].data();
+        }
+        return ret;
+    }
+
+    void releaseReadBuffer(SoapySDR::Stream *handle, const size_t index)
+    {
+        auto stream = reinterpret_cast<ReplayStream *>(handle);
+        if (index < numDirectBuffs) stream->directInUse[index] = false;
+    }
+
+    /*******************************************************************
+     * Antenna, frequency, and sample rate API
+     ******************************************************************/
+    std::vector<std::string> listAntennas(const int, const size_t) const
+    {
+        return std::vector<std::string>(1, "RX");
+    }
+
+    std::string getAntenna(const int, const size_t) const
+    {
+        return "RX";
+    }
+
+    void setFrequency(const int, const size_t, const std::string &, const double frequency, const SoapySDR::Kwargs &)
+    {
+        _frequency = frequency;
+    }
+
+    double getFrequency(const int, const size_t, const std::string &) const
+    {
+        return _frequency;
+    }
+
+    std::vector<std::string> listFrequencies(const int, const size_t) const
+    {
+        return std::vector<std::string>(1, "RF");
+    }
+
+    SoapySDR::RangeList getFrequencyRange(const int, const size_t, const std::string &) const
+    {
+        return SoapySDR::RangeList(1, SoapySDR::Range(0.0, 1e12));
+    }
+
+    //a different rate replays the recording faster or slower than it was captured
+    void setSampleRate(const int, const size_t, const double rate)
+    {
+        if (not (rate > 0.0)) throw std::invalid_argument("ReplayDevice::setSampleRate() rate must be positive");
+        _rate = rate;
+    }
+
+    double getSampleRate(const int, const size_t) const
+    {
+        return _rate;
+    }
+
+    SoapySDR::RangeList getSampleRateRange(const int, const size_t) const
+    {
+        return SoapySDR::RangeList(1, SoapySDR::Range(1.0, 1e9));
+    }
+
+    /*******************************************************************
+     * Time API
+     ******************************************************************/
+    bool hasHardwareTime(const std::string &what) const
+    {
+        return what.empty();
+    }
+
+    //the time of the next sample in the recording
+    long long getHardwareTime(const std::string & = "") const
+    {
+        return _timeNs;
+    }
+
+private:
+
+    //the time of a sample from the capture that it belongs to
+    long long timeAt(const size_t pos, const long long loops) const
+    {
+        const SoapySDR::SigMFMeta::Capture *capture(nullptr);
+        for (const auto &c : _recording.meta().captures)
+        {
+            if (c.sampleStart > pos) break;
+            capture = &c;
+        }
+        const double rate = (_recording.meta().sampleRate > 0.0)?_recording.meta().sampleRate:double(_rate);
+        long long timeNs = loops*SoapySDR::ticksToTimeNs((long long)(_recording.numElems()), rate);
+        if (capture != nullptr and capture->hasTime) timeNs += capture->timeNs + SoapySDR::ticksToTimeNs((long long)(pos - capture->sampleStart), rate);
+        else timeNs += SoapySDR::ticksToTimeNs((long long)(pos), rate);
+        return timeNs;
+    }
+
+    //the end of the capture that a sample belongs to
+    size_t captureEnd(const size_t pos) const
+    {
+        for (const auto &c : _recording.meta().captures)
+        {
+            if (c.sampleStart > pos) return std::min(size_t(c.sampleStart), _recording.numElems());
+        }
+        return _recording.numElems();
+    }
+
+    //the next run of mapped samples, within one capture so that the timestamp holds for the run
+    int nextSamples(ReplayStream *stream, const size_t numElems, const char *&in, int &flags, long long &timeNs, const long timeoutUs)
+    {
+        flags = 0;
+        const auto exit = std::chrono::steady_clock::now() + std::chrono::microseconds(timeoutUs);
+        if (not stream->active)
+        {
+            std::this_thread::sleep_until(exit);
+            return SOAPY_SDR_TIMEOUT;
+        }
+
+        size_t n = std::min(std::min(numElems, stream->mtu), this->captureEnd(stream->pos) - stream->pos);
+        if (stream->burstRemaining != 0) n = std::min(n, stream->burstRemaining);
+
+        //paced streams deliver the samples whose time has passed by the timeout
+        if (_paced)
+        {
+            const double rate = _rate;
+            const auto due = [&](const long long count)
+            {
+                return stream->epoch + std::chrono::nanoseconds(SoapySDR::ticksToTimeNs(count, rate));
+            };
+            if (due(stream->delivered + (long long)(n)) > exit)
+            {
+                const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(exit - stream->epoch).count();
+                const long long available = SoapySDR::timeNsToTicks(elapsed, rate) - stream->delivered;
+                if (available <= 0)
+                {
+                    std::this_thread::sleep_until(exit);
+                    return SOAPY_SDR_TIMEOUT;
+                }
+                n = std::min(n, size_t(available));
+            }
+            std::this_thread::sleep_until(due(stream->delivered + (long long)(n)));
+        }
+
+        in = reinterpret_cast<const char *>(_recording.data()) + stream->pos*_fileSize;
+        flags |= SOAPY_SDR_HAS_TIME;
+        timeNs = this->timeAt(stream->pos, stream->loops);
+        stream->pos += n;
+        stream->delivered += (long long)(n);
+        _timeNs = this->timeAt(stream->pos, stream->loops);
+
+        //wrap around or end the burst at the end of the recording
+        if (stream->pos == _recording.numElems())
+        {
+            stream->pos = 0;
+            stream->loops++;
+            if (not _loop) stream->burstRemaining = n;
+        }
+        if (stream->burstRemaining != 0)
+        {
+            stream->burstRemaining -= n;
+            if (stream->burstRemaining == 0)
+            {
+                flags |= SOAPY_SDR_END_BURST;
+                stream->active = false;
+            }
+        }
+        return int(n);
+    }
+
+    bool acquireDirect(ReplayStream *stream, size_t &index)
+    {
+        for (size_t i = 0; i < numDirectBuffs; i++)
+        {
+            const size_t next = (stream->directNext + i) % numDirectBuffs;
+            if (stream->directInUse[next]) continue;
+            stream->directInUse[next] = true;
+            stream->directNext = (next + 1) % numDirectBuffs;
+            index = next;
+            return true;
+        }
+        return false;
+    }
+
+    const SoapySDR::MappedRecording _recording;
+    const size_t _fileSize;
+    const bool _paced;
+    const bool _loop;
+    size_t _mtu;
+    std::atomic<double> _rate;
+    std::atomic<double> _frequency;
+    std::atomic<long long> _timeNs;
+};
+
+/***********************************************************************
+ * Find available devices
+ **********************************************************************/
+SoapySDR::KwargsList findReplayDevice(const SoapySDR::Kwargs &args)
+{
+    SoapySDR::KwargsList results;
+
+    //require that the user specify a file to replay
+    if (args.count("file") == 0) return results;
+    if (args.count("driver") != 0 and args.at("driver") != "replay") return results;
+
+    try
+    {
+        const SoapySDR::MappedRecording recording(args.at("file"), (args.count("format") != 0)?args.at("format"):"");
+        SoapySDR::Kwargs replayArgs;
+        replayArgs["driver"] = "replay";
+        replayArgs["file"] = args.at("file");
+        replayArgs["label"] = "Replay " + recording.dataPath();
+        results.push_back(replayArgs);
+    }
+    catch (const std::exception &)
+    {
+        //not a readable recording
+    }
+
+    return results;
+}
+
+/***********************************************************************
+ * Make device instance
+ **********************************************************************/
+SoapySDR::Device *makeReplayDevice(const SoapySDR::Kwargs &args)
+{
+    return new ReplayDevice(args);
+}
+
+/***********************************************************************
+ * Registration
+ **********************************************************************/
+static SoapySDR::Registry registerReplayDevice("replay", &findReplayDevice, &makeReplayDevice, SOAPY_SDR_ABI_VERSION);
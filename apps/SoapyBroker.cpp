@@ -0,0 +1,86 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/Device.hpp>
+#include <SoapySDR/Broker.hpp>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <csignal>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <cstdio>
+
+static std::atomic<bool> brokerDone(false);
+static void sigIntHandlerBroker(const int)
+{
+    brokerDone = true;
+}
+
+int SoapySDRBroker(
+    const std::string &argStr,
+    const double sampleRate,
+    const double frequency,
+    const std::string &channelStr,
+    const std::string &name,
+    const std::string &format,
+    const std::string &streamArgs,
+    const double duration)
+{
+    SoapySDR::Device *device(nullptr);
+    int status = EXIT_FAILURE;
+
+    try
+    {
+        device = SoapySDR::Device::make(argStr);
+
+        //every channel of the list is published, the first by default
+        std::vector<size_t> channels;
+        for (const auto &pair : SoapySDR::KwargsFromString(channelStr)) channels.push_back(std::stoul(pair.first));
+        if (channels.empty()) channels.push_back(0);
+        for (const auto chan : channels)
+        {
+            if (sampleRate != 0.0) device->setSampleRate(SOAPY_SDR_RX, chan, sampleRate);
+            if (frequency != 0.0) device->setFrequency(SOAPY_SDR_RX, chan, frequency);
+        }
+
+        auto args = SoapySDR::KwargsFromString(streamArgs);
+        if (not format.empty()) args["format"] = format;
+
+        SoapySDR::Broker broker(device, channels, name, args);
+        const double rate = device->getSampleRate(SOAPY_SDR_RX, channels.front());
+        std::cout << "Publishing " << channels.size() << " channel(s) at " << (rate/1e6) << " Msps as broker " << name << std::endl;
+        std::cout << "Attach with --args=\"driver=broker,name=" << name << "\", press Ctrl+C to stop..." << std::endl;
+
+        signal(SIGINT, sigIntHandlerBroker);
+        broker.start();
+        const auto exitTime = std::chrono::high_resolution_clock::now() + std::chrono::microseconds((long long)(duration*1e6));
+        auto timeLastPrint = std::chrono::high_resolution_clock::now();
+        while (not brokerDone)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            const auto now = std::chrono::high_resolution_clock::now();
+            if (duration > 0.0 and now > exitTime) break;
+            if (timeLastPrint + std::chrono::seconds(1) > now) continue;
+            timeLastPrint = now;
+            const auto readers = broker.readers();
+            printf("%llu buffers\tOverflows %llu\tReaders %d\n", broker.numBuffers(), broker.numOverflows(), int(readers.size()));
+            for (const auto &reader : readers)
+            {
+                printf("  pid %lld\tLag %llu\tOverflows %llu\tDropped %llu\n", reader.pid, reader.lag, reader.numOverflows, reader.numDropped);
+            }
+        }
+        broker.stop();
+        printf("Published %llu buffers\tOverflows %llu\n", broker.numBuffers(), broker.numOverflows());
+        status = EXIT_SUCCESS;
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << "Error in broker: " << ex.what() << std::endl;
+    }
+    SoapySDR::Device::unmake(device);
+    return status;
+}
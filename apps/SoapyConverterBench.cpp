@@ -0,0 +1,122 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/ConverterRegistry.hpp>
+#include <SoapySDR/Formats.hpp>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+
+//buffer sizes in elements from L1 resident to DRAM bound
+static const size_t benchSizes[] = {256, 4096, 65536, 1 << 20, 1 << 22};
+
+//minimum measurement time for each source/target/priority/size
+static const double minBenchSeconds = 0.02;
+
+struct ConverterBenchResult
+{
+    std::string source;
+    std::string target;
+    SoapySDR::ConverterRegistry::FunctionPriority priority;
+    size_t numElems;
+    size_t bytesPerCall;
+    double msps;
+    double gbps;
+};
+
+static std::string priorityToString(const SoapySDR::ConverterRegistry::FunctionPriority priority)
+{
+    switch (priority)
+    {
+    case SoapySDR::ConverterRegistry::GENERIC: return "GENERIC";
+    case SoapySDR::ConverterRegistry::VECTORIZED: return "VECTORIZED";
+    case SoapySDR::ConverterRegistry::CUSTOM: return "CUSTOM";
+    }
+    return std::to_string(int(priority));
+}
+
+static ConverterBenchResult benchConverter(
+    const std::string &source,
+    const std::string &target,
+    const SoapySDR::ConverterRegistry::FunctionPriority priority,
+    const size_t numElems)
+{
+    const auto converter = SoapySDR::ConverterRegistry::getConverter(source, target, priority);
+    std::vector<char> srcBuff(numElems*converter.sourceElemSize);
+    std::vector<char> dstBuff(numElems*converter.targetElemSize);
+
+    //warm up the caches and page in the buffers
+    converter(srcBuff.data(), dstBuff.data(), numElems);
+
+    unsigned long long numCalls(0);
+    double elapsed(0.0);
+    const auto startTime = std::chrono::high_resolution_clock::now();
+    while (elapsed < minBenchSeconds)
+    {
+        converter(srcBuff.data(), dstBuff.data(), numElems);
+        numCalls++;
+        elapsed = std::chrono::duration<double>(std::chrono::high_resolution_clock::now()-startTime).count();
+    }
+
+    ConverterBenchResult result;
+    result.source = source;
+    result.target = target;
+    result.priority = priority;
+    result.numElems = numElems;
+    result.bytesPerCall = srcBuff.size() + dstBuff.size();
+    result.msps = (numCalls*numElems)/elapsed/1e6;
+    result.gbps = (numCalls*result.bytesPerCall)/elapsed/1e9;
+    return result;
+}
+
+/***********************************************************************
+ * Time every registered converter and print CSV or JSON results
+ **********************************************************************/
+int SoapySDRConverterBench(const std::string &formatStr)
+{
+    const bool json = (formatStr == "json");
+    if (not json and not formatStr.empty() and formatStr != "csv")
+    {
+        std::cerr << "Unknown output format " << formatStr << ", use csv or json" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    std::vector<ConverterBenchResult> results;
+    for (const auto &source : SoapySDR::ConverterRegistry::listAvailableSourceFormats())
+    {
+        for (const auto &target : SoapySDR::ConverterRegistry::listTargetFormats(source))
+        {
+            for (const auto priority : SoapySDR::ConverterRegistry::listPriorities(source, target))
+            {
+                for (const auto numElems : benchSizes)
+                {
+                    results.push_back(benchConverter(source, target, priority, numElems));
+                    if (json) continue;
+                    const auto &r = results.back();
+                    if (results.size() == 1) std::cout << "source,target,priority,elements,bytes,msps,gbps" << std::endl;
+                    std::cout << r.source << "," << r.target << "," << priorityToString(r.priority) << ","
+                        << r.numElems << "," << r.bytesPerCall << ","
+                        << std::fixed << std::setprecision(3) << r.msps << "," << r.gbps << std::endl;
+                }
+            }
+        }
+    }
+
+    if (not json) return EXIT_SUCCESS;
+
+    std::cout << "[" << std::endl;
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        const auto &r = results[i];
+        std::cout << "  {\"source\": \"" << r.source << "\", \"target\": \"" << r.target
+            << "\", \"priority\": \"" << priorityToString(r.priority)
+            << "\", \"elements\": " << r.numElems << ", \"bytes\": " << r.bytesPerCall
+            << ", \"msps\": " << std::fixed << std::setprecision(3) << r.msps
+            << ", \"gbps\": " << r.gbps << "}" << ((i+1 == results.size())?"":",") << std::endl;
+    }
+    std::cout << "]" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,83 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/Device.hpp>
+#include <SoapySDR/Recording.hpp>
+#include <string>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <csignal>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <cstdio>
+
+static std::atomic<bool> playDone(false);
+static void sigIntHandlerPlay(const int)
+{
+    playDone = true;
+}
+
+int SoapySDRPlay(
+    const std::string &argStr,
+    const double sampleRate,
+    const double frequency,
+    const std::string &channelStr,
+    const std::string &path,
+    const std::string &format,
+    const std::string &streamArgs,
+    const double duration,
+    const bool loop)
+{
+    SoapySDR::Device *device(nullptr);
+    int status = EXIT_FAILURE;
+
+    try
+    {
+        device = SoapySDR::Device::make(argStr);
+
+        //the first channel of the list is played to
+        const auto channels = SoapySDR::KwargsFromString(channelStr);
+        const size_t channel = channels.empty()?0:std::stoul(channels.begin()->first);
+
+        auto args = SoapySDR::KwargsFromString(streamArgs);
+        if (not format.empty()) args["format"] = format;
+        if (loop) args["loop"] = "true";
+        SoapySDR::Player player(device, channel, path, args);
+
+        //the recording rate unless one was given
+        const auto &meta = player.recording().meta();
+        const double rate = (sampleRate != 0.0)?sampleRate:meta.sampleRate;
+        const double freq = (frequency != 0.0 or meta.captures.empty())?frequency:meta.captures.front().frequency;
+        if (rate != 0.0) device->setSampleRate(SOAPY_SDR_TX, channel, rate);
+        if (freq != 0.0) device->setFrequency(SOAPY_SDR_TX, channel, freq);
+
+        std::cout << "Playing " << player.recording().dataPath() << " (" << player.recording().numElems() << " " << meta.format
+            << " samples) to channel " << channel << " at " << (device->getSampleRate(SOAPY_SDR_TX, channel)/1e6) << " Msps" << std::endl;
+        std::cout << "Press Ctrl+C to stop..." << std::endl;
+
+        signal(SIGINT, sigIntHandlerPlay);
+        player.start();
+        const auto timeStart = std::chrono::high_resolution_clock::now();
+        auto timeLastPrint = timeStart;
+        while (not playDone and not player.done())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            const auto now = std::chrono::high_resolution_clock::now();
+            if (duration > 0.0 and std::chrono::duration<double>(now - timeStart).count() >= duration) break;
+            if (timeLastPrint + std::chrono::seconds(1) > now) continue;
+            timeLastPrint = now;
+            printf("%llu samples\tLoops %llu\tUnderflows %llu\n", player.numSamples(), player.numLoops(), player.numUnderflows());
+        }
+        player.stop();
+        printf("Played %llu samples\tLoops %llu\tUnderflows %llu\n", player.numSamples(), player.numLoops(), player.numUnderflows());
+        status = EXIT_SUCCESS;
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << "Error in play: " << ex.what() << std::endl;
+    }
+    SoapySDR::Device::unmake(device);
+    return status;
+}
@@ -1,90 +1,245 @@
-// Copyright (c) 2016-2017 Josh Blum
+// Copyright (c) 2016-2018 Josh Blum
 // SPDX-License-Identifier: BSL-1.0
 
+#include "SoapyRateTest.hpp"
 #include <SoapySDR/Device.hpp>
 #include <SoapySDR/Formats.hpp>
 #include <SoapySDR/Errors.hpp>
+#include <SoapySDR/ThreadHints.hpp>
+#include <SoapySDR/Buffers.hpp>
+#include <SoapySDR/Time.hpp>
 #include <string>
+#include <vector>
+#include <memory>
 #include <cstdlib>
 #include <iostream>
+#include <iomanip>
 #include <stdexcept>
+#include <algorithm>
 #include <csignal>
 #include <chrono>
+#include <thread>
+#include <atomic>
 #include <cstdio>
+#include <ctime>
+#include <cmath>
 
-static sig_atomic_t loopDone = false;
+static std::atomic<bool> loopDone(false);
 void sigIntHandler(const int)
 {
     loopDone = true;
 }
 
-void runRateTestStreamLoop(
-    SoapySDR::Device *device,
-    SoapySDR::Stream *stream,
-    const int direction,
-    const size_t numChans,
-    const size_t elemSize)
+/***********************************************************************
+ * Log scale latency histogram with 8 bins per octave,
+ * percentiles are accurate to the bin width of about 9%.
+ **********************************************************************/
+class RateTestHistogram
 {
-    //allocate buffers for the stream read/write
-    const size_t numElems = device->getStreamMTU(stream);
-    std::vector<std::vector<char>> buffMem(numChans, std::vector<char>(elemSize*numElems));
-    std::vector<void *> buffs(numChans);
-    for (size_t i = 0; i < numChans; i++) buffs[i] = buffMem[i].data();
-
-    //state collected in this loop
-    unsigned int overflows(0);
-    unsigned int underflows(0);
-    unsigned long long totalSamples(0);
-    const auto startTime = std::chrono::high_resolution_clock::now();
-    auto timeLastPrint = std::chrono::high_resolution_clock::now();
-    auto timeLastSpin = std::chrono::high_resolution_clock::now();
-    auto timeLastStatus = std::chrono::high_resolution_clock::now();
-    int spinIndex(0);
+public:
+    RateTestHistogram(void):
+        _bins(64*binsPerOctave, 0),
+        _count(0),
+        _minNs(0),
+        _maxNs(0),
+        _sumNs(0.0)
+    {
+        return;
+    }
 
-    std::cout << "Starting stream loop, press Ctrl+C to exit..." << std::endl;
-    device->activateStream(stream);
-    signal(SIGINT, sigIntHandler);
-    while (not loopDone)
+    void add(const long long ns)
     {
-        int ret(0);
-        int flags(0);
-        long long timeNs(0);
-        switch(direction)
+        const size_t index = (ns <= 1)?0:std::min(_bins.size()-1, size_t(std::log2(double(ns))*binsPerOctave));
+        _bins[index]++;
+        if (_count == 0 or ns < _minNs) _minNs = ns;
+        if (_count == 0 or ns > _maxNs) _maxNs = ns;
+        _sumNs += ns;
+        _count++;
+    }
+
+    unsigned long long count(void) const
+    {
+        return _count;
+    }
+
+    double minUs(void) const
+    {
+        return _minNs/1e3;
+    }
+
+    double maxUs(void) const
+    {
+        return _maxNs/1e3;
+    }
+
+    double meanUs(void) const
+    {
+        return (_count == 0)?0.0:(_sumNs/_count/1e3);
+    }
+
+    //the upper edge of the bin holding the percentile, clipped to the maximum
+    double percentileUs(const double p) const
+    {
+        const auto target = (unsigned long long)(std::ceil(p*_count));
+        unsigned long long total(0);
+        for (size_t i = 0; i < _bins.size(); i++)
         {
-        case SOAPY_SDR_RX:
-            ret = device->readStream(stream, buffs.data(), numElems, flags, timeNs);
-            break;
-        case SOAPY_SDR_TX:
-            ret = device->writeStream(stream, buffs.data(), numElems, flags, timeNs);
-            break;
+            total += _bins[i];
+            if (total < target or total == 0) continue;
+            const double upperNs = std::pow(2.0, double(i+1)/binsPerOctave);
+            return std::max(std::min(upperNs, double(_maxNs)), double(_minNs))/1e3;
         }
+        return this->maxUs();
+    }
+
+private:
+    static const size_t binsPerOctave = 8;
+    std::vector<unsigned long long> _bins;
+    unsigned long long _count;
+    long long _minNs;
+    long long _maxNs;
+    double _sumNs;
+};
+
+/***********************************************************************
+ * One stream under test, run from its own thread
+ **********************************************************************/
+struct RateTestStream
+{
+    RateTestStream(void):
+        device(nullptr),
+        stream(nullptr),
+        deviceIndex(0),
+        direction(SOAPY_SDR_RX),
+        cpu(-1),
+        numChans(0),
+        elemSize(0),
+        numElems(0),
+        sampleRate(0.0),
+        txStartNs(0),
+        ok(true),
+        totalSamples(0),
+        overflows(0),
+        underflows(0),
+        drops(0),
+        timeouts(0)
+    {
+        return;
+    }
+
+    SoapySDR::Device *device;
+    SoapySDR::Stream *stream;
+    size_t deviceIndex;
+    int direction;
+    int cpu;
+    std::string format;
+    size_t numChans;
+    size_t elemSize;
+    size_t numElems;
+    double sampleRate;
+    long long txStartNs;
+    std::atomic<bool> ok;
+
+    //counters read by the main thread while the stream runs
+    std::atomic<unsigned long long> totalSamples;
+    std::atomic<unsigned long long> overflows;
+    std::atomic<unsigned long long> underflows;
+    std::atomic<unsigned long long> drops;
+    std::atomic<unsigned long long> timeouts;
+
+    //call latencies, read once the stream thread exits
+    RateTestHistogram latency;
 
-        if (ret == SOAPY_SDR_TIMEOUT) continue;
+    //the timestamp latency from getStreamStats()
+    SoapySDR::StreamStats stats;
+
+    //placement of the stream thread and its buffers
+    SoapySDR::ThreadHints hints;
+    SoapySDR::BufferPool buffers;
+};
+
+static const char *directionName(const int direction)
+{
+    return (direction == SOAPY_SDR_RX)?"RX":"TX";
+}
+
+//the lead of the first timed TX write ahead of the hardware time
+static const long long txLeadNs = 10000000;
+
+static int rateTestStreamCall(RateTestStream &s, void * const *buffs, const SoapySDRRateTestOptions &options)
+{
+    //TX writes follow a timeline for the lead time figures
+    int flags(0);
+    long long timeNs(0);
+    if (options.timeLatency and s.direction == SOAPY_SDR_TX)
+    {
+        flags = SOAPY_SDR_HAS_TIME;
+        timeNs = s.txStartNs + SoapySDR::ticksToTimeNs((long long)(s.totalSamples), s.sampleRate);
+    }
+    if (not options.directAccess) switch(s.direction)
+    {
+    case SOAPY_SDR_RX: return s.device->readStream(s.stream, buffs, s.numElems, flags, timeNs, options.timeoutUs);
+    case SOAPY_SDR_TX: return s.device->writeStream(s.stream, buffs, s.numElems, flags, timeNs, options.timeoutUs);
+    }
+
+    size_t handle(0);
+    std::vector<void *> direct(s.numChans);
+    if (s.direction == SOAPY_SDR_RX)
+    {
+        const int ret = s.device->acquireReadBuffer(s.stream, handle, const_cast<const void **>(direct.data()), flags, timeNs, options.timeoutUs);
+        if (ret >= 0) s.device->releaseReadBuffer(s.stream, handle);
+        return ret;
+    }
+    const int ret = s.device->acquireWriteBuffer(s.stream, handle, direct.data(), options.timeoutUs);
+    if (ret < 0) return ret;
+    const size_t numElems = std::min(size_t(ret), s.numElems);
+    s.device->releaseWriteBuffer(s.stream, handle, numElems, flags, timeNs);
+    return int(numElems);
+}
+
+static void runRateTestStreamLoop(RateTestStream &s, const SoapySDRRateTestOptions &options)
+{
+    //pin the thread with the same hints that drivers apply to their own threads
+    s.hints.applyToThisThread();
+    void * const *buffs = s.buffers.buffs();
+    if (options.timeLatency) s.txStartNs = s.device->getHardwareTime() + txLeadNs;
+
+    auto timeLastStatus = std::chrono::high_resolution_clock::now();
+    while (not loopDone)
+    {
+        const auto callStart = std::chrono::high_resolution_clock::now();
+        const int ret = rateTestStreamCall(s, buffs, options);
+        const auto now = std::chrono::high_resolution_clock::now();
+
+        if (ret == SOAPY_SDR_TIMEOUT)
+        {
+            s.timeouts++;
+            continue;
+        }
+        s.latency.add(std::chrono::duration_cast<std::chrono::nanoseconds>(now - callStart).count());
         if (ret == SOAPY_SDR_OVERFLOW)
         {
-            overflows++;
+            s.overflows++;
             continue;
         }
         if (ret == SOAPY_SDR_UNDERFLOW)
         {
-            underflows++;
+            s.underflows++;
+            continue;
+        }
+        if (ret == SOAPY_SDR_CORRUPTION)
+        {
+            s.drops++;
             continue;
         }
         if (ret < 0)
         {
-            std::cerr << "Unexpected stream error " << SoapySDR::errToStr(ret) << std::endl;
+            std::cerr << "Unexpected " << directionName(s.direction) << " stream error " << SoapySDR::errToStr(ret) << std::endl;
+            s.ok = false;
             break;
         }
-        totalSamples += ret;
+        s.totalSamples += ret;
 
-        const auto now = std::chrono::high_resolution_clock::now();
-        if (timeLastSpin + std::chrono::milliseconds(300) < now)
-        {
-            timeLastSpin = now;
-            static const char spin[] = {"|/-\\"};
-            printf("\b%c", spin[(spinIndex++)%4]);
-            fflush(stdout);
-        }
         //occasionally read out the stream status (non blocking)
         if (timeLastStatus + std::chrono::seconds(1) < now)
         {
@@ -92,45 +247,217 @@ void runRateTestStreamLoop(
             while (true)
             {
                 size_t chanMask; int flags; long long timeNs;
-                ret = device->readStreamStatus(stream, chanMask, flags, timeNs, 0);
-                if (ret == SOAPY_SDR_OVERFLOW) overflows++;
-                else if (ret == SOAPY_SDR_UNDERFLOW) underflows++;
-                else if (ret == SOAPY_SDR_TIME_ERROR) {}
+                const int status = s.device->readStreamStatus(s.stream, chanMask, flags, timeNs, 0);
+                if (status == SOAPY_SDR_OVERFLOW) s.overflows++;
+                else if (status == SOAPY_SDR_UNDERFLOW) s.underflows++;
+                else if (status == SOAPY_SDR_TIME_ERROR) {}
                 else break;
             }
         }
+    }
+}
+
+/***********************************************************************
+ * Reports
+ **********************************************************************/
+static void printRateTestReport(
+    const std::vector<std::string> &argStrs,
+    const std::vector<std::unique_ptr<RateTestStream>> &streams,
+    const double seconds,
+    const double cpuSeconds,
+    const std::string &output)
+{
+    //the aggregate over every device
+    unsigned long long allSamples(0), allOverflows(0), allUnderflows(0), allDrops(0);
+    double allMsps(0.0), allMbps(0.0);
+    for (const auto &s : streams)
+    {
+        const double msps = (seconds == 0.0)?0.0:(s->totalSamples/seconds/1e6);
+        allSamples += s->totalSamples;
+        allOverflows += s->overflows;
+        allUnderflows += s->underflows;
+        allDrops += s->drops;
+        allMsps += msps;
+        allMbps += msps*s->numChans*s->elemSize;
+    }
+    const double cpuNsPerSample = (allSamples == 0)?0.0:(cpuSeconds*1e9/allSamples);
+    const double cpuPercent = (seconds == 0.0)?0.0:(100.0*cpuSeconds/seconds);
+
+    if (output == "csv")
+    {
+        std::cout << "device,args,direction,format,channels,elements,seconds,samples,msps,mbps,overflows,underflows,drops,timeouts,"
+            "lat_min_us,lat_mean_us,lat_p50_us,lat_p90_us,lat_p99_us,lat_p999_us,lat_max_us,cpu_ns_per_sample,cpu_percent,"
+            "time_lat_count,time_lat_min_us,time_lat_mean_us,time_lat_p99_us,time_lat_max_us" << std::endl;
+    }
+    if (output == "json") std::cout << "{\"seconds\": " << std::fixed << std::setprecision(3) << seconds
+        << ", \"cpu_ns_per_sample\": " << cpuNsPerSample << ", \"cpu_percent\": " << cpuPercent
+        << ", \"aggregate\": {\"devices\": " << argStrs.size() << ", \"samples\": " << allSamples
+        << ", \"msps\": " << allMsps << ", \"mbps\": " << allMbps << ", \"overflows\": " << allOverflows
+        << ", \"underflows\": " << allUnderflows << ", \"drops\": " << allDrops << "}, \"streams\": [" << std::endl;
+
+    for (size_t i = 0; i < streams.size(); i++)
+    {
+        const auto &s = *streams[i];
+        const double msps = (seconds == 0.0)?0.0:(s.totalSamples/seconds/1e6);
+        const double mbps = msps*s.numChans*s.elemSize;
+        const auto &lat = s.latency;
+        const auto &stats = s.stats;
+        if (output == "csv")
+        {
+            std::cout << s.deviceIndex << ",\"" << argStrs[s.deviceIndex] << "\"," << directionName(s.direction) << ","
+                << s.format << "," << s.numChans << "," << s.numElems << ","
+                << std::fixed << std::setprecision(3) << seconds << "," << s.totalSamples << "," << msps << "," << mbps << ","
+                << s.overflows << "," << s.underflows << "," << s.drops << "," << s.timeouts << ","
+                << lat.minUs() << "," << lat.meanUs() << "," << lat.percentileUs(0.5) << "," << lat.percentileUs(0.9) << ","
+                << lat.percentileUs(0.99) << "," << lat.percentileUs(0.999) << "," << lat.maxUs() << ","
+                << cpuNsPerSample << "," << cpuPercent << ","
+                << stats.numTimestamps << "," << stats.minTimeLatencyNs/1e3 << "," << stats.avgTimeLatencyNs/1e3 << ","
+                << stats.p99TimeLatencyNs/1e3 << "," << stats.maxTimeLatencyNs/1e3 << std::endl;
+        }
+        else if (output == "json")
+        {
+            std::cout << "  {\"device\": " << s.deviceIndex << ", \"cpu\": " << s.cpu
+                << ", \"direction\": \"" << directionName(s.direction) << "\", \"format\": \"" << s.format
+                << "\", \"channels\": " << s.numChans << ", \"elements\": " << s.numElems
+                << ", \"samples\": " << s.totalSamples << std::fixed << std::setprecision(3)
+                << ", \"msps\": " << msps << ", \"mbps\": " << mbps
+                << ", \"overflows\": " << s.overflows << ", \"underflows\": " << s.underflows
+                << ", \"drops\": " << s.drops << ", \"timeouts\": " << s.timeouts
+                << ", \"latency_us\": {\"min\": " << lat.minUs() << ", \"mean\": " << lat.meanUs()
+                << ", \"p50\": " << lat.percentileUs(0.5) << ", \"p90\": " << lat.percentileUs(0.9)
+                << ", \"p99\": " << lat.percentileUs(0.99) << ", \"p999\": " << lat.percentileUs(0.999)
+                << ", \"max\": " << lat.maxUs() << "}, \"time_latency_us\": {\"count\": " << stats.numTimestamps
+                << ", \"min\": " << stats.minTimeLatencyNs/1e3 << ", \"mean\": " << stats.avgTimeLatencyNs/1e3
+                << ", \"p99\": " << stats.p99TimeLatencyNs/1e3 << ", \"max\": " << stats.maxTimeLatencyNs/1e3
+                << "}}" << ((i+1 == streams.size())?"":",") << std::endl;
+        }
+        else
+        {
+            if (argStrs.size() > 1) printf("Device %zu \"%s\" ", s.deviceIndex, argStrs[s.deviceIndex].c_str());
+            printf("%s %s: %g Msps\t%g MBps\tOverflows %llu\tUnderflows %llu\tDrops %llu\tTimeouts %llu\n",
+                directionName(s.direction), s.format.c_str(), msps, mbps,
+                (unsigned long long)(s.overflows), (unsigned long long)(s.underflows),
+                (unsigned long long)(s.drops), (unsigned long long)(s.timeouts));
+            printf("  Call latency us: min %.1f, mean %.1f, p50 %.1f, p90 %.1f, p99 %.1f, p99.9 %.1f, max %.1f\n",
+                lat.minUs(), lat.meanUs(), lat.percentileUs(0.5), lat.percentileUs(0.9),
+                lat.percentileUs(0.99), lat.percentileUs(0.999), lat.maxUs());
+            if (stats.numTimestamps != 0) printf("  %s us: min %.1f, mean %.1f, p99 %.1f, max %.1f\n",
+                (s.direction == SOAPY_SDR_RX)?"Timestamp latency":"Lead time",
+                stats.minTimeLatencyNs/1e3, stats.avgTimeLatencyNs/1e3, stats.p99TimeLatencyNs/1e3, stats.maxTimeLatencyNs/1e3);
+        }
+    }
+
+    if (output == "json") std::cout << "]}" << std::endl;
+    if (output.empty() and argStrs.size() > 1)
+    {
+        printf("Aggregate of %zu devices: %g Msps\t%g MBps\tOverflows %llu\tUnderflows %llu\tDrops %llu\n",
+            argStrs.size(), allMsps, allMbps, allOverflows, allUnderflows, allDrops);
+    }
+    if (output.empty()) printf("CPU time: %g ns per sample, %g%% of one core over %g seconds\n", cpuNsPerSample, cpuPercent, seconds);
+}
+
+/***********************************************************************
+ * Run the streams until Ctrl+C or the duration expires
+ **********************************************************************/
+static bool runRateTestStreams(
+    const std::vector<std::string> &argStrs,
+    const std::vector<std::unique_ptr<RateTestStream>> &streams,
+    const SoapySDRRateTestOptions &options)
+{
+    const bool text = options.output.empty();
+    if (text) std::cout << "Starting stream loop, press Ctrl+C to exit..." << std::endl;
+    for (const auto &s : streams) s->device->activateStream(s->stream);
+    signal(SIGINT, sigIntHandler);
+
+    const auto startTime = std::chrono::high_resolution_clock::now();
+    const std::clock_t cpuStart = std::clock();
+    std::vector<std::thread> threads;
+    for (const auto &s : streams)
+    {
+        threads.push_back(std::thread(&runRateTestStreamLoop, std::ref(*s), std::cref(options)));
+    }
+
+    //print progress from the main thread so that the streams only stream
+    auto timeLastPrint = startTime;
+    int spinIndex(0);
+    while (not loopDone)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        const auto now = std::chrono::high_resolution_clock::now();
+        const double elapsed = std::chrono::duration<double>(now - startTime).count();
+        if (options.duration > 0.0 and elapsed >= options.duration) loopDone = true;
+        bool running = false;
+        for (const auto &s : streams) running = running or s->ok;
+        if (not running) loopDone = true;
+        if (not text) continue;
+
+        if (spinIndex++ % 3 == 0)
+        {
+            static const char spin[] = {"|/-\\"};
+            printf("\b%c", spin[(spinIndex/3)%4]);
+            fflush(stdout);
+        }
         if (timeLastPrint + std::chrono::seconds(5) < now)
         {
             timeLastPrint = now;
-            const auto timePassed = std::chrono::duration_cast<std::chrono::microseconds>(now - startTime);
-            const auto sampleRate = double(totalSamples)/timePassed.count();
-            printf("\b%g Msps\t%g MBps", sampleRate, sampleRate*numChans*elemSize);
-            if (overflows != 0) printf("\tOverflows %u", overflows);
-            if (underflows != 0) printf("\tUnderflows %u", underflows);
+            printf("\b");
+            for (const auto &s : streams)
+            {
+                const auto sampleRate = s->totalSamples/elapsed/1e6;
+                if (argStrs.size() > 1) printf("%zu:", s->deviceIndex);
+                printf("%s %g Msps\t%g MBps", (streams.size() == 1)?"":directionName(s->direction), sampleRate, sampleRate*s->numChans*s->elemSize);
+                if (s->overflows != 0) printf("\tOverflows %llu", (unsigned long long)(s->overflows));
+                if (s->underflows != 0) printf("\tUnderflows %llu", (unsigned long long)(s->underflows));
+                printf("\t");
+            }
             printf("\n ");
         }
-
     }
-    device->deactivateStream(stream);
+
+    for (auto &thread : threads) thread.join();
+    const double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - startTime).count();
+    const double cpuSeconds = double(std::clock() - cpuStart)/CLOCKS_PER_SEC;
+    for (const auto &s : streams) s->device->deactivateStream(s->stream);
+    for (const auto &s : streams) s->device->getStreamStats(s->stream, s->stats);
+
+    if (text) printf("\b\n");
+    printRateTestReport(argStrs, streams, seconds, cpuSeconds, options.output);
+
+    bool ok = true;
+    for (const auto &s : streams) ok = ok and s->ok;
+    return ok;
 }
 
 int SoapySDRRateTest(
-    const std::string &argStr,
+    const std::vector<std::string> &argStrs,
     const double sampleRate,
     const std::string &channelStr,
-    const std::string &directionStr)
+    const std::string &directionStr,
+    const SoapySDRRateTestOptions &options)
 {
-    SoapySDR::Device *device(nullptr);
+    std::vector<SoapySDR::Device *> devices;
+    std::vector<std::unique_ptr<RateTestStream>> streams;
+    bool ok = false;
+
+    //informational messages stay out of machine readable output
+    std::ostream &info = options.output.empty()?std::cout:std::cerr;
 
     try
     {
-        device = SoapySDR::Device::make(argStr);
+        if (not options.output.empty() and options.output != "csv" and options.output != "json")
+        {
+            throw std::invalid_argument("output not in csv/json: " + options.output);
+        }
 
-        //parse the direction to the integer enum
-        int direction(-1);
-        if (directionStr == "RX" or directionStr == "rx") direction = SOAPY_SDR_RX;
-        if (directionStr == "TX" or directionStr == "tx") direction = SOAPY_SDR_TX;
-        if (direction == -1) throw std::invalid_argument("direction not in RX/TX: " + directionStr);
+        //parse the direction to the integer enum, RX,TX runs both at the same time
+        std::vector<int> directions;
+        for (const auto &pair : SoapySDR::KwargsFromString(directionStr))
+        {
+            if (pair.first == "RX" or pair.first == "rx") directions.push_back(SOAPY_SDR_RX);
+            else if (pair.first == "TX" or pair.first == "tx") directions.push_back(SOAPY_SDR_TX);
+            else throw std::invalid_argument("direction not in RX/TX: " + directionStr);
+        }
+        if (directions.empty()) throw std::invalid_argument("direction not in RX/TX: " + directionStr);
 
         //build channels list, using KwargsFromString is a easy parsing hack
         std::vector<size_t> channels;
@@ -140,34 +467,85 @@ int SoapySDRRateTest(
         }
         if (channels.empty()) channels.push_back(0);
 
-        //initialize the sample rate for all channels
-        for (const auto &chan : channels)
+        //the CPUs that stream threads are pinned to in turn
+        std::vector<int> cpus;
+        for (const auto &pair : SoapySDR::KwargsFromString(options.cpuList))
+        {
+            cpus.push_back(std::stoi(pair.first));
+        }
+        if (cpus.empty() and argStrs.size() > 1)
         {
-            device->setSampleRate(direction, chan, sampleRate);
+            for (unsigned i = 0; i < std::max(1u, std::thread::hardware_concurrency()); i++) cpus.push_back(int(i));
         }
 
-        //create the stream, use the native format
-        double fullScale(0.0);
-        const auto format = device->getNativeStreamFormat(direction, channels.front(), fullScale);
-        const size_t elemSize = SoapySDR::formatToSize(format);
-        auto stream = device->setupStream(direction, format, channels);
+        //open every device in parallel
+        SoapySDR::KwargsList argsList;
+        for (const auto &argStr : argStrs) argsList.push_back(SoapySDR::KwargsFromString(argStr));
+        if (argsList.empty()) argsList.push_back(SoapySDR::Kwargs());
+        devices = SoapySDR::Device::make(argsList);
 
-        //run the rate test one setup is complete
-        std::cout << "Stream format: " << format << std::endl;
-        std::cout << "Num channels: " << channels.size() << std::endl;
-        std::cout << "Element size: " << elemSize << " bytes" << std::endl;
-        std::cout << "Begin " << directionStr << " rate test at " << (sampleRate/1e6) << " Msps" << std::endl;
-        runRateTestStreamLoop(device, stream, direction, channels.size(), elemSize);
+        for (size_t deviceIndex = 0; deviceIndex < devices.size(); deviceIndex++)
+        {
+            auto device = devices[deviceIndex];
+            for (const auto direction : directions)
+            {
+                //initialize the sample rate for all channels
+                for (const auto &chan : channels)
+                {
+                    device->setSampleRate(direction, chan, sampleRate);
+                }
 
-        //cleanup stream and device
-        device->closeStream(stream);
-        SoapySDR::Device::unmake(device);
+                //create the stream, use the native format unless specified
+                std::unique_ptr<RateTestStream> s(new RateTestStream());
+                double fullScale(0.0);
+                s->device = device;
+                s->deviceIndex = deviceIndex;
+                s->direction = direction;
+                s->cpu = cpus.empty()?-1:cpus[streams.size()%cpus.size()];
+                s->format = options.format.empty()?device->getNativeStreamFormat(direction, channels.front(), fullScale):options.format;
+                s->numChans = channels.size();
+                s->elemSize = SoapySDR::formatToSize(s->format);
+                s->sampleRate = sampleRate;
+                auto streamArgs = SoapySDR::KwargsFromString(options.streamArgs);
+                if (options.timeLatency) streamArgs["latency_stats"] = "true";
+                s->stream = device->setupStream(direction, s->format, channels, streamArgs);
+                streams.push_back(std::move(s));
+
+                auto &stream = *streams.back();
+                stream.numElems = (options.numElems == 0)?device->getStreamMTU(stream.stream):options.numElems;
+                stream.hints = SoapySDR::ThreadHints(SoapySDR::KwargsFromString(options.streamArgs));
+                if (stream.cpu >= 0) stream.hints.cpus.assign(1, size_t(stream.cpu));
+
+                //aligned buffers for the stream read/write on the stream's NUMA node
+                stream.buffers.resize(stream.numChans, stream.numElems, stream.elemSize, 1,
+                    options.hugePages?SOAPY_SDR_BUFFER_HUGE_PAGES:0, stream.hints.numaNode);
+                if (options.directAccess and device->getNumDirectAccessBuffers(stream.stream) == 0)
+                {
+                    throw std::runtime_error(std::string(directionName(direction)) + " stream has no direct access buffers in " + stream.format);
+                }
+
+                if (devices.size() > 1) info << "Device " << deviceIndex << " " << argStrs[deviceIndex] << std::endl;
+                info << directionName(direction) << " stream format: " << stream.format << std::endl;
+                info << "Num channels: " << stream.numChans << std::endl;
+                info << "Element size: " << stream.elemSize << " bytes" << std::endl;
+                info << "Buffer size: " << stream.numElems << " elements" << (options.directAccess?" (direct access)":"") << std::endl;
+                if (stream.cpu >= 0) info << "Stream thread CPU: " << stream.cpu << std::endl;
+            }
+        }
+
+        //run the rate test one setup is complete
+        info << "Begin " << directionStr << " rate test at " << (sampleRate/1e6) << " Msps";
+        if (devices.size() > 1) info << " on " << devices.size() << " devices";
+        info << std::endl;
+        ok = runRateTestStreams((argStrs.empty()?std::vector<std::string>(1):argStrs), streams, options);
     }
     catch (const std::exception &ex)
     {
         std::cerr << "Error in rate test: " << ex.what() << std::endl;
-        SoapySDR::Device::unmake(device);
-        return EXIT_FAILURE;
     }
-    return EXIT_FAILURE;
+
+    //cleanup streams and devices
+    for (const auto &s : streams) s->device->closeStream(s->stream);
+    SoapySDR::Device::unmake(devices);
+    return ok?EXIT_SUCCESS:EXIT_FAILURE;
 }
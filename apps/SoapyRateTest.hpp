@@ -0,0 +1,75 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include <string>
+#include <vector>
+#include <cstddef>
+
+/*!
+ * Optional settings for the rate test.
+ * The defaults reproduce the original behaviour:
+ * the native format, MTU sized buffers, and a run until Ctrl+C.
+ */
+struct SoapySDRRateTestOptions
+{
+    SoapySDRRateTestOptions(void):
+        numElems(0),
+        timeoutUs(100000),
+        directAccess(false),
+        duration(0.0),
+        hugePages(false),
+        timeLatency(false)
+    {
+        return;
+    }
+
+    //! The stream format, or empty for the native format
+    std::string format;
+
+    //! The elements per stream call, or 0 for the stream MTU
+    size_t numElems;
+
+    //! The timeout for each stream call in microseconds
+    long timeoutUs;
+
+    //! Use the direct buffer access API instead of read/writeStream()
+    bool directAccess;
+
+    //! The run time in seconds, or 0 to run until Ctrl+C
+    double duration;
+
+    //! The report format: empty for text, csv, or json
+    std::string output;
+
+    /*!
+     * CPUs to pin the stream threads to in turn, "0, 2, 4" style.
+     * When empty, the threads are pinned round robin over all CPUs
+     * for a multi-device test and left unpinned otherwise.
+     */
+    std::string cpuList;
+
+    //! Args markup for setupStream() such as the standard thread hints
+    std::string streamArgs;
+
+    //! Back the stream buffers with huge pages
+    bool hugePages;
+
+    /*!
+     * Measure the stream timestamps against the hardware time
+     * with the latency_stats stream arg and report the figures.
+     * TX writes are timed on a timeline that starts ahead of the hardware time.
+     */
+    bool timeLatency;
+};
+
+/*!
+ * Stream from every device in the list at the same time.
+ * Each device opens the same channels and directions.
+ */
+int SoapySDRRateTest(
+    const std::vector<std::string> &argStrs,
+    const double sampleRate,
+    const std::string &channelStr,
+    const std::string &directionStr,
+    const SoapySDRRateTestOptions &options);
@@ -0,0 +1,86 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/Device.hpp>
+#include <SoapySDR/Recording.hpp>
+#include <string>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <csignal>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <cstdio>
+
+static std::atomic<bool> recordDone(false);
+static void sigIntHandlerRecord(const int)
+{
+    recordDone = true;
+}
+
+//SigMF unless the path has another extension
+static bool isSigMFPath(const std::string &path)
+{
+    const size_t dot = path.find_last_of('.');
+    const size_t slash = path.find_last_of("/\\");
+    if (dot == std::string::npos or (slash != std::string::npos and dot < slash)) return true;
+    return path.compare(dot, 6, ".sigmf") == 0;
+}
+
+int SoapySDRRecord(
+    const std::string &argStr,
+    const double sampleRate,
+    const double frequency,
+    const std::string &channelStr,
+    const std::string &path,
+    const std::string &format,
+    const std::string &streamArgs,
+    const double duration)
+{
+    SoapySDR::Device *device(nullptr);
+    int status = EXIT_FAILURE;
+
+    try
+    {
+        device = SoapySDR::Device::make(argStr);
+
+        //the first channel of the list is recorded
+        const auto channels = SoapySDR::KwargsFromString(channelStr);
+        const size_t channel = channels.empty()?0:std::stoul(channels.begin()->first);
+        if (sampleRate != 0.0) device->setSampleRate(SOAPY_SDR_RX, channel, sampleRate);
+        if (frequency != 0.0) device->setFrequency(SOAPY_SDR_RX, channel, frequency);
+
+        auto args = SoapySDR::KwargsFromString(streamArgs);
+        if (not format.empty()) args["format"] = format;
+        args["output"] = isSigMFPath(path)?"sigmf":"raw";
+
+        const double rate = device->getSampleRate(SOAPY_SDR_RX, channel);
+        const unsigned long long numSamples = (duration > 0.0)?(unsigned long long)(duration*rate):0;
+        SoapySDR::Recorder recorder(device, channel, path, args);
+        std::cout << "Recording channel " << channel << " at " << (rate/1e6) << " Msps to " << recorder.dataPath() << std::endl;
+        if (not recorder.metaPath().empty()) std::cout << "Metadata: " << recorder.metaPath() << std::endl;
+        std::cout << ((numSamples == 0)?"Press Ctrl+C to stop...":"Recording, press Ctrl+C to stop early...") << std::endl;
+
+        signal(SIGINT, sigIntHandlerRecord);
+        recorder.start(numSamples);
+        auto timeLastPrint = std::chrono::high_resolution_clock::now();
+        while (not recordDone and not recorder.done())
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            const auto now = std::chrono::high_resolution_clock::now();
+            if (timeLastPrint + std::chrono::seconds(1) > now) continue;
+            timeLastPrint = now;
+            printf("%llu samples\tOverflows %llu\tDropped %llu\n", recorder.numSamples(), recorder.numOverflows(), recorder.numDropped());
+        }
+        recorder.stop();
+        printf("Recorded %llu samples\tOverflows %llu\tDropped %llu\n", recorder.numSamples(), recorder.numOverflows(), recorder.numDropped());
+        status = EXIT_SUCCESS;
+    }
+    catch (const std::exception &ex)
+    {
+        std::cerr << "Error in record: " << ex.what() << std::endl;
+    }
+    SoapySDR::Device::unmake(device);
+    return status;
+}
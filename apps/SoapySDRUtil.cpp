@@ -1,6 +1,7 @@
 // Copyright (c) 2014-2018 Josh Blum
 // SPDX-License-Identifier: BSL-1.0
 
+#include "SoapyRateTest.hpp"
 #include <SoapySDR/Version.hpp>
 #include <SoapySDR/Modules.hpp>
 #include <SoapySDR/Registry.hpp>
@@ -16,11 +17,35 @@
 #include <sys/stat.h>
 
 std::string SoapySDRDeviceProbe(SoapySDR::Device *);
-int SoapySDRRateTest(
+int SoapySDRConverterBench(const std::string &formatStr);
+int SoapySDRRecord(
     const std::string &argStr,
     const double sampleRate,
+    const double frequency,
     const std::string &channelStr,
-    const std::string &directionStr);
+    const std::string &path,
+    const std::string &format,
+    const std::string &streamArgs,
+    const double duration);
+int SoapySDRPlay(
+    const std::string &argStr,
+    const double sampleRate,
+    const double frequency,
+    const std::string &channelStr,
+    const std::string &path,
+    const std::string &format,
+    const std::string &streamArgs,
+    const double duration,
+    const bool loop);
+int SoapySDRBroker(
+    const std::string &argStr,
+    const double sampleRate,
+    const double frequency,
+    const std::string &channelStr,
+    const std::string &name,
+    const std::string &format,
+    const std::string &streamArgs,
+    const double duration);
 
 /***********************************************************************
  * Print the banner
@@ -53,10 +78,37 @@ static int printHelp(void)
     std::cout << std::endl;
 
     std::cout << "  Rate testing options:" << std::endl;
-    std::cout << "    --args[=\"driver=foo\"] \t\t Arguments for testing" << std::endl;
+    std::cout << "    --args[=\"driver=foo\"] \t\t Arguments for testing, repeat for more devices" << std::endl;
     std::cout << "    --rate[=stream rate Sps] \t\t Rate in samples per second" << std::endl;
     std::cout << "    --channels[=\"0, 1, 2\"] \t\t List of channels, default 0" << std::endl;
-    std::cout << "    --direction[=RX or TX] \t\t Specify the channel direction" << std::endl;
+    std::cout << "    --direction[=RX or TX] \t\t Specify the channel direction, RX,TX for both" << std::endl;
+    std::cout << "    --format[=CS16] \t\t\t Stream format, default native" << std::endl;
+    std::cout << "    --buffer-size[=elements] \t\t Elements per call, default MTU" << std::endl;
+    std::cout << "    --timeout[=microseconds] \t\t Timeout per call, default 100000" << std::endl;
+    std::cout << "    --direct-access \t\t\t Use the direct buffer access API" << std::endl;
+    std::cout << "    --duration[=seconds] \t\t Run time, default until Ctrl+C" << std::endl;
+    std::cout << "    --output[=csv or json] \t\t Machine readable report" << std::endl;
+    std::cout << "    --cpus[=\"0, 1, 2\"] \t\t CPUs to pin the stream threads to" << std::endl;
+    std::cout << "    --stream-args[=\"numa_node=0\"] \t Arguments for setupStream()" << std::endl;
+    std::cout << "    --huge-pages \t\t\t Back the stream buffers with huge pages" << std::endl;
+    std::cout << "    --time-latency \t\t\t Measure timestamps against the hardware time" << std::endl;
+    std::cout << std::endl;
+
+    std::cout << "  Record and playback options:" << std::endl;
+    std::cout << "    --record[=capture.sigmf] \t\t Record RX to SigMF, other extensions are raw" << std::endl;
+    std::cout << "    --play[=capture.sigmf] \t\t Play a SigMF or raw --format recording to TX" << std::endl;
+    std::cout << "    --loop \t\t\t\t Repeat the recording until stopped" << std::endl;
+    std::cout << "    --freq[=center frequency Hz] \t Tune before recording or playing" << std::endl;
+    std::cout << "    Also --args, --rate, --channels, --format, --stream-args, --duration" << std::endl;
+    std::cout << std::endl;
+
+    std::cout << "  Converter benchmark options:" << std::endl;
+    std::cout << "    --bench-converters[=csv or json] \t Time every registered converter" << std::endl;
+    std::cout << std::endl;
+
+    std::cout << "  Stream broker options:" << std::endl;
+    std::cout << "    --broker[=name] \t\t\t Share RX with other processes as driver=broker" << std::endl;
+    std::cout << "    Also --args, --rate, --freq, --channels, --format, --stream-args, --duration" << std::endl;
     std::cout << std::endl;
     return EXIT_SUCCESS;
 }
@@ -100,6 +152,16 @@ static int printInfo(void)
     }
     if (modules.empty()) std::cout << "No modules found!" << std::endl;
 
+    //refresh the manifest cache from the modules loaded above
+    const auto manifestPath = SoapySDR::getModuleManifestPath();
+    if (not manifestPath.empty())
+    {
+        const auto errMsg = SoapySDR::saveModuleManifest();
+        std::cout << "Module manifest: " << manifestPath;
+        if (not errMsg.empty()) std::cout << "\n  " << errMsg;
+        std::cout << std::endl;
+    }
+
     std::cout << "Available factories... ";
     std::string factories;
     for (const auto &it : SoapySDR::Registry::listFindFunctions())
@@ -248,6 +310,15 @@ int main(int argc, char *argv[])
     bool sparsePrintFlag(false);
     bool makeDeviceFlag(false);
     bool probeDeviceFlag(false);
+    bool benchConvertersFlag(false);
+    std::string benchFormatStr;
+    SoapySDRRateTestOptions rateOptions;
+    std::vector<std::string> rateArgStrs;
+    std::string recordPath;
+    std::string playPath;
+    std::string brokerName;
+    bool loopFlag(false);
+    double frequency(0.0);
 
     /*******************************************************************
      * parse command line options
@@ -266,6 +337,24 @@ int main(int argc, char *argv[])
         {"rate", optional_argument, 0, 'r'},
         {"channels", optional_argument, 0, 'n'},
         {"direction", optional_argument, 0, 'd'},
+        {"format", optional_argument, 0, 'F'},
+        {"buffer-size", optional_argument, 0, 'B'},
+        {"timeout", optional_argument, 0, 'T'},
+        {"direct-access", no_argument, 0, 'D'},
+        {"duration", optional_argument, 0, 'u'},
+        {"output", optional_argument, 0, 'o'},
+        {"cpus", optional_argument, 0, 'C'},
+        {"stream-args", optional_argument, 0, 'S'},
+        {"huge-pages", no_argument, 0, 'H'},
+        {"time-latency", no_argument, 0, 'W'},
+
+        {"record", optional_argument, 0, 'R'},
+        {"play", optional_argument, 0, 'P'},
+        {"loop", no_argument, 0, 'L'},
+        {"freq", optional_argument, 0, 'q'},
+
+        {"bench-converters", optional_argument, 0, 'b'},
+        {"broker", optional_argument, 0, 'K'},
         {0, 0, 0,  0}
     };
     int long_index = 0;
@@ -300,6 +389,7 @@ int main(int argc, char *argv[])
             break;
         case 'a':
             if (optarg != nullptr) argStr = optarg;
+            if (optarg != nullptr) rateArgStrs.push_back(optarg);
             break;
         case 'r':
             if (optarg != nullptr) sampleRate = std::stod(optarg);
@@ -310,9 +400,65 @@ int main(int argc, char *argv[])
         case 'd':
             if (optarg != nullptr) dirStr = optarg;
             break;
+        case 'F':
+            if (optarg != nullptr) rateOptions.format = optarg;
+            break;
+        case 'B':
+            if (optarg != nullptr) rateOptions.numElems = std::stoul(optarg);
+            break;
+        case 'T':
+            if (optarg != nullptr) rateOptions.timeoutUs = std::stol(optarg);
+            break;
+        case 'D':
+            rateOptions.directAccess = true;
+            break;
+        case 'u':
+            if (optarg != nullptr) rateOptions.duration = std::stod(optarg);
+            break;
+        case 'o':
+            if (optarg != nullptr) rateOptions.output = optarg;
+            break;
+        case 'C':
+            if (optarg != nullptr) rateOptions.cpuList = optarg;
+            break;
+        case 'S':
+            if (optarg != nullptr) rateOptions.streamArgs = optarg;
+            break;
+        case 'H':
+            rateOptions.hugePages = true;
+            break;
+        case 'W':
+            rateOptions.timeLatency = true;
+            break;
+        case 'R':
+            recordPath = (optarg != nullptr)?optarg:"capture.sigmf";
+            break;
+        case 'P':
+            playPath = (optarg != nullptr)?optarg:"capture.sigmf";
+            break;
+        case 'L':
+            loopFlag = true;
+            break;
+        case 'q':
+            if (optarg != nullptr) frequency = std::stod(optarg);
+            break;
+        case 'b':
+            benchConvertersFlag = true;
+            if (optarg != nullptr) benchFormatStr = optarg;
+            break;
+        case 'K':
+            brokerName = (optarg != nullptr)?optarg:"default";
+            break;
         }
     }
 
+    //machine-readable output without the banner
+    if (benchConvertersFlag) return SoapySDRConverterBench(benchFormatStr);
+    if (sampleRate != 0.0 and not rateOptions.output.empty())
+    {
+        return SoapySDRRateTest(rateArgStrs, sampleRate, chanStr, dirStr, rateOptions);
+    }
+
     if (not sparsePrintFlag) printBanner();
     if (not driverName.empty()) return checkDriver(driverName);
     if (findDevicesFlag) return findDevices(argStr, sparsePrintFlag);
@@ -320,9 +466,24 @@ int main(int argc, char *argv[])
     if (probeDeviceFlag) return probeDevice(argStr);
 
     //invoke utilities that rely on multiple arguments
+    if (not recordPath.empty())
+    {
+        return SoapySDRRecord(argStr, sampleRate, frequency, chanStr, recordPath,
+            rateOptions.format, rateOptions.streamArgs, rateOptions.duration);
+    }
+    if (not playPath.empty())
+    {
+        return SoapySDRPlay(argStr, sampleRate, frequency, chanStr, playPath,
+            rateOptions.format, rateOptions.streamArgs, rateOptions.duration, loopFlag);
+    }
+    if (not brokerName.empty())
+    {
+        return SoapySDRBroker(argStr, sampleRate, frequency, chanStr, brokerName,
+            rateOptions.format, rateOptions.streamArgs, rateOptions.duration);
+    }
     if (sampleRate != 0.0)
     {
-        return SoapySDRRateTest(argStr, sampleRate, chanStr, dirStr);
+        return SoapySDRRateTest(rateArgStrs, sampleRate, chanStr, dirStr, rateOptions);
     }
 
     //unknown or unspecified options, do help...
@@ -0,0 +1,114 @@
+///
+/// \file SoapySDR/AsyncReader.hpp
+///
+/// Prefetching receive transfers for drivers with a synchronous transfer call.
+///
+/// \copyright
+/// Copyright (c) 2018-2018 Josh Blum
+/// SPDX-License-Identifier: BSL-1.0
+///
+
+#pragma once
+#include <SoapySDR/Config.hpp>
+#include <SoapySDR/ThreadHints.hpp>
+#include <functional>
+#include <cstddef> //size_t
+
+namespace SoapySDR
+{
+
+/*!
+ * Keep receive transfers going while the application processes samples.
+ *
+ * A driver that only transfers when readStream() is called leaves the bus
+ * idle between calls. The adapter calls the driver's synchronous transfer
+ * from a thread of its own, filling up to numTransfers buffers ahead of the
+ * reader, and hands the results to the driver's stream calls in order.
+ * When every buffer is full the thread waits for the reader,
+ * so that the driver still sees and reports its own overflows.
+ *
+ * Errors other than timeouts are delivered in order as the return code of
+ * a read, with the flags and time from the transfer. Reads that split a
+ * transfer set SOAPY_SDR_MORE_FRAGMENTS, and keep SOAPY_SDR_HAS_TIME
+ * when the sample rate is known. The handles of acquireReadBuffer()
+ * are the buffer indexes of getDirectAccessBufferAddrs().
+ *
+ * Example driver usage:
+ * \code
+ * //setupStream()
+ * _reader.reset(new SoapySDR::AsyncReader(
+ *     [this](void * const *buffs, const size_t numElems, int &flags, long long &timeNs, const long timeoutUs)
+ *     {return this->transfer(buffs, numElems, flags, timeNs, timeoutUs);},
+ *     numChans, mtu, SoapySDR::formatToSize(format), 8, SoapySDR::ThreadHints(args)));
+ *
+ * //activateStream() and deactivateStream()
+ * _reader->setSampleRate(_rate);
+ * _reader->start();
+ * _reader->stop();
+ *
+ * //readStream()
+ * return _reader->readStream(buffs, numElems, flags, timeNs, timeoutUs);
+ * \endcode
+ */
+class SOAPY_SDR_API AsyncReader
+{
+public:
+
+    /*!
+     * The driver's synchronous transfer, with the arguments of readStream().
+     * Return the number of elements written to buffs or an error code.
+     */
+    typedef std::function<int(void * const *buffs, const size_t numElems, int &flags, long long &timeNs, const long timeoutUs)> Transfer;
+
+    /*!
+     * Allocate the transfer buffers, the thread starts with start().
+     * \param transfer the driver's synchronous transfer call
+     * \param numChans the number of channel buffers per transfer
+     * \param numElems the number of elements per transfer, usually the MTU
+     * \param elemSize the size of an element in bytes
+     * \param numTransfers the number of transfers that can be ahead of the reader
+     * \param hints the placement of the transfer thread and its buffers
+     */
+    AsyncReader(const Transfer &transfer, const size_t numChans, const size_t numElems, const size_t elemSize, const size_t numTransfers = 4, const ThreadHints &hints = ThreadHints());
+
+    //! Stop the transfer thread
+    ~AsyncReader(void);
+
+    //! The sample rate used to timestamp the remainder of a split transfer
+    void setSampleRate(const double rate);
+
+    //! Set a call made from the transfer thread after each transfer is buffered
+    void setNotify(const std::function<void(void)> &notify);
+
+    //! The number of buffered transfers, including one that a read is part way through
+    size_t numReady(void) const;
+
+    //! Start the transfer thread, usually from activateStream()
+    void start(void);
+
+    //! Stop the transfer thread and discard the buffered transfers
+    void stop(void);
+
+    //! Read buffered transfers with the semantics of Device::readStream()
+    int readStream(void * const *buffs, const size_t numElems, int &flags, long long &timeNs, const long timeoutUs);
+
+    //! The number of transfer buffers
+    size_t getNumDirectAccessBuffers(void) const;
+
+    //! The channel buffers of a transfer buffer
+    int getDirectAccessBufferAddrs(const size_t handle, void **buffs) const;
+
+    //! Acquire one whole transfer with the semantics of Device::acquireReadBuffer()
+    int acquireReadBuffer(size_t &handle, const void **buffs, int &flags, long long &timeNs, const long timeoutUs);
+
+    //! Release a transfer from acquireReadBuffer(), in the order of acquisition
+    void releaseReadBuffer(const size_t handle);
+
+private:
+    AsyncReader(const AsyncReader &);
+    AsyncReader &operator=(const AsyncReader &);
+    struct Impl;
+    Impl *_impl;
+};
+
+}
@@ -0,0 +1,220 @@
+///
+/// \file SoapySDR/Broker.hpp
+///
+/// Share the receive stream of one device with other processes.
+///
+/// \copyright
+/// Copyright (c) 2018-2018 Josh Blum
+/// SPDX-License-Identifier: BSL-1.0
+///
+
+#pragma once
+#include <SoapySDR/Config.hpp>
+#include <SoapySDR/Types.hpp>
+#include <vector>
+#include <string>
+#include <cstddef> //size_t
+
+namespace SoapySDR
+{
+
+class Device;
+
+/*!
+ * Publish the receive stream of a device into a shared memory ring.
+ *
+ * A device can only be opened by one process. The broker runs in that
+ * process: a thread reads the stream straight into the slots of a ring
+ * in a named shared memory segment, and any number of BrokerReader
+ * instances in other processes read the slots in place.
+ * The "broker" driver module wraps a reader as a receive only device,
+ * so that applications attach with "driver=broker,name=...".
+ *
+ * The broker never waits for readers. A reader that falls behind skips
+ * ahead to the newest buffer, and the loss is counted for that reader
+ * alone, so a slow reader does not overflow the device or other readers.
+ * The guard slots keep the newest buffers that a reader may acquire
+ * away from the slot being written, which gives a held buffer
+ * that many buffer periods before it is overwritten.
+ *
+ * The segment is a POSIX shared memory object named "/SoapySDR.<name>",
+ * or a file mapping named "Local\\SoapySDR.<name>" on Windows.
+ *
+ * Broker args:
+ *  - format: the stream format (default native)
+ *  - buffers: the number of MTU sized slots in the ring (default 64)
+ *  - guard: the number of slots that readers may not acquire (default buffers/4)
+ *  - readers: the maximum number of attached readers (default 16)
+ *  - the thread placement args of SoapySDR/ThreadHints.hpp
+ *  - any other args are passed to setupStream()
+ *
+ * \code
+ * //the owner process
+ * SoapySDR::Broker broker(device, std::vector<size_t>(1, 0), "radio0");
+ * broker.start();
+ *
+ * //other processes
+ * auto device = SoapySDR::Device::make("driver=broker,name=radio0");
+ * \endcode
+ */
+class SOAPY_SDR_API Broker
+{
+public:
+
+    //! The counters of an attached reader
+    struct SOAPY_SDR_API ReaderStats
+    {
+        ReaderStats(void);
+
+        //! The process of the reader
+        long long pid;
+
+        //! The number of published buffers that the reader has not acquired
+        unsigned long long lag;
+
+        //! The number of times the reader fell behind or held a buffer too long
+        unsigned long long numOverflows;
+
+        //! The number of buffers that the reader skipped
+        unsigned long long numDropped;
+    };
+
+    /*!
+     * Set up the stream and create the shared memory segment.
+     * \param device the device to stream from, used until the broker is destroyed
+     * \param channels the receive channels to publish
+     * \param name the name of the segment that readers attach to
+     * \param args the broker and stream args
+     * \throws std::runtime_error when the name is in use or the stream cannot be opened
+     */
+    Broker(Device *device, const std::vector<size_t> &channels, const std::string &name, const Kwargs &args = Kwargs());
+
+    //! Stop publishing, close the stream, and remove the segment
+    ~Broker(void);
+
+    /*!
+     * Activate the stream and start publishing.
+     * The sample rate and frequency seen by readers are updated first.
+     */
+    void start(void);
+
+    //! Stop publishing and deactivate the stream
+    void stop(void);
+
+    //! The name of the segment
+    std::string name(void) const;
+
+    //! The number of buffers published since the broker was created
+    unsigned long long numBuffers(void) const;
+
+    //! The number of overflows reported by the stream
+    unsigned long long numOverflows(void) const;
+
+    //! The counters of the readers that are attached now
+    std::vector<ReaderStats> readers(void) const;
+
+private:
+    Broker(const Broker &);
+    Broker &operator=(const Broker &);
+    struct Impl;
+    Impl *_impl;
+};
+
+/*!
+ * Read the buffers of a Broker without a copy.
+ *
+ * Each reader keeps its own position in the ring. A new reader starts
+ * at the newest published buffer. Acquired buffers stay in the shared
+ * memory and are released in the order that they were acquired.
+ * When the broker lapped the reader, or overwrote a buffer while it was
+ * held, the next acquire() returns SOAPY_SDR_OVERFLOW once and the
+ * reader continues from the newest buffer.
+ *
+ * A reader is used from one thread at a time.
+ */
+class SOAPY_SDR_API BrokerReader
+{
+public:
+
+    /*!
+     * Attach to the segment of a running broker.
+     * \param name the name of the segment
+     * \throws std::runtime_error when there is no such broker or no free reader entry
+     */
+    BrokerReader(const std::string &name);
+
+    //! Detach from the segment, held buffers are released
+    ~BrokerReader(void);
+
+    //! The name of the segment
+    std::string name(void) const;
+
+    //! The stream format of the buffers
+    std::string format(void) const;
+
+    //! The full scale of the stream format
+    double fullScale(void) const;
+
+    //! The number of channel buffers per slot
+    size_t numChannels(void) const;
+
+    //! The maximum number of elements per buffer
+    size_t mtu(void) const;
+
+    //! The number of slots in the ring, the range of buffer handles
+    size_t numBuffers(void) const;
+
+    //! The sample rate when the broker was started
+    double sampleRate(void) const;
+
+    //! The frequency of the first channel when the broker was started
+    double frequency(void) const;
+
+    //! The hardware key of the device
+    std::string hardwareKey(void) const;
+
+    //! The process that owns the device
+    long long ownerPid(void) const;
+
+    //! Continue from the newest published buffer
+    void resync(void);
+
+    /*!
+     * Acquire the next buffer.
+     * \param [out] handle the slot index of the buffer
+     * \param [out] buffs the channel buffers of the slot
+     * \param [out] flags the stream flags of the buffer
+     * \param [out] timeNs the stream time of the buffer
+     * \param timeoutUs how long to wait for a buffer
+     * \return the number of elements, SOAPY_SDR_TIMEOUT, SOAPY_SDR_OVERFLOW,
+     * or SOAPY_SDR_STREAM_ERROR when the broker has closed, failed, or exited
+     */
+    int acquire(size_t &handle, const void **buffs, int &flags, long long &timeNs, const long timeoutUs);
+
+    /*!
+     * Release an acquired buffer.
+     * \param handle the handle from acquire()
+     */
+    void release(const size_t handle);
+
+    /*!
+     * Get the channel buffers of a slot.
+     * \param handle a slot index less than numBuffers()
+     * \param [out] buffs the channel buffers of the slot
+     */
+    void bufferAddrs(const size_t handle, const void **buffs) const;
+
+    //! The number of times this reader fell behind or held a buffer too long
+    unsigned long long numOverflows(void) const;
+
+    //! The number of buffers that this reader skipped
+    unsigned long long numDropped(void) const;
+
+private:
+    BrokerReader(const BrokerReader &);
+    BrokerReader &operator=(const BrokerReader &);
+    struct Impl;
+    Impl *_impl;
+};
+
+}
@@ -0,0 +1,114 @@
+///
+/// \file SoapySDR/Buffers.hpp
+///
+/// Aligned stream buffer allocation with hugepage and NUMA placement.
+///
+/// \copyright
+/// Copyright (c) 2018-2018 Josh Blum
+/// SPDX-License-Identifier: BSL-1.0
+///
+
+#pragma once
+#include <SoapySDR/Config.hpp>
+#include <vector>
+#include <string>
+#include <cstddef> //size_t
+
+//! The minimum alignment of every buffer from allocBuffer() in bytes
+#define SOAPY_SDR_BUFFER_ALIGNMENT 64
+
+//! Back the buffer with huge pages when the system provides them
+#define SOAPY_SDR_BUFFER_HUGE_PAGES (1 << 0)
+
+namespace SoapySDR
+{
+
+class Device;
+class Stream;
+
+/*!
+ * Allocate a buffer for stream samples.
+ * The buffer is aligned to at least SOAPY_SDR_BUFFER_ALIGNMENT,
+ * so that converters and drivers may use aligned vector loads.
+ *
+ * With SOAPY_SDR_BUFFER_HUGE_PAGES the buffer is mapped from the huge page pool,
+ * or from regular pages advised for transparent huge pages when the pool is empty.
+ * A NUMA node binds the pages to that node, see ThreadHints::bindMemory().
+ * Huge pages and NUMA binding are linux only and ignored elsewhere.
+ *
+ * \param size the buffer size in bytes
+ * \param flags optional SOAPY_SDR_BUFFER_* flags
+ * \param numaNode the NUMA node for the pages, or -1 for no preference
+ * \param alignment the alignment in bytes, a power of two, raised to the minimum
+ * \return the buffer, released with freeBuffer()
+ * \throws std::bad_alloc when the memory is not available
+ */
+SOAPY_SDR_API void *allocBuffer(const size_t size, const int flags = 0, const int numaNode = -1, const size_t alignment = SOAPY_SDR_BUFFER_ALIGNMENT);
+
+//! Release a buffer from allocBuffer(), null is ignored
+SOAPY_SDR_API void freeBuffer(void *buff);
+
+/*!
+ * A set of per-channel stream buffers in a single allocation.
+ *
+ * Each of numBuffs entries has one buffer per channel of numElems elements,
+ * and every channel buffer starts on an aligned boundary.
+ * Resizing to a layout that fits the current allocation reuses the memory,
+ * so that a pool kept across stream setups does not allocate again.
+ *
+ * \code
+ * auto stream = device->setupStream(SOAPY_SDR_RX, SOAPY_SDR_CS16, channels);
+ * SoapySDR::BufferPool pool(device, stream, channels.size(), SOAPY_SDR_CS16);
+ * device->readStream(stream, pool.buffs(0), pool.numElems(), flags, timeNs);
+ * \endcode
+ */
+class SOAPY_SDR_API BufferPool
+{
+public:
+
+    //! Create an empty pool without an allocation
+    BufferPool(void);
+
+    //! Create a pool, see resize()
+    BufferPool(const size_t numChans, const size_t numElems, const size_t elemSize, const size_t numBuffs = 1, const int flags = 0, const int numaNode = -1);
+
+    //! Create a pool of MTU sized buffers for a stream in the given format
+    BufferPool(Device *device, Stream *stream, const size_t numChans, const std::string &format, const size_t numBuffs = 1, const int flags = 0, const int numaNode = -1);
+
+    ~BufferPool(void);
+
+    /*!
+     * Change the layout of the pool.
+     * The memory is reallocated only when the new layout
+     * is larger than the allocation or the placement changed.
+     * The contents are not preserved.
+     */
+    void resize(const size_t numChans, const size_t numElems, const size_t elemSize, const size_t numBuffs = 1, const int flags = 0, const int numaNode = -1);
+
+    //! The number of buffer entries
+    size_t numBuffs(void) const;
+
+    //! The number of channels per entry
+    size_t numChans(void) const;
+
+    //! The number of elements in each channel buffer
+    size_t numElems(void) const;
+
+    //! The per-channel buffer pointers of an entry, for read/writeStream()
+    void * const *buffs(const size_t index = 0) const;
+
+private:
+    BufferPool(const BufferPool &);
+    BufferPool &operator=(const BufferPool &);
+
+    void *_mem;
+    size_t _capacity;
+    int _flags;
+    int _numaNode;
+    size_t _numBuffs;
+    size_t _numChans;
+    size_t _numElems;
+    std::vector<void *> _buffs;
+};
+
+}
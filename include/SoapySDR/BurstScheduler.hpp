@@ -0,0 +1,111 @@
+///
+/// \file SoapySDR/BurstScheduler.hpp
+///
+/// Queued transmission of timed bursts for writeStream().
+///
+/// \copyright
+/// Copyright (c) 2018-2018 Josh Blum
+/// SPDX-License-Identifier: BSL-1.0
+///
+
+#pragma once
+#include <SoapySDR/Config.hpp>
+#include <SoapySDR/Types.hpp>
+#include <cstddef> //size_t
+
+namespace SoapySDR
+{
+
+class Device;
+class Stream;
+
+/*!
+ * Transmit timed bursts from a thread on behalf of the caller.
+ *
+ * Bursts are copied into a queue with their start times. The scheduler
+ * thread writes each burst a lead time before it is due, in MTU sized
+ * writeStream() calls with SOAPY_SDR_HAS_TIME on the first and
+ * SOAPY_SDR_END_BURST on the last. Bursts that follow each other within
+ * max_gap_us are coalesced into one burst, with zeros in the gaps, so
+ * that many short bursts use whole MTU transfers.
+ *
+ * A burst that is already due when the scheduler reaches it is dropped
+ * and reported by readStreamStatus() as SOAPY_SDR_TIME_ERROR with
+ * the burst time. Other stream status comes from the device.
+ *
+ * Scheduler args:
+ *  - lead_us: how long before the burst time to write it (default 10000)
+ *  - max_gap_us: the largest gap between coalesced bursts (default 0, back to back only)
+ *  - queue: the number of bursts that can wait in the queue (default 64)
+ *  - the thread placement args of SoapySDR/ThreadHints.hpp
+ *
+ * \code
+ * auto stream = device->setupStream(SOAPY_SDR_TX, SOAPY_SDR_CF32);
+ * SoapySDR::BurstScheduler scheduler(device, stream, 1, sizeof(std::complex<float>), rate);
+ * device->activateStream(stream);
+ * const long long start = device->getHardwareTime() + 100000000;
+ * for (size_t i = 0; i < numSlots; i++) scheduler.submit(buffs, slotElems, start + i*slotNs, 100000);
+ * scheduler.flush(1000000);
+ * \endcode
+ */
+class SOAPY_SDR_API BurstScheduler
+{
+public:
+
+    /*!
+     * Start the scheduler thread for an activated or soon activated stream.
+     * \param device the device to transmit with, used until the scheduler is destroyed
+     * \param stream the TX stream, not written by the caller while scheduled
+     * \param numChans the number of channels of the stream
+     * \param elemSize the size of an element of the stream format in bytes
+     * \param rate the sample rate, which gives the end times of the bursts
+     * \param args the scheduler args
+     */
+    BurstScheduler(Device *device, Stream *stream, const size_t numChans, const size_t elemSize, const double rate, const Kwargs &args = Kwargs());
+
+    //! Stop the scheduler thread, bursts that were not written are discarded
+    ~BurstScheduler(void);
+
+    /*!
+     * Queue a copy of a burst.
+     * \param buffs a buffer per channel
+     * \param numElems the number of elements in each buffer
+     * \param timeNs the hardware time of the first element
+     * \param timeoutUs how long to wait for room in the queue
+     * \return 0 or SOAPY_SDR_TIMEOUT when the queue stayed full
+     */
+    int submit(const void * const *buffs, const size_t numElems, const long long timeNs, const long timeoutUs = 100000);
+
+    /*!
+     * Wait for the queued bursts to be written.
+     * \param timeoutUs how long to wait
+     * \return true when every burst was written or dropped
+     */
+    bool flush(const long timeoutUs = 100000);
+
+    /*!
+     * Read the late burst reports, then the device stream status.
+     * The arguments and return codes are those of Device::readStreamStatus().
+     */
+    int readStreamStatus(size_t &chanMask, int &flags, long long &timeNs, const long timeoutUs = 100000);
+
+    //! The number of bursts waiting in the queue
+    size_t numQueued(void) const;
+
+    //! The number of bursts that were written
+    unsigned long long numBursts(void) const;
+
+    //! The number of bursts that were dropped because they were late
+    unsigned long long numLate(void) const;
+
+    //! The number of writeStream() calls made
+    unsigned long long numWrites(void) const;
+
+private:
+    BurstScheduler(const BurstScheduler &);
+    BurstScheduler &operator=(const BurstScheduler &);
+    struct Impl;
+    Impl *_impl;
+};
+
+}
@@ -0,0 +1,68 @@
+///
+/// \file SoapySDR/ConverterPool.hpp
+///
+/// Multi-threaded batch conversion for multi-channel streams.
+///
+/// \copyright
+/// Copyright (c) 2018-2018 Josh Blum
+/// SPDX-License-Identifier: BSL-1.0
+///
+
+#pragma once
+#include <SoapySDR/Config.hpp>
+#include <SoapySDR/ConverterRegistry.hpp>
+#include <cstddef>
+
+namespace SoapySDR
+{
+
+/*!
+ * A persistent pool of worker threads for converting many channels at once.
+ * The work is split one channel per task when there are enough channels,
+ * otherwise each channel is split into large chunks to occupy every thread.
+ * The calling thread participates in the conversion and convert() blocks
+ * until all channels are finished. Concurrent calls are serialized.
+ */
+class SOAPY_SDR_API ConverterPool
+{
+public:
+
+    /*!
+     * Create a new conversion pool.
+     * \param numThreads the total number of threads including the caller,
+     * or 0 to use the number of hardware threads on this system
+     */
+    ConverterPool(const size_t numThreads = 0);
+
+    //! Stop and join the worker threads
+    ~ConverterPool(void);
+
+    //! Get the total number of threads used for conversion
+    size_t getNumThreads(void) const;
+
+    /*!
+     * Convert an array of channel buffers.
+     * The buffer arrays follow the same layout as Device::readStream().
+     * \param converter a resolved converter from ConverterRegistry::getConverter()
+     * \param srcBuffs an array of numChans source buffers
+     * \param dstBuffs an array of numChans destination buffers
+     * \param numChans the number of channels in the buffer arrays
+     * \param numElems the number of elements in each channel buffer
+     * \param scaler the optional scale factor for the conversion
+     */
+    void convert(
+        const ConverterRegistry::Converter &converter,
+        const void * const *srcBuffs,
+        void * const *dstBuffs,
+        const size_t numChans,
+        const size_t numElems,
+        const double scaler = 1.0);
+
+private:
+    ConverterPool(const ConverterPool &);
+    ConverterPool &operator=(const ConverterPool &);
+    struct Impl;
+    Impl *_impl;
+};
+
+}
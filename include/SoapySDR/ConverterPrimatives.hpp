@@ -150,4 +150,80 @@ inline int8_t U16toS8(uint16_t from){
 }
 
 
+/*!
+ * Scaled conversion primatives with a precomputed single precision gain.
+ * The gain folds the optional scaler and the full scale into one constant,
+ * so that converting a sample takes a single float multiply.
+ * Unsigned formats use the gain of the signed format with the same width.
+ * \param scaler the optional scale factor of the conversion
+ * \return the gain to pass into the scaled conversion primatives
+ */
+
+inline float F32toS32Gain(const double scaler){
+  return float(scaler * S32_FULL_SCALE);
+}
+inline float S32toF32Gain(const double scaler){
+  return float(scaler / S32_FULL_SCALE);
+}
+
+inline float F32toS16Gain(const double scaler){
+  return float(scaler * S16_FULL_SCALE);
+}
+inline float S16toF32Gain(const double scaler){
+  return float(scaler / S16_FULL_SCALE);
+}
+
+inline float F32toS8Gain(const double scaler){
+  return float(scaler * S8_FULL_SCALE);
+}
+inline float S8toF32Gain(const double scaler){
+  return float(scaler / S8_FULL_SCALE);
+}
+
+// scaled type conversion: float <> signed integers
+
+inline int32_t F32toS32(float from, const float gain){
+  return int32_t(from * gain);
+}
+inline float S32toF32(int32_t from, const float gain){
+  return float(from) * gain;
+}
+
+inline int16_t F32toS16(float from, const float gain){
+  return int16_t(from * gain);
+}
+inline float S16toF32(int16_t from, const float gain){
+  return float(from) * gain;
+}
+
+inline int8_t F32toS8(float from, const float gain){
+  return int8_t(from * gain);
+}
+inline float S8toF32(int8_t from, const float gain){
+  return float(from) * gain;
+}
+
+// scaled type conversion: float <> unsigned integers
+
+inline uint32_t F32toU32(float from, const float gain){
+  return S32toU32(F32toS32(from, gain));
+}
+inline float U32toF32(uint32_t from, const float gain){
+  return S32toF32(U32toS32(from), gain);
+}
+
+inline uint16_t F32toU16(float from, const float gain){
+  return S16toU16(F32toS16(from, gain));
+}
+inline float U16toF32(uint16_t from, const float gain){
+  return S16toF32(U16toS16(from), gain);
+}
+
+inline uint8_t F32toU8(float from, const float gain){
+  return S8toU8(F32toS8(from, gain));
+}
+inline float U8toF32(uint8_t from, const float gain){
+  return S8toF32(U8toS8(from), gain);
+}
+
 }
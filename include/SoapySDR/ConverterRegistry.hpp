@@ -27,9 +27,35 @@ namespace SoapySDR
      * A typedef for a conversion function pointer.
      * A conversion function converts an input buffer into an output buffer.
      * The parameters are (input pointer, output pointer, number of elements, optional scalar)
+     *
+     * Aliasing contract: the input and output buffers must not overlap,
+     * unless the function was registered as in-place capable,
+     * in which case the output pointer may equal the input pointer.
+     * Use supportsInPlace() to query a registered conversion.
      */
     typedef void (*ConverterFunction)(const void *, void *, const size_t, const double);
 
+    /*!
+     * A typedef for a fused deinterleave conversion function pointer.
+     * A deinterleave function converts one buffer of interleaved channels
+     * into one output buffer per channel in a single pass.
+     * The parameters are (input pointer, array of output pointers, number of channels,
+     * input stride in elements, number of elements per channel, optional scalar).
+     * The stride is the distance in elements between consecutive samples
+     * of the same channel in the interleaved buffer (at least the number of channels).
+     */
+    typedef void (*DeinterleaveFunction)(const void *, void * const *, const size_t, const size_t, const size_t, const double);
+
+    /*!
+     * A typedef for a fused interleave conversion function pointer.
+     * An interleave function converts one input buffer per channel
+     * into one buffer of interleaved channels in a single pass.
+     * The parameters are (array of input pointers, output pointer, number of channels,
+     * output stride in elements, number of elements per channel, optional scalar).
+     * Padding elements in the output stride beyond the channel count are not written.
+     */
+    typedef void (*InterleaveFunction)(const void * const *, void *, const size_t, const size_t, const size_t, const double);
+
     /*!
      * FormatConverterPriority: allow selection of a converter function with a given source and target format
      */
@@ -54,6 +80,51 @@ namespace SoapySDR
      */
     typedef std::map<std::string, TargetFormatConverters> FormatConverters;
 
+    /*!
+     * FormatId: an interned integer identifier for a format markup string.
+     * Format identifiers are stable for the lifetime of the process.
+     */
+    typedef size_t FormatId;
+
+    /*!
+     * Converter: a resolved conversion function and its element sizes.
+     * Resolve the converter once, for example in setupStream(),
+     * then call it in the streaming path without any lookups.
+     * The object is small and cheap to copy.
+     */
+    struct SOAPY_SDR_API Converter
+    {
+      //! Create an unresolved converter
+      Converter(void);
+
+      //! The resolved conversion function or nullptr
+      ConverterFunction function;
+
+      //! The priority of the resolved conversion function
+      FunctionPriority priority;
+
+      //! The size in bytes of a single source element
+      size_t sourceElemSize;
+
+      //! The size in bytes of a single target element
+      size_t targetElemSize;
+
+      //! True when the function may convert with the same source and target buffer
+      bool inPlace;
+
+      //! True when the converter holds a conversion function
+      explicit operator bool(void) const
+      {
+        return function != nullptr;
+      }
+
+      //! Convert numElems from the source buffer into the target buffer
+      void operator()(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler = 1.0) const
+      {
+        function(srcBuff, dstBuff, numElems, scaler);
+      }
+    };
+
     /*!
      * Class constructor for managing the Converter Registry.
      * refuses to register converter and logs error if a source/target/priority entry already exists
@@ -63,6 +134,39 @@ namespace SoapySDR
      * \param converter function to register
      */
     ConverterRegistry(const std::string &sourceFormat, const std::string &targetFormat, const FunctionPriority &priority, ConverterFunction converter);
+
+    /*!
+     * Class constructor for managing the Converter Registry.
+     * refuses to register converter and logs error if a source/target/priority entry already exists
+     * \param sourceFormat the source format markup string
+     * \param targetFormat the target format markup string
+     * \param priority the FunctionPriority of the converter to register
+     * \param converter function to register
+     * \param inPlace true when the function supports the same input and output buffer
+     */
+    ConverterRegistry(const std::string &sourceFormat, const std::string &targetFormat, const FunctionPriority &priority, ConverterFunction converter, const bool inPlace);
+
+    /*!
+     * Register a fused deinterleave converter.
+     * The source format is the format of the interleaved buffer.
+     * refuses to register converter and logs error if a source/target/priority entry already exists
+     * \param sourceFormat the source format markup string
+     * \param targetFormat the target format markup string
+     * \param priority the FunctionPriority of the converter to register
+     * \param converter function to register
+     */
+    ConverterRegistry(const std::string &sourceFormat, const std::string &targetFormat, const FunctionPriority &priority, DeinterleaveFunction converter);
+
+    /*!
+     * Register a fused interleave converter.
+     * The target format is the format of the interleaved buffer.
+     * refuses to register converter and logs error if a source/target/priority entry already exists
+     * \param sourceFormat the source format markup string
+     * \param targetFormat the target format markup string
+     * \param priority the FunctionPriority of the converter to register
+     * \param converter function to register
+     */
+    ConverterRegistry(const std::string &sourceFormat, const std::string &targetFormat, const FunctionPriority &priority, InterleaveFunction converter);
     
     /*!
      * Get a list of formats to which we can convert the source format into.
@@ -100,6 +204,89 @@ namespace SoapySDR
     static ConverterFunction getFunction(const std::string &sourceFormat, const std::string &targetFormat);
     static ConverterFunction getFunction(const std::string &sourceFormat, const std::string &targetFormat, const FunctionPriority &priority);
 
+    /*!
+     * Get the highest priority converter between a source and target format ID.
+     * This lookup is a constant-time table access without allocations.
+     * \throws runtime_error when the conversion does not exist
+     * \param sourceFormat the source format identifier from getFormatId()
+     * \param targetFormat the target format identifier from getFormatId()
+     * \return a conversion function pointer
+     */
+    static ConverterFunction getFunction(const FormatId sourceFormat, const FormatId targetFormat);
+
+    /*!
+     * Get a resolved converter handle between a source and target format.
+     * \throws runtime_error when the conversion does not exist
+     * \param sourceFormat the source format markup string
+     * \param targetFormat the target format markup string
+     * \return a resolved converter with the highest priority function
+     */
+    static Converter getConverter(const std::string &sourceFormat, const std::string &targetFormat);
+    static Converter getConverter(const std::string &sourceFormat, const std::string &targetFormat, const FunctionPriority &priority);
+
+    /*!
+     * Query if a conversion can be performed in-place.
+     * In-place means that the source and target pointers are the same buffer,
+     * which is possible when the target element is not larger than the source element.
+     * \param sourceFormat the source format markup string
+     * \param targetFormat the target format markup string
+     * \return true when the function returned by getFunction() supports in-place conversion
+     */
+    static bool supportsInPlace(const std::string &sourceFormat, const std::string &targetFormat);
+    static bool supportsInPlace(const std::string &sourceFormat, const std::string &targetFormat, const FunctionPriority &priority);
+
+    /*!
+     * Get a fused deinterleave converter between a source and target format.
+     * \throws runtime_error when the conversion does not exist
+     * \param sourceFormat the format markup string of the interleaved buffer
+     * \param targetFormat the format markup string of the channel buffers
+     * \return the highest priority or the requested priority function pointer
+     */
+    static DeinterleaveFunction getDeinterleaveFunction(const std::string &sourceFormat, const std::string &targetFormat);
+    static DeinterleaveFunction getDeinterleaveFunction(const std::string &sourceFormat, const std::string &targetFormat, const FunctionPriority &priority);
+
+    /*!
+     * Get a fused interleave converter between a source and target format.
+     * \throws runtime_error when the conversion does not exist
+     * \param sourceFormat the format markup string of the channel buffers
+     * \param targetFormat the format markup string of the interleaved buffer
+     * \return the highest priority or the requested priority function pointer
+     */
+    static InterleaveFunction getInterleaveFunction(const std::string &sourceFormat, const std::string &targetFormat);
+    static InterleaveFunction getInterleaveFunction(const std::string &sourceFormat, const std::string &targetFormat, const FunctionPriority &priority);
+
+    /*!
+     * Get the interned identifier for a format markup string.
+     * Unknown formats are interned on first use,
+     * so that identifiers can be resolved before registration.
+     * \param format the format markup string
+     * \return the identifier for the format
+     */
+    static FormatId getFormatId(const std::string &format);
+
+    /*!
+     * Get the format markup string for an interned identifier.
+     * \throws out_of_range when the identifier was never interned
+     * \param formatId the format identifier from getFormatId()
+     * \return the format markup string
+     */
+    static std::string getFormatName(const FormatId formatId);
+
+    /*!
+     * Select the fastest converter priority by timing on first use.
+     * By default getFunction() returns the highest registered priority.
+     * When calibration is enabled, getFunction() and getConverter()
+     * time each registered priority the first time that a conversion
+     * is requested and then return the fastest one for this machine.
+     * Calibration can also be enabled with the environment variable
+     * SOAPY_SDR_CONVERTER_CALIBRATION=1 or SOAPY_SDR_CONVERTER_CALIBRATION=persist.
+     * Persisted results are stored in getRootPath()/share/SoapySDR/ConverterCalibration.txt,
+     * or the file named by the environment variable SOAPY_SDR_CONVERTER_CALIBRATION_FILE.
+     * \param enable true to enable calibration, false to restore the default selection
+     * \param persist true to load and save calibration results in the calibration file
+     */
+    static void setCalibrationMode(const bool enable, const bool persist = false);
+
     /*!
      * Get a list of known source formats in the registry.
      */
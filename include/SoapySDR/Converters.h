@@ -0,0 +1,88 @@
+///
+/// \file SoapySDR/Converters.h
+///
+/// Convert buffers between stream formats.
+/// C bindings for the ConverterRegistry.
+///
+/// \copyright
+/// Copyright (c) 2018-2018 Josh Blum
+/// SPDX-License-Identifier: BSL-1.0
+///
+
+#pragma once
+#include <SoapySDR/Config.h>
+#include <stddef.h> //size_t
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * A typedef for a conversion function pointer.
+ * The parameters are (input pointer, output pointer, number of elements, optional scalar).
+ * The input and output buffers must not overlap.
+ */
+typedef void (*SoapySDRConverterFunction)(const void *, void *, const size_t, const double);
+
+//! Allow selection of a converter function with a given source and target format
+typedef enum
+{
+    SOAPY_SDR_CONVERTER_GENERIC = 0, //!< usual C for-loops, shifts, multiplies, etc
+    SOAPY_SDR_CONVERTER_VECTORIZED = 3, //!< vectorized operations such as SIMD
+    SOAPY_SDR_CONVERTER_CUSTOM = 5 //!< custom user re-implementation, max priority
+} SoapySDRConverterFunctionPriority;
+
+/*!
+ * Get a list of formats to which we can convert the source format into.
+ * \param sourceFormat the source format markup string
+ * \param [out] length the number of target formats
+ * \return a list of target formats, free with SoapySDRStrings_clear()
+ */
+SOAPY_SDR_API char **SoapySDRConverter_listTargetFormats(const char *sourceFormat, size_t *length);
+
+/*!
+ * Get a list of formats to which we can convert the target format from.
+ * \param targetFormat the target format markup string
+ * \param [out] length the number of source formats
+ * \return a list of source formats, free with SoapySDRStrings_clear()
+ */
+SOAPY_SDR_API char **SoapySDRConverter_listSourceFormats(const char *targetFormat, size_t *length);
+
+/*!
+ * Get a list of available converter priorities for a given source and target format.
+ * \param sourceFormat the source format markup string
+ * \param targetFormat the target format markup string
+ * \param [out] length the number of priorities
+ * \return a list of priorities, free with free()
+ */
+SOAPY_SDR_API SoapySDRConverterFunctionPriority *SoapySDRConverter_listPriorities(const char *sourceFormat, const char *targetFormat, size_t *length);
+
+/*!
+ * Get the highest priority converter between a source and target format.
+ * On failure, the error is available from SoapySDRDevice_lastError().
+ * \param sourceFormat the source format markup string
+ * \param targetFormat the target format markup string
+ * \return a conversion function pointer or NULL on error
+ */
+SOAPY_SDR_API SoapySDRConverterFunction SoapySDRConverter_getFunction(const char *sourceFormat, const char *targetFormat);
+
+/*!
+ * Get a converter between a source and target format with a given priority.
+ * On failure, the error is available from SoapySDRDevice_lastError().
+ * \param sourceFormat the source format markup string
+ * \param targetFormat the target format markup string
+ * \param priority the priority of the conversion function
+ * \return a conversion function pointer or NULL on error
+ */
+SOAPY_SDR_API SoapySDRConverterFunction SoapySDRConverter_getFunctionWithPriority(const char *sourceFormat, const char *targetFormat, const SoapySDRConverterFunctionPriority priority);
+
+/*!
+ * Get a list of known source formats in the registry.
+ * \param [out] length the number of source formats
+ * \return a list of source formats, free with SoapySDRStrings_clear()
+ */
+SOAPY_SDR_API char **SoapySDRConverter_listAvailableSourceFormats(size_t *length);
+
+#ifdef __cplusplus
+}
+#endif
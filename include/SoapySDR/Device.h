@@ -18,6 +18,7 @@
 #include <SoapySDR/Types.h>
 #include <SoapySDR/Constants.h>
 #include <SoapySDR/Errors.h>
+#include <stdint.h> //intptr_t
 #include <SoapySDR/Device.h>
 
 #ifdef __cplusplus
@@ -30,9 +31,82 @@ typedef struct SoapySDRDevice SoapySDRDevice;
 //! Forward declaration of stream handle
 typedef struct SoapySDRStream SoapySDRStream;
 
+//! Forward declaration of an asynchronous enumerate result
+typedef struct SoapySDREnumerateFuture SoapySDREnumerateFuture;
+
+//! Forward declaration of an asynchronous make result
+typedef struct SoapySDRMakeFuture SoapySDRMakeFuture;
+
+//! Forward declaration of a batch of queued settings
+typedef struct SoapySDRSettingsTransaction SoapySDRSettingsTransaction;
+
+//! Forward declaration of a sensor subscription handle
+typedef struct SoapySDRSensorSubscription SoapySDRSensorSubscription;
+
+//! Identifies a global sensor or a channel sensor for a subscription
+typedef struct
+{
+    //! the ID name of an available sensor
+    const char *key;
+
+    //! true for a channel sensor
+    bool isChannel;
+
+    //! the channel direction RX or TX
+    int direction;
+
+    //! an available channel on the device
+    size_t channel;
+} SoapySDRSensor;
+
+/*!
+ * A typed sensor reading from a subscription.
+ * The text of STRING sensors is only available from readSensor().
+ */
+typedef struct
+{
+    //! the sensor type from getSensorInfo(), see SoapySDRArgInfoType
+    int type;
+
+    //! false when the readback failed or did not parse as the type
+    bool valid;
+
+    //! the value for BOOL, or a non-zero numeric value
+    bool boolValue;
+
+    //! the value for INT, or the rounded numeric value
+    long long intValue;
+
+    //! the value for FLOAT, or the numeric value
+    double floatValue;
+} SoapySDRSensorValue;
+
+/*!
+ * Callback for sensor subscription updates.
+ * \param values an array of values, one per subscribed sensor
+ * \param length the number of values in the array
+ * \param userData the user data from SoapySDRDevice_subscribeSensors()
+ */
+typedef void (*SoapySDRSensorCallback)(const SoapySDRSensorValue *values, const size_t length, void *userData);
+
+//! Forward declaration of a stream subscription handle
+typedef struct SoapySDRStreamSubscription SoapySDRStreamSubscription;
+
+/*!
+ * Callback for the buffers of a stream subscription.
+ * \param buffs the channel buffers, valid until the callback returns
+ * \param ret the number of elements per buffer or an error code
+ * \param flags the flags of the buffer like SOAPY_SDR_HAS_TIME
+ * \param timeNs the hardware time of the first element
+ * \param userData the user data from SoapySDRDevice_subscribeStream()
+ */
+typedef void (*SoapySDRStreamCallback)(const void * const *buffs, const int ret, const int flags, const long long timeNs, void *userData);
+
 /*!
  * Get the last status code after a Device API call.
- * The status code is cleared on entry to each Device call.
+ * The status code is cleared on entry to each Device call,
+ * except for the stream fast path calls, see SoapySDRDevice_readStreamFast().
+ * The status is stored per thread.
  * When an device API call throws, the C bindings catch
  * the exception, and set a non-zero last status code.
  * Use lastStatus() to determine success/failure for
@@ -57,6 +131,16 @@ SOAPY_SDR_API const char *SoapySDRDevice_lastError(void);
  */
 SOAPY_SDR_API SoapySDRKwargs *SoapySDRDevice_enumerate(const SoapySDRKwargs *args, size_t *length);
 
+/*!
+ * Enumerate devices into a single allocation.
+ * The result and all of its strings are released with one call to free().
+ * The result is read-only, do not pass it to SoapySDRKwargs_set() or SoapySDRKwargs_clear().
+ * \param args device construction key/value argument filters
+ * \param [out] length the number of elements in the result.
+ * \return a list of arguments strings, each unique to a device
+ */
+SOAPY_SDR_API SoapySDRKwargs *SoapySDRDevice_enumerateArena(const SoapySDRKwargs *args, size_t *length);
+
 /*!
  * Enumerate a list of available devices on the system.
  * Markup format for args: "keyA=valA, keyB=valB".
@@ -96,6 +180,91 @@ SOAPY_SDR_API SoapySDRDevice *SoapySDRDevice_makeStrArgs(const char *args);
  */
 SOAPY_SDR_API int SoapySDRDevice_unmake(SoapySDRDevice *device);
 
+/*!
+ * Make multiple Device objects given a list of construction args.
+ * A single enumeration is shared between all of the args,
+ * and the devices are constructed in parallel.
+ * If any device fails to construct, the others are unmade.
+ *
+ * \param argsList a list of device construction key/value argument maps
+ * \param length the number of elements in the args list
+ * \return an array of device pointers in the same order as the args,
+ * which the caller frees with free(), or null for error
+ */
+SOAPY_SDR_API SoapySDRDevice **SoapySDRDevice_makeList(const SoapySDRKwargs *argsList, const size_t length);
+
+/*!
+ * Unmake or release multiple device object handles in parallel.
+ * The array itself remains owned by the caller.
+ *
+ * \param devices an array of pointers to device objects
+ * \param length the number of elements in the devices array
+ * \return 0 for success or error code on failure
+ */
+SOAPY_SDR_API int SoapySDRDevice_unmakeList(SoapySDRDevice **devices, const size_t length);
+
+/*!
+ * Set the time to live for cached enumeration results.
+ * \param seconds the time to live in seconds, 0 to disable the cache
+ */
+SOAPY_SDR_API void SoapySDRDevice_setEnumerateCacheTTL(const double seconds);
+
+/*!
+ * Invalidate cached enumeration results.
+ * \param driver the driver key, or NULL or empty for all drivers
+ */
+SOAPY_SDR_API void SoapySDRDevice_invalidateEnumerateCache(const char *driver);
+
+/*!
+ * Enumerate devices in a background thread.
+ * The future must be consumed with SoapySDREnumerateFuture_get().
+ * \param args device construction key/value argument filters
+ * \return a future for the enumeration result or null for error
+ */
+SOAPY_SDR_API SoapySDREnumerateFuture *SoapySDRDevice_enumerateAsync(const SoapySDRKwargs *args);
+
+/*!
+ * Wait for an asynchronous enumeration to complete.
+ * \param future the future from SoapySDRDevice_enumerateAsync()
+ * \param timeoutUs the timeout in microseconds, 0 to poll, negative to wait forever
+ * \return 0 when the result is ready or SOAPY_SDR_TIMEOUT
+ */
+SOAPY_SDR_API int SoapySDREnumerateFuture_wait(SoapySDREnumerateFuture *future, const long timeoutUs);
+
+/*!
+ * Get the result of an asynchronous enumeration and free the future.
+ * This call blocks until the result is ready.
+ * \param future the future from SoapySDRDevice_enumerateAsync()
+ * \param [out] length the number of elements in the result.
+ * \return a list of arguments strings, each unique to a device
+ */
+SOAPY_SDR_API SoapySDRKwargs *SoapySDREnumerateFuture_get(SoapySDREnumerateFuture *future, size_t *length);
+
+/*!
+ * Make a new Device object in a background thread.
+ * The future must be consumed with SoapySDRMakeFuture_get().
+ * \param args device construction key/value argument map
+ * \return a future for the device or null for error
+ */
+SOAPY_SDR_API SoapySDRMakeFuture *SoapySDRDevice_makeAsync(const SoapySDRKwargs *args);
+
+/*!
+ * Wait for an asynchronous make to complete.
+ * \param future the future from SoapySDRDevice_makeAsync()
+ * \param timeoutUs the timeout in microseconds, 0 to poll, negative to wait forever
+ * \return 0 when the result is ready or SOAPY_SDR_TIMEOUT
+ */
+SOAPY_SDR_API int SoapySDRMakeFuture_wait(SoapySDRMakeFuture *future, const long timeoutUs);
+
+/*!
+ * Get the result of an asynchronous make and free the future.
+ * This call blocks until the result is ready.
+ * On failure, the error is available from SoapySDRDevice_lastError().
+ * \param future the future from SoapySDRDevice_makeAsync()
+ * \return a pointer to a new Device object or null for error
+ */
+SOAPY_SDR_API SoapySDRDevice *SoapySDRMakeFuture_get(SoapySDRMakeFuture *future);
+
 /*******************************************************************
  * Identification API
  ******************************************************************/
@@ -392,6 +561,64 @@ SOAPY_SDR_API int SoapySDRDevice_writeStream(SoapySDRDevice *device,
     const long long timeNs,
     const long timeoutUs);
 
+/*!
+ * Read several buffers from a stream in a single call.
+ * Each entry of buffs is an array of void * with one pointer
+ * per channel, like the buffs argument of readStream().
+ * The first read waits up to the timeout, and the batch ends
+ * early when no more data is ready without waiting.
+ * An error after the first buffer ends the batch with the buffers
+ * read so far, and is returned by the next call for the stream.
+ *
+ * \param device a pointer to a device instance
+ * \param stream the opaque pointer to a stream handle
+ * \param buffs an array of numBuffs arrays of void* buffers
+ * \param numBuffs the number of buffers in the batch
+ * \param numElems the number of elements in each buffer
+ * \param [out] elems the number of elements read per buffer
+ * \param [out] flags optional flag indicators about each result or NULL
+ * \param [out] timeNs optional timestamp of each buffer in nanoseconds or NULL
+ * \param timeoutUs the timeout in microseconds
+ * \return the number of buffers read or error code
+ */
+SOAPY_SDR_API int SoapySDRDevice_readStreamBatch(SoapySDRDevice *device,
+    SoapySDRStream *stream,
+    void * const * const *buffs,
+    const size_t numBuffs,
+    const size_t numElems,
+    size_t *elems,
+    int *flags,
+    long long *timeNs,
+    const long timeoutUs);
+
+/*!
+ * Write several buffers to a stream in a single call.
+ * Each entry of buffs is an array of void * with one pointer
+ * per channel, like the buffs argument of writeStream().
+ * The batch ends early on an error or a partial write of a buffer,
+ * an error after the first buffer is returned by the next call.
+ *
+ * \param device a pointer to a device instance
+ * \param stream the opaque pointer to a stream handle
+ * \param buffs an array of numBuffs arrays of void* buffers
+ * \param numBuffs the number of buffers in the batch
+ * \param numElems the number of elements in each buffer
+ * \param [out] elems the number of elements written per buffer
+ * \param [inout] flags optional input flags and output flags per buffer or NULL
+ * \param timeNs optional timestamp of each buffer in nanoseconds or NULL
+ * \param timeoutUs the timeout in microseconds
+ * \return the number of buffers written or error code
+ */
+SOAPY_SDR_API int SoapySDRDevice_writeStreamBatch(SoapySDRDevice *device,
+    SoapySDRStream *stream,
+    const void * const * const *buffs,
+    const size_t numBuffs,
+    const size_t *numElems,
+    size_t *elems,
+    int *flags,
+    const long long *timeNs,
+    const long timeoutUs);
+
 /*!
  * Readback status information about a stream.
  * This call is typically used on a transmit stream
@@ -420,6 +647,37 @@ SOAPY_SDR_API int SoapySDRDevice_readStreamStatus(SoapySDRDevice *device,
     long long *timeNs,
     const long timeoutUs);
 
+/*!
+ * Get the statistics counters for a stream.
+ * Devices created with SoapySDRDevice_make() count the
+ * stream calls that go through the API.
+ *
+ * \param device a pointer to a device instance
+ * \param stream the opaque pointer to a stream handle
+ * \param [out] stats the statistics counters
+ * \return 0 for success or error code like SOAPY_SDR_NOT_SUPPORTED
+ */
+SOAPY_SDR_API int SoapySDRDevice_getStreamStats(SoapySDRDevice *device,
+    SoapySDRStream *stream,
+    SoapySDRStreamStats *stats);
+
+/*!
+ * Get a handle that an event loop can wait on for a stream.
+ * The handle is ready while readStream() on a receive stream
+ * or readStreamStatus() on a transmit stream would not wait.
+ * On unix systems the handle is a file descriptor for poll(),
+ * on Windows it is an event HANDLE, both cast to an intptr_t.
+ * The handle belongs to the stream, do not close it.
+ *
+ * \param device a pointer to a device instance
+ * \param stream the opaque pointer to a stream handle
+ * \param [out] handle the file descriptor or event HANDLE
+ * \return 0 for success or error code like SOAPY_SDR_NOT_SUPPORTED
+ */
+SOAPY_SDR_API int SoapySDRDevice_getStreamPollHandle(SoapySDRDevice *device,
+    SoapySDRStream *stream,
+    intptr_t *handle);
+
 /*******************************************************************
  * Direct buffer access API
  ******************************************************************/
@@ -541,6 +799,96 @@ SOAPY_SDR_API void SoapySDRDevice_releaseWriteBuffer(SoapySDRDevice *device,
     int *flags,
     const long long timeNs);
 
+/*!
+ * Subscribe a callback to the buffers of a receive stream.
+ * The callback gets the direct access buffers without a copy,
+ * they are released when the callback returns.
+ * The default implementation serves all subscriptions on a device
+ * from one thread that waits on the stream poll handles.
+ * Remove the subscription before the stream is closed.
+ * \param device a pointer to a device instance
+ * \param stream the opaque pointer to a receive stream handle
+ * \param numChans the number of channels of the stream
+ * \param callback the callback invoked with every buffer
+ * \param userData user data passed to the callback
+ * \return a subscription handle or NULL on error
+ */
+SOAPY_SDR_API SoapySDRStreamSubscription *SoapySDRDevice_subscribeStream(SoapySDRDevice *device,
+    SoapySDRStream *stream,
+    const size_t numChans,
+    SoapySDRStreamCallback callback,
+    void *userData);
+
+/*!
+ * Remove a subscription from SoapySDRDevice_subscribeStream().
+ * \param device a pointer to a device instance
+ * \param subscription the subscription handle to free
+ * \return 0 for success or error code on failure
+ */
+SOAPY_SDR_API int SoapySDRDevice_unsubscribeStream(SoapySDRDevice *device, SoapySDRStreamSubscription *subscription);
+
+/*******************************************************************
+ * Stream fast path API
+ ******************************************************************/
+
+/*!
+ * The fast path calls are identical to their regular counterparts,
+ * except that they do not clear the last error state on entry.
+ * On success no global or thread-local state is touched at all,
+ * which suits bindings that call into the stream API from tight loops.
+ * When the result is SOAPY_SDR_STREAM_ERROR, SoapySDRDevice_lastStatus()
+ * and SoapySDRDevice_lastError() report an exception from the driver;
+ * otherwise they may still hold the state of an earlier call.
+ * The error state is thread-local, so streaming threads do not share it.
+ */
+
+//! Fast path SoapySDRDevice_readStream()
+SOAPY_SDR_API int SoapySDRDevice_readStreamFast(SoapySDRDevice *device,
+    SoapySDRStream *stream,
+    void * const *buffs,
+    const size_t numElems,
+    int *flags,
+    long long *timeNs,
+    const long timeoutUs);
+
+//! Fast path SoapySDRDevice_writeStream()
+SOAPY_SDR_API int SoapySDRDevice_writeStreamFast(SoapySDRDevice *device,
+    SoapySDRStream *stream,
+    const void * const *buffs,
+    const size_t numElems,
+    int *flags,
+    const long long timeNs,
+    const long timeoutUs);
+
+//! Fast path SoapySDRDevice_acquireReadBuffer()
+SOAPY_SDR_API int SoapySDRDevice_acquireReadBufferFast(SoapySDRDevice *device,
+    SoapySDRStream *stream,
+    size_t *handle,
+    const void **buffs,
+    int *flags,
+    long long *timeNs,
+    const long timeoutUs);
+
+//! Fast path SoapySDRDevice_releaseReadBuffer()
+SOAPY_SDR_API void SoapySDRDevice_releaseReadBufferFast(SoapySDRDevice *device,
+    SoapySDRStream *stream,
+    const size_t handle);
+
+//! Fast path SoapySDRDevice_acquireWriteBuffer()
+SOAPY_SDR_API int SoapySDRDevice_acquireWriteBufferFast(SoapySDRDevice *device,
+    SoapySDRStream *stream,
+    size_t *handle,
+    void **buffs,
+    const long timeoutUs);
+
+//! Fast path SoapySDRDevice_releaseWriteBuffer()
+SOAPY_SDR_API void SoapySDRDevice_releaseWriteBufferFast(SoapySDRDevice *device,
+    SoapySDRStream *stream,
+    const size_t handle,
+    const size_t numElems,
+    int *flags,
+    const long long timeNs);
+
 /*******************************************************************
  * Antenna API
  ******************************************************************/
@@ -799,6 +1147,23 @@ SOAPY_SDR_API SoapySDRRange SoapySDRDevice_getGainRange(const SoapySDRDevice *de
  */
 SOAPY_SDR_API SoapySDRRange SoapySDRDevice_getGainElementRange(const SoapySDRDevice *device, const int direction, const size_t channel, const char *name);
 
+/*!
+ * Enable or disable the gain model cache.
+ * With the cache enabled, the overall gain calls capture
+ * the element names and ranges once per channel.
+ * \param device a pointer to a device instance
+ * \param enable true to enable the cache, false to disable and clear it
+ * \return 0 for success or error code on failure
+ */
+SOAPY_SDR_API int SoapySDRDevice_enableGainCache(SoapySDRDevice *device, const bool enable);
+
+/*!
+ * Clear the captured gain model so that it is queried again.
+ * \param device a pointer to a device instance
+ * \return 0 for success or error code on failure
+ */
+SOAPY_SDR_API int SoapySDRDevice_invalidateGainCache(SoapySDRDevice *device);
+
 /*******************************************************************
  * Frequency API
  ******************************************************************/
@@ -1134,6 +1499,15 @@ SOAPY_SDR_API int SoapySDRDevice_setCommandTime(SoapySDRDevice *device, const lo
  */
 SOAPY_SDR_API char **SoapySDRDevice_listSensors(const SoapySDRDevice *device, size_t *length);
 
+/*!
+ * List the available global readback sensors into a single allocation.
+ * The result and all of its strings are released with one call to free().
+ * \param device a pointer to a device instance
+ * \param [out] length the number of sensor names
+ * \return a list of available sensor string names
+ */
+SOAPY_SDR_API char **SoapySDRDevice_listSensorsArena(const SoapySDRDevice *device, size_t *length);
+
 /*!
  * Get meta-information about a sensor.
  * Example: displayable name, type, range.
@@ -1164,6 +1538,17 @@ SOAPY_SDR_API char *SoapySDRDevice_readSensor(const SoapySDRDevice *device, cons
  */
 SOAPY_SDR_API char **SoapySDRDevice_listChannelSensors(const SoapySDRDevice *device, const int direction, const size_t channel, size_t *length);
 
+/*!
+ * List the available channel readback sensors into a single allocation.
+ * The result and all of its strings are released with one call to free().
+ * \param device a pointer to a device instance
+ * \param direction the channel direction RX or TX
+ * \param channel an available channel on the device
+ * \param [out] length the number of sensor names
+ * \return a list of available sensor string names
+ */
+SOAPY_SDR_API char **SoapySDRDevice_listChannelSensorsArena(const SoapySDRDevice *device, const int direction, const size_t channel, size_t *length);
+
 /*!
  * Get meta-information about a channel sensor.
  * Example: displayable name, type, range.
@@ -1187,6 +1572,37 @@ SOAPY_SDR_API SoapySDRArgInfo SoapySDRDevice_getChannelSensorInfo(const SoapySDR
  */
 SOAPY_SDR_API char *SoapySDRDevice_readChannelSensor(const SoapySDRDevice *device, const int direction, const size_t channel, const char *key);
 
+/*!
+ * Subscribe to periodic readback of global and channel sensors.
+ * The default implementation polls from a thread shared by all subscriptions.
+ * All subscriptions must be removed before the device is unmade.
+ * \param device a pointer to a device instance
+ * \param sensors an array of sensors to read
+ * \param length the number of sensors in the array
+ * \param rate the update rate in Hz
+ * \param callback an optional callback invoked with every update or NULL
+ * \param userData user data passed to the callback
+ * \return a subscription handle or NULL on error
+ */
+SOAPY_SDR_API SoapySDRSensorSubscription *SoapySDRDevice_subscribeSensors(SoapySDRDevice *device, const SoapySDRSensor *sensors, const size_t length, const double rate, SoapySDRSensorCallback callback, void *userData);
+
+/*!
+ * Remove a subscription from SoapySDRDevice_subscribeSensors().
+ * \param device a pointer to a device instance
+ * \param subscription the subscription handle to free
+ * \return 0 for success or error code on failure
+ */
+SOAPY_SDR_API int SoapySDRDevice_unsubscribeSensors(SoapySDRDevice *device, SoapySDRSensorSubscription *subscription);
+
+/*!
+ * Copy the latest values from a subscription without blocking the update.
+ * \param subscription a subscription handle
+ * \param [out] values an array to fill with one value per sensor
+ * \param length the size of the values array
+ * \return the number of values copied, 0 before the first update
+ */
+SOAPY_SDR_API size_t SoapySDRSensorSubscription_snapshot(const SoapySDRSensorSubscription *subscription, SoapySDRSensorValue *values, const size_t length);
+
 /*******************************************************************
  * Register API
  ******************************************************************/
@@ -1245,6 +1661,29 @@ SOAPY_SDR_API int SoapySDRDevice_writeRegisters(SoapySDRDevice *device, const ch
  */
 SOAPY_SDR_API unsigned *SoapySDRDevice_readRegisters(const SoapySDRDevice *device, const char *name, const unsigned addr, size_t *length);
 
+/*!
+ * Write a scattered list of registers given the interface name.
+ * Drivers may write the entire list in a single burst.
+ * \param device a pointer to a device instance
+ * \param name the name of a available register interface
+ * \param addrs an array of register addresses in write order
+ * \param values an array of register values, one per address
+ * \param length the number of registers to write
+ * \return 0 for success or error code on failure
+ */
+SOAPY_SDR_API int SoapySDRDevice_writeRegisterList(SoapySDRDevice *device, const char *name, const unsigned *addrs, const unsigned *values, const size_t length);
+
+/*!
+ * Read a scattered list of registers given the interface name.
+ * \param device a pointer to a device instance
+ * \param name the name of a available register interface
+ * \param addrs an array of register addresses in read order
+ * \param [out] values an array filled with one register value per address
+ * \param length the number of registers to read
+ * \return 0 for success or error code on failure
+ */
+SOAPY_SDR_API int SoapySDRDevice_readRegisterList(const SoapySDRDevice *device, const char *name, const unsigned *addrs, unsigned *values, const size_t length);
+
 /*******************************************************************
  * Settings API
  ******************************************************************/
@@ -1257,6 +1696,16 @@ SOAPY_SDR_API unsigned *SoapySDRDevice_readRegisters(const SoapySDRDevice *devic
  */
 SOAPY_SDR_API SoapySDRArgInfo *SoapySDRDevice_getSettingInfo(const SoapySDRDevice *device, size_t *length);
 
+/*!
+ * Describe the settings into a single allocation.
+ * The result and all of its strings are released with one call to free().
+ * The result is read-only, do not pass it to SoapySDRArgInfoList_clear().
+ * \param device a pointer to a device instance
+ * \param [out] length the number of settings
+ * \return a list of argument info structures
+ */
+SOAPY_SDR_API SoapySDRArgInfo *SoapySDRDevice_getSettingInfoArena(const SoapySDRDevice *device, size_t *length);
+
 /*!
  * Write an arbitrary setting on the device.
  * The interpretation is up the implementation.
@@ -1285,6 +1734,18 @@ SOAPY_SDR_API char *SoapySDRDevice_readSetting(const SoapySDRDevice *device, con
  */
 SOAPY_SDR_API SoapySDRArgInfo *SoapySDRDevice_getChannelSettingInfo(const SoapySDRDevice *device, const int direction, const size_t channel, size_t *length);
 
+/*!
+ * Describe the channel settings into a single allocation.
+ * The result and all of its strings are released with one call to free().
+ * The result is read-only, do not pass it to SoapySDRArgInfoList_clear().
+ * \param device a pointer to a device instance
+ * \param direction the channel direction RX or TX
+ * \param channel an available channel on the device
+ * \param [out] length the number of settings
+ * \return a list of argument info structures
+ */
+SOAPY_SDR_API SoapySDRArgInfo *SoapySDRDevice_getChannelSettingInfoArena(const SoapySDRDevice *device, const int direction, const size_t channel, size_t *length);
+
 /*!
  * Write an arbitrary channel setting on the device.
  * The interpretation is up the implementation.
@@ -1307,6 +1768,83 @@ SOAPY_SDR_API int SoapySDRDevice_writeChannelSetting(SoapySDRDevice *device, con
  */
 SOAPY_SDR_API char *SoapySDRDevice_readChannelSetting(const SoapySDRDevice *device, const int direction, const size_t channel, const char *key);
 
+/*!
+ * Create an empty batch of queued settings.
+ * The setters queue calls that are applied by SoapySDRDevice_commitSettings().
+ * \return a new transaction to free with SoapySDRSettingsTransaction_free()
+ */
+SOAPY_SDR_API SoapySDRSettingsTransaction *SoapySDRSettingsTransaction_new(void);
+
+//! Free a transaction from SoapySDRSettingsTransaction_new()
+SOAPY_SDR_API void SoapySDRSettingsTransaction_free(SoapySDRSettingsTransaction *transaction);
+
+//! Remove all queued commands from a transaction and reset the command time
+SOAPY_SDR_API void SoapySDRSettingsTransaction_clear(SoapySDRSettingsTransaction *transaction);
+
+//! Set the command time in nanoseconds for subsequently queued commands
+SOAPY_SDR_API void SoapySDRSettingsTransaction_setCommandTime(SoapySDRSettingsTransaction *transaction, const long long timeNs);
+
+//! Queue an overall center frequency tune, args may be null
+SOAPY_SDR_API void SoapySDRSettingsTransaction_setFrequency(SoapySDRSettingsTransaction *transaction, const int direction, const size_t channel, const double frequency, const SoapySDRKwargs *args);
+
+//! Queue a frequency tune of a named tunable element, args may be null
+SOAPY_SDR_API void SoapySDRSettingsTransaction_setFrequencyComponent(SoapySDRSettingsTransaction *transaction, const int direction, const size_t channel, const char *name, const double frequency, const SoapySDRKwargs *args);
+
+//! Queue an overall gain setting
+SOAPY_SDR_API void SoapySDRSettingsTransaction_setGain(SoapySDRSettingsTransaction *transaction, const int direction, const size_t channel, const double value);
+
+//! Queue a gain setting of a named amplification element
+SOAPY_SDR_API void SoapySDRSettingsTransaction_setGainElement(SoapySDRSettingsTransaction *transaction, const int direction, const size_t channel, const char *name, const double value);
+
+//! Queue a baseband filter bandwidth setting
+SOAPY_SDR_API void SoapySDRSettingsTransaction_setBandwidth(SoapySDRSettingsTransaction *transaction, const int direction, const size_t channel, const double bw);
+
+//! Queue a baseband sample rate setting
+SOAPY_SDR_API void SoapySDRSettingsTransaction_setSampleRate(SoapySDRSettingsTransaction *transaction, const int direction, const size_t channel, const double rate);
+
+//! Queue an antenna selection
+SOAPY_SDR_API void SoapySDRSettingsTransaction_setAntenna(SoapySDRSettingsTransaction *transaction, const int direction, const size_t channel, const char *name);
+
+//! Queue an arbitrary device setting
+SOAPY_SDR_API void SoapySDRSettingsTransaction_writeSetting(SoapySDRSettingsTransaction *transaction, const char *key, const char *value);
+
+//! Queue an arbitrary channel setting
+SOAPY_SDR_API void SoapySDRSettingsTransaction_writeChannelSetting(SoapySDRSettingsTransaction *transaction, const int direction, const size_t channel, const char *key, const char *value);
+
+/*!
+ * Apply a batch of queued settings across one or more channels.
+ * Drivers may apply all of the settings in a single transaction,
+ * otherwise each command is applied in order until the first error.
+ * \param device a pointer to a device instance
+ * \param transaction the queued setter calls
+ * \return 0 for success or error code on failure
+ */
+SOAPY_SDR_API int SoapySDRDevice_commitSettings(SoapySDRDevice *device, const SoapySDRSettingsTransaction *transaction);
+
+/*!
+ * Schedule a list of timed settings, such as a frequency hopping plan.
+ * Each command is applied once the hardware time reaches its command time.
+ * A new schedule replaces any pending commands from a previous schedule.
+ * \param device a pointer to a device instance
+ * \param transaction the queued setter calls with command times
+ * \return 0 for success or error code on failure
+ */
+SOAPY_SDR_API int SoapySDRDevice_scheduleSettings(SoapySDRDevice *device, const SoapySDRSettingsTransaction *transaction);
+
+/*!
+ * Cancel the pending commands from SoapySDRDevice_scheduleSettings().
+ * \param device a pointer to a device instance
+ * \return 0 for success or error code on failure
+ */
+SOAPY_SDR_API int SoapySDRDevice_cancelScheduledSettings(SoapySDRDevice *device);
+
+/*!
+ * Get the number of scheduled commands that have not yet been applied.
+ * \param device a pointer to a device instance
+ * \return the number of pending commands
+ */
+SOAPY_SDR_API size_t SoapySDRDevice_getNumScheduledSettings(const SoapySDRDevice *device);
+
 /*******************************************************************
  * GPIO API
  ******************************************************************/
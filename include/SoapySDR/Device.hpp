@@ -12,12 +12,18 @@
 #pragma once
 #include <SoapySDR/Config.hpp>
 #include <SoapySDR/Types.hpp>
+#include <SoapySDR/SettingsTransaction.hpp>
+#include <SoapySDR/SensorSubscription.hpp>
+#include <SoapySDR/StreamSubscription.hpp>
 #include <SoapySDR/Constants.h>
 #include <SoapySDR/Errors.h>
+#include <utility>
 #include <vector>
 #include <string>
 #include <complex>
+#include <future>
 #include <cstddef> //size_t
+#include <cstdint> //intptr_t
 
 namespace SoapySDR
 {
@@ -32,11 +38,26 @@ class SOAPY_SDR_API Device
 {
 public:
 
-    //! virtual destructor for inheritance
+    /*!
+     * Virtual destructor for inheritance.
+     * The base destructor cancels scheduleSettings() only after the
+     * derived driver is gone, while the schedule may still call its setters.
+     * Device::unmake() cancels the schedule before the driver is deleted,
+     * a driver that is deleted directly must call cancelScheduledSettings() first.
+     */
     virtual ~Device(void);
 
     /*!
      * Enumerate a list of available devices on the system.
+     * The find functions of the drivers are called concurrently,
+     * and the results are merged in the order of the driver names.
+     * Concurrent calls to enumerate() may also run the find function
+     * of the same driver concurrently in different threads.
+     * The environment variable SOAPY_SDR_ENUMERATE_TIMEOUT sets an
+     * optional timeout in seconds after which results are discarded.
+     * A find function that times out is not cancelled: it keeps running
+     * and keeps its module loaded, the results that it returns later are
+     * dropped, and its driver is skipped by enumerate() until it returns.
      * \param args device construction key/value argument filters
      * \return a list of argument maps, each unique to a device
      */
@@ -56,6 +77,12 @@ public:
      * with the same arguments will produce the same device.
      * For every call to make, there should be a matched call to unmake.
      *
+     * The returned device is a library stream layer over the driver's device:
+     * it converts stream formats that the driver does not support natively
+     * with a StreamFormatAdapter, and forwards every other call to the driver.
+     * Pass soapy_stream_wrapper=false to get the driver's device directly,
+     * for example to dynamic_cast it to the driver's own class.
+     *
      * \param args device construction key/value argument map
      * \return a pointer to a new Device object
      */
@@ -79,6 +106,68 @@ public:
      */
     static void unmake(Device *device);
 
+    /*!
+     * Make multiple Device objects given a list of construction args.
+     * A single enumeration is shared between all of the args,
+     * and the devices are constructed in parallel.
+     * If any device fails to construct, the others are unmade
+     * and the first error is thrown.
+     *
+     * \param argsList a list of device construction key/value argument maps
+     * \return a list of device pointers in the same order as the args
+     */
+    static std::vector<Device *> make(const KwargsList &argsList);
+
+    /*!
+     * Unmake or release multiple device object handles in parallel.
+     * Every device is released before the first error is thrown.
+     *
+     * \param devices a list of pointers to device objects
+     */
+    static void unmake(const std::vector<Device *> &devices);
+
+    /*!
+     * Set the time to live for cached enumeration results.
+     * When enabled, the results of each driver's find function are
+     * cached per query arguments, so repeated enumerate() and make()
+     * calls do not query the hardware again until the entries expire.
+     * The cache is disabled by default, or set by the environment
+     * variable SOAPY_SDR_ENUMERATE_CACHE_TTL in seconds.
+     * \param seconds the time to live in seconds, 0 to disable the cache
+     */
+    static void setEnumerateCacheTTL(const double seconds);
+
+    /*!
+     * Invalidate cached enumeration results.
+     * Drivers should call this from their hotplug event callbacks.
+     * A failed make() invalidates the results of its driver.
+     * \param driver the driver key, or empty for all drivers
+     */
+    static void invalidateEnumerateCache(const std::string &driver = "");
+
+    /*!
+     * Enumerate devices in a background thread.
+     * \param args device construction key/value argument filters
+     * \return a future for the result of enumerate()
+     */
+    static std::future<KwargsList> enumerateAsync(const Kwargs &args = Kwargs());
+
+    /*!
+     * Make a new Device object in a background thread.
+     * The future result has the same semantics as make(),
+     * and must be retrieved and unmade to release the device.
+     * \param args device construction key/value argument map
+     * \return a future for the result of make()
+     */
+    static std::future<Device *> makeAsync(const Kwargs &args = Kwargs());
+
+    /*!
+     * Make a new Device object in a background thread.
+     * \param args a markup string of key/value arguments
+     * \return a future for the result of make()
+     */
+    static std::future<Device *> makeAsync(const std::string &args);
+
     /*******************************************************************
      * Identification API
      ******************************************************************/
@@ -350,6 +439,73 @@ public:
         const long long timeNs = 0,
         const long timeoutUs = 100000);
 
+    /*!
+     * Read several buffers from a stream in a single call.
+     * Each entry of buffs is an array of void * with one pointer
+     * per channel, like the buffs argument of readStream().
+     * The outputs elems, flags, and timeNs are arrays of numBuffs
+     * entries with the result of each buffer read.
+     *
+     * The default implementation calls readStream() in a loop:
+     * The first read waits up to the timeout, and the following
+     * reads do not wait and end the batch when no data is ready.
+     * An error after the first buffer ends the batch with the buffers
+     * read so far, and is returned by the next call for the stream.
+     * Implementations may override this call to hand over many
+     * packets with a single lock or system call.
+     *
+     * \param stream the opaque pointer to a stream handle
+     * \param buffs an array of numBuffs arrays of void* buffers
+     * \param numBuffs the number of buffers in the batch
+     * \param numElems the number of elements in each buffer
+     * \param [out] elems the number of elements read per buffer
+     * \param [out] flags optional flag indicators about each result or nullptr
+     * \param [out] timeNs optional timestamp of each buffer in nanoseconds or nullptr
+     * \param timeoutUs the timeout in microseconds
+     * \return the number of buffers read or error code
+     */
+    virtual int readStreamBatch(
+        Stream *stream,
+        void * const * const *buffs,
+        const size_t numBuffs,
+        const size_t numElems,
+        size_t *elems,
+        int *flags,
+        long long *timeNs,
+        const long timeoutUs = 100000);
+
+    /*!
+     * Write several buffers to a stream in a single call.
+     * Each entry of buffs is an array of void * with one pointer
+     * per channel, like the buffs argument of writeStream().
+     * The arrays numElems, flags, and timeNs hold the arguments for
+     * each buffer, flags also returns the output flags of each write.
+     *
+     * The default implementation calls writeStream() in a loop,
+     * each write waits up to the timeout for space to become available.
+     * The batch ends early on an error or a partial write of a buffer,
+     * an error after the first buffer is returned by the next call.
+     *
+     * \param stream the opaque pointer to a stream handle
+     * \param buffs an array of numBuffs arrays of void* buffers
+     * \param numBuffs the number of buffers in the batch
+     * \param numElems the number of elements in each buffer
+     * \param [out] elems the number of elements written per buffer
+     * \param flags optional input flags and output flags per buffer or nullptr
+     * \param timeNs optional timestamp of each buffer in nanoseconds or nullptr
+     * \param timeoutUs the timeout in microseconds
+     * \return the number of buffers written or error code
+     */
+    virtual int writeStreamBatch(
+        Stream *stream,
+        const void * const * const *buffs,
+        const size_t numBuffs,
+        const size_t *numElems,
+        size_t *elems,
+        int *flags,
+        const long long *timeNs,
+        const long timeoutUs = 100000);
+
     /*!
      * Readback status information about a stream.
      * This call is typically used on a transmit stream
@@ -377,6 +533,48 @@ public:
         long long &timeNs,
         const long timeoutUs = 100000);
 
+    /*!
+     * Get the statistics counters for a stream.
+     * Devices from make() count the read, write and status calls
+     * of every stream in the library layer. Drivers implement this
+     * call to report the fill level of their internal buffers,
+     * the library layer fills in its own counters over the result.
+     * A bare driver device without the library layer only reports
+     * stats when the driver counts its calls with StreamCounters.
+     *
+     * The latency_stats=true stream arg additionally compares the
+     * timestamp of every transfer with getHardwareTime() when the
+     * call returns, for the timestamp latency figures of the stats.
+     *
+     * \param stream the opaque pointer to a stream handle
+     * \param [out] stats the statistics counters
+     * \return 0 for success or error code like SOAPY_SDR_NOT_SUPPORTED
+     */
+    virtual int getStreamStats(Stream *stream, StreamStats &stats);
+
+    /*!
+     * Get a handle that an event loop can wait on for a stream.
+     * The handle is ready while a call would return without waiting:
+     * readStream() and acquireReadBuffer() on a receive stream,
+     * readStreamStatus() on a transmit stream.
+     * The handle stays ready until the call has taken what is waiting,
+     * and it belongs to the stream, so do not close or reset it.
+     *
+     * On unix systems the handle is a file descriptor that polls readable
+     * with poll(), select() or epoll, on Windows it is an event HANDLE
+     * for WaitForMultipleObjects(), both are cast to an intptr_t.
+     *
+     * Drivers with a synchronous transfer call can provide the handle
+     * with a thread that prefetches the receive transfers
+     * or the transmit stream status for the calls above.
+     * Request the handle before activating the stream.
+     *
+     * \param stream the opaque pointer to a stream handle
+     * \param [out] handle the file descriptor or event HANDLE
+     * \return 0 for success or error code like SOAPY_SDR_NOT_SUPPORTED
+     */
+    virtual int getStreamPollHandle(Stream *stream, intptr_t &handle);
+
     /*******************************************************************
      * Direct buffer access API
      ******************************************************************/
@@ -492,6 +690,42 @@ public:
         int &flags,
         const long long timeNs = 0);
 
+    /*!
+     * Subscribe a callback to the buffers of a receive stream.
+     * The callback is invoked with the direct access buffers of
+     * acquireReadBuffer(), which are released when it returns.
+     *
+     * The default implementation waits on the getStreamPollHandle()
+     * of all subscribed streams from a background thread that is shared
+     * by the subscriptions on the device, so that one thread serves
+     * many streams. Streams without a poll handle or direct buffers
+     * are read with readStream() into buffers of getStreamMTU() elements
+     * by a prefetch thread of the subscription. Drivers with asynchronous
+     * transfers may override this call and publish to a StreamSubscription
+     * from their own context.
+     *
+     * Subscribe before activating the stream, and remove the subscription
+     * with unsubscribeStream() before the stream is closed.
+     *
+     * \throws runtime_error when the poll handle of the stream fails
+     * \param stream the opaque pointer to a receive stream handle
+     * \param numChans the number of channels of the stream
+     * \param callback the callback invoked with every buffer
+     * \return a subscription handle for unsubscribeStream()
+     */
+    virtual StreamSubscription *subscribeStream(
+        Stream *stream,
+        const size_t numChans,
+        const StreamSubscription::Callback &callback);
+
+    /*!
+     * Remove a subscription from subscribeStream().
+     * This call returns after any callback in progress completes,
+     * unless called from the subscription callback itself.
+     * \param subscription the subscription handle to free
+     */
+    virtual void unsubscribeStream(StreamSubscription *subscription);
+
     /*******************************************************************
      * Antenna API
      ******************************************************************/
@@ -709,6 +943,26 @@ public:
      */
     virtual Range getGainRange(const int direction, const size_t channel, const std::string &name) const;
 
+    /*!
+     * Enable or disable the gain model cache.
+     * The default overall gain calls query listGains() and getGainRange()
+     * for every element on every call. With the cache enabled,
+     * the element names and ranges are captured once per channel,
+     * so that setting the overall gain only sets and reads back the elements.
+     * Drivers that change their gain elements at runtime
+     * in other calls should call invalidateGainCache() when they do.
+     * \param enable true to enable the cache, false to disable and clear it
+     */
+    virtual void enableGainCache(const bool enable = true);
+
+    /*!
+     * Clear the captured gain model so that it is queried again.
+     * This is called automatically for factory devices after
+     * setFrontendMapping(), setAntenna(), and setGainMode(),
+     * and after antenna changes by commitSettings() and scheduleSettings().
+     */
+    virtual void invalidateGainCache(void);
+
     /*******************************************************************
      * Frequency API
      ******************************************************************/
@@ -982,6 +1236,38 @@ public:
      */
     virtual void setCommandTime(const long long timeNs, const std::string &what = "");
 
+    /*!
+     * Schedule a list of timed settings, such as a frequency hopping plan.
+     * Each command is applied once the hardware time reaches its time,
+     * see SettingsTransaction::setCommandTime(). A new schedule replaces
+     * any commands that are still pending from a previous schedule.
+     *
+     * The default implementation sequences the commands in time order
+     * from a host thread, waiting on getHardwareTime(), or on the host clock
+     * when hasHardwareTime() is false. Errors from the setters are logged.
+     * Drivers with hardware command queues may override this call
+     * to load the entire list for deterministic timing.
+     * Device::unmake() cancels the schedule before the driver is deleted.
+     * A driver that is deleted directly must have cancelScheduledSettings()
+     * called first, the base destructor runs after the setters are gone.
+     *
+     * \param transaction the queued setter calls with command times
+     */
+    virtual void scheduleSettings(const SettingsTransaction &transaction);
+
+    /*!
+     * Cancel the pending commands from scheduleSettings().
+     * This call returns after any command in progress completes.
+     */
+    virtual void cancelScheduledSettings(void);
+
+    /*!
+     * Get the number of commands from scheduleSettings()
+     * that have not yet been applied.
+     * \return the number of pending commands
+     */
+    virtual size_t getNumScheduledSettings(void) const;
+
     /*******************************************************************
      * Sensor API
      ******************************************************************/
@@ -1040,6 +1326,38 @@ public:
      */
     virtual std::string readSensor(const int direction, const size_t channel, const std::string &key) const;
 
+    /*!
+     * Subscribe to periodic readback of global and channel sensors.
+     * Values are converted according to the type from getSensorInfo(),
+     * and published to the subscription snapshot and optional callback.
+     *
+     * The default implementation polls readSensor() from a background thread
+     * that is shared by all subscriptions on the device. Sensors that are due
+     * in the same pass are read once, and equal rates are updated together.
+     * Drivers with asynchronous status reports may override this call
+     * and publish to a SensorSubscription from their own context.
+     *
+     * All subscriptions must be removed with unsubscribeSensors()
+     * before the device is unmade.
+     *
+     * \param sensors the global and channel sensors to read
+     * \param rate the update rate in Hz
+     * \param callback an optional callback invoked with every update
+     * \return a subscription handle for unsubscribeSensors()
+     */
+    virtual SensorSubscription *subscribeSensors(
+        const std::vector<SensorSubscription::Sensor> &sensors,
+        const double rate,
+        const SensorSubscription::Callback &callback = SensorSubscription::Callback());
+
+    /*!
+     * Remove a subscription from subscribeSensors().
+     * This call returns after any update in progress completes,
+     * unless called from the subscription callback itself.
+     * \param subscription the subscription handle to free
+     */
+    virtual void unsubscribeSensors(SensorSubscription *subscription);
+
     /*******************************************************************
      * Register API
      ******************************************************************/
@@ -1090,6 +1408,7 @@ public:
      * Write a memory block on the device given the interface name.
      * This can represent a memory block on a soft CPU, FPGA, IC;
      * the interpretation is up the implementation to decide.
+     * The default implementation writes each word with writeRegister().
      * \param name the name of a available memory block interface
      * \param addr the memory block start address
      * \param value the memory block content
@@ -1098,6 +1417,7 @@ public:
 
     /*!
      * Read a memory block on the device given the interface name.
+     * The default implementation reads each word with readRegister().
      * \param name the name of a available memory block interface
      * \param addr the memory block start address
      * \param length number of words to be read from memory block
@@ -1105,6 +1425,25 @@ public:
      */
     virtual std::vector<unsigned> readRegisters(const std::string &name, const unsigned addr, const size_t length) const;
 
+    /*!
+     * Write a scattered list of registers given the interface name.
+     * Drivers may override this call to write the entire list
+     * in a single burst, such as for loading a configuration map.
+     * The default implementation writes each pair with writeRegister().
+     * \param name the name of a available register interface
+     * \param values a list of register address and value pairs in write order
+     */
+    virtual void writeRegisters(const std::string &name, const std::vector<std::pair<unsigned, unsigned>> &values);
+
+    /*!
+     * Read a scattered list of registers given the interface name.
+     * The default implementation reads each address with readRegister().
+     * \param name the name of a available register interface
+     * \param addrs a list of register addresses in read order
+     * \return a list of register values, one per address
+     */
+    virtual std::vector<unsigned> readRegisters(const std::string &name, const std::vector<unsigned> &addrs) const;
+
     /*******************************************************************
      * Settings API
      ******************************************************************/
@@ -1157,6 +1496,16 @@ public:
      */
     virtual std::string readSetting(const int direction, const size_t channel, const std::string &key) const;
 
+    /*!
+     * Apply a batch of queued settings across one or more channels.
+     * The default implementation replays each command in order
+     * through the corresponding setter call, and stops at the first error.
+     * Drivers may override this call to apply all of the settings
+     * in a single bus or network transaction.
+     * \param transaction the queued setter calls
+     */
+    virtual void commitSettings(const SettingsTransaction &transaction);
+
     /*******************************************************************
      * GPIO API
      ******************************************************************/
@@ -1285,6 +1634,22 @@ public:
      */
     virtual std::string readUART(const std::string &which, const long timeoutUs = 100000) const;
 
+    //! Create a device with the gain model cache disabled
+    Device(void);
+
+private:
+    Device(const Device &);
+    Device &operator=(const Device &);
+
+    //element names and ranges for the overall gain distribution
+    typedef std::vector<std::pair<std::string, Range>> GainElements;
+    GainElements getGainElements(const int direction, const size_t channel) const;
+
+    //apply a single queued setter call
+    void applySetting(const SettingsTransaction::Command &command);
+
+    class Impl;
+    Impl *_impl;
 };
 
 };
@@ -0,0 +1,161 @@
+///
+/// \file SoapySDR/FlatKwargs.hpp
+///
+/// Compact key-value arguments for hot lookups.
+/// A flat alternative to Kwargs that compares and hashes cheaply,
+/// and converts losslessly to and from the Kwargs map.
+///
+/// \copyright
+/// Copyright (c) 2018-2018 Josh Blum
+/// SPDX-License-Identifier: BSL-1.0
+///
+
+#pragma once
+#include <SoapySDR/Config.hpp>
+#include <SoapySDR/Types.hpp>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include <string>
+#include <cstddef>
+
+namespace SoapySDR
+{
+
+/*!
+ * Key-value arguments stored as a sorted vector of interned strings.
+ *
+ * Every key and value points into a process wide pool of strings,
+ * so that equal strings share one address. Comparison and equality
+ * work on the pointers alone, and the hash is precomputed on construction.
+ * The entries are sorted by key text, in the same order as Kwargs.
+ *
+ * The comparison operators order by string addresses,
+ * which is consistent within a process but not alphabetical.
+ */
+class SOAPY_SDR_API FlatKwargs
+{
+public:
+
+    //! An entry of interned key and value strings
+    typedef std::pair<const std::string *, const std::string *> Entry;
+
+    //! Iterator over the entries in key order
+    typedef std::vector<Entry>::const_iterator const_iterator;
+
+    //! Create empty arguments
+    FlatKwargs(void);
+
+    //! Create from a key-value map
+    explicit FlatKwargs(const Kwargs &args);
+
+    /*!
+     * Create from a markup string.
+     * The markup format is: "key0=value0, key1=value1"
+     * This matches the result of KwargsFromString().
+     */
+    static FlatKwargs fromString(const std::string &markup);
+
+    //! Convert to a key-value map
+    Kwargs toKwargs(void) const;
+
+    //! Convert to a markup string, the same as KwargsToString()
+    std::string toString(void) const;
+
+    /*!
+     * Get the interned copy of a string.
+     * The pointer is unique to the string contents
+     * and remains valid for the lifetime of the process.
+     */
+    static const std::string *intern(const std::string &s);
+
+    //! Get the number of entries
+    size_t size(void) const;
+
+    //! Is this an empty set of arguments?
+    bool empty(void) const;
+
+    //! Get an iterator to the first entry
+    const_iterator begin(void) const;
+
+    //! Get an iterator past the last entry
+    const_iterator end(void) const;
+
+    //! Get a pointer to the value for a key or nullptr when missing
+    const std::string *find(const std::string &key) const;
+
+    //! Get the precomputed hash of the entries
+    size_t hash(void) const;
+
+    //! Equality of all keys and values
+    bool operator==(const FlatKwargs &rhs) const;
+
+    //! Inequality of any key or value
+    bool operator!=(const FlatKwargs &rhs) const;
+
+    //! Strict weak ordering for use as a map key
+    bool operator<(const FlatKwargs &rhs) const;
+
+private:
+    void finalize(void);
+    std::vector<Entry> _entries;
+    size_t _hash;
+};
+
+}
+
+namespace std
+{
+    //! Hash support so FlatKwargs can key unordered containers
+    template <>
+    struct hash<SoapySDR::FlatKwargs>
+    {
+        size_t operator()(const SoapySDR::FlatKwargs &args) const
+        {
+            return args.hash();
+        }
+    };
+}
+
+inline size_t SoapySDR::FlatKwargs::size(void) const
+{
+    return _entries.size();
+}
+
+inline bool SoapySDR::FlatKwargs::empty(void) const
+{
+    return _entries.empty();
+}
+
+inline SoapySDR::FlatKwargs::const_iterator SoapySDR::FlatKwargs::begin(void) const
+{
+    return _entries.begin();
+}
+
+inline SoapySDR::FlatKwargs::const_iterator SoapySDR::FlatKwargs::end(void) const
+{
+    return _entries.end();
+}
+
+inline size_t SoapySDR::FlatKwargs::hash(void) const
+{
+    return _hash;
+}
+
+inline bool SoapySDR::FlatKwargs::operator==(const FlatKwargs &rhs) const
+{
+    return _hash == rhs._hash and _entries == rhs._entries;
+}
+
+inline bool SoapySDR::FlatKwargs::operator!=(const FlatKwargs &rhs) const
+{
+    return not (*this == rhs);
+}
+
+inline bool SoapySDR::FlatKwargs::operator<(const FlatKwargs &rhs) const
+{
+    const std::less<const std::string *> less;
+    return std::lexicographical_compare(_entries.begin(), _entries.end(), rhs._entries.begin(), rhs._entries.end(),
+        [&less](const Entry &a, const Entry &b){return less(a.first, b.first) or (a.first == b.first and less(a.second, b.second));});
+}
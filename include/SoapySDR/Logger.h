@@ -13,6 +13,7 @@
 #pragma once
 #include <SoapySDR/Config.h>
 #include <stdarg.h>
+#include <stddef.h>
 
 /*!
  * The available priority levels for log messages.
@@ -42,6 +43,9 @@ typedef enum
 //! Compile-time detection macro for SSI feature
 #define SOAPY_SDR_SSI SOAPY_SDR_SSI
 
+//! The maximum message size including terminator in asynchronous mode
+#define SOAPY_SDR_ASYNC_LOG_MESSAGE_SIZE 512
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -74,6 +78,40 @@ static inline void SoapySDR_logf(const SoapySDRLogLevel logLevel, const char *fo
     va_end(argList);
 }
 
+/*!
+ * Send a rate-limited message to the registered logger.
+ * Messages are keyed by the address of the format string,
+ * so each call site with a literal format has its own limit.
+ * The first message of each period is logged, repeats within
+ * the period are only counted, and the next logged message
+ * carries a summary with the number of suppressed repeats.
+ * \param logLevel a possible logging level
+ * \param format a printf style format string, also the message key
+ * \param argList an argument list for the formatter
+ */
+SOAPY_SDR_API void SoapySDR_vlogfLimited(const SoapySDRLogLevel logLevel, const char *format, va_list argList);
+
+/*!
+ * Send a rate-limited message to the registered logger.
+ * \param logLevel a possible logging level
+ * \param format a printf style format string, also the message key
+ */
+static inline void SoapySDR_logfLimited(const SoapySDRLogLevel logLevel, const char *format, ...)
+{
+    va_list argList;
+    va_start(argList, format);
+    SoapySDR_vlogfLimited(logLevel, format, argList);
+    va_end(argList);
+}
+
+/*!
+ * Set the period for rate-limited log messages.
+ * The default period is 1 second, or the value of the
+ * SOAPY_SDR_LOG_RATE_LIMIT environment variable in seconds.
+ * \param periodSecs the period in seconds, 0 to disable the limit
+ */
+SOAPY_SDR_API void SoapySDR_setLogRateLimit(const double periodSecs);
+
 /*!
  * Typedef for the registered log handler function.
  */
@@ -91,6 +129,24 @@ SOAPY_SDR_API void SoapySDR_registerLogHandler(const SoapySDRLogHandler handler)
  */
 SOAPY_SDR_API void SoapySDR_setLogLevel(const SoapySDRLogLevel logLevel);
 
+/*!
+ * Enable or disable asynchronous logging.
+ * In asynchronous mode, log calls format the message into a
+ * preallocated lock-free ring without allocating or blocking,
+ * and a background thread passes messages to the log handler.
+ * Messages longer than SOAPY_SDR_ASYNC_LOG_MESSAGE_SIZE are truncated.
+ * When the ring is full, messages are dropped and counted,
+ * and the background thread logs a notice with the dropped count.
+ * Disabling asynchronous mode delivers all queued messages.
+ * \param enable true to enable asynchronous logging
+ */
+SOAPY_SDR_API void SoapySDR_setLogAsync(const bool enable);
+
+/*!
+ * Get the total number of messages dropped in asynchronous mode.
+ */
+SOAPY_SDR_API size_t SoapySDR_getLogDropped(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -48,6 +48,35 @@ static inline void logf(const SoapySDRLogLevel logLevel, const char *format, ...
     va_end(argList);
 }
 
+/*!
+ * Send a rate-limited message to the registered logger.
+ * Messages are keyed by the address of the format string,
+ * repeats within the period are counted and summarized.
+ * \param logLevel a possible logging level
+ * \param format a printf style format string, also the message key
+ * \param argList an argument list for the formatter
+ */
+SOAPY_SDR_API void vlogfLimited(const SoapySDRLogLevel logLevel, const char *format, va_list argList);
+
+/*!
+ * Send a rate-limited message to the registered logger.
+ * \param logLevel a possible logging level
+ * \param format a printf style format string, also the message key
+ */
+static inline void logfLimited(const SoapySDRLogLevel logLevel, const char *format, ...)
+{
+    va_list argList;
+    va_start(argList, format);
+    SoapySDR::vlogfLimited(logLevel, format, argList);
+    va_end(argList);
+}
+
+/*!
+ * Set the period for rate-limited log messages.
+ * \param periodSecs the period in seconds, 0 to disable the limit
+ */
+SOAPY_SDR_API void setLogRateLimit(const double periodSecs);
+
 /*!
  * Typedef for the registered log handler function.
  */
@@ -65,4 +94,16 @@ SOAPY_SDR_API void registerLogHandler(const LogHandler &handler);
  */
 SOAPY_SDR_API void setLogLevel(const LogLevel logLevel);
 
+/*!
+ * Enable or disable asynchronous logging.
+ * In asynchronous mode, log calls format the message into a
+ * preallocated lock-free ring without allocating or blocking,
+ * and a background thread passes messages to the log handler.
+ * \param enable true to enable asynchronous logging
+ */
+SOAPY_SDR_API void setLogAsync(const bool enable);
+
+//! Get the total number of messages dropped in asynchronous mode
+SOAPY_SDR_API size_t getLogDropped(void);
+
 }
@@ -87,6 +87,20 @@ SOAPY_SDR_API char *SoapySDR_unloadModule(const char *path);
  */
 SOAPY_SDR_API void SoapySDR_loadModules(void);
 
+/*!
+ * Get the file path of the module manifest cache.
+ * The caller must free the result string.
+ * \return the manifest path or empty when disabled
+ */
+SOAPY_SDR_API char *SoapySDR_getModuleManifestPath(void);
+
+/*!
+ * Save the module manifest cache for the currently loaded modules.
+ * The caller must free the result error string.
+ * \return an error message, empty on success
+ */
+SOAPY_SDR_API char *SoapySDR_saveModuleManifest(void);
+
 #ifdef __cplusplus
 }
 #endif
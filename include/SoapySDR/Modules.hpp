@@ -77,9 +77,32 @@ SOAPY_SDR_API std::string unloadModule(const std::string &path);
  * Load the support modules installed on this system.
  * This call will only actually perform the load once.
  * Subsequent calls are a NOP.
+ *
+ * Modules are loaded serially by default. Set the environment variable
+ * SOAPY_SDR_MODULE_LOAD_THREADS to load modules on a pool of threads,
+ * where 0 selects one thread per core.
  */
 SOAPY_SDR_API void loadModules(void);
 
+/*!
+ * Get the file path of the module manifest cache.
+ * The manifest records the driver keys, version, and file stamp
+ * of each module, so that the automatic load for a device args
+ * with a driver key only loads the modules that provide it.
+ * The SOAPY_SDR_MODULE_MANIFEST environment variable overrides
+ * the path, or disables the manifest when set to "off".
+ * \return the manifest path or empty when disabled
+ */
+SOAPY_SDR_API std::string getModuleManifestPath(void);
+
+/*!
+ * Save the module manifest cache for the currently loaded modules.
+ * This is called automatically after loadModules(), the file is
+ * only replaced when its content changes.
+ * \return an error message, empty on success
+ */
+SOAPY_SDR_API std::string saveModuleManifest(void);
+
 //! \cond
 //! Internal call to register version with a module during load
 class SOAPY_SDR_API ModuleVersion
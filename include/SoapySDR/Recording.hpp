@@ -0,0 +1,290 @@
+///
+/// \file SoapySDR/Recording.hpp
+///
+/// Streaming capture to disk and playback from disk with SigMF metadata.
+///
+/// \copyright
+/// Copyright (c) 2018-2018 Josh Blum
+/// SPDX-License-Identifier: BSL-1.0
+///
+
+#pragma once
+#include <SoapySDR/Config.hpp>
+#include <SoapySDR/Types.hpp>
+#include <vector>
+#include <string>
+#include <cstddef> //size_t
+
+namespace SoapySDR
+{
+
+class Device;
+
+//! The SigMF datatype of a stream format such as "ci16_le", empty when there is none
+SOAPY_SDR_API std::string formatToSigMF(const std::string &format);
+
+//! The stream format of a SigMF datatype such as "CS16", empty when there is none
+SOAPY_SDR_API std::string formatFromSigMF(const std::string &datatype);
+
+/*!
+ * The metadata of a single channel SigMF recording.
+ * Only the fields that SoapySDR reads and writes are kept,
+ * the hardware timestamps use the "soapy:" extension namespace.
+ */
+class SOAPY_SDR_API SigMFMeta
+{
+public:
+
+    //! A segment of samples that starts at a new timestamp
+    struct SOAPY_SDR_API Capture
+    {
+        Capture(void);
+
+        //! The index of the first sample of the segment
+        unsigned long long sampleStart;
+
+        //! The center frequency in Hz
+        double frequency;
+
+        //! True when timeNs holds the hardware time of the first sample
+        bool hasTime;
+
+        //! The hardware time of the first sample in nanoseconds
+        long long timeNs;
+    };
+
+    //! A note about a range of samples, such as an overflow
+    struct SOAPY_SDR_API Annotation
+    {
+        Annotation(void);
+
+        unsigned long long sampleStart;
+        unsigned long long sampleCount;
+        std::string comment;
+    };
+
+    SigMFMeta(void);
+
+    //! The stream format of the samples in the data file
+    std::string format;
+
+    //! The sample rate in samples per second
+    double sampleRate;
+
+    //! The host time of the recording start in ISO 8601, or empty
+    std::string datetime;
+
+    //! The hardware key of the recording device
+    std::string hardware;
+
+    //! A free form description of the recording
+    std::string description;
+
+    //! Capture segments in sample order
+    std::vector<Capture> captures;
+
+    //! Annotations in sample order
+    std::vector<Annotation> annotations;
+
+    //! Serialize to the JSON of a .sigmf-meta file
+    std::string toJSON(void) const;
+
+    /*!
+     * Parse the JSON of a .sigmf-meta file.
+     * \throws std::runtime_error for malformed JSON or an unsupported datatype
+     */
+    static SigMFMeta fromJSON(const std::string &json);
+
+    //! Write the metadata to a file, throws std::runtime_error on failure
+    void save(const std::string &path) const;
+
+    //! Read the metadata from a file, throws std::runtime_error on failure
+    static SigMFMeta load(const std::string &path);
+};
+
+/*!
+ * Record a receive channel to disk without blocking the reader.
+ *
+ * A reader thread streams into a ring of aligned buffers,
+ * and a writer thread converts and writes them out,
+ * so that slow disk writes do not overflow the stream.
+ * When the ring is full the reader discards the samples
+ * and the gap is recorded as an annotation, as are overflows.
+ *
+ * Recorder args:
+ *  - format: the file format, converted from the native format (default native)
+ *  - output: sigmf (default) for a .sigmf-data and .sigmf-meta pair, or raw
+ *  - buffers: the number of MTU sized buffers in the ring (default 64)
+ *  - direct: write with O_DIRECT to bypass the page cache (default true, linux only)
+ *  - any other args are passed to setupStream()
+ *
+ * \code
+ * SoapySDR::Recorder recorder(device, 0, "capture", SoapySDR::KwargsFromString("format=CS16"));
+ * recorder.start(10000000);
+ * while (not recorder.done()) std::this_thread::sleep_for(std::chrono::milliseconds(100));
+ * recorder.stop();
+ * \endcode
+ */
+class SOAPY_SDR_API Recorder
+{
+public:
+
+    /*!
+     * Set up the stream and open the output files.
+     * \param device the device to record from, used until the recorder is destroyed
+     * \param channel the receive channel to record
+     * \param path the data file, or the base name of the SigMF files
+     * \param args the recorder and stream args
+     * \throws std::runtime_error when the stream or files cannot be opened
+     */
+    Recorder(Device *device, const size_t channel, const std::string &path, const Kwargs &args = Kwargs());
+
+    //! Stop the recording and close the stream
+    ~Recorder(void);
+
+    /*!
+     * Activate the stream and start recording.
+     * \param numSamples the number of samples to record, 0 to record until stop()
+     */
+    void start(const unsigned long long numSamples = 0);
+
+    /*!
+     * Stop recording, flush the data file, and write the metadata.
+     * \throws std::runtime_error when a write failed during the recording
+     */
+    void stop(void);
+
+    //! True once the requested samples are written or the recording failed
+    bool done(void) const;
+
+    //! The number of samples written to the data file
+    unsigned long long numSamples(void) const;
+
+    //! The number of overflows reported by the stream
+    unsigned long long numOverflows(void) const;
+
+    //! The number of samples discarded because the writer fell behind
+    unsigned long long numDropped(void) const;
+
+    //! The path of the data file
+    std::string dataPath(void) const;
+
+    //! The path of the metadata file, empty for raw output
+    std::string metaPath(void) const;
+
+private:
+    Recorder(const Recorder &);
+    Recorder &operator=(const Recorder &);
+    struct Impl;
+    Impl *_impl;
+};
+
+/*!
+ * A recording mapped into memory for reading.
+ * The path may name a SigMF recording by its base name or either file,
+ * any other path is a raw file of samples in the given format.
+ * Off POSIX systems the file is read into memory instead.
+ */
+class SOAPY_SDR_API MappedRecording
+{
+public:
+
+    /*!
+     * Open and map a recording.
+     * \param path the raw data file, or the base name or a file of a SigMF recording
+     * \param format the sample format of a raw file, unused for SigMF
+     * \throws std::runtime_error when the files cannot be read
+     */
+    MappedRecording(const std::string &path, const std::string &format = "");
+
+    ~MappedRecording(void);
+
+    //! The metadata, only the format is set for raw files
+    const SigMFMeta &meta(void) const;
+
+    //! The mapped samples
+    const void *data(void) const;
+
+    //! The number of whole samples in the data file
+    size_t numElems(void) const;
+
+    //! The path of the data file
+    std::string dataPath(void) const;
+
+    //! The path of the metadata file, empty for raw files
+    std::string metaPath(void) const;
+
+private:
+    MappedRecording(const MappedRecording &);
+    MappedRecording &operator=(const MappedRecording &);
+    struct Impl;
+    Impl *_impl;
+};
+
+/*!
+ * Play a recording out of a transmit channel.
+ *
+ * A writer thread streams straight from the mapped file, so that
+ * a file in the stream format is written without a copy.
+ * Other formats are converted into the direct access buffers when
+ * the driver has them, or into an intermediate buffer otherwise.
+ *
+ * Player args:
+ *  - format: the sample format of a raw file
+ *  - loop: repeat the recording until stop() (default false)
+ *  - direct: convert into the direct access buffers when present (default true)
+ *  - any other args are passed to setupStream()
+ */
+class SOAPY_SDR_API Player
+{
+public:
+
+    /*!
+     * Map the recording and set up the stream.
+     * \param device the device to play to, used until the player is destroyed
+     * \param channel the transmit channel to play to
+     * \param path the recording, see MappedRecording
+     * \param args the player and stream args
+     * \throws std::runtime_error when the stream or files cannot be opened
+     */
+    Player(Device *device, const size_t channel, const std::string &path, const Kwargs &args = Kwargs());
+
+    //! Stop the playback and close the stream
+    ~Player(void);
+
+    /*!
+     * Activate the stream and start playing.
+     * \param flags SOAPY_SDR_HAS_TIME to start the burst at timeNs
+     * \param timeNs the hardware time of the first sample
+     */
+    void start(const int flags = 0, const long long timeNs = 0);
+
+    /*!
+     * Stop playing and deactivate the stream.
+     * \throws std::runtime_error when a write failed during the playback
+     */
+    void stop(void);
+
+    //! True once the recording was played without loop or the playback failed
+    bool done(void) const;
+
+    //! The number of samples written to the stream
+    unsigned long long numSamples(void) const;
+
+    //! The number of times that the recording wrapped around
+    unsigned long long numLoops(void) const;
+
+    //! The number of underflows reported by the stream
+    unsigned long long numUnderflows(void) const;
+
+    //! The recording that is played
+    const MappedRecording &recording(void) const;
+
+private:
+    Player(const Player &);
+    Player &operator=(const Player &);
+    struct Impl;
+    Impl *_impl;
+};
+
+}
@@ -0,0 +1,228 @@
+///
+/// \file SoapySDR/RingBuffer.hpp
+///
+/// Lock-free single producer single consumer ring buffer.
+/// A header-only building block for drivers that hand off
+/// buffers from a worker thread to the stream API calls.
+///
+/// \copyright
+/// Copyright (c) 2018-2018 Josh Blum
+/// SPDX-License-Identifier: BSL-1.0
+///
+
+#pragma once
+#include <SoapySDR/Config.hpp>
+#include <condition_variable>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstddef>
+
+//! The assumed cache line size used to pad shared indexes
+#ifndef SOAPY_SDR_CACHE_LINE_SIZE
+#define SOAPY_SDR_CACHE_LINE_SIZE 64
+#endif
+
+namespace SoapySDR
+{
+
+/*!
+ * A fixed number of slots shared between one producer and one consumer.
+ *
+ * Slots are acquired and released in place, so the element type may
+ * describe pre-allocated memory such as a DMA buffer and its metadata.
+ * The slot handles are stable indexes in the range [0, capacity),
+ * which map directly onto the handles of Device::acquireReadBuffer(),
+ * Device::acquireWriteBuffer(), and Device::getDirectAccessBufferAddrs().
+ *
+ * Each side may hold several acquired slots at once,
+ * but must release them in the same order that they were acquired.
+ * The producer side calls acquireWrite() and releaseWrite(),
+ * the consumer side calls acquireRead() and releaseRead().
+ *
+ * Acquire calls with a timeout first spin on the shared indexes.
+ * In the default mode the waiting side then sleeps until notified,
+ * the notifying side only takes a lock when there is a sleeper.
+ * In busy-poll mode the waiting side spins and yields until the timeout,
+ * which trades a core for the lowest latency handoff.
+ *
+ * Example driver usage with readStream() on top of a worker thread:
+ * \code
+ * //worker thread
+ * size_t handle;
+ * Packet *p = ring.acquireWrite(handle, 100000);
+ * if (p != nullptr) {fillPacket(*p); ring.releaseWrite(handle);}
+ *
+ * //acquireReadBuffer()
+ * Packet *p = ring.acquireRead(handle, timeoutUs);
+ * if (p == nullptr) return SOAPY_SDR_TIMEOUT;
+ * buffs[0] = p->data;
+ * return p->numElems;
+ *
+ * //releaseReadBuffer()
+ * ring.releaseRead(handle);
+ * \endcode
+ */
+template <typename T>
+class RingBuffer
+{
+public:
+
+    /*!
+     * Create a ring buffer with default constructed slots.
+     * \param capacity the number of slots in the ring
+     * \param busyPoll true to spin instead of sleeping in the acquire calls
+     */
+    RingBuffer(const size_t capacity, const bool busyPoll = false):
+        _slots(capacity),
+        _busyPoll(busyPoll),
+        _head(0),
+        _tail(0),
+        _readAcquired(0),
+        _writeAcquired(0),
+        _waiters(0)
+    {
+        return;
+    }
+
+    //! Get the number of slots in the ring
+    size_t capacity(void) const
+    {
+        return _slots.size();
+    }
+
+    //! Get the number of released slots that are ready to read
+    size_t size(void) const
+    {
+        return _tail.load(std::memory_order_acquire)-_head.load(std::memory_order_acquire);
+    }
+
+    //! Access a slot by handle, for example to set up its memory once
+    T &operator[](const size_t handle)
+    {
+        return _slots[handle];
+    }
+
+    //! Access a slot by handle, for example to set up its memory once
+    const T &operator[](const size_t handle) const
+    {
+        return _slots[handle];
+    }
+
+    /*!
+     * Acquire the next free slot for writing (producer side).
+     * \param [out] handle the handle of the acquired slot
+     * \param timeoutUs the timeout in microseconds, 0 to poll
+     * \return a pointer to the slot or nullptr on timeout
+     */
+    T *acquireWrite(size_t &handle, const long timeoutUs = 0)
+    {
+        const size_t index = _writeAcquired;
+        if (not this->wait(_writeCond, [this, index](void){
+            return index-_head.load(std::memory_order_acquire) < _slots.size();}, timeoutUs)) return nullptr;
+        _writeAcquired++;
+        handle = index % _slots.size();
+        return &_slots[handle];
+    }
+
+    /*!
+     * Release the oldest acquired write slot to the consumer.
+     * \param handle the handle from acquireWrite()
+     */
+    void releaseWrite(const size_t handle)
+    {
+        (void)handle;
+        _tail.fetch_add(1, std::memory_order_seq_cst);
+        this->notify(_readCond);
+    }
+
+    /*!
+     * Acquire the next written slot for reading (consumer side).
+     * \param [out] handle the handle of the acquired slot
+     * \param timeoutUs the timeout in microseconds, 0 to poll
+     * \return a pointer to the slot or nullptr on timeout
+     */
+    T *acquireRead(size_t &handle, const long timeoutUs = 0)
+    {
+        const size_t index = _readAcquired;
+        if (not this->wait(_readCond, [this, index](void){
+            return index != _tail.load(std::memory_order_acquire);}, timeoutUs)) return nullptr;
+        _readAcquired++;
+        handle = index % _slots.size();
+        return &_slots[handle];
+    }
+
+    /*!
+     * Release the oldest acquired read slot back to the producer.
+     * \param handle the handle from acquireRead()
+     */
+    void releaseRead(const size_t handle)
+    {
+        (void)handle;
+        _head.fetch_add(1, std::memory_order_seq_cst);
+        this->notify(_writeCond);
+    }
+
+private:
+
+    template <typename Predicate>
+    bool wait(std::condition_variable &cond, const Predicate &ready, const long timeoutUs)
+    {
+        for (size_t i = 0; i < 64; i++)
+        {
+            if (ready()) return true;
+        }
+        if (timeoutUs <= 0) return false;
+
+        const auto exitTime = std::chrono::steady_clock::now() + std::chrono::microseconds(timeoutUs);
+        if (_busyPoll)
+        {
+            while (not ready())
+            {
+                if (std::chrono::steady_clock::now() > exitTime) return false;
+                std::this_thread::yield();
+            }
+            return true;
+        }
+
+        //the waiter count is published before the predicate is checked under the lock,
+        //so a notifier that misses the sleeper always sees the ready condition first
+        std::unique_lock<std::mutex> lock(_mutex);
+        _waiters.fetch_add(1, std::memory_order_seq_cst);
+        const bool ok = cond.wait_until(lock, exitTime, ready);
+        _waiters.fetch_sub(1, std::memory_order_relaxed);
+        return ok;
+    }
+
+    void notify(std::condition_variable &cond)
+    {
+        if (_waiters.load(std::memory_order_seq_cst) == 0) return;
+        std::lock_guard<std::mutex> lock(_mutex);
+        cond.notify_one();
+    }
+
+    std::vector<T> _slots;
+    const bool _busyPoll;
+
+    //shared indexes on separate cache lines
+    char _pad0[SOAPY_SDR_CACHE_LINE_SIZE];
+    std::atomic<size_t> _head;
+    char _pad1[SOAPY_SDR_CACHE_LINE_SIZE];
+    std::atomic<size_t> _tail;
+    char _pad2[SOAPY_SDR_CACHE_LINE_SIZE];
+
+    //side local indexes
+    size_t _readAcquired;
+    char _pad3[SOAPY_SDR_CACHE_LINE_SIZE];
+    size_t _writeAcquired;
+    char _pad4[SOAPY_SDR_CACHE_LINE_SIZE];
+
+    //sleeping waiters
+    std::atomic<size_t> _waiters;
+    std::mutex _mutex;
+    std::condition_variable _readCond, _writeCond;
+};
+
+}
@@ -0,0 +1,169 @@
+///
+/// \file SoapySDR/Scanner.hpp
+///
+/// Frequency sweeps with timed retunes on an active receive stream.
+///
+/// \copyright
+/// Copyright (c) 2018-2018 Josh Blum
+/// SPDX-License-Identifier: BSL-1.0
+///
+
+#pragma once
+#include <SoapySDR/Config.hpp>
+#include <SoapySDR/Types.hpp>
+#include <functional>
+#include <vector>
+#include <cstddef> //size_t
+
+namespace SoapySDR
+{
+
+class Device;
+class Stream;
+
+/*!
+ * Sweep a receive channel over a list of frequencies.
+ *
+ * The stream stays active for the whole scan. When the device has a
+ * hardware clock, each sweep is planned as a timeline of retunes that
+ * are loaded with Device::scheduleSettings(), and the samples of a step
+ * are selected by their stream timestamps: the settling time after a
+ * retune is discarded, and the following dwell time is captured.
+ * The next sweep is scheduled as soon as the last retune of the
+ * current sweep has happened, so sweeps follow each other closely.
+ *
+ * Without a hardware clock the scanner tunes with setFrequency()
+ * and discards the settling time as a count of samples at the rate.
+ * The settling time then also has to cover the samples that were
+ * already in flight in the driver when the tune returned.
+ *
+ * Each completed step is handed to the callback from a thread of its own,
+ * while the capture thread continues with the next steps.
+ *
+ * Scanner args:
+ *  - lead_us: how far ahead of the hardware time a sweep is scheduled (default 10000)
+ *  - buffers: the number of completed steps that can wait for the callback (default 4)
+ *  - timed: false to tune from the host even with a hardware clock
+ *  - the thread placement args of SoapySDR/ThreadHints.hpp
+ *
+ * \code
+ * std::vector<SoapySDR::Scanner::Step> steps;
+ * for (double f = 88e6; f < 108e6; f += 2e6) steps.push_back(SoapySDR::Scanner::Step(f, 1000000, 200000));
+ * auto stream = device->setupStream(SOAPY_SDR_RX, SOAPY_SDR_CF32);
+ * device->activateStream(stream);
+ * SoapySDR::Scanner scanner(device, stream, 0, 1, sizeof(std::complex<float>));
+ * scanner.start(steps, [](const SoapySDR::Scanner::Capture &capture){ ... }, 10);
+ * scanner.wait(10000000);
+ * \endcode
+ */
+class SOAPY_SDR_API Scanner
+{
+public:
+
+    //! One frequency of a sweep
+    struct SOAPY_SDR_API Step
+    {
+        Step(void);
+
+        /*!
+         * Create a step.
+         * \param frequency the center frequency in Hz
+         * \param dwellNs how long to capture after the settling time
+         * \param settleNs how long to discard after the retune
+         * \param args the tune args for setFrequency()
+         */
+        Step(const double frequency, const long long dwellNs, const long long settleNs = 0, const Kwargs &args = Kwargs());
+
+        double frequency;
+        long long dwellNs;
+        long long settleNs;
+        Kwargs args;
+    };
+
+    //! The samples of a completed step
+    struct SOAPY_SDR_API Capture
+    {
+        Capture(void);
+
+        //! The index of the step in the list
+        size_t step;
+
+        //! The number of previously completed sweeps
+        size_t sweep;
+
+        //! The center frequency of the step
+        double frequency;
+
+        //! The stream time of the first element
+        long long timeNs;
+
+        //! The number of elements per channel buffer
+        size_t numElems;
+
+        //! The channel buffers, valid until the callback returns
+        const void * const *buffs;
+
+        /*!
+         * 0 for a complete capture, SOAPY_SDR_OVERFLOW when samples were
+         * lost during the dwell, SOAPY_SDR_TIME_ERROR when the step was
+         * missed, or another error code from readStream()
+         */
+        int status;
+    };
+
+    //! A callback invoked from the delivery thread with every completed step
+    typedef std::function<void(const Capture &)> Callback;
+
+    /*!
+     * Create a scanner for an active or soon activated receive stream.
+     * \param device the device to tune, used until the scanner is destroyed
+     * \param stream the receive stream, not read by the caller while scanning
+     * \param channel the channel to tune
+     * \param numChans the number of channels of the stream
+     * \param elemSize the size of an element of the stream format in bytes
+     * \param args the scanner args
+     */
+    Scanner(Device *device, Stream *stream, const size_t channel, const size_t numChans, const size_t elemSize, const Kwargs &args = Kwargs());
+
+    //! Stop the scan
+    ~Scanner(void);
+
+    /*!
+     * Start scanning from a thread, a scan in progress is stopped first.
+     * \throws invalid_argument for an empty step list
+     * \param steps the frequency steps of a sweep
+     * \param callback the callback for every completed step
+     * \param numSweeps the number of sweeps, 0 to sweep until stopped
+     */
+    void start(const std::vector<Step> &steps, const Callback &callback, const size_t numSweeps = 0);
+
+    /*!
+     * Stop scanning, no callbacks are made after this returns.
+     * Retunes that were scheduled with the hardware clock are cancelled.
+     */
+    void stop(void);
+
+    /*!
+     * Wait for the sweeps to complete and their callbacks to return.
+     * \param timeoutUs how long to wait
+     * \return true when the scan has finished
+     */
+    bool wait(const long timeoutUs);
+
+    //! The number of completed sweeps
+    size_t numSweeps(void) const;
+
+    //! The number of steps handed to the callback
+    unsigned long long numCaptures(void) const;
+
+    //! The number of elements discarded while settling or between steps
+    unsigned long long numDiscarded(void) const;
+
+private:
+    Scanner(const Scanner &);
+    Scanner &operator=(const Scanner &);
+    struct Impl;
+    Impl *_impl;
+};
+
+}
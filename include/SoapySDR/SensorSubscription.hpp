@@ -0,0 +1,147 @@
+///
+/// \file SoapySDR/SensorSubscription.hpp
+///
+/// Periodic typed sensor readback for Device::subscribeSensors().
+///
+/// \copyright
+/// Copyright (c) 2018-2018 Josh Blum
+/// SPDX-License-Identifier: BSL-1.0
+///
+
+#pragma once
+#include <SoapySDR/Config.hpp>
+#include <SoapySDR/Types.hpp>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <string>
+#include <cstddef> //size_t
+
+namespace SoapySDR
+{
+
+/*!
+ * A set of sensors that are read back periodically on behalf of the caller.
+ *
+ * Each update publishes typed values in the order of the subscribed sensors.
+ * The latest values are available as an immutable snapshot at any time,
+ * and an optional callback is invoked with every update.
+ *
+ * \code
+ * std::vector<SoapySDR::SensorSubscription::Sensor> sensors;
+ * sensors.push_back(SoapySDR::SensorSubscription::Sensor("temp"));
+ * sensors.push_back(SoapySDR::SensorSubscription::Sensor(SOAPY_SDR_RX, 0, "lo_locked"));
+ * auto subscription = device->subscribeSensors(sensors, 10.0);
+ * ...
+ * const auto values = subscription->snapshot();
+ * if (values and (*values)[1].valid and not (*values)[1].boolValue) ...
+ * ...
+ * device->unsubscribeSensors(subscription);
+ * \endcode
+ */
+class SOAPY_SDR_API SensorSubscription
+{
+public:
+
+    //! Identifies a global sensor or a channel sensor
+    struct SOAPY_SDR_API Sensor
+    {
+        //! Create an empty global sensor key
+        Sensor(void);
+
+        //! Create a global sensor key
+        Sensor(const std::string &key);
+
+        //! Create a channel sensor key
+        Sensor(const int direction, const size_t channel, const std::string &key);
+
+        std::string key;
+        bool isChannel;
+        int direction;
+        size_t channel;
+    };
+
+    //! A sensor reading converted according to the sensor type
+    struct SOAPY_SDR_API Value
+    {
+        Value(void);
+
+        //! The sensor type from getSensorInfo()
+        ArgInfo::Type type;
+
+        //! False when the readback failed or did not parse as the type
+        bool valid;
+
+        //! The value for BOOL, or a non-zero numeric value
+        bool boolValue;
+
+        //! The value for INT, or the rounded numeric value
+        long long intValue;
+
+        //! The value for FLOAT, or the numeric value
+        double floatValue;
+
+        //! The readback string as returned by readSensor()
+        std::string text;
+    };
+
+    //! An immutable list of values, one per subscribed sensor
+    typedef std::shared_ptr<const std::vector<Value>> Snapshot;
+
+    //! A callback invoked from the polling context with every update
+    typedef std::function<void(const std::vector<Value> &)> Callback;
+
+    /*!
+     * Create a subscription, drivers use this to implement subscribeSensors()
+     * \param sensors the subscribed global and channel sensors
+     * \param rate the update rate in Hz
+     * \param callback an optional callback for every update
+     */
+    SensorSubscription(const std::vector<Sensor> &sensors, const double rate, const Callback &callback = Callback());
+
+    virtual ~SensorSubscription(void);
+
+    //! Get the subscribed sensors
+    const std::vector<Sensor> &sensors(void) const;
+
+    //! Get the update rate in Hz
+    double rate(void) const;
+
+    /*!
+     * Get the latest values without blocking the update.
+     * \return the latest values, or null before the first update
+     */
+    Snapshot snapshot(void) const;
+
+    /*!
+     * Publish an update, drivers call this with one value per sensor.
+     * The snapshot is replaced and then the callback is invoked.
+     */
+    void publish(const std::vector<Value> &values);
+
+    /*!
+     * Convert a readSensor() string into a typed value.
+     * \param type the sensor type from getSensorInfo()
+     * \param text the readback string
+     * \return the typed value
+     */
+    static Value parseValue(const ArgInfo::Type type, const std::string &text);
+
+private:
+    std::vector<Sensor> _sensors;
+    double _rate;
+    Callback _callback;
+    Snapshot _snapshot;
+};
+
+}
+
+inline const std::vector<SoapySDR::SensorSubscription::Sensor> &SoapySDR::SensorSubscription::sensors(void) const
+{
+    return _sensors;
+}
+
+inline double SoapySDR::SensorSubscription::rate(void) const
+{
+    return _rate;
+}
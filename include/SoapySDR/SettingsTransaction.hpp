@@ -0,0 +1,124 @@
+///
+/// \file SoapySDR/SettingsTransaction.hpp
+///
+/// A batch of device settings applied with a single commit.
+///
+/// \copyright
+/// Copyright (c) 2018-2018 Josh Blum
+/// SPDX-License-Identifier: BSL-1.0
+///
+
+#pragma once
+#include <SoapySDR/Config.hpp>
+#include <SoapySDR/Types.hpp>
+#include <vector>
+#include <string>
+#include <cstddef> //size_t
+
+namespace SoapySDR
+{
+
+/*!
+ * A list of queued setter calls for Device::commitSettings().
+ *
+ * The setters mirror the device API, and may address several channels.
+ * Nothing is applied until the transaction is committed, which allows
+ * drivers to apply all of the settings in one bus or network transaction.
+ *
+ * \code
+ * SoapySDR::SettingsTransaction t;
+ * t.setFrequency(SOAPY_SDR_RX, 0, 915e6);
+ * t.setGain(SOAPY_SDR_RX, 0, 30.0);
+ * t.setFrequency(SOAPY_SDR_RX, 1, 868e6);
+ * device->commitSettings(t);
+ * \endcode
+ *
+ * With command times, a transaction is also a timed command list
+ * for Device::scheduleSettings(), such as a frequency hopping plan.
+ */
+class SOAPY_SDR_API SettingsTransaction
+{
+public:
+
+    //! The kind of setter call for a command
+    enum Type
+    {
+        FREQUENCY, //!< setFrequency(), a non-empty name selects a component
+        GAIN, //!< setGain(), a non-empty name selects an element
+        BANDWIDTH, //!< setBandwidth()
+        SAMPLE_RATE, //!< setSampleRate()
+        ANTENNA, //!< setAntenna() with the antenna in text
+        SETTING, //!< writeSetting() with the key in name and the value in text
+        CHANNEL_SETTING //!< channel writeSetting() with the key in name and the value in text
+    };
+
+    //! A single queued setter call
+    struct SOAPY_SDR_API Command
+    {
+        Command(void);
+        Type type;
+        int direction;
+        size_t channel;
+        std::string name;
+        double value;
+        std::string text;
+        Kwargs args;
+        long long timeNs; //!< command time for Device::scheduleSettings()
+    };
+
+    //! Create an empty transaction
+    SettingsTransaction(void);
+
+    //! Queue an overall center frequency tune
+    void setFrequency(const int direction, const size_t channel, const double frequency, const Kwargs &args = Kwargs());
+
+    //! Queue a frequency tune of a named tunable element
+    void setFrequency(const int direction, const size_t channel, const std::string &name, const double frequency, const Kwargs &args = Kwargs());
+
+    //! Queue an overall gain setting
+    void setGain(const int direction, const size_t channel, const double value);
+
+    //! Queue a gain setting of a named amplification element
+    void setGain(const int direction, const size_t channel, const std::string &name, const double value);
+
+    //! Queue a baseband filter bandwidth setting
+    void setBandwidth(const int direction, const size_t channel, const double bw);
+
+    //! Queue a baseband sample rate setting
+    void setSampleRate(const int direction, const size_t channel, const double rate);
+
+    //! Queue an antenna selection
+    void setAntenna(const int direction, const size_t channel, const std::string &name);
+
+    //! Queue an arbitrary device setting
+    void writeSetting(const std::string &key, const std::string &value);
+
+    //! Queue an arbitrary channel setting
+    void writeSetting(const int direction, const size_t channel, const std::string &key, const std::string &value);
+
+    /*!
+     * Set the command time for the subsequently queued commands.
+     * The time is only used by Device::scheduleSettings(),
+     * and commitSettings() applies the commands immediately.
+     * \param timeNs the hardware time in nanoseconds
+     */
+    void setCommandTime(const long long timeNs);
+
+    //! Get the queued commands in order
+    const std::vector<Command> &commands(void) const;
+
+    //! Remove all queued commands and reset the command time
+    void clear(void);
+
+private:
+    Command &push(const Type type, const int direction, const size_t channel);
+    std::vector<Command> _commands;
+    long long _timeNs;
+};
+
+}
+
+inline const std::vector<SoapySDR::SettingsTransaction::Command> &SoapySDR::SettingsTransaction::commands(void) const
+{
+    return _commands;
+}
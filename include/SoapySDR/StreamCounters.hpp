@@ -0,0 +1,101 @@
+///
+/// \file SoapySDR/StreamCounters.hpp
+///
+/// Statistics counters for the stream calls of a driver.
+///
+/// \copyright
+/// Copyright (c) 2018-2018 Josh Blum
+/// SPDX-License-Identifier: BSL-1.0
+///
+
+#pragma once
+#include <SoapySDR/Config.hpp>
+#include <SoapySDR/Types.hpp>
+#include <chrono>
+#include <cstddef> //size_t
+
+namespace SoapySDR
+{
+
+/*!
+ * Count the stream calls of a driver for Device::getStreamStats().
+ *
+ * Devices from Device::make() already count every stream with these
+ * counters in the library layer. A driver only needs its own counters
+ * to report the stats when it is used without that layer.
+ *
+ * The counters are relaxed atomics, so that the stats may be loaded
+ * from other threads while the stream is in use. Timed out calls
+ * are counted but left out of the latency figures.
+ *
+ * The latency_stats=true stream arg enables the timestamp latency:
+ * RX adds the hardware time at return minus the buffer's timestamp,
+ * TX adds the buffer's timestamp minus the hardware time at return.
+ * A log scale histogram with 8 bins per octave gives the percentile,
+ * accurate to the bin width of about 9%, negative values use bin 0.
+ *
+ * Example driver usage:
+ * \code
+ * //setupStream()
+ * stream->counters.reset(new SoapySDR::StreamCounters(direction, args));
+ *
+ * //readStream()
+ * const auto start = SoapySDR::StreamCounters::Clock::now();
+ * const int ret = this->transfer(stream, buffs, numElems, flags, timeNs, timeoutUs);
+ * stream->counters->countCall(start, ret, size_t(ret));
+ * if (ret > 0 and stream->counters->measuresTime()) stream->counters->countTime(flags, timeNs, this->getHardwareTime());
+ *
+ * //getStreamStats()
+ * stream->counters->load(stats);
+ * \endcode
+ */
+class SOAPY_SDR_API StreamCounters
+{
+public:
+
+    //! The clock of the call latency
+    typedef std::chrono::steady_clock Clock;
+
+    /*!
+     * Create zero counters for a stream.
+     * \param direction the stream direction RX or TX
+     * \param args the stream args, latency_stats=true measures the timestamps
+     */
+    StreamCounters(const int direction, const Kwargs &args = Kwargs());
+
+    ~StreamCounters(void);
+
+    //! True when the stream args enabled the timestamp latency
+    bool measuresTime(void) const;
+
+    /*!
+     * Count a read or write call.
+     * \param start the time when the call was made
+     * \param ret the return code of the call
+     * \param numElems the number of elements transferred, used when ret is not an error
+     */
+    void countCall(const Clock::time_point &start, const int ret, const size_t numElems);
+
+    //! Count the error code of a call or of readStreamStatus()
+    void countError(const int ret);
+
+    /*!
+     * Measure the timestamp of a transfer against the hardware time.
+     * Transfers without SOAPY_SDR_HAS_TIME in the flags are skipped.
+     * \param flags the flags of the transfer
+     * \param timeNs the timestamp of the transfer
+     * \param hardwareNs the hardware time when the call returned
+     */
+    void countTime(const int flags, const long long timeNs, const long long hardwareNs);
+
+    //! Load the counters into the stats, the buffer fill is left as is
+    void load(StreamStats &stats) const;
+
+private:
+    StreamCounters(const StreamCounters &);
+    StreamCounters &operator=(const StreamCounters &);
+    struct Impl;
+    Impl *_impl;
+};
+
+}
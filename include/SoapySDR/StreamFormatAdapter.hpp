@@ -0,0 +1,109 @@
+///
+/// \file SoapySDR/StreamFormatAdapter.hpp
+///
+/// Stream format conversion for drivers with a single native format.
+///
+/// \copyright
+/// Copyright (c) 2018-2018 Josh Blum
+/// SPDX-License-Identifier: BSL-1.0
+///
+
+#pragma once
+#include <SoapySDR/Config.hpp>
+#include <SoapySDR/Types.hpp>
+#include <SoapySDR/AsyncReader.hpp>
+#include <functional>
+#include <vector>
+#include <string>
+#include <cstddef> //size_t
+
+namespace SoapySDR
+{
+
+/*!
+ * Convert a stream between the host format and the driver's native format.
+ *
+ * A driver that transfers in one native format creates an adapter in
+ * setupStream() for any other format, and passes its native read or
+ * write through the adapter. The samples go through per-channel scratch
+ * buffers of one MTU, allocated once and placed on the numa_node
+ * stream arg, with the highest priority converter of the registry.
+ * Integer formats are scaled to the driver's full scale.
+ * Streams in the native format should not use an adapter.
+ *
+ * Device::make() already adapts the formats of every driver whose
+ * native format is listed by getStreamFormats(). A driver only needs
+ * an adapter of its own to convert inside its stream implementation.
+ *
+ * Example driver usage:
+ * \code
+ * //getStreamFormats()
+ * return SoapySDR::StreamFormatAdapter::listFormats(direction, SOAPY_SDR_CS16);
+ *
+ * //setupStream()
+ * if (format != SOAPY_SDR_CS16) stream->adapter.reset(new SoapySDR::StreamFormatAdapter(
+ *     direction, format, SOAPY_SDR_CS16, channels.size(), mtu, 2048, args));
+ *
+ * //readStream()
+ * if (not stream->adapter) return this->readNative(stream, buffs, numElems, flags, timeNs, timeoutUs);
+ * return stream->adapter->readStream(
+ *     [this, stream](void * const *buffs, const size_t numElems, int &flags, long long &timeNs, const long timeoutUs)
+ *     {return this->readNative(stream, buffs, numElems, flags, timeNs, timeoutUs);},
+ *     buffs, numElems, flags, timeNs, timeoutUs);
+ * \endcode
+ */
+class SOAPY_SDR_API StreamFormatAdapter
+{
+public:
+
+    //! The driver's native read, with the arguments of Device::readStream()
+    typedef AsyncReader::Transfer Read;
+
+    //! The driver's native write, with the arguments of Device::writeStream()
+    typedef std::function<int(const void * const *buffs, const size_t numElems, int &flags, const long long timeNs, const long timeoutUs)> Write;
+
+    /*!
+     * List the native format and every format that it converts to (RX) or from (TX).
+     * \param direction the stream direction RX or TX
+     * \param native the driver's native format
+     * \return the formats for Device::getStreamFormats()
+     */
+    static std::vector<std::string> listFormats(const int direction, const std::string &native);
+
+    /*!
+     * Look up the converter and allocate the scratch buffers.
+     * \param direction the stream direction RX or TX
+     * \param format the host format requested by setupStream()
+     * \param native the driver's native format
+     * \param numChans the number of channel buffers per transfer
+     * \param mtu the maximum number of elements per native transfer
+     * \param fullScale the full scale of the native format or 0 when unknown
+     * \param args the stream args, numa_node places the scratch buffers
+     * \throws std::runtime_error when there is no converter
+     */
+    StreamFormatAdapter(const int direction, const std::string &format, const std::string &native,
+        const size_t numChans, const size_t mtu, const double fullScale = 0.0, const Kwargs &args = Kwargs());
+
+    ~StreamFormatAdapter(void);
+
+    /*!
+     * Read up to one MTU in the native format and convert it into buffs.
+     * \return the return code of the native read
+     */
+    int readStream(const Read &read, void * const *buffs, const size_t numElems, int &flags, long long &timeNs, const long timeoutUs);
+
+    /*!
+     * Convert up to one MTU from buffs and write it in the native format.
+     * An end of burst is only passed on with the last of the elements.
+     * \return the return code of the native write
+     */
+    int writeStream(const Write &write, const void * const *buffs, const size_t numElems, int &flags, const long long timeNs, const long timeoutUs);
+
+private:
+    StreamFormatAdapter(const StreamFormatAdapter &);
+    StreamFormatAdapter &operator=(const StreamFormatAdapter &);
+    struct Impl;
+    Impl *_impl;
+};
+
+}
@@ -0,0 +1,107 @@
+///
+/// \file SoapySDR/StreamSubscription.hpp
+///
+/// Callback delivery of receive buffers for Device::subscribeStream().
+///
+/// \copyright
+/// Copyright (c) 2018-2018 Josh Blum
+/// SPDX-License-Identifier: BSL-1.0
+///
+
+#pragma once
+#include <SoapySDR/Config.hpp>
+#include <functional>
+#include <atomic>
+#include <cstddef> //size_t
+
+namespace SoapySDR
+{
+
+class Stream;
+
+/*!
+ * A receive stream whose buffers are handed to a callback as they arrive.
+ *
+ * The callback sees the driver's direct access buffers without a copy.
+ * The buffers are released to the driver when the callback returns,
+ * so a callback that keeps samples must copy them.
+ * Stream errors like SOAPY_SDR_OVERFLOW are delivered in order
+ * as the ret argument with null buffers.
+ *
+ * \code
+ * auto stream = device->setupStream(SOAPY_SDR_RX, SOAPY_SDR_CF32);
+ * auto subscription = device->subscribeStream(stream, 1,
+ *     [](const void * const *buffs, const int ret, const int flags, const long long timeNs)
+ *     {
+ *         if (ret > 0) process(static_cast<const std::complex<float> *>(buffs[0]), ret);
+ *     });
+ * device->activateStream(stream);
+ * ...
+ * device->deactivateStream(stream);
+ * device->unsubscribeStream(subscription);
+ * device->closeStream(stream);
+ * \endcode
+ */
+class SOAPY_SDR_API StreamSubscription
+{
+public:
+
+    /*!
+     * A callback invoked from the dispatch context with every buffer.
+     * \param buffs the channel buffers, valid until the callback returns
+     * \param ret the number of elements per buffer or an error code
+     * \param flags the flags of the buffer like SOAPY_SDR_HAS_TIME
+     * \param timeNs the hardware time of the first element
+     */
+    typedef std::function<void(const void * const *buffs, const int ret, const int flags, const long long timeNs)> Callback;
+
+    /*!
+     * Create a subscription, drivers use this to implement subscribeStream()
+     * \param stream the subscribed receive stream
+     * \param numChans the number of channels of the stream
+     * \param callback the callback for every buffer
+     */
+    StreamSubscription(Stream *stream, const size_t numChans, const Callback &callback);
+
+    virtual ~StreamSubscription(void);
+
+    //! Get the subscribed stream
+    Stream *stream(void) const;
+
+    //! Get the number of channels of the stream
+    size_t numChans(void) const;
+
+    /*!
+     * Deliver a buffer, drivers call this for every buffer or error.
+     * The callback is invoked in the calling context.
+     */
+    void publish(const void * const *buffs, const int ret, const int flags, const long long timeNs);
+
+    //! Get the number of buffers and errors delivered
+    unsigned long long numPublished(void) const;
+
+private:
+    StreamSubscription(const StreamSubscription &);
+    StreamSubscription &operator=(const StreamSubscription &);
+    Stream *_stream;
+    size_t _numChans;
+    Callback _callback;
+    std::atomic<unsigned long long> _numPublished;
+};
+
+}
+
+inline SoapySDR::Stream *SoapySDR::StreamSubscription::stream(void) const
+{
+    return _stream;
+}
+
+inline size_t SoapySDR::StreamSubscription::numChans(void) const
+{
+    return _numChans;
+}
+
+inline unsigned long long SoapySDR::StreamSubscription::numPublished(void) const
+{
+    return _numPublished.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,106 @@
+///
+/// \file SoapySDR/ThreadHints.hpp
+///
+/// Standard stream arguments for thread and memory placement.
+///
+/// \copyright
+/// Copyright (c) 2018-2018 Josh Blum
+/// SPDX-License-Identifier: BSL-1.0
+///
+
+#pragma once
+#include <SoapySDR/Config.hpp>
+#include <SoapySDR/Types.hpp>
+#include <vector>
+#include <string>
+#include <cstddef> //size_t
+
+/*!
+ * The CPUs that stream threads may run on.
+ * A list of CPU numbers and ranges such as "0-3 8" or "0-3:8",
+ * since commas separate the key/value pairs of args markup.
+ */
+#define SOAPY_SDR_THREAD_CPU_AFFINITY "cpu_affinity"
+
+//! The SCHED_FIFO priority of stream threads from 1 to 99, 0 for the default policy
+#define SOAPY_SDR_THREAD_RT_PRIORITY "rt_priority"
+
+//! The NUMA node for stream threads and buffers, -1 for no preference
+#define SOAPY_SDR_THREAD_NUMA_NODE "numa_node"
+
+namespace SoapySDR
+{
+
+/*!
+ * Placement hints for a driver's stream threads and buffers.
+ *
+ * The hints are parsed from the standard setupStream() args,
+ * and a driver applies them from inside each of its stream threads
+ * and to the buffers that those threads fill or drain.
+ * Drivers advertise support by appending argsInfo() to getStreamArgsInfo().
+ *
+ * \code
+ * SoapySDR::Stream *MyDevice::setupStream(..., const SoapySDR::Kwargs &args)
+ * {
+ *     _hints = SoapySDR::ThreadHints(args);
+ *     _hints.bindMemory(_ring.data(), _ring.size());
+ *     _thread = std::thread([this]{_hints.applyToThisThread(); this->workLoop();});
+ *     ...
+ * }
+ * \endcode
+ *
+ * Placement is supported on linux, other platforms ignore the hints.
+ * A failure to apply a hint, such as a missing permission
+ * for real-time priority, is logged as a warning rather than thrown.
+ */
+class SOAPY_SDR_API ThreadHints
+{
+public:
+
+    //! Create empty hints that leave threads and memory unchanged
+    ThreadHints(void);
+
+    /*!
+     * Parse the standard keys from stream args, other keys are ignored.
+     * \throws std::invalid_argument for a malformed value
+     */
+    ThreadHints(const Kwargs &args);
+
+    //! The arg info for getStreamArgsInfo() of drivers that apply the hints
+    static ArgInfoList argsInfo(void);
+
+    //! True when no hint is set
+    bool empty(void) const;
+
+    //! The CPUs from the affinity hint, empty for no preference
+    std::vector<size_t> cpus;
+
+    //! The SCHED_FIFO priority, 0 for the default scheduling
+    int priority;
+
+    //! The NUMA node, -1 for no preference
+    int numaNode;
+
+    /*!
+     * The CPUs that a thread will be restricted to:
+     * the affinity hint, otherwise the CPUs of the NUMA node.
+     */
+    std::vector<size_t> effectiveCpus(void) const;
+
+    /*!
+     * Apply the affinity and priority to the calling thread.
+     * \return true when every hint was applied
+     */
+    bool applyToThisThread(void) const;
+
+    /*!
+     * Bind the pages of a buffer to the NUMA node hint.
+     * Pages that were already touched are moved to the node.
+     * \param buff the start of the buffer
+     * \param length the buffer size in bytes
+     * \return true when bound or when there is no node hint
+     */
+    bool bindMemory(void *buff, const size_t length) const;
+};
+
+}
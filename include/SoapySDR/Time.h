@@ -10,6 +10,7 @@
 
 #pragma once
 #include <SoapySDR/Config.h>
+#include <stddef.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -31,6 +32,26 @@ SOAPY_SDR_API long long SoapySDR_ticksToTimeNs(const long long ticks, const doub
  */
 SOAPY_SDR_API long long SoapySDR_timeNsToTicks(const long long timeNs, const double rate);
 
+/*!
+ * Convert an array of tick counts into times in nanoseconds.
+ * The rate dependent terms are computed once for the entire array.
+ * \param ticks an array of integer tick counts
+ * \param [out] timeNs an array of times in nanoseconds
+ * \param length the number of elements in each array
+ * \param rate the ticks per second
+ */
+SOAPY_SDR_API void SoapySDR_ticksToTimeNsArray(const long long *ticks, long long *timeNs, const size_t length, const double rate);
+
+/*!
+ * Convert an array of times in nanoseconds into tick counts.
+ * The rate dependent terms are computed once for the entire array.
+ * \param timeNs an array of times in nanoseconds
+ * \param [out] ticks an array of integer tick counts
+ * \param length the number of elements in each array
+ * \param rate the ticks per second
+ */
+SOAPY_SDR_API void SoapySDR_timeNsToTicksArray(const long long *timeNs, long long *ticks, const size_t length, const double rate);
+
 #ifdef __cplusplus
 }
 #endif
@@ -4,13 +4,15 @@
 /// Utility functions to convert time and ticks.
 ///
 /// \copyright
-/// Copyright (c) 2015-2015 Josh Blum
+/// Copyright (c) 2015-2018 Josh Blum
 /// SPDX-License-Identifier: BSL-1.0
 ///
 
 #pragma once
 #include <SoapySDR/Config.hpp>
 #include <SoapySDR/Time.h>
+#include <cstddef>
+#include <cmath>
 
 namespace SoapySDR
 {
@@ -31,6 +33,45 @@ static inline long long ticksToTimeNs(const long long ticks, const double rate);
  */
 static inline long long timeNsToTicks(const long long timeNs, const double rate);
 
+/*!
+ * Convert between ticks and nanoseconds for a fixed tick rate.
+ * The rate dependent terms are computed once on construction,
+ * so that the conversions avoid floating point division.
+ * Rates that are an integer number of Hz use integer only arithmetic.
+ * The results are identical to ticksToTimeNs() and timeNsToTicks().
+ */
+class TickConverter
+{
+public:
+
+    //! Create a converter for the given ticks per second
+    TickConverter(const double rate = 1e9);
+
+    //! Get the ticks per second
+    double rate(void) const;
+
+    //! Convert a tick count into a time in nanoseconds
+    long long ticksToTimeNs(const long long ticks) const;
+
+    //! Convert a time in nanoseconds into a tick count
+    long long timeNsToTicks(const long long timeNs) const;
+
+    //! Convert an array of tick counts into times in nanoseconds
+    void ticksToTimeNs(const long long *ticks, long long *timeNs, const size_t length) const;
+
+    //! Convert an array of times in nanoseconds into tick counts
+    void timeNsToTicks(const long long *timeNs, long long *ticks, const size_t length) const;
+
+private:
+    static long long divRound(const long long num, const long long den);
+    double _rate;
+    long long _ratell;
+    double _rateFrac;
+    double _nsPerTick;
+    double _ticksPerNs;
+    bool _integer;
+};
+
 }
 
 static inline long long SoapySDR::ticksToTimeNs(const long long ticks, const double rate)
@@ -42,3 +83,59 @@ static inline long long SoapySDR::timeNsToTicks(const long long timeNs, const do
 {
     return SoapySDR_timeNsToTicks(timeNs, rate);
 }
+
+inline SoapySDR::TickConverter::TickConverter(const double rate):
+    _rate(rate),
+    _ratell((long long)(rate)),
+    _rateFrac(rate - (long long)(rate)),
+    _nsPerTick(1e9/rate),
+    _ticksPerNs(rate/1e9),
+    //the integer products below stay within range for rates up to 9 GHz
+    _integer(_rateFrac == 0.0 and _ratell > 0 and _ratell <= 9000000000LL)
+{
+    return;
+}
+
+inline double SoapySDR::TickConverter::rate(void) const
+{
+    return _rate;
+}
+
+inline long long SoapySDR::TickConverter::divRound(const long long num, const long long den)
+{
+    //round half away from zero like llround()
+    const long long q = num/den;
+    const long long r = num - q*den;
+    if (2*(r < 0 ? -r : r) < den) return q;
+    return (num < 0)?(q - 1):(q + 1);
+}
+
+inline long long SoapySDR::TickConverter::ticksToTimeNs(const long long ticks) const
+{
+    const long long full = (long long)(ticks/_ratell);
+    const long long err = ticks - (full*_ratell);
+    if (_integer) return (full*1000000000) + divRound(err*1000000000, _ratell);
+    const double part = full*_rateFrac;
+    const double frac = (err - part)*_nsPerTick;
+    return (full*1000000000) + std::llround(frac);
+}
+
+inline long long SoapySDR::TickConverter::timeNsToTicks(const long long timeNs) const
+{
+    const long long full = (long long)(timeNs/1000000000);
+    const long long err = timeNs - (full*1000000000);
+    if (_integer) return (full*_ratell) + divRound(err*_ratell, 1000000000);
+    const double part = full*_rateFrac;
+    const double frac = part + (err*_ticksPerNs);
+    return (full*_ratell) + std::llround(frac);
+}
+
+inline void SoapySDR::TickConverter::ticksToTimeNs(const long long *ticks, long long *timeNs, const size_t length) const
+{
+    for (size_t i = 0; i < length; i++) timeNs[i] = this->ticksToTimeNs(ticks[i]);
+}
+
+inline void SoapySDR::TickConverter::timeNsToTicks(const long long *timeNs, long long *ticks, const size_t length) const
+{
+    for (size_t i = 0; i < length; i++) ticks[i] = this->timeNsToTicks(timeNs[i]);
+}
@@ -0,0 +1,116 @@
+///
+/// \file SoapySDR/Tracer.hpp
+///
+/// Pluggable tracing of begin/end events in the library hot paths.
+///
+/// \copyright
+/// Copyright (c) 2018-2018 Josh Blum
+/// SPDX-License-Identifier: BSL-1.0
+///
+
+#pragma once
+#include <SoapySDR/Config.hpp>
+#include <string>
+#include <cstddef>
+
+namespace SoapySDR
+{
+
+/*!
+ * A tracer receives begin and end events from the instrumented calls:
+ * stream calls, conversions, stream setup and activation,
+ * module loading, and device construction.
+ * Events nest per thread, and every begin has a matching end.
+ * The name and category arguments are string literals
+ * which remain valid for the lifetime of the process.
+ * The implementation is called from the streaming threads
+ * and should not block, allocate, or perform IO inline.
+ */
+class SOAPY_SDR_API Tracer
+{
+public:
+    virtual ~Tracer(void);
+
+    //! Mark the beginning of an event on the calling thread
+    virtual void begin(const char *name, const char *category) = 0;
+
+    //! Mark the end of the last event begun on the calling thread
+    virtual void end(const char *name, const char *category) = 0;
+};
+
+/*!
+ * Register a tracer for all instrumented calls.
+ * The caller retains ownership, and the tracer must outlive its use:
+ * register nullptr and stop the stream threads before deleting it.
+ * \param tracer the new tracer or nullptr to disable tracing
+ */
+SOAPY_SDR_API void registerTracer(Tracer *tracer);
+
+//! Get the registered tracer or nullptr when tracing is disabled
+SOAPY_SDR_API Tracer *getTracer(void);
+
+/*!
+ * Trace the lifetime of a scope as one event.
+ * When no tracer is registered, the cost is a load and a branch.
+ */
+class TraceScope
+{
+public:
+    TraceScope(const char *name, const char *category):
+        _tracer(getTracer()),
+        _name(name),
+        _category(category)
+    {
+        if (_tracer != nullptr) _tracer->begin(_name, _category);
+    }
+
+    ~TraceScope(void)
+    {
+        if (_tracer != nullptr) _tracer->end(_name, _category);
+    }
+
+private:
+    TraceScope(const TraceScope &);
+    TraceScope &operator=(const TraceScope &);
+    Tracer *_tracer;
+    const char *_name;
+    const char *_category;
+};
+
+/*!
+ * A tracer that writes the Chrome trace event JSON format.
+ * The output can be viewed with chrome://tracing or similar tools.
+ * Events are recorded into a lock-free ring of compact records,
+ * and a background thread drains the ring into the file.
+ * Events are dropped and counted when the ring is full.
+ */
+class SOAPY_SDR_API ChromeTracer : public Tracer
+{
+public:
+
+    /*!
+     * Create a tracer that writes to a file.
+     * \throws std::runtime_error when the file cannot be opened
+     * \param path the path of the output JSON file
+     * \param capacity the number of events that can be buffered
+     */
+    ChromeTracer(const std::string &path, const size_t capacity = 1 << 16);
+
+    //! Write the remaining events and close the file
+    ~ChromeTracer(void);
+
+    void begin(const char *name, const char *category);
+
+    void end(const char *name, const char *category);
+
+    //! Get the number of events dropped because the ring was full
+    size_t getNumDropped(void) const;
+
+private:
+    ChromeTracer(const ChromeTracer &);
+    ChromeTracer &operator=(const ChromeTracer &);
+    struct Impl;
+    Impl *_impl;
+};
+
+}
@@ -102,6 +102,53 @@ typedef struct
 
 } SoapySDRArgInfo;
 
+//! Definition for stream statistics counters
+typedef struct
+{
+    //! The number of read or write calls on the stream
+    unsigned long long numCalls;
+
+    //! The number of elements transferred per channel
+    unsigned long long numElems;
+
+    //! The number of overflows reported by reads
+    unsigned long long numOverflows;
+
+    //! The number of underflows reported by writes or status
+    unsigned long long numUnderflows;
+
+    //! The number of late or otherwise bad timestamps
+    unsigned long long numTimeErrors;
+
+    //! The number of dropped or corrupted packets
+    unsigned long long numDropped;
+
+    //! The longest read or write call in nanoseconds
+    long long maxLatencyNs;
+
+    //! The average read or write call in nanoseconds
+    long long avgLatencyNs;
+
+    //! The fill level of the driver's buffers from 0.0 to 1.0, or negative when unknown
+    double bufferFill;
+
+    //! The number of timestamped transfers measured with the latency_stats stream arg
+    unsigned long long numTimestamps;
+
+    //! The smallest timestamp latency in nanoseconds
+    long long minTimeLatencyNs;
+
+    //! The average timestamp latency in nanoseconds
+    long long avgTimeLatencyNs;
+
+    //! The 99th percentile of the timestamp latency in nanoseconds
+    long long p99TimeLatencyNs;
+
+    //! The largest timestamp latency in nanoseconds
+    long long maxTimeLatencyNs;
+
+} SoapySDRStreamStats;
+
 /*!
  * Clear the contents of a list of string
  * Convenience call to deal with results that return a string list.
@@ -126,6 +126,66 @@ public:
  */
 typedef std::vector<ArgInfo> ArgInfoList;
 
+/*!
+ * Statistics counters for the activity on a stream.
+ * The counters accumulate from the time that the stream was setup.
+ */
+class SOAPY_SDR_API StreamStats
+{
+public:
+
+    //! Create stats with zero counters and unknown buffer fill
+    StreamStats(void);
+
+    //! The number of read or write calls on the stream
+    unsigned long long numCalls;
+
+    //! The number of elements transferred per channel
+    unsigned long long numElems;
+
+    //! The number of overflows reported by reads
+    unsigned long long numOverflows;
+
+    //! The number of underflows reported by writes or status
+    unsigned long long numUnderflows;
+
+    //! The number of late or otherwise bad timestamps
+    unsigned long long numTimeErrors;
+
+    //! The number of dropped or corrupted packets
+    unsigned long long numDropped;
+
+    //! The longest read or write call in nanoseconds
+    long long maxLatencyNs;
+
+    //! The average read or write call in nanoseconds
+    long long avgLatencyNs;
+
+    //! The fill level of the driver's buffers from 0.0 to 1.0, or negative when unknown
+    double bufferFill;
+
+    /*!
+     * The number of timestamped transfers measured against the hardware time.
+     * Only streams setup with the latency_stats=true stream arg are measured.
+     * RX measures the hardware time when a read returns minus the buffer's timestamp,
+     * TX measures the lead time of the buffer's timestamp when a write returns,
+     * which is negative for a late write.
+     */
+    unsigned long long numTimestamps;
+
+    //! The smallest timestamp latency in nanoseconds
+    long long minTimeLatencyNs;
+
+    //! The average timestamp latency in nanoseconds
+    long long avgTimeLatencyNs;
+
+    //! The 99th percentile of the timestamp latency in nanoseconds
+    long long p99TimeLatencyNs;
+
+    //! The largest timestamp latency in nanoseconds
+    long long maxTimeLatencyNs;
+};
+
 }
 
 inline double SoapySDR::Range::minimum(void) const
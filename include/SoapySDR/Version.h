@@ -35,7 +35,7 @@
  * And <i>extra</i> is empty for releases but set on development branches.
  * The ABI should remain constant across patch releases of the library.
  */
-#define SOAPY_SDR_ABI_VERSION "0.7"
+#define SOAPY_SDR_ABI_VERSION "0.7-1"
 
 /*!
  * Compatibility define for GPIO access API with masks
@@ -142,6 +142,181 @@
  */
 #define SOAPY_SDR_API_HAS_FREQUENCY_CORRECTION_API
 
+/*!
+ * Compatibility define for resolved converter handles and format IDs
+ */
+#define SOAPY_SDR_API_HAS_CONVERTER_HANDLE
+
+/*!
+ * Compatibility define for the multi-threaded converter pool
+ */
+#define SOAPY_SDR_API_HAS_CONVERTER_POOL
+
+/*!
+ * Compatibility define for fused deinterleave and interleave converters
+ */
+#define SOAPY_SDR_API_HAS_INTERLEAVE_CONVERTERS
+
+/*!
+ * Compatibility define for batched readStreamBatch() and writeStreamBatch()
+ */
+#define SOAPY_SDR_API_HAS_STREAM_BATCH
+
+/*!
+ * Compatibility define for getStreamStats() and StreamStats
+ */
+#define SOAPY_SDR_API_HAS_STREAM_STATS
+
+/*!
+ * Compatibility define for the Tracer API
+ */
+#define SOAPY_SDR_API_HAS_TRACER
+
+/*!
+ * Compatibility define for asynchronous logging
+ */
+#define SOAPY_SDR_API_HAS_LOG_ASYNC
+
+/*!
+ * Compatibility define for rate-limited logging
+ */
+#define SOAPY_SDR_API_HAS_LOG_RATE_LIMIT
+
+/*!
+ * Compatibility define for Device::makeAsync() and enumerateAsync()
+ */
+#define SOAPY_SDR_API_HAS_ASYNC_FACTORY
+
+/*!
+ * Compatibility define for batch make and unmake of device lists
+ */
+#define SOAPY_SDR_API_HAS_BATCH_FACTORY
+
+/*!
+ * Compatibility define for the module manifest cache
+ */
+#define SOAPY_SDR_API_HAS_MODULE_MANIFEST
+
+/*!
+ * Compatibility define for the FlatKwargs type
+ */
+#define SOAPY_SDR_API_HAS_FLAT_KWARGS
+
+/*!
+ * Compatibility define for TickConverter and the time conversion arrays
+ */
+#define SOAPY_SDR_API_HAS_TICK_CONVERTER
+
+/*!
+ * Compatibility define for SettingsTransaction and Device::commitSettings()
+ */
+#define SOAPY_SDR_API_HAS_SETTINGS_TRANSACTION
+
+/*!
+ * Compatibility define for Device::enableGainCache()
+ */
+#define SOAPY_SDR_API_HAS_GAIN_CACHE
+
+/*!
+ * Compatibility define for Device::scheduleSettings()
+ */
+#define SOAPY_SDR_API_HAS_SETTINGS_SCHEDULE
+
+/*!
+ * Compatibility define for the register defaults and scatter/gather overloads
+ */
+#define SOAPY_SDR_API_HAS_REGISTER_LIST
+
+/*!
+ * Compatibility define for Device::subscribeSensors()
+ */
+#define SOAPY_SDR_API_HAS_SENSOR_SUBSCRIPTION
+
+/*!
+ * Compatibility define for SoapySDRDevice_readStreamFast() and friends
+ */
+#define SOAPY_SDR_API_HAS_STREAM_FAST_PATH
+
+/*!
+ * Compatibility define for the converter C API in Converters.h
+ */
+#define SOAPY_SDR_API_HAS_CONVERTERS_C_API
+
+/*!
+ * Compatibility define for the single allocation *Arena() C calls
+ */
+#define SOAPY_SDR_API_HAS_ARENA_RESULTS
+
+/*!
+ * Compatibility define for the null device sources, loopback, and timing
+ */
+#define SOAPY_SDR_API_HAS_NULL_DEVICE_STREAMS
+
+/*!
+ * Compatibility define for the SoapySDR::ThreadHints stream args helper
+ */
+#define SOAPY_SDR_API_HAS_THREAD_HINTS
+
+/*!
+ * Compatibility define for allocBuffer() and the BufferPool class
+ */
+#define SOAPY_SDR_API_HAS_BUFFER_POOL
+
+/*!
+ * Compatibility define for the Recorder and SigMFMeta classes
+ */
+#define SOAPY_SDR_API_HAS_RECORDER
+
+/*!
+ * Compatibility define for the Player and MappedRecording classes
+ */
+#define SOAPY_SDR_API_HAS_PLAYER
+
+/*!
+ * Compatibility define for the AsyncReader prefetch adapter
+ */
+#define SOAPY_SDR_API_HAS_ASYNC_READER
+
+/*!
+ * Compatibility define for the BurstScheduler timed TX helper
+ */
+#define SOAPY_SDR_API_HAS_BURST_SCHEDULER
+
+/*!
+ * Compatibility define for Device::getStreamPollHandle()
+ */
+#define SOAPY_SDR_API_HAS_STREAM_POLL_HANDLE
+
+/*!
+ * Compatibility define for Device::subscribeStream()
+ */
+#define SOAPY_SDR_API_HAS_STREAM_SUBSCRIPTION
+
+/*!
+ * Compatibility define for the Scanner frequency sweeps
+ */
+#define SOAPY_SDR_API_HAS_SCANNER
+
+/*!
+ * Compatibility define for the timestamp latency figures of StreamStats
+ */
+#define SOAPY_SDR_API_HAS_STREAM_TIME_LATENCY
+
+/*!
+ * Compatibility define for the shared memory stream Broker
+ */
+#define SOAPY_SDR_API_HAS_BROKER
+
+/*!
+ * Compatibility define for the StreamCounters driver helper
+ */
+#define SOAPY_SDR_API_HAS_STREAM_COUNTERS
+
+/*!
+ * Compatibility define for the StreamFormatAdapter driver helper
+ */
+#define SOAPY_SDR_API_HAS_STREAM_FORMAT_ADAPTER
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -0,0 +1,162 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include "TypeHelpers.hpp"
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+
+/*******************************************************************
+ * Single allocation marshalling for the C API
+ ******************************************************************/
+
+/*!
+ * Carve a result out of one contiguous allocation.
+ * A layout function runs twice: first without a base pointer to measure
+ * the total size, then again to fill the allocation. All pointers from
+ * alloc() are null during the measure pass and must not be written.
+ * The first allocation is at the base, so free() on it releases the result.
+ */
+class SoapySDRArena
+{
+public:
+    SoapySDRArena(char *base = nullptr):
+        _base(base),
+        _offset(0)
+    {
+        return;
+    }
+
+    //! True during the measure pass
+    bool measuring(void) const
+    {
+        return _base == nullptr;
+    }
+
+    //! The total number of bytes laid out so far
+    size_t size(void) const
+    {
+        return _offset;
+    }
+
+    //! Allocate an aligned array of n elements
+    template <typename T>
+    T *alloc(const size_t n)
+    {
+        _offset = (_offset + alignof(T) - 1) & ~(alignof(T) - 1);
+        T *p = measuring()?nullptr:reinterpret_cast<T *>(_base + _offset);
+        _offset += n*sizeof(T);
+        return p;
+    }
+
+    //! Copy a string with its terminator
+    char *copy(const std::string &s)
+    {
+        char *p = this->alloc<char>(s.size()+1);
+        if (p != nullptr) std::memcpy(p, s.c_str(), s.size()+1);
+        return p;
+    }
+
+private:
+    char *_base;
+    size_t _offset;
+};
+
+//! Run a layout function in a single allocation, the result is released with free()
+template <typename T, typename Layout>
+T *toArena(const Layout &layout)
+{
+    SoapySDRArena measure;
+    layout(measure);
+    char *base = (char *)calloc(1, (measure.size() == 0)?1:measure.size());
+    if (base == nullptr) return nullptr;
+    SoapySDRArena arena(base);
+    layout(arena);
+    return reinterpret_cast<T *>(base);
+}
+
+static inline char **toStrArray(SoapySDRArena &arena, const std::vector<std::string> &strs)
+{
+    char **out = arena.alloc<char *>(strs.size());
+    for (size_t i = 0; i < strs.size(); i++)
+    {
+        char *s = arena.copy(strs[i]);
+        if (out != nullptr) out[i] = s;
+    }
+    return out;
+}
+
+static inline void toKwargs(SoapySDRArena &arena, const SoapySDR::Kwargs &args, SoapySDRKwargs *out)
+{
+    char **keys = arena.alloc<char *>(args.size());
+    char **vals = arena.alloc<char *>(args.size());
+    size_t i = 0;
+    for (const auto &it : args)
+    {
+        char *key = arena.copy(it.first);
+        char *val = arena.copy(it.second);
+        if (out != nullptr)
+        {
+            keys[i] = key;
+            vals[i] = val;
+        }
+        i++;
+    }
+    if (out == nullptr) return;
+    out->size = args.size();
+    out->keys = keys;
+    out->vals = vals;
+}
+
+static inline void toArgInfo(SoapySDRArena &arena, const SoapySDR::ArgInfo &info, SoapySDRArgInfo *out)
+{
+    char *key = arena.copy(info.key);
+    char *value = arena.copy(info.value);
+    char *name = arena.copy(info.name);
+    char *description = arena.copy(info.description);
+    char *units = arena.copy(info.units);
+    char **options = toStrArray(arena, info.options);
+    char **optionNames = toStrArray(arena, info.optionNames);
+    if (out == nullptr) return;
+    out->key = key;
+    out->value = value;
+    out->name = name;
+    out->description = description;
+    out->units = units;
+    out->type = SoapySDRArgInfoType(info.type);
+    out->range = toRange(info.range);
+    out->numOptions = info.options.size();
+    out->options = options;
+    out->optionNames = optionNames;
+}
+
+static inline char **toStrArrayArena(const std::vector<std::string> &strs, size_t *length)
+{
+    auto out = toArena<char *>([&strs](SoapySDRArena &arena){toStrArray(arena, strs);});
+    if (out != nullptr) *length = strs.size();
+    return out;
+}
+
+static inline SoapySDRKwargs *toKwargsListArena(const SoapySDR::KwargsList &args, size_t *length)
+{
+    auto out = toArena<SoapySDRKwargs>([&args](SoapySDRArena &arena)
+    {
+        SoapySDRKwargs *list = arena.alloc<SoapySDRKwargs>(args.size());
+        for (size_t i = 0; i < args.size(); i++) toKwargs(arena, args[i], (list == nullptr)?nullptr:list+i);
+    });
+    if (out != nullptr) *length = args.size();
+    return out;
+}
+
+static inline SoapySDRArgInfo *toArgInfoListArena(const SoapySDR::ArgInfoList &infos, size_t *length)
+{
+    auto out = toArena<SoapySDRArgInfo>([&infos](SoapySDRArena &arena)
+    {
+        SoapySDRArgInfo *list = arena.alloc<SoapySDRArgInfo>(infos.size());
+        for (size_t i = 0; i < infos.size(); i++) toArgInfo(arena, infos[i], (list == nullptr)?nullptr:list+i);
+    });
+    if (out != nullptr) *length = infos.size();
+    return out;
+}
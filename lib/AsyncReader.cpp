@@ -0,0 +1,243 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/AsyncReader.hpp>
+#include <SoapySDR/RingBuffer.hpp>
+#include <SoapySDR/Buffers.hpp>
+#include <SoapySDR/Constants.h>
+#include <SoapySDR/Errors.h>
+#include <SoapySDR/Time.hpp>
+#include <algorithm>
+#include <cstring>
+#include <atomic>
+#include <thread>
+
+/***********************************************************************
+ * The result of one transfer into the buffers of its slot
+ **********************************************************************/
+struct AsyncTransfer
+{
+    AsyncTransfer(void):
+        ret(0),
+        flags(0),
+        timeNs(0)
+    {
+        return;
+    }
+
+    int ret;
+    int flags;
+    long long timeNs;
+};
+
+struct SoapySDR::AsyncReader::Impl
+{
+    Impl(const size_t numTransfers):
+        ring(numTransfers),
+        numChans(0),
+        numElems(0),
+        elemSize(0),
+        rate(0.0),
+        running(false),
+        held(false),
+        heldHandle(0),
+        heldOffset(0)
+    {
+        return;
+    }
+
+    void work(void);
+    void drain(void);
+
+    SoapySDR::AsyncReader::Transfer transfer;
+    std::function<void(void)> notify;
+    SoapySDR::RingBuffer<AsyncTransfer> ring;
+    SoapySDR::BufferPool pool;
+    SoapySDR::ThreadHints hints;
+    size_t numChans;
+    size_t numElems;
+    size_t elemSize;
+    std::atomic<double> rate;
+    std::atomic<bool> running;
+    std::thread thread;
+
+    //the transfer that readStream() is part way through
+    bool held;
+    size_t heldHandle;
+    size_t heldOffset;
+};
+
+void SoapySDR::AsyncReader::Impl::work(void)
+{
+    hints.applyToThisThread();
+    while (running)
+    {
+        size_t handle(0);
+        AsyncTransfer *slot = ring.acquireWrite(handle, 100000);
+        if (slot == nullptr) continue;
+
+        //retry timeouts in place, a slot still holds a timeout when stopped
+        do
+        {
+            slot->flags = 0;
+            slot->timeNs = 0;
+            slot->ret = transfer(pool.buffs(handle), numElems, slot->flags, slot->timeNs, 100000);
+        } while (slot->ret == SOAPY_SDR_TIMEOUT and running);
+        ring.releaseWrite(handle);
+        if (notify) notify();
+    }
+}
+
+void SoapySDR::AsyncReader::Impl::drain(void)
+{
+    if (held) ring.releaseRead(heldHandle);
+    held = false;
+    size_t handle(0);
+    while (ring.acquireRead(handle) != nullptr) ring.releaseRead(handle);
+}
+
+/***********************************************************************
+ * AsyncReader
+ **********************************************************************/
+SoapySDR::AsyncReader::AsyncReader(const Transfer &transfer, const size_t numChans, const size_t numElems, const size_t elemSize, const size_t numTransfers, const ThreadHints &hints):
+    _impl(new Impl(std::max<size_t>(1, numTransfers)))
+{
+    _impl->transfer = transfer;
+    _impl->hints = hints;
+    _impl->numChans = numChans;
+    _impl->numElems = numElems;
+    _impl->elemSize = elemSize;
+    try
+    {
+        _impl->pool.resize(numChans, numElems, elemSize, _impl->ring.capacity(), 0, hints.numaNode);
+    }
+    catch (...)
+    {
+        delete _impl;
+        throw;
+    }
+}
+
+SoapySDR::AsyncReader::~AsyncReader(void)
+{
+    this->stop();
+    delete _impl;
+}
+
+void SoapySDR::AsyncReader::setSampleRate(const double rate)
+{
+    _impl->rate = rate;
+}
+
+void SoapySDR::AsyncReader::setNotify(const std::function<void(void)> &notify)
+{
+    _impl->notify = notify;
+}
+
+size_t SoapySDR::AsyncReader::numReady(void) const
+{
+    return _impl->ring.size();
+}
+
+void SoapySDR::AsyncReader::start(void)
+{
+    if (_impl->running) return;
+    _impl->running = true;
+    _impl->thread = std::thread(&Impl::work, _impl);
+}
+
+void SoapySDR::AsyncReader::stop(void)
+{
+    if (not _impl->running) return;
+    _impl->running = false;
+    _impl->thread.join();
+    _impl->drain();
+}
+
+int SoapySDR::AsyncReader::readStream(void * const *buffs, const size_t numElems, int &flags, long long &timeNs, const long timeoutUs)
+{
+    //the next transfer, timeouts left behind by a stop are skipped
+    while (not _impl->held)
+    {
+        const AsyncTransfer *slot = _impl->ring.acquireRead(_impl->heldHandle, timeoutUs);
+        if (slot == nullptr) return SOAPY_SDR_TIMEOUT;
+        if (slot->ret > 0)
+        {
+            _impl->held = true;
+            _impl->heldOffset = 0;
+            break;
+        }
+        const int ret = slot->ret;
+        flags = slot->flags;
+        timeNs = slot->timeNs;
+        _impl->ring.releaseRead(_impl->heldHandle);
+        if (ret != SOAPY_SDR_TIMEOUT) return ret;
+    }
+
+    const AsyncTransfer &slot = _impl->ring[_impl->heldHandle];
+    const size_t offset = _impl->heldOffset;
+    const size_t n = std::min(numElems, size_t(slot.ret) - offset);
+    void * const *src = _impl->pool.buffs(_impl->heldHandle);
+    for (size_t i = 0; i < _impl->numChans; i++)
+    {
+        std::memcpy(buffs[i], reinterpret_cast<const char *>(src[i]) + offset*_impl->elemSize, n*_impl->elemSize);
+    }
+
+    //the remainder of a split transfer is timestamped from the rate
+    flags = slot.flags & ~SOAPY_SDR_END_BURST;
+    timeNs = slot.timeNs;
+    if (offset != 0)
+    {
+        const double rate = _impl->rate;
+        if (rate > 0.0) timeNs += SoapySDR::ticksToTimeNs((long long)(offset), rate);
+        else flags &= ~SOAPY_SDR_HAS_TIME;
+    }
+
+    _impl->heldOffset += n;
+    if (_impl->heldOffset == size_t(slot.ret))
+    {
+        flags |= slot.flags & SOAPY_SDR_END_BURST;
+        _impl->held = false;
+        _impl->ring.releaseRead(_impl->heldHandle);
+    }
+    else flags |= SOAPY_SDR_MORE_FRAGMENTS;
+    return int(n);
+}
+
+size_t SoapySDR::AsyncReader::getNumDirectAccessBuffers(void) const
+{
+    return _impl->ring.capacity();
+}
+
+int SoapySDR::AsyncReader::getDirectAccessBufferAddrs(const size_t handle, void **buffs) const
+{
+    if (handle >= _impl->ring.capacity()) return SOAPY_SDR_STREAM_ERROR;
+    void * const *src = _impl->pool.buffs(handle);
+    std::copy(src, src + _impl->numChans, buffs);
+    return 0;
+}
+
+int SoapySDR::AsyncReader::acquireReadBuffer(size_t &handle, const void **buffs, int &flags, long long &timeNs, const long timeoutUs)
+{
+    while (true)
+    {
+        const AsyncTransfer *slot = _impl->ring.acquireRead(handle, timeoutUs);
+        if (slot == nullptr) return SOAPY_SDR_TIMEOUT;
+        const int ret = slot->ret;
+        flags = slot->flags;
+        timeNs = slot->timeNs;
+        if (ret > 0)
+        {
+            void * const *src = _impl->pool.buffs(handle);
+            std::copy(src, src + _impl->numChans, buffs);
+            return ret;
+        }
+        _impl->ring.releaseRead(handle);
+        if (ret != SOAPY_SDR_TIMEOUT) return ret;
+    }
+}
+
+void SoapySDR::AsyncReader::releaseReadBuffer(const size_t handle)
+{
+    _impl->ring.releaseRead(handle);
+}
@@ -0,0 +1,738 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include "SharedMemory.hpp"
+#include <SoapySDR/Broker.hpp>
+#include <SoapySDR/Device.hpp>
+#include <SoapySDR/Formats.hpp>
+#include <SoapySDR/Errors.hpp>
+#include <SoapySDR/Logger.hpp>
+#include <SoapySDR/ThreadHints.hpp>
+#include <stdexcept>
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <deque>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <ctime>
+#endif
+
+/***********************************************************************
+ * The shared memory layout:
+ * The header, the slot metadata, the reader entries,
+ * and the page aligned channel buffers of every slot.
+ * Everything that changes after the broker starts is an atomic,
+ * the slot metadata is guarded by the sequence number of the slot.
+ **********************************************************************/
+static const char brokerMagic[8] = {'S', 'O', 'A', 'P', 'Y', 'B', 'R', 'K'};
+static const uint32_t brokerVersion = 1;
+static const unsigned long long brokerNoSeq = ~0ull;
+static const size_t brokerLineSize = 64;
+static const size_t brokerPageSize = 4096;
+
+enum BrokerState
+{
+    BROKER_INIT,
+    BROKER_READY,
+    BROKER_STREAMING,
+    BROKER_STOPPED,
+    BROKER_FAILED,
+    BROKER_CLOSED
+};
+
+struct BrokerHeader
+{
+    BrokerHeader(void):
+        version(0),
+        numChans(0),
+        elemSize(0),
+        mtu(0),
+        numSlots(0),
+        window(0),
+        maxReaders(0),
+        slotsOffset(0),
+        readersOffset(0),
+        dataOffset(0),
+        chanStride(0),
+        length(0),
+        fullScale(0.0),
+        ownerPid(0),
+        sampleRate(0.0),
+        frequency(0.0),
+        state(BROKER_INIT),
+        sleepers(0),
+        wake(0),
+        writeSeq(0),
+        overflows(0)
+    {
+        std::memset(magic, 0, sizeof(magic));
+        std::memset(format, 0, sizeof(format));
+        std::memset(hardware, 0, sizeof(hardware));
+    }
+
+    //constant after the state leaves BROKER_INIT
+    char magic[8];
+    uint32_t version;
+    uint32_t numChans;
+    uint32_t elemSize;
+    uint32_t mtu;
+    uint32_t numSlots;
+    uint32_t window;
+    uint32_t maxReaders;
+    uint64_t slotsOffset;
+    uint64_t readersOffset;
+    uint64_t dataOffset;
+    uint64_t chanStride;
+    uint64_t length;
+    char format[32];
+    char hardware[64];
+    double fullScale;
+    int64_t ownerPid;
+
+    //updated by start()
+    std::atomic<double> sampleRate;
+    std::atomic<double> frequency;
+    std::atomic<uint32_t> state;
+
+    //readers sleep on the wake counter, which changes with every publish
+    std::atomic<uint32_t> sleepers;
+    alignas(brokerLineSize) std::atomic<uint32_t> wake;
+    alignas(brokerLineSize) std::atomic<unsigned long long> writeSeq;
+    std::atomic<unsigned long long> overflows;
+};
+
+struct alignas(brokerLineSize) BrokerSlot
+{
+    BrokerSlot(void):
+        seq(brokerNoSeq),
+        numElems(0),
+        flags(0),
+        gap(0),
+        timeNs(0)
+    {
+        return;
+    }
+
+    std::atomic<unsigned long long> seq;
+    uint32_t numElems;
+    int32_t flags;
+    uint32_t gap;
+    int64_t timeNs;
+};
+
+struct alignas(brokerLineSize) BrokerReaderEntry
+{
+    BrokerReaderEntry(void):
+        claimed(0),
+        pid(0),
+        position(0),
+        overflows(0),
+        dropped(0)
+    {
+        return;
+    }
+
+    std::atomic<uint32_t> claimed;
+    std::atomic<long long> pid;
+    std::atomic<unsigned long long> position;
+    std::atomic<unsigned long long> overflows;
+    std::atomic<unsigned long long> dropped;
+};
+
+struct BrokerLayout
+{
+    BrokerLayout(void *mem):
+        base(reinterpret_cast<char *>(mem)),
+        header(reinterpret_cast<BrokerHeader *>(mem))
+    {
+        return;
+    }
+
+    BrokerSlot &slot(const size_t index) const
+    {
+        return reinterpret_cast<BrokerSlot *>(base + header->slotsOffset)[index];
+    }
+
+    BrokerReaderEntry &reader(const size_t index) const
+    {
+        return reinterpret_cast<BrokerReaderEntry *>(base + header->readersOffset)[index];
+    }
+
+    char *buff(const size_t index, const size_t chan) const
+    {
+        return base + header->dataOffset + (index*header->numChans + chan)*header->chanStride;
+    }
+
+    char *base;
+    BrokerHeader *header;
+};
+
+static size_t roundUp(const size_t value, const size_t multiple)
+{
+    return ((value + multiple - 1)/multiple)*multiple;
+}
+
+/***********************************************************************
+ * Readers sleep on a futex in the shared mapping on linux,
+ * and poll the shared sequence elsewhere.
+ **********************************************************************/
+static void brokerWait(std::atomic<uint32_t> &word, const uint32_t value, const long timeoutUs)
+{
+    #ifdef __linux__
+    struct timespec timeout;
+    timeout.tv_sec = timeoutUs/1000000;
+    timeout.tv_nsec = (timeoutUs%1000000)*1000;
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT, value, &timeout, nullptr, 0);
+    #else
+    (void)word;
+    (void)value;
+    std::this_thread::sleep_for(std::chrono::microseconds(std::min<long>(timeoutUs, 50)));
+    #endif
+}
+
+static void brokerWake(BrokerHeader *header)
+{
+    header->wake.fetch_add(1);
+    #ifdef __linux__
+    if (header->sleepers.load() == 0) return;
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&header->wake), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    #endif
+}
+
+//the full scale of a converted stream format
+static double brokerFullScale(const std::string &format)
+{
+    if (format.find('F') != std::string::npos) return 1.0;
+    const size_t bits = SoapySDR::formatToSize(format)*8/((format[0] == 'C')?2:1);
+    return double(1ull << (bits-1));
+}
+
+static void copyString(char *dst, const size_t size, const std::string &src)
+{
+    std::strncpy(dst, src.c_str(), size-1);
+    dst[size-1] = '\0';
+}
+
+/***********************************************************************
+ * Broker
+ **********************************************************************/
+SoapySDR::Broker::ReaderStats::ReaderStats(void):
+    pid(0),
+    lag(0),
+    numOverflows(0),
+    numDropped(0)
+{
+    return;
+}
+
+struct SoapySDR::Broker::Impl
+{
+    Impl(void):
+        device(nullptr),
+        stream(nullptr),
+        layout(nullptr),
+        running(false),
+        seq(0)
+    {
+        return;
+    }
+
+    void publisher(void);
+
+    SoapySDR::Device *device;
+    SoapySDR::Stream *stream;
+    std::vector<size_t> channels;
+    std::string name;
+    SoapySDR::ThreadHints hints;
+    std::unique_ptr<SoapySDR::SharedMemory> shm;
+    BrokerLayout layout;
+    std::atomic<bool> running;
+    std::thread thread;
+    unsigned long long seq;
+};
+
+void SoapySDR::Broker::Impl::publisher(void)
+{
+    hints.applyToThisThread();
+    BrokerHeader *header = layout.header;
+    std::vector<void *> buffs(channels.size());
+    bool gap = false;
+
+    while (running)
+    {
+        //invalidate the slot so that a reader still holding it sees the overwrite
+        const size_t index = size_t(seq % header->numSlots);
+        BrokerSlot &slot = layout.slot(index);
+        slot.seq.store(brokerNoSeq, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        for (size_t i = 0; i < buffs.size(); i++) buffs[i] = layout.buff(index, i);
+        int flags(0);
+        long long timeNs(0);
+        const int ret = device->readStream(stream, buffs.data(), header->mtu, flags, timeNs, 100000);
+        if (ret == SOAPY_SDR_TIMEOUT) continue;
+        if (ret == SOAPY_SDR_OVERFLOW)
+        {
+            header->overflows.fetch_add(1, std::memory_order_relaxed);
+            gap = true;
+            continue;
+        }
+        if (ret == SOAPY_SDR_CORRUPTION or ret == SOAPY_SDR_TIME_ERROR)
+        {
+            SoapySDR::logfLimited(SOAPY_SDR_WARNING, "Broker %s: readStream() %s", name.c_str(), SoapySDR::errToStr(ret));
+            gap = true;
+            continue;
+        }
+        if (ret < 0)
+        {
+            SoapySDR::logf(SOAPY_SDR_ERROR, "Broker %s: readStream() failed: %s", name.c_str(), SoapySDR::errToStr(ret));
+            header->state.store(BROKER_FAILED, std::memory_order_release);
+            break;
+        }
+
+        //a discontinuity is reported to the readers before the buffer that follows it
+        slot.numElems = uint32_t(ret);
+        slot.flags = flags;
+        slot.gap = gap?1:0;
+        slot.timeNs = timeNs;
+        gap = false;
+        slot.seq.store(seq, std::memory_order_release);
+        header->writeSeq.store(++seq, std::memory_order_release);
+        brokerWake(header);
+    }
+    brokerWake(header);
+}
+
+SoapySDR::Broker::Broker(Device *device, const std::vector<size_t> &channels, const std::string &name, const Kwargs &args_):
+    _impl(new Impl())
+{
+    //split the broker args from the stream args
+    auto args = args_;
+    auto take = [&args](const std::string &key, const std::string &defaultValue)
+    {
+        const auto it = args.find(key);
+        if (it == args.end()) return defaultValue;
+        const auto value = it->second;
+        args.erase(it);
+        return value;
+    };
+    const auto format = take("format", "");
+    const size_t numSlots = std::max<size_t>(2, std::stoul(take("buffers", "64")));
+    const size_t guard = std::min(numSlots-1, std::max<size_t>(1, std::stoul(take("guard", std::to_string(numSlots/4)))));
+    const size_t maxReaders = std::max<size_t>(1, std::stoul(take("readers", "16")));
+    if (channels.empty()) throw std::runtime_error("Broker needs at least one channel");
+
+    _impl->device = device;
+    _impl->channels = channels;
+    _impl->name = name;
+
+    try
+    {
+        double fullScale(0.0);
+        _impl->hints = SoapySDR::ThreadHints(args);
+        const auto native = device->getNativeStreamFormat(SOAPY_SDR_RX, channels.front(), fullScale);
+        const auto streamFormat = format.empty()?native:format;
+        if (streamFormat != native) fullScale = brokerFullScale(streamFormat);
+        const size_t elemSize = SoapySDR::formatToSize(streamFormat);
+        _impl->stream = device->setupStream(SOAPY_SDR_RX, streamFormat, channels, args);
+        const size_t mtu = device->getStreamMTU(_impl->stream);
+
+        const size_t slotsOffset = roundUp(sizeof(BrokerHeader), brokerLineSize);
+        const size_t readersOffset = slotsOffset + numSlots*sizeof(BrokerSlot);
+        const size_t dataOffset = roundUp(readersOffset + maxReaders*sizeof(BrokerReaderEntry), brokerPageSize);
+        const size_t chanStride = roundUp(mtu*elemSize, brokerLineSize);
+        const size_t length = dataOffset + numSlots*channels.size()*chanStride;
+
+        //a segment left behind by a broker that has exited is replaced
+        _impl->shm.reset(SoapySDR::SharedMemory::create(name, length));
+        if (not _impl->shm)
+        {
+            bool stale(false);
+            try
+            {
+                std::unique_ptr<SoapySDR::SharedMemory> existing(SoapySDR::SharedMemory::open(name));
+                const BrokerHeader *header = reinterpret_cast<const BrokerHeader *>(existing->data());
+                const uint32_t state = (existing->length() < sizeof(BrokerHeader))?uint32_t(BROKER_INIT):header->state.load();
+                stale = state == BROKER_CLOSED or (state != BROKER_INIT and not SoapySDR::SharedMemory::processAlive(header->ownerPid));
+            }
+            catch (const std::runtime_error &) {}
+            if (not stale) throw std::runtime_error("Broker name " + name + " is in use");
+            SoapySDR::SharedMemory::remove(name);
+            _impl->shm.reset(SoapySDR::SharedMemory::create(name, length));
+            if (not _impl->shm) throw std::runtime_error("Broker name " + name + " is in use");
+        }
+
+        _impl->layout = BrokerLayout(_impl->shm->data());
+        BrokerHeader *header = new (_impl->shm->data()) BrokerHeader();
+        if (not header->writeSeq.is_lock_free()) throw std::runtime_error("Broker needs lock-free 64-bit atomics");
+        std::memcpy(header->magic, brokerMagic, sizeof(brokerMagic));
+        header->version = brokerVersion;
+        header->numChans = uint32_t(channels.size());
+        header->elemSize = uint32_t(elemSize);
+        header->mtu = uint32_t(mtu);
+        header->numSlots = uint32_t(numSlots);
+        header->window = uint32_t(numSlots - guard);
+        header->maxReaders = uint32_t(maxReaders);
+        header->slotsOffset = slotsOffset;
+        header->readersOffset = readersOffset;
+        header->dataOffset = dataOffset;
+        header->chanStride = chanStride;
+        header->length = length;
+        copyString(header->format, sizeof(header->format), streamFormat);
+        copyString(header->hardware, sizeof(header->hardware), device->getHardwareKey());
+        header->fullScale = fullScale;
+        header->ownerPid = SoapySDR::SharedMemory::processId();
+        header->sampleRate = device->getSampleRate(SOAPY_SDR_RX, channels.front());
+        header->frequency = device->getFrequency(SOAPY_SDR_RX, channels.front());
+        for (size_t i = 0; i < numSlots; i++) new (&_impl->layout.slot(i)) BrokerSlot();
+        for (size_t i = 0; i < maxReaders; i++) new (&_impl->layout.reader(i)) BrokerReaderEntry();
+        header->state.store(BROKER_READY, std::memory_order_release);
+    }
+    catch (...)
+    {
+        if (_impl->shm) SoapySDR::SharedMemory::remove(name);
+        if (_impl->stream != nullptr) device->closeStream(_impl->stream);
+        delete _impl;
+        throw;
+    }
+}
+
+SoapySDR::Broker::~Broker(void)
+{
+    try
+    {
+        this->stop();
+    }
+    catch (const std::exception &ex)
+    {
+        SoapySDR::logf(SOAPY_SDR_ERROR, "Broker::~Broker() %s", ex.what());
+    }
+    _impl->device->closeStream(_impl->stream);
+
+    //attached readers keep their mapping and see the closed state
+    _impl->layout.header->state.store(BROKER_CLOSED, std::memory_order_release);
+    brokerWake(_impl->layout.header);
+    SoapySDR::SharedMemory::remove(_impl->name);
+    delete _impl;
+}
+
+void SoapySDR::Broker::start(void)
+{
+    if (_impl->running) throw std::runtime_error("Broker::start() already started");
+    BrokerHeader *header = _impl->layout.header;
+    header->sampleRate = _impl->device->getSampleRate(SOAPY_SDR_RX, _impl->channels.front());
+    header->frequency = _impl->device->getFrequency(SOAPY_SDR_RX, _impl->channels.front());
+
+    const int ret = _impl->device->activateStream(_impl->stream);
+    if (ret != 0) throw std::runtime_error(std::string("Broker::start() activateStream() failed: ") + SoapySDR::errToStr(ret));
+    header->state.store(BROKER_STREAMING, std::memory_order_release);
+    _impl->running = true;
+    _impl->thread = std::thread(&Impl::publisher, _impl);
+}
+
+void SoapySDR::Broker::stop(void)
+{
+    if (not _impl->running) return;
+    _impl->running = false;
+    _impl->thread.join();
+    _impl->device->deactivateStream(_impl->stream);
+    uint32_t state = BROKER_STREAMING;
+    _impl->layout.header->state.compare_exchange_strong(state, BROKER_STOPPED);
+    brokerWake(_impl->layout.header);
+}
+
+std::string SoapySDR::Broker::name(void) const
+{
+    return _impl->name;
+}
+
+unsigned long long SoapySDR::Broker::numBuffers(void) const
+{
+    return _impl->layout.header->writeSeq.load(std::memory_order_relaxed);
+}
+
+unsigned long long SoapySDR::Broker::numOverflows(void) const
+{
+    return _impl->layout.header->overflows.load(std::memory_order_relaxed);
+}
+
+std::vector<SoapySDR::Broker::ReaderStats> SoapySDR::Broker::readers(void) const
+{
+    const BrokerHeader *header = _impl->layout.header;
+    const unsigned long long written = header->writeSeq.load(std::memory_order_acquire);
+    std::vector<ReaderStats> readers;
+    for (size_t i = 0; i < header->maxReaders; i++)
+    {
+        const BrokerReaderEntry &entry = _impl->layout.reader(i);
+        if (entry.claimed.load(std::memory_order_acquire) == 0) continue;
+        ReaderStats stats;
+        stats.pid = entry.pid.load(std::memory_order_relaxed);
+        const unsigned long long position = entry.position.load(std::memory_order_relaxed);
+        stats.lag = (written > position)?(written - position):0;
+        stats.numOverflows = entry.overflows.load(std::memory_order_relaxed);
+        stats.numDropped = entry.dropped.load(std::memory_order_relaxed);
+        readers.push_back(stats);
+    }
+    return readers;
+}
+
+/***********************************************************************
+ * BrokerReader
+ **********************************************************************/
+struct SoapySDR::BrokerReader::Impl
+{
+    Impl(void):
+        layout(nullptr),
+        entry(nullptr),
+        position(0),
+        gapReported(brokerNoSeq),
+        pendingOverflow(false)
+    {
+        return;
+    }
+
+    void moveTo(const unsigned long long seq)
+    {
+        position = seq;
+        entry->position.store(seq, std::memory_order_relaxed);
+    }
+
+    std::string name;
+    std::unique_ptr<SoapySDR::SharedMemory> shm;
+    BrokerLayout layout;
+    BrokerReaderEntry *entry;
+    unsigned long long position;
+    unsigned long long gapReported;
+    bool pendingOverflow;
+    std::deque<unsigned long long> held;
+};
+
+SoapySDR::BrokerReader::BrokerReader(const std::string &name):
+    _impl(new Impl())
+{
+    try
+    {
+        _impl->name = name;
+        _impl->shm.reset(SoapySDR::SharedMemory::open(name));
+        _impl->layout = BrokerLayout(_impl->shm->data());
+        const BrokerHeader *header = _impl->layout.header;
+        if (_impl->shm->length() < sizeof(BrokerHeader) or header->state.load(std::memory_order_acquire) == BROKER_INIT)
+        {
+            throw std::runtime_error("BrokerReader broker " + name + " is not ready");
+        }
+        if (std::memcmp(header->magic, brokerMagic, sizeof(brokerMagic)) != 0 or header->version != brokerVersion)
+        {
+            throw std::runtime_error("BrokerReader segment " + name + " is not a compatible broker");
+        }
+        if (_impl->shm->length() < header->length) throw std::runtime_error("BrokerReader segment " + name + " is truncated");
+        if (header->state.load(std::memory_order_acquire) == BROKER_CLOSED) throw std::runtime_error("BrokerReader broker " + name + " is closed");
+        if (not SoapySDR::SharedMemory::processAlive(header->ownerPid)) throw std::runtime_error("BrokerReader broker " + name + " has exited");
+
+        //claim a free entry, or the entry of a reader that has exited
+        const long long pid = SoapySDR::SharedMemory::processId();
+        for (size_t i = 0; i < header->maxReaders and _impl->entry == nullptr; i++)
+        {
+            BrokerReaderEntry &entry = _impl->layout.reader(i);
+            uint32_t expected = 0;
+            if (entry.claimed.compare_exchange_strong(expected, 1)) _impl->entry = &entry;
+        }
+        for (size_t i = 0; i < header->maxReaders and _impl->entry == nullptr; i++)
+        {
+            BrokerReaderEntry &entry = _impl->layout.reader(i);
+            long long owner = entry.pid.load();
+            if (owner == 0 or SoapySDR::SharedMemory::processAlive(owner)) continue;
+            if (entry.pid.compare_exchange_strong(owner, pid)) _impl->entry = &entry;
+        }
+        if (_impl->entry == nullptr) throw std::runtime_error("BrokerReader broker " + name + " has no free reader entry");
+        _impl->entry->pid.store(pid);
+        _impl->entry->overflows.store(0, std::memory_order_relaxed);
+        _impl->entry->dropped.store(0, std::memory_order_relaxed);
+        this->resync();
+    }
+    catch (...)
+    {
+        if (_impl->entry != nullptr) _impl->entry->claimed.store(0, std::memory_order_release);
+        delete _impl;
+        throw;
+    }
+}
+
+SoapySDR::BrokerReader::~BrokerReader(void)
+{
+    _impl->entry->pid.store(0);
+    _impl->entry->claimed.store(0, std::memory_order_release);
+    delete _impl;
+}
+
+std::string SoapySDR::BrokerReader::name(void) const
+{
+    return _impl->name;
+}
+
+std::string SoapySDR::BrokerReader::format(void) const
+{
+    return _impl->layout.header->format;
+}
+
+double SoapySDR::BrokerReader::fullScale(void) const
+{
+    return _impl->layout.header->fullScale;
+}
+
+size_t SoapySDR::BrokerReader::numChannels(void) const
+{
+    return _impl->layout.header->numChans;
+}
+
+size_t SoapySDR::BrokerReader::mtu(void) const
+{
+    return _impl->layout.header->mtu;
+}
+
+size_t SoapySDR::BrokerReader::numBuffers(void) const
+{
+    return _impl->layout.header->numSlots;
+}
+
+double SoapySDR::BrokerReader::sampleRate(void) const
+{
+    return _impl->layout.header->sampleRate;
+}
+
+double SoapySDR::BrokerReader::frequency(void) const
+{
+    return _impl->layout.header->frequency;
+}
+
+std::string SoapySDR::BrokerReader::hardwareKey(void) const
+{
+    return _impl->layout.header->hardware;
+}
+
+long long SoapySDR::BrokerReader::ownerPid(void) const
+{
+    return _impl->layout.header->ownerPid;
+}
+
+void SoapySDR::BrokerReader::resync(void)
+{
+    const unsigned long long written = _impl->layout.header->writeSeq.load(std::memory_order_acquire);
+    _impl->moveTo((written == 0)?0:(written-1));
+    _impl->gapReported = _impl->position;
+    _impl->pendingOverflow = false;
+}
+
+int SoapySDR::BrokerReader::acquire(size_t &handle, const void **buffs, int &flags, long long &timeNs, const long timeoutUs)
+{
+    BrokerHeader *header = _impl->layout.header;
+    if (_impl->pendingOverflow)
+    {
+        //the overwrite was already counted, a lap since then is reported with it
+        _impl->pendingOverflow = false;
+        const unsigned long long written = header->writeSeq.load(std::memory_order_acquire);
+        if (written - _impl->position > header->window)
+        {
+            _impl->entry->dropped.fetch_add(written - 1 - _impl->position, std::memory_order_relaxed);
+            _impl->moveTo(written-1);
+            _impl->gapReported = _impl->position;
+        }
+        return SOAPY_SDR_OVERFLOW;
+    }
+
+    const auto exitTime = std::chrono::steady_clock::now() + std::chrono::microseconds(timeoutUs);
+    while (true)
+    {
+        //wait for the broker to publish past the position
+        const uint32_t wake = header->wake.load(std::memory_order_acquire);
+        const unsigned long long written = header->writeSeq.load(std::memory_order_acquire);
+        if (written <= _impl->position)
+        {
+            const uint32_t state = header->state.load(std::memory_order_acquire);
+            if (state == BROKER_FAILED or state == BROKER_CLOSED) return SOAPY_SDR_STREAM_ERROR;
+            const auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(exitTime - std::chrono::steady_clock::now()).count();
+            if (remaining <= 0)
+            {
+                //a broker that was killed never sets the closed state
+                if (not SoapySDR::SharedMemory::processAlive(header->ownerPid)) return SOAPY_SDR_STREAM_ERROR;
+                return SOAPY_SDR_TIMEOUT;
+            }
+            header->sleepers.fetch_add(1);
+            brokerWait(header->wake, wake, long(remaining));
+            header->sleepers.fetch_sub(1);
+            continue;
+        }
+
+        //lapped: skip to the newest buffer and report the loss once
+        if (written - _impl->position > header->window)
+        {
+            _impl->entry->overflows.fetch_add(1, std::memory_order_relaxed);
+            _impl->entry->dropped.fetch_add(written - 1 - _impl->position, std::memory_order_relaxed);
+            _impl->moveTo(written-1);
+            _impl->gapReported = _impl->position;
+            return SOAPY_SDR_OVERFLOW;
+        }
+
+        //a changed slot sequence means the broker lapped since the check above
+        const size_t index = size_t(_impl->position % header->numSlots);
+        const BrokerSlot &slot = _impl->layout.slot(index);
+        if (slot.seq.load(std::memory_order_acquire) != _impl->position) continue;
+        if (slot.gap != 0 and _impl->gapReported != _impl->position)
+        {
+            _impl->gapReported = _impl->position;
+            return SOAPY_SDR_OVERFLOW;
+        }
+        const int numElems = int(slot.numElems);
+        flags = slot.flags;
+        timeNs = slot.timeNs;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.seq.load(std::memory_order_relaxed) != _impl->position) continue;
+
+        handle = index;
+        this->bufferAddrs(index, buffs);
+        _impl->held.push_back(_impl->position);
+        _impl->moveTo(_impl->position+1);
+        return numElems;
+    }
+}
+
+void SoapySDR::BrokerReader::release(const size_t handle)
+{
+    const size_t numSlots = _impl->layout.header->numSlots;
+    auto &held = _impl->held;
+    const auto it = std::find_if(held.begin(), held.end(), [handle, numSlots](const unsigned long long seq){return seq % numSlots == handle;});
+    if (it == held.end()) return;
+    const unsigned long long seq = *it;
+    held.erase(it);
+
+    //the broker invalidates a slot before it overwrites it
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (_impl->layout.slot(handle).seq.load(std::memory_order_relaxed) != seq)
+    {
+        _impl->entry->overflows.fetch_add(1, std::memory_order_relaxed);
+        _impl->pendingOverflow = true;
+    }
+}
+
+void SoapySDR::BrokerReader::bufferAddrs(const size_t handle, const void **buffs) const
+{
+    for (size_t i = 0; i < _impl->layout.header->numChans; i++) buffs[i] = _impl->layout.buff(handle, i);
+}
+
+unsigned long long SoapySDR::BrokerReader::numOverflows(void) const
+{
+    return _impl->entry->overflows.load(std::memory_order_relaxed);
+}
+
+unsigned long long SoapySDR::BrokerReader::numDropped(void) const
+{
+    return _impl->entry->dropped.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,199 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/Buffers.hpp>
+#include <SoapySDR/ThreadHints.hpp>
+#include <SoapySDR/Device.hpp>
+#include <SoapySDR/Formats.hpp>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdint>
+#include <new>
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/***********************************************************************
+ * Every buffer is preceded by a header that records how to release it
+ **********************************************************************/
+enum BufferKind
+{
+    BUFFER_HEAP,
+    BUFFER_MAPPED
+};
+
+struct BufferHeader
+{
+    void *base;
+    size_t length;
+    BufferKind kind;
+};
+
+//the size of the huge pages that mapped lengths are rounded to
+static const size_t hugePageSize = size_t(2) << 20;
+
+static size_t alignUp(const size_t value, const size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static void *placeBuffer(void *base, const size_t length, const BufferKind kind, const size_t alignment)
+{
+    const size_t addr = alignUp(size_t(base) + sizeof(BufferHeader), alignment);
+    auto header = reinterpret_cast<BufferHeader *>(addr) - 1;
+    header->base = base;
+    header->length = length;
+    header->kind = kind;
+    return reinterpret_cast<void *>(addr);
+}
+
+#ifdef __linux__
+static void *mapBuffer(const size_t length, const int flags)
+{
+    //the huge page pool first, then regular pages with transparent huge pages
+    if ((flags & SOAPY_SDR_BUFFER_HUGE_PAGES) != 0)
+    {
+        #ifdef MAP_HUGETLB
+        void *base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (base != MAP_FAILED) return base;
+        #endif
+    }
+    void *base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) return nullptr;
+    #ifdef MADV_HUGEPAGE
+    if ((flags & SOAPY_SDR_BUFFER_HUGE_PAGES) != 0) madvise(base, length, MADV_HUGEPAGE);
+    #endif
+    return base;
+}
+#endif
+
+void *SoapySDR::allocBuffer(const size_t size, const int flags, const int numaNode, const size_t alignment_)
+{
+    const size_t alignment = std::max<size_t>(alignment_, SOAPY_SDR_BUFFER_ALIGNMENT);
+    if ((alignment & (alignment - 1)) != 0) throw std::invalid_argument("allocBuffer() alignment must be a power of two");
+    const size_t length = size + sizeof(BufferHeader) + alignment - 1;
+
+    //pages of their own for huge pages and binding, so that no other allocation shares them
+    #ifdef __linux__
+    if ((flags & SOAPY_SDR_BUFFER_HUGE_PAGES) != 0 or numaNode >= 0)
+    {
+        const size_t pageSize = ((flags & SOAPY_SDR_BUFFER_HUGE_PAGES) != 0)?hugePageSize:size_t(sysconf(_SC_PAGESIZE));
+        const size_t mapLength = alignUp(length, pageSize);
+        void *base = mapBuffer(mapLength, flags);
+        if (base == nullptr) throw std::bad_alloc();
+        SoapySDR::ThreadHints hints;
+        hints.numaNode = numaNode;
+        hints.bindMemory(base, mapLength);
+        return placeBuffer(base, mapLength, BUFFER_MAPPED, alignment);
+    }
+    #else
+    (void)flags;
+    (void)numaNode;
+    #endif
+
+    void *base = std::malloc(length);
+    if (base == nullptr) throw std::bad_alloc();
+    return placeBuffer(base, length, BUFFER_HEAP, alignment);
+}
+
+void SoapySDR::freeBuffer(void *buff)
+{
+    if (buff == nullptr) return;
+    const auto header = reinterpret_cast<BufferHeader *>(buff) - 1;
+    #ifdef __linux__
+    if (header->kind == BUFFER_MAPPED)
+    {
+        munmap(header->base, header->length);
+        return;
+    }
+    #endif
+    std::free(header->base);
+}
+
+/***********************************************************************
+ * Buffer pool
+ **********************************************************************/
+SoapySDR::BufferPool::BufferPool(void):
+    _mem(nullptr),
+    _capacity(0),
+    _flags(0),
+    _numaNode(-1),
+    _numBuffs(0),
+    _numChans(0),
+    _numElems(0)
+{
+    return;
+}
+
+SoapySDR::BufferPool::BufferPool(const size_t numChans, const size_t numElems, const size_t elemSize, const size_t numBuffs, const int flags, const int numaNode):
+    _mem(nullptr),
+    _capacity(0),
+    _flags(0),
+    _numaNode(-1),
+    _numBuffs(0),
+    _numChans(0),
+    _numElems(0)
+{
+    this->resize(numChans, numElems, elemSize, numBuffs, flags, numaNode);
+}
+
+SoapySDR::BufferPool::BufferPool(Device *device, Stream *stream, const size_t numChans, const std::string &format, const size_t numBuffs, const int flags, const int numaNode):
+    _mem(nullptr),
+    _capacity(0),
+    _flags(0),
+    _numaNode(-1),
+    _numBuffs(0),
+    _numChans(0),
+    _numElems(0)
+{
+    this->resize(numChans, device->getStreamMTU(stream), SoapySDR::formatToSize(format), numBuffs, flags, numaNode);
+}
+
+SoapySDR::BufferPool::~BufferPool(void)
+{
+    SoapySDR::freeBuffer(_mem);
+}
+
+void SoapySDR::BufferPool::resize(const size_t numChans, const size_t numElems, const size_t elemSize, const size_t numBuffs, const int flags, const int numaNode)
+{
+    const size_t stride = alignUp(numElems*elemSize, SOAPY_SDR_BUFFER_ALIGNMENT);
+    const size_t size = numBuffs*numChans*stride;
+    if (size > _capacity or flags != _flags or numaNode != _numaNode or _mem == nullptr)
+    {
+        void *mem = SoapySDR::allocBuffer(std::max<size_t>(size, 1), flags, numaNode);
+        SoapySDR::freeBuffer(_mem);
+        _mem = mem;
+        _capacity = size;
+        _flags = flags;
+        _numaNode = numaNode;
+    }
+
+    _numBuffs = numBuffs;
+    _numChans = numChans;
+    _numElems = numElems;
+    _buffs.resize(numBuffs*numChans);
+    for (size_t i = 0; i < _buffs.size(); i++) _buffs[i] = reinterpret_cast<char *>(_mem) + i*stride;
+}
+
+size_t SoapySDR::BufferPool::numBuffs(void) const
+{
+    return _numBuffs;
+}
+
+size_t SoapySDR::BufferPool::numChans(void) const
+{
+    return _numChans;
+}
+
+size_t SoapySDR::BufferPool::numElems(void) const
+{
+    return _numElems;
+}
+
+void * const *SoapySDR::BufferPool::buffs(const size_t index) const
+{
+    if (index >= _numBuffs) throw std::out_of_range("BufferPool::buffs() index out of range");
+    return _buffs.data() + index*_numChans;
+}
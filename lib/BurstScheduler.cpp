@@ -0,0 +1,358 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/BurstScheduler.hpp>
+#include <SoapySDR/Device.hpp>
+#include <SoapySDR/Buffers.hpp>
+#include <SoapySDR/ThreadHints.hpp>
+#include <SoapySDR/Errors.hpp>
+#include <SoapySDR/Logger.hpp>
+#include <SoapySDR/Time.hpp>
+#include <condition_variable>
+#include <algorithm>
+#include <cstring>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+/***********************************************************************
+ * A queued burst and a status report
+ **********************************************************************/
+struct ScheduledBurst
+{
+    ScheduledBurst(void):
+        numElems(0),
+        timeNs(0)
+    {
+        return;
+    }
+
+    std::vector<std::vector<char>> data;
+    size_t numElems;
+    long long timeNs;
+};
+
+struct SchedulerStatus
+{
+    int ret;
+    size_t chanMask;
+    int flags;
+    long long timeNs;
+};
+
+struct SoapySDR::BurstScheduler::Impl
+{
+    Impl(void):
+        device(nullptr),
+        stream(nullptr),
+        numChans(0),
+        elemSize(0),
+        mtu(0),
+        leadNs(0),
+        maxGapNs(0),
+        maxQueue(0),
+        busy(false),
+        running(false),
+        bursts(0),
+        late(0),
+        writes(0)
+    {
+        return;
+    }
+
+    void work(void);
+    void writeGroup(const std::vector<ScheduledBurst> &group);
+    bool writeStaged(const size_t numElems, const bool first, const bool last, const long long timeNs);
+    void report(const int ret, const int flags, const long long timeNs);
+
+    SoapySDR::Device *device;
+    SoapySDR::Stream *stream;
+    size_t numChans;
+    size_t elemSize;
+    size_t mtu;
+    SoapySDR::TickConverter ticks;
+    long long leadNs;
+    long long maxGapNs;
+    size_t maxQueue;
+    SoapySDR::ThreadHints hints;
+    SoapySDR::BufferPool staging;
+
+    //the queue, recycled bursts, and reports under the mutex
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::deque<ScheduledBurst> queue;
+    std::vector<ScheduledBurst> spare;
+    std::deque<SchedulerStatus> status;
+    bool busy;
+
+    std::atomic<bool> running;
+    std::thread thread;
+    std::atomic<unsigned long long> bursts;
+    std::atomic<unsigned long long> late;
+    std::atomic<unsigned long long> writes;
+};
+
+void SoapySDR::BurstScheduler::Impl::report(const int ret, const int flags, const long long timeNs)
+{
+    SchedulerStatus s;
+    s.ret = ret;
+    s.chanMask = (numChans >= sizeof(size_t)*8)?~size_t(0):((size_t(1) << numChans) - 1);
+    s.flags = flags;
+    s.timeNs = timeNs;
+    std::lock_guard<std::mutex> lock(mutex);
+    status.push_back(s);
+    cond.notify_all();
+}
+
+void SoapySDR::BurstScheduler::Impl::work(void)
+{
+    hints.applyToThisThread();
+    std::vector<ScheduledBurst> group;
+    while (running)
+    {
+        long long due(0);
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cond.wait_for(lock, std::chrono::milliseconds(100), [this]{return not queue.empty() or not running;});
+            if (queue.empty()) continue;
+            due = queue.front().timeNs;
+        }
+
+        //drop a burst whose time has passed, wait for the lead time of the next one
+        const long long now = device->getHardwareTime();
+        if (due <= now)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                spare.push_back(std::move(queue.front()));
+                queue.pop_front();
+            }
+            late++;
+            this->report(SOAPY_SDR_TIME_ERROR, SOAPY_SDR_HAS_TIME, due);
+            continue;
+        }
+        if (due - leadNs > now)
+        {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(std::min<long long>(due - leadNs - now, 10000000)));
+            continue;
+        }
+
+        //take the burst with the bursts that follow it closely enough to coalesce
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            group.push_back(std::move(queue.front()));
+            queue.pop_front();
+            const long long halfTick = ticks.ticksToTimeNs(1)/2;
+            while (not queue.empty())
+            {
+                const auto &prev = group.back();
+                const long long gapNs = queue.front().timeNs - (prev.timeNs + ticks.ticksToTimeNs((long long)(prev.numElems)));
+                if (gapNs < -halfTick or gapNs > maxGapNs + halfTick) break;
+                group.push_back(std::move(queue.front()));
+                queue.pop_front();
+            }
+            busy = true;
+        }
+        cond.notify_all();
+
+        this->writeGroup(group);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            bursts += group.size();
+            for (auto &burst : group) spare.push_back(std::move(burst));
+            busy = false;
+        }
+        group.clear();
+        cond.notify_all();
+    }
+}
+
+void SoapySDR::BurstScheduler::Impl::writeGroup(const std::vector<ScheduledBurst> &group)
+{
+    void * const *stage = staging.buffs();
+    const long long startTick = ticks.timeNsToTicks(group.front().timeNs);
+    long long cursor = startTick;
+    size_t fill(0);
+    bool first(true);
+
+    //stage zeros for the gaps and the burst samples, writing whenever the MTU is full
+    for (const auto &burst : group)
+    {
+        size_t gap = size_t(std::max<long long>(0, ticks.timeNsToTicks(burst.timeNs) - cursor));
+        cursor += (long long)(gap + burst.numElems);
+        size_t offset(0);
+        while (gap != 0 or offset != burst.numElems)
+        {
+            const size_t n = std::min(mtu - fill, (gap != 0)?gap:(burst.numElems - offset));
+            for (size_t i = 0; i < numChans; i++)
+            {
+                char *out = reinterpret_cast<char *>(stage[i]) + fill*elemSize;
+                if (gap != 0) std::memset(out, 0, n*elemSize);
+                else std::memcpy(out, burst.data[i].data() + offset*elemSize, n*elemSize);
+            }
+            if (gap != 0) gap -= n;
+            else offset += n;
+            fill += n;
+            if (fill != mtu) continue;
+            const bool last = (&burst == &group.back() and gap == 0 and offset == burst.numElems);
+            if (not this->writeStaged(fill, first, last, group.front().timeNs)) return;
+            first = false;
+            fill = 0;
+        }
+    }
+    if (fill != 0) this->writeStaged(fill, first, true, group.front().timeNs);
+}
+
+bool SoapySDR::BurstScheduler::Impl::writeStaged(const size_t numElems, const bool first, const bool last, const long long timeNs)
+{
+    void * const *stage = staging.buffs();
+    std::vector<const void *> buffs(numChans);
+    size_t offset(0);
+    bool timed(first);
+    while (offset != numElems)
+    {
+        for (size_t i = 0; i < numChans; i++) buffs[i] = reinterpret_cast<const char *>(stage[i]) + offset*elemSize;
+        int flags = (timed?SOAPY_SDR_HAS_TIME:0) | (last?SOAPY_SDR_END_BURST:0);
+        const int ret = device->writeStream(stream, buffs.data(), numElems - offset, flags, timeNs, 100000);
+        writes++;
+        if (ret == SOAPY_SDR_TIMEOUT and running) continue;
+        if (ret < 0)
+        {
+            SoapySDR::logf(SOAPY_SDR_ERROR, "BurstScheduler: writeStream() failed: %s", SoapySDR::errToStr(ret));
+            this->report(ret, 0, timeNs);
+            return false;
+        }
+        offset += size_t(ret);
+        timed = false;
+    }
+    return true;
+}
+
+/***********************************************************************
+ * BurstScheduler
+ **********************************************************************/
+SoapySDR::BurstScheduler::BurstScheduler(Device *device, Stream *stream, const size_t numChans, const size_t elemSize, const double rate, const Kwargs &args):
+    _impl(new Impl())
+{
+    try
+    {
+        _impl->device = device;
+        _impl->stream = stream;
+        _impl->numChans = numChans;
+        _impl->elemSize = elemSize;
+        _impl->mtu = std::max<size_t>(1, device->getStreamMTU(stream));
+        _impl->ticks = SoapySDR::TickConverter(rate);
+        _impl->leadNs = (args.count("lead_us") != 0)?std::stoll(args.at("lead_us"))*1000:10000000;
+        _impl->maxGapNs = (args.count("max_gap_us") != 0)?std::stoll(args.at("max_gap_us"))*1000:0;
+        _impl->maxQueue = std::max<size_t>(1, (args.count("queue") != 0)?std::stoul(args.at("queue")):64);
+        _impl->hints = SoapySDR::ThreadHints(args);
+        _impl->staging.resize(numChans, _impl->mtu, elemSize, 1, 0, _impl->hints.numaNode);
+    }
+    catch (...)
+    {
+        delete _impl;
+        throw;
+    }
+    _impl->running = true;
+    _impl->thread = std::thread(&Impl::work, _impl);
+}
+
+SoapySDR::BurstScheduler::~BurstScheduler(void)
+{
+    _impl->running = false;
+    _impl->cond.notify_all();
+    _impl->thread.join();
+    delete _impl;
+}
+
+int SoapySDR::BurstScheduler::submit(const void * const *buffs, const size_t numElems, const long long timeNs, const long timeoutUs)
+{
+    std::unique_lock<std::mutex> lock(_impl->mutex);
+    if (not _impl->cond.wait_for(lock, std::chrono::microseconds(timeoutUs), [this]{return _impl->queue.size() < _impl->maxQueue;}))
+    {
+        return SOAPY_SDR_TIMEOUT;
+    }
+
+    //reuse the memory of a burst that was already written
+    ScheduledBurst burst;
+    if (not _impl->spare.empty())
+    {
+        burst = std::move(_impl->spare.back());
+        _impl->spare.pop_back();
+    }
+    burst.data.resize(_impl->numChans);
+    for (size_t i = 0; i < _impl->numChans; i++)
+    {
+        burst.data[i].resize(numElems*_impl->elemSize);
+        std::memcpy(burst.data[i].data(), buffs[i], numElems*_impl->elemSize);
+    }
+    burst.numElems = numElems;
+    burst.timeNs = timeNs;
+    _impl->queue.push_back(std::move(burst));
+    _impl->cond.notify_all();
+    return 0;
+}
+
+bool SoapySDR::BurstScheduler::flush(const long timeoutUs)
+{
+    std::unique_lock<std::mutex> lock(_impl->mutex);
+    return _impl->cond.wait_for(lock, std::chrono::microseconds(timeoutUs), [this]{return _impl->queue.empty() and not _impl->busy;});
+}
+
+int SoapySDR::BurstScheduler::readStreamStatus(size_t &chanMask, int &flags, long long &timeNs, const long timeoutUs)
+{
+    const auto exit = std::chrono::steady_clock::now() + std::chrono::microseconds(timeoutUs);
+    while (true)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_impl->mutex);
+            if (not _impl->status.empty())
+            {
+                const auto s = _impl->status.front();
+                _impl->status.pop_front();
+                chanMask = s.chanMask;
+                flags = s.flags;
+                timeNs = s.timeNs;
+                return s.ret;
+            }
+        }
+
+        //wait on the device in slices so that late reports are not held up
+        const auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(exit - std::chrono::steady_clock::now()).count();
+        const long slice = long(std::max<long long>(0, std::min<long long>(remaining, 10000)));
+        const int ret = _impl->device->readStreamStatus(_impl->stream, chanMask, flags, timeNs, slice);
+        if (ret != SOAPY_SDR_TIMEOUT and ret != SOAPY_SDR_NOT_SUPPORTED) return ret;
+        if (ret == SOAPY_SDR_NOT_SUPPORTED)
+        {
+            std::unique_lock<std::mutex> lock(_impl->mutex);
+            _impl->cond.wait_for(lock, std::chrono::microseconds(slice), [this]{return not _impl->status.empty();});
+        }
+        if (std::chrono::steady_clock::now() < exit) continue;
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        if (_impl->status.empty()) return SOAPY_SDR_TIMEOUT;
+    }
+}
+
+size_t SoapySDR::BurstScheduler::numQueued(void) const
+{
+    std::lock_guard<std::mutex> lock(_impl->mutex);
+    return _impl->queue.size();
+}
+
+unsigned long long SoapySDR::BurstScheduler::numBursts(void) const
+{
+    return _impl->bursts;
+}
+
+unsigned long long SoapySDR::BurstScheduler::numLate(void) const
+{
+    return _impl->late;
+}
+
+unsigned long long SoapySDR::BurstScheduler::numWrites(void) const
+{
+    return _impl->writes;
+}
@@ -0,0 +1,192 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/ConverterPool.hpp>
+#include <SoapySDR/Tracer.hpp>
+#include <condition_variable>
+#include <algorithm>
+#include <stdexcept>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <vector>
+
+//channels are not split into chunks smaller than this many elements
+static const size_t MIN_CHUNK_ELEMS = 4096;
+
+struct ConversionTask
+{
+    SoapySDR::ConverterRegistry::ConverterFunction function;
+    const void *src;
+    void *dst;
+    size_t numElems;
+    double scaler;
+};
+
+struct SoapySDR::ConverterPool::Impl
+{
+    size_t numThreads;
+    std::vector<std::thread> workers;
+
+    //serializes calls to convert()
+    std::mutex callMutex;
+
+    //protects the job state below
+    std::mutex mutex;
+    std::condition_variable workCond;
+    std::condition_variable doneCond;
+    bool shutdown;
+    size_t generation;
+    size_t active;
+    size_t pending;
+    std::vector<ConversionTask> tasks;
+    std::atomic<size_t> nextTask;
+
+    Impl(void):
+        numThreads(1),
+        shutdown(false),
+        generation(0),
+        active(0),
+        pending(0),
+        nextTask(0)
+    {
+        return;
+    }
+
+    //run tasks until there are none left, return the number completed
+    size_t runTasks(void)
+    {
+        size_t completed(0);
+        while (true)
+        {
+            const size_t index = nextTask.fetch_add(1);
+            if (index >= tasks.size()) return completed;
+            const auto &task = tasks[index];
+            task.function(task.src, task.dst, task.numElems, task.scaler);
+            completed++;
+        }
+    }
+
+    void finishTasks(const size_t completed)
+    {
+        if (completed == 0) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        pending -= completed;
+        if (pending == 0) doneCond.notify_all();
+    }
+
+    void workerLoop(void)
+    {
+        size_t lastGeneration(0);
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            workCond.wait(lock, [&]{return shutdown or generation != lastGeneration;});
+            if (shutdown) return;
+            lastGeneration = generation;
+            active++;
+            lock.unlock();
+
+            const size_t completed = runTasks();
+
+            lock.lock();
+            active--;
+            pending -= completed;
+            if (pending == 0 and active == 0) doneCond.notify_all();
+        }
+    }
+};
+
+SoapySDR::ConverterPool::ConverterPool(const size_t numThreads):
+    _impl(new Impl())
+{
+    _impl->numThreads = numThreads;
+    if (_impl->numThreads == 0) _impl->numThreads = std::thread::hardware_concurrency();
+    if (_impl->numThreads == 0) _impl->numThreads = 1;
+
+    //the calling thread is one of the conversion threads
+    for (size_t i = 1; i < _impl->numThreads; i++)
+    {
+        _impl->workers.emplace_back(&Impl::workerLoop, _impl);
+    }
+}
+
+SoapySDR::ConverterPool::~ConverterPool(void)
+{
+    {
+        std::lock_guard<std::mutex> lock(_impl->mutex);
+        _impl->shutdown = true;
+    }
+    _impl->workCond.notify_all();
+    for (auto &worker : _impl->workers) worker.join();
+    delete _impl;
+}
+
+size_t SoapySDR::ConverterPool::getNumThreads(void) const
+{
+    return _impl->numThreads;
+}
+
+void SoapySDR::ConverterPool::convert(
+    const ConverterRegistry::Converter &converter,
+    const void * const *srcBuffs,
+    void * const *dstBuffs,
+    const size_t numChans,
+    const size_t numElems,
+    const double scaler)
+{
+    if (not converter) throw std::invalid_argument("ConverterPool::convert() unresolved converter");
+    TraceScope trace("ConverterPool::convert", "converter");
+    if (numChans == 0 or numElems == 0) return;
+
+    std::lock_guard<std::mutex> callLock(_impl->callMutex);
+
+    //one task per channel, or split channels into chunks to fill the threads
+    size_t chunksPerChan(1);
+    if (numChans < _impl->numThreads)
+    {
+        chunksPerChan = (_impl->numThreads + numChans - 1)/numChans;
+        chunksPerChan = std::min(chunksPerChan, std::max<size_t>(1, numElems/MIN_CHUNK_ELEMS));
+    }
+    const size_t chunkElems = (numElems + chunksPerChan - 1)/chunksPerChan;
+
+    //small jobs are converted directly on the calling thread
+    if (numChans*chunksPerChan == 1 or _impl->workers.empty())
+    {
+        for (size_t ch = 0; ch < numChans; ch++)
+        {
+            converter.function(srcBuffs[ch], dstBuffs[ch], numElems, scaler);
+        }
+        return;
+    }
+
+    {
+        //a late worker may still be leaving the previous task list
+        std::unique_lock<std::mutex> lock(_impl->mutex);
+        _impl->doneCond.wait(lock, [this]{return _impl->active == 0;});
+        _impl->tasks.clear();
+        for (size_t ch = 0; ch < numChans; ch++)
+        {
+            for (size_t offset = 0; offset < numElems; offset += chunkElems)
+            {
+                ConversionTask task;
+                task.function = converter.function;
+                task.src = reinterpret_cast<const char *>(srcBuffs[ch]) + offset*converter.sourceElemSize;
+                task.dst = reinterpret_cast<char *>(dstBuffs[ch]) + offset*converter.targetElemSize;
+                task.numElems = std::min(chunkElems, numElems - offset);
+                task.scaler = scaler;
+                _impl->tasks.push_back(task);
+            }
+        }
+        _impl->pending = _impl->tasks.size();
+        _impl->nextTask = 0;
+        _impl->generation++;
+    }
+    _impl->workCond.notify_all();
+
+    _impl->finishTasks(_impl->runTasks());
+
+    //wait for the workers to finish and leave the task list
+    std::unique_lock<std::mutex> lock(_impl->mutex);
+    _impl->doneCond.wait(lock, [this]{return _impl->pending == 0 and _impl->active == 0;});
+}
@@ -3,40 +3,505 @@
 // SPDX-License-Identifier: BSL-1.0
 
 #include <SoapySDR/ConverterRegistry.hpp>
+#include <SoapySDR/Modules.hpp>
 #include <algorithm>
 #include <stdexcept>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <limits>
 
 void lateLoadDefaultConverters(void);
+std::string getEnvImpl(const char *name);
 
-static SoapySDR::ConverterRegistry::FormatConverters formatConverters;
+/***********************************************************************
+ * The registry state is an immutable snapshot published by pointer:
+ * Registration copies the current snapshot under the writer mutex,
+ * modifies the copy, and atomically swaps it in. Lookups pin the
+ * current snapshot with a SnapshotReader and read it without locks.
+ * A replaced snapshot is retired, and the writer frees the retired
+ * snapshots once it observes that no lookup is in progress.
+ *
+ * Format identifiers live in a separate append-only table, so that
+ * interning a format string never copies the registry. Each snapshot
+ * keeps the identifiers of its registered formats for the lock-free
+ * path of getFormatId().
+ **********************************************************************/
+template <typename Function>
+using FunctionTable = std::map<std::string, std::map<std::string, std::map<SoapySDR::ConverterRegistry::FunctionPriority, Function>>>;
 
-SoapySDR::ConverterRegistry::ConverterRegistry(const std::string &sourceFormat, const std::string &targetFormat, const FunctionPriority &priority, ConverterFunction converterFunction)
+struct RegistrySnapshot
 {
-  if (formatConverters.count(sourceFormat) == 0)
+  SoapySDR::ConverterRegistry::FormatConverters formatConverters;
+
+  //identifiers of the registered formats from the format table
+  std::map<std::string, SoapySDR::ConverterRegistry::FormatId> formatIds;
+
+  //the highest priority function for each (source, target) identifier pair
+  std::vector<std::vector<SoapySDR::ConverterRegistry::ConverterFunction>> bestFunctions;
+
+  //priority selected by calibration for each (source, target) pair
+  std::map<std::string, std::map<std::string, SoapySDR::ConverterRegistry::FunctionPriority>> calibratedPriorities;
+
+  //true when bestFunctions holds the calibrated function for the identifier pair
+  std::vector<std::vector<bool>> calibrated;
+
+  //in-place capability of each registered function keyed like formatConverters
+  FunctionTable<bool> inPlaceSupport;
+
+  //fused multi-channel converters keyed like formatConverters
+  FunctionTable<SoapySDR::ConverterRegistry::DeinterleaveFunction> deinterleavers;
+  FunctionTable<SoapySDR::ConverterRegistry::InterleaveFunction> interleavers;
+};
+
+static std::atomic<const RegistrySnapshot *> currentSnapshot(nullptr);
+
+//the number of lookups that may hold a snapshot
+static std::atomic<size_t> activeReaders(0);
+
+static std::mutex &getRegistryMutex(void)
+{
+  static std::mutex mutex;
+  return mutex;
+}
+
+static const RegistrySnapshot &getEmptySnapshot(void)
+{
+  static const RegistrySnapshot emptySnapshot;
+  return emptySnapshot;
+}
+
+//pin the current snapshot for the lifetime of a lookup
+class SnapshotReader
+{
+public:
+  SnapshotReader(void)
+  {
+    //count the reader before the load, see publishSnapshot()
+    activeReaders++;
+    const auto snapshot = currentSnapshot.load();
+    _snapshot = (snapshot == nullptr)?&getEmptySnapshot():snapshot;
+  }
+
+  ~SnapshotReader(void)
+  {
+    activeReaders--;
+  }
+
+  const RegistrySnapshot &operator*(void) const
+  {
+    return *_snapshot;
+  }
+
+  const RegistrySnapshot *operator->(void) const
+  {
+    return _snapshot;
+  }
+
+private:
+  SnapshotReader(const SnapshotReader &);
+  SnapshotReader &operator=(const SnapshotReader &);
+  const RegistrySnapshot *_snapshot;
+};
+
+//call with the registry mutex held, only writers free snapshots
+static const RegistrySnapshot &getCurrentSnapshot(void)
+{
+  const auto snapshot = currentSnapshot.load();
+  return (snapshot == nullptr)?getEmptySnapshot():*snapshot;
+}
+
+//call with the registry mutex held
+static void publishSnapshot(RegistrySnapshot *snapshot)
+{
+  static std::vector<std::unique_ptr<const RegistrySnapshot>> retired;
+  const auto previous = currentSnapshot.exchange(snapshot);
+  if (previous != nullptr) retired.emplace_back(previous);
+
+  //a reader that loaded a retired snapshot was counted before the exchange,
+  //and a reader counted after this check can only load the new snapshot
+  if (activeReaders == 0) retired.clear();
+}
+
+/***********************************************************************
+ * Append-only format identifier table
+ **********************************************************************/
+struct FormatTable
+{
+  std::mutex mutex;
+  std::map<std::string, SoapySDR::ConverterRegistry::FormatId> formatIds;
+  std::vector<std::string> formatNames;
+};
+
+static FormatTable &getFormatTable(void)
+{
+  static FormatTable table;
+  return table;
+}
+
+static SoapySDR::ConverterRegistry::FormatId internFormatId(const std::string &format)
+{
+  auto &table = getFormatTable();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  const auto it = table.formatIds.find(format);
+  if (it != table.formatIds.end()) return it->second;
+
+  const SoapySDR::ConverterRegistry::FormatId formatId = table.formatNames.size();
+  table.formatNames.push_back(format);
+  table.formatIds[format] = formatId;
+  return formatId;
+}
+
+//call with the registry mutex held
+static SoapySDR::ConverterRegistry::FormatId internFormat(RegistrySnapshot &snapshot, const std::string &format)
+{
+  const auto it = snapshot.formatIds.find(format);
+  if (it != snapshot.formatIds.end()) return it->second;
+
+  const auto formatId = internFormatId(format);
+  snapshot.formatIds[format] = formatId;
+
+  //the tables cover every identifier up to the newest, other pairs stay empty
+  const size_t numFormats = std::max(snapshot.bestFunctions.size(), formatId+1);
+  snapshot.bestFunctions.resize(numFormats);
+  for (auto &row : snapshot.bestFunctions) row.resize(numFormats, nullptr);
+  snapshot.calibrated.resize(numFormats);
+  for (auto &row : snapshot.calibrated) row.resize(numFormats, false);
+  return formatId;
+}
+
+SoapySDR::ConverterRegistry::Converter::Converter(void):
+  function(nullptr),
+  priority(GENERIC),
+  sourceElemSize(0),
+  targetElemSize(0),
+  inPlace(false)
+{
+  return;
+}
+
+SoapySDR::ConverterRegistry::ConverterRegistry(const std::string &sourceFormat, const std::string &targetFormat, const FunctionPriority &priority, ConverterFunction converterFunction):
+  ConverterRegistry(sourceFormat, targetFormat, priority, converterFunction, false)
+{
+  return;
+}
+
+SoapySDR::ConverterRegistry::ConverterRegistry(const std::string &sourceFormat, const std::string &targetFormat, const FunctionPriority &priority, ConverterFunction converterFunction, const bool inPlace)
+{
+  std::lock_guard<std::mutex> lock(getRegistryMutex());
+
+  const auto &current = getCurrentSnapshot();
+  const auto sourceIt = current.formatConverters.find(sourceFormat);
+  if (sourceIt == current.formatConverters.end())
     ;
-  else if (formatConverters[sourceFormat].count(targetFormat) == 0)
+  else if (sourceIt->second.count(targetFormat) == 0)
     ;
-  else if (formatConverters[sourceFormat][targetFormat].count(priority) != 0)
+  else if (sourceIt->second.at(targetFormat).count(priority) != 0)
     {
       SoapySDR::logf(SOAPY_SDR_ERROR, "SoapySDR::ConverterRegistry(%s, %s, %s) duplicate registration", sourceFormat.c_str(), targetFormat.c_str(), std::to_string(priority).c_str());
       return;
     }
-  
-  formatConverters[sourceFormat][targetFormat][priority] = converterFunction;
+
+  std::unique_ptr<RegistrySnapshot> snapshot(new RegistrySnapshot(current));
+  auto &priorities = snapshot->formatConverters[sourceFormat][targetFormat];
+  priorities[priority] = converterFunction;
+  snapshot->inPlaceSupport[sourceFormat][targetFormat][priority] = inPlace;
+
+  const auto sourceId = internFormat(*snapshot, sourceFormat);
+  const auto targetId = internFormat(*snapshot, targetFormat);
+  snapshot->bestFunctions[sourceId][targetId] = priorities.rbegin()->second;
+
+  //a new priority invalidates the calibration for this pair
+  auto &calibratedTargets = snapshot->calibratedPriorities[sourceFormat];
+  calibratedTargets.erase(targetFormat);
+  snapshot->calibrated[sourceId][targetId] = false;
+
+  publishSnapshot(snapshot.release());
 
   return;
 }
 
+/***********************************************************************
+ * Runtime calibration of the fastest priority
+ **********************************************************************/
+enum CalibrationMode
+{
+  CALIBRATION_DISABLED,
+  CALIBRATION_ENABLED,
+  CALIBRATION_PERSIST,
+};
+
+static int calibrationModeFromEnv(void)
+{
+  const std::string mode = getEnvImpl("SOAPY_SDR_CONVERTER_CALIBRATION");
+  if (mode.empty() or mode == "0" or mode == "off" or mode == "false") return CALIBRATION_DISABLED;
+  if (mode == "persist") return CALIBRATION_PERSIST;
+  return CALIBRATION_ENABLED;
+}
+
+static std::atomic<int> &getCalibrationMode(void)
+{
+  static std::atomic<int> mode(calibrationModeFromEnv());
+  return mode;
+}
+
+static std::string getCalibrationFile(void)
+{
+  const std::string path = getEnvImpl("SOAPY_SDR_CONVERTER_CALIBRATION_FILE");
+  if (not path.empty()) return path;
+  return SoapySDR::getRootPath() + "/share/SoapySDR/ConverterCalibration.txt";
+}
+
+//calibration results from the file for this and previous processes
+typedef std::map<std::pair<std::string, std::string>, int> PersistedCalibration;
+
+static std::mutex &getCalibrationMutex(void)
+{
+  static std::mutex mutex;
+  return mutex;
+}
+
+//call with the calibration mutex held
+static PersistedCalibration &getPersistedCalibration(void)
+{
+  static bool loaded(false);
+  static PersistedCalibration persisted;
+  if (loaded) return persisted;
+  loaded = true;
+
+  std::ifstream file(getCalibrationFile());
+  std::string line;
+  while (std::getline(file, line))
+    {
+      if (line.empty() or line[0] == '#') continue;
+      std::istringstream ss(line);
+      std::string source, target;
+      int priority(0);
+      if (ss >> source >> target >> priority) persisted[std::make_pair(source, target)] = priority;
+    }
+  return persisted;
+}
+
+//call with the calibration mutex held
+static void savePersistedCalibration(const PersistedCalibration &persisted)
+{
+  const auto path = getCalibrationFile();
+  std::ofstream file(path);
+  file << "# SoapySDR converter calibration: source target priority" << std::endl;
+  for (const auto &entry : persisted)
+    {
+      file << entry.first.first << " " << entry.first.second << " " << entry.second << std::endl;
+    }
+  if (not file) SoapySDR::logf(SOAPY_SDR_WARNING, "ConverterRegistry calibration could not write %s", path.c_str());
+}
+
+static SoapySDR::ConverterRegistry::FunctionPriority timeFastestPriority(const std::string &sourceFormat, const std::string &targetFormat, const SoapySDR::ConverterRegistry::TargetFormatConverterPriority &priorities)
+{
+  const size_t numElems = 8192;
+  const size_t numTrials = 8;
+  std::vector<char> srcBuff(numElems*SoapySDR::formatToSize(sourceFormat));
+  std::vector<char> dstBuff(numElems*SoapySDR::formatToSize(targetFormat));
+
+  //iterate from the highest priority so that ties keep the higher priority
+  auto fastest = priorities.rbegin()->first;
+  double fastestTime(std::numeric_limits<double>::max());
+  for (auto it = priorities.rbegin(); it != priorities.rend(); ++it)
+    {
+      it->second(srcBuff.data(), dstBuff.data(), numElems, 1.0);
+      double bestTrial(std::numeric_limits<double>::max());
+      for (size_t i = 0; i < numTrials; i++)
+        {
+          const auto t0 = std::chrono::steady_clock::now();
+          it->second(srcBuff.data(), dstBuff.data(), numElems, 1.0);
+          const auto t1 = std::chrono::steady_clock::now();
+          bestTrial = std::min(bestTrial, std::chrono::duration<double>(t1-t0).count());
+        }
+      if (bestTrial < fastestTime)
+        {
+          fastestTime = bestTrial;
+          fastest = it->first;
+        }
+    }
+
+  SoapySDR::logf(SOAPY_SDR_DEBUG, "ConverterRegistry calibration %s -> %s selected priority %d", sourceFormat.c_str(), targetFormat.c_str(), int(fastest));
+  return fastest;
+}
+
+//restore the highest priority functions, call with the registry mutex held
+static void resetCalibration(RegistrySnapshot &snapshot)
+{
+  for (const auto &source : snapshot.calibratedPriorities)
+    {
+      for (const auto &target : source.second)
+        {
+          const auto sourceId = snapshot.formatIds.at(source.first);
+          const auto targetId = snapshot.formatIds.at(target.first);
+          const auto &priorities = snapshot.formatConverters.at(source.first).at(target.first);
+          snapshot.bestFunctions[sourceId][targetId] = priorities.rbegin()->second;
+        }
+    }
+  snapshot.calibratedPriorities.clear();
+  for (auto &row : snapshot.calibrated) std::fill(row.begin(), row.end(), false);
+}
+
+static SoapySDR::ConverterRegistry::ConverterFunction getCalibratedFunction(const std::string &sourceFormat, const std::string &targetFormat, const SoapySDR::ConverterRegistry::TargetFormatConverterPriority &priorities)
+{
+  //already calibrated by this process
+  {
+    SnapshotReader snapshot;
+    const auto sourceIt = snapshot->calibratedPriorities.find(sourceFormat);
+    if (sourceIt != snapshot->calibratedPriorities.end())
+      {
+        const auto targetIt = sourceIt->second.find(targetFormat);
+        if (targetIt != sourceIt->second.end() and priorities.count(targetIt->second) != 0)
+          return priorities.at(targetIt->second);
+      }
+  }
+
+  auto priority = priorities.rbegin()->first;
+  if (priorities.size() > 1)
+    {
+      std::lock_guard<std::mutex> lock(getCalibrationMutex());
+      const bool persist = (getCalibrationMode() == CALIBRATION_PERSIST);
+      const auto key = std::make_pair(sourceFormat, targetFormat);
+      PersistedCalibration unused;
+      auto &persisted = persist?getPersistedCalibration():unused;
+      const auto persistedIt = persisted.find(key);
+      if (persistedIt != persisted.end() and priorities.count(SoapySDR::ConverterRegistry::FunctionPriority(persistedIt->second)) != 0)
+        {
+          priority = SoapySDR::ConverterRegistry::FunctionPriority(persistedIt->second);
+        }
+      else
+        {
+          priority = timeFastestPriority(sourceFormat, targetFormat, priorities);
+          persisted[key] = priority;
+          if (persist) savePersistedCalibration(persisted);
+        }
+    }
+  const auto function = priorities.at(priority);
+
+  //publish the selection so the format ID lookup uses it directly
+  std::lock_guard<std::mutex> lock(getRegistryMutex());
+  std::unique_ptr<RegistrySnapshot> snapshot(new RegistrySnapshot(getCurrentSnapshot()));
+  snapshot->calibratedPriorities[sourceFormat][targetFormat] = priority;
+  const auto sourceId = internFormat(*snapshot, sourceFormat);
+  const auto targetId = internFormat(*snapshot, targetFormat);
+  snapshot->bestFunctions[sourceId][targetId] = function;
+  snapshot->calibrated[sourceId][targetId] = true;
+  publishSnapshot(snapshot.release());
+  return function;
+}
+
+void SoapySDR::ConverterRegistry::setCalibrationMode(const bool enable, const bool persist)
+{
+  getCalibrationMode() = enable?(persist?CALIBRATION_PERSIST:CALIBRATION_ENABLED):CALIBRATION_DISABLED;
+  if (enable) return;
+
+  std::lock_guard<std::mutex> lock(getRegistryMutex());
+  std::unique_ptr<RegistrySnapshot> snapshot(new RegistrySnapshot(getCurrentSnapshot()));
+  resetCalibration(*snapshot);
+  publishSnapshot(snapshot.release());
+}
+
+/***********************************************************************
+ * Fused multi-channel converters
+ **********************************************************************/
+template <typename Function>
+static void registerFusedFunction(FunctionTable<Function> RegistrySnapshot::*table, const char *kind, const std::string &sourceFormat, const std::string &targetFormat, const SoapySDR::ConverterRegistry::FunctionPriority &priority, Function function)
+{
+  std::lock_guard<std::mutex> lock(getRegistryMutex());
+
+  const auto &current = getCurrentSnapshot();
+  const auto sourceIt = (current.*table).find(sourceFormat);
+  if (sourceIt == (current.*table).end())
+    ;
+  else if (sourceIt->second.count(targetFormat) == 0)
+    ;
+  else if (sourceIt->second.at(targetFormat).count(priority) != 0)
+    {
+      SoapySDR::logf(SOAPY_SDR_ERROR, "SoapySDR::ConverterRegistry(%s, %s, %s) duplicate %s registration", sourceFormat.c_str(), targetFormat.c_str(), std::to_string(priority).c_str(), kind);
+      return;
+    }
+
+  std::unique_ptr<RegistrySnapshot> snapshot(new RegistrySnapshot(current));
+  ((*snapshot).*table)[sourceFormat][targetFormat][priority] = function;
+  publishSnapshot(snapshot.release());
+}
+
+template <typename Function>
+static Function getFusedFunction(const FunctionTable<Function> &table, const char *what, const std::string &sourceFormat, const std::string &targetFormat, const SoapySDR::ConverterRegistry::FunctionPriority *priority)
+{
+  const auto sourceIt = table.find(sourceFormat);
+  if (sourceIt != table.end())
+    {
+      const auto targetIt = sourceIt->second.find(targetFormat);
+      if (targetIt != sourceIt->second.end() and not targetIt->second.empty())
+        {
+          if (priority == nullptr) return targetIt->second.rbegin()->second;
+          const auto priorityIt = targetIt->second.find(*priority);
+          if (priorityIt != targetIt->second.end()) return priorityIt->second;
+        }
+    }
+
+  throw std::runtime_error(std::string("ConverterRegistry::")+what+"() conversion not registered; "
+                           "sourceFormat="+sourceFormat+", targetFormat="+targetFormat+
+                           ((priority == nullptr)?"":", priority="+std::to_string(*priority)));
+}
+
+SoapySDR::ConverterRegistry::ConverterRegistry(const std::string &sourceFormat, const std::string &targetFormat, const FunctionPriority &priority, DeinterleaveFunction converterFunction)
+{
+  registerFusedFunction(&RegistrySnapshot::deinterleavers, "deinterleave", sourceFormat, targetFormat, priority, converterFunction);
+}
+
+SoapySDR::ConverterRegistry::ConverterRegistry(const std::string &sourceFormat, const std::string &targetFormat, const FunctionPriority &priority, InterleaveFunction converterFunction)
+{
+  registerFusedFunction(&RegistrySnapshot::interleavers, "interleave", sourceFormat, targetFormat, priority, converterFunction);
+}
+
+SoapySDR::ConverterRegistry::DeinterleaveFunction SoapySDR::ConverterRegistry::getDeinterleaveFunction(const std::string &sourceFormat, const std::string &targetFormat)
+{
+  lateLoadDefaultConverters();
+  SnapshotReader snapshot;
+  return getFusedFunction(snapshot->deinterleavers, "getDeinterleaveFunction", sourceFormat, targetFormat, nullptr);
+}
+
+SoapySDR::ConverterRegistry::DeinterleaveFunction SoapySDR::ConverterRegistry::getDeinterleaveFunction(const std::string &sourceFormat, const std::string &targetFormat, const FunctionPriority &priority)
+{
+  lateLoadDefaultConverters();
+  SnapshotReader snapshot;
+  return getFusedFunction(snapshot->deinterleavers, "getDeinterleaveFunction", sourceFormat, targetFormat, &priority);
+}
+
+SoapySDR::ConverterRegistry::InterleaveFunction SoapySDR::ConverterRegistry::getInterleaveFunction(const std::string &sourceFormat, const std::string &targetFormat)
+{
+  lateLoadDefaultConverters();
+  SnapshotReader snapshot;
+  return getFusedFunction(snapshot->interleavers, "getInterleaveFunction", sourceFormat, targetFormat, nullptr);
+}
+
+SoapySDR::ConverterRegistry::InterleaveFunction SoapySDR::ConverterRegistry::getInterleaveFunction(const std::string &sourceFormat, const std::string &targetFormat, const FunctionPriority &priority)
+{
+  lateLoadDefaultConverters();
+  SnapshotReader snapshot;
+  return getFusedFunction(snapshot->interleavers, "getInterleaveFunction", sourceFormat, targetFormat, &priority);
+}
+
 std::vector<std::string> SoapySDR::ConverterRegistry::listTargetFormats(const std::string &sourceFormat)
 {
   lateLoadDefaultConverters();
+  SnapshotReader snapshot;
+  const auto &formatConverters = snapshot->formatConverters;
 
   std::vector<std::string> targets;
 
-  if (formatConverters.count(sourceFormat) == 0)
+  const auto sourceIt = formatConverters.find(sourceFormat);
+  if (sourceIt == formatConverters.end())
     return targets;
 
-  for(const auto &it:formatConverters[sourceFormat])
+  for(const auto &it:sourceIt->second)
     {
       std::string targetFormat = it.first;
       targets.push_back(targetFormat);
@@ -49,13 +514,15 @@ std::vector<std::string> SoapySDR::ConverterRegistry::listTargetFormats(const st
 std::vector<std::string> SoapySDR::ConverterRegistry::listSourceFormats(const std::string &targetFormat)
 {
   lateLoadDefaultConverters();
+  SnapshotReader snapshot;
+  const auto &formatConverters = snapshot->formatConverters;
 
   std::vector<std::string> sources;
 
   for(const auto &it:formatConverters)
     {
       std::string sourceFormat = it.first;
-      if (formatConverters[sourceFormat].count(targetFormat) > 0)
+      if (it.second.count(targetFormat) > 0)
         sources.push_back(sourceFormat);
     }
   
@@ -66,22 +533,23 @@ std::vector<std::string> SoapySDR::ConverterRegistry::listSourceFormats(const st
 std::vector<SoapySDR::ConverterRegistry::FunctionPriority> SoapySDR::ConverterRegistry::listPriorities(const std::string &sourceFormat, const std::string &targetFormat)
 {
   lateLoadDefaultConverters();
+  SnapshotReader snapshot;
+  const auto &formatConverters = snapshot->formatConverters;
 
   std::vector<FunctionPriority> priorities;
   
-  if (formatConverters.count(sourceFormat) == 0)
-    ;
-  else if (formatConverters[sourceFormat].count(targetFormat) == 0)
-    ;
-  else if (formatConverters[sourceFormat][targetFormat].size() == 0)
-    ;
-  else
+  const auto sourceIt = formatConverters.find(sourceFormat);
+  if (sourceIt == formatConverters.end())
+    return priorities;
+
+  const auto targetIt = sourceIt->second.find(targetFormat);
+  if (targetIt == sourceIt->second.end())
+    return priorities;
+
+  for(const auto &it:targetIt->second)
     {
-      for(const auto &it:formatConverters[sourceFormat][targetFormat])
-        {
-          FunctionPriority priority = it.first;
-          priorities.push_back(priority);
-        }
+      FunctionPriority priority = it.first;
+      priorities.push_back(priority);
     }
   
   return priorities;
@@ -91,56 +559,163 @@ std::vector<SoapySDR::ConverterRegistry::FunctionPriority> SoapySDR::ConverterRe
 SoapySDR::ConverterRegistry::ConverterFunction SoapySDR::ConverterRegistry::getFunction(const std::string &sourceFormat, const std::string &targetFormat)
 {
   lateLoadDefaultConverters();
+  SnapshotReader snapshot;
+  const auto &formatConverters = snapshot->formatConverters;
 
-  if (formatConverters.count(sourceFormat) == 0)
+  const auto sourceIt = formatConverters.find(sourceFormat);
+  if (sourceIt == formatConverters.end())
     {
       throw std::runtime_error("ConverterRegistry::getFunction() conversion source not registered; "
                                "sourceFormat="+sourceFormat+", targetFormat="+targetFormat);
     }
   
-  if (formatConverters[sourceFormat].count(targetFormat) == 0)
+  const auto targetIt = sourceIt->second.find(targetFormat);
+  if (targetIt == sourceIt->second.end())
     {
       throw std::runtime_error("ConverterRegistry::getFunction() conversion target not registered; "
                                "sourceFormat="+sourceFormat+", targetFormat="+targetFormat);
     }
 
-  if (formatConverters[sourceFormat][targetFormat].size() == 0)
+  if (targetIt->second.empty())
     {
       throw std::runtime_error("ConverterRegistry::getFunction() no functions found for registered conversion; "
                                "sourceFormat="+sourceFormat+", targetFormat="+targetFormat);
     }
 
-  return formatConverters[sourceFormat][targetFormat].rbegin()->second;
+  if (getCalibrationMode() != CALIBRATION_DISABLED)
+    return getCalibratedFunction(sourceFormat, targetFormat, targetIt->second);
+
+  return targetIt->second.rbegin()->second;
 }
 
 SoapySDR::ConverterRegistry::ConverterFunction SoapySDR::ConverterRegistry::getFunction(const std::string &sourceFormat, const std::string &targetFormat, const FunctionPriority &priority)
 {
   lateLoadDefaultConverters();
+  SnapshotReader snapshot;
+  const auto &formatConverters = snapshot->formatConverters;
 
-  if (formatConverters.count(sourceFormat) == 0)
+  const auto sourceIt = formatConverters.find(sourceFormat);
+  if (sourceIt == formatConverters.end())
     {
       throw std::runtime_error("ConverterRegistry::getFunction() conversion source not registered; "
                                "sourceFormat="+sourceFormat+", targetFormat="+targetFormat+", priority="+std::to_string(priority));
     }
 
-  if (formatConverters[sourceFormat].count(targetFormat) == 0)
+  const auto targetIt = sourceIt->second.find(targetFormat);
+  if (targetIt == sourceIt->second.end())
     {
       throw std::runtime_error("ConverterRegistry::getFunction() conversion target not registered; "
                                "sourceFormat="+sourceFormat+", targetFormat="+targetFormat+", priority="+std::to_string(priority));
     }
 
-  if (formatConverters[sourceFormat][targetFormat].count(priority) == 0)
+  const auto priorityIt = targetIt->second.find(priority);
+  if (priorityIt == targetIt->second.end())
     {
       throw std::runtime_error("ConverterRegistry::getFunction() conversion priority not registered; "
                                "sourceFormat="+sourceFormat+", targetFormat="+targetFormat+", priority="+std::to_string(priority));
     }
 
-  return formatConverters[sourceFormat][targetFormat][priority];
+  return priorityIt->second;
+}
+
+SoapySDR::ConverterRegistry::ConverterFunction SoapySDR::ConverterRegistry::getFunction(const FormatId sourceFormat, const FormatId targetFormat)
+{
+  lateLoadDefaultConverters();
+  SnapshotReader snapshot;
+  const auto &bestFunctions = snapshot->bestFunctions;
+
+  if (sourceFormat < bestFunctions.size() and targetFormat < bestFunctions.size())
+    {
+      const auto function = bestFunctions[sourceFormat][targetFormat];
+      if (function == nullptr)
+        ;
+      else if (getCalibrationMode() != CALIBRATION_DISABLED and not snapshot->calibrated[sourceFormat][targetFormat])
+        return getFunction(getFormatName(sourceFormat), getFormatName(targetFormat));
+      else
+        return function;
+    }
+
+  throw std::runtime_error("ConverterRegistry::getFunction() conversion not registered; "
+                           "sourceFormatId="+std::to_string(sourceFormat)+", targetFormatId="+std::to_string(targetFormat));
+}
+
+SoapySDR::ConverterRegistry::Converter SoapySDR::ConverterRegistry::getConverter(const std::string &sourceFormat, const std::string &targetFormat)
+{
+  const auto function = getFunction(sourceFormat, targetFormat);
+
+  Converter converter;
+  converter.function = function;
+  SnapshotReader snapshot;
+  for (const auto &it : snapshot->formatConverters.at(sourceFormat).at(targetFormat))
+    {
+      if (it.second == function) converter.priority = it.first;
+    }
+  converter.inPlace = snapshot->inPlaceSupport.at(sourceFormat).at(targetFormat).at(converter.priority);
+  converter.sourceElemSize = SoapySDR::formatToSize(sourceFormat);
+  converter.targetElemSize = SoapySDR::formatToSize(targetFormat);
+  return converter;
+}
+
+SoapySDR::ConverterRegistry::Converter SoapySDR::ConverterRegistry::getConverter(const std::string &sourceFormat, const std::string &targetFormat, const FunctionPriority &priority)
+{
+  Converter converter;
+  converter.function = getFunction(sourceFormat, targetFormat, priority);
+  converter.priority = priority;
+  SnapshotReader snapshot;
+  converter.inPlace = snapshot->inPlaceSupport.at(sourceFormat).at(targetFormat).at(priority);
+  converter.sourceElemSize = SoapySDR::formatToSize(sourceFormat);
+  converter.targetElemSize = SoapySDR::formatToSize(targetFormat);
+  return converter;
+}
+
+bool SoapySDR::ConverterRegistry::supportsInPlace(const std::string &sourceFormat, const std::string &targetFormat)
+{
+  try
+    {
+      return getConverter(sourceFormat, targetFormat).inPlace;
+    }
+  catch (const std::runtime_error &)
+    {
+      return false;
+    }
+}
+
+bool SoapySDR::ConverterRegistry::supportsInPlace(const std::string &sourceFormat, const std::string &targetFormat, const FunctionPriority &priority)
+{
+  try
+    {
+      return getConverter(sourceFormat, targetFormat, priority).inPlace;
+    }
+  catch (const std::runtime_error &)
+    {
+      return false;
+    }
+}
+
+SoapySDR::ConverterRegistry::FormatId SoapySDR::ConverterRegistry::getFormatId(const std::string &format)
+{
+  //fast path: a registered format
+  {
+    SnapshotReader snapshot;
+    const auto it = snapshot->formatIds.find(format);
+    if (it != snapshot->formatIds.end()) return it->second;
+  }
+
+  return internFormatId(format);
+}
+
+std::string SoapySDR::ConverterRegistry::getFormatName(const FormatId formatId)
+{
+  auto &table = getFormatTable();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  return table.formatNames.at(formatId);
 }
 
 std::vector<std::string> SoapySDR::ConverterRegistry::listAvailableSourceFormats(void)
 {
     lateLoadDefaultConverters();
+    SnapshotReader snapshot;
+    const auto &formatConverters = snapshot->formatConverters;
 
     std::vector<std::string> sources;
     for (const auto &it : formatConverters)
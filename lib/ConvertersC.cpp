@@ -0,0 +1,62 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include "ErrorHelpers.hpp"
+#include "TypeHelpers.hpp"
+#include <SoapySDR/Converters.h>
+#include <SoapySDR/ConverterRegistry.hpp>
+#include <cstdlib>
+
+extern "C" {
+
+char **SoapySDRConverter_listTargetFormats(const char *sourceFormat, size_t *length)
+{
+    *length = 0;
+    __SOAPY_SDR_C_TRY
+    return toStrArray(SoapySDR::ConverterRegistry::listTargetFormats(sourceFormat), length);
+    __SOAPY_SDR_C_CATCH_RET(nullptr);
+}
+
+char **SoapySDRConverter_listSourceFormats(const char *targetFormat, size_t *length)
+{
+    *length = 0;
+    __SOAPY_SDR_C_TRY
+    return toStrArray(SoapySDR::ConverterRegistry::listSourceFormats(targetFormat), length);
+    __SOAPY_SDR_C_CATCH_RET(nullptr);
+}
+
+SoapySDRConverterFunctionPriority *SoapySDRConverter_listPriorities(const char *sourceFormat, const char *targetFormat, size_t *length)
+{
+    *length = 0;
+    __SOAPY_SDR_C_TRY
+    const auto priorities = SoapySDR::ConverterRegistry::listPriorities(sourceFormat, targetFormat);
+    auto out = (SoapySDRConverterFunctionPriority *)calloc(priorities.size(), sizeof(SoapySDRConverterFunctionPriority));
+    for (size_t i = 0; i < priorities.size(); i++) out[i] = SoapySDRConverterFunctionPriority(priorities[i]);
+    *length = priorities.size();
+    return out;
+    __SOAPY_SDR_C_CATCH_RET(nullptr);
+}
+
+SoapySDRConverterFunction SoapySDRConverter_getFunction(const char *sourceFormat, const char *targetFormat)
+{
+    __SOAPY_SDR_C_TRY
+    return SoapySDR::ConverterRegistry::getFunction(sourceFormat, targetFormat);
+    __SOAPY_SDR_C_CATCH_RET(nullptr);
+}
+
+SoapySDRConverterFunction SoapySDRConverter_getFunctionWithPriority(const char *sourceFormat, const char *targetFormat, const SoapySDRConverterFunctionPriority priority)
+{
+    __SOAPY_SDR_C_TRY
+    return SoapySDR::ConverterRegistry::getFunction(sourceFormat, targetFormat, SoapySDR::ConverterRegistry::FunctionPriority(priority));
+    __SOAPY_SDR_C_CATCH_RET(nullptr);
+}
+
+char **SoapySDRConverter_listAvailableSourceFormats(size_t *length)
+{
+    *length = 0;
+    __SOAPY_SDR_C_TRY
+    return toStrArray(SoapySDR::ConverterRegistry::listAvailableSourceFormats(), length);
+    __SOAPY_SDR_C_CATCH_RET(nullptr);
+}
+
+} //extern "C"
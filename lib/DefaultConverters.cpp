@@ -7,639 +7,255 @@
 #include <SoapySDR/ConverterPrimatives.hpp>
 #include <SoapySDR/ConverterRegistry.hpp>
 #include <SoapySDR/Formats.hpp>
+#include <type_traits>
+#include <limits>
 #include <cstring> //memcpy
 
 // ********************************
-// Real Soapy Formats
-
-// Copy Converters
-
-// F32 <> F32
-static void genericF32toF32(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 1;
-
-  if (scaler == 1.0)
-    {
-      const size_t sampleSize = sizeof(float);
-      std::memcpy(dstBuff, srcBuff, numElems*elemDepth*sampleSize);
-    }
-  else
-    {
-      auto *src = (float*)srcBuff;
-      auto *dst = (float*)dstBuff;
-      for (size_t i = 0; i < numElems*elemDepth; i++)
-        {
-          dst[i] = float(src[i]) * scaler;
-        }
-    }
-}
-
-// S32 <> S32
-static void genericS32toS32(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 1;
-
-  if (scaler == 1.0)
-    {
-      const size_t sampleSize = sizeof(int32_t);
-      std::memcpy(dstBuff, srcBuff, numElems*elemDepth*sampleSize);
-    }
-  else
-    {
-      auto *src = (int32_t*)srcBuff;
-      auto *dst = (int32_t*)dstBuff;
-      for (size_t i = 0; i < numElems*elemDepth; i++)
-        {
-          dst[i] = int32_t(src[i]) * scaler;
-        }
-    }
-}
-
-// S16 <> S16
-static void genericS16toS16(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 1;
-
-  if (scaler == 1.0)
-    {
-      const size_t sampleSize = sizeof(int16_t);
-      std::memcpy(dstBuff, srcBuff, numElems*elemDepth*sampleSize);
-    }
-  else
-    {
-      auto *src = (int16_t*)srcBuff;
-      auto *dst = (int16_t*)dstBuff;
-      for (size_t i = 0; i < numElems*elemDepth; i++)
-        {
-          dst[i] = int16_t(src[i]) * scaler;
-        }
-    }
-}
-
-// S8 <> S8
-static void genericS8toS8(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 1;
-
-  if (scaler == 1.0)
-    {
-      const size_t sampleSize = sizeof(int8_t);
-      std::memcpy(dstBuff, srcBuff, numElems*elemDepth*sampleSize);
-    }
-  else
-    {
-      auto *src = (int8_t*)srcBuff;
-      auto *dst = (int8_t*)dstBuff;
-      for (size_t i = 0; i < numElems*elemDepth; i++)
-        {
-          dst[i] = int8_t(src[i]) * scaler;
-        }
-    }
-}
-
-// Type Converters
-
-// F32 <> S16
-static void genericF32toS16(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 1;
-
-  auto *src = (float*)srcBuff;
-  auto *dst = (int16_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::F32toS16(src[i] * scaler);
-    }
-}
-
-static void genericS16toF32(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 1;
-
-  auto *src = (int16_t*)srcBuff;
-  auto *dst = (float*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::S16toF32(src[i]) * scaler;
-    }
-}
-
-// F32 <> U16
-static void genericF32toU16(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 1;
-
-  auto *src = (float*)srcBuff;
-  auto *dst = (uint16_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::F32toU16(src[i] * scaler);
-    }
-}
-
-static void genericU16toF32(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 1;
-
-  auto *src = (uint16_t*)srcBuff;
-  auto *dst = (float*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::U16toF32(src[i]) * scaler;
-    }
-}
-
-// F32 <> S8
-static void genericF32toS8(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 1;
-
-  auto *src = (float*)srcBuff;
-  auto *dst = (int8_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::F32toS8(src[i] * scaler);
-    }
-}
-
-static void genericS8toF32(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 1;
-
-  auto *src = (int8_t*)srcBuff;
-  auto *dst = (float*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::S8toF32(src[i]) * scaler;
-    }
-}
-
-// F32 <> U8
-static void genericF32toU8(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 1;
-
-  auto *src = (float*)srcBuff;
-  auto *dst = (uint8_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::F32toU8(src[i] * scaler);
-    }
-}
-
-static void genericU8toF32(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 1;
-
-  auto *src = (uint8_t*)srcBuff;
-  auto *dst = (float*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::U8toF32(src[i]) * scaler;
-    }
-}
-
-// S16 <> U16
-static void genericS16toU16(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 1;
-
-  auto *src = (int16_t*)srcBuff;
-  auto *dst = (uint16_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::S16toU16(src[i] * scaler);
-    }
-}
-
-static void genericU16toS16(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 1;
-
-  auto *src = (uint16_t*)srcBuff;
-  auto *dst = (int16_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::U16toS16(src[i]) * scaler;
-    }
-}
+// Sample traits
+//
+// Every sample type is described by its signed counterpart,
+// so that offset binary types convert through two's complement.
 
-// S16 <> S8
-static void genericS16toS8(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+template <typename T, bool isFloat = std::is_floating_point<T>::value>
+struct SignedType
 {
-  const size_t elemDepth = 1;
-
-  auto *src = (int16_t*)srcBuff;
-  auto *dst = (int8_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::S16toS8(src[i] * scaler);
-    }
-}
+  typedef typename std::make_signed<T>::type type;
+};
 
-static void genericS8toS16(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+template <typename T>
+struct SignedType<T, true>
 {
-  const size_t elemDepth = 1;
-
-  auto *src = (int8_t*)srcBuff;
-  auto *dst = (int16_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::S8toS16(src[i]) * scaler;
-    }
-}
+  typedef T type;
+};
 
-// S16 <> U8
-static void genericS16toU8(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+template <typename T>
+struct SampleTraits
 {
-  const size_t elemDepth = 1;
-
-  auto *src = (int16_t*)srcBuff;
-  auto *dst = (uint8_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::S16toU8(src[i] * scaler);
-    }
-}
+  static const bool isFloat = std::is_floating_point<T>::value;
+  static const bool isUnsigned = std::is_unsigned<T>::value;
+  static const int bits = int(sizeof(T)*8);
+  typedef typename SignedType<T>::type Signed;
+};
 
-static void genericU8toS16(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+// offset binary <> two's complement
+template <typename T>
+static inline typename SampleTraits<T>::Signed toSigned(const T from)
 {
-  const size_t elemDepth = 1;
-
-  auto *src = (uint8_t*)srcBuff;
-  auto *dst = (int16_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::U8toS16(src[i]) * scaler;
-    }
+  typedef typename SampleTraits<T>::Signed Signed;
+  const T offset = SampleTraits<T>::isUnsigned?T(T(1) << (SampleTraits<T>::bits-1)):T(0);
+  return Signed(from - offset);
 }
 
-// U16 <> S8
-static void genericU16toS8(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+template <typename T>
+static inline T fromSigned(const typename SampleTraits<T>::Signed from)
 {
-  const size_t elemDepth = 1;
-
-  auto *src = (uint16_t*)srcBuff;
-  auto *dst = (int8_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::U16toS8(src[i] * scaler);
-    }
+  const T offset = SampleTraits<T>::isUnsigned?T(T(1) << (SampleTraits<T>::bits-1)):T(0);
+  return T(T(from) + offset);
 }
 
-static void genericS8toU16(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+// signed size conversion: shift up to widen, shift down to narrow
+template <typename To, typename From>
+static inline To resizeSigned(const From from)
 {
-  const size_t elemDepth = 1;
-
-  auto *src = (int8_t*)srcBuff;
-  auto *dst = (uint16_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::S8toU16(src[i]) * scaler;
-    }
+  const int up = (SampleTraits<To>::bits > SampleTraits<From>::bits)?(SampleTraits<To>::bits - SampleTraits<From>::bits):0;
+  const int down = (SampleTraits<From>::bits > SampleTraits<To>::bits)?(SampleTraits<From>::bits - SampleTraits<To>::bits):0;
+  return To(To(from >> down) * To(1 << up));
 }
 
-// S8 <> U8
-static void genericS8toU8(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+// clamp a scaled value to the range of a signed integer type
+template <typename T>
+static inline T saturate(const double from)
 {
-  const size_t elemDepth = 1;
-
-  auto *src = (int8_t*)srcBuff;
-  auto *dst = (uint8_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::S8toU8(src[i] * scaler);
-    }
+  const double hi = double(std::numeric_limits<T>::max());
+  const double lo = double(std::numeric_limits<T>::min());
+  return T((from > hi)?hi:((from < lo)?lo:from));
 }
 
-static void genericU8toS8(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+// the positive full scale of an integer type as a gain
+template <typename T>
+static inline double fullScale(void)
 {
-  const size_t elemDepth = 1;
-
-  auto *src = (uint8_t*)srcBuff;
-  auto *dst = (int8_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::U8toS8(src[i]) * scaler;
-    }
+  return double((1ull << (SampleTraits<T>::bits-1)) - 1);
 }
 
 // ********************************
-// Complex Data Types
-
-// Copy Converters
-
-// CF32 <> CF32
-static void genericCF32toCF32(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 2;
-
-  if (scaler == 1.0)
-    {
-      const size_t sampleSize = sizeof(float);
-      std::memcpy(dstBuff, srcBuff, numElems*elemDepth*sampleSize);
-    }
-  else
-    {
-      auto *src = (float*)srcBuff;
-      auto *dst = (float*)dstBuff;
-      for (size_t i = 0; i < numElems*elemDepth; i++)
-        {
-          dst[i] = float(src[i]) * scaler;
-        }
-    }
-}
-
-// CS32 <> CS32
-static void genericCS32toCS32(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 2;
-
-  if (scaler == 1.0)
-    {
-      const size_t sampleSize = sizeof(int32_t);
-      std::memcpy(dstBuff, srcBuff, numElems*elemDepth*sampleSize);
-    }
-  else
-    {
-      auto *src = (int32_t*)srcBuff;
-      auto *dst = (int32_t*)dstBuff;
-      for (size_t i = 0; i < numElems*elemDepth; i++)
-        {
-          dst[i] = int32_t(src[i]) * scaler;
-        }
-    }
-}
-
-// CS16 <> CS16
-static void genericCS16toCS16(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 2;
-
-  if (scaler == 1.0)
-    {
-      const size_t sampleSize = sizeof(int16_t);
-      std::memcpy(dstBuff, srcBuff, numElems*elemDepth*sampleSize);
-    }
-  else
-    {
-      auto *src = (int16_t*)srcBuff;
-      auto *dst = (int16_t*)dstBuff;
-      for (size_t i = 0; i < numElems*elemDepth; i++)
-        {
-          dst[i] = int16_t(src[i]) * scaler;
-        }
-    }
-}
-
-// CS8 <> CS8
-static void genericCS8toCS8(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 2;
-
-  if (scaler == 1.0)
-    {
-      const size_t sampleSize = sizeof(int8_t);
-      std::memcpy(dstBuff, srcBuff, numElems*elemDepth*sampleSize);
-    }
-  else
-    {
-      auto *src = (int8_t*)srcBuff;
-      auto *dst = (int8_t*)dstBuff;
-      for (size_t i = 0; i < numElems*elemDepth; i++)
-        {
-          dst[i] = int8_t(src[i]) * scaler;
-        }
-    }
-}
-
-// Type Converters
-
-// CF32 <> CS16
-static void genericCF32toCS16(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 2;
-
-  auto *src = (float*)srcBuff;
-  auto *dst = (int16_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::F32toS16(src[i] * scaler);
-    }
-}
-
-static void genericCS16toCF32(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 2;
-
-  auto *src = (int16_t*)srcBuff;
-  auto *dst = (float*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::S16toF32(src[i]) * scaler;
-    }
-}
-
-// CF32 <> CU16
-static void genericCF32toCU16(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 2;
-
-  auto *src = (float*)srcBuff;
-  auto *dst = (uint16_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::F32toU16(src[i] * scaler);
-    }
-}
-
-static void genericCU16toCF32(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 2;
-
-  auto *src = (uint16_t*)srcBuff;
-  auto *dst = (float*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::U16toF32(src[i]) * scaler;
-    }
-}
-
-// CF32 <> CS8
-static void genericCF32toCS8(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 2;
-
-  auto *src = (float*)srcBuff;
-  auto *dst = (int8_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::F32toS8(src[i] * scaler);
-    }
-}
-
-static void genericCS8toCF32(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 2;
-
-  auto *src = (int8_t*)srcBuff;
-  auto *dst = (float*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::S8toF32(src[i]) * scaler;
-    }
-}
-
-// CF32 <> CU8
-static void genericCF32toCU8(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 2;
-
-  auto *src = (float*)srcBuff;
-  auto *dst = (uint8_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::F32toU8(src[i] * scaler);
-    }
-}
-
-static void genericCU8toCF32(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 2;
-
-  auto *src = (uint8_t*)srcBuff;
-  auto *dst = (float*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::U8toF32(src[i]) * scaler;
-    }
-}
-
-// CS16 <> CU16
-static void genericCS16toCU16(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 2;
-
-  auto *src = (int16_t*)srcBuff;
-  auto *dst = (uint16_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::S16toU16(src[i] * scaler);
-    }
-}
-
-static void genericCU16toCS16(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 2;
-
-  auto *src = (uint16_t*)srcBuff;
-  auto *dst = (int16_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::U16toS16(src[i]) * scaler;
-    }
-}
-
-// CS16 <> CS8
-static void genericCS16toCS8(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 2;
-
-  auto *src = (int16_t*)srcBuff;
-  auto *dst = (int8_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::S16toS8(src[i] * scaler);
-    }
-}
-
-static void genericCS8toCS16(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 2;
-
-  auto *src = (int8_t*)srcBuff;
-  auto *dst = (int16_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::S8toS16(src[i]) * scaler;
-    }
-}
-
-// CS16 <> CU8
-static void genericCS16toCU8(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 2;
+// Sample conversions
+//
+// A conversion precomputes its gain once per call,
+// and the Unity parameter selects the unscaled path at compile time:
+// integer and float resizing is then free of any multiply.
+
+template <typename Src, typename Dst, bool Unity,
+  bool SrcFloat = SampleTraits<Src>::isFloat, bool DstFloat = SampleTraits<Dst>::isFloat>
+struct SampleConvert;
+
+// float <> float: scaled in the wider type
+template <typename Src, typename Dst, bool Unity>
+struct SampleConvert<Src, Dst, Unity, true, true>
+{
+  typedef typename std::conditional<(sizeof(Src) > sizeof(Dst)), Src, Dst>::type Gain;
+  static inline Gain gain(const double scaler) {return Gain(scaler);}
+  static inline Dst convert(const Src from, const Gain gain)
+  {
+    return Unity?Dst(from):Dst(Gain(from) * gain);
+  }
+};
+
+// float -> integer: the gain folds the scaler and the full scale
+template <typename Src, typename Dst, bool Unity>
+struct SampleConvert<Src, Dst, Unity, true, false>
+{
+  typedef Src Gain;
+  static inline Gain gain(const double scaler) {return Gain(scaler * fullScale<Dst>());}
+  static inline Dst convert(const Src from, const Gain gain)
+  {
+    return fromSigned<Dst>(typename SampleTraits<Dst>::Signed(from * gain));
+  }
+};
+
+// integer -> float: the gain folds the scaler and the full scale
+template <typename Src, typename Dst, bool Unity>
+struct SampleConvert<Src, Dst, Unity, false, true>
+{
+  typedef Dst Gain;
+  static inline Gain gain(const double scaler) {return Gain(scaler / fullScale<Src>());}
+  static inline Dst convert(const Src from, const Gain gain)
+  {
+    return Dst(toSigned(from)) * gain;
+  }
+};
+
+// integer <> integer: scaled in the wider signed type,
+// a scaler above one saturates instead of wrapping
+template <typename Src, typename Dst, bool Unity>
+struct SampleConvert<Src, Dst, Unity, false, false>
+{
+  typedef double Gain;
+  typedef typename SampleTraits<Src>::Signed SrcSigned;
+  typedef typename SampleTraits<Dst>::Signed DstSigned;
+  typedef typename std::conditional<(sizeof(Src) > sizeof(Dst)), SrcSigned, DstSigned>::type Wide;
+  static inline Gain gain(const double scaler) {return scaler;}
+  static inline Dst convert(const Src from, const Gain gain)
+  {
+    const Wide wide = resizeSigned<Wide>(toSigned(from));
+    return fromSigned<Dst>(resizeSigned<DstSigned>(Unity?wide:saturate<Wide>(wide * gain)));
+  }
+};
 
-  auto *src = (int16_t*)srcBuff;
-  auto *dst = (uint8_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::S16toU8(src[i] * scaler);
-    }
-}
+// ********************************
+// Generic kernels
 
-static void genericCU8toCS16(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+template <typename Src, typename Dst, size_t ElemDepth, bool Unity>
+static void convertLoop(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
 {
-  const size_t elemDepth = 2;
+  typedef SampleConvert<Src, Dst, Unity> Sample;
+  const typename Sample::Gain gain = Sample::gain(scaler);
 
-  auto *src = (uint8_t*)srcBuff;
-  auto *dst = (int16_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
+  auto *src = (const Src*)srcBuff;
+  auto *dst = (Dst*)dstBuff;
+  for (size_t i = 0; i < numElems*ElemDepth; i++)
     {
-      dst[i] = SoapySDR::U8toS16(src[i]) * scaler;
+      dst[i] = Sample::convert(src[i], gain);
     }
 }
 
-// CU16 <> CS8
-static void genericCU16toCS8(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+// unity gain conversions between different types
+template <typename Src, typename Dst, size_t ElemDepth>
+struct UnityKernel
 {
-  const size_t elemDepth = 2;
-
-  auto *src = (uint16_t*)srcBuff;
-  auto *dst = (int8_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::U16toS8(src[i] * scaler);
-    }
-}
+  static void convert(const void *srcBuff, void *dstBuff, const size_t numElems)
+  {
+    convertLoop<Src, Dst, ElemDepth, true>(srcBuff, dstBuff, numElems, 1.0);
+  }
+};
 
-static void genericCS8toCU16(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+// unity gain conversions within a type are a copy
+template <typename T, size_t ElemDepth>
+struct UnityKernel<T, T, ElemDepth>
 {
-  const size_t elemDepth = 2;
-
-  auto *src = (int8_t*)srcBuff;
-  auto *dst = (uint16_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::S8toU16(src[i]) * scaler;
-    }
-}
+  static void convert(const void *srcBuff, void *dstBuff, const size_t numElems)
+  {
+    if (srcBuff != dstBuff) std::memcpy(dstBuff, srcBuff, numElems*ElemDepth*sizeof(T));
+  }
+};
 
-// CS8 <> CU8
-static void genericCS8toCU8(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+template <typename Src, typename Dst, size_t ElemDepth>
+static void genericConvert(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
 {
-  const size_t elemDepth = 2;
-
-  auto *src = (int8_t*)srcBuff;
-  auto *dst = (uint8_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::S8toU8(src[i] * scaler);
-    }
+  if (scaler == 1.0) UnityKernel<Src, Dst, ElemDepth>::convert(srcBuff, dstBuff, numElems);
+  else convertLoop<Src, Dst, ElemDepth, false>(srcBuff, dstBuff, numElems, scaler);
 }
 
-static void genericCU8toCS8(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
-{
-  const size_t elemDepth = 2;
-
-  auto *src = (uint8_t*)srcBuff;
-  auto *dst = (int8_t*)dstBuff;
-  for (size_t i = 0; i < numElems*elemDepth; i++)
-    {
-      dst[i] = SoapySDR::U8toS8(src[i]) * scaler;
-    }
-}
+// ********************************
+// Registration table
+//
+// The full matrix of real and complex formats up to 64 bits.
+// The kernels store each element after loading it,
+// so conversions that do not widen are safe in-place.
+
+struct GenericConverter
+{
+  const char *sourceFormat;
+  const char *targetFormat;
+  SoapySDR::ConverterRegistry::ConverterFunction function;
+  bool inPlace;
+};
+
+#define GENERIC_CONVERTER(srcFmt, SrcType, dstFmt, DstType, elemDepth) \
+  {srcFmt, dstFmt, &genericConvert<SrcType, DstType, elemDepth>, sizeof(DstType) <= sizeof(SrcType)}
+
+#define GENERIC_REAL_ROW(srcFmt, SrcType) \
+  GENERIC_CONVERTER(srcFmt, SrcType, SOAPY_SDR_F64, double, 1), \
+  GENERIC_CONVERTER(srcFmt, SrcType, SOAPY_SDR_F32, float, 1), \
+  GENERIC_CONVERTER(srcFmt, SrcType, SOAPY_SDR_S32, int32_t, 1), \
+  GENERIC_CONVERTER(srcFmt, SrcType, SOAPY_SDR_U32, uint32_t, 1), \
+  GENERIC_CONVERTER(srcFmt, SrcType, SOAPY_SDR_S16, int16_t, 1), \
+  GENERIC_CONVERTER(srcFmt, SrcType, SOAPY_SDR_U16, uint16_t, 1), \
+  GENERIC_CONVERTER(srcFmt, SrcType, SOAPY_SDR_S8, int8_t, 1), \
+  GENERIC_CONVERTER(srcFmt, SrcType, SOAPY_SDR_U8, uint8_t, 1)
+
+#define GENERIC_COMPLEX_ROW(srcFmt, SrcType) \
+  GENERIC_CONVERTER(srcFmt, SrcType, SOAPY_SDR_CF64, double, 2), \
+  GENERIC_CONVERTER(srcFmt, SrcType, SOAPY_SDR_CF32, float, 2), \
+  GENERIC_CONVERTER(srcFmt, SrcType, SOAPY_SDR_CS32, int32_t, 2), \
+  GENERIC_CONVERTER(srcFmt, SrcType, SOAPY_SDR_CU32, uint32_t, 2), \
+  GENERIC_CONVERTER(srcFmt, SrcType, SOAPY_SDR_CS16, int16_t, 2), \
+  GENERIC_CONVERTER(srcFmt, SrcType, SOAPY_SDR_CU16, uint16_t, 2), \
+  GENERIC_CONVERTER(srcFmt, SrcType, SOAPY_SDR_CS8, int8_t, 2), \
+  GENERIC_CONVERTER(srcFmt, SrcType, SOAPY_SDR_CU8, uint8_t, 2)
+
+static constexpr GenericConverter genericConverters[] = {
+  GENERIC_REAL_ROW(SOAPY_SDR_F64, double),
+  GENERIC_REAL_ROW(SOAPY_SDR_F32, float),
+  GENERIC_REAL_ROW(SOAPY_SDR_S32, int32_t),
+  GENERIC_REAL_ROW(SOAPY_SDR_U32, uint32_t),
+  GENERIC_REAL_ROW(SOAPY_SDR_S16, int16_t),
+  GENERIC_REAL_ROW(SOAPY_SDR_U16, uint16_t),
+  GENERIC_REAL_ROW(SOAPY_SDR_S8, int8_t),
+  GENERIC_REAL_ROW(SOAPY_SDR_U8, uint8_t),
+  GENERIC_COMPLEX_ROW(SOAPY_SDR_CF64, double),
+  GENERIC_COMPLEX_ROW(SOAPY_SDR_CF32, float),
+  GENERIC_COMPLEX_ROW(SOAPY_SDR_CS32, int32_t),
+  GENERIC_COMPLEX_ROW(SOAPY_SDR_CU32, uint32_t),
+  GENERIC_COMPLEX_ROW(SOAPY_SDR_CS16, int16_t),
+  GENERIC_COMPLEX_ROW(SOAPY_SDR_CU16, uint16_t),
+  GENERIC_COMPLEX_ROW(SOAPY_SDR_CS8, int8_t),
+  GENERIC_COMPLEX_ROW(SOAPY_SDR_CU8, uint8_t),
+};
+
+static bool registerGenericConverters(void)
+{
+  for (const auto &c : genericConverters)
+    {
+      SoapySDR::ConverterRegistry registration(c.sourceFormat, c.targetFormat, SoapySDR::ConverterRegistry::GENERIC, c.function, c.inPlace);
+    }
+  return true;
+}
+
+void lateLoadVectorizedConverters(void);
+void lateLoadInterleavedConverters(void);
+void lateLoadTableConverters(void);
 
 /*!
  * lateLoadDefaultConverters() is called by loadModules()
@@ -651,48 +267,16 @@ static void genericCU8toCS8(const void *srcBuff, void *dstBuff, const size_t num
  */
 void lateLoadDefaultConverters(void)
 {
-    static SoapySDR::ConverterRegistry registerGenericF32toF32(SOAPY_SDR_F32, SOAPY_SDR_F32, SoapySDR::ConverterRegistry::GENERIC, &genericF32toF32);
-    static SoapySDR::ConverterRegistry registerGenericS32toS32(SOAPY_SDR_S32, SOAPY_SDR_S32, SoapySDR::ConverterRegistry::GENERIC, &genericS32toS32);
-    static SoapySDR::ConverterRegistry registerGenericS16toS16(SOAPY_SDR_S16, SOAPY_SDR_S16, SoapySDR::ConverterRegistry::GENERIC, &genericS16toS16);
-    static SoapySDR::ConverterRegistry registerGenericS8toS8(SOAPY_SDR_S8, SOAPY_SDR_S8, SoapySDR::ConverterRegistry::GENERIC, &genericS8toS8);
-    static SoapySDR::ConverterRegistry registerGenericF32toS16(SOAPY_SDR_F32, SOAPY_SDR_S16, SoapySDR::ConverterRegistry::GENERIC, &genericF32toS16);
-    static SoapySDR::ConverterRegistry registerGenericS16toF32(SOAPY_SDR_S16, SOAPY_SDR_F32, SoapySDR::ConverterRegistry::GENERIC, &genericS16toF32);
-    static SoapySDR::ConverterRegistry registerGenericF32toU16(SOAPY_SDR_F32, SOAPY_SDR_U16, SoapySDR::ConverterRegistry::GENERIC, &genericF32toU16);
-    static SoapySDR::ConverterRegistry registerGenericU16toF32(SOAPY_SDR_U16, SOAPY_SDR_F32, SoapySDR::ConverterRegistry::GENERIC, &genericU16toF32);
-    static SoapySDR::ConverterRegistry registerGenericF32toS8(SOAPY_SDR_F32, SOAPY_SDR_S8, SoapySDR::ConverterRegistry::GENERIC, &genericF32toS8);
-    static SoapySDR::ConverterRegistry registerGenericS8toF32(SOAPY_SDR_S8, SOAPY_SDR_F32, SoapySDR::ConverterRegistry::GENERIC, &genericS8toF32);
-    static SoapySDR::ConverterRegistry registerGenericF32toU8(SOAPY_SDR_F32, SOAPY_SDR_U8, SoapySDR::ConverterRegistry::GENERIC, &genericF32toU8);
-    static SoapySDR::ConverterRegistry registerGenericU8toF32(SOAPY_SDR_U8, SOAPY_SDR_F32, SoapySDR::ConverterRegistry::GENERIC, &genericU8toF32);
-    static SoapySDR::ConverterRegistry registerGenericS16toU16(SOAPY_SDR_S16, SOAPY_SDR_U16, SoapySDR::ConverterRegistry::GENERIC, &genericS16toU16);
-    static SoapySDR::ConverterRegistry registerGenericU16toS16(SOAPY_SDR_U16, SOAPY_SDR_S16, SoapySDR::ConverterRegistry::GENERIC, &genericU16toS16);
-    static SoapySDR::ConverterRegistry registerGenericS16toS8(SOAPY_SDR_S16, SOAPY_SDR_S8, SoapySDR::ConverterRegistry::GENERIC, &genericS16toS8);
-    static SoapySDR::ConverterRegistry registerGenericS8toS16(SOAPY_SDR_S8, SOAPY_SDR_S16, SoapySDR::ConverterRegistry::GENERIC, &genericS8toS16);
-    static SoapySDR::ConverterRegistry registerGenericS16toU8(SOAPY_SDR_S16, SOAPY_SDR_U8, SoapySDR::ConverterRegistry::GENERIC, &genericS16toU8);
-    static SoapySDR::ConverterRegistry registerGenericU8toS16(SOAPY_SDR_U8, SOAPY_SDR_S16, SoapySDR::ConverterRegistry::GENERIC, &genericU8toS16);
-    static SoapySDR::ConverterRegistry registerGenericU16toS8(SOAPY_SDR_U16, SOAPY_SDR_S8, SoapySDR::ConverterRegistry::GENERIC, &genericU16toS8);
-    static SoapySDR::ConverterRegistry registerGenericS8toU16(SOAPY_SDR_S8, SOAPY_SDR_U16, SoapySDR::ConverterRegistry::GENERIC, &genericS8toU16);
-    static SoapySDR::ConverterRegistry registerGenericS8toU8(SOAPY_SDR_S8, SOAPY_SDR_U8, SoapySDR::ConverterRegistry::GENERIC, &genericS8toU8);
-    static SoapySDR::ConverterRegistry registerGenericU8toS8(SOAPY_SDR_U8, SOAPY_SDR_S8, SoapySDR::ConverterRegistry::GENERIC, &genericU8toS8);
-    static SoapySDR::ConverterRegistry registerGenericCF32toCF32(SOAPY_SDR_CF32, SOAPY_SDR_CF32, SoapySDR::ConverterRegistry::GENERIC, &genericCF32toCF32);
-    static SoapySDR::ConverterRegistry registerGenericCS32toCS32(SOAPY_SDR_CS32, SOAPY_SDR_CS32, SoapySDR::ConverterRegistry::GENERIC, &genericCS32toCS32);
-    static SoapySDR::ConverterRegistry registerGenericCS16toCS16(SOAPY_SDR_CS16, SOAPY_SDR_CS16, SoapySDR::ConverterRegistry::GENERIC, &genericCS16toCS16);
-    static SoapySDR::ConverterRegistry registerGenericCS8toCS8(SOAPY_SDR_CS8, SOAPY_SDR_CS8, SoapySDR::ConverterRegistry::GENERIC, &genericCS8toCS8);
-    static SoapySDR::ConverterRegistry registerGenericCF32toCS16(SOAPY_SDR_CF32, SOAPY_SDR_CS16, SoapySDR::ConverterRegistry::GENERIC, &genericCF32toCS16);
-    static SoapySDR::ConverterRegistry registerGenericCS16toCF32(SOAPY_SDR_CS16, SOAPY_SDR_CF32, SoapySDR::ConverterRegistry::GENERIC, &genericCS16toCF32);
-    static SoapySDR::ConverterRegistry registerGenericCF32toCU16(SOAPY_SDR_CF32, SOAPY_SDR_CU16, SoapySDR::ConverterRegistry::GENERIC, &genericCF32toCU16);
-    static SoapySDR::ConverterRegistry registerGenericCU16toCF32(SOAPY_SDR_CU16, SOAPY_SDR_CF32, SoapySDR::ConverterRegistry::GENERIC, &genericCU16toCF32);
-    static SoapySDR::ConverterRegistry registerGenericCF32toCS8(SOAPY_SDR_CF32, SOAPY_SDR_CS8, SoapySDR::ConverterRegistry::GENERIC, &genericCF32toCS8);
-    static SoapySDR::ConverterRegistry registerGenericCS8toCF32(SOAPY_SDR_CS8, SOAPY_SDR_CF32, SoapySDR::ConverterRegistry::GENERIC, &genericCS8toCF32);
-    static SoapySDR::ConverterRegistry registerGenericCF32toCU8(SOAPY_SDR_CF32, SOAPY_SDR_CU8, SoapySDR::ConverterRegistry::GENERIC, &genericCF32toCU8);
-    static SoapySDR::ConverterRegistry registerGenericCU8toCF32(SOAPY_SDR_CU8, SOAPY_SDR_CF32, SoapySDR::ConverterRegistry::GENERIC, &genericCU8toCF32);
-    static SoapySDR::ConverterRegistry registerGenericCS16toCU16(SOAPY_SDR_CS16, SOAPY_SDR_CU16, SoapySDR::ConverterRegistry::GENERIC, &genericCS16toCU16);
-    static SoapySDR::ConverterRegistry registerGenericCU16toCS16(SOAPY_SDR_CU16, SOAPY_SDR_CS16, SoapySDR::ConverterRegistry::GENERIC, &genericCU16toCS16);
-    static SoapySDR::ConverterRegistry registerGenericCS16toCS8(SOAPY_SDR_CS16, SOAPY_SDR_CS8, SoapySDR::ConverterRegistry::GENERIC, &genericCS16toCS8);
-    static SoapySDR::ConverterRegistry registerGenericCS8toCS16(SOAPY_SDR_CS8, SOAPY_SDR_CS16, SoapySDR::ConverterRegistry::GENERIC, &genericCS8toCS16);
-    static SoapySDR::ConverterRegistry registerGenericCS16toCU8(SOAPY_SDR_CS16, SOAPY_SDR_CU8, SoapySDR::ConverterRegistry::GENERIC, &genericCS16toCU8);
-    static SoapySDR::ConverterRegistry registerGenericCU8toCS16(SOAPY_SDR_CU8, SOAPY_SDR_CS16, SoapySDR::ConverterRegistry::GENERIC, &genericCU8toCS16);
-    static SoapySDR::ConverterRegistry registerGenericCU16toCS8(SOAPY_SDR_CU16, SOAPY_SDR_CS8, SoapySDR::ConverterRegistry::GENERIC, &genericCU16toCS8);
-    static SoapySDR::ConverterRegistry registerGenericCS8toCU16(SOAPY_SDR_CS8, SOAPY_SDR_CU16, SoapySDR::ConverterRegistry::GENERIC, &genericCS8toCU16);
-    static SoapySDR::ConverterRegistry registerGenericCS8toCU8(SOAPY_SDR_CS8, SOAPY_SDR_CU8, SoapySDR::ConverterRegistry::GENERIC, &genericCS8toCU8);
-    static SoapySDR::ConverterRegistry registerGenericCU8toCS8(SOAPY_SDR_CU8, SOAPY_SDR_CS8, SoapySDR::ConverterRegistry::GENERIC, &genericCU8toCS8);
+    //one-shot registration of the generic matrix
+    static const bool registered = registerGenericConverters();
+    (void)registered;
+
+    //SIMD kernels for the host's CPU (when available)
+    lateLoadVectorizedConverters();
+
+    //fused multi-channel (de)interleave kernels
+    lateLoadInterleavedConverters();
+
+    //lookup table kernels for 8-bit sources
+    lateLoadTableConverters();
 }
@@ -4,14 +4,174 @@
 
 #include <SoapySDR/Device.hpp>
 #include <SoapySDR/Formats.hpp>
+#include "SensorPoller.hpp"
+#include "StreamDispatcher.hpp"
 #include <cstdlib>
 #include <algorithm> //min/max/find
+#include <SoapySDR/Logger.hpp>
+#include <condition_variable>
+#include <utility>
+#include <thread>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <map>
 
-SoapySDR::Device::~Device(void)
+/*******************************************************************
+ * Private state for the default implementations
+ ******************************************************************/
+class SoapySDR::Device::Impl
+{
+public:
+    Impl(void):
+        gainCacheEnabled(false),
+        gainGeneration(0),
+        numScheduled(0),
+        numBatchErrors(0)
+    {
+        return;
+    }
+
+    ~Impl(void)
+    {
+        //only a schedule thread that deleted the device itself is left
+        for (auto &thread : retiredThreads) thread.detach();
+    }
+
+    //keep an error that ended a batch after its first buffer
+    void stashBatchError(Stream *stream, const int ret)
+    {
+        std::lock_guard<std::mutex> lock(batchMutex);
+        if (batchErrors.count(stream) == 0) numBatchErrors++;
+        batchErrors[stream] = ret;
+    }
+
+    //take the kept error of the stream, false when there is none
+    bool takeBatchError(Stream *stream, int &ret)
+    {
+        if (numBatchErrors == 0) return false;
+        std::lock_guard<std::mutex> lock(batchMutex);
+        const auto it = batchErrors.find(stream);
+        if (it == batchErrors.end()) return false;
+        ret = it->second;
+        batchErrors.erase(it);
+        numBatchErrors--;
+        return true;
+    }
+
+    //gain model cache
+    std::mutex gainMutex;
+    bool gainCacheEnabled;
+    size_t gainGeneration;
+    std::map<std::pair<int, size_t>, GainElements> gainElements;
+
+    //host thread for the scheduled settings, each schedule has its own cancel token
+    std::mutex scheduleMutex;
+    std::condition_variable scheduleCond;
+    std::thread scheduleThread;
+    std::shared_ptr<std::atomic<bool>> scheduleCancel;
+    std::vector<std::thread> retiredThreads;
+    std::atomic<size_t> numScheduled;
+
+    //cancel the current schedule and take its thread, call with the schedule lock
+    void retireSchedule(std::vector<std::thread> &threads)
+    {
+        if (scheduleCancel) *scheduleCancel = true;
+        scheduleCancel.reset();
+        numScheduled = 0;
+        threads.swap(retiredThreads);
+        if (scheduleThread.joinable()) threads.push_back(std::move(scheduleThread));
+    }
+
+    //join the retired threads, a setter called from a schedule cannot join its own thread
+    void joinSchedules(std::vector<std::thread> &threads)
+    {
+        scheduleCond.notify_all();
+        for (auto &thread : threads)
+        {
+            if (thread.get_id() != std::this_thread::get_id()) thread.join();
+            else
+            {
+                std::lock_guard<std::mutex> lock(scheduleMutex);
+                retiredThreads.push_back(std::move(thread));
+            }
+        }
+    }
+
+    void runSchedule(Device *device, const SettingsTransaction transaction, const std::shared_ptr<std::atomic<bool>> cancel);
+
+    //shared poller for the sensor subscriptions, created on demand
+    std::mutex sensorMutex;
+    std::unique_ptr<SensorPoller> sensorPoller;
+
+    //shared dispatcher for the stream subscriptions, created on demand
+    std::mutex streamMutex;
+    std::unique_ptr<StreamDispatcher> streamDispatcher;
+
+    //errors of the default batch calls, returned by the next batch
+    std::mutex batchMutex;
+    std::map<Stream *, int> batchErrors;
+    std::atomic<size_t> numBatchErrors;
+};
+
+SoapySDR::Device::Device(void):
+    _impl(new Impl())
 {
     return;
 }
 
+SoapySDR::Device::~Device(void)
+{
+    //by now the derived driver is gone, but the schedule thread calls its setters
+    if (_impl->numScheduled != 0) SoapySDR::logf(SOAPY_SDR_ERROR,
+        "Device::~Device() %d scheduled settings still pending, call cancelScheduledSettings() before delete",
+        int(_impl->numScheduled));
+    this->Device::cancelScheduledSettings();
+    delete _impl;
+}
+
+/*******************************************************************
+ * Gain model cache
+ ******************************************************************/
+void SoapySDR::Device::enableGainCache(const bool enable)
+{
+    std::lock_guard<std::mutex> lock(_impl->gainMutex);
+    _impl->gainCacheEnabled = enable;
+    if (not enable) _impl->gainElements.clear();
+    _impl->gainGeneration++;
+}
+
+void SoapySDR::Device::invalidateGainCache(void)
+{
+    std::lock_guard<std::mutex> lock(_impl->gainMutex);
+    _impl->gainElements.clear();
+    _impl->gainGeneration++;
+}
+
+SoapySDR::Device::GainElements SoapySDR::Device::getGainElements(const int dir, const size_t channel) const
+{
+    size_t generation(0);
+    {
+        std::lock_guard<std::mutex> lock(_impl->gainMutex);
+        const auto it = _impl->gainElements.find(std::make_pair(dir, channel));
+        if (it != _impl->gainElements.end()) return it->second;
+        generation = _impl->gainGeneration;
+    }
+
+    //query the driver without the lock, the driver may invalidate the cache
+    GainElements elements;
+    for (const auto &name : this->listGains(dir, channel))
+    {
+        elements.push_back(std::make_pair(name, this->getGainRange(dir, channel, name)));
+    }
+
+    //an invalidation during the query makes the result stale
+    std::lock_guard<std::mutex> lock(_impl->gainMutex);
+    if (_impl->gainCacheEnabled and _impl->gainGeneration == generation) _impl->gainElements[std::make_pair(dir, channel)] = elements;
+    return elements;
+}
+
 /*******************************************************************
  * Identification API
  ******************************************************************/
@@ -113,11 +273,62 @@ int SoapySDR::Device::writeStream(Stream *, const void * const *, const size_t,
     return SOAPY_SDR_NOT_SUPPORTED;
 }
 
+int SoapySDR::Device::readStreamBatch(Stream *stream, void * const * const *buffs, const size_t numBuffs, const size_t numElems, size_t *elems, int *flags, long long *timeNs, const long timeoutUs)
+{
+    int error(0);
+    if (_impl->takeBatchError(stream, error)) return error;
+
+    size_t i = 0;
+    for (; i < numBuffs; i++)
+    {
+        int flag(0);
+        long long time(0);
+        const int ret = this->readStream(stream, buffs[i], numElems, flag, time, (i == 0)?timeoutUs:0);
+        if (ret < 0 and i == 0) return ret;
+        if (ret < 0 and ret != SOAPY_SDR_TIMEOUT) _impl->stashBatchError(stream, ret);
+        if (ret <= 0) break;
+        elems[i] = size_t(ret);
+        if (flags != nullptr) flags[i] = flag;
+        if (timeNs != nullptr) timeNs[i] = time;
+    }
+    return int(i);
+}
+
+int SoapySDR::Device::writeStreamBatch(Stream *stream, const void * const * const *buffs, const size_t numBuffs, const size_t *numElems, size_t *elems, int *flags, const long long *timeNs, const long timeoutUs)
+{
+    int error(0);
+    if (_impl->takeBatchError(stream, error)) return error;
+
+    size_t i = 0;
+    for (; i < numBuffs; i++)
+    {
+        int flag = (flags != nullptr)?flags[i]:0;
+        const int ret = this->writeStream(stream, buffs[i], numElems[i], flag, (timeNs != nullptr)?timeNs[i]:0, timeoutUs);
+        if (flags != nullptr) flags[i] = flag;
+        if (ret < 0 and i == 0) return ret;
+        if (ret < 0 and ret != SOAPY_SDR_TIMEOUT) _impl->stashBatchError(stream, ret);
+        if (ret < 0) break;
+        elems[i] = size_t(ret);
+        if (elems[i] != numElems[i]) return int(i+1);
+    }
+    return int(i);
+}
+
 int SoapySDR::Device::readStreamStatus(Stream *, size_t &, int &, long long &, const long)
 {
     return SOAPY_SDR_NOT_SUPPORTED;
 }
 
+int SoapySDR::Device::getStreamStats(Stream *, StreamStats &)
+{
+    return SOAPY_SDR_NOT_SUPPORTED;
+}
+
+int SoapySDR::Device::getStreamPollHandle(Stream *, intptr_t &)
+{
+    return SOAPY_SDR_NOT_SUPPORTED;
+}
+
 /*******************************************************************
  * Direct buffer access API
  ******************************************************************/
@@ -151,6 +362,28 @@ void SoapySDR::Device::releaseWriteBuffer(Stream *, const size_t, const size_t,
     return;
 }
 
+SoapySDR::StreamSubscription *SoapySDR::Device::subscribeStream(Stream *stream, const size_t numChans, const StreamSubscription::Callback &callback)
+{
+    StreamDispatcher *dispatcher = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_impl->streamMutex);
+        if (not _impl->streamDispatcher) _impl->streamDispatcher.reset(new StreamDispatcher(this));
+        dispatcher = _impl->streamDispatcher.get();
+    }
+    return dispatcher->subscribe(stream, numChans, callback);
+}
+
+void SoapySDR::Device::unsubscribeStream(StreamSubscription *subscription)
+{
+    StreamDispatcher *dispatcher = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_impl->streamMutex);
+        dispatcher = _impl->streamDispatcher.get();
+    }
+    if (dispatcher == nullptr) delete subscription;
+    else dispatcher->unsubscribe(subscription);
+}
+
 /*******************************************************************
  * Antenna API
  ******************************************************************/
@@ -272,25 +505,25 @@ bool SoapySDR::Device::getGainMode(const int, const size_t) const
 void SoapySDR::Device::setGain(const int dir, const size_t channel, double gain)
 {
     //algorithm to distribute overall gain (TX gets BB first, RX gets RF first)
-    const auto names = this->listGains(dir, channel);
+    const auto elements = this->getGainElements(dir, channel);
     if (dir == SOAPY_SDR_TX)
     {
-        for (int i = names.size()-1; i >= 0; i--)
+        for (int i = elements.size()-1; i >= 0; i--)
         {
-            const auto r = this->getGainRange(dir, channel, names[i]);
+            const auto &r = elements[i].second;
             const double g = std::min(gain, r.maximum()-r.minimum());
-            this->setGain(dir, channel, names[i], g+r.minimum());
-            gain -= this->getGain(dir, channel, names[i])-r.minimum();
+            this->setGain(dir, channel, elements[i].first, g+r.minimum());
+            gain -= this->getGain(dir, channel, elements[i].first)-r.minimum();
         }
     }
     if (dir == SOAPY_SDR_RX)
     {
-        for (size_t i = 0; i < names.size(); i++)
+        for (size_t i = 0; i < elements.size(); i++)
         {
-            const auto r = this->getGainRange(dir, channel, names[i]);
+            const auto &r = elements[i].second;
             const double g = std::min(gain, r.maximum()-r.minimum());
-            this->setGain(dir, channel, names[i], g+r.minimum());
-            gain -= this->getGain(dir, channel, names[i])-r.minimum();
+            this->setGain(dir, channel, elements[i].first, g+r.minimum());
+            gain -= this->getGain(dir, channel, elements[i].first)-r.minimum();
         }
     }
 }
@@ -304,10 +537,9 @@ double SoapySDR::Device::getGain(const int dir, const size_t channel) const
 {
     //algorithm to return an overall gain (summing each normalized gain)
     double gain = 0.0;
-    for (const auto &name : this->listGains(dir, channel))
+    for (const auto &element : this->getGainElements(dir, channel))
     {
-        const auto r = this->getGainRange(dir, channel, name);
-        gain += this->getGain(dir, channel, name)-r.minimum();
+        gain += this->getGain(dir, channel, element.first)-element.second.minimum();
     }
     return gain;
 }
@@ -326,10 +558,9 @@ SoapySDR::Range SoapySDR::Device::getGainRange(const int dir, const size_t chann
 {
     //algorithm to return an overall gain range (use 0 to max possible on each element)
     double gain = 0.0;
-    for (const auto &name : this->listGains(dir, channel))
+    for (const auto &element : this->getGainElements(dir, channel))
     {
-        const auto r = this->getGainRange(dir, channel, name);
-        gain += r.maximum()-r.minimum();
+        gain += element.second.maximum()-element.second.minimum();
     }
     return SoapySDR::Range(0.0, gain);
 }
@@ -620,6 +851,91 @@ void SoapySDR::Device::setCommandTime(const long long, const std::string &)
     return;
 }
 
+void SoapySDR::Device::scheduleSettings(const SettingsTransaction &transaction)
+{
+    if (transaction.commands().empty()) return this->Device::cancelScheduledSettings();
+
+    //replace the current schedule under one lock, so that concurrent calls never overlap
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> lock(_impl->scheduleMutex);
+        _impl->retireSchedule(threads);
+        _impl->scheduleCancel = std::make_shared<std::atomic<bool>>(false);
+        _impl->numScheduled = transaction.commands().size();
+        _impl->scheduleThread = std::thread(&SoapySDR::Device::Impl::runSchedule, _impl, this, transaction, _impl->scheduleCancel);
+    }
+    _impl->joinSchedules(threads);
+}
+
+void SoapySDR::Device::cancelScheduledSettings(void)
+{
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> lock(_impl->scheduleMutex);
+        _impl->retireSchedule(threads);
+    }
+    _impl->joinSchedules(threads);
+}
+
+size_t SoapySDR::Device::getNumScheduledSettings(void) const
+{
+    return _impl->numScheduled;
+}
+
+void SoapySDR::Device::Impl::runSchedule(Device *device, const SettingsTransaction transaction, const std::shared_ptr<std::atomic<bool>> cancel)
+{
+    //stable so that commands with equal times apply in queued order
+    std::vector<SettingsTransaction::Command> commands(transaction.commands());
+    std::stable_sort(commands.begin(), commands.end(),
+        [](const SettingsTransaction::Command &a, const SettingsTransaction::Command &b){return a.timeNs < b.timeNs;});
+
+    std::unique_lock<std::mutex> lock(scheduleMutex);
+    try
+    {
+        //without hardware time, follow the host clock from the current time
+        const bool hasTime = device->hasHardwareTime();
+        const long long timeNs0 = device->getHardwareTime();
+        const auto hostTime0 = std::chrono::steady_clock::now();
+
+        for (const auto &command : commands)
+        {
+            while (not *cancel)
+            {
+                lock.unlock();
+                const long long nowNs = hasTime?device->getHardwareTime():(timeNs0 +
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - hostTime0).count());
+                lock.lock();
+                const long long delta = command.timeNs - nowNs;
+                if (delta <= 0) break;
+
+                //bounded waits to track the hardware clock as it advances
+                const long long timeout = std::min<long long>(delta, 100000000);
+                scheduleCond.wait_for(lock, std::chrono::nanoseconds(timeout), [&cancel]{return bool(*cancel);});
+            }
+            if (*cancel) return;
+
+            lock.unlock();
+            try
+            {
+                device->applySetting(command);
+            }
+            catch (const std::exception &ex)
+            {
+                SoapySDR::logf(SOAPY_SDR_ERROR, "Device::scheduleSettings() command at %lld ns failed: %s", command.timeNs, ex.what());
+            }
+            lock.lock();
+
+            //a setter may have replaced this schedule, which then owns the count
+            if (not *cancel and numScheduled != 0) numScheduled--;
+        }
+    }
+    catch (const std::exception &ex)
+    {
+        SoapySDR::logf(SOAPY_SDR_ERROR, "Device::scheduleSettings() hardware time failed: %s", ex.what());
+        if (not *cancel) numScheduled = 0;
+    }
+}
+
 /*******************************************************************
  * Sensor API
  ******************************************************************/
@@ -653,6 +969,31 @@ std::string SoapySDR::Device::readSensor(const int, const size_t, const std::str
     return "";
 }
 
+SoapySDR::SensorSubscription *SoapySDR::Device::subscribeSensors(
+    const std::vector<SensorSubscription::Sensor> &sensors,
+    const double rate,
+    const SensorSubscription::Callback &callback)
+{
+    SensorPoller *poller = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_impl->sensorMutex);
+        if (not _impl->sensorPoller) _impl->sensorPoller.reset(new SensorPoller(this));
+        poller = _impl->sensorPoller.get();
+    }
+    return poller->subscribe(sensors, rate, callback);
+}
+
+void SoapySDR::Device::unsubscribeSensors(SensorSubscription *subscription)
+{
+    SensorPoller *poller = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(_impl->sensorMutex);
+        poller = _impl->sensorPoller.get();
+    }
+    if (poller == nullptr) delete subscription;
+    else poller->unsubscribe(subscription);
+}
+
 /*******************************************************************
  * Register API
  ******************************************************************/
@@ -681,14 +1022,28 @@ unsigned SoapySDR::Device::readRegister(const unsigned) const
     return 0;
 }
 
-void SoapySDR::Device::writeRegisters(const std::string &, const unsigned, const std::vector<unsigned> &)
+void SoapySDR::Device::writeRegisters(const std::string &name, const unsigned addr, const std::vector<unsigned> &value)
 {
-    return;
+    for (size_t i = 0; i < value.size(); i++) this->writeRegister(name, unsigned(addr+i), value[i]);
+}
+
+std::vector<unsigned> SoapySDR::Device::readRegisters(const std::string &name, const unsigned addr, size_t length) const
+{
+    std::vector<unsigned> value(length);
+    for (size_t i = 0; i < length; i++) value[i] = this->readRegister(name, unsigned(addr+i));
+    return value;
+}
+
+void SoapySDR::Device::writeRegisters(const std::string &name, const std::vector<std::pair<unsigned, unsigned>> &values)
+{
+    for (const auto &pair : values) this->writeRegister(name, pair.first, pair.second);
 }
 
-std::vector<unsigned> SoapySDR::Device::readRegisters(const std::string &, const unsigned, size_t length) const
+std::vector<unsigned> SoapySDR::Device::readRegisters(const std::string &name, const std::vector<unsigned> &addrs) const
 {
-    return std::vector<unsigned>(length, 0);
+    std::vector<unsigned> values(addrs.size());
+    for (size_t i = 0; i < addrs.size(); i++) values[i] = this->readRegister(name, addrs[i]);
+    return values;
 }
 
 /*******************************************************************
@@ -724,6 +1079,34 @@ std::string SoapySDR::Device::readSetting(const int, const size_t, const std::st
     return "";
 }
 
+void SoapySDR::Device::applySetting(const SettingsTransaction::Command &cmd)
+{
+    switch (cmd.type)
+    {
+    case SettingsTransaction::FREQUENCY:
+        if (cmd.name.empty()) this->setFrequency(cmd.direction, cmd.channel, cmd.value, cmd.args);
+        else this->setFrequency(cmd.direction, cmd.channel, cmd.name, cmd.value, cmd.args);
+        break;
+    case SettingsTransaction::GAIN:
+        if (cmd.name.empty()) this->setGain(cmd.direction, cmd.channel, cmd.value);
+        else this->setGain(cmd.direction, cmd.channel, cmd.name, cmd.value);
+        break;
+    case SettingsTransaction::BANDWIDTH: this->setBandwidth(cmd.direction, cmd.channel, cmd.value); break;
+    case SettingsTransaction::SAMPLE_RATE: this->setSampleRate(cmd.direction, cmd.channel, cmd.value); break;
+    case SettingsTransaction::ANTENNA:
+        this->setAntenna(cmd.direction, cmd.channel, cmd.text);
+        this->invalidateGainCache();
+        break;
+    case SettingsTransaction::SETTING: this->writeSetting(cmd.name, cmd.text); break;
+    case SettingsTransaction::CHANNEL_SETTING: this->writeSetting(cmd.direction, cmd.channel, cmd.name, cmd.text); break;
+    }
+}
+
+void SoapySDR::Device::commitSettings(const SettingsTransaction &transaction)
+{
+    for (const auto &cmd : transaction.commands()) this->applySetting(cmd);
+}
+
 /*******************************************************************
  * GPIO API
  ******************************************************************/
@@ -4,6 +4,7 @@
 
 #include "ErrorHelpers.hpp"
 #include "TypeHelpers.hpp"
+#include "ArenaHelpers.hpp"
 #include <SoapySDR/Device.h>
 #include <SoapySDR/Device.hpp>
 #include <algorithm>
@@ -213,6 +214,20 @@ int SoapySDRDevice_writeStream(SoapySDRDevice *device, SoapySDRStream *stream, c
     __SOAPY_SDR_C_CATCH_RET(SOAPY_SDR_STREAM_ERROR);
 }
 
+int SoapySDRDevice_readStreamBatch(SoapySDRDevice *device, SoapySDRStream *stream, void * const * const *buffs, const size_t numBuffs, const size_t numElems, size_t *elems, int *flags, long long *timeNs, const long timeoutUs)
+{
+    __SOAPY_SDR_C_TRY
+    return device->readStreamBatch(reinterpret_cast<SoapySDR::Stream *>(stream), buffs, numBuffs, numElems, elems, flags, timeNs, timeoutUs);
+    __SOAPY_SDR_C_CATCH_RET(SOAPY_SDR_STREAM_ERROR);
+}
+
+int SoapySDRDevice_writeStreamBatch(SoapySDRDevice *device, SoapySDRStream *stream, const void * const * const *buffs, const size_t numBuffs, const size_t *numElems, size_t *elems, int *flags, const long long *timeNs, const long timeoutUs)
+{
+    __SOAPY_SDR_C_TRY
+    return device->writeStreamBatch(reinterpret_cast<SoapySDR::Stream *>(stream), buffs, numBuffs, numElems, elems, flags, timeNs, timeoutUs);
+    __SOAPY_SDR_C_CATCH_RET(SOAPY_SDR_STREAM_ERROR);
+}
+
 int SoapySDRDevice_readStreamStatus(SoapySDRDevice *device, SoapySDRStream *stream, size_t *chanMask, int *flags, long long *timeNs, const long timeoutUs)
 {
     __SOAPY_SDR_C_TRY
@@ -220,6 +235,36 @@ int SoapySDRDevice_readStreamStatus(SoapySDRDevice *device, SoapySDRStream *stre
     __SOAPY_SDR_C_CATCH_RET(SOAPY_SDR_STREAM_ERROR);
 }
 
+int SoapySDRDevice_getStreamStats(SoapySDRDevice *device, SoapySDRStream *stream, SoapySDRStreamStats *stats)
+{
+    __SOAPY_SDR_C_TRY
+    SoapySDR::StreamStats s;
+    const int ret = device->getStreamStats(reinterpret_cast<SoapySDR::Stream *>(stream), s);
+    stats->numCalls = s.numCalls;
+    stats->numElems = s.numElems;
+    stats->numOverflows = s.numOverflows;
+    stats->numUnderflows = s.numUnderflows;
+    stats->numTimeErrors = s.numTimeErrors;
+    stats->numDropped = s.numDropped;
+    stats->maxLatencyNs = s.maxLatencyNs;
+    stats->avgLatencyNs = s.avgLatencyNs;
+    stats->bufferFill = s.bufferFill;
+    stats->numTimestamps = s.numTimestamps;
+    stats->minTimeLatencyNs = s.minTimeLatencyNs;
+    stats->avgTimeLatencyNs = s.avgTimeLatencyNs;
+    stats->p99TimeLatencyNs = s.p99TimeLatencyNs;
+    stats->maxTimeLatencyNs = s.maxTimeLatencyNs;
+    return ret;
+    __SOAPY_SDR_C_CATCH_RET(SOAPY_SDR_STREAM_ERROR);
+}
+
+int SoapySDRDevice_getStreamPollHandle(SoapySDRDevice *device, SoapySDRStream *stream, intptr_t *handle)
+{
+    __SOAPY_SDR_C_TRY
+    return device->getStreamPollHandle(reinterpret_cast<SoapySDR::Stream *>(stream), *handle);
+    __SOAPY_SDR_C_CATCH_RET(SOAPY_SDR_STREAM_ERROR);
+}
+
 /*******************************************************************
  * Direct buffer access API
  ******************************************************************/
@@ -282,6 +327,70 @@ void SoapySDRDevice_releaseWriteBuffer(SoapySDRDevice *device,
     __SOAPY_SDR_C_CATCH_RET(SoapySDRVoidRet);
 }
 
+SoapySDRStreamSubscription *SoapySDRDevice_subscribeStream(SoapySDRDevice *device, SoapySDRStream *stream, const size_t numChans, SoapySDRStreamCallback callback, void *userData)
+{
+    __SOAPY_SDR_C_TRY
+    SoapySDR::StreamSubscription::Callback handler;
+    if (callback != nullptr) handler = [callback, userData](const void * const *buffs, const int ret, const int flags, const long long timeNs)
+    {
+        callback(buffs, ret, flags, timeNs, userData);
+    };
+    return reinterpret_cast<SoapySDRStreamSubscription *>(device->subscribeStream(reinterpret_cast<SoapySDR::Stream *>(stream), numChans, handler));
+    __SOAPY_SDR_C_CATCH_RET(nullptr);
+}
+
+int SoapySDRDevice_unsubscribeStream(SoapySDRDevice *device, SoapySDRStreamSubscription *subscription)
+{
+    __SOAPY_SDR_C_TRY
+    device->unsubscribeStream(reinterpret_cast<SoapySDR::StreamSubscription *>(subscription));
+    __SOAPY_SDR_C_CATCH
+}
+
+/*******************************************************************
+ * Stream fast path API
+ ******************************************************************/
+int SoapySDRDevice_readStreamFast(SoapySDRDevice *device, SoapySDRStream *stream, void * const *buffs, const size_t numElems, int *flags, long long *timeNs, const long timeoutUs)
+{
+    __SOAPY_SDR_C_TRY_FAST
+    return device->readStream(reinterpret_cast<SoapySDR::Stream *>(stream), buffs, numElems, *flags, *timeNs, timeoutUs);
+    __SOAPY_SDR_C_CATCH_RET(SOAPY_SDR_STREAM_ERROR);
+}
+
+int SoapySDRDevice_writeStreamFast(SoapySDRDevice *device, SoapySDRStream *stream, const void * const *buffs, const size_t numElems, int *flags, const long long timeNs, const long timeoutUs)
+{
+    __SOAPY_SDR_C_TRY_FAST
+    return device->writeStream(reinterpret_cast<SoapySDR::Stream *>(stream), buffs, numElems, *flags, timeNs, timeoutUs);
+    __SOAPY_SDR_C_CATCH_RET(SOAPY_SDR_STREAM_ERROR);
+}
+
+int SoapySDRDevice_acquireReadBufferFast(SoapySDRDevice *device, SoapySDRStream *stream, size_t *handle, const void **buffs, int *flags, long long *timeNs, const long timeoutUs)
+{
+    __SOAPY_SDR_C_TRY_FAST
+    return device->acquireReadBuffer(reinterpret_cast<SoapySDR::Stream *>(stream), *handle, buffs, *flags, *timeNs, timeoutUs);
+    __SOAPY_SDR_C_CATCH_RET(SOAPY_SDR_STREAM_ERROR);
+}
+
+void SoapySDRDevice_releaseReadBufferFast(SoapySDRDevice *device, SoapySDRStream *stream, const size_t handle)
+{
+    __SOAPY_SDR_C_TRY_FAST
+    return device->releaseReadBuffer(reinterpret_cast<SoapySDR::Stream *>(stream), handle);
+    __SOAPY_SDR_C_CATCH_RET(SoapySDRVoidRet);
+}
+
+int SoapySDRDevice_acquireWriteBufferFast(SoapySDRDevice *device, SoapySDRStream *stream, size_t *handle, void **buffs, const long timeoutUs)
+{
+    __SOAPY_SDR_C_TRY_FAST
+    return device->acquireWriteBuffer(reinterpret_cast<SoapySDR::Stream *>(stream), *handle, buffs, timeoutUs);
+    __SOAPY_SDR_C_CATCH_RET(SOAPY_SDR_STREAM_ERROR);
+}
+
+void SoapySDRDevice_releaseWriteBufferFast(SoapySDRDevice *device, SoapySDRStream *stream, const size_t handle, const size_t numElems, int *flags, const long long timeNs)
+{
+    __SOAPY_SDR_C_TRY_FAST
+    return device->releaseWriteBuffer(reinterpret_cast<SoapySDR::Stream *>(stream), handle, numElems, *flags, timeNs);
+    __SOAPY_SDR_C_CATCH_RET(SoapySDRVoidRet);
+}
+
 /*******************************************************************
  * Antenna API
  ******************************************************************/
@@ -472,6 +581,20 @@ SoapySDRRange SoapySDRDevice_getGainElementRange(const SoapySDRDevice *device, c
     __SOAPY_SDR_C_CATCH_RET(SoapySDRRangeNAN);
 }
 
+int SoapySDRDevice_enableGainCache(SoapySDRDevice *device, const bool enable)
+{
+    __SOAPY_SDR_C_TRY
+    device->enableGainCache(enable);
+    __SOAPY_SDR_C_CATCH
+}
+
+int SoapySDRDevice_invalidateGainCache(SoapySDRDevice *device)
+{
+    __SOAPY_SDR_C_TRY
+    device->invalidateGainCache();
+    __SOAPY_SDR_C_CATCH
+}
+
 /*******************************************************************
  * Frequency API
  ******************************************************************/
@@ -713,6 +836,14 @@ char **SoapySDRDevice_listSensors(const SoapySDRDevice *device, size_t *length)
     __SOAPY_SDR_C_CATCH_RET(nullptr);
 }
 
+char **SoapySDRDevice_listSensorsArena(const SoapySDRDevice *device, size_t *length)
+{
+    *length = 0;
+    __SOAPY_SDR_C_TRY
+    return toStrArrayArena(device->listSensors(), length);
+    __SOAPY_SDR_C_CATCH_RET(nullptr);
+}
+
 SoapySDRArgInfo SoapySDRDevice_getSensorInfo(const SoapySDRDevice *device, const char *key)
 {
     __SOAPY_SDR_C_TRY
@@ -735,6 +866,14 @@ char **SoapySDRDevice_listChannelSensors(const SoapySDRDevice *device, const int
     __SOAPY_SDR_C_CATCH_RET(nullptr);
 }
 
+char **SoapySDRDevice_listChannelSensorsArena(const SoapySDRDevice *device, const int direction, const size_t channel, size_t *length)
+{
+    *length = 0;
+    __SOAPY_SDR_C_TRY
+    return toStrArrayArena(device->listSensors(direction, channel), length);
+    __SOAPY_SDR_C_CATCH_RET(nullptr);
+}
+
 SoapySDRArgInfo SoapySDRDevice_getChannelSensorInfo(const SoapySDRDevice *device, const int direction, const size_t channel, const char *key)
 {
     __SOAPY_SDR_C_TRY
@@ -749,6 +888,52 @@ char *SoapySDRDevice_readChannelSensor(const SoapySDRDevice *device, const int d
     __SOAPY_SDR_C_CATCH_RET(nullptr);
 }
 
+static void toSensorValue(const SoapySDR::SensorSubscription::Value &in, SoapySDRSensorValue &out)
+{
+    out.type = int(in.type);
+    out.valid = in.valid;
+    out.boolValue = in.boolValue;
+    out.intValue = in.intValue;
+    out.floatValue = in.floatValue;
+}
+
+SoapySDRSensorSubscription *SoapySDRDevice_subscribeSensors(SoapySDRDevice *device, const SoapySDRSensor *sensors, const size_t length, const double rate, SoapySDRSensorCallback callback, void *userData)
+{
+    __SOAPY_SDR_C_TRY
+    std::vector<SoapySDR::SensorSubscription::Sensor> sensorList;
+    for (size_t i = 0; i < length; i++)
+    {
+        if (sensors[i].isChannel) sensorList.emplace_back(sensors[i].direction, sensors[i].channel, sensors[i].key);
+        else sensorList.emplace_back(sensors[i].key);
+    }
+
+    SoapySDR::SensorSubscription::Callback handler;
+    if (callback != nullptr) handler = [callback, userData](const std::vector<SoapySDR::SensorSubscription::Value> &values)
+    {
+        std::vector<SoapySDRSensorValue> out(values.size());
+        for (size_t i = 0; i < values.size(); i++) toSensorValue(values[i], out[i]);
+        callback(out.data(), out.size(), userData);
+    };
+    return reinterpret_cast<SoapySDRSensorSubscription *>(device->subscribeSensors(sensorList, rate, handler));
+    __SOAPY_SDR_C_CATCH_RET(nullptr);
+}
+
+int SoapySDRDevice_unsubscribeSensors(SoapySDRDevice *device, SoapySDRSensorSubscription *subscription)
+{
+    __SOAPY_SDR_C_TRY
+    device->unsubscribeSensors(reinterpret_cast<SoapySDR::SensorSubscription *>(subscription));
+    __SOAPY_SDR_C_CATCH
+}
+
+size_t SoapySDRSensorSubscription_snapshot(const SoapySDRSensorSubscription *subscription, SoapySDRSensorValue *values, const size_t length)
+{
+    const auto snapshot = reinterpret_cast<const SoapySDR::SensorSubscription *>(subscription)->snapshot();
+    if (not snapshot) return 0;
+    const size_t n = std::min(length, snapshot->size());
+    for (size_t i = 0; i < n; i++) toSensorValue((*snapshot)[i], values[i]);
+    return n;
+}
+
 /*******************************************************************
  * Register API
  ******************************************************************/
@@ -791,6 +976,23 @@ unsigned *SoapySDRDevice_readRegisters(const SoapySDRDevice *device, const char
     __SOAPY_SDR_C_CATCH_RET(nullptr);
 }
 
+int SoapySDRDevice_writeRegisterList(SoapySDRDevice *device, const char *name, const unsigned *addrs, const unsigned *values, const size_t length)
+{
+    __SOAPY_SDR_C_TRY
+    std::vector<std::pair<unsigned, unsigned>> pairs(length);
+    for (size_t i = 0; i < length; i++) pairs[i] = std::make_pair(addrs[i], values[i]);
+    device->writeRegisters(name, pairs);
+    __SOAPY_SDR_C_CATCH
+}
+
+int SoapySDRDevice_readRegisterList(const SoapySDRDevice *device, const char *name, const unsigned *addrs, unsigned *values, const size_t length)
+{
+    __SOAPY_SDR_C_TRY
+    const auto result = device->readRegisters(name, toNumericVector(addrs, length));
+    std::copy(result.begin(), result.end(), values);
+    __SOAPY_SDR_C_CATCH
+}
+
 /*******************************************************************
  * Settings API
  ******************************************************************/
@@ -802,6 +1004,14 @@ SoapySDRArgInfo *SoapySDRDevice_getSettingInfo(const SoapySDRDevice *device, siz
     __SOAPY_SDR_C_CATCH_RET(nullptr);
 }
 
+SoapySDRArgInfo *SoapySDRDevice_getSettingInfoArena(const SoapySDRDevice *device, size_t *length)
+{
+    *length = 0;
+    __SOAPY_SDR_C_TRY
+    return toArgInfoListArena(device->getSettingInfo(), length);
+    __SOAPY_SDR_C_CATCH_RET(nullptr);
+}
+
 int SoapySDRDevice_writeSetting(SoapySDRDevice *device, const char *key, const char *value)
 {
     __SOAPY_SDR_C_TRY
@@ -824,6 +1034,14 @@ SoapySDRArgInfo *SoapySDRDevice_getChannelSettingInfo(const SoapySDRDevice *devi
     __SOAPY_SDR_C_CATCH_RET(nullptr);
 }
 
+SoapySDRArgInfo *SoapySDRDevice_getChannelSettingInfoArena(const SoapySDRDevice *device, const int direction, const size_t channel, size_t *length)
+{
+    *length = 0;
+    __SOAPY_SDR_C_TRY
+    return toArgInfoListArena(device->getSettingInfo(direction, channel), length);
+    __SOAPY_SDR_C_CATCH_RET(nullptr);
+}
+
 int SoapySDRDevice_writeChannelSetting(SoapySDRDevice *device, const int direction, const size_t channel, const char *key, const char *value)
 {
     __SOAPY_SDR_C_TRY
@@ -838,6 +1056,103 @@ char *SoapySDRDevice_readChannelSetting(const SoapySDRDevice *device, const int
     __SOAPY_SDR_C_CATCH_RET(nullptr);
 }
 
+struct SoapySDRSettingsTransaction : SoapySDR::SettingsTransaction {};
+
+SoapySDRSettingsTransaction *SoapySDRSettingsTransaction_new(void)
+{
+    __SOAPY_SDR_C_TRY
+    return new SoapySDRSettingsTransaction();
+    __SOAPY_SDR_C_CATCH_RET(nullptr);
+}
+
+void SoapySDRSettingsTransaction_free(SoapySDRSettingsTransaction *transaction)
+{
+    delete transaction;
+}
+
+void SoapySDRSettingsTransaction_clear(SoapySDRSettingsTransaction *transaction)
+{
+    transaction->clear();
+}
+
+void SoapySDRSettingsTransaction_setCommandTime(SoapySDRSettingsTransaction *transaction, const long long timeNs)
+{
+    transaction->setCommandTime(timeNs);
+}
+
+void SoapySDRSettingsTransaction_setFrequency(SoapySDRSettingsTransaction *transaction, const int direction, const size_t channel, const double frequency, const SoapySDRKwargs *args)
+{
+    transaction->setFrequency(direction, channel, frequency, toKwargs(args));
+}
+
+void SoapySDRSettingsTransaction_setFrequencyComponent(SoapySDRSettingsTransaction *transaction, const int direction, const size_t channel, const char *name, const double frequency, const SoapySDRKwargs *args)
+{
+    transaction->setFrequency(direction, channel, name, frequency, toKwargs(args));
+}
+
+void SoapySDRSettingsTransaction_setGain(SoapySDRSettingsTransaction *transaction, const int direction, const size_t channel, const double value)
+{
+    transaction->setGain(direction, channel, value);
+}
+
+void SoapySDRSettingsTransaction_setGainElement(SoapySDRSettingsTransaction *transaction, const int direction, const size_t channel, const char *name, const double value)
+{
+    transaction->setGain(direction, channel, name, value);
+}
+
+void SoapySDRSettingsTransaction_setBandwidth(SoapySDRSettingsTransaction *transaction, const int direction, const size_t channel, const double bw)
+{
+    transaction->setBandwidth(direction, channel, bw);
+}
+
+void SoapySDRSettingsTransaction_setSampleRate(SoapySDRSettingsTransaction *transaction, const int direction, const size_t channel, const double rate)
+{
+    transaction->setSampleRate(direction, channel, rate);
+}
+
+void SoapySDRSettingsTransaction_setAntenna(SoapySDRSettingsTransaction *transaction, const int direction, const size_t channel, const char *name)
+{
+    transaction->setAntenna(direction, channel, name);
+}
+
+void SoapySDRSettingsTransaction_writeSetting(SoapySDRSettingsTransaction *transaction, const char *key, const char *value)
+{
+    transaction->writeSetting(key, value);
+}
+
+void SoapySDRSettingsTransaction_writeChannelSetting(SoapySDRSettingsTransaction *transaction, const int direction, const size_t channel, const char *key, const char *value)
+{
+    transaction->writeSetting(direction, channel, key, value);
+}
+
+int SoapySDRDevice_commitSettings(SoapySDRDevice *device, const SoapySDRSettingsTransaction *transaction)
+{
+    __SOAPY_SDR_C_TRY
+    device->commitSettings(*transaction);
+    __SOAPY_SDR_C_CATCH
+}
+
+int SoapySDRDevice_scheduleSettings(SoapySDRDevice *device, const SoapySDRSettingsTransaction *transaction)
+{
+    __SOAPY_SDR_C_TRY
+    device->scheduleSettings(*transaction);
+    __SOAPY_SDR_C_CATCH
+}
+
+int SoapySDRDevice_cancelScheduledSettings(SoapySDRDevice *device)
+{
+    __SOAPY_SDR_C_TRY
+    device->cancelScheduledSettings();
+    __SOAPY_SDR_C_CATCH
+}
+
+size_t SoapySDRDevice_getNumScheduledSettings(const SoapySDRDevice *device)
+{
+    __SOAPY_SDR_C_TRY
+    return device->getNumScheduledSettings();
+    __SOAPY_SDR_C_CATCH_RET(0);
+}
+
 /*******************************************************************
  * GPIO API
  ******************************************************************/
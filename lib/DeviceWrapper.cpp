@@ -0,0 +1,712 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include "DeviceWrapper.hpp"
+
+SoapySDR::DeviceWrapper::DeviceWrapper(Device *device):
+    _device(device)
+{
+    return;
+}
+
+SoapySDR::DeviceWrapper::~DeviceWrapper(void)
+{
+    //stop the default schedule before the driver destructor runs
+    _device->cancelScheduledSettings();
+    delete _device;
+}
+
+/***********************************************************************
+ * Identification API
+ **********************************************************************/
+std::string SoapySDR::DeviceWrapper::getDriverKey(void) const
+{
+    return _device->getDriverKey();
+}
+
+std::string SoapySDR::DeviceWrapper::getHardwareKey(void) const
+{
+    return _device->getHardwareKey();
+}
+
+SoapySDR::Kwargs SoapySDR::DeviceWrapper::getHardwareInfo(void) const
+{
+    return _device->getHardwareInfo();
+}
+
+/***********************************************************************
+ * Channels API
+ **********************************************************************/
+void SoapySDR::DeviceWrapper::setFrontendMapping(const int direction, const std::string &mapping)
+{
+    _device->setFrontendMapping(direction, mapping);
+    _device->invalidateGainCache();
+}
+
+std::string SoapySDR::DeviceWrapper::getFrontendMapping(const int direction) const
+{
+    return _device->getFrontendMapping(direction);
+}
+
+size_t SoapySDR::DeviceWrapper::getNumChannels(const int direction) const
+{
+    return _device->getNumChannels(direction);
+}
+
+SoapySDR::Kwargs SoapySDR::DeviceWrapper::getChannelInfo(const int direction, const size_t channel) const
+{
+    return _device->getChannelInfo(direction, channel);
+}
+
+bool SoapySDR::DeviceWrapper::getFullDuplex(const int direction, const size_t channel) const
+{
+    return _device->getFullDuplex(direction, channel);
+}
+
+/***********************************************************************
+ * Stream API
+ **********************************************************************/
+std::vector<std::string> SoapySDR::DeviceWrapper::getStreamFormats(const int direction, const size_t channel) const
+{
+    return _device->getStreamFormats(direction, channel);
+}
+
+std::string SoapySDR::DeviceWrapper::getNativeStreamFormat(const int direction, const size_t channel, double &fullScale) const
+{
+    return _device->getNativeStreamFormat(direction, channel, fullScale);
+}
+
+SoapySDR::ArgInfoList SoapySDR::DeviceWrapper::getStreamArgsInfo(const int direction, const size_t channel) const
+{
+    return _device->getStreamArgsInfo(direction, channel);
+}
+
+SoapySDR::Stream *SoapySDR::DeviceWrapper::setupStream(const int direction, const std::string &format, const std::vector<size_t> &channels, const Kwargs &args)
+{
+    return _device->setupStream(direction, format, channels, args);
+}
+
+void SoapySDR::DeviceWrapper::closeStream(Stream *stream)
+{
+    _device->closeStream(stream);
+}
+
+size_t SoapySDR::DeviceWrapper::getStreamMTU(Stream *stream) const
+{
+    return _device->getStreamMTU(stream);
+}
+
+int SoapySDR::DeviceWrapper::activateStream(Stream *stream, const int flags, const long long timeNs, const size_t numElems)
+{
+    return _device->activateStream(stream, flags, timeNs, numElems);
+}
+
+int SoapySDR::DeviceWrapper::deactivateStream(Stream *stream, const int flags, const long long timeNs)
+{
+    return _device->deactivateStream(stream, flags, timeNs);
+}
+
+int SoapySDR::DeviceWrapper::readStream(Stream *stream, void * const *buffs, const size_t numElems, int &flags, long long &timeNs, const long timeoutUs)
+{
+    return _device->readStream(stream, buffs, numElems, flags, timeNs, timeoutUs);
+}
+
+int SoapySDR::DeviceWrapper::writeStream(Stream *stream, const void * const *buffs, const size_t numElems, int &flags, const long long timeNs, const long timeoutUs)
+{
+    return _device->writeStream(stream, buffs, numElems, flags, timeNs, timeoutUs);
+}
+
+int SoapySDR::DeviceWrapper::readStreamBatch(Stream *stream, void * const * const *buffs, const size_t numBuffs, const size_t numElems, size_t *elems, int *flags, long long *timeNs, const long timeoutUs)
+{
+    return _device->readStreamBatch(stream, buffs, numBuffs, numElems, elems, flags, timeNs, timeoutUs);
+}
+
+int SoapySDR::DeviceWrapper::writeStreamBatch(Stream *stream, const void * const * const *buffs, const size_t numBuffs, const size_t *numElems, size_t *elems, int *flags, const long long *timeNs, const long timeoutUs)
+{
+    return _device->writeStreamBatch(stream, buffs, numBuffs, numElems, elems, flags, timeNs, timeoutUs);
+}
+
+int SoapySDR::DeviceWrapper::getStreamStats(Stream *stream, StreamStats &stats)
+{
+    return _device->getStreamStats(stream, stats);
+}
+
+int SoapySDR::DeviceWrapper::getStreamPollHandle(Stream *stream, intptr_t &handle)
+{
+    return _device->getStreamPollHandle(stream, handle);
+}
+
+int SoapySDR::DeviceWrapper::readStreamStatus(Stream *stream, size_t &chanMask, int &flags, long long &timeNs, const long timeoutUs)
+{
+    return _device->readStreamStatus(stream, chanMask, flags, timeNs, timeoutUs);
+}
+
+/***********************************************************************
+ * Direct buffer access API
+ **********************************************************************/
+size_t SoapySDR::DeviceWrapper::getNumDirectAccessBuffers(Stream *stream)
+{
+    return _device->getNumDirectAccessBuffers(stream);
+}
+
+int SoapySDR::DeviceWrapper::getDirectAccessBufferAddrs(Stream *stream, const size_t handle, void **buffs)
+{
+    return _device->getDirectAccessBufferAddrs(stream, handle, buffs);
+}
+
+int SoapySDR::DeviceWrapper::acquireReadBuffer(Stream *stream, size_t &handle, const void **buffs, int &flags, long long &timeNs, const long timeoutUs)
+{
+    return _device->acquireReadBuffer(stream, handle, buffs, flags, timeNs, timeoutUs);
+}
+
+void SoapySDR::DeviceWrapper::releaseReadBuffer(Stream *stream, const size_t handle)
+{
+    _device->releaseReadBuffer(stream, handle);
+}
+
+int SoapySDR::DeviceWrapper::acquireWriteBuffer(Stream *stream, size_t &handle, void **buffs, const long timeoutUs)
+{
+    return _device->acquireWriteBuffer(stream, handle, buffs, timeoutUs);
+}
+
+void SoapySDR::DeviceWrapper::releaseWriteBuffer(Stream *stream, const size_t handle, const size_t numElems, int &flags, const long long timeNs)
+{
+    _device->releaseWriteBuffer(stream, handle, numElems, flags, timeNs);
+}
+
+SoapySDR::StreamSubscription *SoapySDR::DeviceWrapper::subscribeStream(Stream *stream, const size_t numChans, const StreamSubscription::Callback &callback)
+{
+    return _device->subscribeStream(stream, numChans, callback);
+}
+
+void SoapySDR::DeviceWrapper::unsubscribeStream(StreamSubscription *subscription)
+{
+    _device->unsubscribeStream(subscription);
+}
+
+/***********************************************************************
+ * Antenna API
+ **********************************************************************/
+std::vector<std::string> SoapySDR::DeviceWrapper::listAntennas(const int direction, const size_t channel) const
+{
+    return _device->listAntennas(direction, channel);
+}
+
+void SoapySDR::DeviceWrapper::setAntenna(const int direction, const size_t channel, const std::string &name)
+{
+    _device->setAntenna(direction, channel, name);
+    _device->invalidateGainCache();
+}
+
+std::string SoapySDR::DeviceWrapper::getAntenna(const int direction, const size_t channel) const
+{
+    return _device->getAntenna(direction, channel);
+}
+
+/***********************************************************************
+ * Frontend corrections API
+ **********************************************************************/
+bool SoapySDR::DeviceWrapper::hasDCOffsetMode(const int direction, const size_t channel) const
+{
+    return _device->hasDCOffsetMode(direction, channel);
+}
+
+void SoapySDR::DeviceWrapper::setDCOffsetMode(const int direction, const size_t channel, const bool automatic)
+{
+    _device->setDCOffsetMode(direction, channel, automatic);
+}
+
+bool SoapySDR::DeviceWrapper::getDCOffsetMode(const int direction, const size_t channel) const
+{
+    return _device->getDCOffsetMode(direction, channel);
+}
+
+bool SoapySDR::DeviceWrapper::hasDCOffset(const int direction, const size_t channel) const
+{
+    return _device->hasDCOffset(direction, channel);
+}
+
+void SoapySDR::DeviceWrapper::setDCOffset(const int direction, const size_t channel, const std::complex<double> &offset)
+{
+    _device->setDCOffset(direction, channel, offset);
+}
+
+std::complex<double> SoapySDR::DeviceWrapper::getDCOffset(const int direction, const size_t channel) const
+{
+    return _device->getDCOffset(direction, channel);
+}
+
+bool SoapySDR::DeviceWrapper::hasIQBalance(const int direction, const size_t channel) const
+{
+    return _device->hasIQBalance(direction, channel);
+}
+
+void SoapySDR::DeviceWrapper::setIQBalance(const int direction, const size_t channel, const std::complex<double> &balance)
+{
+    _device->setIQBalance(direction, channel, balance);
+}
+
+std::complex<double> SoapySDR::DeviceWrapper::getIQBalance(const int direction, const size_t channel) const
+{
+    return _device->getIQBalance(direction, channel);
+}
+
+bool SoapySDR::DeviceWrapper::hasFrequencyCorrection(const int direction, const size_t channel) const
+{
+    return _device->hasFrequencyCorrection(direction, channel);
+}
+
+void SoapySDR::DeviceWrapper::setFrequencyCorrection(const int direction, const size_t channel, const double value)
+{
+    _device->setFrequencyCorrection(direction, channel, value);
+}
+
+double SoapySDR::DeviceWrapper::getFrequencyCorrection(const int direction, const size_t channel) const
+{
+    return _device->getFrequencyCorrection(direction, channel);
+}
+
+/***********************************************************************
+ * Gain API
+ **********************************************************************/
+std::vector<std::string> SoapySDR::DeviceWrapper::listGains(const int direction, const size_t channel) const
+{
+    return _device->listGains(direction, channel);
+}
+
+bool SoapySDR::DeviceWrapper::hasGainMode(const int direction, const size_t channel) const
+{
+    return _device->hasGainMode(direction, channel);
+}
+
+void SoapySDR::DeviceWrapper::setGainMode(const int direction, const size_t channel, const bool automatic)
+{
+    _device->setGainMode(direction, channel, automatic);
+    _device->invalidateGainCache();
+}
+
+bool SoapySDR::DeviceWrapper::getGainMode(const int direction, const size_t channel) const
+{
+    return _device->getGainMode(direction, channel);
+}
+
+void SoapySDR::DeviceWrapper::setGain(const int direction, const size_t channel, const double value)
+{
+    _device->setGain(direction, channel, value);
+}
+
+void SoapySDR::DeviceWrapper::setGain(const int direction, const size_t channel, const std::string &name, const double value)
+{
+    _device->setGain(direction, channel, name, value);
+}
+
+double SoapySDR::DeviceWrapper::getGain(const int direction, const size_t channel) const
+{
+    return _device->getGain(direction, channel);
+}
+
+double SoapySDR::DeviceWrapper::getGain(const int direction, const size_t channel, const std::string &name) const
+{
+    return _device->getGain(direction, channel, name);
+}
+
+SoapySDR::Range SoapySDR::DeviceWrapper::getGainRange(const int direction, const size_t channel) const
+{
+    return _device->getGainRange(direction, channel);
+}
+
+SoapySDR::Range SoapySDR::DeviceWrapper::getGainRange(const int direction, const size_t channel, const std::string &name) const
+{
+    return _device->getGainRange(direction, channel, name);
+}
+
+void SoapySDR::DeviceWrapper::enableGainCache(const bool enable)
+{
+    _device->enableGainCache(enable);
+}
+
+void SoapySDR::DeviceWrapper::invalidateGainCache(void)
+{
+    _device->invalidateGainCache();
+}
+
+/***********************************************************************
+ * Frequency API
+ **********************************************************************/
+void SoapySDR::DeviceWrapper::setFrequency(const int direction, const size_t channel, const double frequency, const Kwargs &args)
+{
+    _device->setFrequency(direction, channel, frequency, args);
+}
+
+void SoapySDR::DeviceWrapper::setFrequency(const int direction, const size_t channel, const std::string &name, const double frequency, const Kwargs &args)
+{
+    _device->setFrequency(direction, channel, name, frequency, args);
+}
+
+double SoapySDR::DeviceWrapper::getFrequency(const int direction, const size_t channel) const
+{
+    return _device->getFrequency(direction, channel);
+}
+
+double SoapySDR::DeviceWrapper::getFrequency(const int direction, const size_t channel, const std::string &name) const
+{
+    return _device->getFrequency(direction, channel, name);
+}
+
+std::vector<std::string> SoapySDR::DeviceWrapper::listFrequencies(const int direction, const size_t channel) const
+{
+    return _device->listFrequencies(direction, channel);
+}
+
+SoapySDR::RangeList SoapySDR::DeviceWrapper::getFrequencyRange(const int direction, const size_t channel) const
+{
+    return _device->getFrequencyRange(direction, channel);
+}
+
+SoapySDR::RangeList SoapySDR::DeviceWrapper::getFrequencyRange(const int direction, const size_t channel, const std::string &name) const
+{
+    return _device->getFrequencyRange(direction, channel, name);
+}
+
+SoapySDR::ArgInfoList SoapySDR::DeviceWrapper::getFrequencyArgsInfo(const int direction, const size_t channel) const
+{
+    return _device->getFrequencyArgsInfo(direction, channel);
+}
+
+/***********************************************************************
+ * Sample Rate API
+ **********************************************************************/
+void SoapySDR::DeviceWrapper::setSampleRate(const int direction, const size_t channel, const double rate)
+{
+    _device->setSampleRate(direction, channel, rate);
+}
+
+double SoapySDR::DeviceWrapper::getSampleRate(const int direction, const size_t channel) const
+{
+    return _device->getSampleRate(direction, channel);
+}
+
+std::vector<double> SoapySDR::DeviceWrapper::listSampleRates(const int direction, const size_t channel) const
+{
+    return _device->listSampleRates(direction, channel);
+}
+
+SoapySDR::RangeList SoapySDR::DeviceWrapper::getSampleRateRange(const int direction, const size_t channel) const
+{
+    return _device->getSampleRateRange(direction, channel);
+}
+
+/***********************************************************************
+ * Bandwidth API
+ **********************************************************************/
+void SoapySDR::DeviceWrapper::setBandwidth(const int direction, const size_t channel, const double bw)
+{
+    _device->setBandwidth(direction, channel, bw);
+}
+
+double SoapySDR::DeviceWrapper::getBandwidth(const int direction, const size_t channel) const
+{
+    return _device->getBandwidth(direction, channel);
+}
+
+std::vector<double> SoapySDR::DeviceWrapper::listBandwidths(const int direction, const size_t channel) const
+{
+    return _device->listBandwidths(direction, channel);
+}
+
+SoapySDR::RangeList SoapySDR::DeviceWrapper::getBandwidthRange(const int direction, const size_t channel) const
+{
+    return _device->getBandwidthRange(direction, channel);
+}
+
+/***********************************************************************
+ * Clocking API
+ **********************************************************************/
+void SoapySDR::DeviceWrapper::setMasterClockRate(const double rate)
+{
+    _device->setMasterClockRate(rate);
+}
+
+double SoapySDR::DeviceWrapper::getMasterClockRate(void) const
+{
+    return _device->getMasterClockRate();
+}
+
+SoapySDR::RangeList SoapySDR::DeviceWrapper::getMasterClockRates(void) const
+{
+    return _device->getMasterClockRates();
+}
+
+std::vector<std::string> SoapySDR::DeviceWrapper::listClockSources(void) const
+{
+    return _device->listClockSources();
+}
+
+void SoapySDR::DeviceWrapper::setClockSource(const std::string &source)
+{
+    _device->setClockSource(source);
+}
+
+std::string SoapySDR::DeviceWrapper::getClockSource(void) const
+{
+    return _device->getClockSource();
+}
+
+/***********************************************************************
+ * Time API
+ **********************************************************************/
+std::vector<std::string> SoapySDR::DeviceWrapper::listTimeSources(void) const
+{
+    return _device->listTimeSources();
+}
+
+void SoapySDR::DeviceWrapper::setTimeSource(const std::string &source)
+{
+    _device->setTimeSource(source);
+}
+
+std::string SoapySDR::DeviceWrapper::getTimeSource(void) const
+{
+    return _device->getTimeSource();
+}
+
+bool SoapySDR::DeviceWrapper::hasHardwareTime(const std::string &what) const
+{
+    return _device->hasHardwareTime(what);
+}
+
+long long SoapySDR::DeviceWrapper::getHardwareTime(const std::string &what) const
+{
+    return _device->getHardwareTime(what);
+}
+
+void SoapySDR::DeviceWrapper::setHardwareTime(const long long timeNs, const std::string &what)
+{
+    _device->setHardwareTime(timeNs, what);
+}
+
+void SoapySDR::DeviceWrapper::setCommandTime(const long long timeNs, const std::string &what)
+{
+    _device->setCommandTime(timeNs, what);
+}
+
+void SoapySDR::DeviceWrapper::scheduleSettings(const SettingsTransaction &transaction)
+{
+    _device->scheduleSettings(transaction);
+}
+
+void SoapySDR::DeviceWrapper::cancelScheduledSettings(void)
+{
+    _device->cancelScheduledSettings();
+}
+
+size_t SoapySDR::DeviceWrapper::getNumScheduledSettings(void) const
+{
+    return _device->getNumScheduledSettings();
+}
+
+/***********************************************************************
+ * Sensor API
+ **********************************************************************/
+std::vector<std::string> SoapySDR::DeviceWrapper::listSensors(void) const
+{
+    return _device->listSensors();
+}
+
+SoapySDR::ArgInfo SoapySDR::DeviceWrapper::getSensorInfo(const std::string &key) const
+{
+    return _device->getSensorInfo(key);
+}
+
+std::string SoapySDR::DeviceWrapper::readSensor(const std::string &key) const
+{
+    return _device->readSensor(key);
+}
+
+std::vector<std::string> SoapySDR::DeviceWrapper::listSensors(const int direction, const size_t channel) const
+{
+    return _device->listSensors(direction, channel);
+}
+
+SoapySDR::ArgInfo SoapySDR::DeviceWrapper::getSensorInfo(const int direction, const size_t channel, const std::string &key) const
+{
+    return _device->getSensorInfo(direction, channel, key);
+}
+
+std::string SoapySDR::DeviceWrapper::readSensor(const int direction, const size_t channel, const std::string &key) const
+{
+    return _device->readSensor(direction, channel, key);
+}
+
+SoapySDR::SensorSubscription *SoapySDR::DeviceWrapper::subscribeSensors(const std::vector<SensorSubscription::Sensor> &sensors, const double rate, const SensorSubscription::Callback &callback)
+{
+    return _device->subscribeSensors(sensors, rate, callback);
+}
+
+void SoapySDR::DeviceWrapper::unsubscribeSensors(SensorSubscription *subscription)
+{
+    _device->unsubscribeSensors(subscription);
+}
+
+/***********************************************************************
+ * Register API
+ **********************************************************************/
+std::vector<std::string> SoapySDR::DeviceWrapper::listRegisterInterfaces(void) const
+{
+    return _device->listRegisterInterfaces();
+}
+
+void SoapySDR::DeviceWrapper::writeRegister(const std::string &name, const unsigned addr, const unsigned value)
+{
+    _device->writeRegister(name, addr, value);
+}
+
+unsigned SoapySDR::DeviceWrapper::readRegister(const std::string &name, const unsigned addr) const
+{
+    return _device->readRegister(name, addr);
+}
+
+void SoapySDR::DeviceWrapper::writeRegister(const unsigned addr, const unsigned value)
+{
+    _device->writeRegister(addr, value);
+}
+
+unsigned SoapySDR::DeviceWrapper::readRegister(const unsigned addr) const
+{
+    return _device->readRegister(addr);
+}
+
+void SoapySDR::DeviceWrapper::writeRegisters(const std::string &name, const unsigned addr, const std::vector<unsigned> &value)
+{
+    _device->writeRegisters(name, addr, value);
+}
+
+std::vector<unsigned> SoapySDR::DeviceWrapper::readRegisters(const std::string &name, const unsigned addr, const size_t length) const
+{
+    return _device->readRegisters(name, addr, length);
+}
+
+void SoapySDR::DeviceWrapper::writeRegisters(const std::string &name, const std::vector<std::pair<unsigned, unsigned>> &values)
+{
+    _device->writeRegisters(name, values);
+}
+
+std::vector<unsigned> SoapySDR::DeviceWrapper::readRegisters(const std::string &name, const std::vector<unsigned> &addrs) const
+{
+    return _device->readRegisters(name, addrs);
+}
+
+/***********************************************************************
+ * Settings API
+ **********************************************************************/
+SoapySDR::ArgInfoList SoapySDR::DeviceWrapper::getSettingInfo(void) const
+{
+    return _device->getSettingInfo();
+}
+
+void SoapySDR::DeviceWrapper::writeSetting(const std::string &key, const std::string &value)
+{
+    _device->writeSetting(key, value);
+}
+
+std::string SoapySDR::DeviceWrapper::readSetting(const std::string &key) const
+{
+    return _device->readSetting(key);
+}
+
+SoapySDR::ArgInfoList SoapySDR::DeviceWrapper::getSettingInfo(const int direction, const size_t channel) const
+{
+    return _device->getSettingInfo(direction, channel);
+}
+
+void SoapySDR::DeviceWrapper::writeSetting(const int direction, const size_t channel, const std::string &key, const std::string &value)
+{
+    _device->writeSetting(direction, channel, key, value);
+}
+
+std::string SoapySDR::DeviceWrapper::readSetting(const int direction, const size_t channel, const std::string &key) const
+{
+    return _device->readSetting(direction, channel, key);
+}
+
+void SoapySDR::DeviceWrapper::commitSettings(const SettingsTransaction &transaction)
+{
+    _device->commitSettings(transaction);
+}
+
+/***********************************************************************
+ * GPIO API
+ **********************************************************************/
+std::vector<std::string> SoapySDR::DeviceWrapper::listGPIOBanks(void) const
+{
+    return _device->listGPIOBanks();
+}
+
+void SoapySDR::DeviceWrapper::writeGPIO(const std::string &bank, const unsigned value)
+{
+    _device->writeGPIO(bank, value);
+}
+
+void SoapySDR::DeviceWrapper::writeGPIO(const std::string &bank, const unsigned value, const unsigned mask)
+{
+    _device->writeGPIO(bank, value, mask);
+}
+
+unsigned SoapySDR::DeviceWrapper::readGPIO(const std::string &bank) const
+{
+    return _device->readGPIO(bank);
+}
+
+void SoapySDR::DeviceWrapper::writeGPIODir(const std::string &bank, const unsigned dir)
+{
+    _device->writeGPIODir(bank, dir);
+}
+
+void SoapySDR::DeviceWrapper::writeGPIODir(const std::string &bank, const unsigned dir, const unsigned mask)
+{
+    _device->writeGPIODir(bank, dir, mask);
+}
+
+unsigned SoapySDR::DeviceWrapper::readGPIODir(const std::string &bank) const
+{
+    return _device->readGPIODir(bank);
+}
+
+/***********************************************************************
+ * I2C API
+ **********************************************************************/
+void SoapySDR::DeviceWrapper::writeI2C(const int addr, const std::string &data)
+{
+    _device->writeI2C(addr, data);
+}
+
+std::string SoapySDR::DeviceWrapper::readI2C(const int addr, const size_t numBytes)
+{
+    return _device->readI2C(addr, numBytes);
+}
+
+/***********************************************************************
+ * SPI API
+ **********************************************************************/
+unsigned SoapySDR::DeviceWrapper::transactSPI(const int addr, const unsigned data, const size_t numBits)
+{
+    return _device->transactSPI(addr, data, numBits);
+}
+
+/***********************************************************************
+ * UART API
+ **********************************************************************/
+std::vector<std::string> SoapySDR::DeviceWrapper::listUARTs(void) const
+{
+    return _device->listUARTs();
+}
+
+void SoapySDR::DeviceWrapper::writeUART(const std::string &which, const std::string &data)
+{
+    _device->writeUART(which, data);
+}
+
+std::string SoapySDR::DeviceWrapper::readUART(const std::string &which, const long timeoutUs) const
+{
+    return _device->readUART(which, timeoutUs);
+}
@@ -0,0 +1,237 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include <SoapySDR/Device.hpp>
+
+namespace SoapySDR
+{
+
+/*!
+ * DeviceWrapper forwards every Device call to the wrapped device.
+ * Library layers derive from the wrapper and override the calls they
+ * adapt, such as the stream format adapter installed by Device::make().
+ * The wrapper owns the wrapped device and deletes it on destruction.
+ * New virtual calls in Device must be forwarded here as well.
+ */
+class DeviceWrapper : public Device
+{
+public:
+    DeviceWrapper(Device *device);
+
+    ~DeviceWrapper(void);
+
+    //! Get the wrapped device
+    Device *getWrappedDevice(void) const
+    {
+        return _device;
+    }
+
+    /*******************************************************************
+     * Identification API
+     ******************************************************************/
+    std::string getDriverKey(void) const;
+    std::string getHardwareKey(void) const;
+    Kwargs getHardwareInfo(void) const;
+
+    /*******************************************************************
+     * Channels API
+     ******************************************************************/
+    void setFrontendMapping(const int direction, const std::string &mapping);
+    std::string getFrontendMapping(const int direction) const;
+    size_t getNumChannels(const int direction) const;
+    Kwargs getChannelInfo(const int direction, const size_t channel) const;
+    bool getFullDuplex(const int direction, const size_t channel) const;
+
+    /*******************************************************************
+     * Stream API
+     ******************************************************************/
+    std::vector<std::string> getStreamFormats(const int direction, const size_t channel) const;
+    std::string getNativeStreamFormat(const int direction, const size_t channel, double &fullScale) const;
+    ArgInfoList getStreamArgsInfo(const int direction, const size_t channel) const;
+    Stream *setupStream(const int direction, const std::string &format, const std::vector<size_t> &channels, const Kwargs &args);
+    void closeStream(Stream *stream);
+    size_t getStreamMTU(Stream *stream) const;
+    int activateStream(Stream *stream, const int flags, const long long timeNs, const size_t numElems);
+    int deactivateStream(Stream *stream, const int flags, const long long timeNs);
+    int readStream(Stream *stream, void * const *buffs, const size_t numElems, int &flags, long long &timeNs, const long timeoutUs);
+    int writeStream(Stream *stream, const void * const *buffs, const size_t numElems, int &flags, const long long timeNs, const long timeoutUs);
+    int readStreamBatch(Stream *stream, void * const * const *buffs, const size_t numBuffs, const size_t numElems, size_t *elems, int *flags, long long *timeNs, const long timeoutUs);
+    int writeStreamBatch(Stream *stream, const void * const * const *buffs, const size_t numBuffs, const size_t *numElems, size_t *elems, int *flags, const long long *timeNs, const long timeoutUs);
+    int getStreamStats(Stream *stream, StreamStats &stats);
+    int getStreamPollHandle(Stream *stream, intptr_t &handle);
+    int readStreamStatus(Stream *stream, size_t &chanMask, int &flags, long long &timeNs, const long timeoutUs);
+
+    /*******************************************************************
+     * Direct buffer access API
+     ******************************************************************/
+    size_t getNumDirectAccessBuffers(Stream *stream);
+    int getDirectAccessBufferAddrs(Stream *stream, const size_t handle, void **buffs);
+    int acquireReadBuffer(Stream *stream, size_t &handle, const void **buffs, int &flags, long long &timeNs, const long timeoutUs);
+    void releaseReadBuffer(Stream *stream, const size_t handle);
+    int acquireWriteBuffer(Stream *stream, size_t &handle, void **buffs, const long timeoutUs);
+    void releaseWriteBuffer(Stream *stream, const size_t handle, const size_t numElems, int &flags, const long long timeNs);
+    StreamSubscription *subscribeStream(Stream *stream, const size_t numChans, const StreamSubscription::Callback &callback);
+    void unsubscribeStream(StreamSubscription *subscription);
+
+    /*******************************************************************
+     * Antenna API
+     ******************************************************************/
+    std::vector<std::string> listAntennas(const int direction, const size_t channel) const;
+    void setAntenna(const int direction, const size_t channel, const std::string &name);
+    std::string getAntenna(const int direction, const size_t channel) const;
+
+    /*******************************************************************
+     * Frontend corrections API
+     ******************************************************************/
+    bool hasDCOffsetMode(const int direction, const size_t channel) const;
+    void setDCOffsetMode(const int direction, const size_t channel, const bool automatic);
+    bool getDCOffsetMode(const int direction, const size_t channel) const;
+    bool hasDCOffset(const int direction, const size_t channel) const;
+    void setDCOffset(const int direction, const size_t channel, const std::complex<double> &offset);
+    std::complex<double> getDCOffset(const int direction, const size_t channel) const;
+    bool hasIQBalance(const int direction, const size_t channel) const;
+    void setIQBalance(const int direction, const size_t channel, const std::complex<double> &balance);
+    std::complex<double> getIQBalance(const int direction, const size_t channel) const;
+    bool hasFrequencyCorrection(const int direction, const size_t channel) const;
+    void setFrequencyCorrection(const int direction, const size_t channel, const double value);
+    double getFrequencyCorrection(const int direction, const size_t channel) const;
+
+    /*******************************************************************
+     * Gain API
+     ******************************************************************/
+    std::vector<std::string> listGains(const int direction, const size_t channel) const;
+    bool hasGainMode(const int direction, const size_t channel) const;
+    void setGainMode(const int direction, const size_t channel, const bool automatic);
+    bool getGainMode(const int direction, const size_t channel) const;
+    void setGain(const int direction, const size_t channel, const double value);
+    void setGain(const int direction, const size_t channel, const std::string &name, const double value);
+    double getGain(const int direction, const size_t channel) const;
+    double getGain(const int direction, const size_t channel, const std::string &name) const;
+    Range getGainRange(const int direction, const size_t channel) const;
+    Range getGainRange(const int direction, const size_t channel, const std::string &name) const;
+    void enableGainCache(const bool enable);
+    void invalidateGainCache(void);
+
+    /*******************************************************************
+     * Frequency API
+     ******************************************************************/
+    void setFrequency(const int direction, const size_t channel, const double frequency, const Kwargs &args);
+    void setFrequency(const int direction, const size_t channel, const std::string &name, const double frequency, const Kwargs &args);
+    double getFrequency(const int direction, const size_t channel) const;
+    double getFrequency(const int direction, const size_t channel, const std::string &name) const;
+    std::vector<std::string> listFrequencies(const int direction, const size_t channel) const;
+    RangeList getFrequencyRange(const int direction, const size_t channel) const;
+    RangeList getFrequencyRange(const int direction, const size_t channel, const std::string &name) const;
+    ArgInfoList getFrequencyArgsInfo(const int direction, const size_t channel) const;
+
+    /*******************************************************************
+     * Sample Rate API
+     ******************************************************************/
+    void setSampleRate(const int direction, const size_t channel, const double rate);
+    double getSampleRate(const int direction, const size_t channel) const;
+    std::vector<double> listSampleRates(const int direction, const size_t channel) const;
+    RangeList getSampleRateRange(const int direction, const size_t channel) const;
+
+    /*******************************************************************
+     * Bandwidth API
+     ******************************************************************/
+    void setBandwidth(const int direction, const size_t channel, const double bw);
+    double getBandwidth(const int direction, const size_t channel) const;
+    std::vector<double> listBandwidths(const int direction, const size_t channel) const;
+    RangeList getBandwidthRange(const int direction, const size_t channel) const;
+
+    /*******************************************************************
+     * Clocking API
+     ******************************************************************/
+    void setMasterClockRate(const double rate);
+    double getMasterClockRate(void) const;
+    RangeList getMasterClockRates(void) const;
+    std::vector<std::string> listClockSources(void) const;
+    void setClockSource(const std::string &source);
+    std::string getClockSource(void) const;
+
+    /*******************************************************************
+     * Time API
+     ******************************************************************/
+    std::vector<std::string> listTimeSources(void) const;
+    void setTimeSource(const std::string &source);
+    std::string getTimeSource(void) const;
+    bool hasHardwareTime(const std::string &what) const;
+    long long getHardwareTime(const std::string &what) const;
+    void setHardwareTime(const long long timeNs, const std::string &what);
+    void setCommandTime(const long long timeNs, const std::string &what);
+    void scheduleSettings(const SettingsTransaction &transaction);
+    void cancelScheduledSettings(void);
+    size_t getNumScheduledSettings(void) const;
+
+    /*******************************************************************
+     * Sensor API
+     ******************************************************************/
+    std::vector<std::string> listSensors(void) const;
+    ArgInfo getSensorInfo(const std::string &key) const;
+    std::string readSensor(const std::string &key) const;
+    std::vector<std::string> listSensors(const int direction, const size_t channel) const;
+    ArgInfo getSensorInfo(const int direction, const size_t channel, const std::string &key) const;
+    std::string readSensor(const int direction, const size_t channel, const std::string &key) const;
+    SensorSubscription *subscribeSensors(const std::vector<SensorSubscription::Sensor> &sensors, const double rate, const SensorSubscription::Callback &callback);
+    void unsubscribeSensors(SensorSubscription *subscription);
+
+    /*******************************************************************
+     * Register API
+     ******************************************************************/
+    std::vector<std::string> listRegisterInterfaces(void) const;
+    void writeRegister(const std::string &name, const unsigned addr, const unsigned value);
+    unsigned readRegister(const std::string &name, const unsigned addr) const;
+    void writeRegister(const unsigned addr, const unsigned value);
+    unsigned readRegister(const unsigned addr) const;
+    void writeRegisters(const std::string &name, const unsigned addr, const std::vector<unsigned> &value);
+    std::vector<unsigned> readRegisters(const std::string &name, const unsigned addr, const size_t length) const;
+    void writeRegisters(const std::string &name, const std::vector<std::pair<unsigned, unsigned>> &values);
+    std::vector<unsigned> readRegisters(const std::string &name, const std::vector<unsigned> &addrs) const;
+
+    /*******************************************************************
+     * Settings API
+     ******************************************************************/
+    ArgInfoList getSettingInfo(void) const;
+    void writeSetting(const std::string &key, const std::string &value);
+    std::string readSetting(const std::string &key) const;
+    ArgInfoList getSettingInfo(const int direction, const size_t channel) const;
+    void writeSetting(const int direction, const size_t channel, const std::string &key, const std::string &value);
+    std::string readSetting(const int direction, const size_t channel, const std::string &key) const;
+    void commitSettings(const SettingsTransaction &transaction);
+
+    /*******************************************************************
+     * GPIO API
+     ******************************************************************/
+    std::vector<std::string> listGPIOBanks(void) const;
+    void writeGPIO(const std::string &bank, const unsigned value);
+    void writeGPIO(const std::string &bank, const unsigned value, const unsigned mask);
+    unsigned readGPIO(const std::string &bank) const;
+    void writeGPIODir(const std::string &bank, const unsigned dir);
+    void writeGPIODir(const std::string &bank, const unsigned dir, const unsigned mask);
+    unsigned readGPIODir(const std::string &bank) const;
+
+    /*******************************************************************
+     * I2C API
+     ******************************************************************/
+    void writeI2C(const int addr, const std::string &data);
+    std::string readI2C(const int addr, const size_t numBytes);
+
+    /*******************************************************************
+     * SPI API
+     ******************************************************************/
+    unsigned transactSPI(const int addr, const unsigned data, const size_t numBits);
+
+    /*******************************************************************
+     * UART API
+     ******************************************************************/
+    std::vector<std::string> listUARTs(void) const;
+    void writeUART(const std::string &which, const std::string &data);
+    std::string readUART(const std::string &which, const long timeoutUs) const;
+
+protected:
+    Device *const _device;
+};
+
+}
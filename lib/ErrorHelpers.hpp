@@ -13,6 +13,10 @@
 #define __SOAPY_SDR_C_TRY \
     SoapySDRDevice_clearError(); try {
 
+//! Start a fast path section, the error state is only touched on error
+#define __SOAPY_SDR_C_TRY_FAST \
+    try {
+
 //! Close a section with a catch, with specified return code
 #define __SOAPY_SDR_C_CATCH_RET(ret) } \
     catch (const std::exception &ex) { SoapySDRDevice_reportError(ex.what()); return ret; } \
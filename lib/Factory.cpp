@@ -4,17 +4,31 @@
 #include <SoapySDR/Device.hpp>
 #include <SoapySDR/Registry.hpp>
 #include <SoapySDR/Modules.hpp>
+#include <SoapySDR/Tracer.hpp>
+#include <SoapySDR/FlatKwargs.hpp>
+#include <unordered_map>
 #include <stdexcept>
 #include <iostream>
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <cstdlib>
 #include <mutex>
 
+//implemented in StreamWrapper.cpp
+SoapySDR::Device *makeStreamWrapper(SoapySDR::Device *device);
+
 static std::recursive_mutex &getFactoryMutex(void)
 {
     static std::recursive_mutex mutex;
     return mutex;
 }
 
-typedef std::map<SoapySDR::Kwargs, SoapySDR::Device *> DeviceTable;
+//hash index of the device args for make() lookups
+typedef std::unordered_map<SoapySDR::FlatKwargs, SoapySDR::Device *> DeviceTable;
 
 static DeviceTable &getDeviceTable(void)
 {
@@ -22,42 +36,315 @@ static DeviceTable &getDeviceTable(void)
     return table;
 }
 
-typedef std::map<SoapySDR::Device *, size_t> DeviceCounts;
+//reverse index of each device to its args and reference count for unmake()
+struct DeviceEntry
+{
+    DeviceEntry(void):
+        count(0)
+    {
+        return;
+    }
 
-static DeviceCounts &getDeviceCounts(void)
+    SoapySDR::FlatKwargs args;
+    size_t count;
+};
+
+typedef std::unordered_map<SoapySDR::Device *, DeviceEntry> DeviceEntries;
+
+static DeviceEntries &getDeviceEntries(void)
 {
-    static DeviceCounts table;
+    static DeviceEntries table;
     return table;
 }
 
-void automaticLoadModules(void);
+void automaticLoadModules(const std::string &driver);
+
+std::string getEnvImpl(const char *name);
+
+//optional timeout for each driver's find function, 0 waits for all results
+static std::chrono::microseconds getEnumerateTimeout(void)
+{
+    const std::string timeoutEnvStr = getEnvImpl("SOAPY_SDR_ENUMERATE_TIMEOUT");
+    if (timeoutEnvStr.empty()) return std::chrono::microseconds(0);
+    return std::chrono::microseconds((long long)(std::atof(timeoutEnvStr.c_str())*1e6));
+}
+
+/***********************************************************************
+ * Optional cache of find function results keyed by driver and args:
+ * The generation count changes on every invalidation so that a find
+ * which was in progress during the invalidation does not store results.
+ **********************************************************************/
+typedef std::pair<std::string, SoapySDR::Kwargs> FindCacheKey;
+
+struct FindCacheEntry
+{
+    std::chrono::steady_clock::time_point expires;
+    SoapySDR::KwargsList results;
+};
+
+static std::mutex &getFindCacheMutex(void)
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+static std::map<FindCacheKey, FindCacheEntry> &getFindCache(void)
+{
+    static std::map<FindCacheKey, FindCacheEntry> cache;
+    return cache;
+}
+
+static long long getDefaultFindCacheTTLUs(void)
+{
+    const std::string ttlEnvStr = getEnvImpl("SOAPY_SDR_ENUMERATE_CACHE_TTL");
+    if (ttlEnvStr.empty()) return 0;
+    return (long long)(std::atof(ttlEnvStr.c_str())*1e6);
+}
+
+static std::atomic<long long> findCacheTTLUs(getDefaultFindCacheTTLUs());
+
+static size_t findCacheGeneration(0);
+
+static bool lookupFindCache(const FindCacheKey &key, SoapySDR::KwargsList &results)
+{
+    if (findCacheTTLUs.load() <= 0) return false;
+    std::lock_guard<std::mutex> lock(getFindCacheMutex());
+    auto it = getFindCache().find(key);
+    if (it == getFindCache().end()) return false;
+    if (it->second.expires < std::chrono::steady_clock::now())
+    {
+        getFindCache().erase(it);
+        return false;
+    }
+    results = it->second.results;
+    return true;
+}
+
+static SoapySDR::KwargsList callFindFunction(const std::string &driver, const SoapySDR::FindFunction &find, const SoapySDR::Kwargs &args)
+{
+    const long long ttlUs = findCacheTTLUs.load();
+    size_t generation(0);
+    if (ttlUs > 0)
+    {
+        std::lock_guard<std::mutex> lock(getFindCacheMutex());
+        generation = findCacheGeneration;
+    }
+
+    SoapySDR::KwargsList results = find(args);
+    for (auto &result : results) result["driver"] = driver;
+
+    if (ttlUs > 0)
+    {
+        std::lock_guard<std::mutex> lock(getFindCacheMutex());
+        if (generation != findCacheGeneration) return results;
+        auto &entry = getFindCache()[FindCacheKey(driver, args)];
+        entry.expires = std::chrono::steady_clock::now() + std::chrono::microseconds(ttlUs);
+        entry.results = results;
+    }
+    return results;
+}
+
+void SoapySDR::Device::setEnumerateCacheTTL(const double seconds)
+{
+    findCacheTTLUs.store((long long)(seconds*1e6));
+    if (seconds <= 0.0) invalidateEnumerateCache();
+}
+
+void SoapySDR::Device::invalidateEnumerateCache(const std::string &driver)
+{
+    std::lock_guard<std::mutex> lock(getFindCacheMutex());
+    findCacheGeneration++;
+    auto &cache = getFindCache();
+    for (auto it = cache.begin(); it != cache.end();)
+    {
+        if (driver.empty() or it->first.first == driver) it = cache.erase(it);
+        else ++it;
+    }
+}
+
+/***********************************************************************
+ * Find calls that run in their own thread:
+ * Each call holds a reference to the module of its driver, so that
+ * unloadModule() does not unmap the find function while it runs.
+ * A call that timed out is abandoned rather than cancelled, its results
+ * are dropped when it returns, and the driver is skipped until then.
+ * Modules are acquired and released outside of the module mutex,
+ * because module constructors take that mutex under the loader lock.
+ **********************************************************************/
+void *acquireModule(const std::string &path);
+
+void releaseModule(void *handle);
+
+std::string getRegistryModulePath(const std::string &name);
+
+std::recursive_mutex &getModuleMutex(void);
+
+struct FindCall
+{
+    FindCall(const std::string &driver, const SoapySDR::FindFunction &find, void *module):
+        driver(driver),
+        find(find),
+        module(module),
+        finished(false),
+        abandoned(false)
+    {
+        return;
+    }
+
+    ~FindCall(void)
+    {
+        //the function object was created in the module
+        find = nullptr;
+        releaseModule(module);
+    }
+
+    const std::string driver;
+    SoapySDR::FindFunction find;
+    void *module;
+    std::promise<SoapySDR::KwargsList> promise;
+    bool finished;
+    bool abandoned;
+};
+
+struct FindTracker
+{
+    std::mutex mutex;
+    std::map<std::string, size_t> numAbandoned;
+};
+
+static FindTracker &getFindTracker(void)
+{
+    //never destroyed, an abandoned call may return during static destruction
+    static FindTracker *tracker(new FindTracker());
+    return *tracker;
+}
+
+static void runFindCall(const std::shared_ptr<FindCall> &call, const SoapySDR::Kwargs &args)
+{
+    try
+    {
+        call->promise.set_value(callFindFunction(call->driver, call->find, args));
+    }
+    catch (...)
+    {
+        call->promise.set_exception(std::current_exception());
+    }
+
+    auto &tracker = getFindTracker();
+    std::lock_guard<std::mutex> lock(tracker.mutex);
+    call->finished = true;
+    if (call->abandoned and --tracker.numAbandoned[call->driver] == 0) tracker.numAbandoned.erase(call->driver);
+}
+
+//mark a call that did not return in time, false when it just finished
+static bool abandonFindCall(FindCall &call)
+{
+    auto &tracker = getFindTracker();
+    std::lock_guard<std::mutex> lock(tracker.mutex);
+    if (call.finished) return false;
+    call.abandoned = true;
+    tracker.numAbandoned[call.driver]++;
+    return true;
+}
+
+static bool isFindAbandoned(const std::string &driver)
+{
+    auto &tracker = getFindTracker();
+    std::lock_guard<std::mutex> lock(tracker.mutex);
+    return tracker.numAbandoned.count(driver) != 0;
+}
 
 SoapySDR::KwargsList SoapySDR::Device::enumerate(const Kwargs &args)
 {
-    std::lock_guard<std::recursive_mutex> lock(getFactoryMutex());
+    TraceScope trace("Device::enumerate", "factory");
+    std::vector<std::pair<std::string, std::string>> drivers;
+    {
+        std::lock_guard<std::recursive_mutex> lock(getFactoryMutex());
+        automaticLoadModules((args.count("driver") == 0)?"":args.at("driver"));
+        std::lock_guard<std::recursive_mutex> moduleLock(getModuleMutex());
+        for (const auto &it : Registry::listFindFunctions())
+        {
+            if (args.count("driver") != 0 and args.at("driver") != it.first) continue;
+            drivers.push_back(std::make_pair(it.first, getRegistryModulePath(it.first)));
+        }
+    }
+
+    //acquire the modules without the module mutex: the loader holds its own lock
+    //while the module constructors register under the module mutex
+    std::vector<void *> modules;
+    for (const auto &driver : drivers) modules.push_back(acquireModule(driver.second));
+
+    //keep the drivers whose module is still the one that registered them
+    std::vector<std::shared_ptr<FindCall>> calls;
+    std::vector<void *> unused;
+    {
+        std::lock_guard<std::recursive_mutex> moduleLock(getModuleMutex());
+        const auto findFunctions = Registry::listFindFunctions();
+        for (size_t i = 0; i < drivers.size(); i++)
+        {
+            const auto it = findFunctions.find(drivers[i].first);
+            const bool loaded = modules[i] != nullptr or drivers[i].second.empty();
+            if (not loaded or it == findFunctions.end() or getRegistryModulePath(it->first) != drivers[i].second)
+            {
+                unused.push_back(modules[i]);
+                continue;
+            }
+            calls.push_back(std::make_shared<FindCall>(it->first, it->second, modules[i]));
+        }
+    }
+    for (void *module : unused) releaseModule(module);
 
-    automaticLoadModules();
+    //call each find function in its own thread, a driver that times out is left running detached
+    static const auto timeout = getEnumerateTimeout();
+    std::vector<std::future<SoapySDR::KwargsList>> futures;
+    for (const auto &call : calls)
+    {
+        SoapySDR::KwargsList cached;
+        bool done = lookupFindCache(FindCacheKey(call->driver, args), cached);
+        if (not done and isFindAbandoned(call->driver))
+        {
+            std::cerr << "SoapySDR::Device::enumerate(" << call->driver << ") " << "skipped, a timed out find is still running" << std::endl;
+            done = true;
+        }
+        if (done)
+        {
+            std::promise<SoapySDR::KwargsList> ready;
+            ready.set_value(cached);
+            futures.push_back(ready.get_future());
+            continue;
+        }
+        if (calls.size() == 1 and timeout.count() == 0)
+        {
+            futures.push_back(std::async(std::launch::deferred, &callFindFunction, call->driver, call->find, args));
+            continue;
+        }
+        futures.push_back(call->promise.get_future());
+        std::thread(&runFindCall, call, args).detach();
+    }
+
+    //merge the results in driver order
+    const auto exitTime = std::chrono::steady_clock::now() + timeout;
     SoapySDR::KwargsList results;
-    for (const auto &it : Registry::listFindFunctions())
+    auto future = futures.begin();
+    for (const auto &call : calls)
     {
-        if (args.count("driver") != 0 and args.at("driver") != it.first) continue;
         try
         {
-            SoapySDR::KwargsList results0 = it.second(args);
-            for (size_t i = 0; i < results0.size(); i++)
+            if (timeout.count() != 0 and future->wait_until(exitTime) != std::future_status::ready and abandonFindCall(*call))
             {
-                results0[i]["driver"] = it.first;
-                results.push_back(results0[i]);
+                std::cerr << "SoapySDR::Device::enumerate(" << call->driver << ") " << "timeout, results dropped" << std::endl;
             }
+            else for (const auto &result : future->get()) results.push_back(result);
         }
         catch (const std::exception &ex)
         {
-            std::cerr << "SoapySDR::Device::enumerate(" << it.first << ") " << ex.what() << std::endl;
+            std::cerr << "SoapySDR::Device::enumerate(" << call->driver << ") " << ex.what() << std::endl;
         }
         catch (...)
         {
-            std::cerr << "SoapySDR::Device::enumerate(" << it.first << ") " << "unknown error" << std::endl;
+            std::cerr << "SoapySDR::Device::enumerate(" << call->driver << ") " << "unknown error" << std::endl;
         }
+        ++future;
     }
     return results;
 }
@@ -67,34 +354,102 @@ SoapySDR::KwargsList SoapySDR::Device::enumerate(const std::string &args)
     return enumerate(KwargsFromString(args));
 }
 
-static SoapySDR::Device* getDeviceFromTable(const SoapySDR::Kwargs &args)
+/***********************************************************************
+ * In-flight factory calls keyed by the discovered args:
+ * Concurrent make() calls for the same args wait on the first call,
+ * which counts one reference for every waiter when it completes.
+ * A make() for args that are being unmade waits for the delete.
+ **********************************************************************/
+struct InFlightMake
 {
-    if (args.empty()) return nullptr;
-    std::lock_guard<std::recursive_mutex> lock(getFactoryMutex());
-    if (getDeviceTable().count(args) != 0 and getDeviceCounts().count(getDeviceTable().at(args)) != 0)
+    InFlightMake(void):
+        future(promise.get_future().share()),
+        numWaiters(0)
     {
-        auto device = getDeviceTable().at(args);
-        getDeviceCounts()[device]++;
-        return device;
+        return;
     }
-    return nullptr;
+
+    std::promise<SoapySDR::Device *> promise;
+    std::shared_future<SoapySDR::Device *> future;
+    size_t numWaiters;
+};
+
+typedef std::unordered_map<SoapySDR::FlatKwargs, std::shared_ptr<InFlightMake>> InFlightMakes;
+
+static InFlightMakes &getInFlightMakes(void)
+{
+    static InFlightMakes table;
+    return table;
 }
 
-SoapySDR::Device* SoapySDR::Device::make(const Kwargs &inputArgs)
+typedef std::unordered_map<SoapySDR::FlatKwargs, std::shared_future<void>> InFlightUnmakes;
+
+static InFlightUnmakes &getInFlightUnmakes(void)
 {
-    Device *device = nullptr;
+    static InFlightUnmakes table;
+    return table;
+}
 
-    //the arguments may have already come from enumerate and been used to open a device
-    device = getDeviceFromTable(inputArgs);
-    if (device != nullptr) return device;
+/*!
+ * Get a reference to an existing or in-flight device.
+ * When claim is specified and there is no device,
+ * register a new in-flight make for the caller to complete.
+ */
+static SoapySDR::Device* getDeviceFromTable(const SoapySDR::FlatKwargs &args, std::shared_ptr<InFlightMake> *claim = nullptr)
+{
+    if (args.empty()) return nullptr;
+    std::unique_lock<std::recursive_mutex> lock(getFactoryMutex());
+    while (true)
+    {
+        auto unmaking = getInFlightUnmakes().find(args);
+        if (unmaking != getInFlightUnmakes().end())
+        {
+            auto done = unmaking->second;
+            lock.unlock();
+            done.wait();
+            lock.lock();
+            continue;
+        }
 
-    //otherwise the args must always come from an enumeration result
-    Kwargs discoveredArgs;
-    const auto results = Device::enumerate(inputArgs);
-    if (not results.empty()) discoveredArgs = results.front();
+        auto found = getDeviceTable().find(args);
+        if (found != getDeviceTable().end() and getDeviceEntries().count(found->second) != 0)
+        {
+            auto device = found->second;
+            getDeviceEntries()[device].count++;
+            return device;
+        }
+
+        auto making = getInFlightMakes().find(args);
+        if (making != getInFlightMakes().end())
+        {
+            auto inFlight = making->second;
+            inFlight->numWaiters++;
+            lock.unlock();
+            return inFlight->future.get();
+        }
+
+        if (claim != nullptr)
+        {
+            claim->reset(new InFlightMake());
+            getInFlightMakes()[args] = *claim;
+        }
+        return nullptr;
+    }
+}
 
-    //check the device table for an already allocated device
-    device = getDeviceFromTable(discoveredArgs);
+/***********************************************************************
+ * Make a device from args that already came from an enumeration result
+ **********************************************************************/
+static SoapySDR::Device *makeDiscovered(const SoapySDR::Kwargs &inputArgs, const SoapySDR::Kwargs &discoveredArgs)
+{
+    using SoapySDR::Kwargs;
+    using SoapySDR::Registry;
+    SoapySDR::Device *device = nullptr;
+
+    //check the device table for an already allocated or in-flight device
+    const SoapySDR::FlatKwargs tableArgs(discoveredArgs);
+    std::shared_ptr<InFlightMake> inFlight;
+    device = getDeviceFromTable(tableArgs, &inFlight);
     if (device != nullptr) return device;
 
     //load the enumeration args with missing keys from the make argument
@@ -104,55 +459,202 @@ SoapySDR::Device* SoapySDR::Device::make(const Kwargs &inputArgs)
         if (hybridArgs.count(it.first) == 0) hybridArgs[it.first] = it.second;
     }
 
-    //lock during device construction
-    //make itself can be parallelized, but we need to keep track of in-process factories
-    //so that other calling threads with the same args can wait on the result
-    std::lock_guard<std::recursive_mutex> lock(getFactoryMutex());
+    //construct without the lock so that different devices open in parallel
+    try
+    {
+        //loop through make functions and call on module match
+        for (const auto &it : Registry::listMakeFunctions())
+        {
+            if (hybridArgs.count("driver") != 0 and hybridArgs.at("driver") != it.first) continue;
+            device = it.second(hybridArgs);
+            break;
+        }
+        if (device == nullptr) throw std::runtime_error("SoapySDR::Device::make() no match");
 
-    //loop through make functions and call on module match
-    for (const auto &it : Registry::listMakeFunctions())
+        //convert streams in formats that the driver does not support natively
+        if (hybridArgs.count("soapy_stream_wrapper") == 0 or hybridArgs.at("soapy_stream_wrapper") != "false")
+        {
+            device = makeStreamWrapper(device);
+        }
+    }
+    catch (...)
     {
-        if (hybridArgs.count("driver") != 0 and hybridArgs.at("driver") != it.first) continue;
-        device = it.second(hybridArgs);
-        break;
+        //the cached enumeration may refer to a device that is gone
+        if (discoveredArgs.count("driver") != 0) SoapySDR::Device::invalidateEnumerateCache(discoveredArgs.at("driver"));
+        std::lock_guard<std::recursive_mutex> lock(getFactoryMutex());
+        if (inFlight)
+        {
+            getInFlightMakes().erase(tableArgs);
+            inFlight->promise.set_exception(std::current_exception());
+        }
+        throw;
     }
-    if (device == nullptr) throw std::runtime_error("SoapySDR::Device::make() no match");
 
-    //store into the table
-    getDeviceTable()[discoveredArgs] = device;
-    getDeviceCounts()[device]++;
+    //store into the table with a reference for the caller and each waiter
+    std::lock_guard<std::recursive_mutex> lock(getFactoryMutex());
+    getDeviceTable()[tableArgs] = device;
+    auto &entry = getDeviceEntries()[device];
+    entry.args = tableArgs;
+    entry.count += 1;
+    if (inFlight)
+    {
+        entry.count += inFlight->numWaiters;
+        getInFlightMakes().erase(tableArgs);
+        inFlight->promise.set_value(device);
+    }
 
     return device;
 }
 
+SoapySDR::Device* SoapySDR::Device::make(const Kwargs &inputArgs)
+{
+    TraceScope trace("Device::make", "factory");
+
+    //the arguments may have already come from enumerate and been used to open a device
+    Device *device = getDeviceFromTable(FlatKwargs(inputArgs));
+    if (device != nullptr) return device;
+
+    //otherwise the args must always come from an enumeration result
+    Kwargs discoveredArgs;
+    const auto results = Device::enumerate(inputArgs);
+    if (not results.empty()) discoveredArgs = results.front();
+
+    return makeDiscovered(inputArgs, discoveredArgs);
+}
+
 SoapySDR::Device *SoapySDR::Device::make(const std::string &args)
 {
     return make(KwargsFromString(args));
 }
 
-void SoapySDR::Device::unmake(Device *device)
+/***********************************************************************
+ * Batch make and unmake
+ **********************************************************************/
+static bool argsMatchResult(const SoapySDR::Kwargs &args, const SoapySDR::Kwargs &result)
 {
-    std::lock_guard<std::recursive_mutex> lock(getFactoryMutex());
-
-    if (getDeviceCounts().count(device) == 0)
+    //keys that the enumeration does not report are treated as device configuration
+    for (const auto &it : args)
     {
-        throw std::runtime_error("SoapySDR::Device::unmake() unknown device");
+        const auto found = result.find(it.first);
+        if (found != result.end() and found->second != it.second) return false;
     }
+    return true;
+}
 
-    getDeviceCounts()[device]--;
-    if (getDeviceCounts()[device] == 0)
+std::vector<SoapySDR::Device *> SoapySDR::Device::make(const KwargsList &argsList)
+{
+    TraceScope trace("Device::make(list)", "factory");
+
+    //a single enumeration, narrowed to the driver when all of the args agree on one
+    Kwargs enumArgs;
+    for (size_t i = 0; i < argsList.size(); i++)
     {
-        getDeviceCounts().erase(device);
-        delete device;
+        const auto it = argsList[i].find("driver");
+        const std::string driver = (it == argsList[i].end())?"":it->second;
+        if (i == 0 and not driver.empty()) enumArgs["driver"] = driver;
+        else if (enumArgs.count("driver") != 0 and enumArgs.at("driver") != driver) enumArgs.clear();
+    }
+    const auto results = argsList.empty()?KwargsList():Device::enumerate(enumArgs);
 
-        //cleanup the argument to device table
-        for (auto it = getDeviceTable().begin(); it != getDeviceTable().end(); ++it)
+    //construct every device in parallel, args without a matching result
+    //fall back to an individual make() which runs its own enumeration
+    std::vector<std::future<Device *>> futures;
+    for (const auto &args : argsList)
+    {
+        const Kwargs *match = nullptr;
+        for (const auto &result : results)
         {
-            if (it->second == device)
-            {
-                getDeviceTable().erase(it);
-                return;
-            }
+            if (not argsMatchResult(args, result)) continue;
+            match = &result;
+            break;
         }
+        if (match == nullptr) futures.push_back(std::async(std::launch::async, [args](void){return Device::make(args);}));
+        else futures.push_back(std::async(std::launch::async, makeDiscovered, args, *match));
+    }
+
+    //collect all results, on failure cleanup the devices that were made
+    std::vector<Device *> devices;
+    std::exception_ptr error;
+    for (auto &future : futures)
+    {
+        try {devices.push_back(future.get());}
+        catch (...) {if (not error) error = std::current_exception();}
+    }
+    if (not error) return devices;
+
+    try {Device::unmake(devices);}
+    catch (const std::exception &ex) {std::cerr << "SoapySDR::Device::make() cleanup: " << ex.what() << std::endl;}
+    std::rethrow_exception(error);
+}
+
+void SoapySDR::Device::unmake(const std::vector<Device *> &devices)
+{
+    TraceScope trace("Device::unmake(list)", "factory");
+
+    std::vector<std::future<void>> futures;
+    for (auto *device : devices)
+    {
+        futures.push_back(std::async(std::launch::async, [device](void){Device::unmake(device);}));
     }
+
+    //wait on every teardown before reporting the first error
+    std::exception_ptr error;
+    for (auto &future : futures)
+    {
+        try {future.get();}
+        catch (...) {if (not error) error = std::current_exception();}
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+std::future<SoapySDR::KwargsList> SoapySDR::Device::enumerateAsync(const Kwargs &args)
+{
+    return std::async(std::launch::async, [args](void){return Device::enumerate(args);});
+}
+
+std::future<SoapySDR::Device *> SoapySDR::Device::makeAsync(const Kwargs &args)
+{
+    return std::async(std::launch::async, [args](void){return Device::make(args);});
+}
+
+std::future<SoapySDR::Device *> SoapySDR::Device::makeAsync(const std::string &args)
+{
+    return makeAsync(KwargsFromString(args));
+}
+
+void SoapySDR::Device::unmake(Device *device)
+{
+    TraceScope trace("Device::unmake", "factory");
+    std::unique_lock<std::recursive_mutex> lock(getFactoryMutex());
+
+    auto entry = getDeviceEntries().find(device);
+    if (entry == getDeviceEntries().end())
+    {
+        throw std::runtime_error("SoapySDR::Device::unmake() unknown device");
+    }
+
+    entry->second.count--;
+    if (entry->second.count != 0) return;
+    const FlatKwargs args = entry->second.args;
+    getDeviceEntries().erase(entry);
+
+    //cleanup the argument to device table,
+    //and mark the args in-flight until the delete completes
+    auto it = getDeviceTable().find(args);
+    const bool found = (it != getDeviceTable().end() and it->second == device);
+    if (found) getDeviceTable().erase(it);
+    std::promise<void> deleted;
+    if (found) getInFlightUnmakes()[args] = deleted.get_future().share();
+
+    //delete without the lock so that other devices can make and unmake
+    lock.unlock();
+
+    //the schedule thread calls into the driver, stop it while the driver is whole
+    try {device->cancelScheduledSettings();}
+    catch (const std::exception &ex) {std::cerr << "SoapySDR::Device::unmake() cancelScheduledSettings: " << ex.what() << std::endl;}
+    delete device;
+    lock.lock();
+
+    if (found) getInFlightUnmakes().erase(args);
+    deleted.set_value();
 }
@@ -3,10 +3,31 @@
 
 #include "ErrorHelpers.hpp"
 #include "TypeHelpers.hpp"
+#include "ArenaHelpers.hpp"
 #include <SoapySDR/Device.h>
 #include <SoapySDR/Device.hpp>
 #include <cstdlib>
 #include <cstring>
+#include <chrono>
+#include <memory>
+
+struct SoapySDREnumerateFuture
+{
+    std::future<SoapySDR::KwargsList> future;
+};
+
+struct SoapySDRMakeFuture
+{
+    std::future<SoapySDR::Device *> future;
+};
+
+template <typename T>
+static int waitFuture(std::future<T> &future, const long timeoutUs)
+{
+    if (timeoutUs < 0) future.wait();
+    else if (future.wait_for(std::chrono::microseconds(timeoutUs)) != std::future_status::ready) return SOAPY_SDR_TIMEOUT;
+    return 0;
+}
 
 extern "C" {
 
@@ -18,6 +39,14 @@ SoapySDRKwargs *SoapySDRDevice_enumerate(const SoapySDRKwargs *args, size_t *len
     __SOAPY_SDR_C_CATCH_RET(nullptr);
 }
 
+SoapySDRKwargs *SoapySDRDevice_enumerateArena(const SoapySDRKwargs *args, size_t *length)
+{
+    *length = 0;
+    __SOAPY_SDR_C_TRY
+    return toKwargsListArena(SoapySDR::Device::enumerate(toKwargs(args)), length);
+    __SOAPY_SDR_C_CATCH_RET(nullptr);
+}
+
 SoapySDRKwargs *SoapySDRDevice_enumerateStrArgs(const char *args, size_t *length)
 {
     *length = 0;
@@ -47,4 +76,86 @@ int SoapySDRDevice_unmake(SoapySDRDevice *device)
     __SOAPY_SDR_C_CATCH
 }
 
+SoapySDRDevice **SoapySDRDevice_makeList(const SoapySDRKwargs *argsList, const size_t length)
+{
+    __SOAPY_SDR_C_TRY
+    SoapySDR::KwargsList args;
+    for (size_t i = 0; i < length; i++) args.push_back(toKwargs(argsList+i));
+    const auto devices = SoapySDR::Device::make(args);
+
+    auto outDevices = (SoapySDRDevice **)std::calloc(devices.size()+1, sizeof(SoapySDRDevice *));
+    if (outDevices == nullptr)
+    {
+        SoapySDR::Device::unmake(devices);
+        throw std::bad_alloc();
+    }
+    for (size_t i = 0; i < devices.size(); i++) outDevices[i] = (SoapySDRDevice *)devices[i];
+    return outDevices;
+    __SOAPY_SDR_C_CATCH_RET(nullptr);
+}
+
+int SoapySDRDevice_unmakeList(SoapySDRDevice **devices, const size_t length)
+{
+    __SOAPY_SDR_C_TRY
+    std::vector<SoapySDR::Device *> devs;
+    for (size_t i = 0; i < length; i++) devs.push_back((SoapySDR::Device *)devices[i]);
+    SoapySDR::Device::unmake(devs);
+    __SOAPY_SDR_C_CATCH
+}
+
+void SoapySDRDevice_setEnumerateCacheTTL(const double seconds)
+{
+    SoapySDR::Device::setEnumerateCacheTTL(seconds);
+}
+
+void SoapySDRDevice_invalidateEnumerateCache(const char *driver)
+{
+    SoapySDR::Device::invalidateEnumerateCache((driver==nullptr)?"":driver);
+}
+
+SoapySDREnumerateFuture *SoapySDRDevice_enumerateAsync(const SoapySDRKwargs *args)
+{
+    __SOAPY_SDR_C_TRY
+    std::unique_ptr<SoapySDREnumerateFuture> future(new SoapySDREnumerateFuture());
+    future->future = SoapySDR::Device::enumerateAsync(toKwargs(args));
+    return future.release();
+    __SOAPY_SDR_C_CATCH_RET(nullptr);
+}
+
+int SoapySDREnumerateFuture_wait(SoapySDREnumerateFuture *future, const long timeoutUs)
+{
+    return waitFuture(future->future, timeoutUs);
+}
+
+SoapySDRKwargs *SoapySDREnumerateFuture_get(SoapySDREnumerateFuture *future, size_t *length)
+{
+    *length = 0;
+    std::unique_ptr<SoapySDREnumerateFuture> owner(future);
+    __SOAPY_SDR_C_TRY
+    return toKwargsList(future->future.get(), length);
+    __SOAPY_SDR_C_CATCH_RET(nullptr);
+}
+
+SoapySDRMakeFuture *SoapySDRDevice_makeAsync(const SoapySDRKwargs *args)
+{
+    __SOAPY_SDR_C_TRY
+    std::unique_ptr<SoapySDRMakeFuture> future(new SoapySDRMakeFuture());
+    future->future = SoapySDR::Device::makeAsync(toKwargs(args));
+    return future.release();
+    __SOAPY_SDR_C_CATCH_RET(nullptr);
+}
+
+int SoapySDRMakeFuture_wait(SoapySDRMakeFuture *future, const long timeoutUs)
+{
+    return waitFuture(future->future, timeoutUs);
+}
+
+SoapySDRDevice *SoapySDRMakeFuture_get(SoapySDRMakeFuture *future)
+{
+    std::unique_ptr<SoapySDRMakeFuture> owner(future);
+    __SOAPY_SDR_C_TRY
+    return (SoapySDRDevice *)future->future.get();
+    __SOAPY_SDR_C_CATCH_RET(nullptr);
+}
+
 }
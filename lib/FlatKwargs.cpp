@@ -0,0 +1,126 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/FlatKwargs.hpp>
+#include "KwargsMarkup.hpp"
+#include <unordered_set>
+#include <algorithm>
+#include <mutex>
+
+/***********************************************************************
+ * Process wide string pool, entries are never erased
+ **********************************************************************/
+static std::mutex &getInternMutex(void)
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+static std::unordered_set<std::string> &getInternPool(void)
+{
+    static std::unordered_set<std::string> pool;
+    return pool;
+}
+
+const std::string *SoapySDR::FlatKwargs::intern(const std::string &s)
+{
+    std::lock_guard<std::mutex> lock(getInternMutex());
+    return &*getInternPool().insert(s).first;
+}
+
+/***********************************************************************
+ * Construction and conversion
+ **********************************************************************/
+SoapySDR::FlatKwargs::FlatKwargs(void):
+    _hash(0)
+{
+    return;
+}
+
+SoapySDR::FlatKwargs::FlatKwargs(const Kwargs &args):
+    _hash(0)
+{
+    //the map is already sorted and unique by key
+    _entries.reserve(args.size());
+    std::lock_guard<std::mutex> lock(getInternMutex());
+    auto &pool = getInternPool();
+    for (const auto &it : args)
+    {
+        _entries.push_back(Entry(&*pool.insert(it.first).first, &*pool.insert(it.second).first));
+    }
+    this->finalize();
+}
+
+SoapySDR::FlatKwargs SoapySDR::FlatKwargs::fromString(const std::string &markup)
+{
+    FlatKwargs args;
+    {
+        std::lock_guard<std::mutex> lock(getInternMutex());
+        auto &pool = getInternPool();
+        std::string key, val;
+        parseKwargsMarkup(markup, [&](const char *k, const size_t kLen, const char *v, const size_t vLen)
+        {
+            key.assign(k, kLen);
+            val.assign(v, vLen);
+            args._entries.push_back(Entry(&*pool.insert(key).first, &*pool.insert(val).first));
+        });
+    }
+
+    //sort by key text, and like KwargsFromString() the last duplicate key wins
+    auto &entries = args._entries;
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b){return *a.first < *b.first;});
+    auto out = entries.begin();
+    for (auto it = entries.begin(); it != entries.end(); ++it)
+    {
+        if (it+1 != entries.end() and (it+1)->first == it->first) continue;
+        *out++ = *it;
+    }
+    entries.erase(out, entries.end());
+
+    args.finalize();
+    return args;
+}
+
+SoapySDR::Kwargs SoapySDR::FlatKwargs::toKwargs(void) const
+{
+    Kwargs args;
+    for (const auto &entry : _entries) args.emplace_hint(args.end(), *entry.first, *entry.second);
+    return args;
+}
+
+std::string SoapySDR::FlatKwargs::toString(void) const
+{
+    std::string markup;
+    for (const auto &entry : _entries)
+    {
+        if (not markup.empty()) markup += ", ";
+        markup += *entry.first;
+        markup += '=';
+        markup += *entry.second;
+    }
+    return markup;
+}
+
+/***********************************************************************
+ * Lookup
+ **********************************************************************/
+const std::string *SoapySDR::FlatKwargs::find(const std::string &key) const
+{
+    const auto it = std::lower_bound(_entries.begin(), _entries.end(), key,
+        [](const Entry &entry, const std::string &k){return *entry.first < k;});
+    if (it == _entries.end() or *it->first != key) return nullptr;
+    return it->second;
+}
+
+void SoapySDR::FlatKwargs::finalize(void)
+{
+    //boost style hash combine of the interned addresses
+    const std::hash<const std::string *> hasher;
+    size_t h = _entries.size();
+    for (const auto &entry : _entries)
+    {
+        h ^= hasher(entry.first) + 0x9e3779b9 + (h << 6) + (h >> 2);
+        h ^= hasher(entry.second) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    }
+    _hash = h;
+}
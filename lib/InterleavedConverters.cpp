@@ -0,0 +1,104 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/ConverterPrimatives.hpp>
+#include <SoapySDR/ConverterRegistry.hpp>
+#include <SoapySDR/Formats.hpp>
+#include <limits>
+
+// ********************************
+// Fused scale + convert + (de)interleave
+//
+// Every channel is converted in the same pass that moves it
+// between the interleaved buffer and the per-channel buffers,
+// so the interleaved buffer is only read or written once.
+
+// Scaled element conversions with a precomputed gain
+
+static inline float unityGain(const double scaler) {return float(scaler);}
+
+// a gain above one can scale an integer sample past the range of its type
+template <typename T>
+static inline T saturate(const float from)
+{
+  const float hi = float(std::numeric_limits<T>::max());
+  const float lo = float(std::numeric_limits<T>::min());
+  return T((from > hi)?hi:((from < lo)?lo:from));
+}
+
+static inline float cf32toCF32(const float from, const float gain) {return from * gain;}
+static inline int16_t cs16toCS16(const int16_t from, const float gain) {return saturate<int16_t>(from * gain);}
+static inline int8_t cs8toCS8(const int8_t from, const float gain) {return saturate<int8_t>(from * gain);}
+
+static inline int16_t cf32toCS16(const float from, const float gain) {return SoapySDR::F32toS16(from, gain);}
+static inline float cs16toCF32(const int16_t from, const float gain) {return SoapySDR::S16toF32(from, gain);}
+static inline uint16_t cf32toCU16(const float from, const float gain) {return SoapySDR::F32toU16(from, gain);}
+static inline float cu16toCF32(const uint16_t from, const float gain) {return SoapySDR::U16toF32(from, gain);}
+static inline int8_t cf32toCS8(const float from, const float gain) {return SoapySDR::F32toS8(from, gain);}
+static inline float cs8toCF32(const int8_t from, const float gain) {return SoapySDR::S8toF32(from, gain);}
+static inline uint8_t cf32toCU8(const float from, const float gain) {return SoapySDR::F32toU8(from, gain);}
+static inline float cu8toCF32(const uint8_t from, const float gain) {return SoapySDR::U8toF32(from, gain);}
+
+// Generic kernels for complex formats
+
+template <typename InType, typename OutType, OutType (*convert)(const InType, const float), float (*gainFor)(const double)>
+static void genericDeinterleave(const void *srcBuff, void * const *dstBuffs, const size_t numChans, const size_t stride, const size_t numElems, const double scaler)
+{
+  const size_t elemDepth = 2;
+  const float gain = gainFor(scaler);
+
+  auto *src = (const InType*)srcBuff;
+  for (size_t i = 0; i < numElems; i++)
+    {
+      const InType *in = src + i*stride*elemDepth;
+      for (size_t ch = 0; ch < numChans; ch++)
+        {
+          auto *dst = (OutType*)dstBuffs[ch] + i*elemDepth;
+          dst[0] = convert(in[ch*elemDepth+0], gain);
+          dst[1] = convert(in[ch*elemDepth+1], gain);
+        }
+    }
+}
+
+template <typename InType, typename OutType, OutType (*convert)(const InType, const float), float (*gainFor)(const double)>
+static void genericInterleave(const void * const *srcBuffs, void *dstBuff, const size_t numChans, const size_t stride, const size_t numElems, const double scaler)
+{
+  const size_t elemDepth = 2;
+  const float gain = gainFor(scaler);
+
+  auto *dst = (OutType*)dstBuff;
+  for (size_t i = 0; i < numElems; i++)
+    {
+      OutType *out = dst + i*stride*elemDepth;
+      for (size_t ch = 0; ch < numChans; ch++)
+        {
+          auto *src = (const InType*)srcBuffs[ch] + i*elemDepth;
+          out[ch*elemDepth+0] = convert(src[0], gain);
+          out[ch*elemDepth+1] = convert(src[1], gain);
+        }
+    }
+}
+
+#define REGISTER_GENERIC_INTERLEAVED(srcFmt, dstFmt, InType, OutType, convert, gainFor) \
+  static SoapySDR::ConverterRegistry registerDeinterleave ## convert(srcFmt, dstFmt, SoapySDR::ConverterRegistry::GENERIC, \
+    &genericDeinterleave<InType, OutType, convert, gainFor>); \
+  static SoapySDR::ConverterRegistry registerInterleave ## convert(srcFmt, dstFmt, SoapySDR::ConverterRegistry::GENERIC, \
+    &genericInterleave<InType, OutType, convert, gainFor>);
+
+/***********************************************************************
+ * Called by lateLoadDefaultConverters()
+ **********************************************************************/
+void lateLoadInterleavedConverters(void)
+{
+  REGISTER_GENERIC_INTERLEAVED(SOAPY_SDR_CF32, SOAPY_SDR_CF32, float, float, cf32toCF32, unityGain);
+  REGISTER_GENERIC_INTERLEAVED(SOAPY_SDR_CS16, SOAPY_SDR_CS16, int16_t, int16_t, cs16toCS16, unityGain);
+  REGISTER_GENERIC_INTERLEAVED(SOAPY_SDR_CS8, SOAPY_SDR_CS8, int8_t, int8_t, cs8toCS8, unityGain);
+  REGISTER_GENERIC_INTERLEAVED(SOAPY_SDR_CF32, SOAPY_SDR_CS16, float, int16_t, cf32toCS16, SoapySDR::F32toS16Gain);
+  REGISTER_GENERIC_INTERLEAVED(SOAPY_SDR_CS16, SOAPY_SDR_CF32, int16_t, float, cs16toCF32, SoapySDR::S16toF32Gain);
+  REGISTER_GENERIC_INTERLEAVED(SOAPY_SDR_CF32, SOAPY_SDR_CU16, float, uint16_t, cf32toCU16, SoapySDR::F32toS16Gain);
+  REGISTER_GENERIC_INTERLEAVED(SOAPY_SDR_CU16, SOAPY_SDR_CF32, uint16_t, float, cu16toCF32, SoapySDR::S16toF32Gain);
+  REGISTER_GENERIC_INTERLEAVED(SOAPY_SDR_CF32, SOAPY_SDR_CS8, float, int8_t, cf32toCS8, SoapySDR::F32toS8Gain);
+  REGISTER_GENERIC_INTERLEAVED(SOAPY_SDR_CS8, SOAPY_SDR_CF32, int8_t, float, cs8toCF32, SoapySDR::S8toF32Gain);
+  REGISTER_GENERIC_INTERLEAVED(SOAPY_SDR_CF32, SOAPY_SDR_CU8, float, uint8_t, cf32toCU8, SoapySDR::F32toS8Gain);
+  REGISTER_GENERIC_INTERLEAVED(SOAPY_SDR_CU8, SOAPY_SDR_CF32, uint8_t, float, cu8toCF32, SoapySDR::S8toF32Gain);
+}
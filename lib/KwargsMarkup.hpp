@@ -0,0 +1,41 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include <string>
+#include <cctype>
+#include <cstddef>
+
+/*!
+ * Parse "key0=value0, key1=value1" markup in a single pass.
+ * Each comma separated entry is split at its first '=',
+ * the key and value are trimmed of whitespace in place,
+ * and entries with an empty key are skipped.
+ * The callback receives (key, keyLen, val, valLen) pointers into the markup.
+ */
+template <typename Callback>
+void parseKwargsMarkup(const std::string &markup, const Callback &callback)
+{
+    const char *p = markup.data();
+    const size_t n = markup.size();
+    const auto space = [p](const size_t i){return std::isspace((unsigned char)p[i]) != 0;};
+
+    for (size_t start = 0; start < n;)
+    {
+        size_t end = markup.find(',', start);
+        if (end == std::string::npos) end = n;
+        size_t eq = markup.find('=', start);
+        if (eq == std::string::npos or eq > end) eq = end;
+
+        size_t keyBegin = start, keyEnd = eq;
+        while (keyBegin < keyEnd and space(keyBegin)) keyBegin++;
+        while (keyEnd > keyBegin and space(keyEnd-1)) keyEnd--;
+
+        size_t valBegin = (eq == end)?end:eq+1, valEnd = end;
+        while (valBegin < valEnd and space(valBegin)) valBegin++;
+        while (valEnd > valBegin and space(valEnd-1)) valEnd--;
+
+        if (keyEnd != keyBegin) callback(p+keyBegin, keyEnd-keyBegin, p+valBegin, valEnd-valBegin);
+        start = end+1;
+    }
+}
@@ -13,6 +13,16 @@ void SoapySDR::vlogf(const SoapySDRLogLevel logLevel, const char *format, va_lis
     return SoapySDR_vlogf(logLevel, format, argList);
 }
 
+void SoapySDR::vlogfLimited(const SoapySDRLogLevel logLevel, const char *format, va_list argList)
+{
+    return SoapySDR_vlogfLimited(logLevel, format, argList);
+}
+
+void SoapySDR::setLogRateLimit(const double periodSecs)
+{
+    SoapySDR_setLogRateLimit(periodSecs);
+}
+
 void SoapySDR::registerLogHandler(const LogHandler &handler)
 {
     return SoapySDR_registerLogHandler(handler);
@@ -22,3 +32,13 @@ void SoapySDR::setLogLevel(const LogLevel logLevel)
 {
     SoapySDR_setLogLevel(logLevel);
 }
+
+void SoapySDR::setLogAsync(const bool enable)
+{
+    SoapySDR_setLogAsync(enable);
+}
+
+size_t SoapySDR::getLogDropped(void)
+{
+    return SoapySDR_getLogDropped();
+}
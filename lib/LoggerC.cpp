@@ -1,11 +1,17 @@
 // Copyright (c) 2014-2017 Josh Blum
 // SPDX-License-Identifier: BSL-1.0
 
+#include "MPSCRing.hpp"
 #include <SoapySDR/Logger.h>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <string>
 #include <iostream>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
 
 /***********************************************************************
  * default log level supports environment variable
@@ -36,6 +42,17 @@ static SoapySDRLogLevel getDefaultLogLevel(void)
     return SoapySDRLogLevel(logLevelInt);
 }
 
+/***********************************************************************
+ * default rate limit supports environment variable
+ **********************************************************************/
+static long long getDefaultLogRateLimitNs(void)
+{
+    const std::string rateLimitEnvStr = getEnvImpl("SOAPY_SDR_LOG_RATE_LIMIT");
+    if (rateLimitEnvStr.empty()) return 1000000000ll;
+    const double periodSecs = std::atof(rateLimitEnvStr.c_str());
+    return (periodSecs > 0.0)?(long long)(periodSecs*1e9):0;
+}
+
 /***********************************************************************
  * Compatibility for vasprintf under MSVC
  **********************************************************************/
@@ -83,17 +100,156 @@ void defaultLogHandler(const SoapySDRLogLevel logLevel, const char *message)
 static SoapySDRLogHandler registeredLogHandler = &defaultLogHandler;
 static SoapySDRLogLevel registeredLogLevel = getDefaultLogLevel();
 
+/***********************************************************************
+ * Asynchronous log ring drained by a background thread
+ **********************************************************************/
+struct AsyncLogRecord
+{
+    SoapySDRLogLevel logLevel;
+    char message[SOAPY_SDR_ASYNC_LOG_MESSAGE_SIZE];
+};
+
+struct AsyncLogger
+{
+    AsyncLogger(void):
+        ring(1024),
+        enabled(false),
+        dropped(0),
+        reportedDropped(0)
+    {
+        return;
+    }
+
+    ~AsyncLogger(void)
+    {
+        this->stop();
+    }
+
+    void start(void)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (thread.joinable()) return;
+        enabled = true;
+        thread = std::thread(&AsyncLogger::work, this);
+    }
+
+    void stop(void)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (not thread.joinable()) return;
+        enabled = false;
+        thread.join();
+        this->drain();
+    }
+
+    void drain(void)
+    {
+        AsyncLogRecord record;
+        while (ring.pop(record)) registeredLogHandler(record.logLevel, record.message);
+
+        const size_t numDropped = dropped.load(std::memory_order_relaxed);
+        if (numDropped == reportedDropped) return;
+        char message[128];
+        std::snprintf(message, sizeof(message), "SoapySDR logger dropped %zu messages", numDropped-reportedDropped);
+        reportedDropped = numDropped;
+        registeredLogHandler(SOAPY_SDR_NOTICE, message);
+    }
+
+    void work(void)
+    {
+        while (enabled)
+        {
+            this->drain();
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+
+    MPSCRing<AsyncLogRecord> ring;
+    std::atomic<bool> enabled;
+    std::atomic<size_t> dropped;
+    size_t reportedDropped;
+    std::mutex mutex;
+    std::thread thread;
+};
+
+static AsyncLogger &getAsyncLogger(void)
+{
+    static AsyncLogger logger;
+    return logger;
+}
+
+template <typename Fill>
+static bool asyncLog(const SoapySDRLogLevel logLevel, const Fill &fill)
+{
+    auto &logger = getAsyncLogger();
+    if (not logger.enabled.load(std::memory_order_relaxed)) return false;
+    const bool ok = logger.ring.push([&](AsyncLogRecord &record){
+        record.logLevel = logLevel;
+        fill(record.message);
+    });
+    if (not ok) logger.dropped.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+/***********************************************************************
+ * Rate limit state keyed by format string address:
+ * A fixed open addressing table, slots are claimed once and never freed.
+ * Keys that do not fit in the table are logged without a limit.
+ **********************************************************************/
+static std::atomic<long long> logRateLimitNs(getDefaultLogRateLimitNs());
+
+struct RateLimitSlot
+{
+    RateLimitSlot(void):
+        key(nullptr),
+        windowStartNs(0),
+        suppressed(0)
+    {
+        return;
+    }
+
+    std::atomic<const char *> key;
+    std::atomic<long long> windowStartNs;
+    std::atomic<unsigned long long> suppressed;
+};
+
+static RateLimitSlot *getRateLimitSlot(const char *key)
+{
+    static const size_t numSlots = 256;
+    static RateLimitSlot slots[numSlots];
+    const size_t hash = (size_t(key) >> 3)*size_t(2654435761u);
+    for (size_t i = 0; i < numSlots; i++)
+    {
+        auto &slot = slots[(hash+i) % numSlots];
+        const char *current = slot.key.load(std::memory_order_acquire);
+        if (current == key) return &slot;
+        if (current != nullptr) continue;
+        if (slot.key.compare_exchange_strong(current, key) or current == key) return &slot;
+    }
+    return nullptr;
+}
+
 extern "C" {
 
 void SoapySDR_log(const SoapySDRLogLevel logLevel, const char *message)
 {
     if (logLevel > registeredLogLevel and logLevel != SOAPY_SDR_SSI) return;
+    if (asyncLog(logLevel, [message](char *out){
+        std::strncpy(out, message, SOAPY_SDR_ASYNC_LOG_MESSAGE_SIZE-1);
+        out[SOAPY_SDR_ASYNC_LOG_MESSAGE_SIZE-1] = '\0';
+    })) return;
     return registeredLogHandler(logLevel, message);
 }
 
 void SoapySDR_vlogf(const SoapySDRLogLevel logLevel, const char *format, va_list argList)
 {
     if (logLevel > registeredLogLevel) return;
+
+    //format directly into the ring in asynchronous mode
+    if (asyncLog(logLevel, [format, &argList](char *out){
+        std::vsnprintf(out, SOAPY_SDR_ASYNC_LOG_MESSAGE_SIZE, format, argList);
+    })) return;
+
     char *message = NULL;
     if (vasprintf(&message, format, argList) != -1)
     {
@@ -102,6 +258,40 @@ void SoapySDR_vlogf(const SoapySDRLogLevel logLevel, const char *format, va_list
     }
 }
 
+void SoapySDR_vlogfLimited(const SoapySDRLogLevel logLevel, const char *format, va_list argList)
+{
+    if (logLevel > registeredLogLevel) return;
+    const long long periodNs = logRateLimitNs.load(std::memory_order_relaxed);
+    RateLimitSlot *slot = (periodNs == 0)?nullptr:getRateLimitSlot(format);
+    if (slot == nullptr) return SoapySDR_vlogf(logLevel, format, argList);
+
+    //repeats within the period are only counted
+    const long long nowNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    long long startNs = slot->windowStartNs.load(std::memory_order_relaxed);
+    if ((startNs != 0 and nowNs-startNs < periodNs) or
+        not slot->windowStartNs.compare_exchange_strong(startNs, nowNs, std::memory_order_relaxed))
+    {
+        slot->suppressed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    const unsigned long long suppressed = slot->suppressed.exchange(0, std::memory_order_relaxed);
+    if (suppressed == 0) return SoapySDR_vlogf(logLevel, format, argList);
+
+    char *message = NULL;
+    if (vasprintf(&message, format, argList) != -1)
+    {
+        SoapySDR_logf(logLevel, "%s [%llu occurrences in last %.3g seconds]", message, suppressed+1, (nowNs-startNs)/1e9);
+        free(message);
+    }
+}
+
+void SoapySDR_setLogRateLimit(const double periodSecs)
+{
+    logRateLimitNs.store((periodSecs > 0.0)?(long long)(periodSecs*1e9):0);
+}
+
 void SoapySDR_registerLogHandler(const SoapySDRLogHandler handler)
 {
     registeredLogHandler = handler;
@@ -112,4 +302,15 @@ void SoapySDR_setLogLevel(const SoapySDRLogLevel logLevel)
     registeredLogLevel = logLevel;
 }
 
+void SoapySDR_setLogAsync(const bool enable)
+{
+    if (enable) getAsyncLogger().start();
+    else getAsyncLogger().stop();
+}
+
+size_t SoapySDR_getLogDropped(void)
+{
+    return getAsyncLogger().dropped.load(std::memory_order_relaxed);
+}
+
 }
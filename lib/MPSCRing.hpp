@@ -0,0 +1,85 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+/***********************************************************************
+ * Bounded lock-free queue for many producers and a single consumer.
+ * Each cell carries a sequence number that tells a producer when the
+ * cell is free and the consumer when the cell is filled. A push on a
+ * full ring fails immediately so that producers never block or allocate.
+ **********************************************************************/
+template <typename T>
+class MPSCRing
+{
+public:
+    MPSCRing(const size_t capacity):
+        _mask(roundUpPow2(capacity)-1),
+        _cells(_mask+1),
+        _writeIndex(0),
+        _readIndex(0)
+    {
+        for (size_t i = 0; i < _cells.size(); i++) _cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    //! Try to push an element, false when the ring is full
+    template <typename Fill>
+    bool push(const Fill &fill)
+    {
+        size_t index = _writeIndex.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            Cell &cell = _cells[index & _mask];
+            const size_t seq = cell.seq.load(std::memory_order_acquire);
+            const ptrdiff_t diff = ptrdiff_t(seq)-ptrdiff_t(index);
+            if (diff == 0)
+            {
+                if (_writeIndex.compare_exchange_weak(index, index+1, std::memory_order_relaxed))
+                {
+                    fill(cell.data);
+                    cell.seq.store(index+1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff < 0) return false;
+            else index = _writeIndex.load(std::memory_order_relaxed);
+        }
+    }
+
+    //! Try to pop an element (single consumer), false when empty
+    bool pop(T &data)
+    {
+        Cell &cell = _cells[_readIndex & _mask];
+        const size_t seq = cell.seq.load(std::memory_order_acquire);
+        if (seq != _readIndex+1) return false;
+        data = cell.data;
+        cell.seq.store(_readIndex+_mask+1, std::memory_order_release);
+        _readIndex++;
+        return true;
+    }
+
+private:
+    static size_t roundUpPow2(const size_t n)
+    {
+        size_t r = 1;
+        while (r < n) r <<= 1;
+        return r;
+    }
+
+    struct Cell
+    {
+        Cell(void): seq(0), data(){}
+        std::atomic<size_t> seq;
+        T data;
+    };
+
+    const size_t _mask;
+    std::vector<Cell> _cells;
+    char _pad0[64];
+    std::atomic<size_t> _writeIndex;
+    char _pad1[64];
+    size_t _readIndex;
+};
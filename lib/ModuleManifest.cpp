@@ -0,0 +1,218 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/Modules.hpp>
+#include <SoapySDR/Version.hpp>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <cstdio> //rename, remove
+#include <atomic>
+#include <fstream>
+#include <stdexcept>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <map>
+#include <mutex>
+
+#ifdef _MSC_VER
+#include <direct.h>
+#include <process.h>
+#define mkdir(path, mode) _mkdir(path)
+#define getpid() _getpid()
+#else
+#include <unistd.h> //getpid
+#endif
+
+/***********************************************************************
+ * Module loader shared data structures
+ **********************************************************************/
+std::string getEnvImpl(const char *name);
+
+std::map<std::string, void *> &getModuleHandles(void);
+
+std::recursive_mutex &getModuleMutex(void);
+
+/***********************************************************************
+ * Manifest entries identify a module file by its mtime and size
+ **********************************************************************/
+struct ManifestEntry
+{
+    long long mtime;
+    long long size;
+    std::string version;
+    std::vector<std::string> drivers;
+};
+
+typedef std::map<std::string, ManifestEntry> Manifest;
+
+static bool statModule(const std::string &path, long long &mtime, long long &size)
+{
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) return false;
+    mtime = (long long)info.st_mtime;
+    size = (long long)info.st_size;
+    return true;
+}
+
+static std::vector<std::string> splitString(const std::string &s, const char sep)
+{
+    std::vector<std::string> result;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, sep)) result.push_back(item);
+    return result;
+}
+
+/***********************************************************************
+ * Manifest file path
+ **********************************************************************/
+std::string SoapySDR::getModuleManifestPath(void)
+{
+    const std::string manifestEnv = getEnvImpl("SOAPY_SDR_MODULE_MANIFEST");
+    if (manifestEnv == "off") return "";
+    if (not manifestEnv.empty()) return manifestEnv;
+
+    const std::string fileName = "modules" + SoapySDR::getABIVersion() + ".manifest";
+    #ifdef _MSC_VER
+    const std::string localAppData = getEnvImpl("LOCALAPPDATA");
+    if (not localAppData.empty()) return localAppData + "\\SoapySDR\\" + fileName;
+    #else
+    const std::string cacheHome = getEnvImpl("XDG_CACHE_HOME");
+    if (not cacheHome.empty()) return cacheHome + "/SoapySDR/" + fileName;
+    const std::string home = getEnvImpl("HOME");
+    if (not home.empty()) return home + "/.cache/SoapySDR/" + fileName;
+    #endif
+    return "";
+}
+
+/***********************************************************************
+ * Read the manifest, an empty result when missing or from another ABI
+ **********************************************************************/
+static Manifest readModuleManifest(void)
+{
+    Manifest manifest;
+    const std::string path = SoapySDR::getModuleManifestPath();
+    if (path.empty()) return manifest;
+    std::ifstream file(path.c_str());
+    if (not file) return manifest;
+
+    std::string line;
+    if (not std::getline(file, line) or line != "abi\t" + SoapySDR::getABIVersion()) return manifest;
+    try
+    {
+        while (std::getline(file, line))
+        {
+            const auto fields = splitString(line, '\t');
+            if (fields.size() < 5 or fields[0] != "module") continue;
+            ManifestEntry &entry = manifest[fields[1]];
+            entry.mtime = std::stoll(fields[2]);
+            entry.size = std::stoll(fields[3]);
+            entry.version = fields[4];
+            if (fields.size() > 5) entry.drivers = splitString(fields[5], ',');
+        }
+    }
+    catch (const std::exception &)
+    {
+        //a corrupt manifest falls back to loading every module
+        manifest.clear();
+    }
+    return manifest;
+}
+
+bool lookupModuleManifest(const std::string &driver, std::vector<std::string> &paths)
+{
+    static const Manifest manifest = readModuleManifest();
+    if (manifest.empty()) return false;
+
+    paths.clear();
+    for (const auto &path : SoapySDR::listModules())
+    {
+        //modules that are new, changed, or without drivers (such as converters) always load
+        long long mtime(0), size(0);
+        const auto it = manifest.find(path);
+        if (it == manifest.end() or not statModule(path, mtime, size) or
+            it->second.mtime != mtime or it->second.size != size or
+            it->second.drivers.empty())
+        {
+            paths.push_back(path);
+            continue;
+        }
+        for (const auto &name : it->second.drivers)
+        {
+            if (name == driver) paths.push_back(path);
+        }
+    }
+    return true;
+}
+
+/***********************************************************************
+ * Write the manifest for the currently loaded modules
+ **********************************************************************/
+static void makeParentDirs(const std::string &path)
+{
+    for (size_t pos = path.find_first_of("/\\", 1); pos != std::string::npos; pos = path.find_first_of("/\\", pos+1))
+    {
+        mkdir(path.substr(0, pos).c_str(), 0755);
+    }
+}
+
+std::string SoapySDR::saveModuleManifest(void)
+{
+    const std::string path = SoapySDR::getModuleManifestPath();
+    if (path.empty()) return "module manifest disabled";
+
+    std::ostringstream content;
+    content << "abi\t" << SoapySDR::getABIVersion() << "\n";
+    {
+        std::lock_guard<std::recursive_mutex> lock(getModuleMutex());
+        for (const auto &it : getModuleHandles())
+        {
+            long long mtime(0), size(0);
+            if (not statModule(it.first, mtime, size)) continue;
+            std::string drivers;
+            for (const auto &result : SoapySDR::getLoaderResult(it.first))
+            {
+                if (not drivers.empty()) drivers += ",";
+                drivers += result.first;
+            }
+            content << "module\t" << it.first << "\t" << mtime << "\t" << size << "\t"
+                 << SoapySDR::getModuleVersion(it.first) << "\t" << drivers << "\n";
+        }
+    }
+
+    //loadModules() saves every time, only write when the modules changed
+    {
+        std::ifstream existing(path.c_str());
+        std::ostringstream current;
+        current << existing.rdbuf();
+        if (existing and current.str() == content.str()) return "";
+    }
+    makeParentDirs(path);
+
+    //write to a temporary file unique to this writer and rename
+    //so that readers and other processes never see a partial manifest
+    static std::atomic<unsigned> numSaves(0);
+    const std::string tmpPath = path + ".tmp." + std::to_string(getpid()) + "." + std::to_string(numSaves++);
+    {
+        std::ofstream file(tmpPath.c_str());
+        if (not file) return "failed to open " + tmpPath;
+        file << content.str();
+        if (not file)
+        {
+            file.close();
+            std::remove(tmpPath.c_str());
+            return "failed to write " + tmpPath;
+        }
+    }
+
+#ifdef _MSC_VER
+    std::remove(path.c_str()); //rename does not replace an existing file on windows
+#endif
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0)
+    {
+        std::remove(tmpPath.c_str());
+        return "failed to rename " + tmpPath;
+    }
+    return "";
+}
@@ -4,11 +4,16 @@
 #include <SoapySDR/Modules.hpp>
 #include <SoapySDR/Logger.hpp>
 #include <SoapySDR/Version.hpp>
+#include <SoapySDR/Tracer.hpp>
 #include <vector>
 #include <string>
 #include <cstdlib> //getenv
+#include <algorithm>
 #include <sstream>
 #include <map>
+#include <mutex>
+#include <thread>
+#include <atomic>
 
 #ifdef _MSC_VER
 #include <windows.h>
@@ -175,11 +180,20 @@ std::map<std::string, void *> &getModuleHandles(void)
     return handles;
 }
 
-//! share the module path during loadModule
-std::string &getModuleLoading(void)
+//! guard the module tables, which loader threads register into
+std::recursive_mutex &getModuleMutex(void)
 {
-    static std::string moduleLoading;
-    return moduleLoading;
+    static std::recursive_mutex mutex;
+    return mutex;
+}
+
+//! share the module path during loadModule, per thread for parallel loads
+static thread_local const std::string *moduleLoading = nullptr;
+
+const std::string &getModuleLoading(void)
+{
+    static const std::string none;
+    return (moduleLoading == nullptr)?none:*moduleLoading;
 }
 
 //! share registration errors during loadModule
@@ -197,6 +211,7 @@ std::map<std::string, std::string> &getModuleVersions(void)
 
 SoapySDR::ModuleVersion::ModuleVersion(const std::string &version)
 {
+    std::lock_guard<std::recursive_mutex> lock(getModuleMutex());
     getModuleVersions()[getModuleLoading()] = version;
 }
 
@@ -224,16 +239,19 @@ static std::string GetLastErrorMessage(void)
 
 static bool enableAutomaticLoadModules(true);
 
-std::string SoapySDR::loadModule(const std::string &path)
+static std::string loadModuleImpl(const std::string &path)
 {
-    //disable automatic load modules when individual modules are manually loaded
-    enableAutomaticLoadModules = false;
+    SoapySDR::TraceScope trace("loadModule", "modules");
 
     //check if already loaded
-    if (getModuleHandles().count(path) != 0) return path + " already loaded";
+    {
+        std::lock_guard<std::recursive_mutex> lock(getModuleMutex());
+        if (getModuleHandles().count(path) != 0) return path + " already loaded";
+    }
 
-    //stash the path for registry access
-    getModuleLoading().assign(path);
+    //stash the path for registry access,
+    //the lock is not held because registrations lock from within the loader
+    moduleLoading = &path;
 
     //load the module
 #ifdef _MSC_VER
@@ -244,27 +262,38 @@ std::string SoapySDR::loadModule(const std::string &path)
     HMODULE handle = LoadLibrary(path.c_str());
     SetThreadErrorMode(oldMode, nullptr);
 
-    getModuleLoading().clear();
+    moduleLoading = nullptr;
     if (handle == NULL) return "LoadLibrary() failed: " + GetLastErrorMessage();
 #else
     void *handle = dlopen(path.c_str(), RTLD_LAZY);
-    getModuleLoading().clear();
+    moduleLoading = nullptr;
     if (handle == NULL) return "dlopen() failed: " + std::string(dlerror());
 #endif
 
     //stash the handle
+    std::lock_guard<std::recursive_mutex> lock(getModuleMutex());
     getModuleHandles()[path] = handle;
     return "";
 }
 
+std::string SoapySDR::loadModule(const std::string &path)
+{
+    //disable automatic load modules when individual modules are manually loaded
+    enableAutomaticLoadModules = false;
+
+    return loadModuleImpl(path);
+}
+
 SoapySDR::Kwargs SoapySDR::getLoaderResult(const std::string &path)
 {
+    std::lock_guard<std::recursive_mutex> lock(getModuleMutex());
     if (getLoaderResults().count(path) == 0) return SoapySDR::Kwargs();
     return getLoaderResults()[path];
 }
 
 std::string SoapySDR::getModuleVersion(const std::string &path)
 {
+    std::lock_guard<std::recursive_mutex> lock(getModuleMutex());
     if (getModuleVersions().count(path) == 0) return "";
     return getModuleVersions()[path];
 }
@@ -272,49 +301,147 @@ std::string SoapySDR::getModuleVersion(const std::string &path)
 std::string SoapySDR::unloadModule(const std::string &path)
 {
     //check if already loaded
-    if (getModuleHandles().count(path) == 0) return path + " never loaded";
+    void *handle = nullptr;
+    {
+        std::lock_guard<std::recursive_mutex> lock(getModuleMutex());
+        if (getModuleHandles().count(path) == 0) return path + " never loaded";
+        handle = getModuleHandles()[path];
+    }
 
     //stash the path for registry access
-    getModuleLoading().assign(path);
+    moduleLoading = &path;
 
     //unload the module
-    void *handle = getModuleHandles()[path];
 #ifdef _MSC_VER
     BOOL success = FreeLibrary((HMODULE)handle);
-    getModuleLoading().clear();
+    moduleLoading = nullptr;
     if (not success) return "FreeLibrary() failed: " + GetLastErrorMessage();
 #else
     int status = dlclose(handle);
-    getModuleLoading().clear();
+    moduleLoading = nullptr;
     if (status != 0) return "dlclose() failed: " + std::string(dlerror());
 #endif
 
     //clear the handle
+    std::lock_guard<std::recursive_mutex> lock(getModuleMutex());
     getLoaderResults().erase(path);
     getModuleVersions().erase(path);
     getModuleHandles().erase(path);
     return "";
 }
 
+/***********************************************************************
+ * module references held while driver code runs in other threads
+ **********************************************************************/
+void *acquireModule(const std::string &path)
+{
+    //drivers without a path are built into the library
+    if (path.empty()) return nullptr;
+#ifdef _MSC_VER
+    HMODULE handle = NULL;
+    GetModuleHandleExA(0, path.c_str(), &handle);
+    return handle;
+#else
+    return dlopen(path.c_str(), RTLD_LAZY | RTLD_NOLOAD);
+#endif
+}
+
+void releaseModule(void *handle)
+{
+    if (handle == nullptr) return;
+#ifdef _MSC_VER
+    FreeLibrary((HMODULE)handle);
+#else
+    dlclose(handle);
+#endif
+}
+
 /***********************************************************************
  * load modules API call
  **********************************************************************/
 
 void lateLoadNullDevice(void);
 
-void automaticLoadModules(void)
+bool lookupModuleManifest(const std::string &driver, std::vector<std::string> &paths);
+
+static size_t getModuleLoadThreads(void)
+{
+    const std::string threadsEnv = getEnvImpl("SOAPY_SDR_MODULE_LOAD_THREADS");
+    if (threadsEnv.empty()) return 1;
+    const auto numThreads = std::strtoul(threadsEnv.c_str(), nullptr, 10);
+    if (numThreads != 0) return numThreads;
+    return std::max<size_t>(1, std::thread::hardware_concurrency()); //0 means one per core
+}
+
+static void loadModulePaths(const std::vector<std::string> &allPaths)
+{
+    std::vector<std::string> paths;
+    {
+        std::lock_guard<std::recursive_mutex> lock(getModuleMutex());
+        for (const auto &path : allPaths)
+        {
+            if (getModuleHandles().count(path) == 0) paths.push_back(path); //not manually loaded
+        }
+    }
+
+    //load on a pool of threads that each take the next path,
+    //with the calling thread as one of the loaders
+    std::vector<std::string> errorMsgs(paths.size());
+    std::atomic<size_t> next(0);
+    const auto loader = [&paths, &errorMsgs, &next](void)
+    {
+        for (size_t i = next++; i < paths.size(); i = next++)
+        {
+            errorMsgs[i] = loadModuleImpl(paths[i]);
+        }
+    };
+    static const size_t numThreads = getModuleLoadThreads();
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < std::min(numThreads, paths.size()); i++) threads.push_back(std::thread(loader));
+    loader();
+    for (auto &thread : threads) thread.join();
+
+    //report errors in path order once every module is loaded
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        const std::string &errorMsg = errorMsgs[i];
+        if (not errorMsg.empty()) SoapySDR::logf(SOAPY_SDR_ERROR, "SoapySDR::loadModule(%s)\n  %s", paths[i].c_str(), errorMsg.c_str());
+        for (const auto &it : SoapySDR::getLoaderResult(paths[i]))
+        {
+            if (it.second.empty()) continue;
+            SoapySDR::logf(SOAPY_SDR_ERROR, "SoapySDR::loadModule(%s)\n  %s", paths[i].c_str(), it.second.c_str());
+        }
+    }
+}
+
+void automaticLoadModules(const std::string &driver)
 {
     //loaded variable makes automatic load a one-shot
     static bool loaded = false;
     if (loaded) return;
-    loaded = true;
 
     //initialize any static units in the library
     //rather than rely on static initialization
     lateLoadNullDevice();
 
     //load the modules when not otherwise disabled
-    if (enableAutomaticLoadModules) SoapySDR::loadModules();
+    if (not enableAutomaticLoadModules)
+    {
+        loaded = true;
+        return;
+    }
+
+    //a driver key only needs the modules that the manifest lists for it,
+    //the remaining modules are loaded once a wildcard lookup needs them
+    std::vector<std::string> paths;
+    if (not driver.empty() and lookupModuleManifest(driver, paths))
+    {
+        loadModulePaths(paths);
+        return;
+    }
+
+    loaded = true;
+    SoapySDR::loadModules();
 }
 
 void SoapySDR::loadModules(void)
@@ -323,16 +450,9 @@ void SoapySDR::loadModules(void)
     //rather than rely on static initialization
     lateLoadNullDevice();
 
-    const auto paths = listModules();
-    for (size_t i = 0; i < paths.size(); i++)
-    {
-        if (getModuleHandles().count(paths[i]) != 0) continue; //was manually loaded
-        const std::string errorMsg = loadModule(paths[i]);
-        if (not errorMsg.empty()) SoapySDR::logf(SOAPY_SDR_ERROR, "SoapySDR::loadModule(%s)\n  %s", paths[i].c_str(), errorMsg.c_str());
-        for (const auto &it : SoapySDR::getLoaderResult(paths[i]))
-        {
-            if (it.second.empty()) continue;
-            SoapySDR::logf(SOAPY_SDR_ERROR, "SoapySDR::loadModule(%s)\n  %s", paths[i].c_str(), it.second.c_str());
-        }
-    }
+    loadModulePaths(listModules());
+
+    //cache the driver keys of each module for the next automatic load
+    const std::string errorMsg = SoapySDR::saveModuleManifest();
+    if (not errorMsg.empty()) SoapySDR::logf(SOAPY_SDR_DEBUG, "SoapySDR::saveModuleManifest()\n  %s", errorMsg.c_str());
 }
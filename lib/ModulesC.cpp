@@ -55,4 +55,14 @@ void SoapySDR_loadModules(void)
     SoapySDR::loadModules();
 }
 
+char *SoapySDR_getModuleManifestPath(void)
+{
+    return strdup(SoapySDR::getModuleManifestPath().c_str());
+}
+
+char *SoapySDR_saveModuleManifest(void)
+{
+    return strdup(SoapySDR::saveModuleManifest().c_str());
+}
+
 }
@@ -1,17 +1,152 @@
-// Copyright (c) 2014-2015 Josh Blum
+// Copyright (c) 2014-2018 Josh Blum
 // SPDX-License-Identifier: BSL-1.0
 
+#include "StreamNotifier.hpp"
 #include <SoapySDR/Device.hpp>
 #include <SoapySDR/Registry.hpp>
+#include <SoapySDR/ConverterRegistry.hpp>
+#include <SoapySDR/Formats.hpp>
+#include <SoapySDR/Time.hpp>
+#include <condition_variable>
+#include <stdexcept>
+#include <algorithm>
+#include <complex>
+#include <cstring>
+#include <cstdint>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <deque>
+#include <mutex>
+#include <cmath>
+#include <map>
+
+/***********************************************************************
+ * A synthetic device for benchmarking the stream paths without hardware.
+ *
+ * Device arguments, also available as settings:
+ *  - source: zeros (default), tone, noise, or loopback of the TX samples
+ *  - tone_freq: tone offset frequency in Hz (default rate/8)
+ *  - amplitude: tone and noise amplitude in full scale (default 0.5)
+ *  - paced: true to stream at the sample rate, false to run unthrottled
+ * Device arguments only:
+ *  - channels: the number of RX and TX channels (default 1)
+ *  - mtu: the default stream MTU in elements, also a stream argument
+ *  - loopback_size: the loopback buffer size in elements per channel
+ *
+ * Stream timestamps count samples at the sample rate from activation,
+ * the hardware time follows the host clock and can be set.
+ * The poll handle of a stream prefetches RX transfers
+ * or queues the TX status in a notifier thread.
+ **********************************************************************/
+enum NullSource
+{
+    SOURCE_ZEROS,
+    SOURCE_TONE,
+    SOURCE_NOISE,
+    SOURCE_LOOPBACK
+};
+
+static NullSource toNullSource(const std::string &name)
+{
+    if (name == "zeros") return SOURCE_ZEROS;
+    if (name == "tone") return SOURCE_TONE;
+    if (name == "noise") return SOURCE_NOISE;
+    if (name == "loopback") return SOURCE_LOOPBACK;
+    throw std::invalid_argument("NullDevice unknown source " + name);
+}
+
+static const char *fromNullSource(const int source)
+{
+    switch (source)
+    {
+    case SOURCE_TONE: return "tone";
+    case SOURCE_NOISE: return "noise";
+    case SOURCE_LOOPBACK: return "loopback";
+    default: return "zeros";
+    }
+}
+
+static const size_t numDirectBuffs = 4;
+
+struct NullStream
+{
+    int direction;
+    std::string format;
+    size_t elemSize;
+    std::vector<size_t> channels;
+    size_t mtu;
+    SoapySDR::Kwargs args;
+
+    //generated samples are converted from CF32 unless the format is CF32
+    SoapySDR::ConverterRegistry::ConverterFunction fromCF32;
+    std::vector<std::complex<float>> scratch;
+    std::vector<std::complex<double>> phasors;
+    uint64_t rng;
+
+    //stream timestamps in sample ticks, a notifier thread may end the burst
+    std::atomic<bool> active;
+    SoapySDR::TickConverter ticks;
+    long long tick;
+    size_t burstRemaining;
+
+    //direct access buffers, one block of channels per handle
+    std::vector<std::vector<char>> directMem;
+    std::vector<bool> directInUse;
+    size_t directNext;
+
+    std::unique_ptr<SoapySDR::StreamNotifier> notifier;
+};
+
+struct NullStatus
+{
+    size_t chanMask;
+    int flags;
+    long long timeNs;
+};
+
+struct NullLoopback
+{
+    NullLoopback(void):
+        readPos(0),
+        count(0)
+    {
+        return;
+    }
+
+    std::vector<char> data;
+    size_t readPos;
+    size_t count;
+};
 
 class NullDevice : public SoapySDR::Device
 {
 public:
-    NullDevice(void)
+    NullDevice(const SoapySDR::Kwargs &args):
+        _numChannels(1),
+        _mtu(1024),
+        _loopbackSize(1 << 16),
+        _source(SOURCE_ZEROS),
+        _toneFreq(-1.0),
+        _amplitude(0.5),
+        _paced(false),
+        _timeEpoch(std::chrono::steady_clock::now()),
+        _timeOffset(0)
     {
-        return;
+        _rate[SOAPY_SDR_TX] = _rate[SOAPY_SDR_RX] = 1e6;
+        if (args.count("channels") != 0) _numChannels = std::max<size_t>(1, std::stoul(args.at("channels")));
+        if (args.count("mtu") != 0) _mtu = std::max<size_t>(1, std::stoul(args.at("mtu")));
+        if (args.count("loopback_size") != 0) _loopbackSize = std::max<size_t>(1, std::stoul(args.at("loopback_size")));
+        for (const auto &key : {"source", "tone_freq", "amplitude", "paced"})
+        {
+            if (args.count(key) != 0) this->writeSetting(key, args.at(key));
+        }
     }
 
+    /*******************************************************************
+     * Identification API
+     ******************************************************************/
     std::string getDriverKey(void) const
     {
         return "null";
@@ -21,6 +156,655 @@ public:
     {
         return "null";
     }
+
+    /*******************************************************************
+     * Channels API
+     ******************************************************************/
+    size_t getNumChannels(const int) const
+    {
+        return _numChannels;
+    }
+
+    bool getFullDuplex(const int, const size_t) const
+    {
+        return true;
+    }
+
+    /*******************************************************************
+     * Stream API
+     ******************************************************************/
+    std::vector<std::string> getStreamFormats(const int, const size_t) const
+    {
+        std::vector<std::string> formats(1, SOAPY_SDR_CF32);
+        for (const auto &format : SoapySDR::ConverterRegistry::listTargetFormats(SOAPY_SDR_CF32))
+        {
+            if (format != SOAPY_SDR_CF32) formats.push_back(format);
+        }
+        return formats;
+    }
+
+    std::string getNativeStreamFormat(const int, const size_t, double &fullScale) const
+    {
+        fullScale = 1.0;
+        return SOAPY_SDR_CF32;
+    }
+
+    SoapySDR::ArgInfoList getStreamArgsInfo(const int, const size_t) const
+    {
+        SoapySDR::ArgInfo mtuArg;
+        mtuArg.key = "mtu";
+        mtuArg.value = std::to_string(_mtu);
+        mtuArg.name = "MTU";
+        mtuArg.description = "The maximum number of elements per stream call";
+        mtuArg.units = "elements";
+        mtuArg.type = SoapySDR::ArgInfo::INT;
+        return SoapySDR::ArgInfoList(1, mtuArg);
+    }
+
+    SoapySDR::Stream *setupStream(const int direction, const std::string &format, const std::vector<size_t> &channels_, const SoapySDR::Kwargs &args)
+    {
+        auto channels = channels_;
+        if (channels.empty()) channels.push_back(0);
+        for (const auto ch : channels)
+        {
+            if (ch >= _numChannels) throw std::runtime_error("NullDevice::setupStream() invalid channel " + std::to_string(ch));
+        }
+
+        std::unique_ptr<NullStream> stream(new NullStream());
+        stream->direction = direction;
+        stream->format = format;
+        stream->elemSize = SoapySDR::formatToSize(format);
+        stream->channels = channels;
+        stream->mtu = (args.count("mtu") != 0)?std::max<size_t>(1, std::stoul(args.at("mtu"))):_mtu;
+        stream->args = args;
+        stream->fromCF32 = (format == SOAPY_SDR_CF32)?nullptr:SoapySDR::ConverterRegistry::getFunction(SOAPY_SDR_CF32, format);
+        stream->scratch.resize(stream->mtu);
+        stream->phasors.assign(channels.size(), std::complex<double>(1.0, 0.0));
+        stream->rng = 0x9E3779B97F4A7C15ull;
+        stream->active = false;
+        stream->tick = 0;
+        stream->burstRemaining = 0;
+        stream->directMem.resize(numDirectBuffs, std::vector<char>(channels.size()*stream->mtu*stream->elemSize));
+        stream->directInUse.assign(numDirectBuffs, false);
+        stream->directNext = 0;
+
+        if (direction == SOAPY_SDR_TX)
+        {
+            std::lock_guard<std::mutex> lock(_loopMutex);
+            _loopFormat = format;
+            _loopElemSize = stream->elemSize;
+            _loopback.assign(_numChannels, NullLoopback());
+            for (auto &loop : _loopback) loop.data.resize(_loopbackSize*stream->elemSize);
+        }
+        return reinterpret_cast<SoapySDR::Stream *>(stream.release());
+    }
+
+    void closeStream(SoapySDR::Stream *handle)
+    {
+        std::unique_ptr<NullStream> stream(reinterpret_cast<NullStream *>(handle));
+        stream->notifier.reset();
+    }
+
+    size_t getStreamMTU(SoapySDR::Stream *handle) const
+    {
+        return reinterpret_cast<NullStream *>(handle)->mtu;
+    }
+
+    int activateStream(SoapySDR::Stream *handle, const int flags, const long long timeNs, const size_t numElems)
+    {
+        auto stream = reinterpret_cast<NullStream *>(handle);
+        if (stream->notifier) stream->notifier->stop();
+        stream->ticks = SoapySDR::TickConverter(_rate[stream->direction]);
+        stream->tick = stream->ticks.timeNsToTicks(((flags & SOAPY_SDR_HAS_TIME) != 0)?timeNs:this->getHardwareTime());
+        stream->burstRemaining = numElems;
+        stream->active = true;
+        if (stream->notifier) stream->notifier->start(_rate[stream->direction]);
+        return 0;
+    }
+
+    int deactivateStream(SoapySDR::Stream *handle, const int, const long long)
+    {
+        auto stream = reinterpret_cast<NullStream *>(handle);
+        if (stream->notifier) stream->notifier->stop();
+        stream->active = false;
+        return 0;
+    }
+
+    int readStream(SoapySDR::Stream *handle, void * const *buffs, const size_t numElems, int &flags, long long &timeNs, const long timeoutUs)
+    {
+        auto stream = reinterpret_cast<NullStream *>(handle);
+        auto *reader = readerOf(stream);
+        const int ret = (reader != nullptr)?
+            reader->readStream(buffs, numElems, flags, timeNs, timeoutUs):
+            this->readTransfer(stream, buffs, numElems, flags, timeNs, timeoutUs);
+        if (reader != nullptr) stream->notifier->refresh();
+        return ret;
+    }
+
+    int writeStream(SoapySDR::Stream *handle, const void * const *buffs, const size_t numElems, int &flags, const long long timeNs, const long timeoutUs)
+    {
+        auto stream = reinterpret_cast<NullStream *>(handle);
+        const int ret = this->writeTransfer(stream, buffs, numElems, flags, timeNs, timeoutUs);
+        return ret;
+    }
+
+    int readStreamStatus(SoapySDR::Stream *handle, size_t &chanMask, int &flags, long long &timeNs, const long timeoutUs)
+    {
+        auto stream = reinterpret_cast<NullStream *>(handle);
+        if (stream->notifier and stream->direction == SOAPY_SDR_TX) return stream->notifier->readStreamStatus(chanMask, flags, timeNs, timeoutUs);
+        return this->readStatus(stream, chanMask, flags, timeNs, timeoutUs);
+    }
+
+    int getStreamPollHandle(SoapySDR::Stream *handle, intptr_t &pollHandle)
+    {
+        auto stream = reinterpret_cast<NullStream *>(handle);
+        if (not stream->notifier) this->makeNotifier(stream);
+        pollHandle = stream->notifier->handle();
+        return 0;
+    }
+
+    /*******************************************************************
+     * Direct buffer access API
+     ******************************************************************/
+    size_t getNumDirectAccessBuffers(SoapySDR::Stream *handle)
+    {
+        auto *reader = readerOf(reinterpret_cast<NullStream *>(handle));
+        return (reader != nullptr)?reader->getNumDirectAccessBuffers():numDirectBuffs;
+    }
+
+    int getDirectAccessBufferAddrs(SoapySDR::Stream *handle, const size_t index, void **buffs)
+    {
+        auto stream = reinterpret_cast<NullStream *>(handle);
+        if (auto *reader = readerOf(stream)) return reader->getDirectAccessBufferAddrs(index, buffs);
+        return this->directBufferAddrs(stream, index, buffs);
+    }
+
+    int acquireReadBuffer(SoapySDR::Stream *handle, size_t &index, const void **buffs, int &flags, long long &timeNs, const long timeoutUs)
+    {
+        auto stream = reinterpret_cast<NullStream *>(handle);
+        auto *reader = readerOf(stream);
+        const int ret = (reader != nullptr)?
+            reader->acquireReadBuffer(index, buffs, flags, timeNs, timeoutUs):
+            this->acquireDirectRead(stream, index, buffs, flags, timeNs, timeoutUs);
+        if (reader != nullptr) stream->notifier->refresh();
+        return ret;
+    }
+
+    void releaseReadBuffer(SoapySDR::Stream *handle, const size_t index)
+    {
+        auto stream = reinterpret_cast<NullStream *>(handle);
+        auto *reader = readerOf(stream);
+        if (reader == nullptr)
+        {
+            if (index < numDirectBuffs) stream->directInUse[index] = false;
+            return;
+        }
+        reader->releaseReadBuffer(index);
+        stream->notifier->refresh();
+    }
+
+    int acquireWriteBuffer(SoapySDR::Stream *handle, size_t &index, void **buffs, const long)
+    {
+        auto stream = reinterpret_cast<NullStream *>(handle);
+        if (not this->acquireDirect(stream, index)) return SOAPY_SDR_STREAM_ERROR;
+        this->directBufferAddrs(stream, index, buffs);
+        return int(stream->mtu);
+    }
+
+    void releaseWriteBuffer(SoapySDR::Stream *handle, const size_t index, const size_t numElems, int &flags, const long long timeNs)
+    {
+        auto stream = reinterpret_cast<NullStream *>(handle);
+        if (index >= numDirectBuffs) return;
+        std::vector<void *> ptrs(stream->channels.size());
+        this->directBufferAddrs(stream, index, ptrs.data());
+        std::vector<const void *> cptrs(ptrs.begin(), ptrs.end());
+        this->writeStream(handle, cptrs.data(), numElems, flags, timeNs, 100000);
+        stream->directInUse[index] = false;
+    }
+
+    /*******************************************************************
+     * Frequency, gain, and sample rate API
+     ******************************************************************/
+    std::vector<std::string> listAntennas(const int direction, const size_t) const
+    {
+        return std::vector<std::string>(1, (direction == SOAPY_SDR_RX)?"RX":"TX");
+    }
+
+    std::string getAntenna(const int direction, const size_t) const
+    {
+        return (direction == SOAPY_SDR_RX)?"RX":"TX";
+    }
+
+    std::vector<std::string> listGains(const int, const size_t) const
+    {
+        return std::vector<std::string>(1, "PGA");
+    }
+
+    void setGain(const int direction, const size_t channel, const std::string &, const double value)
+    {
+        std::lock_guard<std::mutex> lock(_settingsMutex);
+        _gains[std::make_pair(direction, channel)] = value;
+    }
+
+    double getGain(const int direction, const size_t channel, const std::string &) const
+    {
+        std::lock_guard<std::mutex> lock(_settingsMutex);
+        const auto it = _gains.find(std::make_pair(direction, channel));
+        return (it == _gains.end())?0.0:it->second;
+    }
+
+    SoapySDR::Range getGainRange(const int, const size_t, const std::string &) const
+    {
+        return SoapySDR::Range(0.0, 60.0, 1.0);
+    }
+
+    void setFrequency(const int direction, const size_t channel, const std::string &, const double frequency, const SoapySDR::Kwargs &)
+    {
+        std::lock_guard<std::mutex> lock(_settingsMutex);
+        _frequencies[std::make_pair(direction, channel)] = frequency;
+    }
+
+    double getFrequency(const int direction, const size_t channel, const std::string &) const
+    {
+        std::lock_guard<std::mutex> lock(_settingsMutex);
+        const auto it = _frequencies.find(std::make_pair(direction, channel));
+        return (it == _frequencies.end())?0.0:it->second;
+    }
+
+    std::vector<std::string> listFrequencies(const int, const size_t) const
+    {
+        return std::vector<std::string>(1, "RF");
+    }
+
+    SoapySDR::RangeList getFrequencyRange(const int, const size_t, const std::string &) const
+    {
+        return SoapySDR::RangeList(1, SoapySDR::Range(0.0, 6e9));
+    }
+
+    void setSampleRate(const int direction, const size_t, const double rate)
+    {
+        if (not (rate > 0.0)) throw std::invalid_argument("NullDevice::setSampleRate() rate must be positive");
+        _rate[direction] = rate;
+    }
+
+    double getSampleRate(const int direction, const size_t) const
+    {
+        return _rate[direction];
+    }
+
+    SoapySDR::RangeList getSampleRateRange(const int, const size_t) const
+    {
+        return SoapySDR::RangeList(1, SoapySDR::Range(1.0, 1e9));
+    }
+
+    /*******************************************************************
+     * Time API
+     ******************************************************************/
+    bool hasHardwareTime(const std::string &what) const
+    {
+        return what.empty();
+    }
+
+    long long getHardwareTime(const std::string & = "") const
+    {
+        const auto elapsed = std::chrono::steady_clock::now() - _timeEpoch;
+        return _timeOffset + std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    }
+
+    void setHardwareTime(const long long timeNs, const std::string &)
+    {
+        const auto elapsed = std::chrono::steady_clock::now() - _timeEpoch;
+        _timeOffset = timeNs - std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    }
+
+    /*******************************************************************
+     * Settings API
+     ******************************************************************/
+    SoapySDR::ArgInfoList getSettingInfo(void) const
+    {
+        SoapySDR::ArgInfoList infos;
+
+        SoapySDR::ArgInfo source;
+        source.key = "source";
+        source.value = "zeros";
+        source.name = "Source";
+        source.description = "The RX sample source";
+        source.type = SoapySDR::ArgInfo::STRING;
+        source.options = {"zeros", "tone", "noise", "loopback"};
+        infos.push_back(source);
+
+        SoapySDR::ArgInfo toneFreq;
+        toneFreq.key = "tone_freq";
+        toneFreq.value = "0";
+        toneFreq.name = "Tone frequency";
+        toneFreq.description = "The tone offset frequency, negative for rate/8";
+        toneFreq.units = "Hz";
+        toneFreq.type = SoapySDR::ArgInfo::FLOAT;
+        infos.push_back(toneFreq);
+
+        SoapySDR::ArgInfo amplitude;
+        amplitude.key = "amplitude";
+        amplitude.value = "0.5";
+        amplitude.name = "Amplitude";
+        amplitude.description = "The tone and noise amplitude in full scale";
+        amplitude.type = SoapySDR::ArgInfo::FLOAT;
+        amplitude.range = SoapySDR::Range(0.0, 1.0);
+        infos.push_back(amplitude);
+
+        SoapySDR::ArgInfo paced;
+        paced.key = "paced";
+        paced.value = "false";
+        paced.name = "Paced";
+        paced.description = "Stream at the sample rate rather than unthrottled";
+        paced.type = SoapySDR::ArgInfo::BOOL;
+        infos.push_back(paced);
+
+        return infos;
+    }
+
+    void writeSetting(const std::string &key, const std::string &value)
+    {
+        if (key == "source") _source = toNullSource(value);
+        else if (key == "tone_freq") _toneFreq = std::stod(value);
+        else if (key == "amplitude") _amplitude = std::stod(value);
+        else if (key == "paced") _paced = (value == "true");
+        else throw std::invalid_argument("NullDevice unknown setting " + key);
+    }
+
+    std::string readSetting(const std::string &key) const
+    {
+        if (key == "source") return fromNullSource(_source);
+        if (key == "tone_freq") return std::to_string(double(_toneFreq));
+        if (key == "amplitude") return std::to_string(double(_amplitude));
+        if (key == "paced") return _paced?"true":"false";
+        throw std::invalid_argument("NullDevice unknown setting " + key);
+    }
+
+private:
+
+    //the synchronous receive, called by readStream() or by the notifier thread
+    int readTransfer(NullStream *stream, void * const *buffs, const size_t numElems, int &flags, long long &timeNs, const long timeoutUs)
+    {
+        const auto exit = std::chrono::steady_clock::now() + std::chrono::microseconds(timeoutUs);
+        flags = 0;
+        if (not stream->active)
+        {
+            std::this_thread::sleep_until(exit);
+            return SOAPY_SDR_TIMEOUT;
+        }
+
+        size_t n = std::min(numElems, stream->mtu);
+        if (stream->burstRemaining != 0) n = std::min(n, stream->burstRemaining);
+
+        //paced streams deliver the samples whose time has passed by the timeout
+        if (_paced)
+        {
+            const long long endNs = stream->ticks.ticksToTimeNs(stream->tick + (long long)(n));
+            this->waitForTime(endNs, exit);
+            const long long available = stream->ticks.timeNsToTicks(this->getHardwareTime()) - stream->tick;
+            if (available <= 0) return SOAPY_SDR_TIMEOUT;
+            n = std::min(n, size_t(available));
+        }
+
+        const int source = _source;
+        if (source == SOURCE_LOOPBACK)
+        {
+            const int ret = this->readLoopback(stream, buffs, n, exit);
+            if (ret <= 0) return ret;
+            n = size_t(ret);
+        }
+        else for (size_t i = 0; i < stream->channels.size(); i++)
+        {
+            this->generate(stream, i, buffs[i], n, source);
+        }
+
+        flags |= SOAPY_SDR_HAS_TIME;
+        timeNs = stream->ticks.ticksToTimeNs(stream->tick);
+        stream->tick += (long long)(n);
+        if (stream->burstRemaining != 0)
+        {
+            stream->burstRemaining -= n;
+            if (stream->burstRemaining == 0)
+            {
+                flags |= SOAPY_SDR_END_BURST;
+                stream->active = false;
+            }
+        }
+        return int(n);
+    }
+
+    //the synchronous transmit
+    int writeTransfer(NullStream *stream, const void * const *buffs, const size_t numElems, int &flags, const long long timeNs, const long timeoutUs)
+    {
+        const auto exit = std::chrono::steady_clock::now() + std::chrono::microseconds(timeoutUs);
+        if (stream->ticks.rate() != _rate[SOAPY_SDR_TX]) stream->ticks = SoapySDR::TickConverter(_rate[SOAPY_SDR_TX]);
+        if ((flags & SOAPY_SDR_HAS_TIME) != 0) stream->tick = stream->ticks.timeNsToTicks(timeNs);
+
+        //paced streams consume the samples once their time is reached
+        size_t n = std::min(numElems, stream->mtu);
+        if (_paced and not this->waitForTime(stream->ticks.ticksToTimeNs(stream->tick), exit)) return SOAPY_SDR_TIMEOUT;
+
+        if (_source == SOURCE_LOOPBACK)
+        {
+            const int ret = this->writeLoopback(stream, buffs, n, exit);
+            if (ret <= 0) return ret;
+            n = size_t(ret);
+        }
+
+        const long long burstTimeNs = stream->ticks.ticksToTimeNs(stream->tick);
+        stream->tick += (long long)(n);
+        if ((flags & SOAPY_SDR_END_BURST) != 0 and n == numElems)
+        {
+            std::lock_guard<std::mutex> lock(_statusMutex);
+            NullStatus status;
+            status.chanMask = 0;
+            for (const auto ch : stream->channels) status.chanMask |= (size_t(1) << ch);
+            status.flags = SOAPY_SDR_END_BURST | SOAPY_SDR_HAS_TIME;
+            status.timeNs = burstTimeNs;
+            _status.push_back(status);
+            _statusCond.notify_all();
+        }
+        return int(n);
+    }
+
+    //the synchronous status, called by readStreamStatus() or by the notifier thread
+    int readStatus(NullStream *stream, size_t &chanMask, int &flags, long long &timeNs, const long timeoutUs)
+    {
+        if (stream->direction != SOAPY_SDR_TX) return SOAPY_SDR_NOT_SUPPORTED;
+        std::unique_lock<std::mutex> lock(_statusMutex);
+        if (not _statusCond.wait_for(lock, std::chrono::microseconds(timeoutUs), [this]{return not _status.empty();})) return SOAPY_SDR_TIMEOUT;
+        chanMask = _status.front().chanMask;
+        flags = _status.front().flags;
+        timeNs = _status.front().timeNs;
+        _status.pop_front();
+        return 0;
+    }
+
+    int directBufferAddrs(NullStream *stream, const size_t index, void **buffs) const
+    {
+        if (index >= numDirectBuffs) return SOAPY_SDR_STREAM_ERROR;
+        for (size_t i = 0; i < stream->channels.size(); i++)
+        {
+            buffs[i] = stream->directMem[index].data() + i*stream->mtu*stream->elemSize;
+        }
+        return 0;
+    }
+
+    int acquireDirectRead(NullStream *stream, size_t &index, const void **buffs, int &flags, long long &timeNs, const long timeoutUs)
+    {
+        if (not this->acquireDirect(stream, index)) return SOAPY_SDR_STREAM_ERROR;
+        std::vector<void *> ptrs(stream->channels.size());
+        this->directBufferAddrs(stream, index, ptrs.data());
+        const int ret = this->readTransfer(stream, ptrs.data(), stream->mtu, flags, timeNs, timeoutUs);
+        if (ret < 0) stream->directInUse[index] = false;
+        else std::copy(ptrs.begin(), ptrs.end(), buffs);
+        return ret;
+    }
+
+    static SoapySDR::AsyncReader *readerOf(const NullStream *stream)
+    {
+        return stream->notifier?stream->notifier->reader():nullptr;
+    }
+
+    void makeNotifier(NullStream *stream)
+    {
+        if (stream->direction == SOAPY_SDR_RX) stream->notifier.reset(new SoapySDR::StreamNotifier(
+            [this, stream](void * const *buffs, const size_t numElems, int &flags, long long &timeNs, const long timeoutUs)
+            {return this->readTransfer(stream, buffs, numElems, flags, timeNs, timeoutUs);},
+            stream->channels.size(), stream->mtu, stream->elemSize, SoapySDR::ThreadHints(stream->args)));
+        else stream->notifier.reset(new SoapySDR::StreamNotifier(
+            [this, stream](size_t &chanMask, int &flags, long long &timeNs, const long timeoutUs)
+            {return this->readStatus(stream, chanMask, flags, timeNs, timeoutUs);}));
+        if (stream->active) stream->notifier->start(_rate[stream->direction]);
+    }
+
+    //sleep until the hardware time or the exit time, true when the time was reached
+    bool waitForTime(const long long timeNs, const std::chrono::steady_clock::time_point &exit) const
+    {
+        const long long delta = timeNs - this->getHardwareTime();
+        if (delta <= 0) return true;
+        const auto wake = std::chrono::steady_clock::now() + std::chrono::nanoseconds(delta);
+        std::this_thread::sleep_until(std::min(wake, exit));
+        return wake <= exit;
+    }
+
+    bool acquireDirect(NullStream *stream, size_t &index)
+    {
+        for (size_t i = 0; i < numDirectBuffs; i++)
+        {
+            const size_t next = (stream->directNext + i) % numDirectBuffs;
+            if (stream->directInUse[next]) continue;
+            stream->directInUse[next] = true;
+            stream->directNext = (next + 1) % numDirectBuffs;
+            index = next;
+            return true;
+        }
+        return false;
+    }
+
+    void generate(NullStream *stream, const size_t index, void *buff, const size_t n, const int source)
+    {
+        if (source == SOURCE_ZEROS)
+        {
+            std::memset(buff, 0, n*stream->elemSize);
+            return;
+        }
+
+        auto out = (stream->fromCF32 == nullptr)?reinterpret_cast<std::complex<float> *>(buff):stream->scratch.data();
+        const float amplitude = float(_amplitude);
+        if (source == SOURCE_TONE)
+        {
+            const double rate = stream->ticks.rate();
+            const double freq = (_toneFreq < 0.0)?(rate/8):double(_toneFreq);
+            const auto step = std::polar(1.0, 2*M_PI*freq/rate);
+            auto phasor = stream->phasors[index];
+            for (size_t i = 0; i < n; i++)
+            {
+                out[i] = std::complex<float>(float(phasor.real())*amplitude, float(phasor.imag())*amplitude);
+                phasor *= step;
+            }
+            stream->phasors[index] = phasor/std::abs(phasor);
+        }
+        else
+        {
+            //xorshift64* uniform noise over [-amplitude, amplitude)
+            const float scale = amplitude/2147483648.0f;
+            uint64_t x = stream->rng;
+            for (size_t i = 0; i < n; i++)
+            {
+                x ^= x >> 12; x ^= x << 25; x ^= x >> 27;
+                const uint64_t r = x*0x2545F4914F6CDD1Dull;
+                out[i] = std::complex<float>(float(int32_t(uint32_t(r >> 32)))*scale, float(int32_t(uint32_t(r)))*scale);
+            }
+            stream->rng = x;
+        }
+        if (stream->fromCF32 != nullptr) stream->fromCF32(out, buff, n, 1.0);
+    }
+
+    int readLoopback(NullStream *stream, void * const *buffs, size_t n, const std::chrono::steady_clock::time_point &exit)
+    {
+        std::unique_lock<std::mutex> lock(_loopMutex);
+        const auto ready = [this, stream]
+        {
+            if (_loopback.empty()) return false;
+            for (const auto ch : stream->channels) if (_loopback[ch].count == 0) return false;
+            return true;
+        };
+        if (not _loopCond.wait_until(lock, exit, ready)) return SOAPY_SDR_TIMEOUT;
+
+        //same format loopback is a copy, otherwise convert from the TX format
+        SoapySDR::ConverterRegistry::ConverterFunction convert = nullptr;
+        if (_loopFormat != stream->format) convert = SoapySDR::ConverterRegistry::getFunction(_loopFormat, stream->format);
+        for (const auto ch : stream->channels) n = std::min(n, _loopback[ch].count/_loopElemSize);
+        std::vector<char> staging((convert == nullptr)?0:n*_loopElemSize);
+
+        for (size_t i = 0; i < stream->channels.size(); i++)
+        {
+            auto &loop = _loopback[stream->channels[i]];
+            char *out = (convert == nullptr)?reinterpret_cast<char *>(buffs[i]):staging.data();
+            const size_t bytes = n*_loopElemSize;
+            const size_t first = std::min(bytes, loop.data.size() - loop.readPos);
+            std::memcpy(out, loop.data.data() + loop.readPos, first);
+            std::memcpy(out + first, loop.data.data(), bytes - first);
+            loop.readPos = (loop.readPos + bytes) % loop.data.size();
+            loop.count -= bytes;
+            if (convert != nullptr) convert(staging.data(), buffs[i], n, 1.0);
+        }
+        _loopCond.notify_all();
+        return int(n);
+    }
+
+    int writeLoopback(NullStream *stream, const void * const *buffs, size_t n, const std::chrono::steady_clock::time_point &exit)
+    {
+        std::unique_lock<std::mutex> lock(_loopMutex);
+        const auto ready = [this, stream]
+        {
+            for (const auto ch : stream->channels) if (_loopback[ch].count + _loopElemSize > _loopback[ch].data.size()) return false;
+            return true;
+        };
+        if (not _loopCond.wait_until(lock, exit, ready)) return SOAPY_SDR_TIMEOUT;
+
+        for (const auto ch : stream->channels) n = std::min(n, (_loopback[ch].data.size() - _loopback[ch].count)/_loopElemSize);
+        for (size_t i = 0; i < stream->channels.size(); i++)
+        {
+            auto &loop = _loopback[stream->channels[i]];
+            const char *in = reinterpret_cast<const char *>(buffs[i]);
+            const size_t bytes = n*_loopElemSize;
+            const size_t writePos = (loop.readPos + loop.count) % loop.data.size();
+            const size_t first = std::min(bytes, loop.data.size() - writePos);
+            std::memcpy(loop.data.data() + writePos, in, first);
+            std::memcpy(loop.data.data(), in + first, bytes - first);
+            loop.count += bytes;
+        }
+        _loopCond.notify_all();
+        return int(n);
+    }
+
+    size_t _numChannels;
+    size_t _mtu;
+    size_t _loopbackSize;
+    std::atomic<int> _source;
+    std::atomic<double> _toneFreq;
+    std::atomic<double> _amplitude;
+    std::atomic<bool> _paced;
+    std::atomic<double> _rate[2];
+
+    const std::chrono::steady_clock::time_point _timeEpoch;
+    std::atomic<long long> _timeOffset;
+
+    mutable std::mutex _settingsMutex;
+    std::map<std::pair<int, size_t>, double> _gains;
+    std::map<std::pair<int, size_t>, double> _frequencies;
+
+    std::mutex _statusMutex;
+    std::condition_variable _statusCond;
+    std::deque<NullStatus> _status;
+
+    std::mutex _loopMutex;
+    std::condition_variable _loopCond;
+    std::string _loopFormat;
+    size_t _loopElemSize;
+    std::vector<NullLoopback> _loopback;
 };
 
 SoapySDR::KwargsList findNullDevice(const SoapySDR::Kwargs &args)
@@ -38,9 +822,9 @@ SoapySDR::KwargsList findNullDevice(const SoapySDR::Kwargs &args)
     return results;
 }
 
-SoapySDR::Device *makeNullDevice(const SoapySDR::Kwargs &)
+SoapySDR::Device *makeNullDevice(const SoapySDR::Kwargs &args)
 {
-    return new NullDevice();
+    return new NullDevice(args);
 }
 
 /*!
@@ -0,0 +1,413 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/Recording.hpp>
+#include <SoapySDR/Device.hpp>
+#include <SoapySDR/Formats.hpp>
+#include <SoapySDR/Errors.hpp>
+#include <SoapySDR/Logger.hpp>
+#include <SoapySDR/Buffers.hpp>
+#include <SoapySDR/ThreadHints.hpp>
+#include <SoapySDR/ConverterRegistry.hpp>
+#include <stdexcept>
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+#include <cerrno>
+#include <memory>
+#include <thread>
+#include <atomic>
+#if defined(__unix__) || defined(__APPLE__)
+#define SOAPY_SDR_MMAP_RECORDINGS
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+/***********************************************************************
+ * Mapped recording
+ **********************************************************************/
+struct SoapySDR::MappedRecording::Impl
+{
+    Impl(void):
+        map(nullptr),
+        length(0),
+        data(nullptr),
+        numElems(0)
+    {
+        return;
+    }
+
+    SoapySDR::SigMFMeta meta;
+    std::string dataPath, metaPath;
+    void *map;
+    size_t length;
+    const void *data;
+    size_t numElems;
+};
+
+static void unmapRecording(void *map, const size_t length)
+{
+    #ifdef SOAPY_SDR_MMAP_RECORDINGS
+    if (map != nullptr) munmap(map, length);
+    #else
+    (void)length;
+    SoapySDR::freeBuffer(map);
+    #endif
+}
+
+static bool endsWith(const std::string &path, const std::string &suffix)
+{
+    return path.size() >= suffix.size() and path.compare(path.size()-suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static bool fileExists(const std::string &path)
+{
+    return bool(std::ifstream(path.c_str()));
+}
+
+SoapySDR::MappedRecording::MappedRecording(const std::string &path, const std::string &format):
+    _impl(new Impl())
+{
+    try
+    {
+        //a SigMF recording by either file or the base name when the metadata exists
+        std::string base;
+        for (const std::string suffix : {".sigmf-data", ".sigmf-meta", ".sigmf"})
+        {
+            if (endsWith(path, suffix)) base = path.substr(0, path.size()-suffix.size());
+            if (not base.empty()) break;
+        }
+        if (base.empty() and fileExists(path + ".sigmf-meta")) base = path;
+
+        if (base.empty())
+        {
+            if (format.empty()) throw std::runtime_error("MappedRecording needs a format for the raw file " + path);
+            _impl->meta.format = format;
+            _impl->dataPath = path;
+        }
+        else
+        {
+            _impl->metaPath = base + ".sigmf-meta";
+            _impl->dataPath = base + ".sigmf-data";
+            _impl->meta = SoapySDR::SigMFMeta::load(_impl->metaPath);
+        }
+        const size_t elemSize = SoapySDR::formatToSize(_impl->meta.format);
+        if (elemSize == 0) throw std::runtime_error("MappedRecording unknown format " + _impl->meta.format);
+
+        #ifdef SOAPY_SDR_MMAP_RECORDINGS
+        const int fd = open(_impl->dataPath.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("MappedRecording failed to open " + _impl->dataPath + ": " + std::strerror(errno));
+        struct stat st;
+        if (fstat(fd, &st) != 0 or st.st_size == 0)
+        {
+            close(fd);
+            throw std::runtime_error("MappedRecording empty or unreadable file " + _impl->dataPath);
+        }
+        _impl->length = size_t(st.st_size);
+        void *map = mmap(nullptr, _impl->length, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) throw std::runtime_error("MappedRecording failed to map " + _impl->dataPath + ": " + std::strerror(errno));
+        _impl->map = map;
+        madvise(map, _impl->length, MADV_SEQUENTIAL);
+        #else
+        std::ifstream file(_impl->dataPath.c_str(), std::ios::binary | std::ios::ate);
+        if (not file) throw std::runtime_error("MappedRecording failed to open " + _impl->dataPath);
+        _impl->length = size_t(file.tellg());
+        if (_impl->length == 0) throw std::runtime_error("MappedRecording empty file " + _impl->dataPath);
+        _impl->map = SoapySDR::allocBuffer(_impl->length);
+        file.seekg(0);
+        if (not file.read(reinterpret_cast<char *>(_impl->map), _impl->length))
+        {
+            throw std::runtime_error("MappedRecording failed to read " + _impl->dataPath);
+        }
+        #endif
+        _impl->data = _impl->map;
+        _impl->numElems = _impl->length/elemSize;
+    }
+    catch (...)
+    {
+        unmapRecording(_impl->map, _impl->length);
+        delete _impl;
+        throw;
+    }
+}
+
+SoapySDR::MappedRecording::~MappedRecording(void)
+{
+    unmapRecording(_impl->map, _impl->length);
+    delete _impl;
+}
+
+const SoapySDR::SigMFMeta &SoapySDR::MappedRecording::meta(void) const
+{
+    return _impl->meta;
+}
+
+const void *SoapySDR::MappedRecording::data(void) const
+{
+    return _impl->data;
+}
+
+size_t SoapySDR::MappedRecording::numElems(void) const
+{
+    return _impl->numElems;
+}
+
+std::string SoapySDR::MappedRecording::dataPath(void) const
+{
+    return _impl->dataPath;
+}
+
+std::string SoapySDR::MappedRecording::metaPath(void) const
+{
+    return _impl->metaPath;
+}
+
+/***********************************************************************
+ * Player
+ **********************************************************************/
+struct SoapySDR::Player::Impl
+{
+    Impl(void):
+        device(nullptr),
+        stream(nullptr),
+        channel(0),
+        mtu(0),
+        nativeSize(0),
+        fileSize(0),
+        convert(nullptr),
+        direct(false),
+        loop(false),
+        startFlags(0),
+        startTime(0),
+        running(false),
+        finished(false),
+        started(false),
+        written(0),
+        loops(0),
+        underflows(0)
+    {
+        return;
+    }
+
+    void writer(void);
+    int write(const char *in, const size_t numElems, int flags, const long long timeNs);
+    void pollStatus(void);
+
+    SoapySDR::Device *device;
+    SoapySDR::Stream *stream;
+    size_t channel;
+    std::unique_ptr<SoapySDR::MappedRecording> recording;
+    size_t mtu;
+    size_t nativeSize, fileSize;
+    SoapySDR::ConverterRegistry::ConverterFunction convert;
+    SoapySDR::ThreadHints hints;
+    SoapySDR::BufferPool scratch;
+    bool direct;
+    bool loop;
+
+    int startFlags;
+    long long startTime;
+    std::atomic<bool> running;
+    std::atomic<bool> finished;
+    bool started;
+    std::thread writerThread;
+    std::string error;
+
+    std::atomic<unsigned long long> written;
+    std::atomic<unsigned long long> loops;
+    std::atomic<unsigned long long> underflows;
+};
+
+int SoapySDR::Player::Impl::write(const char *in, const size_t numElems, int flags, const long long timeNs)
+{
+    //the file is in the stream format, write from the mapped pages
+    if (convert == nullptr)
+    {
+        const void *buffs[1] = {in};
+        return device->writeStream(stream, buffs, numElems, flags, timeNs, 100000);
+    }
+
+    //convert into a direct access buffer, the end of burst only applies when the rest fits
+    if (direct)
+    {
+        size_t handle(0);
+        void *buffs[1] = {nullptr};
+        const int ret = device->acquireWriteBuffer(stream, handle, buffs, 100000);
+        if (ret <= 0) return ret;
+        const size_t n = std::min(numElems, size_t(ret));
+        if (n != numElems) flags &= ~SOAPY_SDR_END_BURST;
+        convert(in, buffs[0], n, 1.0);
+        device->releaseWriteBuffer(stream, handle, n, flags, timeNs);
+        return int(n);
+    }
+
+    //convert into the scratch buffer for writeStream
+    const size_t n = std::min(numElems, mtu);
+    if (n != numElems) flags &= ~SOAPY_SDR_END_BURST;
+    convert(in, scratch.buffs()[0], n, 1.0);
+    const void *buffs[1] = {scratch.buffs()[0]};
+    return device->writeStream(stream, buffs, n, flags, timeNs, 100000);
+}
+
+void SoapySDR::Player::Impl::pollStatus(void)
+{
+    size_t chanMask(0);
+    int flags(0);
+    long long timeNs(0);
+    if (device->readStreamStatus(stream, chanMask, flags, timeNs, 0) == SOAPY_SDR_UNDERFLOW) underflows++;
+}
+
+void SoapySDR::Player::Impl::writer(void)
+{
+    hints.applyToThisThread();
+    const char *data = reinterpret_cast<const char *>(recording->data());
+    const size_t total = recording->numElems();
+    size_t pos(0);
+    int flags = startFlags;
+    long long timeNs = startTime;
+
+    while (running)
+    {
+        const size_t n = std::min(total - pos, mtu);
+        const bool last = (not loop and pos + n == total);
+        const int ret = this->write(data + pos*fileSize, n, last?(flags | SOAPY_SDR_END_BURST):flags, timeNs);
+        this->pollStatus();
+        if (ret == SOAPY_SDR_TIMEOUT) continue;
+        if (ret == SOAPY_SDR_UNDERFLOW)
+        {
+            underflows++;
+            continue;
+        }
+        if (ret < 0)
+        {
+            error = std::string("writeStream() failed: ") + SoapySDR::errToStr(ret);
+            SoapySDR::logf(SOAPY_SDR_ERROR, "Player: %s", error.c_str());
+            break;
+        }
+
+        //only the first write of a timed start carries the time
+        flags = 0;
+        pos += size_t(ret);
+        written += size_t(ret);
+        if (pos < total) continue;
+        if (not loop) break;
+        pos = 0;
+        loops++;
+    }
+    finished = true;
+}
+
+SoapySDR::Player::Player(Device *device, const size_t channel, const std::string &path, const Kwargs &args_):
+    _impl(new Impl())
+{
+    //split the player args from the stream args
+    auto args = args_;
+    auto take = [&args](const std::string &key, const std::string &defaultValue)
+    {
+        const auto it = args.find(key);
+        if (it == args.end()) return defaultValue;
+        const auto value = it->second;
+        args.erase(it);
+        return value;
+    };
+    const auto format = take("format", "");
+    _impl->loop = take("loop", "false") == "true";
+    const bool direct = take("direct", "true") == "true";
+
+    _impl->device = device;
+    _impl->channel = channel;
+
+    try
+    {
+        _impl->recording.reset(new SoapySDR::MappedRecording(path, format));
+        const auto &fileFormat = _impl->recording->meta().format;
+        double fullScale(0.0);
+        _impl->hints = SoapySDR::ThreadHints(args);
+        const auto nativeFormat = device->getNativeStreamFormat(SOAPY_SDR_TX, channel, fullScale);
+        if (fileFormat != nativeFormat)
+        {
+            _impl->convert = SoapySDR::ConverterRegistry::getFunction(fileFormat, nativeFormat);
+        }
+        _impl->nativeSize = SoapySDR::formatToSize(nativeFormat);
+        _impl->fileSize = SoapySDR::formatToSize(fileFormat);
+
+        _impl->stream = device->setupStream(SOAPY_SDR_TX, nativeFormat, std::vector<size_t>(1, channel), args);
+        _impl->mtu = device->getStreamMTU(_impl->stream);
+        _impl->direct = _impl->convert != nullptr and direct and device->getNumDirectAccessBuffers(_impl->stream) != 0;
+        if (_impl->convert != nullptr and not _impl->direct)
+        {
+            _impl->scratch.resize(1, _impl->mtu, _impl->nativeSize, 1, 0, _impl->hints.numaNode);
+        }
+    }
+    catch (...)
+    {
+        if (_impl->stream != nullptr) device->closeStream(_impl->stream);
+        delete _impl;
+        throw;
+    }
+}
+
+SoapySDR::Player::~Player(void)
+{
+    try
+    {
+        this->stop();
+    }
+    catch (const std::exception &ex)
+    {
+        SoapySDR::logf(SOAPY_SDR_ERROR, "Player::~Player() %s", ex.what());
+    }
+    _impl->device->closeStream(_impl->stream);
+    delete _impl;
+}
+
+void SoapySDR::Player::start(const int flags, const long long timeNs)
+{
+    if (_impl->started) throw std::runtime_error("Player::start() already started");
+    _impl->started = true;
+    _impl->startFlags = flags & SOAPY_SDR_HAS_TIME;
+    _impl->startTime = timeNs;
+
+    const int ret = _impl->device->activateStream(_impl->stream);
+    if (ret != 0) throw std::runtime_error(std::string("Player::start() activateStream failed: ") + SoapySDR::errToStr(ret));
+    _impl->running = true;
+    _impl->writerThread = std::thread(&Impl::writer, _impl);
+}
+
+void SoapySDR::Player::stop(void)
+{
+    if (not _impl->started) return;
+    _impl->started = false;
+    _impl->running = false;
+    _impl->writerThread.join();
+    _impl->device->deactivateStream(_impl->stream);
+    if (not _impl->error.empty()) throw std::runtime_error(_impl->error);
+}
+
+bool SoapySDR::Player::done(void) const
+{
+    return _impl->finished;
+}
+
+unsigned long long SoapySDR::Player::numSamples(void) const
+{
+    return _impl->written;
+}
+
+unsigned long long SoapySDR::Player::numLoops(void) const
+{
+    return _impl->loops;
+}
+
+unsigned long long SoapySDR::Player::numUnderflows(void) const
+{
+    return _impl->underflows;
+}
+
+const SoapySDR::MappedRecording &SoapySDR::Player::recording(void) const
+{
+    return *_impl->recording;
+}
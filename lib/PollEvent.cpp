@@ -0,0 +1,114 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include "PollEvent.hpp"
+#include <stdexcept>
+#include <string>
+#include <cstring>
+#include <cerrno>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#endif
+#ifdef __linux__
+#include <sys/eventfd.h>
+#endif
+
+SoapySDR::PollEvent::PollEvent(void):
+    _ready(false),
+    _handle(-1),
+    _writeHandle(-1)
+{
+    #ifdef _WIN32
+    HANDLE event = CreateEvent(nullptr, TRUE/*manual reset*/, FALSE, nullptr);
+    if (event == nullptr) throw std::runtime_error("PollEvent CreateEvent() failed");
+    _handle = _writeHandle = reinterpret_cast<intptr_t>(event);
+    #elif defined(__linux__)
+    const int fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (fd < 0) throw std::runtime_error(std::string("PollEvent eventfd() failed: ") + std::strerror(errno));
+    _handle = _writeHandle = fd;
+    #else
+    int fds[2];
+    if (::pipe(fds) != 0) throw std::runtime_error(std::string("PollEvent pipe() failed: ") + std::strerror(errno));
+    for (const int fd : fds)
+    {
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+    _handle = fds[0];
+    _writeHandle = fds[1];
+    #endif
+}
+
+SoapySDR::PollEvent::~PollEvent(void)
+{
+    #ifdef _WIN32
+    CloseHandle(reinterpret_cast<HANDLE>(_handle));
+    #else
+    ::close(int(_handle));
+    if (_writeHandle != _handle) ::close(int(_writeHandle));
+    #endif
+}
+
+intptr_t SoapySDR::PollEvent::handle(void) const
+{
+    return _handle;
+}
+
+void SoapySDR::PollEvent::set(const bool ready)
+{
+    //the handle only changes on a transition
+    if (ready == _ready) return;
+    _ready = ready;
+    #ifdef _WIN32
+    if (ready) SetEvent(reinterpret_cast<HANDLE>(_writeHandle));
+    else ResetEvent(reinterpret_cast<HANDLE>(_writeHandle));
+    #else
+    #ifdef __linux__
+    uint64_t value(1); //eventfd counter
+    #else
+    char value(0);
+    #endif
+    ssize_t ret(0);
+    if (ready) ret = ::write(int(_writeHandle), &value, sizeof(value));
+    else ret = ::read(int(_handle), &value, sizeof(value));
+    (void)ret;
+    #endif
+}
+
+size_t SoapySDR::PollEvent::wait(const std::vector<intptr_t> &handles, std::vector<bool> &ready, const long timeoutUs)
+{
+    ready.assign(handles.size(), false);
+    size_t numReady(0);
+    #ifdef _WIN32
+    std::vector<HANDLE> events;
+    for (const auto handle : handles) events.push_back(reinterpret_cast<HANDLE>(handle));
+    const DWORD ret = WaitForMultipleObjects(DWORD(events.size()), events.data(), FALSE, DWORD(timeoutUs/1000));
+    if (ret == WAIT_TIMEOUT or ret == WAIT_FAILED) return 0;
+
+    //the wait reports the first event, check the others without waiting
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        ready[i] = WaitForSingleObject(events[i], 0) == WAIT_OBJECT_0;
+        if (ready[i]) numReady++;
+    }
+    #else
+    std::vector<pollfd> fds(handles.size());
+    for (size_t i = 0; i < handles.size(); i++)
+    {
+        fds[i].fd = int(handles[i]);
+        fds[i].events = POLLIN;
+        fds[i].revents = 0;
+    }
+    if (poll(fds.data(), nfds_t(fds.size()), int(timeoutUs/1000)) <= 0) return 0;
+    for (size_t i = 0; i < fds.size(); i++)
+    {
+        ready[i] = (fds[i].revents & POLLIN) != 0;
+        if (ready[i]) numReady++;
+    }
+    #endif
+    return numReady;
+}
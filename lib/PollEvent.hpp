@@ -0,0 +1,47 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace SoapySDR
+{
+
+/*!
+ * A level triggered event for Device::getStreamPollHandle().
+ * The handle is an eventfd on Linux, the read end of a pipe on other
+ * unix systems and a manual reset event on Windows.
+ */
+class PollEvent
+{
+public:
+    PollEvent(void);
+
+    ~PollEvent(void);
+
+    //! The file descriptor or event HANDLE
+    intptr_t handle(void) const;
+
+    //! Set or clear the handle, the callers serialize the updates
+    void set(const bool ready);
+
+    /*!
+     * Wait for any of the handles to become ready.
+     * \param handles the handles from getStreamPollHandle()
+     * \param [out] ready true for each handle that is ready
+     * \param timeoutUs how long to wait
+     * \return the number of ready handles
+     */
+    static size_t wait(const std::vector<intptr_t> &handles, std::vector<bool> &ready, const long timeoutUs);
+
+private:
+    PollEvent(const PollEvent &);
+    PollEvent &operator=(const PollEvent &);
+    bool _ready;
+    intptr_t _handle;
+    intptr_t _writeHandle;
+};
+
+}
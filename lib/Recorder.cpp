@@ -0,0 +1,518 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/Recording.hpp>
+#include <SoapySDR/Device.hpp>
+#include <SoapySDR/Formats.hpp>
+#include <SoapySDR/Errors.hpp>
+#include <SoapySDR/Logger.hpp>
+#include <SoapySDR/Buffers.hpp>
+#include <SoapySDR/ThreadHints.hpp>
+#include <SoapySDR/ConverterRegistry.hpp>
+#include <condition_variable>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <memory>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <ctime>
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+//the block size that O_DIRECT writes are aligned to
+static const size_t directBlockSize = 4096;
+
+/***********************************************************************
+ * The data file: O_DIRECT block writes on linux, stdio elsewhere
+ **********************************************************************/
+class RecorderFile
+{
+public:
+    RecorderFile(const std::string &path, const bool direct):
+        _direct(false),
+        _fd(-1),
+        _file(nullptr)
+    {
+        #ifdef __linux__
+        #ifdef O_DIRECT
+        if (direct) _fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+        _direct = (_fd >= 0);
+        #else
+        (void)direct;
+        #endif
+        //some filesystems such as tmpfs reject O_DIRECT
+        if (_fd < 0) _fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (_fd < 0) throw std::runtime_error("Recorder failed to open " + path + ": " + std::strerror(errno));
+        #else
+        (void)direct;
+        _file = std::fopen(path.c_str(), "wb");
+        if (_file == nullptr) throw std::runtime_error("Recorder failed to open " + path);
+        #endif
+    }
+
+    ~RecorderFile(void)
+    {
+        #ifdef __linux__
+        close(_fd);
+        #else
+        std::fclose(_file);
+        #endif
+    }
+
+    //write whole blocks from an aligned buffer, or the unaligned tail when last is set
+    void write(const void *buff, const size_t length, const bool last)
+    {
+        #ifdef __linux__
+        if (last and _direct and (length % directBlockSize) != 0)
+        {
+            fcntl(_fd, F_SETFL, fcntl(_fd, F_GETFL) & ~O_DIRECT);
+            _direct = false;
+        }
+        const char *p = reinterpret_cast<const char *>(buff);
+        size_t remaining = length;
+        while (remaining != 0)
+        {
+            const ssize_t ret = ::write(_fd, p, remaining);
+            if (ret < 0 and errno == EINTR) continue;
+            if (ret <= 0) throw std::runtime_error(std::string("Recorder write failed: ") + std::strerror(errno));
+            p += ret;
+            remaining -= size_t(ret);
+        }
+        #else
+        (void)last;
+        if (std::fwrite(buff, 1, length, _file) != length) throw std::runtime_error("Recorder write failed");
+        #endif
+    }
+
+private:
+    bool _direct;
+    int _fd;
+    std::FILE *_file;
+};
+
+/***********************************************************************
+ * Recorder state shared by the reader and writer threads
+ **********************************************************************/
+struct RecorderEntry
+{
+    RecorderEntry(void):
+        numElems(0)
+    {
+        return;
+    }
+
+    size_t numElems;
+};
+
+struct SoapySDR::Recorder::Impl
+{
+    Impl(void):
+        device(nullptr),
+        stream(nullptr),
+        channel(0),
+        mtu(0),
+        nativeSize(0),
+        fileSize(0),
+        convert(nullptr),
+        staging(nullptr),
+        stagingSize(0),
+        stagingFill(0),
+        target(0),
+        queued(0),
+        head(0),
+        tail(0),
+        running(false),
+        readerDone(false),
+        finished(false),
+        failed(false),
+        started(false),
+        written(0),
+        overflows(0),
+        dropped(0),
+        output(false)
+    {
+        return;
+    }
+
+    void reader(void);
+    void writer(void);
+    void annotate(const std::string &comment, const unsigned long long count = 0);
+    void fail(const std::string &what);
+
+    SoapySDR::Device *device;
+    SoapySDR::Stream *stream;
+    size_t channel;
+    std::string dataPath, metaPath;
+    std::string nativeFormat, fileFormat;
+    size_t mtu;
+    size_t nativeSize, fileSize;
+    SoapySDR::ConverterRegistry::ConverterFunction convert;
+    SoapySDR::ThreadHints hints;
+
+    //ring of MTU sized read buffers, a single producer and consumer
+    SoapySDR::BufferPool ring;
+    SoapySDR::BufferPool discard;
+    std::vector<RecorderEntry> entries;
+
+    //aligned staging for whole block writes
+    std::unique_ptr<RecorderFile> file;
+    void *staging;
+    size_t stagingSize;
+    size_t stagingFill;
+
+    //reader state
+    unsigned long long target;
+    unsigned long long queued;
+
+    std::atomic<size_t> head;
+    std::atomic<size_t> tail;
+    std::atomic<bool> running;
+    std::atomic<bool> readerDone;
+    std::atomic<bool> finished;
+    std::atomic<bool> failed;
+    bool started;
+    std::mutex mutex;
+    std::condition_variable cond;
+    std::thread readerThread, writerThread;
+
+    std::atomic<unsigned long long> written;
+    std::atomic<unsigned long long> overflows;
+    std::atomic<unsigned long long> dropped;
+
+    //metadata and errors under the mutex
+    bool output;
+    SoapySDR::SigMFMeta meta;
+    std::string error;
+};
+
+void SoapySDR::Recorder::Impl::annotate(const std::string &comment, const unsigned long long count)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    SoapySDR::SigMFMeta::Annotation annotation;
+    annotation.sampleStart = queued;
+    annotation.sampleCount = count;
+    annotation.comment = comment;
+    meta.annotations.push_back(annotation);
+}
+
+void SoapySDR::Recorder::Impl::fail(const std::string &what)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (error.empty()) error = what;
+    }
+    failed = true;
+    SoapySDR::logf(SOAPY_SDR_ERROR, "Recorder: %s", what.c_str());
+    running = false;
+    cond.notify_all();
+}
+
+void SoapySDR::Recorder::Impl::reader(void)
+{
+    hints.applyToThisThread();
+    bool newCapture = true;
+    unsigned long long pendingDrop(0);
+    void *discardBuff = discard.buffs()[0];
+
+    while (running and not readerDone)
+    {
+        int flags(0);
+        long long timeNs(0);
+
+        //the writer fell behind, read and discard to keep the stream flowing
+        if (tail - head == entries.size())
+        {
+            const int ret = device->readStream(stream, &discardBuff, mtu, flags, timeNs, 100000);
+            if (ret > 0)
+            {
+                dropped += size_t(ret);
+                pendingDrop += size_t(ret);
+            }
+            continue;
+        }
+
+        const size_t index = tail % entries.size();
+        void *buff = ring.buffs(index)[0];
+        const int ret = device->readStream(stream, &buff, mtu, flags, timeNs, 100000);
+        if (ret == SOAPY_SDR_TIMEOUT) continue;
+        if (ret == SOAPY_SDR_OVERFLOW)
+        {
+            overflows++;
+            this->annotate("overflow");
+            newCapture = true;
+            continue;
+        }
+        if (ret == SOAPY_SDR_CORRUPTION or ret == SOAPY_SDR_TIME_ERROR)
+        {
+            this->annotate(std::string("stream error ") + SoapySDR::errToStr(ret));
+            newCapture = true;
+            continue;
+        }
+        if (ret < 0)
+        {
+            this->fail(std::string("readStream() failed: ") + SoapySDR::errToStr(ret));
+            break;
+        }
+
+        if (pendingDrop != 0)
+        {
+            this->annotate("dropped " + std::to_string(pendingDrop) + " samples, writer behind", 0);
+            pendingDrop = 0;
+            newCapture = true;
+        }
+
+        //a new segment starts at each discontinuity that has a timestamp
+        if (newCapture)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto &captures = meta.captures;
+            if (captures.size() == 1 and not captures.front().hasTime and queued == 0) captures.clear();
+            if (captures.empty() or (flags & SOAPY_SDR_HAS_TIME) != 0)
+            {
+                SoapySDR::SigMFMeta::Capture capture;
+                capture.sampleStart = queued;
+                capture.frequency = device->getFrequency(SOAPY_SDR_RX, channel);
+                capture.hasTime = (flags & SOAPY_SDR_HAS_TIME) != 0;
+                capture.timeNs = timeNs;
+                captures.push_back(capture);
+            }
+            newCapture = false;
+        }
+
+        size_t n = size_t(ret);
+        if (target != 0) n = size_t(std::min<unsigned long long>(n, target - queued));
+        entries[index].numElems = n;
+        queued += n;
+        tail++;
+        if (target != 0 and queued >= target) readerDone = true;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+        }
+        cond.notify_one();
+    }
+    readerDone = true;
+    cond.notify_all();
+}
+
+void SoapySDR::Recorder::Impl::writer(void)
+{
+    try
+    {
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                cond.wait_for(lock, std::chrono::milliseconds(100), [this]{return head != tail or readerDone;});
+            }
+            if (head == tail)
+            {
+                if (readerDone) break;
+                continue;
+            }
+
+            //convert or copy into the staging, writing whenever a block run is full
+            const auto &entry = entries[head % entries.size()];
+            const char *in = reinterpret_cast<const char *>(ring.buffs(head % entries.size())[0]);
+            size_t remaining = entry.numElems;
+            while (remaining != 0)
+            {
+                const size_t n = std::min(remaining, (stagingSize - stagingFill)/fileSize);
+                char *out = reinterpret_cast<char *>(staging) + stagingFill;
+                if (convert == nullptr) std::memcpy(out, in, n*fileSize);
+                else convert(in, out, n, 1.0);
+                in += n*nativeSize;
+                remaining -= n;
+                stagingFill += n*fileSize;
+                if (stagingFill == stagingSize)
+                {
+                    file->write(staging, stagingSize, false);
+                    written += stagingSize/fileSize;
+                    stagingFill = 0;
+                }
+            }
+            head++;
+        }
+
+        file->write(staging, stagingFill, true);
+        written += stagingFill/fileSize;
+        stagingFill = 0;
+    }
+    catch (const std::exception &ex)
+    {
+        this->fail(ex.what());
+    }
+    finished = true;
+}
+
+/***********************************************************************
+ * Recorder
+ **********************************************************************/
+static std::string endsWithout(const std::string &path, const std::string &suffix)
+{
+    if (path.size() >= suffix.size() and path.compare(path.size()-suffix.size(), suffix.size(), suffix) == 0)
+    {
+        return path.substr(0, path.size()-suffix.size());
+    }
+    return path;
+}
+
+SoapySDR::Recorder::Recorder(Device *device, const size_t channel, const std::string &path, const Kwargs &args_):
+    _impl(new Impl())
+{
+    //split the recorder args from the stream args
+    auto args = args_;
+    auto take = [&args](const std::string &key, const std::string &defaultValue)
+    {
+        const auto it = args.find(key);
+        if (it == args.end()) return defaultValue;
+        const auto value = it->second;
+        args.erase(it);
+        return value;
+    };
+    const auto format = take("format", "");
+    const auto output = take("output", "sigmf");
+    const size_t numBuffs = std::max<size_t>(2, std::stoul(take("buffers", "64")));
+    const bool direct = take("direct", "true") == "true";
+    if (output != "sigmf" and output != "raw") throw std::runtime_error("Recorder output not in sigmf/raw: " + output);
+
+    _impl->device = device;
+    _impl->channel = channel;
+    _impl->output = (output == "sigmf");
+    if (_impl->output)
+    {
+        const auto base = endsWithout(endsWithout(endsWithout(path, ".sigmf-data"), ".sigmf-meta"), ".sigmf");
+        _impl->dataPath = base + ".sigmf-data";
+        _impl->metaPath = base + ".sigmf-meta";
+    }
+    else _impl->dataPath = path;
+
+    try
+    {
+        double fullScale(0.0);
+        _impl->hints = SoapySDR::ThreadHints(args);
+        _impl->nativeFormat = device->getNativeStreamFormat(SOAPY_SDR_RX, channel, fullScale);
+        _impl->fileFormat = format.empty()?_impl->nativeFormat:format;
+        if (_impl->output and formatToSigMF(_impl->fileFormat).empty())
+        {
+            throw std::runtime_error("Recorder format " + _impl->fileFormat + " has no SigMF datatype");
+        }
+        if (_impl->fileFormat != _impl->nativeFormat)
+        {
+            _impl->convert = SoapySDR::ConverterRegistry::getFunction(_impl->nativeFormat, _impl->fileFormat);
+        }
+        _impl->nativeSize = SoapySDR::formatToSize(_impl->nativeFormat);
+        _impl->fileSize = SoapySDR::formatToSize(_impl->fileFormat);
+
+        _impl->stream = device->setupStream(SOAPY_SDR_RX, _impl->nativeFormat, std::vector<size_t>(1, channel), args);
+        _impl->mtu = device->getStreamMTU(_impl->stream);
+        _impl->ring.resize(1, _impl->mtu, _impl->nativeSize, numBuffs, 0, _impl->hints.numaNode);
+        _impl->discard.resize(1, _impl->mtu, _impl->nativeSize, 1);
+        _impl->entries.resize(numBuffs);
+
+        //a staging size that holds whole elements and whole blocks
+        _impl->stagingSize = directBlockSize*_impl->fileSize*64;
+        _impl->staging = SoapySDR::allocBuffer(_impl->stagingSize, 0, _impl->hints.numaNode, directBlockSize);
+        _impl->file.reset(new RecorderFile(_impl->dataPath, direct));
+
+        _impl->meta.format = _impl->fileFormat;
+        _impl->meta.sampleRate = device->getSampleRate(SOAPY_SDR_RX, channel);
+        _impl->meta.hardware = device->getHardwareKey();
+    }
+    catch (...)
+    {
+        if (_impl->stream != nullptr) device->closeStream(_impl->stream);
+        SoapySDR::freeBuffer(_impl->staging);
+        delete _impl;
+        throw;
+    }
+}
+
+SoapySDR::Recorder::~Recorder(void)
+{
+    try
+    {
+        this->stop();
+    }
+    catch (const std::exception &ex)
+    {
+        SoapySDR::logf(SOAPY_SDR_ERROR, "Recorder::~Recorder() %s", ex.what());
+    }
+    _impl->device->closeStream(_impl->stream);
+    _impl->file.reset();
+    SoapySDR::freeBuffer(_impl->staging);
+    delete _impl;
+}
+
+void SoapySDR::Recorder::start(const unsigned long long numSamples)
+{
+    if (_impl->started) throw std::runtime_error("Recorder::start() already started");
+    _impl->started = true;
+    _impl->target = numSamples;
+
+    //the first capture holds the frequency until the first timestamp arrives
+    char datetime[32];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(datetime, sizeof(datetime), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    _impl->meta.datetime = datetime;
+    SoapySDR::SigMFMeta::Capture capture;
+    capture.frequency = _impl->device->getFrequency(SOAPY_SDR_RX, _impl->channel);
+    _impl->meta.captures.assign(1, capture);
+
+    const int ret = _impl->device->activateStream(_impl->stream);
+    if (ret != 0) throw std::runtime_error(std::string("Recorder::start() activateStream failed: ") + SoapySDR::errToStr(ret));
+    _impl->running = true;
+    _impl->writerThread = std::thread(&Impl::writer, _impl);
+    _impl->readerThread = std::thread(&Impl::reader, _impl);
+}
+
+void SoapySDR::Recorder::stop(void)
+{
+    if (not _impl->started) return;
+    _impl->started = false;
+
+    //the reader stops first, the writer drains what was queued
+    _impl->running = false;
+    _impl->readerThread.join();
+    _impl->writerThread.join();
+    _impl->device->deactivateStream(_impl->stream);
+
+    if (_impl->output) _impl->meta.save(_impl->metaPath);
+    if (not _impl->error.empty()) throw std::runtime_error(_impl->error);
+}
+
+bool SoapySDR::Recorder::done(void) const
+{
+    return _impl->finished or _impl->failed;
+}
+
+unsigned long long SoapySDR::Recorder::numSamples(void) const
+{
+    return _impl->written;
+}
+
+unsigned long long SoapySDR::Recorder::numOverflows(void) const
+{
+    return _impl->overflows;
+}
+
+unsigned long long SoapySDR::Recorder::numDropped(void) const
+{
+    return _impl->dropped;
+}
+
+std::string SoapySDR::Recorder::dataPath(void) const
+{
+    return _impl->dataPath;
+}
+
+std::string SoapySDR::Recorder::metaPath(void) const
+{
+    return _impl->metaPath;
+}
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: BSL-1.0
 
 #include <SoapySDR/Registry.hpp>
+#include <mutex>
 
 /***********************************************************************
  * Function table holds all registration entries by name
@@ -24,7 +25,9 @@ static FunctionTable &getFunctionTable(void)
 /***********************************************************************
  * Module loader shared data structures
  **********************************************************************/
-std::string &getModuleLoading(void);
+const std::string &getModuleLoading(void);
+
+std::recursive_mutex &getModuleMutex(void);
 
 std::map<std::string, SoapySDR::Kwargs> &getLoaderResults(void);
 
@@ -33,6 +36,8 @@ std::map<std::string, SoapySDR::Kwargs> &getLoaderResults(void);
  **********************************************************************/
 SoapySDR::Registry::Registry(const std::string &name, const FindFunction &find, const MakeFunction &make, const std::string &abi)
 {
+    std::lock_guard<std::recursive_mutex> lock(getModuleMutex());
+
     //create an entry for the loader result
     std::string &errorMsg = getLoaderResults()[getModuleLoading()][name];
 
@@ -63,6 +68,7 @@ SoapySDR::Registry::~Registry(void)
 {
     //erase entry
     if (_name.empty()) return;
+    std::lock_guard<std::recursive_mutex> lock(getModuleMutex());
     getFunctionTable().erase(_name);
 }
 
@@ -71,6 +77,7 @@ SoapySDR::Registry::~Registry(void)
  **********************************************************************/
 SoapySDR::FindFunctions SoapySDR::Registry::listFindFunctions(void)
 {
+    std::lock_guard<std::recursive_mutex> lock(getModuleMutex());
     FindFunctions functions;
     for (const auto &it : getFunctionTable())
     {
@@ -81,6 +88,7 @@ SoapySDR::FindFunctions SoapySDR::Registry::listFindFunctions(void)
 
 SoapySDR::MakeFunctions SoapySDR::Registry::listMakeFunctions(void)
 {
+    std::lock_guard<std::recursive_mutex> lock(getModuleMutex());
     MakeFunctions functions;
     for (const auto &it : getFunctionTable())
     {
@@ -88,3 +96,10 @@ SoapySDR::MakeFunctions SoapySDR::Registry::listMakeFunctions(void)
     }
     return functions;
 }
+
+std::string getRegistryModulePath(const std::string &name)
+{
+    std::lock_guard<std::recursive_mutex> lock(getModuleMutex());
+    const auto it = getFunctionTable().find(name);
+    return (it == getFunctionTable().end())?"":it->second.modulePath;
+}
@@ -0,0 +1,401 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/Scanner.hpp>
+#include <SoapySDR/Device.hpp>
+#include <SoapySDR/SettingsTransaction.hpp>
+#include <SoapySDR/RingBuffer.hpp>
+#include <SoapySDR/Buffers.hpp>
+#include <SoapySDR/ThreadHints.hpp>
+#include <SoapySDR/Logger.hpp>
+#include <SoapySDR/Time.hpp>
+#include <condition_variable>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <mutex>
+
+SoapySDR::Scanner::Step::Step(void):
+    frequency(0.0),
+    dwellNs(0),
+    settleNs(0)
+{
+    return;
+}
+
+SoapySDR::Scanner::Step::Step(const double frequency, const long long dwellNs, const long long settleNs, const Kwargs &args):
+    frequency(frequency),
+    dwellNs(dwellNs),
+    settleNs(settleNs),
+    args(args)
+{
+    return;
+}
+
+SoapySDR::Scanner::Capture::Capture(void):
+    step(0),
+    sweep(0),
+    frequency(0.0),
+    timeNs(0),
+    numElems(0),
+    buffs(nullptr),
+    status(0)
+{
+    return;
+}
+
+/***********************************************************************
+ * The stream times of a step and the slot of a completed step
+ **********************************************************************/
+struct ScanWindow
+{
+    long long startNs;
+    long long endNs;
+    size_t numElems;
+};
+
+struct ScanSlot
+{
+    ScanSlot(void):
+        step(0),
+        sweep(0),
+        timeNs(0),
+        numElems(0),
+        status(0)
+    {
+        return;
+    }
+
+    size_t step;
+    size_t sweep;
+    long long timeNs;
+    size_t numElems;
+    int status;
+};
+
+struct SoapySDR::Scanner::Impl
+{
+    Impl(const size_t numBuffers):
+        device(nullptr),
+        stream(nullptr),
+        channel(0),
+        numChans(0),
+        elemSize(0),
+        leadNs(0),
+        timed(false),
+        ring(numBuffers),
+        rate(0.0),
+        numSweeps(0),
+        nextTimeNs(0),
+        running(false),
+        captured(false),
+        finished(true),
+        sweeps(0),
+        captures(0),
+        discarded(0)
+    {
+        return;
+    }
+
+    void capture(void);
+    void deliver(void);
+    std::vector<ScanWindow> plan(const long long lastEndNs);
+    void captureStep(const size_t step, const size_t sweep, const ScanWindow &window, const bool planNext);
+
+    SoapySDR::Device *device;
+    SoapySDR::Stream *stream;
+    size_t channel;
+    size_t numChans;
+    size_t elemSize;
+    long long leadNs;
+    bool timed;
+    SoapySDR::ThreadHints hints;
+    SoapySDR::RingBuffer<ScanSlot> ring;
+    SoapySDR::BufferPool pool;
+
+    //the scan of the last start()
+    std::vector<SoapySDR::Scanner::Step> steps;
+    SoapySDR::Scanner::Callback callback;
+    double rate;
+    size_t numSweeps;
+    std::vector<ScanWindow> nextWindows;
+    long long nextTimeNs;
+
+    std::atomic<bool> running;
+    std::atomic<bool> captured;
+    std::thread captureThread;
+    std::thread deliverThread;
+    std::mutex mutex;
+    std::condition_variable cond;
+    bool finished;
+
+    std::atomic<size_t> sweeps;
+    std::atomic<unsigned long long> captures;
+    std::atomic<unsigned long long> discarded;
+};
+
+std::vector<ScanWindow> SoapySDR::Scanner::Impl::plan(const long long lastEndNs)
+{
+    //with the hardware clock the retunes of a sweep are one schedule
+    std::vector<ScanWindow> windows;
+    SoapySDR::SettingsTransaction transaction;
+    long long t = std::max(device->getHardwareTime() + leadNs, lastEndNs);
+    for (const auto &step : steps)
+    {
+        transaction.setCommandTime(t);
+        transaction.setFrequency(SOAPY_SDR_RX, channel, step.frequency, step.args);
+        ScanWindow window;
+        window.startNs = t + step.settleNs;
+        window.numElems = size_t(std::max<long long>(1, SoapySDR::timeNsToTicks(step.dwellNs, rate)));
+        window.endNs = window.startNs + SoapySDR::ticksToTimeNs((long long)(window.numElems), rate);
+        windows.push_back(window);
+        t = window.endNs;
+    }
+    device->scheduleSettings(transaction);
+    return windows;
+}
+
+void SoapySDR::Scanner::Impl::capture(void)
+{
+    hints.applyToThisThread();
+    long long lastEndNs(0);
+    if (timed) nextWindows = this->plan(lastEndNs);
+    for (size_t sweep = 0; running and (numSweeps == 0 or sweep < numSweeps); sweep++)
+    {
+        const std::vector<ScanWindow> windows(nextWindows);
+        for (size_t i = 0; i < steps.size() and running; i++)
+        {
+            ScanWindow window;
+            if (timed) window = windows[i];
+            else
+            {
+                //the host tune applies to the samples read after it returns
+                try
+                {
+                    device->setFrequency(SOAPY_SDR_RX, channel, steps[i].frequency, steps[i].args);
+                }
+                catch (const std::exception &ex)
+                {
+                    SoapySDR::logf(SOAPY_SDR_ERROR, "Scanner setFrequency(%g) failed: %s", steps[i].frequency, ex.what());
+                }
+                window.startNs = nextTimeNs + steps[i].settleNs;
+                window.numElems = size_t(std::max<long long>(1, SoapySDR::timeNsToTicks(steps[i].dwellNs, rate)));
+                window.endNs = window.startNs + SoapySDR::ticksToTimeNs((long long)(window.numElems), rate);
+            }
+            const bool last = i+1 == steps.size();
+            const bool more = numSweeps == 0 or sweep+1 < numSweeps;
+            this->captureStep(i, sweep, window, timed and last and more);
+            lastEndNs = window.endNs;
+        }
+        if (running) sweeps++;
+    }
+    captured = true;
+}
+
+void SoapySDR::Scanner::Impl::captureStep(const size_t step, const size_t sweep, const ScanWindow &window, const bool planNext)
+{
+    size_t handle(0);
+    ScanSlot *slot = nullptr;
+    while (running and slot == nullptr) slot = ring.acquireWrite(handle, 100000);
+    if (slot == nullptr) return;
+    slot->step = step;
+    slot->sweep = sweep;
+    slot->timeNs = window.startNs;
+    slot->numElems = 0;
+    slot->status = 0;
+
+    void * const *buffs = pool.buffs(handle);
+    std::vector<void *> ptrs(numChans);
+    bool planned = not planNext;
+    while (running and slot->numElems < window.numElems)
+    {
+        const size_t offset = slot->numElems*elemSize;
+        for (size_t i = 0; i < numChans; i++) ptrs[i] = reinterpret_cast<char *>(buffs[i]) + offset;
+        int flags(0);
+        long long timeNs(0);
+        const int ret = device->readStream(stream, ptrs.data(), window.numElems - slot->numElems, flags, timeNs, 100000);
+        if (ret == SOAPY_SDR_TIMEOUT) continue;
+        if (ret == SOAPY_SDR_OVERFLOW)
+        {
+            if (slot->numElems != 0) slot->status = ret;
+            continue;
+        }
+        if (ret < 0)
+        {
+            slot->status = ret;
+            break;
+        }
+
+        //timestamps place the block, untimed blocks follow the previous one
+        long long blockNs = timeNs;
+        if (not timed or (flags & SOAPY_SDR_HAS_TIME) == 0)
+        {
+            if (timed and nextTimeNs == 0) nextTimeNs = device->getHardwareTime();
+            blockNs = nextTimeNs;
+        }
+        nextTimeNs = blockNs + SoapySDR::ticksToTimeNs((long long)(ret), rate);
+
+        //samples before the window are settling, samples after it belong to a later step
+        const size_t skip = (blockNs >= window.startNs)?0:size_t(std::min<long long>(ret, SoapySDR::timeNsToTicks(window.startNs - blockNs, rate)));
+        const size_t keepEnd = (blockNs >= window.endNs)?0:size_t(std::min<long long>(ret, SoapySDR::timeNsToTicks(window.endNs - blockNs, rate)));
+        if (keepEnd <= skip)
+        {
+            discarded += (unsigned long long)(ret);
+            if (blockNs < window.endNs) continue;
+            slot->status = (slot->numElems == 0)?SOAPY_SDR_TIME_ERROR:SOAPY_SDR_OVERFLOW;
+            break;
+        }
+
+        //the last retune of the sweep has happened, schedule the next sweep behind it
+        if (not planned)
+        {
+            nextWindows = this->plan(window.endNs);
+            planned = true;
+        }
+
+        if (slot->numElems == 0) slot->timeNs = blockNs + SoapySDR::ticksToTimeNs((long long)(skip), rate);
+        if (skip != 0) for (size_t i = 0; i < numChans; i++)
+        {
+            std::memmove(ptrs[i], reinterpret_cast<const char *>(ptrs[i]) + skip*elemSize, (keepEnd - skip)*elemSize);
+        }
+        slot->numElems += keepEnd - skip;
+        discarded += (unsigned long long)(size_t(ret) - (keepEnd - skip));
+
+        //a gap in the timestamps ended the window early
+        if (keepEnd < size_t(ret))
+        {
+            if (slot->numElems < window.numElems) slot->status = SOAPY_SDR_OVERFLOW;
+            break;
+        }
+    }
+    if (not planned and running) nextWindows = this->plan(window.endNs);
+    ring.releaseWrite(handle);
+}
+
+void SoapySDR::Scanner::Impl::deliver(void)
+{
+    while (running)
+    {
+        if (captured and ring.size() == 0) break;
+        size_t handle(0);
+        const ScanSlot *slot = ring.acquireRead(handle, 10000);
+        if (slot == nullptr) continue;
+
+        SoapySDR::Scanner::Capture capture;
+        capture.step = slot->step;
+        capture.sweep = slot->sweep;
+        capture.frequency = steps[slot->step].frequency;
+        capture.timeNs = slot->timeNs;
+        capture.numElems = slot->numElems;
+        capture.buffs = pool.buffs(handle);
+        capture.status = slot->status;
+        if (running) try
+        {
+            if (callback) callback(capture);
+        }
+        catch (const std::exception &ex)
+        {
+            SoapySDR::logf(SOAPY_SDR_ERROR, "Scanner callback failed: %s", ex.what());
+        }
+        captures++;
+        ring.releaseRead(handle);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    finished = true;
+    cond.notify_all();
+}
+
+/***********************************************************************
+ * Scanner
+ **********************************************************************/
+SoapySDR::Scanner::Scanner(Device *device, Stream *stream, const size_t channel, const size_t numChans, const size_t elemSize, const Kwargs &args):
+    _impl(nullptr)
+{
+    const size_t numBuffers = std::max<size_t>(1, (args.count("buffers") != 0)?std::stoul(args.at("buffers")):4);
+    _impl = new Impl(numBuffers);
+    try
+    {
+        _impl->device = device;
+        _impl->stream = stream;
+        _impl->channel = channel;
+        _impl->numChans = numChans;
+        _impl->elemSize = elemSize;
+        _impl->leadNs = (args.count("lead_us") != 0)?std::stoll(args.at("lead_us"))*1000:10000000;
+        _impl->timed = device->hasHardwareTime() and not (args.count("timed") != 0 and args.at("timed") == "false");
+        _impl->hints = SoapySDR::ThreadHints(args);
+    }
+    catch (...)
+    {
+        delete _impl;
+        throw;
+    }
+}
+
+SoapySDR::Scanner::~Scanner(void)
+{
+    this->stop();
+    delete _impl;
+}
+
+void SoapySDR::Scanner::start(const std::vector<Step> &steps, const Callback &callback, const size_t numSweeps)
+{
+    if (steps.empty()) throw std::invalid_argument("Scanner::start() no steps");
+    this->stop();
+
+    //step buffers hold the longest dwell
+    _impl->rate = _impl->device->getSampleRate(SOAPY_SDR_RX, _impl->channel);
+    size_t maxElems(1);
+    for (const auto &step : steps) maxElems = std::max<size_t>(maxElems, size_t(SoapySDR::timeNsToTicks(step.dwellNs, _impl->rate)));
+    _impl->pool.resize(_impl->numChans, maxElems, _impl->elemSize, _impl->ring.capacity(), 0, _impl->hints.numaNode);
+
+    _impl->steps = steps;
+    _impl->callback = callback;
+    _impl->numSweeps = numSweeps;
+    _impl->nextTimeNs = 0;
+    _impl->sweeps = 0;
+    _impl->captures = 0;
+    _impl->discarded = 0;
+    _impl->captured = false;
+    _impl->finished = false;
+    _impl->running = true;
+    _impl->captureThread = std::thread(&Impl::capture, _impl);
+    _impl->deliverThread = std::thread(&Impl::deliver, _impl);
+}
+
+void SoapySDR::Scanner::stop(void)
+{
+    if (not _impl->captureThread.joinable()) return;
+    _impl->running = false;
+    _impl->captureThread.join();
+    _impl->deliverThread.join();
+    if (_impl->timed) _impl->device->cancelScheduledSettings();
+
+    //discard the steps that were not delivered
+    size_t handle(0);
+    while (_impl->ring.acquireRead(handle) != nullptr) _impl->ring.releaseRead(handle);
+}
+
+bool SoapySDR::Scanner::wait(const long timeoutUs)
+{
+    std::unique_lock<std::mutex> lock(_impl->mutex);
+    return _impl->cond.wait_for(lock, std::chrono::microseconds(timeoutUs), [this]{return _impl->finished;});
+}
+
+size_t SoapySDR::Scanner::numSweeps(void) const
+{
+    return _impl->sweeps;
+}
+
+unsigned long long SoapySDR::Scanner::numCaptures(void) const
+{
+    return _impl->captures;
+}
+
+unsigned long long SoapySDR::Scanner::numDiscarded(void) const
+{
+    return _impl->discarded;
+}
@@ -0,0 +1,178 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include "SensorPoller.hpp"
+#include <SoapySDR/Logger.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include <tuple>
+#include <map>
+
+//updates due within this window are coalesced into the same pass
+static const std::chrono::milliseconds coalesceWindow(1);
+
+SoapySDR::SensorPoller::SensorPoller(const Device *device):
+    _device(device),
+    _epoch(Clock::now()),
+    _running(false),
+    _polling(false)
+{
+    return;
+}
+
+SoapySDR::SensorPoller::~SensorPoller(void)
+{
+    std::thread thread;
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _cond.wait(lock, [this]{return not _polling;});
+        for (auto &entry : _entries) delete entry.subscription;
+        _entries.clear();
+        thread.swap(_thread);
+    }
+    _cond.notify_all();
+    if (thread.joinable()) thread.join();
+}
+
+SoapySDR::SensorSubscription *SoapySDR::SensorPoller::subscribe(
+    const std::vector<SensorSubscription::Sensor> &sensors,
+    const double rate,
+    const SensorSubscription::Callback &callback)
+{
+    if (not (rate > 0.0)) throw std::invalid_argument("SensorPoller::subscribe() rate must be positive");
+
+    Entry entry;
+    for (const auto &sensor : sensors)
+    {
+        const auto info = sensor.isChannel?
+            _device->getSensorInfo(sensor.direction, sensor.channel, sensor.key):
+            _device->getSensorInfo(sensor.key);
+        entry.types.push_back(info.type);
+    }
+
+    //align to a multiple of the period so equal rates share a pass
+    entry.period = std::max<Clock::duration>(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0/rate)), Clock::duration(1));
+    const auto elapsed = Clock::now() - _epoch;
+    entry.next = _epoch + ((elapsed + entry.period - Clock::duration(1))/entry.period)*entry.period;
+    entry.subscription = new SensorSubscription(sensors, rate, callback);
+
+    std::thread finished;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _entries.push_back(entry);
+        if (not _running)
+        {
+            finished.swap(_thread);
+            _running = true;
+            _thread = std::thread(&SensorPoller::run, this);
+        }
+    }
+    _cond.notify_all();
+    if (finished.joinable()) finished.join();
+    return entry.subscription;
+}
+
+void SoapySDR::SensorPoller::unsubscribe(SensorSubscription *subscription)
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _entries.erase(std::remove_if(_entries.begin(), _entries.end(),
+            [subscription](const Entry &entry){return entry.subscription == subscription;}), _entries.end());
+        _cond.notify_all();
+
+        //the current pass may still use the subscription
+        if (_polling)
+        {
+            if (std::this_thread::get_id() == _thread.get_id())
+            {
+                _retired.push_back(subscription);
+                return;
+            }
+            _cond.wait(lock, [this]{return not _polling;});
+        }
+    }
+    delete subscription;
+}
+
+void SoapySDR::SensorPoller::run(void)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (not _entries.empty())
+    {
+        auto next = _entries.front().next;
+        for (const auto &entry : _entries) next = std::min(next, entry.next);
+        const auto now = Clock::now();
+        if (next > now + coalesceWindow)
+        {
+            _cond.wait_until(lock, next);
+            continue;
+        }
+
+        //collect the due entries and schedule their next update, skipping missed periods
+        std::vector<Entry> due;
+        for (auto &entry : _entries)
+        {
+            if (entry.next > now + coalesceWindow) continue;
+            due.push_back(entry);
+            entry.next += entry.period;
+            if (entry.next <= now) entry.next += ((now - entry.next)/entry.period + 1)*entry.period;
+        }
+
+        _polling = true;
+        lock.unlock();
+        this->poll(due);
+        lock.lock();
+        _polling = false;
+        for (auto subscription : _retired) delete subscription;
+        _retired.clear();
+        _cond.notify_all();
+    }
+    _running = false;
+}
+
+void SoapySDR::SensorPoller::poll(const std::vector<Entry> &due)
+{
+    //each distinct sensor is read once per pass
+    typedef std::tuple<bool, int, size_t, std::string> Key;
+    std::map<Key, std::pair<bool, std::string>> readings;
+
+    for (const auto &entry : due)
+    {
+        const auto &sensors = entry.subscription->sensors();
+        std::vector<SensorSubscription::Value> values(sensors.size());
+        for (size_t i = 0; i < sensors.size(); i++)
+        {
+            const auto &sensor = sensors[i];
+            const Key key(sensor.isChannel, sensor.direction, sensor.channel, sensor.key);
+            auto it = readings.find(key);
+            if (it == readings.end())
+            {
+                std::pair<bool, std::string> reading(false, "");
+                try
+                {
+                    reading.second = sensor.isChannel?
+                        _device->readSensor(sensor.direction, sensor.channel, sensor.key):
+                        _device->readSensor(sensor.key);
+                    reading.first = true;
+                }
+                catch (const std::exception &)
+                {
+                    //reported as an invalid value
+                }
+                it = readings.insert(std::make_pair(key, reading)).first;
+            }
+
+            if (it->second.first) values[i] = SensorSubscription::parseValue(entry.types[i], it->second.second);
+            else values[i].type = entry.types[i];
+        }
+        try
+        {
+            entry.subscription->publish(values);
+        }
+        catch (const std::exception &ex)
+        {
+            SoapySDR::logf(SOAPY_SDR_ERROR, "Device::subscribeSensors() callback failed: %s", ex.what());
+        }
+    }
+}
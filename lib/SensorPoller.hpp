@@ -0,0 +1,59 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include <SoapySDR/Device.hpp>
+#include <SoapySDR/SensorSubscription.hpp>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+namespace SoapySDR
+{
+
+/*!
+ * The default implementation of Device::subscribeSensors().
+ * A single background thread serves all subscriptions of a device.
+ * Update times are aligned to multiples of each period,
+ * and sensors that are due in the same pass are read only once.
+ * The thread exits when the last subscription is removed.
+ */
+class SensorPoller
+{
+public:
+    SensorPoller(const Device *device);
+
+    ~SensorPoller(void);
+
+    SensorSubscription *subscribe(const std::vector<SensorSubscription::Sensor> &sensors, const double rate, const SensorSubscription::Callback &callback);
+
+    void unsubscribe(SensorSubscription *subscription);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Entry
+    {
+        SensorSubscription *subscription;
+        std::vector<ArgInfo::Type> types;
+        Clock::duration period;
+        Clock::time_point next;
+    };
+
+    void run(void);
+    void poll(const std::vector<Entry> &due);
+
+    const Device *_device;
+    const Clock::time_point _epoch;
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    std::thread _thread;
+    bool _running;
+    bool _polling;
+    std::vector<Entry> _entries;
+    std::vector<SensorSubscription *> _retired;
+};
+
+}
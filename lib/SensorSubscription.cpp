@@ -0,0 +1,101 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/SensorSubscription.hpp>
+#include <cstdlib>
+#include <cmath>
+
+SoapySDR::SensorSubscription::Sensor::Sensor(void):
+    isChannel(false),
+    direction(0),
+    channel(0)
+{
+    return;
+}
+
+SoapySDR::SensorSubscription::Sensor::Sensor(const std::string &key):
+    key(key),
+    isChannel(false),
+    direction(0),
+    channel(0)
+{
+    return;
+}
+
+SoapySDR::SensorSubscription::Sensor::Sensor(const int direction, const size_t channel, const std::string &key):
+    key(key),
+    isChannel(true),
+    direction(direction),
+    channel(channel)
+{
+    return;
+}
+
+SoapySDR::SensorSubscription::Value::Value(void):
+    type(ArgInfo::STRING),
+    valid(false),
+    boolValue(false),
+    intValue(0),
+    floatValue(0.0)
+{
+    return;
+}
+
+SoapySDR::SensorSubscription::SensorSubscription(const std::vector<Sensor> &sensors, const double rate, const Callback &callback):
+    _sensors(sensors),
+    _rate(rate),
+    _callback(callback)
+{
+    return;
+}
+
+SoapySDR::SensorSubscription::~SensorSubscription(void)
+{
+    return;
+}
+
+SoapySDR::SensorSubscription::Snapshot SoapySDR::SensorSubscription::snapshot(void) const
+{
+    return std::atomic_load(&_snapshot);
+}
+
+void SoapySDR::SensorSubscription::publish(const std::vector<Value> &values)
+{
+    std::atomic_store(&_snapshot, Snapshot(new std::vector<Value>(values)));
+    if (_callback) _callback(values);
+}
+
+SoapySDR::SensorSubscription::Value SoapySDR::SensorSubscription::parseValue(const ArgInfo::Type type, const std::string &text)
+{
+    Value value;
+    value.type = type;
+    value.text = text;
+
+    const char *begin = text.c_str();
+    char *end = nullptr;
+    switch (type)
+    {
+    case ArgInfo::BOOL:
+        value.valid = (text == "true" or text == "false");
+        value.boolValue = (text == "true");
+        value.intValue = value.boolValue?1:0;
+        value.floatValue = double(value.intValue);
+        break;
+    case ArgInfo::INT:
+        value.intValue = std::strtoll(begin, &end, 10);
+        value.valid = (end != begin);
+        value.floatValue = double(value.intValue);
+        value.boolValue = (value.intValue != 0);
+        break;
+    case ArgInfo::FLOAT:
+        value.floatValue = std::strtod(begin, &end);
+        value.valid = (end != begin);
+        value.intValue = std::llround(value.floatValue);
+        value.boolValue = (value.floatValue != 0.0);
+        break;
+    case ArgInfo::STRING:
+        value.valid = true;
+        break;
+    }
+    return value;
+}
@@ -0,0 +1,98 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/SettingsTransaction.hpp>
+
+SoapySDR::SettingsTransaction::Command::Command(void):
+    type(SETTING),
+    direction(0),
+    channel(0),
+    value(0.0),
+    timeNs(0)
+{
+    return;
+}
+
+SoapySDR::SettingsTransaction::SettingsTransaction(void):
+    _timeNs(0)
+{
+    return;
+}
+
+SoapySDR::SettingsTransaction::Command &SoapySDR::SettingsTransaction::push(const Type type, const int direction, const size_t channel)
+{
+    _commands.push_back(Command());
+    Command &command = _commands.back();
+    command.type = type;
+    command.direction = direction;
+    command.channel = channel;
+    command.timeNs = _timeNs;
+    return command;
+}
+
+void SoapySDR::SettingsTransaction::setFrequency(const int direction, const size_t channel, const double frequency, const Kwargs &args)
+{
+    Command &command = this->push(FREQUENCY, direction, channel);
+    command.value = frequency;
+    command.args = args;
+}
+
+void SoapySDR::SettingsTransaction::setFrequency(const int direction, const size_t channel, const std::string &name, const double frequency, const Kwargs &args)
+{
+    Command &command = this->push(FREQUENCY, direction, channel);
+    command.name = name;
+    command.value = frequency;
+    command.args = args;
+}
+
+void SoapySDR::SettingsTransaction::setGain(const int direction, const size_t channel, const double value)
+{
+    this->push(GAIN, direction, channel).value = value;
+}
+
+void SoapySDR::SettingsTransaction::setGain(const int direction, const size_t channel, const std::string &name, const double value)
+{
+    Command &command = this->push(GAIN, direction, channel);
+    command.name = name;
+    command.value = value;
+}
+
+void SoapySDR::SettingsTransaction::setBandwidth(const int direction, const size_t channel, const double bw)
+{
+    this->push(BANDWIDTH, direction, channel).value = bw;
+}
+
+void SoapySDR::SettingsTransaction::setSampleRate(const int direction, const size_t channel, const double rate)
+{
+    this->push(SAMPLE_RATE, direction, channel).value = rate;
+}
+
+void SoapySDR::SettingsTransaction::setAntenna(const int direction, const size_t channel, const std::string &name)
+{
+    this->push(ANTENNA, direction, channel).text = name;
+}
+
+void SoapySDR::SettingsTransaction::writeSetting(const std::string &key, const std::string &value)
+{
+    Command &command = this->push(SETTING, 0, 0);
+    command.name = key;
+    command.text = value;
+}
+
+void SoapySDR::SettingsTransaction::writeSetting(const int direction, const size_t channel, const std::string &key, const std::string &value)
+{
+    Command &command = this->push(CHANNEL_SETTING, direction, channel);
+    command.name = key;
+    command.text = value;
+}
+
+void SoapySDR::SettingsTransaction::setCommandTime(const long long timeNs)
+{
+    _timeNs = timeNs;
+}
+
+void SoapySDR::SettingsTransaction::clear(void)
+{
+    _commands.clear();
+    _timeNs = 0;
+}
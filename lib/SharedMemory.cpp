@@ -0,0 +1,203 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include "SharedMemory.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+static std::string sharedMemoryName(const std::string &name)
+{
+    if (name.empty() or name.find_first_of("/\\") != std::string::npos)
+    {
+        throw std::invalid_argument("SharedMemory invalid name '" + name + "'");
+    }
+    #ifdef _WIN32
+    return "Local\\SoapySDR." + name;
+    #else
+    return "/SoapySDR." + name;
+    #endif
+}
+
+SoapySDR::SharedMemory::SharedMemory(void):
+    _data(nullptr),
+    _length(0),
+    _handle(nullptr)
+{
+    return;
+}
+
+SoapySDR::SharedMemory::~SharedMemory(void)
+{
+    #ifdef _WIN32
+    UnmapViewOfFile(_data);
+    CloseHandle(reinterpret_cast<HANDLE>(_handle));
+    #else
+    if (_data != nullptr) munmap(_data, _length);
+    #endif
+}
+
+void *SoapySDR::SharedMemory::data(void) const
+{
+    return _data;
+}
+
+size_t SoapySDR::SharedMemory::length(void) const
+{
+    return _length;
+}
+
+#ifdef _WIN32
+
+SoapySDR::SharedMemory *SoapySDR::SharedMemory::create(const std::string &name, const size_t length)
+{
+    const auto path = sharedMemoryName(name);
+    const unsigned long long size = length;
+    HANDLE handle = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, DWORD(size >> 32), DWORD(size), path.c_str());
+    if (handle == nullptr) throw std::runtime_error("SharedMemory CreateFileMapping() failed for " + path);
+    if (GetLastError() == ERROR_ALREADY_EXISTS)
+    {
+        CloseHandle(handle);
+        return nullptr;
+    }
+    void *data = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, length);
+    if (data == nullptr)
+    {
+        CloseHandle(handle);
+        throw std::runtime_error("SharedMemory MapViewOfFile() failed for " + path);
+    }
+    auto shm = new SharedMemory();
+    shm->_data = data;
+    shm->_length = length;
+    shm->_handle = handle;
+    return shm;
+}
+
+SoapySDR::SharedMemory *SoapySDR::SharedMemory::open(const std::string &name)
+{
+    const auto path = sharedMemoryName(name);
+    HANDLE handle = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, path.c_str());
+    if (handle == nullptr) throw std::runtime_error("SharedMemory no segment " + path);
+    void *data = MapViewOfFile(handle, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION info;
+    if (data == nullptr or VirtualQuery(data, &info, sizeof(info)) == 0)
+    {
+        if (data != nullptr) UnmapViewOfFile(data);
+        CloseHandle(handle);
+        throw std::runtime_error("SharedMemory MapViewOfFile() failed for " + path);
+    }
+    auto shm = new SharedMemory();
+    shm->_data = data;
+    shm->_length = info.RegionSize;
+    shm->_handle = handle;
+    return shm;
+}
+
+void SoapySDR::SharedMemory::remove(const std::string &)
+{
+    return;
+}
+
+long long SoapySDR::SharedMemory::processId(void)
+{
+    return (long long)GetCurrentProcessId();
+}
+
+bool SoapySDR::SharedMemory::processAlive(const long long pid)
+{
+    HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, DWORD(pid));
+    if (process == nullptr) return GetLastError() != ERROR_INVALID_PARAMETER;
+    const bool alive = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+    CloseHandle(process);
+    return alive;
+}
+
+#else
+
+static void *mapSharedMemory(const int fd, const std::string &path, const size_t length)
+{
+    void *data = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    const int err = errno;
+    ::close(fd);
+    if (data == MAP_FAILED) throw std::runtime_error("SharedMemory failed to map " + path + ": " + std::strerror(err));
+    return data;
+}
+
+SoapySDR::SharedMemory *SoapySDR::SharedMemory::create(const std::string &name, const size_t length)
+{
+    const auto path = sharedMemoryName(name);
+    const int fd = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0660);
+    if (fd < 0 and errno == EEXIST) return nullptr;
+    if (fd < 0) throw std::runtime_error("SharedMemory failed to create " + path + ": " + std::strerror(errno));
+    if (ftruncate(fd, off_t(length)) != 0)
+    {
+        const int err = errno;
+        ::close(fd);
+        shm_unlink(path.c_str());
+        throw std::runtime_error("SharedMemory failed to size " + path + ": " + std::strerror(err));
+    }
+    auto shm = new SharedMemory();
+    try
+    {
+        shm->_data = mapSharedMemory(fd, path, length);
+    }
+    catch (...)
+    {
+        shm_unlink(path.c_str());
+        delete shm;
+        throw;
+    }
+    shm->_length = length;
+    return shm;
+}
+
+SoapySDR::SharedMemory *SoapySDR::SharedMemory::open(const std::string &name)
+{
+    const auto path = sharedMemoryName(name);
+    const int fd = shm_open(path.c_str(), O_RDWR, 0);
+    if (fd < 0) throw std::runtime_error("SharedMemory failed to open " + path + ": " + std::strerror(errno));
+    struct stat st;
+    if (fstat(fd, &st) != 0 or st.st_size == 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("SharedMemory empty segment " + path);
+    }
+    auto shm = new SharedMemory();
+    try
+    {
+        shm->_data = mapSharedMemory(fd, path, size_t(st.st_size));
+    }
+    catch (...)
+    {
+        delete shm;
+        throw;
+    }
+    shm->_length = size_t(st.st_size);
+    return shm;
+}
+
+void SoapySDR::SharedMemory::remove(const std::string &name)
+{
+    shm_unlink(sharedMemoryName(name).c_str());
+}
+
+long long SoapySDR::SharedMemory::processId(void)
+{
+    return (long long)getpid();
+}
+
+bool SoapySDR::SharedMemory::processAlive(const long long pid)
+{
+    return kill(pid_t(pid), 0) == 0 or errno != ESRCH;
+}
+
+#endif
@@ -0,0 +1,61 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include <string>
+#include <cstddef>
+
+namespace SoapySDR
+{
+
+/*!
+ * A named shared memory segment mapped read and write.
+ * A POSIX shared memory object on unix systems,
+ * and a file mapping backed by the paging file on Windows.
+ */
+class SharedMemory
+{
+public:
+
+    /*!
+     * Create a zero filled segment.
+     * \return nullptr when the name is already in use
+     * \throws std::runtime_error on other failures
+     */
+    static SharedMemory *create(const std::string &name, const size_t length);
+
+    /*!
+     * Open an existing segment at its full length.
+     * \throws std::runtime_error when it does not exist
+     */
+    static SharedMemory *open(const std::string &name);
+
+    /*!
+     * Remove the name so that it can be created again.
+     * Mappings stay valid until they are closed.
+     * Windows removes the name with the last open mapping.
+     */
+    static void remove(const std::string &name);
+
+    //! The identifier of the calling process
+    static long long processId(void);
+
+    //! False when the process is known to have exited
+    static bool processAlive(const long long pid);
+
+    ~SharedMemory(void);
+
+    void *data(void) const;
+
+    size_t length(void) const;
+
+private:
+    SharedMemory(void);
+    SharedMemory(const SharedMemory &);
+    SharedMemory &operator=(const SharedMemory &);
+    void *_data;
+    size_t _length;
+    void *_handle;
+};
+
+}
@@ -0,0 +1,321 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/Recording.hpp>
+#include <SoapySDR/Formats.hpp>
+#include <stdexcept>
+#include <sstream>
+#include <fstream>
+#include <iomanip>
+#include <cstdlib>
+#include <cctype>
+#include <utility>
+#include <map>
+
+/***********************************************************************
+ * Format names
+ **********************************************************************/
+static const std::pair<const char *, const char *> sigmfFormats[] = {
+    {SOAPY_SDR_CF64, "cf64_le"}, {SOAPY_SDR_CF32, "cf32_le"},
+    {SOAPY_SDR_CS32, "ci32_le"}, {SOAPY_SDR_CU32, "cu32_le"},
+    {SOAPY_SDR_CS16, "ci16_le"}, {SOAPY_SDR_CU16, "cu16_le"},
+    {SOAPY_SDR_CS8, "ci8"}, {SOAPY_SDR_CU8, "cu8"},
+    {SOAPY_SDR_F64, "rf64_le"}, {SOAPY_SDR_F32, "rf32_le"},
+    {SOAPY_SDR_S32, "ri32_le"}, {SOAPY_SDR_U32, "ru32_le"},
+    {SOAPY_SDR_S16, "ri16_le"}, {SOAPY_SDR_U16, "ru16_le"},
+    {SOAPY_SDR_S8, "ri8"}, {SOAPY_SDR_U8, "ru8"},
+};
+
+std::string SoapySDR::formatToSigMF(const std::string &format)
+{
+    for (const auto &pair : sigmfFormats) if (format == pair.first) return pair.second;
+    return "";
+}
+
+std::string SoapySDR::formatFromSigMF(const std::string &datatype)
+{
+    for (const auto &pair : sigmfFormats) if (datatype == pair.second) return pair.first;
+    return "";
+}
+
+/***********************************************************************
+ * A minimal JSON reader for the metadata files:
+ * objects, arrays, strings, numbers, and literals
+ **********************************************************************/
+struct SigMFValue
+{
+    SigMFValue(void):
+        isObject(false),
+        number(0.0)
+    {
+        return;
+    }
+
+    bool isObject;
+    std::string text;
+    double number;
+    std::map<std::string, SigMFValue> members;
+    std::vector<SigMFValue> items;
+
+    const SigMFValue *find(const std::string &key) const
+    {
+        const auto it = members.find(key);
+        return (it == members.end())?nullptr:&it->second;
+    }
+};
+
+class SigMFParser
+{
+public:
+    SigMFParser(const std::string &json):
+        _json(json),
+        _pos(0)
+    {
+        return;
+    }
+
+    SigMFValue parse(void)
+    {
+        auto value = this->value();
+        this->skip();
+        if (_pos != _json.size()) this->fail("trailing characters");
+        return value;
+    }
+
+private:
+    void fail(const std::string &what) const
+    {
+        throw std::runtime_error("SigMFMeta::fromJSON() " + what + " at offset " + std::to_string(_pos));
+    }
+
+    void skip(void)
+    {
+        while (_pos < _json.size() and std::isspace((unsigned char)_json[_pos])) _pos++;
+    }
+
+    bool accept(const char ch)
+    {
+        this->skip();
+        if (_pos < _json.size() and _json[_pos] == ch)
+        {
+            _pos++;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(const char ch)
+    {
+        if (not this->accept(ch)) this->fail(std::string("expected '") + ch + "'");
+    }
+
+    std::string string(void)
+    {
+        this->expect('"');
+        std::string out;
+        while (_pos < _json.size() and _json[_pos] != '"')
+        {
+            char ch = _json[_pos++];
+            if (ch == '\\' and _pos < _json.size())
+            {
+                ch = _json[_pos++];
+                switch (ch)
+                {
+                case 'n': ch = '\n'; break;
+                case 't': ch = '\t'; break;
+                case 'r': ch = '\r'; break;
+                case 'b': ch = '\b'; break;
+                case 'f': ch = '\f'; break;
+                case 'u':
+                    //only the ASCII range is decoded, other code points become '?'
+                    ch = char(std::strtol(_json.substr(_pos, 4).c_str(), nullptr, 16));
+                    if ((unsigned char)(ch) > 0x7f) ch = '?';
+                    _pos += 4;
+                    break;
+                default: break;
+                }
+            }
+            out.push_back(ch);
+        }
+        this->expect('"');
+        return out;
+    }
+
+    SigMFValue value(void)
+    {
+        SigMFValue value;
+        this->skip();
+        if (_pos >= _json.size()) this->fail("unexpected end");
+        const char ch = _json[_pos];
+        if (ch == '{')
+        {
+            _pos++;
+            value.isObject = true;
+            if (this->accept('}')) return value;
+            do
+            {
+                const auto key = this->string();
+                this->expect(':');
+                value.members[key] = this->value();
+            } while (this->accept(','));
+            this->expect('}');
+        }
+        else if (ch == '[')
+        {
+            _pos++;
+            if (this->accept(']')) return value;
+            do value.items.push_back(this->value());
+            while (this->accept(','));
+            this->expect(']');
+        }
+        else if (ch == '"') value.text = this->string();
+        else
+        {
+            //numbers and the true, false, and null literals
+            const size_t start = _pos;
+            while (_pos < _json.size() and std::string(",]} \t\r\n").find(_json[_pos]) == std::string::npos) _pos++;
+            value.text = _json.substr(start, _pos-start);
+            value.number = std::strtod(value.text.c_str(), nullptr);
+            if (value.text.empty()) this->fail("expected a value");
+        }
+        return value;
+    }
+
+    const std::string &_json;
+    size_t _pos;
+};
+
+static std::string quoted(const std::string &s)
+{
+    std::string out("\"");
+    for (const char ch : s)
+    {
+        switch (ch)
+        {
+        case '"': out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\t': out += "\\t"; break;
+        case '\r': out += "\\r"; break;
+        default:
+            if ((unsigned char)(ch) < 0x20) continue;
+            out.push_back(ch);
+        }
+    }
+    return out + "\"";
+}
+
+/***********************************************************************
+ * Metadata
+ **********************************************************************/
+SoapySDR::SigMFMeta::Capture::Capture(void):
+    sampleStart(0),
+    frequency(0.0),
+    hasTime(false),
+    timeNs(0)
+{
+    return;
+}
+
+SoapySDR::SigMFMeta::Annotation::Annotation(void):
+    sampleStart(0),
+    sampleCount(0)
+{
+    return;
+}
+
+SoapySDR::SigMFMeta::SigMFMeta(void):
+    sampleRate(0.0)
+{
+    return;
+}
+
+std::string SoapySDR::SigMFMeta::toJSON(void) const
+{
+    std::ostringstream os;
+    os << std::setprecision(17);
+    os << "{\n  \"global\": {\n";
+    os << "    \"core:datatype\": " << quoted(formatToSigMF(format)) << ",\n";
+    os << "    \"core:sample_rate\": " << sampleRate << ",\n";
+    os << "    \"core:version\": \"1.0.0\",\n";
+    if (not hardware.empty()) os << "    \"core:hw\": " << quoted(hardware) << ",\n";
+    if (not description.empty()) os << "    \"core:description\": " << quoted(description) << ",\n";
+    os << "    \"core:recorder\": \"SoapySDR\"\n  },\n";
+
+    os << "  \"captures\": [";
+    for (size_t i = 0; i < captures.size(); i++)
+    {
+        const auto &c = captures[i];
+        os << ((i == 0)?"\n":",\n") << "    {\"core:sample_start\": " << c.sampleStart << ", \"core:frequency\": " << c.frequency;
+        if (i == 0 and not datetime.empty()) os << ", \"core:datetime\": " << quoted(datetime);
+        if (c.hasTime) os << ", \"soapy:hardware_time_ns\": " << c.timeNs;
+        os << "}";
+    }
+    os << (captures.empty()?"],\n":"\n  ],\n");
+
+    os << "  \"annotations\": [";
+    for (size_t i = 0; i < annotations.size(); i++)
+    {
+        const auto &a = annotations[i];
+        os << ((i == 0)?"\n":",\n") << "    {\"core:sample_start\": " << a.sampleStart
+            << ", \"core:sample_count\": " << a.sampleCount << ", \"core:comment\": " << quoted(a.comment) << "}";
+    }
+    os << (annotations.empty()?"]\n":"\n  ]\n") << "}\n";
+    return os.str();
+}
+
+SoapySDR::SigMFMeta SoapySDR::SigMFMeta::fromJSON(const std::string &json)
+{
+    const auto root = SigMFParser(json).parse();
+    const auto global = root.find("global");
+    if (global == nullptr or not global->isObject) throw std::runtime_error("SigMFMeta::fromJSON() missing global object");
+
+    SigMFMeta meta;
+    const auto datatype = global->find("core:datatype");
+    meta.format = (datatype == nullptr)?"":formatFromSigMF(datatype->text);
+    if (meta.format.empty()) throw std::runtime_error("SigMFMeta::fromJSON() unsupported datatype " + ((datatype == nullptr)?std::string("(missing)"):datatype->text));
+    if (const auto rate = global->find("core:sample_rate")) meta.sampleRate = rate->number;
+    if (const auto hw = global->find("core:hw")) meta.hardware = hw->text;
+    if (const auto description = global->find("core:description")) meta.description = description->text;
+
+    if (const auto captures = root.find("captures")) for (const auto &item : captures->items)
+    {
+        Capture capture;
+        if (const auto start = item.find("core:sample_start")) capture.sampleStart = std::strtoull(start->text.c_str(), nullptr, 10);
+        if (const auto freq = item.find("core:frequency")) capture.frequency = freq->number;
+        if (const auto datetime = item.find("core:datetime")) if (meta.datetime.empty()) meta.datetime = datetime->text;
+        if (const auto time = item.find("soapy:hardware_time_ns"))
+        {
+            capture.hasTime = true;
+            capture.timeNs = std::strtoll(time->text.c_str(), nullptr, 10);
+        }
+        meta.captures.push_back(capture);
+    }
+
+    if (const auto annotations = root.find("annotations")) for (const auto &item : annotations->items)
+    {
+        Annotation annotation;
+        if (const auto start = item.find("core:sample_start")) annotation.sampleStart = std::strtoull(start->text.c_str(), nullptr, 10);
+        if (const auto count = item.find("core:sample_count")) annotation.sampleCount = std::strtoull(count->text.c_str(), nullptr, 10);
+        if (const auto comment = item.find("core:comment")) annotation.comment = comment->text;
+        meta.annotations.push_back(annotation);
+    }
+    return meta;
+}
+
+void SoapySDR::SigMFMeta::save(const std::string &path) const
+{
+    std::ofstream file(path.c_str(), std::ios::out | std::ios::trunc);
+    file << this->toJSON();
+    file.close();
+    if (not file) throw std::runtime_error("SigMFMeta::save() failed to write " + path);
+}
+
+SoapySDR::SigMFMeta SoapySDR::SigMFMeta::load(const std::string &path)
+{
+    std::ifstream file(path.c_str());
+    if (not file) throw std::runtime_error("SigMFMeta::load() failed to open " + path);
+    std::stringstream json;
+    json << file.rdbuf();
+    return fromJSON(json.str());
+}
@@ -0,0 +1,166 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/StreamCounters.hpp>
+#include <SoapySDR/Constants.h>
+#include <SoapySDR/Errors.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <limits>
+#include <cmath>
+
+/***********************************************************************
+ * Timestamp latency histogram for the latency_stats stream arg
+ **********************************************************************/
+struct TimeLatencyCounters
+{
+    TimeLatencyCounters(void):
+        numTimestamps(0),
+        minNs(std::numeric_limits<long long>::max()),
+        maxNs(std::numeric_limits<long long>::min()),
+        totalNs(0)
+    {
+        for (auto &bin : bins) bin.store(0, std::memory_order_relaxed);
+    }
+
+    void add(const long long ns)
+    {
+        const size_t index = (ns <= 1)?0:std::min(numBins-1, size_t(std::log2(double(ns))*binsPerOctave));
+        bins[index].fetch_add(1, std::memory_order_relaxed);
+        totalNs.fetch_add(ns, std::memory_order_relaxed);
+        long long minValue = minNs.load(std::memory_order_relaxed);
+        while (ns < minValue and not minNs.compare_exchange_weak(minValue, ns, std::memory_order_relaxed));
+        long long maxValue = maxNs.load(std::memory_order_relaxed);
+        while (ns > maxValue and not maxNs.compare_exchange_weak(maxValue, ns, std::memory_order_relaxed));
+        numTimestamps.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void load(SoapySDR::StreamStats &stats) const
+    {
+        const unsigned long long count = numTimestamps.load(std::memory_order_relaxed);
+        stats.numTimestamps = count;
+        if (count == 0) return;
+        stats.minTimeLatencyNs = minNs.load(std::memory_order_relaxed);
+        stats.maxTimeLatencyNs = maxNs.load(std::memory_order_relaxed);
+        stats.avgTimeLatencyNs = totalNs.load(std::memory_order_relaxed)/(long long)(count);
+
+        //the upper edge of the bin holding the percentile, clipped to the range
+        const auto target = (unsigned long long)(std::ceil(0.99*count));
+        unsigned long long total(0);
+        stats.p99TimeLatencyNs = stats.maxTimeLatencyNs;
+        for (size_t i = 0; i < numBins; i++)
+        {
+            total += bins[i].load(std::memory_order_relaxed);
+            if (total < target or total == 0) continue;
+            const auto upperNs = (long long)(std::pow(2.0, double(i+1)/binsPerOctave));
+            stats.p99TimeLatencyNs = std::max(std::min(upperNs, stats.maxTimeLatencyNs), stats.minTimeLatencyNs);
+            break;
+        }
+    }
+
+    static const size_t binsPerOctave = 8;
+    static const size_t numBins = 64*binsPerOctave;
+    std::atomic<unsigned long long> numTimestamps;
+    std::atomic<long long> minNs;
+    std::atomic<long long> maxNs;
+    std::atomic<long long> totalNs;
+    std::atomic<unsigned long long> bins[numBins];
+};
+
+/***********************************************************************
+ * Call counters
+ **********************************************************************/
+struct SoapySDR::StreamCounters::Impl
+{
+    Impl(const int direction):
+        direction(direction),
+        numCalls(0),
+        numTimed(0),
+        numElems(0),
+        numOverflows(0),
+        numUnderflows(0),
+        numTimeErrors(0),
+        numDropped(0),
+        maxLatencyNs(0),
+        totalLatencyNs(0)
+    {
+        return;
+    }
+
+    const int direction;
+    std::atomic<unsigned long long> numCalls;
+    std::atomic<unsigned long long> numTimed;
+    std::atomic<unsigned long long> numElems;
+    std::atomic<unsigned long long> numOverflows;
+    std::atomic<unsigned long long> numUnderflows;
+    std::atomic<unsigned long long> numTimeErrors;
+    std::atomic<unsigned long long> numDropped;
+    std::atomic<long long> maxLatencyNs;
+    std::atomic<long long> totalLatencyNs;
+    std::unique_ptr<TimeLatencyCounters> timeLatency;
+};
+
+SoapySDR::StreamCounters::StreamCounters(const int direction, const Kwargs &args):
+    _impl(new Impl(direction))
+{
+    if (args.count("latency_stats") != 0 and args.at("latency_stats") == "true") _impl->timeLatency.reset(new TimeLatencyCounters());
+}
+
+SoapySDR::StreamCounters::~StreamCounters(void)
+{
+    delete _impl;
+}
+
+bool SoapySDR::StreamCounters::measuresTime(void) const
+{
+    return bool(_impl->timeLatency);
+}
+
+void SoapySDR::StreamCounters::countCall(const Clock::time_point &start, const int ret, const size_t numElems)
+{
+    _impl->numCalls.fetch_add(1, std::memory_order_relaxed);
+    if (ret == SOAPY_SDR_TIMEOUT) return;
+
+    const long long latency = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now()-start).count();
+    _impl->numTimed.fetch_add(1, std::memory_order_relaxed);
+    _impl->totalLatencyNs.fetch_add(latency, std::memory_order_relaxed);
+    long long maxLatency = _impl->maxLatencyNs.load(std::memory_order_relaxed);
+    while (latency > maxLatency and not _impl->maxLatencyNs.compare_exchange_weak(maxLatency, latency, std::memory_order_relaxed));
+
+    if (ret < 0) this->countError(ret);
+    else _impl->numElems.fetch_add(numElems, std::memory_order_relaxed);
+}
+
+void SoapySDR::StreamCounters::countError(const int ret)
+{
+    switch (ret)
+    {
+    case SOAPY_SDR_OVERFLOW: _impl->numOverflows.fetch_add(1, std::memory_order_relaxed); break;
+    case SOAPY_SDR_UNDERFLOW: _impl->numUnderflows.fetch_add(1, std::memory_order_relaxed); break;
+    case SOAPY_SDR_TIME_ERROR: _impl->numTimeErrors.fetch_add(1, std::memory_order_relaxed); break;
+    case SOAPY_SDR_CORRUPTION: _impl->numDropped.fetch_add(1, std::memory_order_relaxed); break;
+    default: break;
+    }
+}
+
+//RX measures how old the buffer is, TX measures how far ahead it was written
+void SoapySDR::StreamCounters::countTime(const int flags, const long long timeNs, const long long hardwareNs)
+{
+    if (not _impl->timeLatency or (flags & SOAPY_SDR_HAS_TIME) == 0) return;
+    _impl->timeLatency->add((_impl->direction == SOAPY_SDR_RX)?(hardwareNs - timeNs):(timeNs - hardwareNs));
+}
+
+void SoapySDR::StreamCounters::load(StreamStats &stats) const
+{
+    stats.numCalls = _impl->numCalls.load(std::memory_order_relaxed);
+    stats.numElems = _impl->numElems.load(std::memory_order_relaxed);
+    stats.numOverflows = _impl->numOverflows.load(std::memory_order_relaxed);
+    stats.numUnderflows = _impl->numUnderflows.load(std::memory_order_relaxed);
+    stats.numTimeErrors = _impl->numTimeErrors.load(std::memory_order_relaxed);
+    stats.numDropped = _impl->numDropped.load(std::memory_order_relaxed);
+    stats.maxLatencyNs = _impl->maxLatencyNs.load(std::memory_order_relaxed);
+    const unsigned long long timed = _impl->numTimed.load(std::memory_order_relaxed);
+    stats.avgLatencyNs = (timed == 0)?0:(_impl->totalLatencyNs.load(std::memory_order_relaxed)/(long long)(timed));
+    if (_impl->timeLatency) _impl->timeLatency->load(stats);
+}
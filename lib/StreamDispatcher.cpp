@@ -0,0 +1,172 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include "StreamDispatcher.hpp"
+#include <SoapySDR/Logger.hpp>
+#include <SoapySDR/Errors.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+//the most buffers taken from one stream per pass, so that a busy stream does not starve the others
+static const size_t maxBuffersPerPass = 16;
+
+//the format is unknown here, so fallback transfers are sized for the largest element
+static const size_t maxElemSize = 16;
+
+SoapySDR::StreamDispatcher::StreamDispatcher(Device *device):
+    _device(device),
+    _running(false),
+    _dispatching(false)
+{
+    return;
+}
+
+SoapySDR::StreamDispatcher::~StreamDispatcher(void)
+{
+    std::thread thread;
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _wake.set(true);
+        _cond.wait(lock, [this]{return not _dispatching;});
+        for (auto &entry : _entries) delete entry.subscription;
+        _entries.clear();
+        thread.swap(_thread);
+    }
+    if (thread.joinable()) thread.join();
+}
+
+SoapySDR::StreamSubscription *SoapySDR::StreamDispatcher::subscribe(Stream *stream, const size_t numChans, const StreamSubscription::Callback &callback)
+{
+    Entry entry;
+    const int ret = _device->getStreamPollHandle(stream, entry.handle);
+    if (ret != 0 and ret != SOAPY_SDR_NOT_SUPPORTED) throw std::runtime_error("Device::subscribeStream() no poll handle: " + std::string(SoapySDR::errToStr(ret)));
+
+    //prefetch with readStream() for drivers without a handle or direct buffers
+    if (ret != 0 or _device->getNumDirectAccessBuffers(stream) == 0)
+    {
+        Device *device = _device;
+        entry.notifier.reset(new StreamNotifier(
+            [device, stream](void * const *buffs, const size_t numElems, int &flags, long long &timeNs, const long timeoutUs)
+            {return device->readStream(stream, buffs, numElems, flags, timeNs, timeoutUs);},
+            numChans, _device->getStreamMTU(stream), maxElemSize, ThreadHints()));
+        entry.handle = entry.notifier->handle();
+        entry.notifier->start(0.0);
+    }
+    entry.subscription = new StreamSubscription(stream, numChans, callback);
+
+    std::thread finished;
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _entries.push_back(entry);
+        _wake.set(true);
+        if (not _running)
+        {
+            finished.swap(_thread);
+            _running = true;
+            _thread = std::thread(&StreamDispatcher::run, this);
+        }
+    }
+    if (finished.joinable()) finished.join();
+    return entry.subscription;
+}
+
+void SoapySDR::StreamDispatcher::unsubscribe(StreamSubscription *subscription)
+{
+    //the notifier stops its reads once the pass is done with it
+    std::shared_ptr<StreamNotifier> notifier;
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        for (const auto &entry : _entries)
+        {
+            if (entry.subscription == subscription) notifier = entry.notifier;
+        }
+        _entries.erase(std::remove_if(_entries.begin(), _entries.end(),
+            [subscription](const Entry &entry){return entry.subscription == subscription;}), _entries.end());
+        _wake.set(true);
+
+        //the current pass may still use the subscription
+        if (_dispatching)
+        {
+            if (std::this_thread::get_id() == _thread.get_id())
+            {
+                _retired.push_back(subscription);
+                return;
+            }
+            _cond.wait(lock, [this]{return not _dispatching;});
+        }
+    }
+    delete subscription;
+}
+
+bool SoapySDR::StreamDispatcher::retired(StreamSubscription *subscription)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return std::find(_retired.begin(), _retired.end(), subscription) != _retired.end();
+}
+
+void SoapySDR::StreamDispatcher::run(void)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (not _entries.empty())
+    {
+        const std::vector<Entry> entries(_entries);
+        _wake.set(false);
+        _dispatching = true;
+        lock.unlock();
+
+        //the wake handle is last
+        std::vector<intptr_t> handles;
+        for (const auto &entry : entries) handles.push_back(entry.handle);
+        handles.push_back(_wake.handle());
+        std::vector<bool> ready;
+        PollEvent::wait(handles, ready, 100000);
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            if (ready[i] and not this->retired(entries[i].subscription)) this->dispatch(entries[i]);
+        }
+
+        lock.lock();
+        _dispatching = false;
+        for (auto subscription : _retired) delete subscription;
+        _retired.clear();
+        _cond.notify_all();
+    }
+    _running = false;
+}
+
+void SoapySDR::StreamDispatcher::dispatch(const Entry &entry)
+{
+    auto *subscription = entry.subscription;
+    auto *reader = entry.notifier?entry.notifier->reader():nullptr;
+    std::vector<const void *> buffs(subscription->numChans());
+    for (size_t i = 0; i < maxBuffersPerPass; i++)
+    {
+        size_t handle(0);
+        int flags(0);
+        long long timeNs(0);
+        const int ret = (reader != nullptr)?
+            reader->acquireReadBuffer(handle, buffs.data(), flags, timeNs, 0):
+            _device->acquireReadBuffer(subscription->stream(), handle, buffs.data(), flags, timeNs, 0);
+        if (reader != nullptr) entry.notifier->refresh();
+        if (ret == SOAPY_SDR_TIMEOUT) return;
+        try
+        {
+            subscription->publish((ret < 0)?nullptr:buffs.data(), ret, flags, timeNs);
+        }
+        catch (const std::exception &ex)
+        {
+            SoapySDR::logf(SOAPY_SDR_ERROR, "Device::subscribeStream() callback failed: %s", ex.what());
+        }
+        if (ret < 0) return; //the next pass continues while the handle is ready
+        if (reader == nullptr) _device->releaseReadBuffer(subscription->stream(), handle);
+        else
+        {
+            reader->releaseReadBuffer(handle);
+            entry.notifier->refresh();
+        }
+
+        //a callback that removed its own subscription ends the delivery
+        if (this->retired(subscription)) return;
+    }
+}
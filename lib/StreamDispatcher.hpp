@@ -0,0 +1,63 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include "PollEvent.hpp"
+#include "StreamNotifier.hpp"
+#include <SoapySDR/Device.hpp>
+#include <SoapySDR/StreamSubscription.hpp>
+#include <condition_variable>
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <vector>
+
+namespace SoapySDR
+{
+
+/*!
+ * The default implementation of Device::subscribeStream().
+ * A single background thread waits on the poll handles of all
+ * stream subscriptions of a device, and drains each ready stream
+ * with acquireReadBuffer() into the subscription callback.
+ * Streams without a poll handle or direct buffers are read with
+ * readStream() by a notifier of their own, which provides both.
+ * The thread exits when the last subscription is removed.
+ */
+class StreamDispatcher
+{
+public:
+    StreamDispatcher(Device *device);
+
+    ~StreamDispatcher(void);
+
+    StreamSubscription *subscribe(Stream *stream, const size_t numChans, const StreamSubscription::Callback &callback);
+
+    void unsubscribe(StreamSubscription *subscription);
+
+private:
+    struct Entry
+    {
+        StreamSubscription *subscription;
+        intptr_t handle;
+        std::shared_ptr<StreamNotifier> notifier;
+    };
+
+    void run(void);
+    void dispatch(const Entry &entry);
+    bool retired(StreamSubscription *subscription);
+
+    Device *_device;
+    std::mutex _mutex;
+    std::condition_variable _cond;
+    std::thread _thread;
+    bool _running;
+    bool _dispatching;
+    std::vector<Entry> _entries;
+    std::vector<StreamSubscription *> _retired;
+
+    //wakes the pass to pick up new and removed subscriptions
+    PollEvent _wake;
+};
+
+}
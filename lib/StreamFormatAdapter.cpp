@@ -0,0 +1,111 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/StreamFormatAdapter.hpp>
+#include <SoapySDR/ConverterRegistry.hpp>
+#include <SoapySDR/ThreadHints.hpp>
+#include <SoapySDR/Buffers.hpp>
+#include <SoapySDR/Constants.h>
+#include <SoapySDR/Formats.hpp>
+#include <SoapySDR/Logger.hpp>
+#include <SoapySDR/Tracer.hpp>
+#include <algorithm>
+#include <cmath>
+
+//the largest integer value of the format's sample type, or 0 for floats
+static double formatTypeFullScale(const std::string &format)
+{
+    if (format.find('F') != std::string::npos) return 0.0;
+    const size_t bits = SoapySDR::formatToSize(format)*8/((format[0] == 'C')?2:1);
+    return double((1ull << (bits-1))-1);
+}
+
+//scale integer samples at the device's full scale to the host format
+static double adapterScaler(const int direction, const std::string &format, const std::string &native, const double fullScale)
+{
+    const double typeFullScale = formatTypeFullScale(native);
+    if (typeFullScale == 0.0 or formatTypeFullScale(format) != 0.0) return 1.0;
+    if (fullScale <= 0.0 or std::abs(fullScale-typeFullScale) <= 1.0) return 1.0;
+    return (direction == SOAPY_SDR_RX)?(typeFullScale/fullScale):(fullScale/typeFullScale);
+}
+
+struct SoapySDR::StreamFormatAdapter::Impl
+{
+    ConverterRegistry::Converter converter;
+    double scaler;
+    size_t numChans;
+    size_t mtu;
+    BufferPool scratch;
+};
+
+std::vector<std::string> SoapySDR::StreamFormatAdapter::listFormats(const int direction, const std::string &native)
+{
+    std::vector<std::string> formats(1, native);
+    const auto converted = (direction == SOAPY_SDR_RX)?
+        ConverterRegistry::listTargetFormats(native):
+        ConverterRegistry::listSourceFormats(native);
+    for (const auto &format : converted)
+    {
+        if (std::find(formats.begin(), formats.end(), format) == formats.end()) formats.push_back(format);
+    }
+    return formats;
+}
+
+SoapySDR::StreamFormatAdapter::StreamFormatAdapter(const int direction, const std::string &format, const std::string &native,
+    const size_t numChans, const size_t mtu, const double fullScale, const Kwargs &args):
+    _impl(new Impl())
+{
+    try
+    {
+        //throws when the registry has no conversion
+        _impl->converter = (direction == SOAPY_SDR_RX)?
+            ConverterRegistry::getConverter(native, format):
+            ConverterRegistry::getConverter(format, native);
+        SoapySDR::logf(SOAPY_SDR_DEBUG, "StreamFormatAdapter converting %s to %s", format.c_str(), native.c_str());
+        _impl->scaler = adapterScaler(direction, format, native, fullScale);
+        _impl->numChans = std::max<size_t>(1, numChans);
+        _impl->mtu = mtu;
+        const size_t nativeSize = (direction == SOAPY_SDR_RX)?_impl->converter.sourceElemSize:_impl->converter.targetElemSize;
+        _impl->scratch.resize(_impl->numChans, mtu, nativeSize, 1, 0, ThreadHints(args).numaNode);
+    }
+    catch (...)
+    {
+        delete _impl;
+        throw;
+    }
+}
+
+SoapySDR::StreamFormatAdapter::~StreamFormatAdapter(void)
+{
+    delete _impl;
+}
+
+int SoapySDR::StreamFormatAdapter::readStream(const Read &read, void * const *buffs, const size_t numElems, int &flags, long long &timeNs, const long timeoutUs)
+{
+    const size_t n = std::min(numElems, _impl->mtu);
+    void * const *scratch = _impl->scratch.buffs();
+    const int ret = read(scratch, n, flags, timeNs, timeoutUs);
+    if (ret <= 0) return ret;
+    SoapySDR::TraceScope trace("convert", "converter");
+    for (size_t i = 0; i < _impl->numChans; i++)
+    {
+        _impl->converter(scratch[i], buffs[i], size_t(ret), _impl->scaler);
+    }
+    return ret;
+}
+
+int SoapySDR::StreamFormatAdapter::writeStream(const Write &write, const void * const *buffs, const size_t numElems, int &flags, const long long timeNs, const long timeoutUs)
+{
+    const size_t n = std::min(numElems, _impl->mtu);
+    void * const *scratch = _impl->scratch.buffs();
+    {
+        SoapySDR::TraceScope trace("convert", "converter");
+        for (size_t i = 0; i < _impl->numChans; i++)
+        {
+            _impl->converter(buffs[i], scratch[i], n, _impl->scaler);
+        }
+    }
+    //an end of burst applies to all of the requested elements
+    if (n < numElems) flags &= ~SOAPY_SDR_END_BURST;
+    return write(scratch, n, flags, timeNs, timeoutUs);
+}
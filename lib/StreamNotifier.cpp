@@ -0,0 +1,113 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include "StreamNotifier.hpp"
+#include <SoapySDR/Errors.h>
+#include <chrono>
+
+//the most status reports kept for the caller, older reports are dropped
+static const size_t maxStatusQueue = 64;
+
+SoapySDR::StreamNotifier::StreamNotifier(const AsyncReader::Transfer &transfer, const size_t numChans, const size_t numElems, const size_t elemSize, const ThreadHints &hints):
+    _reader(new AsyncReader(transfer, numChans, numElems, elemSize, 4, hints)),
+    _running(false),
+    _statusSupported(true)
+{
+    _reader->setNotify([this](void){this->refresh();});
+}
+
+SoapySDR::StreamNotifier::StreamNotifier(const StatusRead &statusRead):
+    _statusRead(statusRead),
+    _running(false),
+    _statusSupported(true)
+{
+    return;
+}
+
+SoapySDR::StreamNotifier::~StreamNotifier(void)
+{
+    this->stop();
+}
+
+intptr_t SoapySDR::StreamNotifier::handle(void) const
+{
+    return _event.handle();
+}
+
+void SoapySDR::StreamNotifier::start(const double rate)
+{
+    if (_reader)
+    {
+        _reader->setSampleRate(rate);
+        _reader->start();
+        return;
+    }
+    if (_running) return;
+    _running = true;
+    _thread = std::thread(&StreamNotifier::statusWork, this);
+}
+
+void SoapySDR::StreamNotifier::stop(void)
+{
+    if (_reader)
+    {
+        _reader->stop();
+        this->refresh();
+        return;
+    }
+    if (not _running) return;
+    _running = false;
+    _thread.join();
+}
+
+SoapySDR::AsyncReader *SoapySDR::StreamNotifier::reader(void) const
+{
+    return _reader.get();
+}
+
+void SoapySDR::StreamNotifier::refresh(void)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _event.set(_reader?(_reader->numReady() != 0):(not _status.empty()));
+}
+
+void SoapySDR::StreamNotifier::statusWork(void)
+{
+    while (_running)
+    {
+        Status status;
+        status.chanMask = 0;
+        status.flags = 0;
+        status.timeNs = 0;
+        status.ret = _statusRead(status.chanMask, status.flags, status.timeNs, 100000);
+        if (status.ret == SOAPY_SDR_TIMEOUT) continue;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _cond.notify_one();
+
+        //the driver has no status to report, the handle stays clear
+        if (status.ret == SOAPY_SDR_NOT_SUPPORTED)
+        {
+            _statusSupported = false;
+            break;
+        }
+        if (_status.size() == maxStatusQueue) _status.pop_front();
+        _status.push_back(status);
+        _event.set(true);
+    }
+}
+
+int SoapySDR::StreamNotifier::readStreamStatus(size_t &chanMask, int &flags, long long &timeNs, const long timeoutUs)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    if (not _cond.wait_for(lock, std::chrono::microseconds(timeoutUs), [this](void){
+        return not _status.empty() or not _statusSupported;})) return SOAPY_SDR_TIMEOUT;
+    if (_status.empty()) return SOAPY_SDR_NOT_SUPPORTED;
+    const Status status = _status.front();
+    _status.pop_front();
+    _event.set(not _status.empty());
+    chanMask = status.chanMask;
+    flags = status.flags;
+    timeNs = status.timeNs;
+    return status.ret;
+}
@@ -0,0 +1,82 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#pragma once
+#include "PollEvent.hpp"
+#include <SoapySDR/AsyncReader.hpp>
+#include <SoapySDR/ThreadHints.hpp>
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <deque>
+#include <memory>
+#include <atomic>
+
+namespace SoapySDR
+{
+
+/*!
+ * The default implementation of Device::getStreamPollHandle().
+ * The handle is set while the prefetched receive transfers or the
+ * queued transmit status hold something for the caller,
+ * and cleared once they are empty.
+ */
+class StreamNotifier
+{
+public:
+    //! The arguments and return codes of Device::readStreamStatus()
+    typedef std::function<int(size_t &chanMask, int &flags, long long &timeNs, const long timeoutUs)> StatusRead;
+
+    //! Prefetch receive transfers, ready while a read would not wait
+    StreamNotifier(const AsyncReader::Transfer &transfer, const size_t numChans, const size_t numElems, const size_t elemSize, const ThreadHints &hints);
+
+    //! Queue the stream status, ready while a report is waiting
+    StreamNotifier(const StatusRead &statusRead);
+
+    ~StreamNotifier(void);
+
+    intptr_t handle(void) const;
+
+    //! Start and stop the prefetch thread with the stream activation
+    void start(const double rate);
+    void stop(void);
+
+    //! The prefetched transfers of a receive stream or nullptr
+    AsyncReader *reader(void) const;
+
+    //! Read the queued status of a transmit stream
+    int readStreamStatus(size_t &chanMask, int &flags, long long &timeNs, const long timeoutUs);
+
+    //! Set or clear the handle after the caller took from the buffers
+    void refresh(void);
+
+private:
+    StreamNotifier(const StreamNotifier &);
+    StreamNotifier &operator=(const StreamNotifier &);
+
+    struct Status
+    {
+        int ret;
+        size_t chanMask;
+        int flags;
+        long long timeNs;
+    };
+
+    void statusWork(void);
+
+    std::unique_ptr<AsyncReader> _reader;
+    StatusRead _statusRead;
+    std::atomic<bool> _running;
+    std::thread _thread;
+    std::deque<Status> _status;
+    std::condition_variable _cond;
+    bool _statusSupported;
+
+    //the lock orders the checks of the buffers with the handle updates
+    std::mutex _mutex;
+    PollEvent _event;
+};
+
+}
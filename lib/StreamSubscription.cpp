@@ -0,0 +1,24 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/StreamSubscription.hpp>
+
+SoapySDR::StreamSubscription::StreamSubscription(Stream *stream, const size_t numChans, const Callback &callback):
+    _stream(stream),
+    _numChans(numChans),
+    _callback(callback),
+    _numPublished(0)
+{
+    return;
+}
+
+SoapySDR::StreamSubscription::~StreamSubscription(void)
+{
+    return;
+}
+
+void SoapySDR::StreamSubscription::publish(const void * const *buffs, const int ret, const int flags, const long long timeNs)
+{
+    _numPublished.fetch_add(1, std::memory_order_relaxed);
+    if (_callback) _callback(buffs, ret, flags, timeNs);
+}
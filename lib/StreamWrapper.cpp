@@ -0,0 +1,295 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include "DeviceWrapper.hpp"
+#include <SoapySDR/StreamFormatAdapter.hpp>
+#include <SoapySDR/StreamCounters.hpp>
+#include <SoapySDR/Tracer.hpp>
+#include <SoapySDR/Formats.hpp>
+#include <SoapySDR/Errors.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <memory>
+
+/***********************************************************************
+ * The stream handle returned to the caller:
+ * Streams in a format that the driver supports are passed through.
+ * Other formats are opened in the driver's native format and converted
+ * by a StreamFormatAdapter, which is allocated once in setupStream().
+ * The counters count the calls of every stream for getStreamStats(),
+ * and measure the timestamps with the latency_stats=true stream arg.
+ **********************************************************************/
+struct WrappedStream
+{
+    WrappedStream(void):
+        stream(nullptr),
+        direction(SOAPY_SDR_RX)
+    {
+        return;
+    }
+
+    SoapySDR::Stream *stream;
+    int direction;
+    std::unique_ptr<SoapySDR::StreamFormatAdapter> adapter;
+    std::unique_ptr<SoapySDR::StreamCounters> counters;
+};
+
+static WrappedStream *toWrapped(SoapySDR::Stream *stream)
+{
+    return reinterpret_cast<WrappedStream *>(stream);
+}
+
+/***********************************************************************
+ * The stream layer that Device::make() installs over every driver,
+ * so that drivers get the stream features of the library unchanged.
+ * Calls other than the stream calls are forwarded by DeviceWrapper.
+ **********************************************************************/
+class StreamWrapper : public SoapySDR::DeviceWrapper
+{
+public:
+    StreamWrapper(SoapySDR::Device *device):
+        SoapySDR::DeviceWrapper(device)
+    {
+        return;
+    }
+
+    /*******************************************************************
+     * Stream API
+     ******************************************************************/
+    std::vector<std::string> getStreamFormats(const int direction, const size_t channel) const
+    {
+        auto formats = _device->getStreamFormats(direction, channel);
+        double fullScale(0.0);
+        const auto native = _device->getNativeStreamFormat(direction, channel, fullScale);
+        if (std::find(formats.begin(), formats.end(), native) == formats.end()) return formats;
+
+        //advertise every format that the native format converts to or from
+        for (const auto &format : SoapySDR::StreamFormatAdapter::listFormats(direction, native))
+        {
+            if (std::find(formats.begin(), formats.end(), format) == formats.end()) formats.push_back(format);
+        }
+        return formats;
+    }
+
+    SoapySDR::Stream *setupStream(const int direction, const std::string &format, const std::vector<size_t> &channels, const SoapySDR::Kwargs &args)
+    {
+        SoapySDR::TraceScope trace("setupStream", "stream");
+        std::unique_ptr<WrappedStream> wrapped(new WrappedStream());
+        wrapped->direction = direction;
+        wrapped->counters.reset(new SoapySDR::StreamCounters(direction, args));
+        const size_t channel = channels.empty()?0:channels.front();
+        const auto formats = _device->getStreamFormats(direction, channel);
+        double fullScale(0.0);
+        const auto native = _device->getNativeStreamFormat(direction, channel, fullScale);
+
+        //only convert when the driver reports its formats and the request is not one of them
+        const bool supported = formats.empty() or std::find(formats.begin(), formats.end(), format) != formats.end();
+        const bool nativeSupported = std::find(formats.begin(), formats.end(), native) != formats.end();
+        const auto convertible = SoapySDR::StreamFormatAdapter::listFormats(direction, native);
+        if (supported or not nativeSupported or std::find(convertible.begin(), convertible.end(), format) == convertible.end())
+        {
+            //no conversion, let the driver report an unsupported format
+            wrapped->stream = _device->setupStream(direction, format, channels, args);
+            return reinterpret_cast<SoapySDR::Stream *>(wrapped.release());
+        }
+
+        wrapped->stream = _device->setupStream(direction, native, channels, args);
+        try
+        {
+            wrapped->adapter.reset(new SoapySDR::StreamFormatAdapter(direction, format, native,
+                std::max<size_t>(1, channels.size()), _device->getStreamMTU(wrapped->stream), fullScale, args));
+        }
+        catch (...)
+        {
+            _device->closeStream(wrapped->stream);
+            throw;
+        }
+        return reinterpret_cast<SoapySDR::Stream *>(wrapped.release());
+    }
+
+    void closeStream(SoapySDR::Stream *stream)
+    {
+        SoapySDR::TraceScope trace("closeStream", "stream");
+        std::unique_ptr<WrappedStream> wrapped(toWrapped(stream));
+        _device->closeStream(wrapped->stream);
+    }
+
+    size_t getStreamMTU(SoapySDR::Stream *stream) const
+    {
+        return _device->getStreamMTU(toWrapped(stream)->stream);
+    }
+
+    int activateStream(SoapySDR::Stream *stream, const int flags, const long long timeNs, const size_t numElems)
+    {
+        SoapySDR::TraceScope trace("activateStream", "stream");
+        return _device->activateStream(toWrapped(stream)->stream, flags, timeNs, numElems);
+    }
+
+    int deactivateStream(SoapySDR::Stream *stream, const int flags, const long long timeNs)
+    {
+        SoapySDR::TraceScope trace("deactivateStream", "stream");
+        return _device->deactivateStream(toWrapped(stream)->stream, flags, timeNs);
+    }
+
+    int readStream(SoapySDR::Stream *stream, void * const *buffs, const size_t numElems, int &flags, long long &timeNs, const long timeoutUs)
+    {
+        SoapySDR::TraceScope trace("readStream", "stream");
+        auto *wrapped = toWrapped(stream);
+        const auto start = SoapySDR::StreamCounters::Clock::now();
+        const int ret = (not wrapped->adapter)?
+            _device->readStream(wrapped->stream, buffs, numElems, flags, timeNs, timeoutUs):
+            wrapped->adapter->readStream(
+                [this, wrapped](void * const *buffs, const size_t numElems, int &flags, long long &timeNs, const long timeoutUs)
+                {return _device->readStream(wrapped->stream, buffs, numElems, flags, timeNs, timeoutUs);},
+                buffs, numElems, flags, timeNs, timeoutUs);
+        this->countCall(wrapped, start, ret, flags, timeNs);
+        return ret;
+    }
+
+    int writeStream(SoapySDR::Stream *stream, const void * const *buffs, const size_t numElems, int &flags, const long long timeNs, const long timeoutUs)
+    {
+        SoapySDR::TraceScope trace("writeStream", "stream");
+        auto *wrapped = toWrapped(stream);
+        const auto start = SoapySDR::StreamCounters::Clock::now();
+        const int ret = (not wrapped->adapter)?
+            _device->writeStream(wrapped->stream, buffs, numElems, flags, timeNs, timeoutUs):
+            wrapped->adapter->writeStream(
+                [this, wrapped](const void * const *buffs, const size_t numElems, int &flags, const long long timeNs, const long timeoutUs)
+                {return _device->writeStream(wrapped->stream, buffs, numElems, flags, timeNs, timeoutUs);},
+                buffs, numElems, flags, timeNs, timeoutUs);
+        this->countCall(wrapped, start, ret, flags, timeNs);
+        return ret;
+    }
+
+    int readStreamBatch(SoapySDR::Stream *stream, void * const * const *buffs, const size_t numBuffs, const size_t numElems, size_t *elems, int *flags, long long *timeNs, const long timeoutUs)
+    {
+        SoapySDR::TraceScope trace("readStreamBatch", "stream");
+        //converted streams loop over readStream() in the base class, which counts every read
+        auto *wrapped = toWrapped(stream);
+        if (wrapped->adapter) return SoapySDR::Device::readStreamBatch(stream, buffs, numBuffs, numElems, elems, flags, timeNs, timeoutUs);
+        const auto start = SoapySDR::StreamCounters::Clock::now();
+        const int ret = _device->readStreamBatch(wrapped->stream, buffs, numBuffs, numElems, elems, flags, timeNs, timeoutUs);
+        this->countBatch(wrapped, start, ret, elems, flags, timeNs);
+        return ret;
+    }
+
+    int writeStreamBatch(SoapySDR::Stream *stream, const void * const * const *buffs, const size_t numBuffs, const size_t *numElems, size_t *elems, int *flags, const long long *timeNs, const long timeoutUs)
+    {
+        SoapySDR::TraceScope trace("writeStreamBatch", "stream");
+        auto *wrapped = toWrapped(stream);
+        if (wrapped->adapter) return SoapySDR::Device::writeStreamBatch(stream, buffs, numBuffs, numElems, elems, flags, timeNs, timeoutUs);
+        const auto start = SoapySDR::StreamCounters::Clock::now();
+        const int ret = _device->writeStreamBatch(wrapped->stream, buffs, numBuffs, numElems, elems, flags, timeNs, timeoutUs);
+        this->countBatch(wrapped, start, ret, elems, flags, timeNs);
+        return ret;
+    }
+
+    int readStreamStatus(SoapySDR::Stream *stream, size_t &chanMask, int &flags, long long &timeNs, const long timeoutUs)
+    {
+        auto *wrapped = toWrapped(stream);
+        const int ret = _device->readStreamStatus(wrapped->stream, chanMask, flags, timeNs, timeoutUs);
+        wrapped->counters->countError(ret);
+        return ret;
+    }
+
+    int getStreamStats(SoapySDR::Stream *stream, SoapySDR::StreamStats &stats)
+    {
+        //the driver may report its buffer fill
+        auto *wrapped = toWrapped(stream);
+        SoapySDR::StreamStats driverStats;
+        if (_device->getStreamStats(wrapped->stream, driverStats) == 0) stats = driverStats;
+        wrapped->counters->load(stats);
+        return 0;
+    }
+
+    int getStreamPollHandle(SoapySDR::Stream *stream, intptr_t &handle)
+    {
+        return _device->getStreamPollHandle(toWrapped(stream)->stream, handle);
+    }
+
+    /*******************************************************************
+     * Direct buffer access API: buffers of converted streams hold the native format
+     ******************************************************************/
+    SoapySDR::StreamSubscription *subscribeStream(SoapySDR::Stream *stream, const size_t numChans, const SoapySDR::StreamSubscription::Callback &callback)
+    {
+        //the dispatcher of this device reads through the wrapper, so converted streams are delivered converted
+        if (toWrapped(stream)->direction != SOAPY_SDR_RX) throw std::invalid_argument("subscribeStream() requires a receive stream");
+        return SoapySDR::Device::subscribeStream(stream, numChans, callback);
+    }
+
+    void unsubscribeStream(SoapySDR::StreamSubscription *subscription)
+    {
+        SoapySDR::Device::unsubscribeStream(subscription);
+    }
+
+    size_t getNumDirectAccessBuffers(SoapySDR::Stream *stream)
+    {
+        auto *wrapped = toWrapped(stream);
+        if (wrapped->adapter) return 0;
+        return _device->getNumDirectAccessBuffers(wrapped->stream);
+    }
+
+    int getDirectAccessBufferAddrs(SoapySDR::Stream *stream, const size_t handle, void **buffs)
+    {
+        auto *wrapped = toWrapped(stream);
+        if (wrapped->adapter) return SOAPY_SDR_NOT_SUPPORTED;
+        return _device->getDirectAccessBufferAddrs(wrapped->stream, handle, buffs);
+    }
+
+    int acquireReadBuffer(SoapySDR::Stream *stream, size_t &handle, const void **buffs, int &flags, long long &timeNs, const long timeoutUs)
+    {
+        auto *wrapped = toWrapped(stream);
+        if (wrapped->adapter) return SOAPY_SDR_NOT_SUPPORTED;
+        const auto start = SoapySDR::StreamCounters::Clock::now();
+        const int ret = _device->acquireReadBuffer(wrapped->stream, handle, buffs, flags, timeNs, timeoutUs);
+        this->countCall(wrapped, start, ret, flags, timeNs);
+        return ret;
+    }
+
+    void releaseReadBuffer(SoapySDR::Stream *stream, const size_t handle)
+    {
+        _device->releaseReadBuffer(toWrapped(stream)->stream, handle);
+    }
+
+    int acquireWriteBuffer(SoapySDR::Stream *stream, size_t &handle, void **buffs, const long timeoutUs)
+    {
+        auto *wrapped = toWrapped(stream);
+        if (wrapped->adapter) return SOAPY_SDR_NOT_SUPPORTED;
+        return _device->acquireWriteBuffer(wrapped->stream, handle, buffs, timeoutUs);
+    }
+
+    void releaseWriteBuffer(SoapySDR::Stream *stream, const size_t handle, const size_t numElems, int &flags, const long long timeNs)
+    {
+        //a write buffer is counted when it is released with its elements
+        auto *wrapped = toWrapped(stream);
+        const auto start = SoapySDR::StreamCounters::Clock::now();
+        _device->releaseWriteBuffer(wrapped->stream, handle, numElems, flags, timeNs);
+        this->countCall(wrapped, start, int(numElems), flags, timeNs);
+    }
+
+private:
+    void countCall(WrappedStream *wrapped, const SoapySDR::StreamCounters::Clock::time_point &start, const int ret, const int flags, const long long timeNs)
+    {
+        wrapped->counters->countCall(start, ret, size_t(ret));
+        if (ret > 0 and wrapped->counters->measuresTime()) wrapped->counters->countTime(flags, timeNs, _device->getHardwareTime());
+    }
+
+    //one call for the batch, the timestamp of every transferred buffer
+    void countBatch(WrappedStream *wrapped, const SoapySDR::StreamCounters::Clock::time_point &start, const int ret, const size_t *elems, const int *flags, const long long *timeNs)
+    {
+        size_t total(0);
+        for (int i = 0; elems != nullptr and i < ret; i++) total += elems[i];
+        wrapped->counters->countCall(start, ret, total);
+        if (ret <= 0 or flags == nullptr or timeNs == nullptr or not wrapped->counters->measuresTime()) return;
+        const long long hardwareNs = _device->getHardwareTime();
+        for (int i = 0; i < ret; i++) wrapped->counters->countTime(flags[i], timeNs[i], hardwareNs);
+    }
+};
+
+/***********************************************************************
+ * Called by Device::make() to wrap every new device
+ **********************************************************************/
+SoapySDR::Device *makeStreamWrapper(SoapySDR::Device *device)
+{
+    return new StreamWrapper(device);
+}
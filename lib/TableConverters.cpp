@@ -0,0 +1,109 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/ConverterPrimatives.hpp>
+#include <SoapySDR/ConverterRegistry.hpp>
+#include <SoapySDR/Formats.hpp>
+#include <cstdint>
+#include <vector>
+#include <mutex>
+#include <map>
+
+/***********************************************************************
+ * Lookup table converters for 8-bit integer sources.
+ *
+ * An 8-bit sample has only 256 possible values, so the scaled float
+ * result for every value is computed once per scaler and each sample
+ * becomes a single table load. Tables are cached by scaler value:
+ * each thread remembers its last table, and other scalers are found
+ * in a shared cache. The cache is bounded; an uncached scaler is
+ * converted with the same arithmetic as the generic converters.
+ **********************************************************************/
+static const size_t MAX_CACHED_TABLES = 16;
+
+template <typename InType>
+static float tableEntry(const InType from, const double scaler);
+
+template <>
+float tableEntry<int8_t>(const int8_t from, const double scaler)
+{
+    return SoapySDR::S8toF32(from, SoapySDR::S8toF32Gain(scaler));
+}
+
+template <>
+float tableEntry<uint8_t>(const uint8_t from, const double scaler)
+{
+    return SoapySDR::U8toF32(from, SoapySDR::S8toF32Gain(scaler));
+}
+
+template <typename InType>
+static const float *getCachedTable(const double scaler)
+{
+    static std::mutex mutex;
+    static std::map<double, std::vector<float>> tables;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto it = tables.find(scaler);
+    if (it != tables.end()) return it->second.data();
+    if (tables.size() >= MAX_CACHED_TABLES or scaler != scaler) return nullptr;
+
+    //tables are never erased, so the storage stays valid for every thread
+    auto &table = tables[scaler];
+    table.resize(256);
+    for (size_t i = 0; i < table.size(); i++) table[i] = tableEntry<InType>(InType(i), scaler);
+    return table.data();
+}
+
+template <typename InType>
+static const float *getTable(const double scaler)
+{
+    static thread_local double lastScaler;
+    static thread_local const float *lastTable;
+    if (lastTable != nullptr and lastScaler == scaler) return lastTable;
+
+    const float *table = getCachedTable<InType>(scaler);
+    if (table == nullptr) return nullptr;
+    lastScaler = scaler;
+    lastTable = table;
+    return table;
+}
+
+template <typename InType, size_t elemDepth>
+static void tableConvert(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+{
+    auto *src = (const InType *)srcBuff;
+    auto *dst = (float *)dstBuff;
+    const size_t n = numElems*elemDepth;
+
+    const float *table = getTable<InType>(scaler);
+    if (table == nullptr)
+    {
+        for (size_t i = 0; i < n; i++) dst[i] = tableEntry<InType>(src[i], scaler);
+        return;
+    }
+    for (size_t i = 0; i < n; i++) dst[i] = table[uint8_t(src[i])];
+}
+
+/***********************************************************************
+ * Complex kernels are used by the vectorized converter selection
+ * when the host has no SIMD implementation for the complex path.
+ **********************************************************************/
+void tableCS8toCF32(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+{
+    tableConvert<int8_t, 2>(srcBuff, dstBuff, numElems, scaler);
+}
+
+void tableCU8toCF32(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+{
+    tableConvert<uint8_t, 2>(srcBuff, dstBuff, numElems, scaler);
+}
+
+/*!
+ * lateLoadTableConverters() is called by lateLoadDefaultConverters()
+ * to register the table kernels for the real 8-bit sources.
+ */
+void lateLoadTableConverters(void)
+{
+    static SoapySDR::ConverterRegistry registerTableS8toF32(SOAPY_SDR_S8, SOAPY_SDR_F32, SoapySDR::ConverterRegistry::VECTORIZED, &tableConvert<int8_t, 1>);
+    static SoapySDR::ConverterRegistry registerTableU8toF32(SOAPY_SDR_U8, SOAPY_SDR_F32, SoapySDR::ConverterRegistry::VECTORIZED, &tableConvert<uint8_t, 1>);
+}
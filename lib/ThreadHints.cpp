@@ -0,0 +1,198 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/ThreadHints.hpp>
+#include <SoapySDR/Logger.hpp>
+#include <stdexcept>
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+#include <cerrno>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+/***********************************************************************
+ * Parse a CPU list such as "0-3 8", any of ", :;" separate the entries
+ **********************************************************************/
+static std::vector<size_t> parseCpuList(const std::string &list)
+{
+    std::vector<size_t> cpus;
+    size_t pos = 0;
+    while (pos < list.size())
+    {
+        const size_t end = std::min(list.find_first_of(", :;", pos), list.size());
+        const std::string entry = list.substr(pos, end-pos);
+        pos = end+1;
+        if (entry.empty()) continue;
+
+        const size_t dash = entry.find('-');
+        try
+        {
+            const size_t first = std::stoul(entry.substr(0, dash));
+            const size_t last = (dash == std::string::npos)?first:std::stoul(entry.substr(dash+1));
+            if (last < first) throw std::invalid_argument(entry);
+            for (size_t cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+        }
+        catch (const std::exception &)
+        {
+            throw std::invalid_argument("ThreadHints: malformed " SOAPY_SDR_THREAD_CPU_AFFINITY " entry \"" + entry + "\"");
+        }
+    }
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    return cpus;
+}
+
+static int parseInt(const SoapySDR::Kwargs &args, const char *key, const int defaultValue)
+{
+    const auto it = args.find(key);
+    if (it == args.end() or it->second.empty()) return defaultValue;
+    try
+    {
+        return std::stoi(it->second);
+    }
+    catch (const std::exception &)
+    {
+        throw std::invalid_argument(std::string("ThreadHints: malformed ") + key + " \"" + it->second + "\"");
+    }
+}
+
+/***********************************************************************
+ * Parsing and arg info
+ **********************************************************************/
+SoapySDR::ThreadHints::ThreadHints(void):
+    priority(0),
+    numaNode(-1)
+{
+    return;
+}
+
+SoapySDR::ThreadHints::ThreadHints(const Kwargs &args):
+    priority(parseInt(args, SOAPY_SDR_THREAD_RT_PRIORITY, 0)),
+    numaNode(parseInt(args, SOAPY_SDR_THREAD_NUMA_NODE, -1))
+{
+    const auto it = args.find(SOAPY_SDR_THREAD_CPU_AFFINITY);
+    if (it != args.end()) cpus = parseCpuList(it->second);
+    if (priority < 0 or priority > 99) throw std::invalid_argument("ThreadHints: " SOAPY_SDR_THREAD_RT_PRIORITY " not in 0 to 99");
+    if (numaNode < -1) throw std::invalid_argument("ThreadHints: " SOAPY_SDR_THREAD_NUMA_NODE " must be -1 or a node number");
+}
+
+SoapySDR::ArgInfoList SoapySDR::ThreadHints::argsInfo(void)
+{
+    ArgInfoList infos;
+
+    ArgInfo affinity;
+    affinity.key = SOAPY_SDR_THREAD_CPU_AFFINITY;
+    affinity.name = "CPU affinity";
+    affinity.description = "CPUs for the stream threads such as \"0-3 8\", empty for any CPU";
+    affinity.type = ArgInfo::STRING;
+    infos.push_back(affinity);
+
+    ArgInfo priority;
+    priority.key = SOAPY_SDR_THREAD_RT_PRIORITY;
+    priority.value = "0";
+    priority.name = "Real-time priority";
+    priority.description = "SCHED_FIFO priority of the stream threads, 0 for the default scheduling";
+    priority.type = ArgInfo::INT;
+    priority.range = Range(0, 99, 1);
+    infos.push_back(priority);
+
+    ArgInfo node;
+    node.key = SOAPY_SDR_THREAD_NUMA_NODE;
+    node.value = "-1";
+    node.name = "NUMA node";
+    node.description = "NUMA node for the stream threads and buffers, -1 for no preference";
+    node.type = ArgInfo::INT;
+    infos.push_back(node);
+
+    return infos;
+}
+
+bool SoapySDR::ThreadHints::empty(void) const
+{
+    return cpus.empty() and priority == 0 and numaNode < 0;
+}
+
+std::vector<size_t> SoapySDR::ThreadHints::effectiveCpus(void) const
+{
+    if (not cpus.empty() or numaNode < 0) return cpus;
+
+    //the kernel lists the CPUs of each node in the cpulist format
+    std::ifstream cpulist("/sys/devices/system/node/node" + std::to_string(numaNode) + "/cpulist");
+    std::string list;
+    std::getline(cpulist, list);
+    return parseCpuList(list);
+}
+
+/***********************************************************************
+ * Placement
+ **********************************************************************/
+bool SoapySDR::ThreadHints::applyToThisThread(void) const
+{
+    if (this->empty()) return true;
+    bool ok = true;
+
+    #ifdef __linux__
+    const auto threadCpus = this->effectiveCpus();
+    if (not threadCpus.empty())
+    {
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        for (const auto cpu : threadCpus) if (cpu < CPU_SETSIZE) CPU_SET(cpu, &cpuset);
+        const int ret = pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+        if (ret != 0)
+        {
+            SoapySDR::logf(SOAPY_SDR_WARNING, "ThreadHints: failed to set the CPU affinity: %s", std::strerror(ret));
+            ok = false;
+        }
+    }
+
+    if (priority > 0)
+    {
+        sched_param param;
+        std::memset(&param, 0, sizeof(param));
+        param.sched_priority = priority;
+        const int ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (ret != 0)
+        {
+            SoapySDR::logf(SOAPY_SDR_WARNING, "ThreadHints: failed to set SCHED_FIFO priority %d: %s", priority, std::strerror(ret));
+            ok = false;
+        }
+    }
+    #else
+    SoapySDR::log(SOAPY_SDR_WARNING, "ThreadHints: thread placement is not supported on this platform");
+    ok = false;
+    #endif
+
+    return ok;
+}
+
+bool SoapySDR::ThreadHints::bindMemory(void *buff, const size_t length) const
+{
+    if (numaNode < 0 or length == 0) return true;
+
+    #if defined(__linux__) && defined(SYS_mbind)
+    //bind the whole pages that cover the buffer, without a libnuma dependency
+    static const int mpolBind(2), mpolMfMove(1 << 1);
+    const size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+    const size_t begin = size_t(buff) & ~(pageSize-1);
+    const size_t end = size_t(buff) + length;
+
+    const size_t bitsPerWord = sizeof(unsigned long)*8;
+    std::vector<unsigned long> nodemask(size_t(numaNode)/bitsPerWord + 1, 0);
+    nodemask[size_t(numaNode)/bitsPerWord] |= 1ul << (size_t(numaNode)%bitsPerWord);
+
+    const long ret = syscall(SYS_mbind, begin, end-begin, mpolBind, nodemask.data(), nodemask.size()*bitsPerWord, mpolMfMove);
+    if (ret == 0) return true;
+    SoapySDR::logf(SOAPY_SDR_WARNING, "ThreadHints: failed to bind memory to NUMA node %d: %s", numaNode, std::strerror(errno));
+    #else
+    (void)buff;
+    SoapySDR::log(SOAPY_SDR_WARNING, "ThreadHints: NUMA memory binding is not supported on this platform");
+    #endif
+
+    return false;
+}
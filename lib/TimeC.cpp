@@ -1,38 +1,28 @@
-// Copyright (c) 2015-2015 Josh Blum
+// Copyright (c) 2015-2018 Josh Blum
 // SPDX-License-Identifier: BSL-1.0
 
-#include <SoapySDR/Time.h>
-#include <cmath>
+#include <SoapySDR/Time.hpp>
 
 extern "C" {
 
-#if defined(_MSC_VER) && (_MSC_VER < 1800)
-
-static inline long long int llround(const double x)
+long long SoapySDR_ticksToTimeNs(const long long ticks, const double rate)
 {
-    return (long long int)((x < (0.0)) ? (x - (0.5)) : (x + (0.5)));
+    return SoapySDR::TickConverter(rate).ticksToTimeNs(ticks);
 }
 
-#endif
+long long SoapySDR_timeNsToTicks(const long long timeNs, const double rate)
+{
+    return SoapySDR::TickConverter(rate).timeNsToTicks(timeNs);
+}
 
-long long SoapySDR_ticksToTimeNs(const long long ticks, const double rate)
+void SoapySDR_ticksToTimeNsArray(const long long *ticks, long long *timeNs, const size_t length, const double rate)
 {
-    const long long ratell = (long long)(rate);
-    const long long full = (long long)(ticks/ratell);
-    const long long err = ticks - (full*ratell);
-    const double part = full*(rate - ratell);
-    const double frac = ((err - part)*1000000000)/rate;
-    return (full*1000000000) + llround(frac);
+    SoapySDR::TickConverter(rate).ticksToTimeNs(ticks, timeNs, length);
 }
 
-long long SoapySDR_timeNsToTicks(const long long timeNs, const double rate)
+void SoapySDR_timeNsToTicksArray(const long long *timeNs, long long *ticks, const size_t length, const double rate)
 {
-    const long long ratell = (long long)(rate);
-    const long long full = (long long)(timeNs/1000000000);
-    const long long err = timeNs - (full*1000000000);
-    const double part = full*(rate - ratell);
-    const double frac = part + ((err*rate)/1000000000);
-    return (full*ratell) + llround(frac);
+    SoapySDR::TickConverter(rate).timeNsToTicks(timeNs, ticks, length);
 }
 
 }
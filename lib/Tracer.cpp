@@ -0,0 +1,145 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include "MPSCRing.hpp"
+#include <SoapySDR/Tracer.hpp>
+#include <stdexcept>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+
+/***********************************************************************
+ * Tracer registration
+ **********************************************************************/
+static std::atomic<SoapySDR::Tracer *> registeredTracer(nullptr);
+
+SoapySDR::Tracer::~Tracer(void)
+{
+    return;
+}
+
+void SoapySDR::registerTracer(Tracer *tracer)
+{
+    registeredTracer.store(tracer, std::memory_order_release);
+}
+
+SoapySDR::Tracer *SoapySDR::getTracer(void)
+{
+    return registeredTracer.load(std::memory_order_acquire);
+}
+
+/***********************************************************************
+ * Chrome trace event writer
+ **********************************************************************/
+struct TraceEvent
+{
+    const char *name;
+    const char *category;
+    char phase;
+    unsigned tid;
+    long long timeNs;
+};
+
+//small sequential thread numbers read better in the viewer than native ids
+static unsigned getTraceThreadId(void)
+{
+    static std::atomic<unsigned> nextId(1);
+    static thread_local unsigned id = 0;
+    if (id == 0) id = nextId.fetch_add(1);
+    return id;
+}
+
+struct SoapySDR::ChromeTracer::Impl
+{
+    Impl(const std::string &path, const size_t capacity):
+        ring(capacity),
+        dropped(0),
+        done(false),
+        first(true),
+        startTime(std::chrono::steady_clock::now()),
+        fp(std::fopen(path.c_str(), "w"))
+    {
+        if (fp == nullptr) throw std::runtime_error("ChromeTracer("+path+") failed to open");
+        std::fputs("[\n", fp);
+        thread = std::thread(&Impl::work, this);
+    }
+
+    ~Impl(void)
+    {
+        done = true;
+        thread.join();
+        this->drain();
+        std::fputs("\n]\n", fp);
+        std::fclose(fp);
+    }
+
+    void record(const char *name, const char *category, const char phase)
+    {
+        const long long timeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now()-startTime).count();
+        const unsigned tid = getTraceThreadId();
+        const bool ok = ring.push([=](TraceEvent &event){
+            event.name = name;
+            event.category = category;
+            event.phase = phase;
+            event.tid = tid;
+            event.timeNs = timeNs;
+        });
+        if (not ok) dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void drain(void)
+    {
+        TraceEvent event;
+        while (ring.pop(event))
+        {
+            std::fprintf(fp, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}",
+                first?"":",\n", event.name, event.category, event.phase, event.timeNs/1e3, event.tid);
+            first = false;
+        }
+    }
+
+    void work(void)
+    {
+        while (not done)
+        {
+            this->drain();
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    MPSCRing<TraceEvent> ring;
+    std::atomic<size_t> dropped;
+    std::atomic<bool> done;
+    bool first;
+    const std::chrono::steady_clock::time_point startTime;
+    std::FILE *fp;
+    std::thread thread;
+};
+
+SoapySDR::ChromeTracer::ChromeTracer(const std::string &path, const size_t capacity):
+    _impl(new Impl(path, capacity))
+{
+    return;
+}
+
+SoapySDR::ChromeTracer::~ChromeTracer(void)
+{
+    delete _impl;
+}
+
+void SoapySDR::ChromeTracer::begin(const char *name, const char *category)
+{
+    _impl->record(name, category, 'B');
+}
+
+void SoapySDR::ChromeTracer::end(const char *name, const char *category)
+{
+    _impl->record(name, category, 'E');
+}
+
+size_t SoapySDR::ChromeTracer::getNumDropped(void) const
+{
+    return _impl->dropped.load(std::memory_order_relaxed);
+}
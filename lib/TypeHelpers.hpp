@@ -55,7 +55,8 @@ static inline SoapySDR::Kwargs toKwargs(const SoapySDRKwargs *args)
     if (args == NULL) return out;
     for (size_t i = 0; i < args->size; i++)
     {
-        out[args->keys[i]] = args->vals[i];
+        //keys that arrive sorted insert at the end without a search
+        out.emplace_hint(out.end(), args->keys[i], std::string())->second = args->vals[i];
     }
     return out;
 }
@@ -64,9 +65,23 @@ static inline SoapySDRKwargs toKwargs(const SoapySDR::Kwargs &args)
 {
     SoapySDRKwargs out;
     std::memset(&out, 0, sizeof(out));
+    if (args.empty()) return out;
+
+    //the map keys are unique, so allocate once rather than search and grow per key
+    out.keys = (char **)calloc(args.size(), sizeof(char *));
+    out.vals = (char **)calloc(args.size(), sizeof(char *));
+    if (out.keys == nullptr or out.vals == nullptr)
+    {
+        free(out.keys);
+        free(out.vals);
+        std::memset(&out, 0, sizeof(out));
+        return out;
+    }
     for (const auto &it : args)
     {
-        SoapySDRKwargs_set(&out, it.first.c_str(), it.second.c_str());
+        out.keys[out.size] = strdup(it.first.c_str());
+        out.vals[out.size] = strdup(it.second.c_str());
+        out.size++;
     }
     return out;
 }
@@ -83,6 +98,7 @@ static inline SoapySDRArgInfo toArgInfo(const SoapySDR::ArgInfo &info)
 {
     SoapySDRArgInfo out;
     out.key = strdup(info.key.c_str());
+    out.value = strdup(info.value.c_str());
     out.name = strdup(info.name.c_str());
     out.description = strdup(info.description.c_str());
     out.units = strdup(info.units.c_str());
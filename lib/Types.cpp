@@ -2,46 +2,15 @@
 // SPDX-License-Identifier: BSL-1.0
 
 #include <SoapySDR/Types.hpp>
-#include <cctype>
-
-static std::string trim(const std::string &s)
-{
-    std::string out = s;
-    while (not out.empty() and std::isspace(out[0])) out = out.substr(1);
-    while (not out.empty() and std::isspace(out[out.size()-1])) out = out.substr(0, out.size()-1);
-    return out;
-}
+#include "KwargsMarkup.hpp"
 
 SoapySDR::Kwargs SoapySDR::KwargsFromString(const std::string &markup)
 {
     SoapySDR::Kwargs kwargs;
-
-    bool inKey = true;
-    std::string key, val;
-    for (size_t i = 0; i < markup.size(); i++)
+    parseKwargsMarkup(markup, [&kwargs](const char *key, const size_t keyLen, const char *val, const size_t valLen)
     {
-        const char ch = markup[i];
-        if (inKey)
-        {
-            if (ch == '=') inKey = false;
-            else if (ch == ',') inKey = true;
-            else key += ch;
-        }
-        else
-        {
-            if (ch == ',') inKey = true;
-            else val += ch;
-        }
-        if ((inKey and (not val.empty() or (ch == ','))) or ((i+1) == markup.size()))
-        {
-            key = trim(key);
-            val = trim(val);
-            if (not key.empty()) kwargs[key] = val;
-            key = "";
-            val = "";
-        }
-    }
-
+        kwargs[std::string(key, keyLen)].assign(val, valLen);
+    });
     return kwargs;
 }
 
@@ -49,10 +18,16 @@ std::string SoapySDR::KwargsToString(const SoapySDR::Kwargs &args)
 {
     std::string markup;
 
+    size_t length = 0;
+    for (const auto &pair : args) length += pair.first.size() + pair.second.size() + 3;
+    markup.reserve(length);
+
     for (const auto &pair : args)
     {
         if (not markup.empty()) markup += ", ";
-        markup += pair.first + "=" + pair.second;
+        markup += pair.first;
+        markup += '=';
+        markup += pair.second;
     }
 
     return markup;
@@ -73,7 +48,27 @@ SoapySDR::Range::Range(const double minimum, const double maximum, const double
     return;
 }
 
-SoapySDR::ArgInfo::ArgInfo(void)
+SoapySDR::ArgInfo::ArgInfo(void):
+    type(STRING)
+{
+    return;
+}
+
+SoapySDR::StreamStats::StreamStats(void):
+    numCalls(0),
+    numElems(0),
+    numOverflows(0),
+    numUnderflows(0),
+    numTimeErrors(0),
+    numDropped(0),
+    maxLatencyNs(0),
+    avgLatencyNs(0),
+    bufferFill(-1.0),
+    numTimestamps(0),
+    minTimeLatencyNs(0),
+    avgTimeLatencyNs(0),
+    p99TimeLatencyNs(0),
+    maxTimeLatencyNs(0)
 {
     return;
 }
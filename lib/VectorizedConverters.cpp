@@ -0,0 +1,763 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/ConverterPrimatives.hpp>
+#include <SoapySDR/ConverterRegistry.hpp>
+#include <SoapySDR/Formats.hpp>
+#include <cstdint>
+
+/***********************************************************************
+ * Vectorized converters for the complex float <> complex integer paths.
+ *
+ * Each kernel processes a multiple of the vector width with SIMD
+ * intrinsics, and finishes any remaining tail with the same scalar
+ * primitives used by the generic converters. The implementation for
+ * the host is selected once at registration time (runtime dispatch),
+ * so that a single library binary runs on every CPU of the family.
+ *
+ * Float to integer conversions truncate like the scalar primitives,
+ * but saturate out-of-range values rather than wrapping around,
+ * and convert NaN to zero. The vector loop and the scalar tail
+ * clamp before converting, so both give the same result.
+ **********************************************************************/
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SOAPY_SDR_X86_SIMD
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SOAPY_SDR_NEON_SIMD
+#include <arm_neon.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SOAPY_SDR_TARGET(x) __attribute__((target(x)))
+#else
+#define SOAPY_SDR_TARGET(x)
+#endif
+
+/***********************************************************************
+ * Scalar tail helpers
+ **********************************************************************/
+static inline float clampScaled(const float x, const float lo, const float hi)
+{
+    if (x != x) return 0.0f; //NaN
+    return (x < lo)?lo:((x > hi)?hi:x);
+}
+
+static inline void tailS16toF32(const int16_t *src, float *dst, const size_t n, const float gain)
+{
+    for (size_t i = 0; i < n; i++) dst[i] = float(src[i])*gain;
+}
+
+static inline void tailF32toS16(const float *src, int16_t *dst, const size_t n, const float gain)
+{
+    for (size_t i = 0; i < n; i++) dst[i] = int16_t(clampScaled(src[i]*gain, -32768.0f, 32767.0f));
+}
+
+static inline void tailU16toF32(const uint16_t *src, float *dst, const size_t n, const float gain)
+{
+    for (size_t i = 0; i < n; i++) dst[i] = float(SoapySDR::U16toS16(src[i]))*gain;
+}
+
+static inline void tailF32toU16(const float *src, uint16_t *dst, const size_t n, const float gain)
+{
+    for (size_t i = 0; i < n; i++) dst[i] = SoapySDR::S16toU16(int16_t(clampScaled(src[i]*gain, -32768.0f, 32767.0f)));
+}
+
+static inline void tailS8toF32(const int8_t *src, float *dst, const size_t n, const float gain)
+{
+    for (size_t i = 0; i < n; i++) dst[i] = float(src[i])*gain;
+}
+
+static inline void tailF32toS8(const float *src, int8_t *dst, const size_t n, const float gain)
+{
+    for (size_t i = 0; i < n; i++) dst[i] = int8_t(clampScaled(src[i]*gain, -128.0f, 127.0f));
+}
+
+static inline void tailU8toF32(const uint8_t *src, float *dst, const size_t n, const float gain)
+{
+    for (size_t i = 0; i < n; i++) dst[i] = float(SoapySDR::U8toS8(src[i]))*gain;
+}
+
+static inline void tailF32toU8(const float *src, uint8_t *dst, const size_t n, const float gain)
+{
+    for (size_t i = 0; i < n; i++) dst[i] = SoapySDR::S8toU8(int8_t(clampScaled(src[i]*gain, -128.0f, 127.0f)));
+}
+
+#ifdef SOAPY_SDR_X86_SIMD
+
+/***********************************************************************
+ * Runtime CPU feature detection
+ **********************************************************************/
+static bool cpuSupportsSSE2(void)
+{
+    #if defined(__x86_64__) || defined(_M_X64)
+    return true; //baseline for the 64-bit instruction set
+    #elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] & (1 << 26)) != 0;
+    #else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+    #endif
+}
+
+static bool cpuSupportsAVX2(void)
+{
+    #if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (not osxsave or not avx) return false;
+    if ((_xgetbv(0) & 0x6) != 0x6) return false; //OS saves YMM state
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+    #else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+    #endif
+}
+
+/***********************************************************************
+ * SSE2 kernels
+ **********************************************************************/
+
+// cvttps returns INT_MIN for NaN and for values outside the int32 range,
+// so clamp to the int16 range first, the packs saturate the rest
+SOAPY_SDR_TARGET("sse2")
+static inline __m128i sse2ConvertF32toS32(const __m128 x)
+{
+    const __m128 ordered = _mm_and_ps(x, _mm_cmpord_ps(x, x));
+    return _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(ordered, _mm_set1_ps(-32768.0f)), _mm_set1_ps(32767.0f)));
+}
+
+// CF32 <> CS16
+SOAPY_SDR_TARGET("sse2")
+static void sse2CF32toCS16(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+{
+    const size_t n = numElems*2;
+    const size_t nVec = n & ~size_t(7);
+    auto *src = (const float *)srcBuff;
+    auto *dst = (int16_t *)dstBuff;
+    const float gainScalar = float(scaler*SoapySDR::S16_FULL_SCALE);
+    const __m128 gain = _mm_set1_ps(gainScalar);
+
+    for (size_t i = 0; i < nVec; i += 8)
+    {
+        const __m128i a = sse2ConvertF32toS32(_mm_mul_ps(_mm_loadu_ps(src+i+0), gain));
+        const __m128i b = sse2ConvertF32toS32(_mm_mul_ps(_mm_loadu_ps(src+i+4), gain));
+        _mm_storeu_si128((__m128i *)(dst+i), _mm_packs_epi32(a, b));
+    }
+    tailF32toS16(src+nVec, dst+nVec, n-nVec, gainScalar);
+}
+
+SOAPY_SDR_TARGET("sse2")
+static void sse2CS16toCF32(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+{
+    const size_t n = numElems*2;
+    const size_t nVec = n & ~size_t(7);
+    auto *src = (const int16_t *)srcBuff;
+    auto *dst = (float *)dstBuff;
+    const float gainScalar = float(scaler/SoapySDR::S16_FULL_SCALE);
+    const __m128 gain = _mm_set1_ps(gainScalar);
+
+    for (size_t i = 0; i < nVec; i += 8)
+    {
+        const __m128i x = _mm_loadu_si128((const __m128i *)(src+i));
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+        _mm_storeu_ps(dst+i+0, _mm_mul_ps(_mm_cvtepi32_ps(lo), gain));
+        _mm_storeu_ps(dst+i+4, _mm_mul_ps(_mm_cvtepi32_ps(hi), gain));
+    }
+    tailS16toF32(src+nVec, dst+nVec, n-nVec, gainScalar);
+}
+
+// CF32 <> CU16
+SOAPY_SDR_TARGET("sse2")
+static void sse2CF32toCU16(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+{
+    const size_t n = numElems*2;
+    const size_t nVec = n & ~size_t(7);
+    auto *src = (const float *)srcBuff;
+    auto *dst = (uint16_t *)dstBuff;
+    const float gainScalar = float(scaler*SoapySDR::S16_FULL_SCALE);
+    const __m128 gain = _mm_set1_ps(gainScalar);
+    const __m128i offset = _mm_set1_epi16(short(SoapySDR::U16_ZERO_OFFSET));
+
+    for (size_t i = 0; i < nVec; i += 8)
+    {
+        const __m128i a = sse2ConvertF32toS32(_mm_mul_ps(_mm_loadu_ps(src+i+0), gain));
+        const __m128i b = sse2ConvertF32toS32(_mm_mul_ps(_mm_loadu_ps(src+i+4), gain));
+        _mm_storeu_si128((__m128i *)(dst+i), _mm_xor_si128(_mm_packs_epi32(a, b), offset));
+    }
+    tailF32toU16(src+nVec, dst+nVec, n-nVec, gainScalar);
+}
+
+SOAPY_SDR_TARGET("sse2")
+static void sse2CU16toCF32(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+{
+    const size_t n = numElems*2;
+    const size_t nVec = n & ~size_t(7);
+    auto *src = (const uint16_t *)srcBuff;
+    auto *dst = (float *)dstBuff;
+    const float gainScalar = float(scaler/SoapySDR::S16_FULL_SCALE);
+    const __m128 gain = _mm_set1_ps(gainScalar);
+    const __m128i offset = _mm_set1_epi16(short(SoapySDR::U16_ZERO_OFFSET));
+
+    for (size_t i = 0; i < nVec; i += 8)
+    {
+        const __m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(src+i)), offset);
+        const __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+        const __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+        _mm_storeu_ps(dst+i+0, _mm_mul_ps(_mm_cvtepi32_ps(lo), gain));
+        _mm_storeu_ps(dst+i+4, _mm_mul_ps(_mm_cvtepi32_ps(hi), gain));
+    }
+    tailU16toF32(src+nVec, dst+nVec, n-nVec, gainScalar);
+}
+
+// CF32 <> CS8
+SOAPY_SDR_TARGET("sse2")
+static inline __m128i sse2PackF32toS8(const float *src, const __m128 gain)
+{
+    const __m128i a = sse2ConvertF32toS32(_mm_mul_ps(_mm_loadu_ps(src+0), gain));
+    const __m128i b = sse2ConvertF32toS32(_mm_mul_ps(_mm_loadu_ps(src+4), gain));
+    const __m128i c = sse2ConvertF32toS32(_mm_mul_ps(_mm_loadu_ps(src+8), gain));
+    const __m128i d = sse2ConvertF32toS32(_mm_mul_ps(_mm_loadu_ps(src+12), gain));
+    return _mm_packs_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+}
+
+SOAPY_SDR_TARGET("sse2")
+static inline void sse2UnpackS8toF32(const __m128i x, float *dst, const __m128 gain)
+{
+    const __m128i lo16 = _mm_srai_epi16(_mm_unpacklo_epi8(x, x), 8);
+    const __m128i hi16 = _mm_srai_epi16(_mm_unpackhi_epi8(x, x), 8);
+    const __m128i a = _mm_srai_epi32(_mm_unpacklo_epi16(lo16, lo16), 16);
+    const __m128i b = _mm_srai_epi32(_mm_unpackhi_epi16(lo16, lo16), 16);
+    const __m128i c = _mm_srai_epi32(_mm_unpacklo_epi16(hi16, hi16), 16);
+    const __m128i d = _mm_srai_epi32(_mm_unpackhi_epi16(hi16, hi16), 16);
+    _mm_storeu_ps(dst+0, _mm_mul_ps(_mm_cvtepi32_ps(a), gain));
+    _mm_storeu_ps(dst+4, _mm_mul_ps(_mm_cvtepi32_ps(b), gain));
+    _mm_storeu_ps(dst+8, _mm_mul_ps(_mm_cvtepi32_ps(c), gain));
+    _mm_storeu_ps(dst+12, _mm_mul_ps(_mm_cvtepi32_ps(d), gain));
+}
+
+SOAPY_SDR_TARGET("sse2")
+static void sse2CF32toCS8(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+{
+    const size_t n = numElems*2;
+    const size_t nVec = n & ~size_t(15);
+    auto *src = (const float *)srcBuff;
+    auto *dst = (int8_t *)dstBuff;
+    const float gainScalar = float(scaler*SoapySDR::S8_FULL_SCALE);
+    const __m128 gain = _mm_set1_ps(gainScalar);
+
+    for (size_t i = 0; i < nVec; i += 16)
+    {
+        _mm_storeu_si128((__m128i *)(dst+i), sse2PackF32toS8(src+i, gain));
+    }
+    tailF32toS8(src+nVec, dst+nVec, n-nVec, gainScalar);
+}
+
+SOAPY_SDR_TARGET("sse2")
+static void sse2CS8toCF32(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+{
+    const size_t n = numElems*2;
+    const size_t nVec = n & ~size_t(15);
+    auto *src = (const int8_t *)srcBuff;
+    auto *dst = (float *)dstBuff;
+    const float gainScalar = float(scaler/SoapySDR::S8_FULL_SCALE);
+    const __m128 gain = _mm_set1_ps(gainScalar);
+
+    for (size_t i = 0; i < nVec; i += 16)
+    {
+        sse2UnpackS8toF32(_mm_loadu_si128((const __m128i *)(src+i)), dst+i, gain);
+    }
+    tailS8toF32(src+nVec, dst+nVec, n-nVec, gainScalar);
+}
+
+// CF32 <> CU8
+SOAPY_SDR_TARGET("sse2")
+static void sse2CF32toCU8(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+{
+    const size_t n = numElems*2;
+    const size_t nVec = n & ~size_t(15);
+    auto *src = (const float *)srcBuff;
+    auto *dst = (uint8_t *)dstBuff;
+    const float gainScalar = float(scaler*SoapySDR::S8_FULL_SCALE);
+    const __m128 gain = _mm_set1_ps(gainScalar);
+    const __m128i offset = _mm_set1_epi8(char(SoapySDR::U8_ZERO_OFFSET));
+
+    for (size_t i = 0; i < nVec; i += 16)
+    {
+        _mm_storeu_si128((__m128i *)(dst+i), _mm_xor_si128(sse2PackF32toS8(src+i, gain), offset));
+    }
+    tailF32toU8(src+nVec, dst+nVec, n-nVec, gainScalar);
+}
+
+SOAPY_SDR_TARGET("sse2")
+static void sse2CU8toCF32(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+{
+    const size_t n = numElems*2;
+    const size_t nVec = n & ~size_t(15);
+    auto *src = (const uint8_t *)srcBuff;
+    auto *dst = (float *)dstBuff;
+    const float gainScalar = float(scaler/SoapySDR::S8_FULL_SCALE);
+    const __m128 gain = _mm_set1_ps(gainScalar);
+    const __m128i offset = _mm_set1_epi8(char(SoapySDR::U8_ZERO_OFFSET));
+
+    for (size_t i = 0; i < nVec; i += 16)
+    {
+        sse2UnpackS8toF32(_mm_xor_si128(_mm_loadu_si128((const __m128i *)(src+i)), offset), dst+i, gain);
+    }
+    tailU8toF32(src+nVec, dst+nVec, n-nVec, gainScalar);
+}
+
+/***********************************************************************
+ * AVX2 kernels
+ **********************************************************************/
+
+// clamp to the int16 range before the conversion, as for SSE2
+SOAPY_SDR_TARGET("avx2")
+static inline __m256i avx2ConvertF32toS32(const __m256 x)
+{
+    const __m256 ordered = _mm256_and_ps(x, _mm256_cmp_ps(x, x, _CMP_ORD_Q));
+    return _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(ordered, _mm256_set1_ps(-32768.0f)), _mm256_set1_ps(32767.0f)));
+}
+
+// pack 16 floats into 16 saturated int16 in the original order
+SOAPY_SDR_TARGET("avx2")
+static inline __m256i avx2PackF32toS16(const float *src, const __m256 gain)
+{
+    const __m256i a = avx2ConvertF32toS32(_mm256_mul_ps(_mm256_loadu_ps(src+0), gain));
+    const __m256i b = avx2ConvertF32toS32(_mm256_mul_ps(_mm256_loadu_ps(src+8), gain));
+    //packs works per 128-bit lane, restore the order of the 64-bit quads
+    return _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xd8);
+}
+
+// convert 8 int32 into scaled floats
+SOAPY_SDR_TARGET("avx2")
+static inline void avx2StoreS32toF32(const __m256i x, float *dst, const __m256 gain)
+{
+    _mm256_storeu_ps(dst, _mm256_mul_ps(_mm256_cvtepi32_ps(x), gain));
+}
+
+// CF32 <> CS16
+SOAPY_SDR_TARGET("avx2")
+static void avx2CF32toCS16(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+{
+    const size_t n = numElems*2;
+    const size_t nVec = n & ~size_t(15);
+    auto *src = (const float *)srcBuff;
+    auto *dst = (int16_t *)dstBuff;
+    const float gainScalar = float(scaler*SoapySDR::S16_FULL_SCALE);
+    const __m256 gain = _mm256_set1_ps(gainScalar);
+
+    for (size_t i = 0; i < nVec; i += 16)
+    {
+        _mm256_storeu_si256((__m256i *)(dst+i), avx2PackF32toS16(src+i, gain));
+    }
+    tailF32toS16(src+nVec, dst+nVec, n-nVec, gainScalar);
+}
+
+SOAPY_SDR_TARGET("avx2")
+static void avx2CS16toCF32(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+{
+    const size_t n = numElems*2;
+    const size_t nVec = n & ~size_t(15);
+    auto *src = (const int16_t *)srcBuff;
+    auto *dst = (float *)dstBuff;
+    const float gainScalar = float(scaler/SoapySDR::S16_FULL_SCALE);
+    const __m256 gain = _mm256_set1_ps(gainScalar);
+
+    for (size_t i = 0; i < nVec; i += 16)
+    {
+        const __m128i lo = _mm_loadu_si128((const __m128i *)(src+i+0));
+        const __m128i hi = _mm_loadu_si128((const __m128i *)(src+i+8));
+        avx2StoreS32toF32(_mm256_cvtepi16_epi32(lo), dst+i+0, gain);
+        avx2StoreS32toF32(_mm256_cvtepi16_epi32(hi), dst+i+8, gain);
+    }
+    tailS16toF32(src+nVec, dst+nVec, n-nVec, gainScalar);
+}
+
+// CF32 <> CU16
+SOAPY_SDR_TARGET("avx2")
+static void avx2CF32toCU16(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+{
+    const size_t n = numElems*2;
+    const size_t nVec = n & ~size_t(15);
+    auto *src = (const float *)srcBuff;
+    auto *dst = (uint16_t *)dstBuff;
+    const float gainScalar = float(scaler*SoapySDR::S16_FULL_SCALE);
+    const __m256 gain = _mm256_set1_ps(gainScalar);
+    const __m256i offset = _mm256_set1_epi16(short(SoapySDR::U16_ZERO_OFFSET));
+
+    for (size_t i = 0; i < nVec; i += 16)
+    {
+        _mm256_storeu_si256((__m256i *)(dst+i), _mm256_xor_si256(avx2PackF32toS16(src+i, gain), offset));
+    }
+    tailF32toU16(src+nVec, dst+nVec, n-nVec, gainScalar);
+}
+
+SOAPY_SDR_TARGET("avx2")
+static void avx2CU16toCF32(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+{
+    const size_t n = numElems*2;
+    const size_t nVec = n & ~size_t(15);
+    auto *src = (const uint16_t *)srcBuff;
+    auto *dst = (float *)dstBuff;
+    const float gainScalar = float(scaler/SoapySDR::S16_FULL_SCALE);
+    const __m256 gain = _mm256_set1_ps(gainScalar);
+    const __m128i offset = _mm_set1_epi16(short(SoapySDR::U16_ZERO_OFFSET));
+
+    for (size_t i = 0; i < nVec; i += 16)
+    {
+        const __m128i lo = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(src+i+0)), offset);
+        const __m128i hi = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(src+i+8)), offset);
+        avx2StoreS32toF32(_mm256_cvtepi16_epi32(lo), dst+i+0, gain);
+        avx2StoreS32toF32(_mm256_cvtepi16_epi32(hi), dst+i+8, gain);
+    }
+    tailU16toF32(src+nVec, dst+nVec, n-nVec, gainScalar);
+}
+
+// CF32 <> CS8
+SOAPY_SDR_TARGET("avx2")
+static inline __m256i avx2PackF32toS8(const float *src, const __m256 gain)
+{
+    const __m256i ab = avx2PackF32toS16(src+0, gain);
+    const __m256i cd = avx2PackF32toS16(src+16, gain);
+    return _mm256_permute4x64_epi64(_mm256_packs_epi16(ab, cd), 0xd8);
+}
+
+SOAPY_SDR_TARGET("avx2")
+static inline void avx2UnpackS8toF32(const __m128i lo, const __m128i hi, float *dst, const __m256 gain)
+{
+    avx2StoreS32toF32(_mm256_cvtepi8_epi32(lo), dst+0, gain);
+    avx2StoreS32toF32(_mm256_cvtepi8_epi32(_mm_srli_si128(lo, 8)), dst+8, gain);
+    avx2StoreS32toF32(_mm256_cvtepi8_epi32(hi), dst+16, gain);
+    avx2StoreS32toF32(_mm256_cvtepi8_epi32(_mm_srli_si128(hi, 8)), dst+24, gain);
+}
+
+SOAPY_SDR_TARGET("avx2")
+static void avx2CF32toCS8(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+{
+    const size_t n = numElems*2;
+    const size_t nVec = n & ~size_t(31);
+    auto *src = (const float *)srcBuff;
+    auto *dst = (int8_t *)dstBuff;
+    const float gainScalar = float(scaler*SoapySDR::S8_FULL_SCALE);
+    const __m256 gain = _mm256_set1_ps(gainScalar);
+
+    for (size_t i = 0; i < nVec; i += 32)
+    {
+        _mm256_storeu_si256((__m256i *)(dst+i), avx2PackF32toS8(src+i, gain));
+    }
+    tailF32toS8(src+nVec, dst+nVec, n-nVec, gainScalar);
+}
+
+SOAPY_SDR_TARGET("avx2")
+static void avx2CS8toCF32(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+{
+    const size_t n = numElems*2;
+    const size_t nVec = n & ~size_t(31);
+    auto *src = (const int8_t *)srcBuff;
+    auto *dst = (float *)dstBuff;
+    const float gainScalar = float(scaler/SoapySDR::S8_FULL_SCALE);
+    const __m256 gain = _mm256_set1_ps(gainScalar);
+
+    for (size_t i = 0; i < nVec; i += 32)
+    {
+        const __m128i lo = _mm_loadu_si128((const __m128i *)(src+i+0));
+        const __m128i hi = _mm_loadu_si128((const __m128i *)(src+i+16));
+        avx2UnpackS8toF32(lo, hi, dst+i, gain);
+    }
+    tailS8toF32(src+nVec, dst+nVec, n-nVec, gainScalar);
+}
+
+// CF32 <> CU8
+SOAPY_SDR_TARGET("avx2")
+static void avx2CF32toCU8(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+{
+    const size_t n = numElems*2;
+    const size_t nVec = n & ~size_t(31);
+    auto *src = (const float *)srcBuff;
+    auto *dst = (uint8_t *)dstBuff;
+    const float gainScalar = float(scaler*SoapySDR::S8_FULL_SCALE);
+    const __m256 gain = _mm256_set1_ps(gainScalar);
+    const __m256i offset = _mm256_set1_epi8(char(SoapySDR::U8_ZERO_OFFSET));
+
+    for (size_t i = 0; i < nVec; i += 32)
+    {
+        _mm256_storeu_si256((__m256i *)(dst+i), _mm256_xor_si256(avx2PackF32toS8(src+i, gain), offset));
+    }
+    tailF32toU8(src+nVec, dst+nVec, n-nVec, gainScalar);
+}
+
+SOAPY_SDR_TARGET("avx2")
+static void avx2CU8toCF32(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+{
+    const size_t n = numElems*2;
+    const size_t nVec = n & ~size_t(31);
+    auto *src = (const uint8_t *)srcBuff;
+    auto *dst = (float *)dstBuff;
+    const float gainScalar = float(scaler/SoapySDR::S8_FULL_SCALE);
+    const __m256 gain = _mm256_set1_ps(gainScalar);
+    const __m128i offset = _mm_set1_epi8(char(SoapySDR::U8_ZERO_OFFSET));
+
+    for (size_t i = 0; i < nVec; i += 32)
+    {
+        const __m128i lo = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(src+i+0)), offset);
+        const __m128i hi = _mm_xor_si128(_mm_loadu_si128((const __m128i *)(src+i+16)), offset);
+        avx2UnpackS8toF32(lo, hi, dst+i, gain);
+    }
+    tailU8toF32(src+nVec, dst+nVec, n-nVec, gainScalar);
+}
+
+#endif //SOAPY_SDR_X86_SIMD
+
+#ifdef SOAPY_SDR_NEON_SIMD
+
+/***********************************************************************
+ * NEON kernels
+ **********************************************************************/
+
+// CF32 <> CS16
+// vcvtq saturates and converts NaN to zero, the narrowing moves saturate the rest
+static inline int16x8_t neonPackF32toS16(const float *src, const float gain)
+{
+    const int32x4_t a = vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(src+0), gain));
+    const int32x4_t b = vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(src+4), gain));
+    return vcombine_s16(vqmovn_s32(a), vqmovn_s32(b));
+}
+
+static inline void neonUnpackS16toF32(const int16x8_t x, float *dst, const float gain)
+{
+    vst1q_f32(dst+0, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))), gain));
+    vst1q_f32(dst+4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))), gain));
+}
+
+static void neonCF32toCS16(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+{
+    const size_t n = numElems*2;
+    const size_t nVec = n & ~size_t(7);
+    auto *src = (const float *)srcBuff;
+    auto *dst = (int16_t *)dstBuff;
+    const float gain = float(scaler*SoapySDR::S16_FULL_SCALE);
+
+    for (size_t i = 0; i < nVec; i += 8)
+    {
+        vst1q_s16(dst+i, neonPackF32toS16(src+i, gain));
+    }
+    tailF32toS16(src+nVec, dst+nVec, n-nVec, gain);
+}
+
+static void neonCS16toCF32(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+{
+    const size_t n = numElems*2;
+    const size_t nVec = n & ~size_t(7);
+    auto *src = (const int16_t *)srcBuff;
+    auto *dst = (float *)dstBuff;
+    const float gain = float(scaler/SoapySDR::S16_FULL_SCALE);
+
+    for (size_t i = 0; i < nVec; i += 8)
+    {
+        neonUnpackS16toF32(vld1q_s16(src+i), dst+i, gain);
+    }
+    tailS16toF32(src+nVec, dst+nVec, n-nVec, gain);
+}
+
+// CF32 <> CU16
+static void neonCF32toCU16(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+{
+    const size_t n = numElems*2;
+    const size_t nVec = n & ~size_t(7);
+    auto *src = (const float *)srcBuff;
+    auto *dst = (uint16_t *)dstBuff;
+    const float gain = float(scaler*SoapySDR::S16_FULL_SCALE);
+    const uint16x8_t offset = vdupq_n_u16(SoapySDR::U16_ZERO_OFFSET);
+
+    for (size_t i = 0; i < nVec; i += 8)
+    {
+        vst1q_u16(dst+i, veorq_u16(vreinterpretq_u16_s16(neonPackF32toS16(src+i, gain)), offset));
+    }
+    tailF32toU16(src+nVec, dst+nVec, n-nVec, gain);
+}
+
+static void neonCU16toCF32(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+{
+    const size_t n = numElems*2;
+    const size_t nVec = n & ~size_t(7);
+    auto *src = (const uint16_t *)srcBuff;
+    auto *dst = (float *)dstBuff;
+    const float gain = float(scaler/SoapySDR::S16_FULL_SCALE);
+    const uint16x8_t offset = vdupq_n_u16(SoapySDR::U16_ZERO_OFFSET);
+
+    for (size_t i = 0; i < nVec; i += 8)
+    {
+        neonUnpackS16toF32(vreinterpretq_s16_u16(veorq_u16(vld1q_u16(src+i), offset)), dst+i, gain);
+    }
+    tailU16toF32(src+nVec, dst+nVec, n-nVec, gain);
+}
+
+// CF32 <> CS8
+static inline int8x16_t neonPackF32toS8(const float *src, const float gain)
+{
+    const int16x8_t lo = neonPackF32toS16(src+0, gain);
+    const int16x8_t hi = neonPackF32toS16(src+8, gain);
+    return vcombine_s8(vqmovn_s16(lo), vqmovn_s16(hi));
+}
+
+static inline void neonUnpackS8toF32(const int8x16_t x, float *dst, const float gain)
+{
+    neonUnpackS16toF32(vmovl_s8(vget_low_s8(x)), dst+0, gain);
+    neonUnpackS16toF32(vmovl_s8(vget_high_s8(x)), dst+8, gain);
+}
+
+static void neonCF32toCS8(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+{
+    const size_t n = numElems*2;
+    const size_t nVec = n & ~size_t(15);
+    auto *src = (const float *)srcBuff;
+    auto *dst = (int8_t *)dstBuff;
+    const float gain = float(scaler*SoapySDR::S8_FULL_SCALE);
+
+    for (size_t i = 0; i < nVec; i += 16)
+    {
+        vst1q_s8(dst+i, neonPackF32toS8(src+i, gain));
+    }
+    tailF32toS8(src+nVec, dst+nVec, n-nVec, gain);
+}
+
+static void neonCS8toCF32(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+{
+    const size_t n = numElems*2;
+    const size_t nVec = n & ~size_t(15);
+    auto *src = (const int8_t *)srcBuff;
+    auto *dst = (float *)dstBuff;
+    const float gain = float(scaler/SoapySDR::S8_FULL_SCALE);
+
+    for (size_t i = 0; i < nVec; i += 16)
+    {
+        neonUnpackS8toF32(vld1q_s8(src+i), dst+i, gain);
+    }
+    tailS8toF32(src+nVec, dst+nVec, n-nVec, gain);
+}
+
+// CF32 <> CU8
+static void neonCF32toCU8(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+{
+    const size_t n = numElems*2;
+    const size_t nVec = n & ~size_t(15);
+    auto *src = (const float *)srcBuff;
+    auto *dst = (uint8_t *)dstBuff;
+    const float gain = float(scaler*SoapySDR::S8_FULL_SCALE);
+    const uint8x16_t offset = vdupq_n_u8(SoapySDR::U8_ZERO_OFFSET);
+
+    for (size_t i = 0; i < nVec; i += 16)
+    {
+        vst1q_u8(dst+i, veorq_u8(vreinterpretq_u8_s8(neonPackF32toS8(src+i, gain)), offset));
+    }
+    tailF32toU8(src+nVec, dst+nVec, n-nVec, gain);
+}
+
+static void neonCU8toCF32(const void *srcBuff, void *dstBuff, const size_t numElems, const double scaler)
+{
+    const size_t n = numElems*2;
+    const size_t nVec = n & ~size_t(15);
+    auto *src = (const uint8_t *)srcBuff;
+    auto *dst = (float *)dstBuff;
+    const float gain = float(scaler/SoapySDR::S8_FULL_SCALE);
+    const uint8x16_t offset = vdupq_n_u8(SoapySDR::U8_ZERO_OFFSET);
+
+    for (size_t i = 0; i < nVec; i += 16)
+    {
+        neonUnpackS8toF32(vreinterpretq_s8_u8(veorq_u8(vld1q_u8(src+i), offset)), dst+i, gain);
+    }
+    tailU8toF32(src+nVec, dst+nVec, n-nVec, gain);
+}
+
+#endif //SOAPY_SDR_NEON_SIMD
+
+/***********************************************************************
+ * Registration with runtime dispatch
+ **********************************************************************/
+void tableCS8toCF32(const void *, void *, const size_t, const double);
+void tableCU8toCF32(const void *, void *, const size_t, const double);
+
+struct VectorizedConverters
+{
+    SoapySDR::ConverterRegistry::ConverterFunction CF32toCS16, CS16toCF32;
+    SoapySDR::ConverterRegistry::ConverterFunction CF32toCU16, CU16toCF32;
+    SoapySDR::ConverterRegistry::ConverterFunction CF32toCS8, CS8toCF32;
+    SoapySDR::ConverterRegistry::ConverterFunction CF32toCU8, CU8toCF32;
+};
+
+static VectorizedConverters selectVectorizedConverters(void)
+{
+    VectorizedConverters c = {};
+    #ifdef SOAPY_SDR_X86_SIMD
+    if (cpuSupportsAVX2())
+    {
+        c.CF32toCS16 = &avx2CF32toCS16; c.CS16toCF32 = &avx2CS16toCF32;
+        c.CF32toCU16 = &avx2CF32toCU16; c.CU16toCF32 = &avx2CU16toCF32;
+        c.CF32toCS8 = &avx2CF32toCS8; c.CS8toCF32 = &avx2CS8toCF32;
+        c.CF32toCU8 = &avx2CF32toCU8; c.CU8toCF32 = &avx2CU8toCF32;
+    }
+    else if (cpuSupportsSSE2())
+    {
+        c.CF32toCS16 = &sse2CF32toCS16; c.CS16toCF32 = &sse2CS16toCF32;
+        c.CF32toCU16 = &sse2CF32toCU16; c.CU16toCF32 = &sse2CU16toCF32;
+        c.CF32toCS8 = &sse2CF32toCS8; c.CS8toCF32 = &sse2CS8toCF32;
+        c.CF32toCU8 = &sse2CF32toCU8; c.CU8toCF32 = &sse2CU8toCF32;
+    }
+    #endif
+    #ifdef SOAPY_SDR_NEON_SIMD
+    c.CF32toCS16 = &neonCF32toCS16; c.CS16toCF32 = &neonCS16toCF32;
+    c.CF32toCU16 = &neonCF32toCU16; c.CU16toCF32 = &neonCU16toCF32;
+    c.CF32toCS8 = &neonCF32toCS8; c.CS8toCF32 = &neonCS8toCF32;
+    c.CF32toCU8 = &neonCF32toCU8; c.CU8toCF32 = &neonCU8toCF32;
+    #endif
+
+    //lookup tables for the 8-bit sources without a SIMD kernel
+    if (c.CS8toCF32 == nullptr) c.CS8toCF32 = &tableCS8toCF32;
+    if (c.CU8toCF32 == nullptr) c.CU8toCF32 = &tableCU8toCF32;
+    return c;
+}
+
+static void registerVectorized(const char *source, const char *target, SoapySDR::ConverterRegistry::ConverterFunction fcn)
+{
+    if (fcn == nullptr) return; //no implementation for this host
+    //the kernels load each block before storing it, so narrowing is safe in-place
+    const bool inPlace = SoapySDR::formatToSize(target) <= SoapySDR::formatToSize(source);
+    SoapySDR::ConverterRegistry registration(source, target, SoapySDR::ConverterRegistry::VECTORIZED, fcn, inPlace);
+}
+
+static bool registerVectorizedConverters(void)
+{
+    const auto c = selectVectorizedConverters();
+    registerVectorized(SOAPY_SDR_CF32, SOAPY_SDR_CS16, c.CF32toCS16);
+    registerVectorized(SOAPY_SDR_CS16, SOAPY_SDR_CF32, c.CS16toCF32);
+    registerVectorized(SOAPY_SDR_CF32, SOAPY_SDR_CU16, c.CF32toCU16);
+    registerVectorized(SOAPY_SDR_CU16, SOAPY_SDR_CF32, c.CU16toCF32);
+    registerVectorized(SOAPY_SDR_CF32, SOAPY_SDR_CS8, c.CF32toCS8);
+    registerVectorized(SOAPY_SDR_CS8, SOAPY_SDR_CF32, c.CS8toCF32);
+    registerVectorized(SOAPY_SDR_CF32, SOAPY_SDR_CU8, c.CF32toCU8);
+    registerVectorized(SOAPY_SDR_CU8, SOAPY_SDR_CF32, c.CU8toCF32);
+    return true;
+}
+
+/*!
+ * lateLoadVectorizedConverters() is called by lateLoadDefaultConverters()
+ * to register the kernels that are supported by the host's CPU.
+ */
+void lateLoadVectorizedConverters(void)
+{
+    //one-shot registration, the selection only depends on the host
+    static const bool registered = registerVectorizedConverters();
+    (void)registered;
+}
@@ -15,6 +15,7 @@
 #include <SoapySDR/Formats.hpp>
 #include <SoapySDR/Time.hpp>
 #include <SoapySDR/Logger.hpp>
+#include <SoapySDR/ConverterRegistry.hpp>
 %}
 
 ////////////////////////////////////////////////////////////////////////
@@ -31,6 +32,19 @@
     {SWIG_exception(SWIG_RuntimeError, "unknown");}
 }
 
+////////////////////////////////////////////////////////////////////////
+// The module is built with -threads, which releases the GIL around
+// every call, keep the GIL for the pure computations that never block
+////////////////////////////////////////////////////////////////////////
+%nothread SoapySDR::getAPIVersion;
+%nothread SoapySDR::getABIVersion;
+%nothread SoapySDR::getLibVersion;
+%nothread SoapySDR::formatToSize;
+%nothread SoapySDR::ticksToTimeNs;
+%nothread SoapySDR::timeNsToTicks;
+%nothread SoapySDR::TickConverter::ticksToTimeNs;
+%nothread SoapySDR::TickConverter::timeNsToTicks;
+
 ////////////////////////////////////////////////////////////////////////
 // Config header defines API export
 ////////////////////////////////////////////////////////////////////////
@@ -43,6 +57,7 @@
 %include <std_string.i>
 %include <std_vector.i>
 %include <std_map.i>
+%include <std_pair.i>
 %include <SoapySDR/Types.hpp>
 
 //handle arm 32-bit case where size_t and unsigned are the same
@@ -50,6 +65,8 @@
 %typedef unsigned int size_t;
 #else
 %template(SoapySDRUnsignedList) std::vector<unsigned>;
+%template(SoapySDRUnsignedPair) std::pair<unsigned, unsigned>;
+%template(SoapySDRUnsignedPairList) std::vector<std::pair<unsigned, unsigned>>;
 #endif
 
 %template(SoapySDRKwargs) std::map<std::string, std::string>;
@@ -91,11 +108,13 @@
     struct StreamResult
     {
         StreamResult(void):
-            ret(0), flags(0), timeNs(0), chanMask(0){}
+            ret(0), flags(0), timeNs(0), chanMask(0), handle(0){}
         int ret;
         int flags;
         long long timeNs;
         size_t chanMask;
+        size_t handle;
+        std::vector<size_t> buffs;
     };
 %}
 
@@ -128,8 +147,48 @@
 %include <SoapySDR/Version.hpp>
 %include <SoapySDR/Modules.hpp>
 %include <SoapySDR/Formats.hpp>
+%ignore SoapySDR::TickConverter::ticksToTimeNs(const long long *, long long *, const size_t) const;
+%ignore SoapySDR::TickConverter::timeNsToTicks(const long long *, long long *, const size_t) const;
 %include <SoapySDR/Time.hpp>
 
+////////////////////////////////////////////////////////////////////////
+// Converters
+////////////////////////////////////////////////////////////////////////
+%inline %{
+namespace SoapySDR
+{
+    std::vector<std::string> listConverterTargetFormats(const std::string &sourceFormat)
+    {
+        return SoapySDR::ConverterRegistry::listTargetFormats(sourceFormat);
+    }
+
+    std::vector<std::string> listConverterSourceFormats(const std::string &targetFormat)
+    {
+        return SoapySDR::ConverterRegistry::listSourceFormats(targetFormat);
+    }
+
+    std::vector<std::string> listConverterAvailableSourceFormats(void)
+    {
+        return SoapySDR::ConverterRegistry::listAvailableSourceFormats();
+    }
+
+    std::vector<size_t> listConverterPriorities(const std::string &sourceFormat, const std::string &targetFormat)
+    {
+        const auto priorities = SoapySDR::ConverterRegistry::listPriorities(sourceFormat, targetFormat);
+        return std::vector<size_t>(priorities.begin(), priorities.end());
+    }
+
+    //a negative priority selects the highest registered priority
+    void convert__(const size_t src, const size_t dst, const size_t numElems, const std::string &sourceFormat, const std::string &targetFormat, const double scaler, const int priority)
+    {
+        const auto function = (priority < 0)?
+            SoapySDR::ConverterRegistry::getFunction(sourceFormat, targetFormat):
+            SoapySDR::ConverterRegistry::getFunction(sourceFormat, targetFormat, SoapySDR::ConverterRegistry::FunctionPriority(priority));
+        function((const void *)src, (void *)dst, numElems, scaler);
+    }
+}
+%}
+
 %ignore SoapySDR::logf;
 %ignore SoapySDR::vlogf;
 %ignore SoapySDR::registerLogHandler;
@@ -138,7 +197,18 @@
 ////////////////////////////////////////////////////////////////////////
 // Device object
 ////////////////////////////////////////////////////////////////////////
+%include <SoapySDR/SettingsTransaction.hpp>
+
 %nodefaultctor SoapySDR::Device;
+%ignore SoapySDR::Device::enumerateAsync;
+%ignore SoapySDR::Device::makeAsync;
+%ignore SoapySDR::Device::make(const KwargsList &);
+%ignore SoapySDR::Device::unmake(const std::vector<Device *> &);
+%ignore SoapySDR::Device::subscribeSensors;
+%ignore SoapySDR::Device::unsubscribeSensors;
+%ignore SoapySDR::Device::getStreamPollHandle;
+%ignore SoapySDR::Device::subscribeStream;
+%ignore SoapySDR::Device::unsubscribeStream;
 %include <SoapySDR/Device.hpp>
 
 //global factory lock support
@@ -153,6 +223,8 @@ for key in sorted(globals().keys()):
 //make device a constructable class
 %insert("python")
 %{
+import ctypes
+
 _Device = Device
 class Device(Device):
     def __new__(cls, *args, **kwargs):
@@ -164,6 +236,20 @@ def extractBuffPointer(buff):
     if hasattr(buff, '__long__'): return long(buff)
     if hasattr(buff, '__int__'): return int(buff)
     raise Exception("Unrecognized data format: " + str(type(buff)))
+
+def directBuffViews(ptrs, numBytes):
+    return [memoryview((ctypes.c_char*numBytes).from_address(p)) for p in ptrs]
+
+def extractBuffBytes(buff):
+    if hasattr(buff, 'nbytes'): return buff.nbytes
+    return memoryview(buff).nbytes
+
+#convert between stream formats with the library converters, the GIL is released during the conversion
+#the number of elements defaults to what fits in both buffers, priority -1 selects the highest priority
+def convert(src, dst, srcFmt, dstFmt, scale = 1.0, numElems = None, priority = -1):
+    if numElems is None:
+        numElems = min(extractBuffBytes(src)//formatToSize(srcFmt), extractBuffBytes(dst)//formatToSize(dstFmt))
+    convert__(extractBuffPointer(src), extractBuffPointer(dst), numElems, srcFmt, dstFmt, scale, priority)
 %}
 
 %extend SoapySDR::Device
@@ -195,6 +281,48 @@ def extractBuffPointer(buff):
         return sr;
     }
 
+    std::vector<size_t> getDirectAccessBufferAddrs__(SoapySDR::Stream *stream, const size_t handle, const size_t numChans)
+    {
+        std::vector<void *> ptrs(numChans);
+        const int ret = self->getDirectAccessBufferAddrs(stream, handle, (&ptrs[0]));
+        if (ret != 0) throw std::runtime_error("getDirectAccessBufferAddrs() "+std::string(SoapySDR::errToStr(ret)));
+        return std::vector<size_t>(ptrs.begin(), ptrs.end());
+    }
+
+    long long getStreamPollHandle(SoapySDR::Stream *stream)
+    {
+        intptr_t handle(0);
+        const int ret = self->getStreamPollHandle(stream, handle);
+        if (ret != 0) throw std::runtime_error("getStreamPollHandle() "+std::string(SoapySDR::errToStr(ret)));
+        return (long long)(handle);
+    }
+
+    StreamResult acquireReadBuffer__(SoapySDR::Stream *stream, const size_t numChans, const long timeoutUs)
+    {
+        StreamResult sr;
+        std::vector<const void *> ptrs(numChans);
+        sr.ret = self->acquireReadBuffer(stream, sr.handle, (&ptrs[0]), sr.flags, sr.timeNs, timeoutUs);
+        if (sr.ret >= 0) for (const auto ptr : ptrs) sr.buffs.push_back(size_t(ptr));
+        return sr;
+    }
+
+    StreamResult acquireWriteBuffer__(SoapySDR::Stream *stream, const size_t numChans, const long timeoutUs)
+    {
+        StreamResult sr;
+        std::vector<void *> ptrs(numChans);
+        sr.ret = self->acquireWriteBuffer(stream, sr.handle, (&ptrs[0]), timeoutUs);
+        if (sr.ret >= 0) for (const auto ptr : ptrs) sr.buffs.push_back(size_t(ptr));
+        return sr;
+    }
+
+    StreamResult releaseWriteBuffer__(SoapySDR::Stream *stream, const size_t handle, const size_t numElems, const int flags, const long long timeNs)
+    {
+        StreamResult sr;
+        sr.flags = flags;
+        self->releaseWriteBuffer(stream, handle, numElems, sr.flags, timeNs);
+        return sr;
+    }
+
     %insert("python")
     %{
         #call unmake from custom deleter
@@ -214,5 +342,23 @@ def extractBuffPointer(buff):
 
         def readStreamStatus(self, stream, timeoutUs = 100000):
             return self.readStreamStatus__(stream, timeoutUs)
+
+        #direct buffer access: the returned memoryviews alias the driver's buffers
+        #and are only valid until the handle is released, numpy.frombuffer() wraps them without a copy
+        def getDirectAccessBufferAddrs(self, stream, handle, numChans = 1):
+            return self.getDirectAccessBufferAddrs__(stream, handle, numChans)
+
+        def acquireReadBuffer(self, stream, format, numChans = 1, timeoutUs = 100000):
+            sr = self.acquireReadBuffer__(stream, numChans, timeoutUs)
+            if sr.ret < 0: return sr, []
+            return sr, directBuffViews(sr.buffs, sr.ret*formatToSize(format))
+
+        def acquireWriteBuffer(self, stream, format, numChans = 1, timeoutUs = 100000):
+            sr = self.acquireWriteBuffer__(stream, numChans, timeoutUs)
+            if sr.ret < 0: return sr, []
+            return sr, directBuffViews(sr.buffs, sr.ret*formatToSize(format))
+
+        def releaseWriteBuffer(self, stream, handle, numElems, flags = 0, timeNs = 0):
+            return self.releaseWriteBuffer__(stream, handle, numElems, flags, timeNs)
     %}
 };
@@ -0,0 +1,239 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/Device.hpp>
+#include <SoapySDR/Modules.hpp>
+#include <SoapySDR/Broker.hpp>
+#include <SoapySDR/Formats.hpp>
+#include <SoapySDR/Errors.hpp>
+#include <SoapySDR/Time.hpp>
+#include <complex>
+#include <cstdlib>
+#include <cstdio>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <vector>
+#include <string>
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+/***********************************************************************
+ * A paced null device at 1 Msps published in buffers of 1000 samples,
+ * 48 of the 64 slots may be acquired, which is 48 ms of samples
+ **********************************************************************/
+static const std::string brokerName("TestBrokerDriver");
+
+static SoapySDR::Device *makeSource(void)
+{
+    return SoapySDR::Device::make("type=null,paced=true,mtu=1000");
+}
+
+static const char *brokerArgs = "buffers=64,guard=16";
+
+static bool continuous(const long long prevTimeNs, const int prevElems, const long long timeNs)
+{
+    return timeNs == prevTimeNs + SoapySDR::ticksToTimeNs(prevElems, 1e6);
+}
+
+#ifndef _WIN32
+//a reader in a forked process sees the buffers of the broker in this process
+static int childReader(void)
+{
+    std::unique_ptr<SoapySDR::BrokerReader> reader;
+    for (size_t i = 0; i < 500 and not reader; i++) try
+    {
+        reader.reset(new SoapySDR::BrokerReader(brokerName));
+    }
+    catch (const std::exception &)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    if (not reader) return EXIT_FAILURE;
+
+    long long prevTimeNs(0);
+    int prevElems(0);
+    size_t numContinuous(0);
+    for (size_t i = 0; i < 16; i++)
+    {
+        size_t handle(0);
+        const void *buffs[1] = {nullptr};
+        int flags(0);
+        long long timeNs(0);
+        const int ret = reader->acquire(handle, buffs, flags, timeNs, 1000000);
+        if (ret <= 0) return EXIT_FAILURE;
+        if (i != 0 and continuous(prevTimeNs, prevElems, timeNs)) numContinuous++;
+        prevTimeNs = timeNs;
+        prevElems = ret;
+        reader->release(handle);
+    }
+    return (numContinuous == 15 and reader->numOverflows() == 0)?EXIT_SUCCESS:EXIT_FAILURE;
+}
+
+static bool testCrossProcess(void)
+{
+    const pid_t pid = fork();
+    if (pid == 0) _exit(childReader());
+
+    auto source = makeSource();
+    int status(-1);
+    {
+        SoapySDR::Broker broker(source, std::vector<size_t>(1, 0), brokerName, SoapySDR::KwargsFromString(brokerArgs));
+        broker.start();
+        waitpid(pid, &status, 0);
+    }
+    SoapySDR::Device::unmake(source);
+
+    if (not WIFEXITED(status) or WEXITSTATUS(status) != EXIT_SUCCESS)
+    {
+        printf("FAIL: broker reader in another process, status %d\n", status);
+        return false;
+    }
+    return true;
+}
+#endif
+
+static bool testFanOut(void)
+{
+    auto source = makeSource();
+    std::unique_ptr<SoapySDR::Broker> broker(new SoapySDR::Broker(source, std::vector<size_t>(1, 0), brokerName, SoapySDR::KwargsFromString(brokerArgs)));
+    broker->start();
+
+    //a second broker by the same name is refused
+    bool inUse(false);
+    try {SoapySDR::Broker other(source, std::vector<size_t>(1, 0), brokerName);}
+    catch (const std::runtime_error &) {inUse = true;}
+
+    //every stream of the client device is a reader of its own
+    auto device = SoapySDR::Device::make("driver=broker,name=" + brokerName);
+    auto copy = device->setupStream(SOAPY_SDR_RX, SOAPY_SDR_CF32);
+    auto direct = device->setupStream(SOAPY_SDR_RX, SOAPY_SDR_CF32);
+    auto convert = device->setupStream(SOAPY_SDR_RX, SOAPY_SDR_CS16);
+    device->activateStream(copy);
+    device->activateStream(direct);
+    device->activateStream(convert);
+
+    //partial reads split a buffer and keep the timestamps
+    std::vector<std::complex<float>> out(600);
+    void *outs[] = {out.data()};
+    int flags(0);
+    long long timeNs(0), prevTimeNs(0);
+    int prevRet(0);
+    size_t numContinuous(0);
+    for (size_t i = 0; i < 20; i++)
+    {
+        const int ret = device->readStream(copy, outs, out.size(), flags, timeNs, 100000);
+        if (ret <= 0) break;
+        if (i != 0 and continuous(prevTimeNs, prevRet, timeNs)) numContinuous++;
+        prevTimeNs = timeNs;
+        prevRet = ret;
+    }
+
+    //direct reads are the shared slots
+    size_t handle(0);
+    const void *buffs[1] = {nullptr};
+    const int directRet = device->acquireReadBuffer(direct, handle, buffs, flags, timeNs, 100000);
+    void *addrs[1] = {nullptr};
+    const bool directOk = directRet == 1000 and device->getDirectAccessBufferAddrs(direct, handle, addrs) == 0 and addrs[0] == buffs[0];
+    if (directRet > 0) device->releaseReadBuffer(direct, handle);
+
+    std::vector<short> shorts(2000);
+    void *shortOuts[] = {shorts.data()};
+    const int convertRet = device->readStream(convert, shortOuts, 1000, flags, timeNs, 100000);
+    const size_t numReaders = broker->readers().size();
+
+    device->deactivateStream(copy);
+    device->deactivateStream(direct);
+    device->deactivateStream(convert);
+    device->closeStream(copy);
+    device->closeStream(direct);
+    device->closeStream(convert);
+    const size_t numClosed = broker->readers().size();
+    SoapySDR::Device::unmake(device);
+    broker.reset();
+    SoapySDR::Device::unmake(source);
+
+    if (not inUse or numContinuous != 19 or not directOk or convertRet != 1000 or numReaders != 3 or numClosed != 0)
+    {
+        printf("FAIL: broker fan out inUse=%d, continuous=%d, direct=%d (%d), convert=%d, readers=%d/%d\n",
+            int(inUse), int(numContinuous), int(directOk), directRet, convertRet, int(numReaders), int(numClosed));
+        return false;
+    }
+    return true;
+}
+
+static bool testOverflowPerReader(void)
+{
+    auto source = makeSource();
+    std::unique_ptr<SoapySDR::Broker> broker(new SoapySDR::Broker(source, std::vector<size_t>(1, 0), brokerName, SoapySDR::KwargsFromString(brokerArgs)));
+    broker->start();
+
+    SoapySDR::BrokerReader fast(brokerName);
+    SoapySDR::BrokerReader slow(brokerName);
+    size_t handle(0), slowHandle(0);
+    const void *buffs[1] = {nullptr};
+    int flags(0);
+    long long timeNs(0);
+    const auto keepUp = [&](const long ms)
+    {
+        const auto exit = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+        while (std::chrono::steady_clock::now() < exit)
+        {
+            if (fast.acquire(handle, buffs, flags, timeNs, 100000) > 0) fast.release(handle);
+        }
+    };
+
+    //the slow reader falls behind by more than the ring and skips ahead
+    keepUp(100);
+    const int lapped = slow.acquire(slowHandle, buffs, flags, timeNs, 100000);
+    const unsigned long long dropped = slow.numDropped();
+
+    //a buffer held for longer than the guard is reported on release
+    const int held = slow.acquire(slowHandle, buffs, flags, timeNs, 100000);
+    keepUp(100);
+    if (held > 0) slow.release(slowHandle);
+    const int overwritten = slow.acquire(slowHandle, buffs, flags, timeNs, 100000);
+    const int resumed = slow.acquire(slowHandle, buffs, flags, timeNs, 100000);
+    if (resumed > 0) slow.release(slowHandle);
+
+    const auto readers = broker->readers();
+    broker.reset();
+    SoapySDR::Device::unmake(source);
+
+    const bool ok =
+        lapped == SOAPY_SDR_OVERFLOW and dropped > 40 and held == 1000 and
+        overwritten == SOAPY_SDR_OVERFLOW and resumed == 1000 and
+        fast.numOverflows() == 0 and slow.numOverflows() == 2 and
+        readers.size() == 2 and readers[0].numOverflows == 0 and readers[1].numOverflows == 2;
+    if (not ok)
+    {
+        printf("FAIL: broker overflow lapped=%d, dropped=%llu, held=%d, overwritten=%d, resumed=%d, overflows fast=%llu slow=%llu\n",
+            lapped, dropped, held, overwritten, resumed, fast.numOverflows(), slow.numOverflows());
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1) SoapySDR::loadModule(argv[1]);
+
+    bool ok = true;
+    #ifndef _WIN32
+    ok = ok and testCrossProcess();
+    #endif
+    ok = ok and testFanOut();
+    ok = ok and testOverflowPerReader();
+
+    //the segment is removed with the broker
+    bool removed(false);
+    try {SoapySDR::BrokerReader reader(brokerName);}
+    catch (const std::runtime_error &) {removed = true;}
+    if (not removed) printf("FAIL: broker segment left behind\n");
+    ok = ok and removed;
+
+    printf("DONE!\n");
+    return ok?EXIT_SUCCESS:EXIT_FAILURE;
+}
@@ -0,0 +1,584 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/ConverterRegistry.hpp>
+#include <SoapySDR/ConverterPool.hpp>
+#include <SoapySDR/Formats.hpp>
+#include <SoapySDR/Converters.h>
+#include <SoapySDR/Types.h>
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <stdexcept>
+#include <atomic>
+#include <thread>
+#include <limits>
+
+//fill a buffer with random values of the specified format
+static void fillRandom(std::vector<char> &buff, const std::string &format)
+{
+    const bool isFloat = (format.find('F') != std::string::npos);
+    if (isFloat and format.find("64") != std::string::npos)
+    {
+        auto *p = (double *)buff.data();
+        for (size_t i = 0; i < buff.size()/sizeof(double); i++)
+        {
+            p[i] = double(std::rand())/RAND_MAX*2.0 - 1.0;
+        }
+    }
+    else if (isFloat)
+    {
+        auto *p = (float *)buff.data();
+        for (size_t i = 0; i < buff.size()/sizeof(float); i++)
+        {
+            p[i] = float(std::rand())/RAND_MAX*2.0f - 1.0f;
+        }
+    }
+    else for (size_t i = 0; i < buff.size(); i++) buff[i] = char(std::rand());
+}
+
+//compare two buffers of the specified format with a tolerance
+static bool checkClose(const std::vector<char> &a, const std::vector<char> &b, const std::string &format, const size_t numElems)
+{
+    const bool isComplex = (format[0] == 'C');
+    const size_t numWords = numElems*(isComplex?2:1);
+    const size_t wordSize = SoapySDR::formatToSize(format)/(isComplex?2:1);
+    if (format.find('F') != std::string::npos)
+    {
+        auto *pa = (const float *)a.data();
+        auto *pb = (const float *)b.data();
+        for (size_t i = 0; i < numWords; i++)
+        {
+            if (std::abs(pa[i] - pb[i]) <= 1e-5) continue;
+            printf("FAIL: index %d %f != %f\n", int(i), pa[i], pb[i]);
+            return false;
+        }
+        return true;
+    }
+
+    //integer formats are allowed to differ by one count due to rounding
+    const bool isUnsigned = (format.find('U') != std::string::npos);
+    for (size_t i = 0; i < numWords; i++)
+    {
+        long long va(0), vb(0);
+        if (wordSize == 2)
+        {
+            int16_t x, y;
+            std::memcpy(&x, a.data()+i*2, 2);
+            std::memcpy(&y, b.data()+i*2, 2);
+            va = x; vb = y;
+            if (isUnsigned) {va = uint16_t(x); vb = uint16_t(y);}
+        }
+        else
+        {
+            va = int8_t(a[i]); vb = int8_t(b[i]);
+            if (isUnsigned) {va = uint8_t(a[i]); vb = uint8_t(b[i]);}
+        }
+        if (std::abs(va - vb) <= 1) continue;
+        printf("FAIL: index %d %lld != %lld\n", int(i), va, vb);
+        return false;
+    }
+    return true;
+}
+
+//compare a registered priority against the generic implementation
+static bool testPriority(const std::string &source, const std::string &target, const SoapySDR::ConverterRegistry::FunctionPriority priority)
+{
+    printf("Test %s -> %s priority %d... ", source.c_str(), target.c_str(), int(priority));
+    const auto generic = SoapySDR::ConverterRegistry::getFunction(source, target, SoapySDR::ConverterRegistry::GENERIC);
+    const auto other = SoapySDR::ConverterRegistry::getFunction(source, target, priority);
+
+    //odd sizes exercise the scalar tail after the vector loop
+    for (const size_t numElems : {1, 7, 64, 1000, 1023})
+    {
+        for (const double scaler : {1.0, 0.5})
+        {
+            std::vector<char> src(numElems*SoapySDR::formatToSize(source));
+            std::vector<char> dst0(numElems*SoapySDR::formatToSize(target));
+            std::vector<char> dst1(dst0.size());
+            fillRandom(src, source);
+            generic(src.data(), dst0.data(), numElems, scaler);
+            other(src.data(), dst1.data(), numElems, scaler);
+            if (not checkClose(dst0, dst1, target, numElems)) return false;
+        }
+    }
+    printf("OK\n");
+    return true;
+}
+
+//out of range and NaN inputs saturate the same in the vector loop and the scalar tail
+template <typename T>
+static bool testOutOfRange(const std::string &target, const T hi, const T lo, const T zero)
+{
+    const auto priority = SoapySDR::ConverterRegistry::VECTORIZED;
+    const auto priorities = SoapySDR::ConverterRegistry::listPriorities(SOAPY_SDR_CF32, target);
+    if (std::find(priorities.begin(), priorities.end(), priority) == priorities.end()) return true;
+    printf("Test %s -> %s out of range... ", SOAPY_SDR_CF32, target.c_str());
+    const auto convert = SoapySDR::ConverterRegistry::getFunction(SOAPY_SDR_CF32, target, priority);
+    const float values[4] = {1e10f, -1e10f, std::numeric_limits<float>::quiet_NaN(), 2.0f};
+    const T expected[4] = {hi, lo, zero, hi};
+
+    //the odd size puts some of each value in the vector loop and in the tail
+    const size_t numElems = 67;
+    std::vector<float> src(numElems*2);
+    for (size_t i = 0; i < src.size(); i++) src[i] = values[i%4];
+    std::vector<T> dst(src.size());
+    convert(src.data(), dst.data(), numElems, 1.0);
+
+    for (size_t i = 0; i < src.size(); i++)
+    {
+        //a single element is converted by the scalar tail alone
+        const float in[2] = {src[i], src[i]};
+        T out[2];
+        convert(in, out, 1, 1.0);
+        if (dst[i] == expected[i%4] and out[0] == expected[i%4]) continue;
+        printf("FAIL: index %d input %g vector %d tail %d expected %d\n",
+            int(i), src[i], int(dst[i]), int(out[0]), int(expected[i%4]));
+        return false;
+    }
+    printf("OK\n");
+    return true;
+}
+
+//the resolved handle and format ID lookup match the string lookup
+static bool testConverterHandle(const std::string &source, const std::string &target)
+{
+    printf("Test %s -> %s handle... ", source.c_str(), target.c_str());
+    const auto best = SoapySDR::ConverterRegistry::getFunction(source, target);
+    const auto converter = SoapySDR::ConverterRegistry::getConverter(source, target);
+    const auto sourceId = SoapySDR::ConverterRegistry::getFormatId(source);
+    const auto targetId = SoapySDR::ConverterRegistry::getFormatId(target);
+    if (not converter or converter.function != best)
+    {
+        printf("FAIL: getConverter() mismatch\n");
+        return false;
+    }
+    if (converter.priority != SoapySDR::ConverterRegistry::listPriorities(source, target).back())
+    {
+        printf("FAIL: getConverter() priority mismatch\n");
+        return false;
+    }
+    if (converter.sourceElemSize != SoapySDR::formatToSize(source) or converter.targetElemSize != SoapySDR::formatToSize(target))
+    {
+        printf("FAIL: getConverter() element size mismatch\n");
+        return false;
+    }
+    if (SoapySDR::ConverterRegistry::getFunction(sourceId, targetId) != best)
+    {
+        printf("FAIL: getFunction(FormatId) mismatch\n");
+        return false;
+    }
+    if (SoapySDR::ConverterRegistry::getFormatName(sourceId) != source)
+    {
+        printf("FAIL: getFormatName() mismatch\n");
+        return false;
+    }
+    printf("OK\n");
+    return true;
+}
+
+//formats are interned without a registration and keep their identifiers
+static bool testFormatIds(void)
+{
+    printf("Test format identifiers... ");
+    std::vector<SoapySDR::ConverterRegistry::FormatId> ids;
+    for (size_t i = 0; i < 1000; i++) ids.push_back(SoapySDR::ConverterRegistry::getFormatId("TEST_FORMAT"+std::to_string(i)));
+    for (size_t i = 0; i < ids.size(); i++)
+    {
+        if (SoapySDR::ConverterRegistry::getFormatId("TEST_FORMAT"+std::to_string(i)) == ids[i] and
+            SoapySDR::ConverterRegistry::getFormatName(ids[i]) == "TEST_FORMAT"+std::to_string(i)) continue;
+        printf("FAIL: identifier %d changed\n", int(i));
+        return false;
+    }
+    const auto cf32 = SoapySDR::ConverterRegistry::getFormatId(SOAPY_SDR_CF32);
+    const auto cs16 = SoapySDR::ConverterRegistry::getFormatId(SOAPY_SDR_CS16);
+    if (SoapySDR::ConverterRegistry::getFunction(cf32, cs16) != SoapySDR::ConverterRegistry::getFunction(SOAPY_SDR_CF32, SOAPY_SDR_CS16))
+    {
+        printf("FAIL: getFunction(FormatId) after interning\n");
+        return false;
+    }
+    printf("OK\n");
+    return true;
+}
+
+//lookups stay valid while another thread registers new conversions
+static void dummyConverter(const void *, void *, const size_t, const double) {}
+
+static bool testConcurrentRegistration(void)
+{
+    printf("Test concurrent registration... ");
+    std::atomic<bool> done(false);
+    std::atomic<bool> failed(false);
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < 4; i++) readers.emplace_back([&]()
+    {
+        const auto sourceId = SoapySDR::ConverterRegistry::getFormatId(SOAPY_SDR_CF32);
+        const auto targetId = SoapySDR::ConverterRegistry::getFormatId(SOAPY_SDR_CS16);
+        const auto expected = SoapySDR::ConverterRegistry::getFunction(SOAPY_SDR_CF32, SOAPY_SDR_CS16);
+        while (not done)
+        {
+            if (SoapySDR::ConverterRegistry::getFunction(sourceId, targetId) != expected) failed = true;
+            if (SoapySDR::ConverterRegistry::listTargetFormats(SOAPY_SDR_CF32).empty()) failed = true;
+        }
+    });
+
+    for (size_t i = 0; i < 100; i++)
+    {
+        SoapySDR::ConverterRegistry("TEST_SRC"+std::to_string(i), "TEST_DST", SoapySDR::ConverterRegistry::CUSTOM, &dummyConverter);
+    }
+    done = true;
+    for (auto &reader : readers) reader.join();
+
+    if (failed or SoapySDR::ConverterRegistry::listSourceFormats("TEST_DST").size() != 100)
+    {
+        printf("FAIL: inconsistent lookups\n");
+        return false;
+    }
+    printf("OK\n");
+    return true;
+}
+
+//fused multi-channel conversion matches a copy then single channel conversion
+static bool testDeinterleave(const std::string &source, const std::string &target, const size_t numChans, const size_t stride)
+{
+    printf("Test %s -> %s (de)interleave chans=%d stride=%d... ", source.c_str(), target.c_str(), int(numChans), int(stride));
+    const size_t numElems = 1000;
+    const double scaler = 0.5;
+    const size_t srcSize = SoapySDR::formatToSize(source);
+    const size_t dstSize = SoapySDR::formatToSize(target);
+    const auto deinterleave = SoapySDR::ConverterRegistry::getDeinterleaveFunction(source, target);
+    const auto interleave = SoapySDR::ConverterRegistry::getInterleaveFunction(source, target);
+    const auto convert = SoapySDR::ConverterRegistry::getFunction(source, target, SoapySDR::ConverterRegistry::GENERIC);
+
+    std::vector<char> interleaved(numElems*stride*srcSize);
+    fillRandom(interleaved, source);
+
+    std::vector<std::vector<char>> outputs(numChans, std::vector<char>(numElems*dstSize));
+    std::vector<void *> outBuffs;
+    for (auto &out : outputs) outBuffs.push_back(out.data());
+    deinterleave(interleaved.data(), outBuffs.data(), numChans, stride, numElems, scaler);
+
+    std::vector<std::vector<char>> inputs(numChans, std::vector<char>(numElems*srcSize));
+    std::vector<const void *> inBuffs;
+    for (auto &in : inputs) inBuffs.push_back(in.data());
+    std::vector<char> reinterleaved(numElems*stride*dstSize);
+    for (size_t ch = 0; ch < numChans; ch++)
+    {
+        for (size_t i = 0; i < numElems; i++)
+        {
+            std::memcpy(inputs[ch].data()+i*srcSize, interleaved.data()+(i*stride+ch)*srcSize, srcSize);
+        }
+        std::vector<char> expected(numElems*dstSize);
+        convert(inputs[ch].data(), expected.data(), numElems, scaler);
+        if (not checkClose(expected, outputs[ch], target, numElems)) return false;
+    }
+
+    interleave(inBuffs.data(), reinterleaved.data(), numChans, stride, numElems, scaler);
+    for (size_t ch = 0; ch < numChans; ch++)
+    {
+        std::vector<char> actual(numElems*dstSize);
+        for (size_t i = 0; i < numElems; i++)
+        {
+            std::memcpy(actual.data()+i*dstSize, reinterleaved.data()+(i*stride+ch)*dstSize, dstSize);
+        }
+        if (not checkClose(outputs[ch], actual, target, numElems)) return false;
+    }
+    printf("OK\n");
+    return true;
+}
+
+//a scaler above one saturates integer to integer conversions
+template <typename T>
+static bool testDeinterleaveSaturates(const std::string &format)
+{
+    printf("Test %s saturation... ", format.c_str());
+    const auto deinterleave = SoapySDR::ConverterRegistry::getDeinterleaveFunction(format, format);
+    const auto interleave = SoapySDR::ConverterRegistry::getInterleaveFunction(format, format);
+    const auto convert = SoapySDR::ConverterRegistry::getFunction(format, format, SoapySDR::ConverterRegistry::GENERIC);
+    const T hi = std::numeric_limits<T>::max(), lo = std::numeric_limits<T>::min();
+    const T in[4] = {T(hi/2+1), T(lo/2-1), T(10), T(-10)};
+    const T expected[4] = {hi, lo, T(40), T(-40)};
+    T out[4], back[4], converted[4];
+    void *outs[] = {out};
+    const void *ins[] = {in};
+    deinterleave(in, outs, 1, 1, 2, 4.0);
+    interleave(ins, back, 1, 1, 2, 4.0);
+    convert(in, converted, 2, 4.0);
+    if (not std::equal(out, out+4, expected) or not std::equal(back, back+4, expected) or not std::equal(converted, converted+4, expected))
+    {
+        printf("FAIL: %d, %d, %d, %d\n", int(out[0]), int(out[1]), int(out[2]), int(out[3]));
+        return false;
+    }
+    printf("OK\n");
+    return true;
+}
+
+//in-place capable conversions match the out-of-place result
+static bool testInPlace(void)
+{
+    printf("Test in-place conversions... ");
+    size_t numTested(0);
+    for (const auto &source : SoapySDR::ConverterRegistry::listAvailableSourceFormats())
+    {
+        for (const auto &target : SoapySDR::ConverterRegistry::listTargetFormats(source))
+        {
+            for (const auto priority : SoapySDR::ConverterRegistry::listPriorities(source, target))
+            {
+                const auto converter = SoapySDR::ConverterRegistry::getConverter(source, target, priority);
+                if (converter.inPlace != SoapySDR::ConverterRegistry::supportsInPlace(source, target, priority))
+                {
+                    printf("FAIL: %s -> %s supportsInPlace() mismatch\n", source.c_str(), target.c_str());
+                    return false;
+                }
+                if (not converter.inPlace) continue;
+
+                const size_t numElems = 1023;
+                std::vector<char> buff(numElems*converter.sourceElemSize);
+                fillRandom(buff, source);
+                std::vector<char> expected(numElems*converter.targetElemSize);
+                converter(buff.data(), expected.data(), numElems, 0.5);
+                converter(buff.data(), buff.data(), numElems, 0.5);
+                buff.resize(expected.size());
+                if (buff != expected)
+                {
+                    printf("FAIL: %s -> %s priority %d in-place mismatch\n", source.c_str(), target.c_str(), int(priority));
+                    return false;
+                }
+                numTested++;
+            }
+        }
+    }
+    if (not SoapySDR::ConverterRegistry::supportsInPlace(SOAPY_SDR_CF32, SOAPY_SDR_CS16) or
+        SoapySDR::ConverterRegistry::supportsInPlace(SOAPY_SDR_CS16, SOAPY_SDR_CF32))
+    {
+        printf("FAIL: unexpected in-place support for CF32 <> CS16\n");
+        return false;
+    }
+    printf("OK (%d conversions)\n", int(numTested));
+    return true;
+}
+
+//every pair of the generic matrix round trips through a double precision reference
+static bool testConverterMatrix(const bool isComplex)
+{
+    printf("Test %s generic matrix... ", isComplex?"complex":"real");
+    std::vector<std::string> formats;
+    for (const std::string format : {"F64", "F32", "S32", "U32", "S16", "U16", "S8", "U8"})
+    {
+        formats.push_back((isComplex?"C":"")+format);
+    }
+    const std::string reference(formats.front());
+    const size_t numElems = 1000;
+    std::vector<double> input(numElems*(isComplex?2:1));
+    for (size_t i = 0; i < input.size(); i++) input[i] = 0.9*std::sin(0.1*i);
+
+    //the tolerance is a few counts of the narrowest integer format
+    const auto resolution = [isComplex](const std::string &format)
+    {
+        if (format.find('F') != std::string::npos) return 1e-6;
+        const size_t bits = SoapySDR::formatToSize(format)*8/(isComplex?2:1);
+        return 1.0/double((1ull << (bits-1)) - 1);
+    };
+
+    for (const auto &first : formats)
+    {
+        for (const auto &second : formats)
+        {
+            for (const double scaler : {1.0, 0.5})
+            {
+                const auto toFirst = SoapySDR::ConverterRegistry::getFunction(reference, first, SoapySDR::ConverterRegistry::GENERIC);
+                const auto toSecond = SoapySDR::ConverterRegistry::getFunction(first, second, SoapySDR::ConverterRegistry::GENERIC);
+                const auto toReference = SoapySDR::ConverterRegistry::getFunction(second, reference, SoapySDR::ConverterRegistry::GENERIC);
+                std::vector<char> a(numElems*SoapySDR::formatToSize(first));
+                std::vector<char> b(numElems*SoapySDR::formatToSize(second));
+                std::vector<double> output(input.size());
+                toFirst(input.data(), a.data(), numElems, 1.0);
+                toSecond(a.data(), b.data(), numElems, scaler);
+                toReference(b.data(), output.data(), numElems, 1.0);
+
+                const double tolerance = 3*std::max(resolution(first), resolution(second));
+                for (size_t i = 0; i < input.size(); i++)
+                {
+                    if (std::abs(output[i] - input[i]*scaler) <= tolerance) continue;
+                    printf("FAIL: %s -> %s scaler %g index %d %f != %f\n",
+                        first.c_str(), second.c_str(), scaler, int(i), output[i], input[i]*scaler);
+                    return false;
+                }
+            }
+        }
+    }
+    printf("OK (%d conversions)\n", int(formats.size()*formats.size()));
+    return true;
+}
+
+//calibration selects one of the registered functions for both lookup styles
+static bool testCalibration(const std::string &source, const std::string &target)
+{
+    printf("Test %s -> %s calibration... ", source.c_str(), target.c_str());
+    const auto highest = SoapySDR::ConverterRegistry::getFunction(source, target);
+    SoapySDR::ConverterRegistry::setCalibrationMode(true);
+    const auto converter = SoapySDR::ConverterRegistry::getConverter(source, target);
+    const auto sourceId = SoapySDR::ConverterRegistry::getFormatId(source);
+    const auto targetId = SoapySDR::ConverterRegistry::getFormatId(target);
+    const bool idMatches = (SoapySDR::ConverterRegistry::getFunction(sourceId, targetId) == converter.function);
+    SoapySDR::ConverterRegistry::setCalibrationMode(false);
+
+    if (converter.function != SoapySDR::ConverterRegistry::getFunction(source, target, converter.priority))
+    {
+        printf("FAIL: calibrated priority mismatch\n");
+        return false;
+    }
+    if (not idMatches)
+    {
+        printf("FAIL: getFunction(FormatId) mismatch\n");
+        return false;
+    }
+    if (SoapySDR::ConverterRegistry::getFunction(sourceId, targetId) != highest)
+    {
+        printf("FAIL: highest priority not restored\n");
+        return false;
+    }
+    printf("OK (priority %d)\n", int(converter.priority));
+    return true;
+}
+
+//the pool output matches a serial conversion of each channel
+static bool testConverterPool(const size_t numThreads, const size_t numChans, const size_t numElems)
+{
+    printf("Test pool threads=%d chans=%d elems=%d... ", int(numThreads), int(numChans), int(numElems));
+    const auto converter = SoapySDR::ConverterRegistry::getConverter(SOAPY_SDR_CF32, SOAPY_SDR_CS16);
+    std::vector<std::vector<char>> src(numChans), dst0(numChans), dst1(numChans);
+    std::vector<const void *> srcBuffs;
+    std::vector<void *> dstBuffs;
+    for (size_t ch = 0; ch < numChans; ch++)
+    {
+        src[ch].resize(numElems*converter.sourceElemSize);
+        dst0[ch].resize(numElems*converter.targetElemSize);
+        dst1[ch].resize(numElems*converter.targetElemSize);
+        fillRandom(src[ch], SOAPY_SDR_CF32);
+        converter(src[ch].data(), dst0[ch].data(), numElems);
+        srcBuffs.push_back(src[ch].data());
+        dstBuffs.push_back(dst1[ch].data());
+    }
+
+    SoapySDR::ConverterPool pool(numThreads);
+    for (size_t i = 0; i < 3; i++)
+    {
+        pool.convert(converter, srcBuffs.data(), dstBuffs.data(), numChans, numElems);
+        for (size_t ch = 0; ch < numChans; ch++)
+        {
+            if (dst0[ch] == dst1[ch]) continue;
+            printf("FAIL: channel %d mismatch\n", int(ch));
+            return false;
+        }
+    }
+    printf("OK\n");
+    return true;
+}
+
+static bool testConvertersC(void)
+{
+    size_t numTargets = 0;
+    char **targets = SoapySDRConverter_listTargetFormats(SOAPY_SDR_CS16, &numTargets);
+    const auto expected = SoapySDR::ConverterRegistry::listTargetFormats(SOAPY_SDR_CS16);
+    bool ok = (numTargets == expected.size());
+    for (size_t i = 0; ok and i < numTargets; i++) ok = (expected[i] == targets[i]);
+    SoapySDRStrings_clear(&targets, numTargets);
+    if (not ok)
+    {
+        printf("FAIL: SoapySDRConverter_listTargetFormats() returned %d formats\n", int(numTargets));
+        return false;
+    }
+
+    size_t numPriorities = 0;
+    auto priorities = SoapySDRConverter_listPriorities(SOAPY_SDR_CS16, SOAPY_SDR_CF32, &numPriorities);
+    const bool hasGeneric = std::find(priorities, priorities+numPriorities, SOAPY_SDR_CONVERTER_GENERIC) != priorities+numPriorities;
+    free(priorities);
+
+    const auto function = SoapySDRConverter_getFunction(SOAPY_SDR_CS16, SOAPY_SDR_CF32);
+    const auto expectedFunction = SoapySDR::ConverterRegistry::getFunction(SOAPY_SDR_CS16, SOAPY_SDR_CF32);
+    const auto generic = SoapySDRConverter_getFunctionWithPriority(SOAPY_SDR_CS16, SOAPY_SDR_CF32, SOAPY_SDR_CONVERTER_GENERIC);
+    if (not hasGeneric or function != expectedFunction or generic == nullptr)
+    {
+        printf("FAIL: SoapySDRConverter_getFunction() CS16 to CF32\n");
+        return false;
+    }
+
+    const int16_t in[2] = {16384, -16384};
+    float out[2] = {0.0f, 0.0f};
+    function(in, out, 1, 1.0);
+    if (std::abs(out[0]-0.5f) > 1e-4f or std::abs(out[1]+0.5f) > 1e-4f)
+    {
+        printf("FAIL: SoapySDRConverter_getFunction() converted to %f, %f\n", out[0], out[1]);
+        return false;
+    }
+
+    if (SoapySDRConverter_getFunction("NOT_A_FORMAT", SOAPY_SDR_CF32) != nullptr)
+    {
+        printf("FAIL: SoapySDRConverter_getFunction() unknown format\n");
+        return false;
+    }
+    return true;
+}
+
+int main(void)
+{
+    const std::vector<std::pair<std::string, std::string>> paths{
+        {SOAPY_SDR_CF32, SOAPY_SDR_CS16}, {SOAPY_SDR_CS16, SOAPY_SDR_CF32},
+        {SOAPY_SDR_CF32, SOAPY_SDR_CU16}, {SOAPY_SDR_CU16, SOAPY_SDR_CF32},
+        {SOAPY_SDR_CF32, SOAPY_SDR_CS8}, {SOAPY_SDR_CS8, SOAPY_SDR_CF32},
+        {SOAPY_SDR_CF32, SOAPY_SDR_CU8}, {SOAPY_SDR_CU8, SOAPY_SDR_CF32},
+        {SOAPY_SDR_S8, SOAPY_SDR_F32}, {SOAPY_SDR_U8, SOAPY_SDR_F32},
+    };
+
+    for (const auto &path : paths)
+    {
+        if (not testConverterHandle(path.first, path.second)) return EXIT_FAILURE;
+        for (const auto priority : SoapySDR::ConverterRegistry::listPriorities(path.first, path.second))
+        {
+            if (priority == SoapySDR::ConverterRegistry::GENERIC) continue;
+            if (not testPriority(path.first, path.second, priority)) return EXIT_FAILURE;
+        }
+    }
+
+    if (not testOutOfRange<int16_t>(SOAPY_SDR_CS16, 32767, -32768, 0)) return EXIT_FAILURE;
+    if (not testOutOfRange<uint16_t>(SOAPY_SDR_CU16, 0xffff, 0, 0x8000)) return EXIT_FAILURE;
+    if (not testOutOfRange<int8_t>(SOAPY_SDR_CS8, 127, -128, 0)) return EXIT_FAILURE;
+    if (not testOutOfRange<uint8_t>(SOAPY_SDR_CU8, 0xff, 0, 0x80)) return EXIT_FAILURE;
+
+    //unregistered conversions throw for both lookup styles
+    const auto unknownId = SoapySDR::ConverterRegistry::getFormatId("UNKNOWN");
+    try
+    {
+        SoapySDR::ConverterRegistry::getFunction(unknownId, SoapySDR::ConverterRegistry::getFormatId(SOAPY_SDR_CF32));
+        printf("FAIL: expected getFunction(FormatId) to throw\n");
+        return EXIT_FAILURE;
+    }
+    catch (const std::runtime_error &) {}
+
+    if (not testFormatIds()) return EXIT_FAILURE;
+    if (not testConcurrentRegistration()) return EXIT_FAILURE;
+    if (not testConvertersC()) return EXIT_FAILURE;
+    if (not testInPlace()) return EXIT_FAILURE;
+    if (not testConverterMatrix(false)) return EXIT_FAILURE;
+    if (not testConverterMatrix(true)) return EXIT_FAILURE;
+    if (not testCalibration(SOAPY_SDR_CF32, SOAPY_SDR_CS16)) return EXIT_FAILURE;
+    if (not testCalibration(SOAPY_SDR_CU8, SOAPY_SDR_CF32)) return EXIT_FAILURE;
+    if (not testDeinterleave(SOAPY_SDR_CS16, SOAPY_SDR_CF32, 4, 4)) return EXIT_FAILURE;
+    if (not testDeinterleave(SOAPY_SDR_CU8, SOAPY_SDR_CF32, 2, 3)) return EXIT_FAILURE;
+    if (not testDeinterleave(SOAPY_SDR_CF32, SOAPY_SDR_CS8, 3, 3)) return EXIT_FAILURE;
+    if (not testDeinterleaveSaturates<int16_t>(SOAPY_SDR_CS16)) return EXIT_FAILURE;
+    if (not testDeinterleaveSaturates<int8_t>(SOAPY_SDR_CS8)) return EXIT_FAILURE;
+    if (not testConverterPool(1, 4, 1000)) return EXIT_FAILURE;
+    if (not testConverterPool(4, 16, 1000)) return EXIT_FAILURE;
+    if (not testConverterPool(4, 2, 100000)) return EXIT_FAILURE;
+    if (not testConverterPool(0, 3, 12345)) return EXIT_FAILURE;
+
+    printf("DONE!\n");
+    return EXIT_SUCCESS;
+}
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: BSL-1.0
 
 #include <SoapySDR/Types.hpp>
+#include <SoapySDR/FlatKwargs.hpp>
 #include <cstdlib>
 #include <cstdio>
 
@@ -71,6 +72,32 @@ int main(void)
     checkArgsEq(SoapySDR::KwargsFromString(SoapySDR::KwargsToString(args1)), args1);
     checkArgsEq(SoapySDR::KwargsFromString(SoapySDR::KwargsToString(args2)), args2);
 
+    //flat args convert losslessly and compare by contents
+    const char *markups[] = {"", " ", "Foo=Bar", " Foo = Bar, ", "Foo=Bar, Baz=123", "Baz= ,Foo = Bar , ", "Baz,Foo = Bar", "a=1, a=2, b=3"};
+    for (const auto markup : markups)
+    {
+        printf("Test flat markup \"%s\"\n", markup);
+        const auto args = SoapySDR::KwargsFromString(markup);
+        const auto flat = SoapySDR::FlatKwargs::fromString(markup);
+        checkArgsEq(flat.toKwargs(), args);
+        if (flat != SoapySDR::FlatKwargs(args) or flat.hash() != SoapySDR::FlatKwargs(args).hash())
+        {
+            printf("FAIL: FlatKwargs(%s) mismatch\n", markup);
+            return EXIT_FAILURE;
+        }
+        if (flat.toString() != SoapySDR::KwargsToString(args))
+        {
+            printf("FAIL: FlatKwargs(%s).toString() = %s\n", markup, flat.toString().c_str());
+            return EXIT_FAILURE;
+        }
+    }
+    const auto flat1 = SoapySDR::FlatKwargs(args1);
+    if (flat1.find("Baz") == nullptr or *flat1.find("Baz") != "123" or flat1.find("Bar") != nullptr or flat1 == SoapySDR::FlatKwargs(args2))
+    {
+        printf("FAIL: FlatKwargs find or compare\n");
+        return EXIT_FAILURE;
+    }
+
     printf("DONE!\n");
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,179 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/Device.hpp>
+#include <SoapySDR/Modules.hpp>
+#include <SoapySDR/Recording.hpp>
+#include <SoapySDR/Formats.hpp>
+#include <SoapySDR/Errors.hpp>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+#include <chrono>
+#include <fstream>
+#include <vector>
+#include <string>
+
+/***********************************************************************
+ * A CS16 ramp recording in two captures with hardware times
+ **********************************************************************/
+static const size_t numSamples = 3000;
+
+static short rampAt(const size_t i)
+{
+    return short((i*7) % 30000);
+}
+
+static void writeRecording(void)
+{
+    std::vector<short> samples(2*numSamples);
+    for (size_t i = 0; i < samples.size(); i++) samples[i] = rampAt(i);
+    std::ofstream file("test_replay.sigmf-data", std::ios::binary);
+    file.write(reinterpret_cast<const char *>(samples.data()), samples.size()*sizeof(short));
+
+    SoapySDR::SigMFMeta meta;
+    meta.format = SOAPY_SDR_CS16;
+    meta.sampleRate = 1e6;
+    meta.captures.resize(2);
+    meta.captures[0].frequency = 100e6;
+    meta.captures[0].hasTime = true;
+    meta.captures[0].timeNs = 1000000000;
+    meta.captures[1].sampleStart = 2000;
+    meta.captures[1].frequency = 100e6;
+    meta.captures[1].hasTime = true;
+    meta.captures[1].timeNs = 5000000000;
+    meta.save("test_replay.sigmf-meta");
+}
+
+struct ReplayRead
+{
+    int ret;
+    int flags;
+    long long timeNs;
+};
+
+static std::vector<ReplayRead> readAll(SoapySDR::Device *device, SoapySDR::Stream *stream, std::vector<short> &out, const size_t numReads)
+{
+    std::vector<ReplayRead> reads;
+    size_t offset(0);
+    for (size_t i = 0; i < numReads; i++)
+    {
+        void *buffs[] = {out.data() + 2*offset};
+        ReplayRead read;
+        read.ret = device->readStream(stream, buffs, (out.size()/2) - offset, read.flags, read.timeNs, 100000);
+        reads.push_back(read);
+        if (read.ret > 0) offset += size_t(read.ret);
+    }
+    return reads;
+}
+
+static bool testCapturesAndEnd(void)
+{
+    auto device = SoapySDR::Device::make("driver=replay,file=test_replay,paced=false,mtu=1500");
+    auto stream = device->setupStream(SOAPY_SDR_RX, SOAPY_SDR_CS16);
+    device->activateStream(stream);
+    std::vector<short> out(2*numSamples);
+    const auto reads = readAll(device, stream, out, 4);
+    const double frequency = device->getFrequency(SOAPY_SDR_RX, 0);
+    device->deactivateStream(stream);
+    device->closeStream(stream);
+    SoapySDR::Device::unmake(device);
+
+    //reads split at the capture boundary and end the burst at the end of the file
+    const bool readsOk =
+        reads[0].ret == 1500 and reads[0].timeNs == 1000000000 and
+        reads[1].ret == 500 and reads[1].timeNs == 1001500000 and
+        reads[2].ret == 1000 and reads[2].timeNs == 5000000000 and (reads[2].flags & SOAPY_SDR_END_BURST) != 0 and
+        reads[3].ret == SOAPY_SDR_TIMEOUT;
+    bool dataOk = true;
+    for (size_t i = 0; i < out.size() and dataOk; i++) dataOk = out[i] == rampAt(i);
+
+    if (not readsOk or not dataOk or frequency != 100e6)
+    {
+        printf("FAIL: replay reads %d@%lld %d@%lld %d@%lld %d, data=%d, freq=%g\n",
+            reads[0].ret, reads[0].timeNs, reads[1].ret, reads[1].timeNs, reads[2].ret, reads[2].timeNs, reads[3].ret, int(dataOk), frequency);
+        return false;
+    }
+    return true;
+}
+
+static bool testDirectAndConvert(void)
+{
+    auto device = SoapySDR::Device::make("driver=replay,file=test_replay,paced=false,loop=true");
+
+    //direct buffers in the file format are the mapped samples
+    auto direct = device->setupStream(SOAPY_SDR_RX, SOAPY_SDR_CS16);
+    device->activateStream(direct);
+    size_t handle(0);
+    const void *buffs[1] = {nullptr};
+    int flags(0);
+    long long timeNs(0);
+    const int directRet = device->acquireReadBuffer(direct, handle, buffs, flags, timeNs, 100000);
+    const bool directOk = directRet == 2000 and static_cast<const short *>(buffs[0])[2*1999+1] == rampAt(2*1999+1);
+    if (directRet > 0) device->releaseReadBuffer(direct, handle);
+    device->deactivateStream(direct);
+    device->closeStream(direct);
+
+    //other formats are converted, and a loop continues the timestamps
+    auto convert = device->setupStream(SOAPY_SDR_RX, SOAPY_SDR_CF32);
+    device->activateStream(convert);
+    std::vector<float> out(2*numSamples);
+    void *outs[] = {out.data()};
+    long long loopTimeNs(0);
+    for (size_t i = 0; i < 2; i++) device->readStream(convert, outs, numSamples, flags, loopTimeNs, 100000);
+    const int convertRet = device->readStream(convert, outs, numSamples, flags, timeNs, 100000);
+    const bool convertOk = convertRet == 2000 and std::abs(out[3] - rampAt(3)/32768.0f) < 1e-3f and timeNs == 1003000000;
+    device->deactivateStream(convert);
+    device->closeStream(convert);
+    SoapySDR::Device::unmake(device);
+
+    if (not directOk or not convertOk)
+    {
+        printf("FAIL: replay direct=%d (%d), convert=%d (%d@%lld)\n", int(directOk), directRet, int(convertOk), convertRet, timeNs);
+        return false;
+    }
+    return true;
+}
+
+static bool testPaced(void)
+{
+    auto device = SoapySDR::Device::make("driver=replay,file=test_replay,paced=true");
+    device->setSampleRate(SOAPY_SDR_RX, 0, 200e3);
+    auto stream = device->setupStream(SOAPY_SDR_RX, SOAPY_SDR_CS16);
+    const auto start = std::chrono::steady_clock::now();
+    device->activateStream(stream);
+    std::vector<short> out(2*numSamples);
+    size_t total(0);
+    for (size_t i = 0; i < 100 and total < numSamples; i++)
+    {
+        const auto reads = readAll(device, stream, out, 1);
+        if (reads[0].ret > 0) total += size_t(reads[0].ret);
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    device->deactivateStream(stream);
+    device->closeStream(stream);
+    SoapySDR::Device::unmake(device);
+
+    //3000 samples at 200 ksps take 15 ms
+    if (total != numSamples or elapsed < 0.014)
+    {
+        printf("FAIL: replay paced %d samples in %g seconds\n", int(total), elapsed);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1) SoapySDR::loadModule(argv[1]);
+    writeRecording();
+
+    bool ok = true;
+    ok = ok and testCapturesAndEnd();
+    ok = ok and testDirectAndConvert();
+    ok = ok and testPaced();
+    std::remove("test_replay.sigmf-data");
+    std::remove("test_replay.sigmf-meta");
+    printf("DONE!\n");
+    return ok?EXIT_SUCCESS:EXIT_FAILURE;
+}
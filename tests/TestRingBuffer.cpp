@@ -0,0 +1,80 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/RingBuffer.hpp>
+#include <cstdlib>
+#include <cstdio>
+#include <thread>
+
+static bool testHandoff(const bool busyPoll)
+{
+    const size_t numItems = 100000;
+    SoapySDR::RingBuffer<size_t> ring(8, busyPoll);
+
+    std::thread producer([&ring, numItems](void){
+        for (size_t i = 0; i < numItems; i++)
+        {
+            size_t handle(0);
+            size_t *slot = nullptr;
+            while (slot == nullptr) slot = ring.acquireWrite(handle, 100000);
+            *slot = i;
+            ring.releaseWrite(handle);
+        }
+    });
+
+    bool ok = true;
+    for (size_t i = 0; i < numItems and ok; i++)
+    {
+        size_t handle(0);
+        const size_t *slot = nullptr;
+        while (slot == nullptr) slot = ring.acquireRead(handle, 100000);
+        if (*slot != i or handle != i % ring.capacity())
+        {
+            printf("FAIL: RingBuffer(busyPoll=%d) read %d at handle %d, expected %d\n", int(busyPoll), int(*slot), int(handle), int(i));
+            ok = false;
+        }
+        ring.releaseRead(handle);
+    }
+    producer.join();
+    return ok;
+}
+
+static bool testMultipleAcquire(void)
+{
+    SoapySDR::RingBuffer<int> ring(4);
+    size_t handles[5];
+    for (size_t i = 0; i < 4; i++)
+    {
+        if (ring.acquireWrite(handles[i]) != nullptr) continue;
+        printf("FAIL: RingBuffer acquireWrite() %d failed\n", int(i));
+        return false;
+    }
+    if (ring.acquireWrite(handles[4], 1000) != nullptr)
+    {
+        printf("FAIL: RingBuffer acquireWrite() past capacity\n");
+        return false;
+    }
+    if (ring.acquireRead(handles[4]) != nullptr)
+    {
+        printf("FAIL: RingBuffer acquireRead() before release\n");
+        return false;
+    }
+    ring.releaseWrite(handles[0]);
+    ring.releaseWrite(handles[1]);
+    if (ring.size() != 2)
+    {
+        printf("FAIL: RingBuffer size() %d, expected 2\n", int(ring.size()));
+        return false;
+    }
+    return true;
+}
+
+int main(void)
+{
+    bool ok = true;
+    ok = ok and testMultipleAcquire();
+    ok = ok and testHandoff(false);
+    ok = ok and testHandoff(true);
+    printf("DONE!\n");
+    return ok?EXIT_SUCCESS:EXIT_FAILURE;
+}
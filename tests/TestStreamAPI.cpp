@@ -0,0 +1,1478 @@
+// Copyright (c) 2018-2018 Josh Blum
+// SPDX-License-Identifier: BSL-1.0
+
+#include <SoapySDR/Device.hpp>
+#include <SoapySDR/Device.h>
+#include <SoapySDR/Registry.hpp>
+#include <SoapySDR/Version.hpp>
+#include <SoapySDR/Tracer.hpp>
+#include <SoapySDR/ThreadHints.hpp>
+#include <SoapySDR/Buffers.hpp>
+#include <SoapySDR/Recording.hpp>
+#include <SoapySDR/AsyncReader.hpp>
+#include <SoapySDR/BurstScheduler.hpp>
+#include <SoapySDR/Scanner.hpp>
+#include <SoapySDR/Errors.hpp>
+#include <SoapySDR/Constants.h>
+#include <SoapySDR/Formats.hpp>
+#include <SoapySDR/Time.hpp>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <complex>
+#include <vector>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <atomic>
+#include <mutex>
+#include <map>
+#include <algorithm>
+#include <stdexcept>
+#include <fstream>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <poll.h>
+#endif
+
+/***********************************************************************
+ * A device with a fixed number of packets ready to read
+ * and a write limit after which the writes are partial
+ **********************************************************************/
+class PacketDevice : public SoapySDR::Device
+{
+public:
+    PacketDevice(const size_t numReady, const size_t writeLimit):
+        numReady(numReady),
+        writeLimit(writeLimit),
+        numReads(0),
+        numWrites(0),
+        lastTimeoutUs(-1),
+        emptyError(SOAPY_SDR_TIMEOUT)
+    {
+        return;
+    }
+
+    int readStream(SoapySDR::Stream *, void * const *, const size_t numElems, int &flags, long long &timeNs, const long timeoutUs)
+    {
+        lastTimeoutUs = timeoutUs;
+        if (numReads == numReady) return emptyError;
+        flags = SOAPY_SDR_HAS_TIME;
+        timeNs = (long long)(numReads++)*1000;
+        return int(numElems);
+    }
+
+    int writeStream(SoapySDR::Stream *, const void * const *, const size_t numElems, int &flags, const long long, const long)
+    {
+        flags = 0;
+        const size_t allowed = (numWrites < writeLimit)?numElems:numElems/2;
+        numWrites++;
+        return int(allowed);
+    }
+
+    size_t numReady, writeLimit;
+    size_t numReads, numWrites;
+    long lastTimeoutUs;
+    int emptyError;
+};
+
+static bool testReadBatch(void)
+{
+    PacketDevice device(3, 0);
+    std::vector<char> mem(8*16);
+    std::vector<void *> chans(8);
+    std::vector<void * const *> buffs(8);
+    for (size_t i = 0; i < 8; i++)
+    {
+        chans[i] = mem.data()+i*16;
+        buffs[i] = &chans[i];
+    }
+    std::vector<size_t> elems(8);
+    std::vector<int> flags(8);
+    std::vector<long long> timeNs(8);
+
+    const int ret = device.readStreamBatch(nullptr, buffs.data(), 8, 16, elems.data(), flags.data(), timeNs.data(), 1000);
+    if (ret != 3)
+    {
+        printf("FAIL: readStreamBatch() returned %d, expected 3\n", ret);
+        return false;
+    }
+    for (size_t i = 0; i < 3; i++)
+    {
+        if (elems[i] == 16 and flags[i] == SOAPY_SDR_HAS_TIME and timeNs[i] == (long long)(i*1000)) continue;
+        printf("FAIL: readStreamBatch() buffer %d: elems=%d, flags=%d, timeNs=%lld\n", int(i), int(elems[i]), flags[i], timeNs[i]);
+        return false;
+    }
+    if (device.lastTimeoutUs != 0)
+    {
+        printf("FAIL: readStreamBatch() waited after the first read\n");
+        return false;
+    }
+
+    //an empty stream reports the error of the first read
+    const int err = device.readStreamBatch(nullptr, buffs.data(), 8, 16, elems.data(), flags.data(), timeNs.data(), 1000);
+    if (err != SOAPY_SDR_TIMEOUT)
+    {
+        printf("FAIL: readStreamBatch() returned %d, expected SOAPY_SDR_TIMEOUT\n", err);
+        return false;
+    }
+
+    //an error after the first buffer is returned by the next batch, the flags and times are optional
+    PacketDevice overflowDevice(2, 0);
+    overflowDevice.emptyError = SOAPY_SDR_OVERFLOW;
+    const int partial = overflowDevice.readStreamBatch(nullptr, buffs.data(), 8, 16, elems.data(), nullptr, nullptr, 1000);
+    overflowDevice.numReady = 4;
+    const int stashed = overflowDevice.readStreamBatch(nullptr, buffs.data(), 8, 16, elems.data(), nullptr, nullptr, 1000);
+    const int next = overflowDevice.readStreamBatch(nullptr, buffs.data(), 8, 16, elems.data(), nullptr, nullptr, 1000);
+    if (partial != 2 or stashed != SOAPY_SDR_OVERFLOW or next != 2)
+    {
+        printf("FAIL: readStreamBatch() error after the first buffer returned %d, %d, %d\n", partial, stashed, next);
+        return false;
+    }
+    return true;
+}
+
+static bool testWriteBatch(void)
+{
+    PacketDevice device(0, 2);
+    std::vector<char> mem(4*16);
+    std::vector<const void *> chans(4);
+    std::vector<const void * const *> buffs(4);
+    for (size_t i = 0; i < 4; i++)
+    {
+        chans[i] = mem.data()+i*16;
+        buffs[i] = &chans[i];
+    }
+    std::vector<size_t> numElems(4, 16), elems(4);
+    std::vector<int> flags(4, 0);
+    std::vector<long long> timeNs(4, 0);
+
+    //the third buffer is partially written and ends the batch
+    const int ret = device.writeStreamBatch(nullptr, buffs.data(), 4, numElems.data(), elems.data(), flags.data(), timeNs.data(), 1000);
+    if (ret != 3 or elems[0] != 16 or elems[1] != 16 or elems[2] != 8 or device.numWrites != 3)
+    {
+        printf("FAIL: writeStreamBatch() returned %d, elems=%d/%d/%d\n", ret, int(elems[0]), int(elems[1]), int(elems[2]));
+        return false;
+    }
+
+    //the flags and times are optional
+    PacketDevice unlimited(0, 4);
+    if (unlimited.writeStreamBatch(nullptr, buffs.data(), 4, numElems.data(), elems.data(), nullptr, nullptr, 1000) != 4)
+    {
+        printf("FAIL: writeStreamBatch() without flags or times\n");
+        return false;
+    }
+    return true;
+}
+
+/***********************************************************************
+ * A driver with only a synchronous readStream()
+ **********************************************************************/
+static SoapySDR::KwargsList findPacketDevice(const SoapySDR::Kwargs &args)
+{
+    if (args.count("driver") != 0 and args.at("driver") != "packet") return SoapySDR::KwargsList();
+    SoapySDR::Kwargs result;
+    result["driver"] = "packet";
+    return SoapySDR::KwargsList(1, result);
+}
+
+static SoapySDR::Device *makePacketDevice(const SoapySDR::Kwargs &)
+{
+    return new PacketDevice(5, 0);
+}
+
+static SoapySDR::Registry registerPacketDevice("packet", &findPacketDevice, &makePacketDevice, SOAPY_SDR_ABI_VERSION);
+
+//a burst of five reads, then a timeout
+static bool testStreamStats(void)
+{
+    auto device = SoapySDR::Device::make("driver=null,type=null");
+    auto stream = device->setupStream(SOAPY_SDR_RX, SOAPY_SDR_CF32);
+    device->activateStream(stream, 0, 0, 5*64);
+    std::vector<char> mem(64*8);
+    void *buffs[1] = {mem.data()};
+    int flags(0);
+    long long timeNs(0);
+    for (size_t i = 0; i < 6; i++) device->readStream(stream, buffs, 64, flags, timeNs, 1000);
+
+    SoapySDR::StreamStats stats;
+    const int ret = device->getStreamStats(stream, stats);
+    device->closeStream(stream);
+    SoapySDR::Device::unmake(device);
+    if (ret != 0 or stats.numCalls != 6 or stats.numElems != 5*64 or stats.bufferFill >= 0.0)
+    {
+        printf("FAIL: getStreamStats() returned %d, numCalls=%d, numElems=%d\n", ret, int(stats.numCalls), int(stats.numElems));
+        return false;
+    }
+    return true;
+}
+
+//the latency_stats stream arg measures the timestamps against the hardware time
+static bool testStreamTimeLatency(void)
+{
+    auto device = SoapySDR::Device::make("driver=null,type=null,paced=true");
+    device->setSampleRate(SOAPY_SDR_RX, 0, 1e6);
+    auto measured = device->setupStream(SOAPY_SDR_RX, SOAPY_SDR_CF32, std::vector<size_t>(), SoapySDR::KwargsFromString("latency_stats=true"));
+    auto unmeasured = device->setupStream(SOAPY_SDR_RX, SOAPY_SDR_CF32);
+    device->activateStream(measured);
+    device->activateStream(unmeasured);
+    std::vector<std::complex<float>> mem(1000);
+    void *buffs[1] = {mem.data()};
+    size_t numReads(0);
+    for (size_t i = 0; i < 10; i++)
+    {
+        int flags(0);
+        long long timeNs(0);
+        if (device->readStream(measured, buffs, mem.size(), flags, timeNs) > 0) numReads++;
+        device->readStream(unmeasured, buffs, mem.size(), flags, timeNs);
+    }
+
+    SoapySDR::StreamStats stats, unmeasuredStats;
+    device->getStreamStats(measured, stats);
+    device->getStreamStats(unmeasured, unmeasuredStats);
+    device->deactivateStream(measured);
+    device->deactivateStream(unmeasured);
+    device->closeStream(measured);
+    device->closeStream(unmeasured);
+    SoapySDR::Device::unmake(device);
+
+    //a paced read returns once the last sample's time has passed
+    if (stats.numTimestamps != numReads or numReads == 0 or unmeasuredStats.numTimestamps != 0 or
+        stats.minTimeLatencyNs < 0 or stats.minTimeLatencyNs > stats.avgTimeLatencyNs or
+        stats.avgTimeLatencyNs > stats.maxTimeLatencyNs or stats.p99TimeLatencyNs < stats.minTimeLatencyNs or
+        stats.p99TimeLatencyNs > stats.maxTimeLatencyNs)
+    {
+        printf("FAIL: time latency %d timestamps, min=%lld, avg=%lld, p99=%lld, max=%lld\n", int(stats.numTimestamps),
+            stats.minTimeLatencyNs, stats.avgTimeLatencyNs, stats.p99TimeLatencyNs, stats.maxTimeLatencyNs);
+        return false;
+    }
+    return true;
+}
+
+/***********************************************************************
+ * The stream calls emit matched trace events
+ **********************************************************************/
+class CountingTracer : public SoapySDR::Tracer
+{
+public:
+    CountingTracer(void): numBegin(0), numEnd(0), numReads(0){}
+
+    void begin(const char *name, const char *)
+    {
+        numBegin++;
+        if (std::string(name) == "readStream") numReads++;
+    }
+
+    void end(const char *, const char *)
+    {
+        numEnd++;
+    }
+
+    size_t numBegin, numEnd, numReads;
+};
+
+static bool testTracer(void)
+{
+    CountingTracer tracer;
+    SoapySDR::registerTracer(&tracer);
+    auto device = SoapySDR::Device::make("driver=null,type=null");
+    auto stream = device->setupStream(SOAPY_SDR_RX, SOAPY_SDR_CF32);
+    device->activateStream(stream);
+    std::vector<char> mem(64*8);
+    void *buffs[1] = {mem.data()};
+    int flags(0);
+    long long timeNs(0);
+    for (size_t i = 0; i < 3; i++) device->readStream(stream, buffs, 64, flags, timeNs);
+    device->deactivateStream(stream);
+    device->closeStream(stream);
+    SoapySDR::Device::unmake(device);
+    SoapySDR::registerTracer(nullptr);
+
+    if (tracer.numReads != 3 or tracer.numBegin != tracer.numEnd or tracer.numBegin < 7)
+    {
+        printf("FAIL: tracer numBegin=%d, numEnd=%d, numReads=%d\n", int(tracer.numBegin), int(tracer.numEnd), int(tracer.numReads));
+        return false;
+    }
+    return true;
+}
+
+/***********************************************************************
+ * Different devices open in parallel, duplicate args share a device
+ **********************************************************************/
+static SoapySDR::KwargsList findSlowDevice(const SoapySDR::Kwargs &args)
+{
+    if (args.count("driver") == 0 or args.at("driver") != "slow") return SoapySDR::KwargsList();
+    SoapySDR::Kwargs result;
+    result["serial"] = args.at("serial");
+    return SoapySDR::KwargsList(1, result);
+}
+
+static SoapySDR::Device *makeSlowDevice(const SoapySDR::Kwargs &)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    return new SoapySDR::Device();
+}
+
+static SoapySDR::Registry registerSlowDevice("slow", &findSlowDevice, &makeSlowDevice, SOAPY_SDR_ABI_VERSION);
+
+static bool testParallelMake(void)
+{
+    const char *args[4] = {"driver=slow, serial=0", "driver=slow, serial=0", "driver=slow, serial=1", "driver=slow, serial=1"};
+    SoapySDR::Device *devices[4];
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < 4; i++) threads.push_back(std::thread([&devices, &args, i](void){
+        devices[i] = SoapySDR::Device::make(args[i]);
+    }));
+    for (auto &thread : threads) thread.join();
+    const auto elapsed = std::chrono::steady_clock::now()-start;
+    for (size_t i = 0; i < 4; i++) SoapySDR::Device::unmake(devices[i]);
+
+    if (devices[0] != devices[1] or devices[2] != devices[3] or devices[0] == devices[2])
+    {
+        printf("FAIL: parallel make() did not share devices by args\n");
+        return false;
+    }
+    if (elapsed > std::chrono::milliseconds(600))
+    {
+        printf("FAIL: parallel make() took %d ms\n", int(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()));
+        return false;
+    }
+    return true;
+}
+
+/***********************************************************************
+ * Cached enumeration results until invalidated
+ **********************************************************************/
+static size_t numCountedFinds = 0;
+
+static SoapySDR::KwargsList findCountedDevice(const SoapySDR::Kwargs &)
+{
+    numCountedFinds++;
+    return SoapySDR::KwargsList(1);
+}
+
+static SoapySDR::Registry registerCountedDevice("counted", &findCountedDevice, &makePacketDevice, SOAPY_SDR_ABI_VERSION);
+
+static bool testEnumerateCache(void)
+{
+    SoapySDR::Device::setEnumerateCacheTTL(10.0);
+    SoapySDR::Device::enumerate("driver=counted");
+    const auto results = SoapySDR::Device::enumerate("driver=counted");
+    const size_t numCached = numCountedFinds;
+    SoapySDR::Device::invalidateEnumerateCache("counted");
+    SoapySDR::Device::enumerate("driver=counted");
+    SoapySDR::Device::setEnumerateCacheTTL(0.0);
+
+    if (numCached != 1 or numCountedFinds != 2 or results.size() != 1 or results[0].at("driver") != "counted")
+    {
+        printf("FAIL: enumerate cache numCached=%d, numFinds=%d\n", int(numCached), int(numCountedFinds));
+        return false;
+    }
+    return true;
+}
+
+/***********************************************************************
+ * Batch make shares an enumeration and cleans up on failure
+ **********************************************************************/
+static std::atomic<int> numBatchDevices(0);
+
+class BatchDevice : public SoapySDR::Device
+{
+public:
+    BatchDevice(void){numBatchDevices++;}
+    ~BatchDevice(void){numBatchDevices--;}
+};
+
+static SoapySDR::KwargsList findBatchDevice(const SoapySDR::Kwargs &)
+{
+    SoapySDR::KwargsList results(3);
+    for (size_t i = 0; i < results.size(); i++) results[i]["serial"] = std::to_string(i);
+    return results;
+}
+
+static SoapySDR::Device *makeBatchDevice(const SoapySDR::Kwargs &args)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    if (args.count("fail") != 0) throw std::runtime_error("batch device failed");
+    return new BatchDevice();
+}
+
+static SoapySDR::Registry registerBatchDevice("batch", &findBatchDevice, &makeBatchDevice, SOAPY_SDR_ABI_VERSION);
+
+static bool testBatchMake(void)
+{
+    SoapySDR::KwargsList argsList(3);
+    for (size_t i = 0; i < argsList.size(); i++)
+    {
+        argsList[i]["driver"] = "batch";
+        argsList[i]["serial"] = std::to_string(i);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const auto devices = SoapySDR::Device::make(argsList);
+    const auto elapsed = std::chrono::steady_clock::now()-start;
+    const int numMade = numBatchDevices;
+    SoapySDR::Device::unmake(devices);
+
+    if (devices.size() != 3 or numMade != 3 or numBatchDevices != 0)
+    {
+        printf("FAIL: batch make() made %d devices\n", numMade);
+        return false;
+    }
+    if (elapsed > std::chrono::milliseconds(500))
+    {
+        printf("FAIL: batch make() took %d ms\n", int(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()));
+        return false;
+    }
+
+    argsList[1]["fail"] = "true";
+    try
+    {
+        SoapySDR::Device::make(argsList);
+        printf("FAIL: batch make() did not throw\n");
+        return false;
+    }
+    catch (const std::runtime_error &) {}
+    if (numBatchDevices != 0)
+    {
+        printf("FAIL: batch make() left %d devices\n", int(numBatchDevices));
+        return false;
+    }
+    return true;
+}
+
+/***********************************************************************
+ * The default settings commit replays each command in order
+ **********************************************************************/
+static std::vector<std::string> recordedSettings;
+
+class RecordingDevice : public SoapySDR::Device
+{
+public:
+    void setFrequency(const int, const size_t channel, const double frequency, const SoapySDR::Kwargs &)
+    {
+        recordedSettings.push_back("freq" + std::to_string(channel) + "=" + std::to_string(int(frequency)));
+    }
+
+    void setGain(const int, const size_t channel, const std::string &name, const double value)
+    {
+        recordedSettings.push_back(name + std::to_string(channel) + "=" + std::to_string(int(value)));
+    }
+
+    void setAntenna(const int, const size_t channel, const std::string &name)
+    {
+        recordedSettings.push_back("ant" + std::to_string(channel) + "=" + name);
+    }
+
+    void writeSetting(const std::string &key, const std::string &value)
+    {
+        recordedSettings.push_back(key + "=" + value);
+    }
+};
+
+static SoapySDR::KwargsList findRecordingDevice(const SoapySDR::Kwargs &)
+{
+    return SoapySDR::KwargsList(1);
+}
+
+static SoapySDR::Device *makeRecordingDevice(const SoapySDR::Kwargs &)
+{
+    return new RecordingDevice();
+}
+
+static SoapySDR::Registry registerRecordingDevice("recording", &findRecordingDevice, &makeRecordingDevice, SOAPY_SDR_ABI_VERSION);
+
+static bool testCommitSettings(void)
+{
+    SoapySDR::SettingsTransaction transaction;
+    transaction.setFrequency(SOAPY_SDR_RX, 0, 100);
+    transaction.setGain(SOAPY_SDR_RX, 1, "LNA", 20);
+    transaction.setAntenna(SOAPY_SDR_RX, 1, "RX2");
+    transaction.writeSetting("mode", "fast");
+
+    auto device = SoapySDR::Device::make("driver=recording");
+    device->commitSettings(transaction);
+    SoapySDR::Device::unmake(device);
+
+    const std::string result = recordedSettings.empty()?"":(recordedSettings[0]+","+recordedSettings[1]+","+recordedSettings[2]+","+recordedSettings[3]);
+    if (recordedSettings.size() != 4 or result != "freq0=100,LNA1=20,ant1=RX2,mode=fast")
+    {
+        printf("FAIL: commitSettings() recorded %d settings \"%s\"\n", int(recordedSettings.size()), result.c_str());
+        return false;
+    }
+    return true;
+}
+
+/***********************************************************************
+ * The gain model cache captures element names and ranges once
+ **********************************************************************/
+static size_t numGainQueries = 0;
+
+class GainDevice : public SoapySDR::Device
+{
+public:
+    std::vector<std::string> listGains(const int, const size_t) const
+    {
+        numGainQueries++;
+        return {"LNA", "VGA"};
+    }
+
+    SoapySDR::Range getGainRange(const int, const size_t, const std::string &) const
+    {
+        numGainQueries++;
+        return SoapySDR::Range(0.0, 10.0);
+    }
+
+    void setGain(const int, const size_t, const std::string &name, const double value)
+    {
+        gains[name] = value;
+    }
+
+    double getGain(const int, const size_t, const std::string &name) const
+    {
+        return gains.at(name);
+    }
+
+    void setAntenna(const int, const size_t, const std::string &)
+    {
+        return;
+    }
+
+    std::map<std::string, double> gains;
+};
+
+static SoapySDR::Device *makeGainDevice(const SoapySDR::Kwargs &)
+{
+    return new GainDevice();
+}
+
+static SoapySDR::Registry registerGainDevice("gain", &findRecordingDevice, &makeGainDevice, SOAPY_SDR_ABI_VERSION);
+
+static bool testGainCache(void)
+{
+    auto device = SoapySDR::Device::make("driver=gain");
+    device->enableGainCache();
+    for (size_t i = 0; i < 10; i++) device->setGain(SOAPY_SDR_RX, 0, 15.0);
+    const double gain = device->getGain(SOAPY_SDR_RX, 0);
+    const size_t numCached = numGainQueries;
+    device->setAntenna(SOAPY_SDR_RX, 0, "RX2");
+    device->setGain(SOAPY_SDR_RX, 0, 5.0);
+    const size_t numInvalidated = numGainQueries;
+    device->setGainMode(SOAPY_SDR_RX, 0, false);
+    device->setGain(SOAPY_SDR_RX, 0, 5.0);
+    const size_t numModeInvalidated = numGainQueries;
+    SoapySDR::Device::unmake(device);
+
+    if (gain != 15.0 or numCached != 3 or numInvalidated != 6 or numModeInvalidated != 9)
+    {
+        printf("FAIL: gain cache gain=%f, numCached=%d, numInvalidated=%d, numModeInvalidated=%d\n",
+            gain, int(numCached), int(numInvalidated), int(numModeInvalidated));
+        return false;
+    }
+    return true;
+}
+
+/***********************************************************************
+ * The default settings schedule applies commands in time order
+ **********************************************************************/
+static bool testScheduleSettings(void)
+{
+    recordedSettings.clear();
+    SoapySDR::SettingsTransaction transaction;
+    transaction.setCommandTime(20000000);
+    transaction.writeSetting("hop", "2");
+    transaction.setCommandTime(10000000);
+    transaction.writeSetting("hop", "1");
+    transaction.setCommandTime(10000000000);
+    transaction.writeSetting("hop", "never");
+
+    auto device = SoapySDR::Device::make("driver=recording");
+    device->scheduleSettings(transaction);
+    for (size_t i = 0; i < 1000 and device->getNumScheduledSettings() > 1; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    const size_t numPending = device->getNumScheduledSettings();
+    device->cancelScheduledSettings();
+    const size_t numCancelled = device->getNumScheduledSettings();
+    const std::string result = (recordedSettings.size() != 2)?"":(recordedSettings[0]+","+recordedSettings[1]);
+
+    //unmake cancels a pending schedule before the driver is deleted
+    device->scheduleSettings(transaction);
+    SoapySDR::Device::unmake(device);
+
+    if (numPending != 1 or numCancelled != 0 or result != "hop=1,hop=2")
+    {
+        printf("FAIL: scheduleSettings() pending=%d, cancelled=%d, recorded \"%s\"\n", int(numPending), int(numCancelled), result.c_str());
+        return false;
+    }
+    return true;
+}
+
+/***********************************************************************
+ * A setter that replaces the schedule it runs in
+ **********************************************************************/
+class RescheduleDevice : public SoapySDR::Device
+{
+public:
+    void writeSetting(const std::string &key, const std::string &value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        settings.push_back(key + "=" + value);
+        if (key != "reschedule") return;
+        SoapySDR::SettingsTransaction transaction;
+        transaction.writeSetting("fresh", "1");
+        this->scheduleSettings(transaction);
+    }
+
+    std::mutex mutex;
+    std::vector<std::string> settings;
+};
+
+static bool testRescheduleSettings(void)
+{
+    //concurrent schedules replace each other without overlapping threads
+    SoapySDR::SettingsTransaction never;
+    never.setCommandTime(10000000000);
+    never.writeSetting("hop", "never");
+    auto device = SoapySDR::Device::make("driver=recording");
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < 4; i++) threads.push_back(std::thread([device, &never](void)
+    {
+        for (size_t j = 0; j < 50; j++) device->scheduleSettings(never);
+    }));
+    for (auto &thread : threads) thread.join();
+    const size_t numPending = device->getNumScheduledSettings();
+    SoapySDR::Device::unmake(device);
+
+    //the replaced schedule stops before its later commands
+    RescheduleDevice rescheduler;
+    SoapySDR::SettingsTransaction transaction;
+    transaction.writeSetting("reschedule", "1");
+    transaction.setCommandTime(20000000);
+    transaction.writeSetting("stale", "1");
+    rescheduler.scheduleSettings(transaction);
+    for (size_t i = 0; i < 1000 and rescheduler.getNumScheduledSettings() != 0; i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(40));
+    rescheduler.cancelScheduledSettings();
+    std::string result;
+    for (const auto &setting : rescheduler.settings) result += setting + ",";
+
+    if (numPending != 1 or result != "reschedule=1,fresh=1,")
+    {
+        printf("FAIL: rescheduleSettings() pending=%d, recorded \"%s\"\n", int(numPending), result.c_str());
+        return false;
+    }
+    return true;
+}
+
+/***********************************************************************
+ * The register list defaults use the single word calls
+ **********************************************************************/
+class RegisterDevice : public SoapySDR::Device
+{
+public:
+    void writeRegister(const std::string &name, const unsigned addr, const unsigned value)
+    {
+        registers[name][addr] = value;
+    }
+
+    unsigned readRegister(const std::string &name, const unsigned addr) const
+    {
+        return registers.at(name).at(addr);
+    }
+
+    std::map<std::string, std::map<unsigned, unsigned>> registers;
+};
+
+static SoapySDR::Device *makeRegisterDevice(const SoapySDR::Kwargs &)
+{
+    return new RegisterDevice();
+}
+
+static SoapySDR::Registry registerRegisterDevice("register", &findRecordingDevice, &makeRegisterDevice, SOAPY_SDR_ABI_VERSION);
+
+static bool testRegisterList(void)
+{
+    auto device = SoapySDR::Device::make("driver=register");
+    device->writeRegisters("FPGA", 0x10, std::vector<unsigned>{1, 2, 3});
+    device->writeRegisters("FPGA", std::vector<std::pair<unsigned, unsigned>>{{0x40, 4}, {0x20, 5}, {0x40, 6}});
+    const auto block = device->readRegisters("FPGA", 0x10, 3);
+    const auto list = device->readRegisters("FPGA", std::vector<unsigned>{0x40, 0x11, 0x20});
+    SoapySDR::Device::unmake(device);
+
+    if (block != std::vector<unsigned>{1, 2, 3} or list != std::vector<unsigned>{6, 2, 5})
+    {
+        printf("FAIL: register list block size=%d, list size=%d\n", int(block.size()), int(list.size()));
+        return false;
+    }
+    return true;
+}
+
+/***********************************************************************
+ * The default sensor poller coalesces reads across subscriptions
+ **********************************************************************/
+static std::atomic<size_t> numTempReads(0);
+
+class SensorDevice : public SoapySDR::Device
+{
+public:
+    SoapySDR::ArgInfo getSensorInfo(const std::string &) const
+    {
+        SoapySDR::ArgInfo info;
+        info.type = SoapySDR::ArgInfo::FLOAT;
+        return info;
+    }
+
+    std::string readSensor(const std::string &) const
+    {
+        numTempReads++;
+        return "42.5";
+    }
+
+    SoapySDR::ArgInfo getSensorInfo(const int, const size_t, const std::string &) const
+    {
+        SoapySDR::ArgInfo info;
+        info.type = SoapySDR::ArgInfo::BOOL;
+        return info;
+    }
+
+    std::string readSensor(const int, const size_t channel, const std::string &) const
+    {
+        if (channel != 0) throw std::runtime_error("no such channel");
+        return "true";
+    }
+};
+
+static SoapySDR::Device *makeSensorDevice(const SoapySDR::Kwargs &)
+{
+    return new SensorDevice();
+}
+
+static SoapySDR::Registry registerSensorDevice("sensor", &findRecordingDevice, &makeSensorDevice, SOAPY_SDR_ABI_VERSION);
+
+static bool testSensorSubscription(void)
+{
+    typedef SoapySDR::SensorSubscription::Sensor Sensor;
+    std::atomic<size_t> numUpdates0(0), numUpdates1(0);
+
+    auto device = SoapySDR::Device::make("driver=sensor");
+    auto sub0 = device->subscribeSensors({Sensor("temp"), Sensor(SOAPY_SDR_RX, 0, "lo_locked")}, 100.0,
+        [&numUpdates0](const std::vector<SoapySDR::SensorSubscription::Value> &){numUpdates0++;});
+    auto sub1 = device->subscribeSensors({Sensor("temp"), Sensor(SOAPY_SDR_RX, 1, "lo_locked")}, 100.0,
+        [&numUpdates1](const std::vector<SoapySDR::SensorSubscription::Value> &){numUpdates1++;});
+    for (size_t i = 0; i < 1000 and (numUpdates0 < 5 or numUpdates1 < 5); i++)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    device->unsubscribeSensors(sub1);
+    const auto values = sub0->snapshot();
+    device->unsubscribeSensors(sub0);
+    SoapySDR::Device::unmake(device);
+
+    if (not values or values->size() != 2 or not values->at(0).valid or values->at(0).floatValue != 42.5 or
+        not values->at(1).valid or not values->at(1).boolValue)
+    {
+        printf("FAIL: sensor subscription snapshot\n");
+        return false;
+    }
+    if (numUpdates0 < 5 or numUpdates1 < 5 or numTempReads > std::max<size_t>(numUpdates0, numUpdates1) + 1)
+    {
+        printf("FAIL: sensor subscription updates=%d/%d, temp reads=%d\n", int(numUpdates0), int(numUpdates1), int(numTempReads));
+        return false;
+    }
+    return true;
+}
+
+/***********************************************************************
+ * The C fast path only touches the error state on error
+ **********************************************************************/
+class FaultyPacketDevice : public PacketDevice
+{
+public:
+    FaultyPacketDevice(void):
+        PacketDevice(2, 0)
+    {
+        return;
+    }
+
+    int readStream(SoapySDR::Stream *stream, void * const *buffs, const size_t numElems, int &flags, long long &timeNs, const long timeoutUs)
+    {
+        if (numElems == 0) throw std::runtime_error("empty read");
+        return PacketDevice::readStream(stream, buffs, numElems, flags, timeNs, timeoutUs);
+    }
+};
+
+static bool testStreamFastPath(void)
+{
+    FaultyPacketDevice packetDevice;
+    SoapySDR::Device *base = &packetDevice;
+    auto device = reinterpret_cast<SoapySDRDevice *>(base);
+    char mem[16];
+    void *buffs[1] = {mem};
+    int flags = 0;
+    long long timeNs = 0;
+
+    const int err = SoapySDRDevice_readStreamFast(device, nullptr, buffs, 0, &flags, &timeNs, 1000);
+    const std::string errMsg = SoapySDRDevice_lastError();
+    const int ret = SoapySDRDevice_readStreamFast(device, nullptr, buffs, 16, &flags, &timeNs, 1000);
+    const int fastStatus = SoapySDRDevice_lastStatus();
+    SoapySDRDevice_readStream(device, nullptr, buffs, 16, &flags, &timeNs, 1000);
+    const int status = SoapySDRDevice_lastStatus();
+
+    if (err != SOAPY_SDR_STREAM_ERROR or errMsg != "empty read" or ret != 16 or fastStatus != -1 or status != 0)
+    {
+        printf("FAIL: stream fast path err=%d \"%s\", ret=%d, fastStatus=%d, status=%d\n", err, errMsg.c_str(), ret, fastStatus, status);
+        return false;
+    }
+    return true;
+}
+
+/***********************************************************************
+ * Arena results match the regular C marshalling
+ **********************************************************************/
+class InfoDevice : public SoapySDR::Device
+{
+public:
+    std::vector<std::string> listSensors(void) const
+    {
+        return {"temp", "lo_locked", ""};
+    }
+
+    SoapySDR::ArgInfoList getSettingInfo(void) const
+    {
+        SoapySDR::ArgInfo info;
+        info.key = "mode";
+        info.value = "fast";
+        info.type = SoapySDR::ArgInfo::STRING;
+        info.options = {"fast", "slow"};
+        info.optionNames = {"Fast", "Slow"};
+        return {info, SoapySDR::ArgInfo()};
+    }
+};
+
+static bool testArenaMarshalling(void)
+{
+    InfoDevice infoDevice;
+    SoapySDR::Device *base = &infoDevice;
+    auto device = reinterpret_cast<const SoapySDRDevice *>(base);
+
+    size_t numSensors = 0;
+    char **sensors = SoapySDRDevice_listSensorsArena(device, &numSensors);
+    const bool sensorsOk = numSensors == 3 and std::string(sensors[0]) == "temp" and std::string(sensors[1]) == "lo_locked" and sensors[2][0] == '\0';
+    free(sensors);
+
+    size_t numInfos = 0;
+    SoapySDRArgInfo *infos = SoapySDRDevice_getSettingInfoArena(device, &numInfos);
+    const bool infosOk = numInfos == 2 and std::string(infos[0].key) == "mode" and std::string(infos[0].value) == "fast" and
+        infos[0].numOptions == 2 and std::string(infos[0].options[1]) == "slow" and std::string(infos[0].optionNames[1]) == "Slow" and
+        infos[1].key[0] == '\0' and infos[1].numOptions == 0;
+    free(infos);
+
+    size_t numArgs = 0;
+    SoapySDRKwargs filter = SoapySDRKwargs_fromString("driver=recording");
+    SoapySDRKwargs *results = SoapySDRDevice_enumerateArena(&filter, &numArgs);
+    SoapySDRKwargs_clear(&filter);
+    char *markup = (numArgs == 1)?SoapySDRKwargs_toString(results):nullptr;
+    const std::string resultMarkup = (markup == nullptr)?"":markup;
+    free(markup);
+    free(results);
+
+    if (not sensorsOk or not infosOk or resultMarkup != "driver=recording")
+    {
+        printf("FAIL: arena marshalling sensors=%d, infos=%d, enumerate=\"%s\"\n", int(sensorsOk), int(infosOk), resultMarkup.c_str());
+        return false;
+    }
+    return true;
+}
+
+static bool testNullDeviceLoopback(void)
+{
+    auto device = SoapySDR::Device::make("driver=null,type=null,source=loopback,mtu=256");
+    auto tx = device->setupStream(SOAPY_SDR_TX, SOAPY_SDR_CF32);
+    auto rx = device->setupStream(SOAPY_SDR_RX, SOAPY_SDR_CS16);
+    device->activateStream(tx);
+    device->activateStream(rx, SOAPY_SDR_HAS_TIME, 1000000);
+
+    std::vector<std::complex<float>> txBuff(100, std::complex<float>(0.5f, -0.25f));
+    const void *txBuffs[] = {txBuff.data()};
+    int txFlags = SOAPY_SDR_END_BURST;
+    const int txRet = device->writeStream(tx, txBuffs, txBuff.size(), txFlags, 0, 100000);
+
+    size_t chanMask = 0;
+    int statusFlags = 0;
+    long long statusTime = -1;
+    const int statusRet = device->readStreamStatus(tx, chanMask, statusFlags, statusTime, 100000);
+
+    std::vector<short> rxBuff(2*txBuff.size());
+    void *rxBuffs[] = {rxBuff.data()};
+    int rxFlags = 0;
+    long long rxTime = 0;
+    const int rxRet = device->readStream(rx, rxBuffs, txBuff.size(), rxFlags, rxTime, 100000);
+    const bool dataOk = rxRet == 100 and std::abs(rxBuff[0]-16384) <= 1 and std::abs(rxBuff[1]+8192) <= 1 and rxBuff[198] == rxBuff[0];
+
+    device->deactivateStream(rx);
+    device->deactivateStream(tx);
+    device->closeStream(rx);
+    device->closeStream(tx);
+    SoapySDR::Device::unmake(device);
+
+    if (txRet != 100 or statusRet != 0 or chanMask != 1 or (statusFlags & SOAPY_SDR_END_BURST) == 0 or
+        not dataOk or (rxFlags & SOAPY_SDR_HAS_TIME) == 0 or rxTime != 1000000)
+    {
+        printf("FAIL: null loopback tx=%d, status=%d, rx=%d, flags=%d, time=%lld\n", txRet, statusRet, rxRet, rxFlags, rxTime);
+        return false;
+    }
+    return true;
+}
+
+static bool testThreadHints(void)
+{
+    const SoapySDR::ThreadHints hints(SoapySDR::KwargsFromString("cpu_affinity=2-4:0 3, rt_priority=10, numa_node=1, other=x"));
+    const bool parsedOk = hints.cpus == std::vector<size_t>({0, 2, 3, 4}) and hints.priority == 10 and hints.numaNode == 1;
+    const bool emptyOk = SoapySDR::ThreadHints(SoapySDR::Kwargs()).empty() and SoapySDR::ThreadHints::argsInfo().size() == 3;
+
+    bool malformedOk = false;
+    try
+    {
+        SoapySDR::ThreadHints(SoapySDR::KwargsFromString("cpu_affinity=3-1"));
+    }
+    catch (const std::invalid_argument &)
+    {
+        malformedOk = true;
+    }
+
+    //affinity to the first CPU is always allowed on linux
+    SoapySDR::ThreadHints pin;
+    pin.cpus.push_back(0);
+    bool appliedOk = true;
+    #ifdef __linux__
+    std::thread([&pin, &appliedOk]{appliedOk = pin.applyToThisThread();}).join();
+    #endif
+
+    if (not parsedOk or not emptyOk or not malformedOk or not appliedOk)
+    {
+        printf("FAIL: thread hints parsed=%d, empty=%d, malformed=%d, applied=%d\n", int(parsedOk), int(emptyOk), int(malformedOk), int(appliedOk));
+        return false;
+    }
+    return true;
+}
+
+static bool testBufferPool(void)
+{
+    bool alignedOk = true;
+    for (const int flags : {0, SOAPY_SDR_BUFFER_HUGE_PAGES})
+    {
+        void *buff = SoapySDR::allocBuffer(1000, flags, -1, 256);
+        alignedOk = alignedOk and (size_t(buff) % 256) == 0;
+        std::memset(buff, 0x5a, 1000);
+        SoapySDR::freeBuffer(buff);
+    }
+
+    SoapySDR::BufferPool pool(3, 100, 4, 2);
+    void * const *first = pool.buffs(0);
+    void * const *second = pool.buffs(1);
+    bool layoutOk = pool.numBuffs() == 2 and pool.numChans() == 3 and pool.numElems() == 100;
+    for (size_t i = 0; i < 3; i++)
+    {
+        layoutOk = layoutOk and (size_t(first[i]) % SOAPY_SDR_BUFFER_ALIGNMENT) == 0 and (size_t(second[i]) % SOAPY_SDR_BUFFER_ALIGNMENT) == 0;
+        std::memset(first[i], 1, 400);
+        std::memset(second[i], 2, 400);
+    }
+    layoutOk = layoutOk and static_cast<const char *>(first[2])[399] == 1 and static_cast<const char *>(second[0])[0] == 2;
+
+    //a smaller layout reuses the allocation
+    void *base = first[0];
+    pool.resize(2, 50, 4, 1);
+    const bool reuseOk = pool.buffs(0)[0] == base and pool.numChans() == 2;
+
+    if (not alignedOk or not layoutOk or not reuseOk)
+    {
+        printf("FAIL: buffer pool aligned=%d, layout=%d, reuse=%d\n", int(alignedOk), int(layoutOk), int(reuseOk));
+        return false;
+    }
+    return true;
+}
+
+static bool testRecorder(void)
+{
+    const unsigned long long numSamples = 100000;
+    auto device = SoapySDR::Device::make("driver=null,type=null,source=tone,paced=true");
+    device->setSampleRate(SOAPY_SDR_RX, 0, 1e6);
+    device->setFrequency(SOAPY_SDR_RX, 0, 10e6);
+    unsigned long long numWritten(0);
+    {
+        SoapySDR::Recorder recorder(device, 0, "test_recorder", SoapySDR::KwargsFromString("format=CS16,buffers=8"));
+        recorder.start(numSamples);
+        for (size_t i = 0; i < 250 and not recorder.done(); i++) std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        recorder.stop();
+        numWritten = recorder.numSamples();
+    }
+    SoapySDR::Device::unmake(device);
+
+    std::ifstream data("test_recorder.sigmf-data", std::ios::binary | std::ios::ate);
+    const long long dataSize = data?(long long)(data.tellg()):-1;
+    data.close();
+    const bool dataOk = numWritten == numSamples and dataSize == (long long)(numSamples*4);
+
+    bool metaOk = false;
+    try
+    {
+        const auto meta = SoapySDR::SigMFMeta::load("test_recorder.sigmf-meta");
+        metaOk = meta.format == SOAPY_SDR_CS16 and meta.sampleRate == 1e6 and
+            not meta.captures.empty() and meta.captures[0].hasTime and meta.captures[0].frequency == 10e6;
+    }
+    catch (const std::exception &ex)
+    {
+        printf("SigMFMeta::load %s\n", ex.what());
+    }
+    std::remove("test_recorder.sigmf-data");
+    std::remove("test_recorder.sigmf-meta");
+
+    //the metadata survives a round trip through JSON
+    SoapySDR::SigMFMeta meta;
+    meta.format = SOAPY_SDR_CF32;
+    meta.sampleRate = 2.5e6;
+    meta.description = "a \"quoted\" note";
+    meta.captures.resize(2);
+    meta.captures[1].sampleStart = 1000;
+    meta.captures[1].hasTime = true;
+    meta.captures[1].timeNs = 123456789012LL;
+    meta.annotations.resize(1);
+    meta.annotations[0].sampleStart = 500;
+    meta.annotations[0].comment = "overflow";
+    const auto parsed = SoapySDR::SigMFMeta::fromJSON(meta.toJSON());
+    const bool jsonOk = parsed.format == meta.format and parsed.sampleRate == meta.sampleRate and
+        parsed.description == meta.description and parsed.captures.size() == 2 and
+        parsed.captures[1].sampleStart == 1000 and parsed.captures[1].timeNs == 123456789012LL and
+        not parsed.captures[0].hasTime and parsed.annotations.size() == 1 and parsed.annotations[0].comment == "overflow";
+
+    if (not dataOk or not metaOk or not jsonOk)
+    {
+        printf("FAIL: recorder data=%d (%llu samples, %lld bytes), meta=%d, json=%d\n",
+            int(dataOk), numWritten, dataSize, int(metaOk), int(jsonOk));
+        return false;
+    }
+    return true;
+}
+
+static bool testPlayer(void)
+{
+    //a raw file of a ramp that is converted to the native format on the way out
+    std::vector<short> samples(2*1000);
+    for (size_t i = 0; i < samples.size(); i++) samples[i] = short(i*16);
+    {
+        std::ofstream file("test_player.cs16", std::ios::binary);
+        file.write(reinterpret_cast<const char *>(samples.data()), samples.size()*sizeof(short));
+    }
+
+    auto device = SoapySDR::Device::make("driver=null,type=null,source=loopback");
+    unsigned long long numPlayed(0);
+    bool dataOk = false;
+    std::string error;
+    try
+    {
+        SoapySDR::Player player(device, 0, "test_player.cs16", SoapySDR::KwargsFromString("format=CS16"));
+        auto rx = device->setupStream(SOAPY_SDR_RX, SOAPY_SDR_CS16);
+        device->activateStream(rx);
+        player.start();
+        for (size_t i = 0; i < 250 and not player.done(); i++) std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        player.stop();
+        numPlayed = player.numSamples();
+
+        std::vector<short> rxBuff(samples.size());
+        size_t numRead(0);
+        while (numRead < 1000)
+        {
+            void *rxBuffs[] = {rxBuff.data() + 2*numRead};
+            int flags(0);
+            long long timeNs(0);
+            const int ret = device->readStream(rx, rxBuffs, 1000 - numRead, flags, timeNs, 100000);
+            if (ret <= 0) break;
+            numRead += size_t(ret);
+        }
+        dataOk = numRead == 1000;
+        for (size_t i = 0; dataOk and i < samples.size(); i++) dataOk = std::abs(rxBuff[i] - samples[i]) <= 1;
+        device->deactivateStream(rx);
+        device->closeStream(rx);
+    }
+    catch (const std::exception &ex)
+    {
+        error = ex.what();
+    }
+    SoapySDR::Device::unmake(device);
+    std::remove("test_player.cs16");
+
+    if (not error.empty() or numPlayed != 1000 or not dataOk)
+    {
+        printf("FAIL: player played=%llu, data=%d %s\n", numPlayed, int(dataOk), error.c_str());
+        return false;
+    }
+    return true;
+}
+
+static bool testAsyncReader(void)
+{
+    //a slow bus transfer of 100 counting samples, the third reports an overflow
+    std::atomic<size_t> numTransfers(0);
+    auto transfer = [&numTransfers](void * const *buffs, const size_t numElems, int &flags, long long &timeNs, const long)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        const size_t index = numTransfers++;
+        if (index == 2) return int(SOAPY_SDR_OVERFLOW);
+        int *out = reinterpret_cast<int *>(buffs[0]);
+        for (size_t i = 0; i < numElems; i++) out[i] = int(index*numElems + i);
+        flags = SOAPY_SDR_HAS_TIME;
+        timeNs = (long long)(index)*1000000;
+        return int(numElems);
+    };
+
+    SoapySDR::AsyncReader reader(transfer, 1, 100, sizeof(int), 4);
+    reader.setSampleRate(100e3);
+    reader.start();
+
+    //split reads keep the order and the interpolated time
+    std::vector<int> buff(100);
+    void *buffs[] = {buff.data()};
+    int flags[3] = {0, 0, 0};
+    long long timeNs[3] = {0, 0, 0};
+    const int first = reader.readStream(buffs, 60, flags[0], timeNs[0], 1000000);
+    const bool firstData = buff[0] == 0 and buff[59] == 59;
+    const int second = reader.readStream(buffs, 60, flags[1], timeNs[1], 1000000);
+    const bool splitOk = first == 60 and firstData and (flags[0] & SOAPY_SDR_MORE_FRAGMENTS) != 0 and timeNs[0] == 0 and
+        second == 40 and buff[0] == 60 and (flags[1] & SOAPY_SDR_MORE_FRAGMENTS) == 0 and
+        (flags[1] & SOAPY_SDR_HAS_TIME) != 0 and timeNs[1] == 600000;
+    reader.readStream(buffs, 100, flags[2], timeNs[2], 1000000);
+    const bool errorOk = reader.readStream(buffs, 100, flags[2], timeNs[2], 1000000) == SOAPY_SDR_OVERFLOW;
+
+    //transfers continue while the reader is busy, so the time is not the sum of both
+    const auto start = std::chrono::steady_clock::now();
+    bool dataOk = true;
+    for (size_t i = 0; i < 10; i++)
+    {
+        size_t handle(0);
+        const void *ptrs[1] = {nullptr};
+        const int ret = reader.acquireReadBuffer(handle, ptrs, flags[2], timeNs[2], 1000000);
+        dataOk = dataOk and ret == 100 and static_cast<const int *>(ptrs[0])[0] == int((i+3)*100);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        if (ret > 0) reader.releaseReadBuffer(handle);
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    reader.stop();
+
+    if (not splitOk or not errorOk or not dataOk or elapsed > 0.085)
+    {
+        printf("FAIL: async reader split=%d (%d, %d@%lld), error=%d, data=%d, elapsed=%g\n",
+            int(splitOk), first, second, timeNs[1], int(errorOk), int(dataOk), elapsed);
+        return false;
+    }
+    return true;
+}
+
+static bool testBurstScheduler(void)
+{
+    auto device = SoapySDR::Device::make("driver=null,type=null,source=loopback");
+    auto tx = device->setupStream(SOAPY_SDR_TX, SOAPY_SDR_CF32);
+    auto rx = device->setupStream(SOAPY_SDR_RX, SOAPY_SDR_CF32);
+    device->activateStream(tx);
+    device->activateStream(rx);
+
+    //a late burst, five back to back bursts that coalesce, and a burst after a gap
+    std::vector<std::complex<float>> samples(600);
+    for (size_t i = 0; i < samples.size(); i++) samples[i] = std::complex<float>(float(i), 0.0f);
+    const long long start = device->getHardwareTime() + 30000000;
+    const long long burstNs = SoapySDR::ticksToTimeNs(100, 1e6);
+    int submitted(0);
+    unsigned long long numBursts(0), numLate(0), numWrites(0);
+    std::vector<int> reports;
+    {
+        SoapySDR::BurstScheduler scheduler(device, tx, 1, sizeof(std::complex<float>), 1e6, SoapySDR::KwargsFromString("lead_us=5000"));
+        const void *late[] = {samples.data()};
+        submitted += scheduler.submit(late, 100, start - 60000000);
+        for (size_t i = 0; i < 6; i++)
+        {
+            const void *buffs[] = {samples.data() + i*100};
+            submitted += scheduler.submit(buffs, 100, start + (long long)(i)*burstNs + ((i == 5)?200000:0));
+        }
+        scheduler.flush(1000000);
+        for (size_t i = 0; i < 3; i++)
+        {
+            size_t chanMask(0);
+            int flags(0);
+            long long timeNs(0);
+            const int ret = scheduler.readStreamStatus(chanMask, flags, timeNs, 100000);
+            reports.push_back((ret == 0)?(flags & SOAPY_SDR_END_BURST):ret);
+        }
+        numBursts = scheduler.numBursts();
+        numLate = scheduler.numLate();
+        numWrites = scheduler.numWrites();
+    }
+
+    std::vector<std::complex<float>> out(samples.size());
+    size_t numRead(0);
+    while (numRead < out.size())
+    {
+        void *buffs[] = {out.data() + numRead};
+        int flags(0);
+        long long timeNs(0);
+        const int ret = device->readStream(rx, buffs, out.size() - numRead, flags, timeNs, 100000);
+        if (ret <= 0) break;
+        numRead += size_t(ret);
+    }
+    const bool dataOk = numRead == out.size() and out == samples;
+
+    device->deactivateStream(rx);
+    device->deactivateStream(tx);
+    device->closeStream(rx);
+    device->closeStream(tx);
+    SoapySDR::Device::unmake(device);
+
+    const bool reportsOk = reports == std::vector<int>({SOAPY_SDR_TIME_ERROR, SOAPY_SDR_END_BURST, SOAPY_SDR_END_BURST});
+    if (submitted != 0 or numBursts != 6 or numLate != 1 or numWrites != 2 or not reportsOk or not dataOk)
+    {
+        printf("FAIL: burst scheduler bursts=%d, late=%d, writes=%d, reports=%d, data=%d\n",
+            int(numBursts), int(numLate), int(numWrites), int(reportsOk), int(dataOk));
+        return false;
+    }
+    return true;
+}
+
+static bool pollReady(const intptr_t handle, const int timeoutMs)
+{
+    #ifdef _WIN32
+    return WaitForSingleObject(reinterpret_cast<HANDLE>(handle), DWORD(timeoutMs)) == WAIT_OBJECT_0;
+    #else
+    pollfd fds[1];
+    fds[0].fd = int(handle);
+    fds[0].events = POLLIN;
+    fds[0].revents = 0;
+    return poll(fds, 1, timeoutMs) == 1 and (fds[0].revents & POLLIN) != 0;
+    #endif
+}
+
+static bool testStreamPollHandle(void)
+{
+    auto device = SoapySDR::Device::make("driver=null,type=null,source=loopback");
+    auto tx = device->setupStream(SOAPY_SDR_TX, SOAPY_SDR_CF32);
+    auto rx = device->setupStream(SOAPY_SDR_RX, SOAPY_SDR_CF32);
+    intptr_t rxHandle(-1), txHandle(-1);
+    const int rxRet = device->getStreamPollHandle(rx, rxHandle);
+    const int txRet = device->getStreamPollHandle(tx, txHandle);
+    device->activateStream(tx);
+    device->activateStream(rx);
+
+    //nothing is ready until a burst loops back
+    const bool idleOk = not pollReady(rxHandle, 20) and not pollReady(txHandle, 0);
+    std::vector<std::complex<float>> samples(500, std::complex<float>(1.0f, 0.0f));
+    const void *txBuffs[] = {samples.data()};
+    int flags(SOAPY_SDR_END_BURST);
+    device->writeStream(tx, txBuffs, samples.size(), flags, 0, 100000);
+    const bool readyOk = pollReady(rxHandle, 1000) and pollReady(txHandle, 1000);
+
+    //reading without a timeout drains the samples and the status, then the handles clear
+    std::vector<std::complex<float>> out(samples.size());
+    void *rxBuffs[] = {out.data()};
+    long long timeNs(0);
+    size_t total(0);
+    while (pollReady(rxHandle, 100))
+    {
+        const int ret = device->readStream(rx, rxBuffs, out.size(), flags, timeNs, 0);
+        if (ret > 0) total += size_t(ret);
+        if (total > samples.size()) break;
+    }
+    size_t chanMask(0);
+    const int statusRet = device->readStreamStatus(tx, chanMask, flags, timeNs, 0);
+    const bool clearOk = not pollReady(rxHandle, 0) and not pollReady(txHandle, 0);
+
+    device->deactivateStream(rx);
+    device->deactivateStream(tx);
+    device->closeStream(rx);
+    device->closeStream(tx);
+    SoapySDR::Device::unmake(device);
+
+    if (rxRet != 0 or txRet != 0 or not idleOk or not readyOk or total != samples.size() or
+        statusRet != 0 or (flags & SOAPY_SDR_END_BURST) == 0 or not clearOk)
+    {
+        printf("FAIL: poll handle ret=%d/%d, idle=%d, ready=%d, total=%d, status=%d, clear=%d\n",
+            rxRet, txRet, int(idleOk), int(readyOk), int(total), statusRet, int(clearOk));
+        return false;
+    }
+    return true;
+}
+
+static bool testStreamSubscription(void)
+{
+    auto device = SoapySDR::Device::make("driver=null,type=null,source=loopback");
+    auto tx = device->setupStream(SOAPY_SDR_TX, SOAPY_SDR_CF32);
+    auto rx = device->setupStream(SOAPY_SDR_RX, SOAPY_SDR_CF32);
+
+    //the callback checks the order of a counting ramp in the zero copy buffers
+    std::atomic<size_t> total(0);
+    std::atomic<bool> orderOk(true);
+    auto subscription = device->subscribeStream(rx, 1, [&total, &orderOk](const void * const *buffs, const int ret, const int, const long long)
+    {
+        if (ret <= 0) return;
+        const auto *samples = static_cast<const std::complex<float> *>(buffs[0]);
+        for (int i = 0; i < ret; i++) if (samples[i].real() != float(total + size_t(i))) orderOk = false;
+        total += size_t(ret);
+    });
+    device->activateStream(tx);
+    device->activateStream(rx);
+
+    std::vector<std::complex<float>> samples(3000);
+    for (size_t i = 0; i < samples.size(); i++) samples[i] = std::complex<float>(float(i), 0.0f);
+    for (size_t i = 0; i < 3; i++)
+    {
+        const void *buffs[] = {samples.data() + i*1000};
+        int flags(SOAPY_SDR_END_BURST);
+        device->writeStream(tx, buffs, 1000, flags, 0, 100000);
+    }
+    for (size_t i = 0; i < 100 and total < samples.size(); i++) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    const unsigned long long numPublished = subscription->numPublished();
+
+    device->deactivateStream(rx);
+    device->deactivateStream(tx);
+    device->unsubscribeStream(subscription);
+    device->closeStream(rx);
+    device->closeStream(tx);
+    SoapySDR::Device::unmake(device);
+
+    if (total != samples.size() or not orderOk or numPublished == 0)
+    {
+        printf("FAIL: stream subscription %d samples in %d buffers, order=%d\n", int(total), int(numPublished), int(orderOk));
+        return false;
+    }
+    return true;
+}
+
+//a driver without a poll handle or direct buffers is read by the subscription
+static bool testStreamSubscriptionFallback(void)
+{
+    auto device = SoapySDR::Device::make("driver=packet");
+    auto stream = device->setupStream(SOAPY_SDR_RX, SOAPY_SDR_CF32);
+    std::atomic<size_t> total(0);
+    auto subscription = device->subscribeStream(stream, 1, [&total](const void * const *, const int ret, const int, const long long)
+    {
+        if (ret > 0) total += size_t(ret);
+    });
+    for (size_t i = 0; i < 100 and total < 5*1024; i++) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    const unsigned long long numPublished = subscription->numPublished();
+    device->unsubscribeStream(subscription);
+
+    //the driver has no stats of its own, make() counts the reads
+    SoapySDR::StreamStats stats;
+    const int ret = device->getStreamStats(stream, stats);
+    device->closeStream(stream);
+    SoapySDR::Device::unmake(device);
+
+    if (total != 5*1024 or numPublished != 5)
+    {
+        printf("FAIL: stream subscription fallback %d samples in %d buffers\n", int(total), int(numPublished));
+        return false;
+    }
+    if (ret != 0 or stats.numCalls < 5 or stats.numElems != 5*1024)
+    {
+        printf("FAIL: stream subscription fallback stats returned %d, numCalls=%d, numElems=%d\n", ret, int(stats.numCalls), int(stats.numElems));
+        return false;
+    }
+    return true;
+}
+
+static bool testScanner(void)
+{
+    auto device = SoapySDR::Device::make("driver=null,type=null,source=tone,paced=true");
+    device->setSampleRate(SOAPY_SDR_RX, 0, 1e6);
+    auto stream = device->setupStream(SOAPY_SDR_RX, SOAPY_SDR_CF32);
+    device->activateStream(stream);
+
+    //three steps of 2 ms after 1 ms of settling
+    std::vector<SoapySDR::Scanner::Step> steps;
+    for (size_t i = 0; i < 3; i++) steps.push_back(SoapySDR::Scanner::Step(100e6 + i*1e6, 2000000, 1000000));
+    std::vector<SoapySDR::Scanner::Capture> captures;
+    std::mutex mutex;
+    auto callback = [&captures, &mutex](const SoapySDR::Scanner::Capture &capture)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        captures.push_back(capture);
+    };
+
+    //timed sweeps follow each other on the stream timeline
+    bool timedOk(false), timedFinished(false);
+    double frequency(0.0);
+    {
+        SoapySDR::Scanner scanner(device, stream, 0, 1, sizeof(std::complex<float>));
+        scanner.start(steps, callback, 2);
+        timedFinished = scanner.wait(2000000);
+
+        //the last retune may still be pending in the schedule thread under load
+        for (size_t i = 0; i < 1000 and device->getNumScheduledSettings() != 0; i++) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        frequency = device->getFrequency(SOAPY_SDR_RX, 0);
+        timedOk = timedFinished and scanner.numSweeps() == 2 and captures.size() == 6 and scanner.numDiscarded() >= 3000;
+        for (size_t i = 0; i < captures.size() and timedOk; i++)
+        {
+            timedOk = captures[i].step == i%3 and captures[i].sweep == i/3 and captures[i].status == 0 and captures[i].numElems == 2000;
+            if (i%3 != 0) timedOk = timedOk and captures[i].timeNs - captures[i-1].timeNs == 3000000;
+        }
+    }
+
+    //host tuned steps discard the settling samples by count
+    captures.clear();
+    bool hostOk(false);
+    {
+        SoapySDR::Scanner scanner(device, stream, 0, 1, sizeof(std::complex<float>), SoapySDR::KwargsFromString("timed=false"));
+        scanner.start(steps, callback, 1);
+        hostOk = scanner.wait(2000000) and captures.size() == 3 and scanner.numDiscarded() == 3000 and
+            captures[2].numElems == 2000 and captures[2].frequency == 102e6 and captures[2].timeNs == 7000000;
+    }
+
+    device->deactivateStream(stream);
+    device->closeStream(stream);
+    SoapySDR::Device::unmake(device);
+
+    if (not timedOk or not hostOk or frequency != 102e6)
+    {
+        printf("FAIL: scanner timed=%d (finished=%d, %d captures), host=%d, freq=%g\n",
+            int(timedOk), int(timedFinished), int(captures.size()), int(hostOk), frequency);
+        return false;
+    }
+    return true;
+}
+
+int main(void)
+{
+    bool ok = true;
+    ok = ok and testReadBatch();
+    ok = ok and testWriteBatch();
+    ok = ok and testStreamStats();
+    ok = ok and testStreamTimeLatency();
+    ok = ok and testTracer();
+    ok = ok and testParallelMake();
+    ok = ok and testEnumerateCache();
+    ok = ok and testBatchMake();
+    ok = ok and testCommitSettings();
+    ok = ok and testGainCache();
+    ok = ok and testScheduleSettings();
+    ok = ok and testRescheduleSettings();
+    ok = ok and testRegisterList();
+    ok = ok and testSensorSubscription();
+    ok = ok and testStreamFastPath();
+    ok = ok and testArenaMarshalling();
+    ok = ok and testNullDeviceLoopback();
+    ok = ok and testThreadHints();
+    ok = ok and testBufferPool();
+    ok = ok and testRecorder();
+    ok = ok and testPlayer();
+    ok = ok and testAsyncReader();
+    ok = ok and testBurstScheduler();
+    ok = ok and testStreamPollHandle();
+    ok = ok and testStreamSubscription();
+    ok = ok and testStreamSubscriptionFallback();
+    ok = ok and testScanner();
+    printf("DONE!\n");
+    return ok?EXIT_SUCCESS:EXIT_FAILURE;
+}
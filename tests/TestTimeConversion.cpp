@@ -1,4 +1,4 @@
-// Copyright (c) 2015-2015 Josh Blum
+// Copyright (c) 2015-2018 Josh Blum
 // SPDX-License-Identifier: BSL-1.0
 
 #include <SoapySDR/Time.hpp>
@@ -51,6 +51,25 @@ static unsigned long long rand64bits(void)
     return results;
 }
 
+static bool checkArrays(const double rate)
+{
+    long long ticks[16], timeNs[16], outTicks[16];
+    for (size_t i = 0; i < 16; i++) ticks[i] = (long long)(rand64bits() >> 8) * ((i % 2)?-1:1);
+    SoapySDR_ticksToTimeNsArray(ticks, timeNs, 16, rate);
+    SoapySDR_timeNsToTicksArray(timeNs, outTicks, 16, rate);
+    const SoapySDR::TickConverter converter(rate);
+    for (size_t i = 0; i < 16; i++)
+    {
+        if (timeNs[i] == SoapySDR::ticksToTimeNs(ticks[i], rate) and
+            timeNs[i] == converter.ticksToTimeNs(ticks[i]) and
+            outTicks[i] == converter.timeNsToTicks(timeNs[i]) and
+            outTicks[i] == ticks[i]) continue;
+        printf("FAIL: checkArrays(%f) ticks = %lld, timeNs = %lld, outTicks = %lld\n", rate, ticks[i], timeNs[i], outTicks[i]);
+        return false;
+    }
+    return true;
+}
+
 int main(void)
 {
     //test that random times can make it through the conversion
@@ -85,6 +104,27 @@ int main(void)
     }
     printf("OK\n");
 
+    //test the array conversions match the scalar conversions
+    printf("Test arrays...\n");
+    for (size_t i = 0; i < 100; i++)
+    {
+        if (not checkArrays(1e9)) return EXIT_FAILURE;
+        if (not checkArrays(52e6)) return EXIT_FAILURE;
+        if (not checkArrays(61.44e6)) return EXIT_FAILURE;
+        if (not checkArrays(100e6/3)) return EXIT_FAILURE;
+    }
+    printf("OK\n");
+
+    //test known values at integer and fractional rates
+    printf("Test known values...\n");
+    if (SoapySDR::ticksToTimeNs(3, 2e9) != 2 or SoapySDR::ticksToTimeNs(-3, 2e9) != -2 or
+        SoapySDR::timeNsToTicks(1000000001, 1e6) != 1000000 or SoapySDR::ticksToTimeNs(61440000, 61.44e6) != 1000000000)
+    {
+        printf("FAIL: known values\n");
+        return EXIT_FAILURE;
+    }
+    printf("OK\n");
+
     printf("DONE!\n");
     return EXIT_SUCCESS;
 }